@@ -14,14 +14,23 @@
 // direction of flux (bx bz) to be predefined and limits the effect of magnetic distortions to yaw
 // axis only.
 //
-// User must define 'halfT' as the (sample period / 2), and the filter gains 'Kp' and 'Ki'.
+// User must define 'dt' as the sample period, and the filter gains 'Kp' and 'Ki'.
 //
-// Global variables 'q0', 'q1', 'q2', 'q3' are the quaternion elements representing the estimated
-// orientation.  See my report for an overview of the use of quaternions in this application.
+// The filter state, quaternion elements 'q0', 'q1', 'q2', 'q3' included, lives in a margAHRS_t so
+// any number of filters can run side by side.  The flight code uses the 'margAHRS' instance through
+// MargAHRSupdate(), offline tools run their own instances through MargAHRSupdateInstance().
+// See my report for an overview of the use of quaternions in this application.
 //
-// User must call 'AHRSupdate()' every sample period and parse calibrated gyroscope ('gx', 'gy', 'gz'),
-// accelerometer ('ax', 'ay', 'ay') and magnetometer ('mx', 'my', 'mz') data.  Gyroscope units are
-// radians/second, accelerometer and magnetometer units are irrelevant as the vector is normalised.
+// User must call 'AHRSupdate()' every sample period and parse the calibrated gyroscope delta angle
+// ('deltaAngle'), accelerometer ('ax', 'ay', 'ay') and magnetometer ('mx', 'my', 'mz') data.  The delta
+// angle is the coning compensated rotation over the sample period in radians, so the 1 kHz samples
+// behind it are not reduced to an average rate.  Accelerometer and magnetometer units are irrelevant
+// as the vector is normalised.  The correction rates are applied on top of the delta angle.
+//
+// The quaternion is the primary state.  Euler angles, heading and the rotation matrix are only
+// computed when read, once per filter update, so a 500 Hz update no longer pays for atan2/asin when
+// the only consumers run at 50 or 100 Hz.  Each update bumps 'generation'; a cached representation
+// is valid while its own generation matches.
 //
 //=====================================================================================================
 
@@ -33,140 +42,145 @@
 //----------------------------------------------------------------------------------------------------
 // Variable definitions
 
-float exAcc    = 0.0f,    eyAcc = 0.0f,    ezAcc = 0.0f; // accel error
-float exAccInt = 0.0f, eyAccInt = 0.0f, ezAccInt = 0.0f; // accel integral error
-
-float exMag    = 0.0f, eyMag    = 0.0f, ezMag    = 0.0f; // mag error
-float exMagInt = 0.0f, eyMagInt = 0.0f, ezMagInt = 0.0f; // mag integral error
-
-float kpAcc, kiAcc;
-
-float q0 = 1.0f, q1 = 0.0f, q2 = 0.0f, q3 = 0.0f;
+margAHRS_t margAHRS = { .q0 = 1.0f, .accMagP = 1.0f, .accConfidence = 1.0f, .generation = 1 };
 
-// auxiliary variables to reduce number of repeated operations
-float q0q0, q0q1, q0q2, q0q3;
-float q1q1, q1q2, q1q3;
-float q2q2, q2q3;
-float q3q3;
+static heading_t heading;
 
-float halfT;
+static uint32_t headingGeneration;
 
-uint8_t MargAHRSinitialized = false;
+float accConfidenceDecay = 0.0f;
 
 //----------------------------------------------------------------------------------------------------
 
-float accConfidenceDecay = 0.0f;
-float accConfidence      = 1.0f;
-
 #define HardFilter(O,N)  ((O)*0.9f+(N)*0.1f)
 
-void calculateAccConfidence(float accMag)
+static void calculateAccConfidence(margAHRS_t *ahrs, float accMag)
 {
 	// G.K. Egan (C) computes confidence in accelerometers when
 	// aircraft is being accelerated over and above that due to gravity
 
-	static float accMagP = 1.0f;
-
 	accMag /= accelOneG;  // HJI Added to convert MPS^2 to G's
 
-	accMag  = HardFilter(accMagP, accMag );
-	accMagP = accMag;
+	accMag        = HardFilter(ahrs->accMagP, accMag );
+	ahrs->accMagP = accMag;
 
-	accConfidence
-			= constrain(1.0 - (accConfidenceDecay * sqrt(fabs(accMag - 1.0f))), 0.0f, 1.0f);
+	ahrs->accConfidence
+			= constrain(1.0f - (ahrs->accConfidenceDecay * fastSqrtf(fabsf(accMag - 1.0f))), 0.0f, 1.0f);
 
 }
 
 //----------------------------------------------------------------------------------------------------
 
+static void updateProducts(margAHRS_t *ahrs)
+{
+    // auxiliary variables to reduce number of repeated operations
+    ahrs->q0q0 = ahrs->q0 * ahrs->q0;
+    ahrs->q0q1 = ahrs->q0 * ahrs->q1;
+    ahrs->q0q2 = ahrs->q0 * ahrs->q2;
+    ahrs->q0q3 = ahrs->q0 * ahrs->q3;
+    ahrs->q1q1 = ahrs->q1 * ahrs->q1;
+    ahrs->q1q2 = ahrs->q1 * ahrs->q2;
+    ahrs->q1q3 = ahrs->q1 * ahrs->q3;
+    ahrs->q2q2 = ahrs->q2 * ahrs->q2;
+    ahrs->q2q3 = ahrs->q2 * ahrs->q3;
+    ahrs->q3q3 = ahrs->q3 * ahrs->q3;
+
+    ahrs->generation++;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+//====================================================================================================
+// Reset
+//====================================================================================================
+
+void MargAHRSreset(margAHRS_t *ahrs)
+{
+    ahrs->q0 = 1.0f;
+    ahrs->q1 = 0.0f;
+    ahrs->q2 = 0.0f;
+    ahrs->q3 = 0.0f;
+
+    ahrs->exAccInt = ahrs->eyAccInt = ahrs->ezAccInt = 0.0f;
+    ahrs->exMagInt = ahrs->eyMagInt = ahrs->ezMagInt = 0.0f;
+
+    ahrs->accMagP       = 1.0f;
+    ahrs->accConfidence = 1.0f;
+
+    ahrs->initialized = false;
+
+    // The bump in updateProducts() invalidates every cache, including the heading, whatever
+    // value an instance on the stack started with
+
+    ahrs->attitudeGeneration = ahrs->generation;
+    ahrs->matrixGeneration   = ahrs->generation;
+
+    updateProducts(ahrs);
+}
+
 //====================================================================================================
 // Initialization
 //====================================================================================================
 
-void MargAHRSinit(float ax, float ay, float az, float mx, float my, float mz)
+static void MargAHRSinit(margAHRS_t *ahrs, float ax, float ay, float az, float mx, float my, float mz)
 {
-    float initialRoll, initialPitch;
-    float cosRoll, sinRoll, cosPitch, sinPitch;
-    float magX, magY;
-    float initialHdg, cosHeading, sinHeading;
-
-    initialRoll  = atan2(-ay, -az);
-    initialPitch = atan2( ax, -az);
-
-    cosRoll  = cosf(initialRoll);
-    sinRoll  = sinf(initialRoll);
-    cosPitch = cosf(initialPitch);
-    sinPitch = sinf(initialPitch);
-
-    magX = mx * cosPitch + my * sinRoll * sinPitch + mz * cosRoll * sinPitch;
-
-    magY = my * cosRoll - mz * sinRoll;
-
-    initialHdg = atan2f(-magY, magX);
-
-    cosRoll = cosf(initialRoll * 0.5f);
-    sinRoll = sinf(initialRoll * 0.5f);
-
-    cosPitch = cosf(initialPitch * 0.5f);
-    sinPitch = sinf(initialPitch * 0.5f);
-
-    cosHeading = cosf(initialHdg * 0.5f);
-    sinHeading = sinf(initialHdg * 0.5f);
-
-    q0 = cosRoll * cosPitch * cosHeading + sinRoll * sinPitch * sinHeading;
-    q1 = sinRoll * cosPitch * cosHeading - cosRoll * sinPitch * sinHeading;
-    q2 = cosRoll * sinPitch * cosHeading + sinRoll * cosPitch * sinHeading;
-    q3 = cosRoll * cosPitch * sinHeading - sinRoll * sinPitch * cosHeading;
-
-    // auxillary variables to reduce number of repeated operations, for 1st pass
-    q0q0 = q0 * q0;
-    q0q1 = q0 * q1;
-    q0q2 = q0 * q2;
-    q0q3 = q0 * q3;
-    q1q1 = q1 * q1;
-    q1q2 = q1 * q2;
-    q1q3 = q1 * q3;
-    q2q2 = q2 * q2;
-    q2q3 = q2 * q3;
-    q3q3 = q3 * q3;
+    const float accel[3] = { ax, ay, az };
+    const float mag[3]   = { mx, my, mz };
+    float       q[4];
+
+    accelMagToQuaternion(accel, mag, q);
+
+    ahrs->q0 = q[0];
+    ahrs->q1 = q[1];
+    ahrs->q2 = q[2];
+    ahrs->q3 = q[3];
+
+    updateProducts(ahrs);
 }
 
 //====================================================================================================
-// Function
+// Function, any instance
 //====================================================================================================
 
-void MargAHRSupdate(float gx, float gy, float gz,
-                    float ax, float ay, float az,
-                    float mx, float my, float mz,
-                    float accelCutoff, uint8_t magDataUpdate, float dt)
+void MargAHRSupdateInstance(margAHRS_t *ahrs,
+                            const float deltaAngle[3],
+                            float ax, float ay, float az,
+                            float mx, float my, float mz,
+                            uint8_t magDataUpdate, float dt)
 {
     float norm, normR;
     float hx, hy, hz, bx, bz;
     float vx, vy, vz, wx, wy, wz;
-    float q0i, q1i, q2i, q3i;
+    float exAcc, eyAcc, ezAcc;
+    float exMag, eyMag, ezMag;
+    float kpAcc, kiAcc;
+    float gx, gy, gz;
+    float q[4];
 
     //-------------------------------------------
 
-    if ((MargAHRSinitialized == false) && (magDataUpdate == true))
+    if ((ahrs->initialized == false) && (magDataUpdate == true))
     {
-        MargAHRSinit(ax, ay, az, mx, my, mz);
+        MargAHRSinit(ahrs, ax, ay, az, mx, my, mz);
 
-        MargAHRSinitialized = true;
+        ahrs->initialized = true;
     }
 
     //-------------------------------------------
 
-    if (MargAHRSinitialized == true)
+    if (ahrs->initialized == true)
     {
-        halfT = dt * 0.5f;
+        gx = 0.0f;
+        gy = 0.0f;
+        gz = 0.0f;
 
-        norm = sqrt(SQR(ax) + SQR(ay) + SQR(az));
+        norm = fastSqrtf(SQR(ax) + SQR(ay) + SQR(az));
 
         if (norm != 0.0f)
         {
-			calculateAccConfidence(norm);
-            kpAcc = eepromConfig.KpAcc * accConfidence;
-            kiAcc = eepromConfig.KiAcc * accConfidence;
+			calculateAccConfidence(ahrs, norm);
+            kpAcc = ahrs->KpAcc * ahrs->accConfidence;
+            kiAcc = ahrs->KiAcc * ahrs->accConfidence;
 
             normR = 1.0f / norm;
             ax *= normR;
@@ -174,9 +188,9 @@ void MargAHRSupdate(float gx, float gy, float gz,
             az *= normR;
 
             // estimated direction of gravity (v)
-            vx = 2.0f * (q1q3 - q0q2);
-            vy = 2.0f * (q0q1 + q2q3);
-            vz = q0q0 - q1q1 - q2q2 + q3q3;
+            vx = 2.0f * (ahrs->q1q3 - ahrs->q0q2);
+            vy = 2.0f * (ahrs->q0q1 + ahrs->q2q3);
+            vz = ahrs->q0q0 - ahrs->q1q1 - ahrs->q2q2 + ahrs->q3q3;
 
             // error is sum of cross product between reference direction
 		    // of fields and direction measured by sensors
@@ -190,19 +204,19 @@ void MargAHRSupdate(float gx, float gy, float gz,
 
             if (kiAcc > 0.0f)
             {
-		    	exAccInt += exAcc * kiAcc;
-                eyAccInt += eyAcc * kiAcc;
-                ezAccInt += ezAcc * kiAcc;
+		    	ahrs->exAccInt += exAcc * kiAcc;
+                ahrs->eyAccInt += eyAcc * kiAcc;
+                ahrs->ezAccInt += ezAcc * kiAcc;
 
-                gx += exAccInt;
-                gy += eyAccInt;
-                gz += ezAccInt;
+                gx += ahrs->exAccInt;
+                gy += ahrs->eyAccInt;
+                gz += ahrs->ezAccInt;
 		    }
 	    }
 
         //-------------------------------------------
 
-        norm = sqrt(SQR(mx) + SQR(my) + SQR(mz));
+        norm = fastSqrtf(SQR(mx) + SQR(my) + SQR(mz));
 
         if (( magDataUpdate == true) && (norm != 0.0f))
         {
@@ -212,22 +226,22 @@ void MargAHRSupdate(float gx, float gy, float gz,
             mz *= normR;
 
             // compute reference direction of flux
-            hx = 2.0f * (mx * (0.5f - q2q2 - q3q3) + my * (q1q2 - q0q3) + mz * (q1q3 + q0q2));
+            hx = 2.0f * (mx * (0.5f - ahrs->q2q2 - ahrs->q3q3) + my * (ahrs->q1q2 - ahrs->q0q3) + mz * (ahrs->q1q3 + ahrs->q0q2));
 
-            hy = 2.0f * (mx * (q1q2 + q0q3) + my * (0.5f - q1q1 - q3q3) + mz * (q2q3 - q0q1));
+            hy = 2.0f * (mx * (ahrs->q1q2 + ahrs->q0q3) + my * (0.5f - ahrs->q1q1 - ahrs->q3q3) + mz * (ahrs->q2q3 - ahrs->q0q1));
 
-            hz = 2.0f * (mx * (q1q3 - q0q2) + my * (q2q3 + q0q1) + mz * (0.5f - q1q1 - q2q2));
+            hz = 2.0f * (mx * (ahrs->q1q3 - ahrs->q0q2) + my * (ahrs->q2q3 + ahrs->q0q1) + mz * (0.5f - ahrs->q1q1 - ahrs->q2q2));
 
-            bx = sqrt((hx * hx) + (hy * hy));
+            bx = fastSqrtf((hx * hx) + (hy * hy));
 
             bz = hz;
 
             // estimated direction of flux (w)
-            wx = 2.0f * (bx * (0.5f - q2q2 - q3q3) + bz * (q1q3 - q0q2));
+            wx = 2.0f * (bx * (0.5f - ahrs->q2q2 - ahrs->q3q3) + bz * (ahrs->q1q3 - ahrs->q0q2));
 
-            wy = 2.0f * (bx * (q1q2 - q0q3) + bz * (q0q1 + q2q3));
+            wy = 2.0f * (bx * (ahrs->q1q2 - ahrs->q0q3) + bz * (ahrs->q0q1 + ahrs->q2q3));
 
-            wz = 2.0f * (bx * (q0q2 + q1q3) + bz * (0.5f - q1q1 - q2q2));
+            wz = 2.0f * (bx * (ahrs->q0q2 + ahrs->q1q3) + bz * (0.5f - ahrs->q1q1 - ahrs->q2q2));
 
             exMag = my * wz - mz * wy;
             eyMag = mz * wx - mx * wz;
@@ -236,60 +250,178 @@ void MargAHRSupdate(float gx, float gy, float gz,
 			// use un-extrapolated old values between magnetometer updates
 			// dubious as dT does not apply to the magnetometer calculation so
 			// time scaling is embedded in KpMag and KiMag
-			gx += exMag * eepromConfig.KpMag;
-			gy += eyMag * eepromConfig.KpMag;
-			gz += ezMag * eepromConfig.KpMag;
+			gx += exMag * ahrs->KpMag;
+			gy += eyMag * ahrs->KpMag;
+			gz += ezMag * ahrs->KpMag;
 
-			if (eepromConfig.KiMag > 0.0f)
+			if (ahrs->KiMag > 0.0f)
 			{
-				exMagInt += exMag * eepromConfig.KiMag;
-				eyMagInt += eyMag * eepromConfig.KiMag;
-				ezMagInt += ezMag * eepromConfig.KiMag;
+				ahrs->exMagInt += exMag * ahrs->KiMag;
+				ahrs->eyMagInt += eyMag * ahrs->KiMag;
+				ahrs->ezMagInt += ezMag * ahrs->KiMag;
 
-				gx += exMagInt;
-				gy += eyMagInt;
-				gz += ezMagInt;
+				gx += ahrs->exMagInt;
+				gy += ahrs->eyMagInt;
+				gz += ahrs->ezMagInt;
 			}
         }
 
         //-------------------------------------------
 
-        // integrate quaternion rate
-        q0i = (-q1 * gx - q2 * gy - q3 * gz) * halfT;
-        q1i = ( q0 * gx + q2 * gz - q3 * gy) * halfT;
-        q2i = ( q0 * gy - q1 * gz + q3 * gx) * halfT;
-        q3i = ( q0 * gz + q1 * gy - q2 * gx) * halfT;
-        q0 += q0i;
-        q1 += q1i;
-        q2 += q2i;
-        q3 += q3i;
-
-        // normalise quaternion
-        normR = 1.0f / sqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
-        q0 *= normR;
-        q1 *= normR;
-        q2 *= normR;
-        q3 *= normR;
-
-        // auxiliary variables to reduce number of repeated operations
-        q0q0 = q0 * q0;
-        q0q1 = q0 * q1;
-        q0q2 = q0 * q2;
-        q0q3 = q0 * q3;
-        q1q1 = q1 * q1;
-        q1q2 = q1 * q2;
-        q1q3 = q1 * q3;
-        q2q2 = q2 * q2;
-        q2q3 = q2 * q3;
-        q3q3 = q3 * q3;
-
-        sensors.attitude500Hz[ROLL ] = atan2f( 2.0f * (q0q1 + q2q3), q0q0 - q1q1 - q2q2 + q3q3 );
-		sensors.attitude500Hz[PITCH] = -asinf( 2.0f * (q1q3 - q0q2) );
-		sensors.attitude500Hz[YAW  ] = atan2f( 2.0f * (q1q2 + q0q3), q0q0 + q1q1 - q2q2 - q3q3 );
-
-		heading.mag = sensors.attitude500Hz[YAW];
-		heading.tru = standardRadianFormat(heading.mag + eepromConfig.magVar);
+        // rotate by the delta angle plus the correction rates over the period, renormalised
+        q[0] = ahrs->q0;
+        q[1] = ahrs->q1;
+        q[2] = ahrs->q2;
+        q[3] = ahrs->q3;
+
+        rotateQuaternion(q, deltaAngle[ROLL ] + gx * dt, deltaAngle[PITCH] + gy * dt, deltaAngle[YAW  ] + gz * dt);
+
+        ahrs->q0 = q[0];
+        ahrs->q1 = q[1];
+        ahrs->q2 = q[2];
+        ahrs->q3 = q[3];
+
+        updateProducts(ahrs);
+    }
+}
+
+//====================================================================================================
+// Set Quaternion, any instance
+//====================================================================================================
+
+void MargAHRSsetQuaternion(margAHRS_t *ahrs, const float q[4])
+{
+    ahrs->q0 = q[0];
+    ahrs->q1 = q[1];
+    ahrs->q2 = q[2];
+    ahrs->q3 = q[3];
+
+    updateProducts(ahrs);
+
+    ahrs->initialized = true;
+}
+
+//====================================================================================================
+// Euler Angles, any instance
+//====================================================================================================
+
+const float *MargAHRSattitude(margAHRS_t *ahrs)
+{
+    if (ahrs->attitudeGeneration != ahrs->generation)
+    {
+        ahrs->attitude[ROLL ] = fastAtan2f( 2.0f * (ahrs->q0q1 + ahrs->q2q3), ahrs->q0q0 - ahrs->q1q1 - ahrs->q2q2 + ahrs->q3q3 );
+		ahrs->attitude[PITCH] = -fastAsinf( 2.0f * (ahrs->q1q3 - ahrs->q0q2) );
+		ahrs->attitude[YAW  ] = fastAtan2f( 2.0f * (ahrs->q1q2 + ahrs->q0q3), ahrs->q0q0 + ahrs->q1q1 - ahrs->q2q2 - ahrs->q3q3 );
+
+		ahrs->attitudeGeneration = ahrs->generation;
+    }
+
+    return ahrs->attitude;
+}
+
+//====================================================================================================
+// Rotation Matrix, any instance
+//====================================================================================================
+
+const float *MargAHRSrotationMatrix(margAHRS_t *ahrs)
+{
+    if (ahrs->matrixGeneration != ahrs->generation)
+    {
+        quaternionToRotationMatrix(ahrs, ahrs->matrix);
+
+        ahrs->matrixGeneration = ahrs->generation;
+    }
+
+    return ahrs->matrix;
+}
+
+//====================================================================================================
+// Function, flight code instance
+//====================================================================================================
+
+void MargAHRSupdate(const float deltaAngle[3],
+                    float ax, float ay, float az,
+                    float mx, float my, float mz,
+                    float accelCutoff, uint8_t magDataUpdate, float dt)
+{
+    // Gains are picked up every pass so CLI changes apply right away
+
+    if (eepromConfig.attitudeEstimator == ATTITUDE_EKF)
+    {
+        // The EKF publishes through the margAHRS quaternion so every
+        // attitude accessor works the same with either estimator
+
+        attitudeEKF.gyroNoise     = eepromConfig.ekfGyroNoise;
+        attitudeEKF.gyroBiasNoise = eepromConfig.ekfGyroBiasNoise;
+        attitudeEKF.accelNoise    = eepromConfig.ekfAccelNoise;
+        attitudeEKF.headingNoise  = eepromConfig.ekfHeadingNoise;
+
+        attitudeEKFupdate(&attitudeEKF, deltaAngle, ax, ay, az, mx, my, mz, magDataUpdate, dt);
+
+        if (attitudeEKF.initialized == true)
+            MargAHRSsetQuaternion(&margAHRS, attitudeEKF.q);
+
+        return;
     }
+
+    margAHRS.KpAcc              = eepromConfig.KpAcc;
+    margAHRS.KiAcc              = eepromConfig.KiAcc;
+    margAHRS.KpMag              = eepromConfig.KpMag;
+    margAHRS.KiMag              = eepromConfig.KiMag;
+    margAHRS.accConfidenceDecay = accConfidenceDecay;
+
+    MargAHRSupdateInstance(&margAHRS, deltaAngle, ax, ay, az, mx, my, mz, magDataUpdate, dt);
+}
+
+//====================================================================================================
+// Flight code instance accessors
+//====================================================================================================
+
+void getQuaternion(float q[4])
+{
+    q[0] = margAHRS.q0;
+    q[1] = margAHRS.q1;
+    q[2] = margAHRS.q2;
+    q[3] = margAHRS.q3;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+const float *getAttitude(void)
+{
+    return MargAHRSattitude(&margAHRS);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+// Heading reads zero until the filter has been initialized from the magnetometer
+
+const heading_t *getHeading(void)
+{
+    if (headingGeneration != margAHRS.generation)
+    {
+        if (margAHRS.initialized == true)
+        {
+            heading.mag = MargAHRSattitude(&margAHRS)[YAW];
+            heading.tru = standardRadianFormat(heading.mag + eepromConfig.magVar);
+        }
+        else
+        {
+            heading.mag = 0.0f;
+            heading.tru = 0.0f;
+        }
+
+        headingGeneration = margAHRS.generation;
+    }
+
+    return &heading;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+const float *getRotationMatrix(void)
+{
+    return MargAHRSrotationMatrix(&margAHRS);
 }
 
 //====================================================================================================
@@ -15,26 +15,81 @@
 #pragma once
 
 //----------------------------------------------------------------------------------------------------
-// Variable declaration
+// Type declaration
 
-extern float accConfidenceDecay;
+typedef struct margAHRS_t
+{
+    // Gains
+    float KpAcc, KiAcc;
+    float KpMag, KiMag;
+    float accConfidenceDecay;
+
+    // quaternion elements representing the estimated orientation
+    float q0, q1, q2, q3;
+
+    // auxiliary variables to reduce number of repeated operations
+    float q0q0, q0q1, q0q2, q0q3;
+    float q1q1, q1q2, q1q3;
+    float q2q2, q2q3;
+    float q3q3;
+
+    float exAccInt, eyAccInt, ezAccInt;  // accel integral error
+    float exMagInt, eyMagInt, ezMagInt;  // mag integral error
+
+    float accMagP;
+    float accConfidence;
+
+    uint8_t initialized;
+
+    // derived representations, rebuilt on first read after an update
+    uint32_t generation;                 // bumped by every change to q0..q3
+    uint32_t attitudeGeneration;
+    uint32_t matrixGeneration;
+
+    float attitude[3];                   // roll, pitch, magnetic heading
+    float matrix[9];                     // body to earth, row major
+} margAHRS_t;
+
+//----------------------------------------------------------------------------------------------------
+// Variable declaration
 
-extern float q0, q1, q2, q3;  // quaternion elements representing the estimated orientation
+extern margAHRS_t margAHRS;
 
-// auxiliary variables to reduce number of repeated operations
-extern float q0q0, q0q1, q0q2, q0q3;
-extern float q1q1, q1q2, q1q3;
-extern float q2q2, q2q3;
-extern float q3q3;
+extern float accConfidenceDecay;
 
 //---------------------------------------------------------------------------------------------------
 // Function declaration
 
-void MargAHRSupdate(float gx, float gy, float gz,
+void MargAHRSreset(margAHRS_t *ahrs);
+
+void MargAHRSupdateInstance(margAHRS_t *ahrs,
+                            const float deltaAngle[3],
+                            float ax, float ay, float az,
+                            float mx, float my, float mz,
+                            uint8_t magDataUpdate, float dt);
+
+void MargAHRSupdate(const float deltaAngle[3],
                     float ax, float ay, float az,
                     float mx, float my, float mz,
                     float accelCutoff, uint8_t magDataUpdate, float dt);
 
+void MargAHRSsetQuaternion(margAHRS_t *ahrs, const float q[4]);
+
+const float *MargAHRSattitude(margAHRS_t *ahrs);
+
+const float *MargAHRSrotationMatrix(margAHRS_t *ahrs);
+
+//----------------------------------------------------------------------------------------------------
+// Flight code instance accessors, nothing is computed until a representation is asked for
+
+void getQuaternion(float q[4]);
+
+const float *getAttitude(void);          // roll, pitch, magnetic heading, radians
+
+const heading_t *getHeading(void);
+
+const float *getRotationMatrix(void);
+
 //=====================================================================================================
 // End of file
 //=====================================================================================================
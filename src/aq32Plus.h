@@ -65,6 +65,8 @@
 #define AUX3     6
 #define AUX4     7
 
+#define NUMBER_OF_RC_CHANNELS  16  // Mapped receiver channels, AUX4 is followed by 8 more
+
 #define XAXIS    0
 #define YAXIS    1
 #define ZAXIS    2
@@ -109,8 +111,8 @@ typedef struct sensors_t
 {
     float    accel500Hz[3];
     float    accel100Hz[3];
-    float    attitude500Hz[3];
     float    gyro500Hz[3];
+    float    deltaAngle500Hz[3];        // Coning compensated rotation vector of the 1 kHz samples, radians
     float    mag10Hz[3];
     float    pressureAlt50Hz;
 
@@ -127,6 +129,13 @@ typedef struct sensors_t
     uint32_t gpsDate;
     float    gpsTime;
     float    gpsHdop;
+
+    uint64_t imu500HzTimestamp;         // micros64() at acquisition of the newest sample used
+    uint64_t imu100HzTimestamp;
+    uint64_t mag10HzTimestamp;
+    uint64_t pressureAlt50HzTimestamp;
+    uint64_t gpsTimestamp;
+    uint64_t rxTimestamp;
 } sensors_t;
 
 extern sensors_t sensors;
@@ -137,8 +146,6 @@ typedef struct heading_t
 	float    tru;
 } heading_t;
 
-extern heading_t heading;
-
 ///////////////////////////////////////////////////////////////////////////////
 // PID Definitions
 ///////////////////////////////////////////////////////////////////////////////
@@ -218,11 +225,19 @@ enum { DISENGAGED, ENGAGED, PANIC };
 
 enum { DLPF_256HZ, DLPF_188HZ, DLPF_98HZ, DLPF_42HZ };
 
+///////////////////////////////////////////////////////////////////////////////
+// Attitude Estimators
+///////////////////////////////////////////////////////////////////////////////
+
+enum { MARG_AHRS, ATTITUDE_EKF };
+
 ///////////////////////////////////////////////////////////////////////////////
 // Receiver Configurations
 ///////////////////////////////////////////////////////////////////////////////
 
-enum { NA_RECEIVER, PARALLEL_PWM, SERIAL_PWM, SPEKTRUM };
+enum { NA_RECEIVER, PARALLEL_PWM, SERIAL_PWM, SPEKTRUM, SBUS, SUMD, IBUS };
+
+#define SERIAL_RECEIVER(type) ((type) >= SPEKTRUM)  // Frames on USART3, the rest are timer captures
 
 ///////////////////////////////////////////////////////////////////////////////
 // GPS Receivers
@@ -271,6 +286,34 @@ typedef struct eepromConfig_t
 
     uint8_t dlpfSetting;
 
+    uint8_t mpu6000FifoEnabled;
+
+    uint8_t gyroDecimatorTaps;
+
+    float gyroDecimatorCutoff;
+
+    uint8_t rateLoopEnabled;
+
+    uint8_t attitudeEstimator;
+
+    float ekfGyroNoise;
+
+    float ekfGyroBiasNoise;
+
+    float ekfAccelNoise;
+
+    float ekfHeadingNoise;
+
+    filterSectionConfig_t filters[NUMBER_OF_FILTER_CHAINS][FILTER_SECTIONS];
+
+    uint8_t dynamicNotchEnabled;
+
+    float dynamicNotchMinHz;
+
+    float dynamicNotchMaxHz;
+
+    float dynamicNotchQ;
+
     ///////////////////////////////////
 
     float rateScaling;
@@ -287,8 +330,11 @@ typedef struct eepromConfig_t
     uint8_t spektrumChannels;
     uint8_t spektrumHires;
 
-    uint8_t rcMap[8];
+    uint8_t rcSmoothing;
+
+    uint8_t rcMap[NUMBER_OF_RC_CHANNELS];
 
+    uint8_t escProtocol;
     uint16_t escPwmRate;
     uint16_t servoPwmRate;
 
@@ -358,6 +404,11 @@ typedef struct eepromConfig_t
 
     ///////////////////////////////////
 
+    uint16_t telemBudget;                           // Link bytes per second for the high speed telemetry streams
+    uint16_t telemRate[NUMBER_OF_TELEM_MESSAGES];   // Sends per second, stream n at n - 1
+
+    ///////////////////////////////////
+
     float   magVar;                // + east, - west
 
     ///////////////////////////////////
@@ -0,0 +1,340 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Multiplicative (error state) extended Kalman filter for attitude and gyro
+// bias.  The quaternion is kept as the nominal state and the filter runs on
+// a 6 element error state, the small body axis rotation that takes the
+// nominal attitude to the true one and the gyro bias error.  After each
+// measurement the error is folded back into the quaternion and bias, so
+// the quaternion is never constrained by the covariance.
+//
+// The gyro delta angle drives the prediction.  The accelerometer corrects roll and
+// pitch through the gravity direction, its noise inflated by how far the
+// measured magnitude is from one g.  The magnetometer corrects heading
+// only, as a scalar measurement of the tilt compensated field direction,
+// so magnetic disturbances cannot pull roll and pitch.
+//
+// All matrix work is arm_mat_*_f32 on fixed size arrays in the instance,
+// nothing is allocated and every step runs the same operations.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Attitude EKF Defines and Variables
+///////////////////////////////////////////////////////////////////////////////
+
+#define STATES  ATTITUDE_EKF_STATES
+
+#define INITIAL_ATTITUDE_SIGMA   (10.0f * D2R)
+#define INITIAL_GYRO_BIAS_SIGMA  ( 2.0f * D2R)
+
+attitudeEKF_t attitudeEKF;
+
+///////////////////////////////////////////////////////////////////////////////
+// Apply Correction
+///////////////////////////////////////////////////////////////////////////////
+
+static void applyCorrection(attitudeEKF_t *ekf, const float dx[STATES])
+{
+    rotateQuaternion(ekf->q, dx[0], dx[1], dx[2]);
+
+    ekf->gyroBias[ROLL ] += dx[3];
+    ekf->gyroBias[PITCH] += dx[4];
+    ekf->gyroBias[YAW  ] += dx[5];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Attitude EKF Reset
+///////////////////////////////////////////////////////////////////////////////
+
+void attitudeEKFreset(attitudeEKF_t *ekf)
+{
+    uint8_t index;
+
+    ekf->q[0] = 1.0f;
+    ekf->q[1] = 0.0f;
+    ekf->q[2] = 0.0f;
+    ekf->q[3] = 0.0f;
+
+    ekf->gyroBias[ROLL ] = 0.0f;
+    ekf->gyroBias[PITCH] = 0.0f;
+    ekf->gyroBias[YAW  ] = 0.0f;
+
+    memset(ekf->P, 0, sizeof(ekf->P));
+
+    for (index = 0; index < 3; index++)
+    {
+        ekf->P[ index      * STATES +  index     ] = SQR(INITIAL_ATTITUDE_SIGMA);
+        ekf->P[(index + 3) * STATES + (index + 3)] = SQR(INITIAL_GYRO_BIAS_SIGMA);
+    }
+
+    arm_mat_init_f32(&ekf->PMatrix,    STATES, STATES, ekf->P);
+    arm_mat_init_f32(&ekf->phiMatrix,  STATES, STATES, ekf->phi);
+    arm_mat_init_f32(&ekf->phiTMatrix, STATES, STATES, ekf->phiT);
+    arm_mat_init_f32(&ekf->tempMatrix, STATES, STATES, ekf->temp);
+    arm_mat_init_f32(&ekf->HMatrix,    3, STATES, ekf->H);
+    arm_mat_init_f32(&ekf->HTMatrix,   STATES, 3, ekf->HT);
+    arm_mat_init_f32(&ekf->HPMatrix,   3, STATES, ekf->HP);
+    arm_mat_init_f32(&ekf->SMatrix,    3, 3, ekf->S);
+    arm_mat_init_f32(&ekf->SInvMatrix, 3, 3, ekf->SInv);
+    arm_mat_init_f32(&ekf->KMatrix,    STATES, 3, ekf->K);
+
+    // Only the bias columns of phi and the attitude columns of H are rewritten each step
+
+    memset(ekf->phi, 0, sizeof(ekf->phi));
+    memset(ekf->H,   0, sizeof(ekf->H));
+
+    for (index = 0; index < STATES; index++)
+        ekf->phi[index * STATES + index] = 1.0f;
+
+    ekf->initialized = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Predict
+///////////////////////////////////////////////////////////////////////////////
+
+static void predict(attitudeEKF_t *ekf, const float deltaAngle[3], float dt)
+{
+    float32_t *phi = ekf->phi;
+    float32_t *P   = ekf->P;
+    float     wx, wy, wz;
+    float     attitudeQ, biasQ, average;
+    uint8_t   row, column;
+
+    wx = deltaAngle[ROLL ] - ekf->gyroBias[ROLL ] * dt;
+    wy = deltaAngle[PITCH] - ekf->gyroBias[PITCH] * dt;
+    wz = deltaAngle[YAW  ] - ekf->gyroBias[YAW  ] * dt;
+
+    rotateQuaternion(ekf->q, wx, wy, wz);
+
+    // phi = I + F dt, F = [ -[w x]  -I ]
+    //                     [    0     0 ]
+
+    phi[0 * STATES + 1] =  wz;  phi[0 * STATES + 2] = -wy;  phi[0 * STATES + 3] = -dt;
+    phi[1 * STATES + 0] = -wz;  phi[1 * STATES + 2] =  wx;  phi[1 * STATES + 4] = -dt;
+    phi[2 * STATES + 0] =  wy;  phi[2 * STATES + 1] = -wx;  phi[2 * STATES + 5] = -dt;
+
+    // P = phi P phi' + Q
+
+    arm_mat_mult_f32(&ekf->phiMatrix, &ekf->PMatrix, &ekf->tempMatrix);
+    arm_mat_trans_f32(&ekf->phiMatrix, &ekf->phiTMatrix);
+    arm_mat_mult_f32(&ekf->tempMatrix, &ekf->phiTMatrix, &ekf->PMatrix);
+
+    attitudeQ = SQR(ekf->gyroNoise)     * dt;
+    biasQ     = SQR(ekf->gyroBiasNoise) * dt;
+
+    for (row = 0; row < 3; row++)
+    {
+        P[ row      * STATES +  row     ] += attitudeQ;
+        P[(row + 3) * STATES + (row + 3)] += biasQ;
+    }
+
+    // Keep P symmetric against round off
+
+    for (row = 0; row < STATES; row++)
+    {
+        for (column = row + 1; column < STATES; column++)
+        {
+            average = 0.5f * (P[row * STATES + column] + P[column * STATES + row]);
+
+            P[row * STATES + column] = average;
+            P[column * STATES + row] = average;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Accel Update
+///////////////////////////////////////////////////////////////////////////////
+
+// Measurement is the unit specific force, which at rest is gravity, -z in
+// earth axes, seen in body axes.  H = [ [y x]  0 ] with y the predicted
+// measurement.
+
+static void accelUpdate(attitudeEKF_t *ekf, float ax, float ay, float az, float accelVariance)
+{
+    const float *q = ekf->q;
+    float32_t   *H = ekf->H;
+    float       yx, yy, yz;
+    float       residual[3], dx[STATES];
+    uint8_t     row, column;
+
+    yx = -2.0f * (q[1] * q[3] - q[0] * q[2]);
+    yy = -2.0f * (q[0] * q[1] + q[2] * q[3]);
+    yz = -(q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3]);
+
+    residual[XAXIS] = ax - yx;
+    residual[YAXIS] = ay - yy;
+    residual[ZAXIS] = az - yz;
+
+    H[0 * STATES + 1] = -yz;  H[0 * STATES + 2] =  yy;
+    H[1 * STATES + 0] =  yz;  H[1 * STATES + 2] = -yx;
+    H[2 * STATES + 0] = -yy;  H[2 * STATES + 1] =  yx;
+
+    // S = H P H' + R, K = P H' S^-1, P = P - K H P
+
+    arm_mat_mult_f32(&ekf->HMatrix, &ekf->PMatrix, &ekf->HPMatrix);
+    arm_mat_trans_f32(&ekf->HMatrix, &ekf->HTMatrix);
+    arm_mat_mult_f32(&ekf->HPMatrix, &ekf->HTMatrix, &ekf->SMatrix);
+
+    ekf->S[0] += accelVariance;
+    ekf->S[4] += accelVariance;
+    ekf->S[8] += accelVariance;
+
+    if (arm_mat_inverse_f32(&ekf->SMatrix, &ekf->SInvMatrix) != ARM_MATH_SUCCESS)
+        return;
+
+    arm_mat_trans_f32(&ekf->HPMatrix, &ekf->HTMatrix);             // P H' = (H P)', P is symmetric
+    arm_mat_mult_f32(&ekf->HTMatrix, &ekf->SInvMatrix, &ekf->KMatrix);
+
+    arm_mat_mult_f32(&ekf->KMatrix, &ekf->HPMatrix, &ekf->tempMatrix);
+    arm_mat_sub_f32(&ekf->PMatrix, &ekf->tempMatrix, &ekf->PMatrix);
+
+    for (row = 0; row < STATES; row++)
+    {
+        dx[row] = 0.0f;
+
+        for (column = 0; column < 3; column++)
+            dx[row] += ekf->K[row * 3 + column] * residual[column];
+    }
+
+    applyCorrection(ekf, dx);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Heading Update
+///////////////////////////////////////////////////////////////////////////////
+
+// Measurement is the heading of the magnetometer vector rotated into earth
+// axes, which is zero when the estimate is right.  H is the earth z row of
+// the rotation matrix, so only the heading part of the error is observed.
+// A scalar measurement needs no matrix inverse.
+
+static void headingUpdate(attitudeEKF_t *ekf, float mx, float my, float mz)
+{
+    const float *q = ekf->q;
+    float32_t   *P = ekf->P;
+    float       matrix[9];
+    float       earthX, earthY, residual, s;
+    float       h[3], PHT[STATES], K[STATES], dx[STATES];
+    uint8_t     row, column;
+
+    matrix[0] = q[0] * q[0] + q[1] * q[1] - q[2] * q[2] - q[3] * q[3];
+    matrix[1] = 2.0f * (q[1] * q[2] - q[0] * q[3]);
+    matrix[2] = 2.0f * (q[0] * q[2] + q[1] * q[3]);
+    matrix[3] = 2.0f * (q[1] * q[2] + q[0] * q[3]);
+    matrix[4] = q[0] * q[0] - q[1] * q[1] + q[2] * q[2] - q[3] * q[3];
+    matrix[5] = 2.0f * (q[2] * q[3] - q[0] * q[1]);
+    matrix[6] = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+    matrix[7] = 2.0f * (q[0] * q[1] + q[2] * q[3]);
+    matrix[8] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+
+    earthX = matrix[0] * mx + matrix[1] * my + matrix[2] * mz;
+    earthY = matrix[3] * mx + matrix[4] * my + matrix[5] * mz;
+
+    residual = -fastAtan2f(earthY, earthX);
+
+    h[0] = matrix[6];
+    h[1] = matrix[7];
+    h[2] = matrix[8];
+
+    for (row = 0; row < STATES; row++)
+        PHT[row] = P[row * STATES + 0] * h[0] + P[row * STATES + 1] * h[1] + P[row * STATES + 2] * h[2];
+
+    s = h[0] * PHT[0] + h[1] * PHT[1] + h[2] * PHT[2] + SQR(ekf->headingNoise);
+
+    for (row = 0; row < STATES; row++)
+    {
+        K[row]  = PHT[row] / s;
+        dx[row] = K[row] * residual;
+    }
+
+    for (row = 0; row < STATES; row++)
+        for (column = 0; column < STATES; column++)
+            P[row * STATES + column] -= K[row] * PHT[column];
+
+    applyCorrection(ekf, dx);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Attitude EKF Update
+///////////////////////////////////////////////////////////////////////////////
+
+void attitudeEKFupdate(attitudeEKF_t *ekf,
+                       const float deltaAngle[3],
+                       float ax, float ay, float az,
+                       float mx, float my, float mz,
+                       uint8_t magDataUpdate, float dt)
+{
+    float norm, normR;
+
+    if ((ekf->initialized == false) && (magDataUpdate == true))
+    {
+        const float accel[3] = { ax, ay, az };
+        const float mag[3]   = { mx, my, mz };
+
+        accelMagToQuaternion(accel, mag, ekf->q);
+
+        ekf->initialized = true;
+    }
+
+    if (ekf->initialized == false)
+        return;
+
+    ///////////////////////////////////
+
+    predict(ekf, deltaAngle, dt);
+
+    norm = fastSqrtf(SQR(ax) + SQR(ay) + SQR(az));
+
+    if (norm != 0.0f)
+    {
+        normR = 1.0f / norm;
+
+        accelUpdate(ekf, ax * normR, ay * normR, az * normR,
+                    SQR(ekf->accelNoise) + SQR(norm / accelOneG - 1.0f));
+    }
+
+    norm = fastSqrtf(SQR(mx) + SQR(my) + SQR(mz));
+
+    if ((magDataUpdate == true) && (norm != 0.0f))
+        headingUpdate(ekf, mx, my, mz);
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,110 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+#include "arm_math.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Attitude EKF Defines
+///////////////////////////////////////////////////////////////////////////////
+
+#define ATTITUDE_EKF_STATES  6       // Attitude error, gyro bias
+
+///////////////////////////////////////////////////////////////////////////////
+// Attitude EKF Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+// Every matrix is a fixed size array inside the instance and the arm_matrix
+// instances point into it, so an attitudeEKF_t must not be copied after
+// attitudeEKFreset().
+
+typedef struct attitudeEKF_t
+{
+    // Noise, set before the first update
+    float gyroNoise;                 // Rad/sec/sqrt(Hz)
+    float gyroBiasNoise;             // Rad/sec^2/sqrt(Hz), bias random walk
+    float accelNoise;                // Unit gravity vector, 1 sigma
+    float headingNoise;              // Rad, 1 sigma
+
+    // Nominal state
+    float q[4];                      // Body to earth, q0 scalar
+    float gyroBias[3];               // Rad/sec
+
+    float32_t P[ATTITUDE_EKF_STATES * ATTITUDE_EKF_STATES];
+
+    // Work space
+    float32_t phi[ATTITUDE_EKF_STATES * ATTITUDE_EKF_STATES];
+    float32_t phiT[ATTITUDE_EKF_STATES * ATTITUDE_EKF_STATES];
+    float32_t temp[ATTITUDE_EKF_STATES * ATTITUDE_EKF_STATES];
+    float32_t H[3 * ATTITUDE_EKF_STATES];
+    float32_t HT[ATTITUDE_EKF_STATES * 3];
+    float32_t HP[3 * ATTITUDE_EKF_STATES];
+    float32_t S[3 * 3];
+    float32_t SInv[3 * 3];
+    float32_t K[ATTITUDE_EKF_STATES * 3];
+
+    arm_matrix_instance_f32 PMatrix, phiMatrix, phiTMatrix, tempMatrix;
+    arm_matrix_instance_f32 HMatrix, HTMatrix, HPMatrix, SMatrix, SInvMatrix, KMatrix;
+
+    uint8_t initialized;
+} attitudeEKF_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+extern attitudeEKF_t attitudeEKF;
+
+///////////////////////////////////////////////////////////////////////////////
+// Attitude EKF Reset
+///////////////////////////////////////////////////////////////////////////////
+
+void attitudeEKFreset(attitudeEKF_t *ekf);
+
+///////////////////////////////////////////////////////////////////////////////
+// Attitude EKF Update
+///////////////////////////////////////////////////////////////////////////////
+
+void attitudeEKFupdate(attitudeEKF_t *ekf,
+                       const float deltaAngle[3],
+                       float ax, float ay, float az,
+                       float mx, float my, float mz,
+                       uint8_t magDataUpdate, float dt);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -27,10 +27,10 @@ void batMonMaxLow();
 
 static const thresholds_t thresholds[] =
   {
-    { 3.6, batMonLow  },
-    { 3.5, batMonLow  },
-    { 3.4, batMonVeryLow },
-    { 3.3, batMonMaxLow },
+    { 3.6f, batMonLow  },
+    { 3.5f, batMonLow  },
+    { 3.4f, batMonVeryLow },
+    { 3.3f, batMonMaxLow },
   };
 
 enum
@@ -41,8 +41,8 @@ enum
   };
 
 /* Exp Filter = LPF time const = 0.1 sampletime */
-static const float alpha = 1.0/( 1.0+0.1 );
-static float v_bat_ave = 0.0;
+static const float alpha = 1.0f/( 1.0f+0.1f );
+static float v_bat_ave = 0.0f;
 static int thresholdCount[thresholdsNUM]; /* Will be inited to zero */
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -55,12 +55,12 @@ void batMonTick()
   int i;
 
   v = batteryVoltage() /  /* eepromConfig.*/ batteryNumCells ;
-  if (0.0 == v_bat_ave)
+  if (0.0f == v_bat_ave)
     v_bat_ave = v;
 
-  if (v > 1.0 ) /* There is a battery connected */
+  if (v > 1.0f ) /* There is a battery connected */
     {
-    v_bat_ave = alpha * v_bat_ave + (1.0-alpha) * v;
+    v_bat_ave = alpha * v_bat_ave + (1.0f-alpha) * v;
 
     for ( i = 0 ; i < thresholdsNUM; ++i )
       if (v_bat_ave < thresholds[i].value )
@@ -81,7 +81,7 @@ void batMonLow()
   /* need to do slow beeping here, push back in telem to flash controler
    * lights, etc.
    */
-  evrPush(EVR_BatLow, (int)(v_bat_ave*1000.0));
+  evrPush(EVR_BatLow, (int)(v_bat_ave*1000.0f));
   }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -92,7 +92,7 @@ void batMonVeryLow()
    * lights, etc.
    * User needs to decsend now ...
    */
-  evrPush(EVR_BatVeryLow, (int)(v_bat_ave*1000.0));
+  evrPush(EVR_BatVeryLow, (int)(v_bat_ave*1000.0f));
   }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -102,7 +102,7 @@ void batMonMaxLow()
   {
   /* User isn't listening flyer needs to auto-descend now ....
    */
-  evrPush(EVR_BatMaxLow, (int)(v_bat_ave*1000.0));
+  evrPush(EVR_BatMaxLow, (int)(v_bat_ave*1000.0f));
 
   // Maybe do something more interesting like auto-descent or hover-hold.
   // armed = false;
@@ -47,7 +47,6 @@
 //#define MPU_ACCEL
 #define MXR_ACCEL
 
-#define TELEM_PRINT 1
 #define TELEM_LOG   0
 
 ///////////////////////////////////////
@@ -110,7 +109,18 @@
 
 /////////////////////////////////////////////////////////////////////////////
 
+#include "dshot.h"
+#include "escProtocol.h"
+#include "filterBank.h"
 #include "pid.h"
+#include "rcSmoothing.h"
+#include "rxFrame.h"
+#include "telemFrame.h"
+#include "telemMessages.h"
+#include "telemScheduler.h"
+#include "timebase.h"
+#include "txRing.h"
+#include "workQueue.h"
 
 #include "aq32Plus.h"
 
@@ -121,7 +131,7 @@
 #include "drv_i2c.h"
 #include "drv_led.h"
 #include "drv_max7456.h"
-#include "drv_pwmESC.h"
+#include "drv_pwmEsc.h"
 #include "drv_pwmServo.h"
 #include "drv_rx.h"
 #include "drv_spi.h"
@@ -131,33 +141,42 @@
 #include "drv_timingFunctions.h"
 
 #include "hmc5883.h"
+#include "gyroDecimator.h"
+#include "mpu6000Burst.h"
 #include "mpu6000.h"
 #include "ms5611_I2C.h"
 
 #include "accelCalibration.h"
+#include "attitudeEKF.h"
 #include "batMon.h"
 #include "cli.h"
 #include "cliSupport.h"
 #include "computeAxisCommands.h"
 #include "config.h"
 #include "coordinateTransforms.h"
+#include "dynamicNotch.h"
 #include "escCalibration.h"
 #include "evr.h"
-#include "firstOrderFilter.h"
+#include "fastMath.h"
 #include "flightCommand.h"
 #include "gps.h"
 #include "gpsMediaTek19.h"
 #include "gpsNMEA.h"
 #include "gpsUblox.h"
+#include "highSpeedTelem.h"
 #include "log.h"
 #include "MargAHRS.h"
 #include "magCalibration.h"
 #include "mixer.h"
 #include "mpu6000Calibration.h"
+#include "newlibStubs.h"
 #include "osdWidgets.h"
+#include "rateLoop.h"
 #include "rfTelem.h"
+#include "scheduler.h"
+#include "sensorScaling.h"
 #include "utilities.h"
 #include "vertCompFilter.h"
-#include "watchDogs.h"
+#include "watchdogs.h"
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -47,6 +47,12 @@ char    temp;
 
 void escCalibration(void)
 {
+    if (eepromConfig.escProtocol >= ESC_PROTOCOL_DSHOT150)
+    {
+        cliPrint("\nDShot ESCs have a fixed throttle range, no calibration needed\n\n");
+        return;
+    }
+
     escCalibrating = true;
 
     armed = false;
@@ -67,6 +73,8 @@ void escCalibration(void)
 
     ///////////////////////////////////
 
+    rateLoopStop();  // Keeps the commands from being mixed over
+
     cliPrint("Enter 'h' for Max Command....\n");
     cliPrint("Enter 'm' for Mid Command....\n");
     cliPrint("Enter 'l' for Min Command....\n");
@@ -74,7 +82,8 @@ void escCalibration(void)
 
     while(true)
     {
-		while (cliAvailable() == false);
+		while (cliAvailable() == false)
+			holdMotors(2);  // OneShot ESCs need a pulse train while waiting
 
 		temp = cliRead();
 
@@ -99,6 +108,7 @@ void escCalibration(void)
 			    cliPrint("Applying Min Command, Exiting Calibration....\n\n");
 			    writeAllMotors(MINCOMMAND);
 			    escCalibrating = false;
+			    rateLoopInit();
 			    return;
 			    break;
 		}
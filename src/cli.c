@@ -43,33 +43,6 @@ uint8_t cliBusy = false;
 static volatile uint8_t cliQuery;
 static volatile uint8_t validCliCommand = false;
 
-uint8_t highSpeedTelem1Enabled = false;
-uint8_t highSpeedTelem2Enabled = false;
-uint8_t highSpeedTelem3Enabled = false;
-uint8_t highSpeedTelem4Enabled = false;
-uint8_t highSpeedTelem5Enabled = false;
-uint8_t highSpeedTelem6Enabled = false;
-uint8_t highSpeedTelem7Enabled = false;
-uint8_t highSpeedTelem8Enabled = false;
-uint8_t highSpeedTelem9Enabled = false;
-
-///////////////////////////////////////////////////////////////////////////////
-// High Speed Telem Disable
-///////////////////////////////////////////////////////////////////////////////
-
-void highSpeedTelemDisable(void)
-{
-	highSpeedTelem1Enabled = false;
-	highSpeedTelem2Enabled = false;
-	highSpeedTelem3Enabled = false;
-	highSpeedTelem4Enabled = false;
-	highSpeedTelem5Enabled = false;
-	highSpeedTelem6Enabled = false;
-	highSpeedTelem7Enabled = false;
-	highSpeedTelem8Enabled = false;
-	highSpeedTelem9Enabled = false;
-}
-
 ///////////////////////////////////////////////////////////////////////////////
 // Read Character String from CLI
 ///////////////////////////////////////////////////////////////////////////////
@@ -142,11 +115,12 @@ void readCliPID(unsigned char PIDid)
   pid->I              = readFloatCLI();
   pid->D              = readFloatCLI();
   pid->windupGuard    = readFloatCLI();
-  pid->iTerm          = 0.0f;
-  pid->lastDcalcValue = 0.0f;
-  pid->lastDterm      = 0.0f;
-  pid->lastLastDterm  = 0.0f;
   pid->dErrorCalc     =(uint8_t)readFloatCLI();
+
+  setPIDintegralError(PIDid, 0.0f);
+  setPIDstates(PIDid, 0.0f);
+
+  loadRatePIDs();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -156,6 +130,8 @@ void readCliPID(unsigned char PIDid)
 void cliCom(void)
 {
 	uint8_t  index;
+	uint8_t  bin;
+	task_t   *task;
 
 	if ((cliAvailable() && !validCliCommand))
     	cliQuery = cliRead();
@@ -339,8 +315,8 @@ void cliCom(void)
         case 'k': // Vertical Axis Variables
         	cliPrintF("%9.4f, %9.4f, %9.4f, %9.4f, %4ld\n", earthAxisAccels[ZAXIS],
         			                                        sensors.pressureAlt50Hz,
-        					                                hDotEstimate,
-        					                                hEstimate,
+        					                                vertComp.hDotEstimate,
+        					                                vertComp.hEstimate,
         					                                ms5611Temperature);
         	validCliCommand = false;
         	break;
@@ -348,9 +324,9 @@ void cliCom(void)
         ///////////////////////////////
 
         case 'l': // Attitudes
-        	cliPrintF("%9.4f, %9.4f, %9.4f\n", sensors.attitude500Hz[ROLL ] * R2D,
-        			                           sensors.attitude500Hz[PITCH] * R2D,
-        			                           sensors.attitude500Hz[YAW  ] * R2D);
+        	cliPrintF("%9.4f, %9.4f, %9.4f\n", getAttitude()[ROLL ] * R2D,
+        			                           getAttitude()[PITCH] * R2D,
+        			                           getAttitude()[YAW  ] * R2D);
         	validCliCommand = false;
         	break;
 
@@ -388,14 +364,78 @@ void cliCom(void)
 
         ///////////////////////////////
 
-        case 'o': // Not Used
+        case 'o': // Task Statistics
+            cliPrintF("\nTask    Runs        Overruns  Skipped   Exec Min/Mean/Max (uSec)  Jitter Min/Mean/Max (uSec)\n");
+
+            for (index = 0; index < schedulerNumberOfTasks; index++)
+            {
+                task = &schedulerTasks[index];
+
+                cliPrintF("%-6s  %10ld  %8ld  %8ld  %6ld, %6ld, %6ld      %6ld, %6ld, %6ld\n", task->name,
+                		                                                                      task->stats.runCount,
+                		                                                                      task->stats.overrunCount,
+                		                                                                      task->stats.skippedCount,
+                		                                                                      task->stats.runCount ? task->stats.executionMin : 0,
+                		                                                                      schedulerExecutionMean(task),
+                		                                                                      task->stats.executionMax,
+                		                                                                      task->stats.runCount ? task->stats.jitterMin : 0,
+                		                                                                      schedulerJitterMean(task),
+                		                                                                      task->stats.jitterMax);
+            }
+
+            cliPrintF("\nMax Backlog: %d Tasks\n", schedulerMaxBacklog);
+
+            cliPrintF("\nISR      Count       Exec Min/Mean/Max (uSec)\n");
+            cliPrintF("SysTick  %10ld  %6ld, %6ld, %6ld\n", sysTickTime.count,
+            		                                         sysTickTime.min,
+            		                                         isrTimeMean(&sysTickTime),
+            		                                         sysTickTime.max);
+            cliPrintF("PendSV   %10ld  %6ld, %6ld, %6ld\n", pendSVTime.count,
+            		                                         pendSVTime.min,
+            		                                         isrTimeMean(&pendSVTime),
+            		                                         pendSVTime.max);
+            cliPrintF("RateLp   %10ld  %6ld, %6ld, %6ld\n", rateLoop.executionTime.count,
+            		                                         rateLoop.executionTime.min,
+            		                                         isrTimeMean(&rateLoop.executionTime),
+            		                                         rateLoop.executionTime.max);
+
+            cliPrintF("\nGyro to Motor Latency, %s\n", rateLoop.enabled ? "Rate Loop" : "500 Hz Task");
+            cliPrintF("         %10ld  %6ld, %6ld, %6ld\n", rateLoop.latency.count,
+            		                                         rateLoop.latency.min,
+            		                                         isrTimeMean(&rateLoop.latency),
+            		                                         rateLoop.latency.max);
+
+            cliPrintF("\nWork Queue Max Depth: %d, Dropped: %ld\n", systemWorkQueue.maxDepth,
+            		                                                 systemWorkQueue.droppedCount);
+
+            cliPrintF("\nHistograms    <16us  <32us  <64us  <128us  <256us  <512us  <1ms  >=1ms\n");
+
+            for (index = 0; index < schedulerNumberOfTasks; index++)
+            {
+                task = &schedulerTasks[index];
+
+                cliPrintF("%-6s Exec  ", task->name);
+                for (bin = 0; bin < SCHEDULER_HISTOGRAM_BINS; bin++)
+                    cliPrintF("%7ld", task->stats.executionHistogram[bin]);
+
+                cliPrintF("\n%-6s Jit   ", task->name);
+                for (bin = 0; bin < SCHEDULER_HISTOGRAM_BINS; bin++)
+                    cliPrintF("%7ld", task->stats.jitterHistogram[bin]);
+
+                cliPrint("\n");
+            }
+
             cliQuery = 'x';
             validCliCommand = false;
             break;
 
         ///////////////////////////////
 
-        case 'p': // Not Used
+        case 'p': // Reset Task Statistics
+            schedulerResetStats();
+            isrTimeReset();
+            cliPrint("\nTask Statistics Reset....\n");
+
             cliQuery = 'x';
         	validCliCommand = false;
         	break;
@@ -435,20 +475,10 @@ void cliCom(void)
         ///////////////////////////////
 
         case 's': // Raw Receiver Commands
-            if (eepromConfig.receiverType == SPEKTRUM)
-            {
-				for (index = 0; index < eepromConfig.spektrumChannels - 1; index++)
-                     cliPrintF("%4ld, ", spektrumChannelData[index]);
+			for (index = 0; index < rxChannelCount() - 1; index++)
+                cliPrintF("%4i, ", rxRead(index));
 
-                cliPrintF("%4ld\n", spektrumChannelData[eepromConfig.spektrumChannels - 1]);
-            }
-		    else
-		    {
-				for (index = 0; index < 7; index++)
-                    cliPrintF("%4i, ", rxRead(index));
-
-                cliPrintF("%4i\n", rxRead(7));
-            }
+            cliPrintF("%4i\n", rxRead(rxChannelCount() - 1));
 
         	validCliCommand = false;
         	break;
@@ -456,10 +486,10 @@ void cliCom(void)
         ///////////////////////////////
 
         case 't': // Processed Receiver Commands
-            for (index = 0; index < 7; index++)
+            for (index = 0; index < NUMBER_OF_RC_CHANNELS - 1; index++)
                 cliPrintF("%8.2f, ", rxCommand[index]);
 
-            cliPrintF("%8.2f\n", rxCommand[7]);
+            cliPrintF("%8.2f\n", rxCommand[NUMBER_OF_RC_CHANNELS - 1]);
 
             validCliCommand = false;
             break;
@@ -529,8 +559,7 @@ void cliCom(void)
         ///////////////////////////////
 
         case '1': // Turn high speed telemetry 1 on
-        	highSpeedTelemDisable();
-          	highSpeedTelem1Enabled = true;
+        	highSpeedTelemEnable(1, true);
 
         	cliQuery = 'x';
             break;
@@ -538,8 +567,7 @@ void cliCom(void)
         ///////////////////////////////
 
         case '2': // Turn high speed telemetry 2 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem2Enabled = true;
+           	highSpeedTelemEnable(2, true);
 
             cliQuery = 'x';
            	break;
@@ -547,8 +575,7 @@ void cliCom(void)
         ///////////////////////////////
 
         case '3': // Turn high speed telemetry 3 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem3Enabled = true;
+           	highSpeedTelemEnable(3, true);
 
             cliQuery = 'x';
            	break;
@@ -556,8 +583,7 @@ void cliCom(void)
         ///////////////////////////////
 
         case '4': // Turn high speed telemetry 4 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem4Enabled = true;
+           	highSpeedTelemEnable(4, true);
 
             cliQuery = 'x';
            	break;
@@ -565,8 +591,7 @@ void cliCom(void)
         ///////////////////////////////
 
         case '5': // Turn high speed telemetry 5 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem5Enabled = true;
+           	highSpeedTelemEnable(5, true);
 
             cliQuery = 'x';
            	break;
@@ -574,8 +599,7 @@ void cliCom(void)
         ///////////////////////////////
 
         case '6': // Turn high speed telemetry 6 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem6Enabled = true;
+           	highSpeedTelemEnable(6, true);
 
             cliQuery = 'x';
            	break;
@@ -583,8 +607,7 @@ void cliCom(void)
         ///////////////////////////////
 
         case '7': // Turn high speed telemetry 7 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem7Enabled = true;
+           	highSpeedTelemEnable(7, true);
 
             cliQuery = 'x';
            	break;
@@ -592,8 +615,7 @@ void cliCom(void)
         ///////////////////////////////
 
         case '8': // Turn high speed telemetry 8 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem8Enabled = true;
+           	highSpeedTelemEnable(8, true);
 
             cliQuery = 'x';
            	break;
@@ -601,8 +623,7 @@ void cliCom(void)
         ///////////////////////////////
 
         case '9': // Turn high speed telemetry 9 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem9Enabled = true;
+           	highSpeedTelemEnable(9, true);
 
             cliQuery = 'x';
            	break;
@@ -806,7 +827,9 @@ void cliCom(void)
 
         ///////////////////////////////
 
-        case 'T': // Not Used
+        case 'T': // Filter CLI
+            filterCLI();
+
             cliQuery = 'x';
            	validCliCommand = false;
            	break;
@@ -842,7 +865,9 @@ void cliCom(void)
 
         ///////////////////////////////
 
-        case 'X': // Not Used
+        case 'X': // Telemetry CLI
+            telemetryCLI();
+
             cliQuery = 'x';
             validCliCommand = false;
             break;
@@ -892,16 +917,16 @@ void cliCom(void)
    		    cliPrint("\n");
    		    cliPrint("'m' GPS Data                               'M' MAX7456 CLI\n");
    		    cliPrint("'n' GPS Stats                              'N' Mixer CLI\n");
-   		    cliPrint("'o' Not Used                               'O' Receiver CLI\n");
-   		    cliPrint("'p' Not Used                               'P' Sensor CLI\n");
+   		    cliPrint("'o' Task Statistics                        'O' Receiver CLI\n");
+   		    cliPrint("'p' Reset Task Statistics                  'P' Sensor CLI\n");
    		    cliPrint("'q' Not Used                               'Q' GPS CLI\n");
    		    cliPrint("'r' Mode States                            'R' Reset and Enter Bootloader\n");
    		    cliPrint("'s' Raw Receiver Commands                  'S' Reset\n");
-   		    cliPrint("'t' Processed Receiver Commands            'T' Not Used\n");
+   		    cliPrint("'t' Processed Receiver Commands            'T' Filter CLI\n");
    		    cliPrint("'u' Command In Detent Discretes            'U' EEPROM CLI\n");
    		    cliPrint("'v' Motor PWM Outputs                      'V' Reset EEPROM Parameters\n");
    		    cliPrint("'w' Servo PWM Outputs                      'W' Write EEPROM Parameters\n");
-   		    cliPrint("'x' Terminate Serial Communication         'X' Not Used\n");
+   		    cliPrint("'x' Terminate Serial Communication         'X' Telemetry CLI\n");
    		    cliPrint("\n");
 
    		    cliPrint("Press space bar for more, or enter a command....\n");
@@ -917,16 +942,16 @@ void cliCom(void)
    		    cliPrint("\n");
    		    cliPrint("'y' ESC Calibration                        'Y' Not Used\n");
    		    cliPrint("'z' ADC Values                             'Z' Not Used\n");
-   		    cliPrint("'1' High Speed Telemetry 1 Enable\n");
-   		    cliPrint("'2' High Speed Telemetry 2 Enable\n");
-   		    cliPrint("'3' High Speed Telemetry 3 Enable\n");
-   		    cliPrint("'4' High Speed Telemetry 4 Enable\n");
-   		    cliPrint("'5' High Speed Telemetry 5 Enable\n");
-   		    cliPrint("'6' High Speed Telemetry 6 Enable\n");
-   		    cliPrint("'7' High Speed Telemetry 7 Enable\n");
-   		    cliPrint("'8' High Speed Telemetry 8 Enable\n");
-   		    cliPrint("'9' High Speed Telemetry 9 Enable\n");
-   		    cliPrint("'0' High Speed Telemetry Disable           '?' Command Summary\n");
+   		    cliPrint("'1' High Speed Telemetry 1 Enable (Accels)\n");
+   		    cliPrint("'2' High Speed Telemetry 2 Enable (Gyros)\n");
+   		    cliPrint("'3' High Speed Telemetry 3 Enable (Earth Accels)\n");
+   		    cliPrint("'4' High Speed Telemetry 4 Enable (Attitude)\n");
+   		    cliPrint("'5' High Speed Telemetry 5 Enable (Vertical)\n");
+   		    cliPrint("'6' High Speed Telemetry 6 Enable (Sensors)\n");
+   		    cliPrint("'7' High Speed Telemetry 7 Enable (ADC Test)\n");
+   		    cliPrint("'8' High Speed Telemetry 8 Enable (Task Statistics)\n");
+   		    cliPrint("'9' High Speed Telemetry 9 Enable (GPS)\n");
+   		    cliPrint("'0' High Speed Telemetry Disable All       '?' Command Summary\n");
    		    cliPrint("\n");
 
   		    cliQuery = 'x';
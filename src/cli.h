@@ -40,22 +40,6 @@
 
 extern uint8_t cliBusy;
 
-extern uint8_t highSpeedTelem1Enabled;
-extern uint8_t highSpeedTelem2Enabled;
-extern uint8_t highSpeedTelem3Enabled;
-extern uint8_t highSpeedTelem4Enabled;
-extern uint8_t highSpeedTelem5Enabled;
-extern uint8_t highSpeedTelem6Enabled;
-extern uint8_t highSpeedTelem7Enabled;
-extern uint8_t highSpeedTelem8Enabled;
-extern uint8_t highSpeedTelem9Enabled;
-
-///////////////////////////////////////////////////////////////////////////////
-// High Speed Telem Disable
-///////////////////////////////////////////////////////////////////////////////
-
-void highSpeedTelemDisable(void);
-
 ///////////////////////////////////////////////////////////////////////////////
 // Read Float from CLI
 ///////////////////////////////////////////////////////////////////////////////
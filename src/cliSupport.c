@@ -430,6 +430,29 @@ void mixerCLI()
                 }
 
                 cliPrintF("Number of Motors:                  %1d\n",  numberMotor);
+                cliPrint("ESC Protocol:                    ");
+                switch (eepromConfig.escProtocol)
+                {
+                    case ESC_PROTOCOL_PWM:
+                        cliPrint("PWM\n");
+                        break;
+                    case ESC_PROTOCOL_ONESHOT125:
+                        cliPrint("OneShot125\n");
+                        break;
+                    case ESC_PROTOCOL_ONESHOT42:
+                        cliPrint("OneShot42\n");
+                        break;
+                    case ESC_PROTOCOL_DSHOT150:
+                        cliPrint("DShot150\n");
+                        break;
+                    case ESC_PROTOCOL_DSHOT300:
+                        cliPrint("DShot300\n");
+                        break;
+                    case ESC_PROTOCOL_DSHOT600:
+                        cliPrint("DShot600\n");
+                        break;
+                }
+
                 cliPrintF("ESC PWM Rate:                    %3ld\n", eepromConfig.escPwmRate);
                 cliPrintF("Servo PWM Rate:                  %3ld\n", eepromConfig.servoPwmRate);
 
@@ -529,8 +552,10 @@ void mixerCLI()
                 eepromConfig.escPwmRate   = (uint16_t)readFloatCLI();
                 eepromConfig.servoPwmRate = (uint16_t)readFloatCLI();
 
-                pwmEscInit(eepromConfig.escPwmRate);
+                rateLoopStop();  // Keeps motor writes off the timers while they are set up
+                pwmEscInit(eepromConfig.escProtocol, eepromConfig.escPwmRate);
                 pwmServoInit(eepromConfig.servoPwmRate);
+                rateLoopInit();
 
                 mixerQuery = 'a';
                 validQuery = true;
@@ -598,6 +623,7 @@ void mixerCLI()
                 rows    = (uint8_t)readFloatCLI();
                 columns = (uint8_t)readFloatCLI();
                 eepromConfig.freeMix[rows][columns] = readFloatCLI();
+                initMixer();
 
                 mixerQuery = 'b';
                 validQuery = true;
@@ -642,6 +668,7 @@ void mixerCLI()
 
             case 'L': // Read V Tail Angle
         	    eepromConfig.vTailAngle = readFloatCLI();
+        	    initMixer();
 
         	    mixerQuery = 'a';
                 validQuery = true;
@@ -657,6 +684,26 @@ void mixerCLI()
                 	tempFloat = -1.0;
 
                 eepromConfig.yawDirection = tempFloat;
+                initMixer();
+
+                mixerQuery = 'a';
+                validQuery = true;
+                break;
+
+            ///////////////////////////
+
+            case 'N': // Read ESC Protocol
+                tempFloat = readFloatCLI();
+
+                if ((tempFloat >= 0.0f) && (tempFloat < NUMBER_OF_ESC_PROTOCOLS))
+                    eepromConfig.escProtocol = (uint8_t)tempFloat;
+
+                rateLoopStop();
+                pwmEscInit(eepromConfig.escProtocol, eepromConfig.escPwmRate);
+                rateLoopInit();
+
+                if (SERIAL_RECEIVER(eepromConfig.receiverType))
+                    rxInit();  // DShot and the receiver DMA share a stream
 
                 mixerQuery = 'a';
                 validQuery = true;
@@ -686,6 +733,7 @@ void mixerCLI()
    		        cliPrint("                                           'K' Set TriCopter Servo Parameters       KMin;Mid;Max\n");
    		        cliPrint("                                           'L' Set V Tail Angle                     LAngle\n");
    		        cliPrint("                                           'M' Set Yaw Direction                    M1 or M-1\n");
+   		        cliPrint("                                           'N' Set ESC Protocol                     N0 PWM, 1 OS125, 2 OS42, 3/4/5 DShot150/300/600\n");
    		        cliPrint("                                           'W' Write EEPROM Parameters\n");
    		        cliPrint("'x' Exit Sensor CLI                        '?' Command Summary\n");
    		        cliPrint("\n");
@@ -703,7 +751,7 @@ void mixerCLI()
 
 void receiverCLI()
 {
-    char     rcOrderString[9];
+    char     rcOrderString[NUMBER_OF_RC_CHANNELS + 1];
     float    tempFloat;
     uint8_t  index;
     uint8_t  receiverQuery;
@@ -741,18 +789,56 @@ void receiverCLI()
                     case SPEKTRUM:
                         cliPrint("Spektrum\n");
                         break;
+                    case SBUS:
+                        cliPrint("SBUS\n");
+                        break;
+                    case SUMD:
+                        cliPrint("SUMD\n");
+                        break;
+                    case IBUS:
+                        cliPrint("IBUS\n");
+                        break;
 		        }
 
                 cliPrint("Current RC Channel Assignment:  ");
-                for (index = 0; index < 8; index++)
-                    rcOrderString[eepromConfig.rcMap[index]] = rcChannelLetters[index];
+                memset(rcOrderString, '-', NUMBER_OF_RC_CHANNELS);
 
-                rcOrderString[index] = '\0';
+                for (index = 0; index < NUMBER_OF_RC_CHANNELS; index++)
+                    if (eepromConfig.rcMap[index] < NUMBER_OF_RC_CHANNELS)
+                        rcOrderString[eepromConfig.rcMap[index]] = rcChannelLetters[index];
+
+                rcOrderString[NUMBER_OF_RC_CHANNELS] = '\0';
 
                 cliPrint(rcOrderString);  cliPrint("\n");
 
                 cliPrintF("Spektrum Resolution:            %s\n",     eepromConfig.spektrumHires ? "11 Bit Mode" : "10 Bit Mode");
                 cliPrintF("Number of Spektrum Channels:    %2d\n",    eepromConfig.spektrumChannels);
+
+                if (SERIAL_RECEIVER(eepromConfig.receiverType))
+                {
+                    cliPrintF("Frames/Rejects/Failsafe/Lost:   %ld, %ld, %ld, %ld\n", rxStats.frames, rxStats.rejects, rxStats.failsafes, rxStats.lost);
+                    cliPrintF("Frame Interval Min/Mean/Max:    %ld, %ld, %ld uSec\n", (rxStats.frames < 2) ? 0 : rxStats.intervalMin,
+                                                                                      rxFrameIntervalMean(),
+                                                                                      rxStats.intervalMax);
+                }
+
+                cliPrint("RC Smoothing:                   ");
+                switch(eepromConfig.rcSmoothing)
+                {
+                    case RC_SMOOTHING_LINEAR:
+                        cliPrint("Linear Extrapolation\n");
+                        break;
+                    case RC_SMOOTHING_FIRST_ORDER:
+                        cliPrint("First Order\n");
+                        break;
+                    default:
+                        cliPrint("Off\n");
+                        break;
+                }
+
+                cliPrintF("RC Interval/Added Latency:      %5.2f, %5.2f mSec\n", rcSmoothing.interval * 1000.0f,
+                                                                                 rcSmoothingLatency(&rcSmoothing) * 1000.0f);
+
                 cliPrintF("Mid Command:                    %4ld\n",   (uint16_t)eepromConfig.midCommand);
 				cliPrintF("Min Check:                      %4ld\n",   (uint16_t)eepromConfig.minCheck);
 				cliPrintF("Max Check:                      %4ld\n",   (uint16_t)eepromConfig.maxCheck);
@@ -813,7 +899,7 @@ void receiverCLI()
             ///////////////////////////
 
             case 'B': // Read RC Control Order
-                readStringCLI( rcOrderString, 8 );
+                readStringCLI( rcOrderString, NUMBER_OF_RC_CHANNELS );
                 parseRcChannels( rcOrderString );
 
           	    receiverQuery = 'a';
@@ -863,6 +949,17 @@ void receiverCLI()
 
             ///////////////////////////
 
+            case 'G': // Read RC Smoothing
+                eepromConfig.rcSmoothing = (uint8_t)readFloatCLI();
+
+                rcSmoothingInit(&rcSmoothing, eepromConfig.rcSmoothing);
+
+                receiverQuery = 'a';
+                validQuery = true;
+                break;
+
+            ///////////////////////////
+
             case 'W': // Write EEPROM Parameters
                 cliPrint("\nWriting EEPROM Parameters....\n\n");
                 writeEEPROM();
@@ -872,12 +969,13 @@ void receiverCLI()
 
 			case '?':
 			   	cliPrint("\n");
-			   	cliPrint("'a' Receiver Configuration Data            'A' Set RX Input Type                    AX, 1=Parallel, 2=Serial, 3=Spektrum\n");
-   		        cliPrint("'b' Set Maximum Rate Command               'B' Set RC Control Order                 BTAER1234\n");
+			   	cliPrint("'a' Receiver Configuration Data            'A' Set RX Input Type                    AX, 1=Parallel, 2=Serial, 3=Spektrum, 4=SBUS, 5=SUMD, 6=IBUS\n");
+   		        cliPrint("'b' Set Maximum Rate Command               'B' Set RC Control Order                 BTAER123456789abc, Aux 1 thru 9 then a b c\n");
 			   	cliPrint("'c' Set Maximum Attitude Command           'C' Set Spektrum Resolution              C0 or C1\n");
 			   	cliPrint("                                           'D' Set Number of Spektrum Channels      D6 thru D12\n");
 			   	cliPrint("                                           'E' Set RC Control Points                EmidCmd;minChk;maxChk;minThrot;maxThrot\n");
 			   	cliPrint("                                           'F' Set Arm/Disarm Counts                FarmCount;disarmCount\n");
+			   	cliPrint("                                           'G' Set RC Smoothing                     G0 Off, G1 Linear, G2 First Order\n");
 			   	cliPrint("                                           'W' Write EEPROM Parameters\n");
 			   	cliPrint("'x' Exit Receiver CLI                      '?' Command Summary\n");
 			   	cliPrint("\n");
@@ -946,6 +1044,17 @@ void sensorCLI()
                 cliPrintF("hdot est/h est Comp Fil A: %9.4f\n",   eepromConfig.compFilterA);
                 cliPrintF("hdot est/h est Comp Fil B: %9.4f\n",   eepromConfig.compFilterB);
 
+                cliPrint("Attitude Estimator:           ");
+                if (eepromConfig.attitudeEstimator == ATTITUDE_EKF)
+                    cliPrint("EKF\n");
+                else
+                    cliPrint("MARG\n");
+
+                cliPrintF("EKF Gyro/Bias Noise:       %9.4f, %9.4f\n", eepromConfig.ekfGyroNoise,
+                                                                       eepromConfig.ekfGyroBiasNoise);
+                cliPrintF("EKF Accel/Heading Noise:   %9.4f, %9.4f\n", eepromConfig.ekfAccelNoise,
+                                                                       eepromConfig.ekfHeadingNoise);
+
                 cliPrint("MPU6000 DLPF:                 ");
                 switch(eepromConfig.dlpfSetting)
                 {
@@ -963,6 +1072,22 @@ void sensorCLI()
                         break;
                 }
 
+                cliPrint("MPU6000 Gyro FIFO:            ");
+                if (eepromConfig.mpu6000FifoEnabled == true)
+                    cliPrintF("8 kHz, %d Taps, %5.1f Hz Cutoff, %ld Overflows\n", eepromConfig.gyroDecimatorTaps,
+                                                                               eepromConfig.gyroDecimatorCutoff,
+                                                                               mpu6000FifoOverflowCount);
+                else
+                    cliPrint("Disabled\n");
+
+                cliPrintF("MPU6000 Data Stalls:          %ld\n", mpu6000StallCount);
+
+                cliPrint("Rate Loop:                    ");
+                if (rateLoop.enabled == true)
+                    cliPrintF("Each Gyro Sample, %5.1f Hz\n", RATE_LOOP_SAMPLE_RATE);
+                else
+                    cliPrint("500 Hz Task\n");
+
                 cliPrint("Magnetic Variation:           ");
                 if (eepromConfig.magVar >= 0.0f)
                   cliPrintF("E%6.4f\n",  eepromConfig.magVar * R2D);
@@ -1041,14 +1166,7 @@ void sensorCLI()
                      	break;
                 }
 
-                setSPIdivisor(MPU6000_SPI, 64);  // 0.65625 MHz SPI clock (within 20 +/- 10%)
-
-                GPIO_ResetBits(MPU6000_CS_GPIO, MPU6000_CS_PIN);
-			    spiTransfer(MPU6000_SPI, MPU6000_CONFIG);
-			    spiTransfer(MPU6000_SPI, eepromConfig.dlpfSetting);
-			    GPIO_SetBits(MPU6000_CS_GPIO, MPU6000_CS_PIN);
-
-                setSPIdivisor(MPU6000_SPI, 2);  // 21 MHz SPI clock (within 20 +/- 10%)
+                mpu6000ConfigureAcquisition();
 
                 sensorQuery = 'a';
                 validQuery = true;
@@ -1095,6 +1213,34 @@ void sensorCLI()
 
             ///////////////////////////
 
+            case 'F': // MPU6000 Gyro FIFO and Decimator
+                eepromConfig.mpu6000FifoEnabled  = (uint8_t)readFloatCLI();
+                eepromConfig.gyroDecimatorTaps   = (uint8_t)readFloatCLI();
+                eepromConfig.gyroDecimatorCutoff = readFloatCLI();
+
+                mpu6000ConfigureAcquisition();
+
+                sensorQuery = 'a';
+                validQuery = true;
+                break;
+
+            ///////////////////////////
+
+            case 'G': // Attitude Estimator and EKF Noise
+                eepromConfig.attitudeEstimator = (uint8_t)readFloatCLI();
+                eepromConfig.ekfGyroNoise      = readFloatCLI();
+                eepromConfig.ekfGyroBiasNoise  = readFloatCLI();
+                eepromConfig.ekfAccelNoise     = readFloatCLI();
+                eepromConfig.ekfHeadingNoise   = readFloatCLI();
+
+                attitudeEKFreset(&attitudeEKF);
+
+                sensorQuery = 'a';
+                validQuery = true;
+                break;
+
+            ///////////////////////////
+
             case 'M': // Magnetic Variation
                 eepromConfig.magVar = readFloatCLI() * D2R;
 
@@ -1104,6 +1250,20 @@ void sensorCLI()
 
             ///////////////////////////
 
+            case 'R': // Rate Loop on Each Gyro Sample
+                eepromConfig.rateLoopEnabled = ((uint8_t)readFloatCLI() != 0) ? true : false;
+
+                rateLoopStop();
+                filterBankInitChain(GYRO500HZ_FILTER);  // Redesigned for the new rate
+                dynamicNotchInit();
+                rateLoopInit();
+
+                sensorQuery = 'a';
+                validQuery = true;
+                break;
+
+            ///////////////////////////
+
             case 'V': // Set Battery Voltage Divider
                 eepromConfig.batteryVoltageDivider = readFloatCLI();
 
@@ -1127,7 +1287,10 @@ void sensorCLI()
 			   	cliPrint("'c' Magnetometer Calibration               'C' Set kpAcc/kiAcc                      CkpAcc;kiAcc\n");
 			   	cliPrint("'d' Accel Bias and SF Calibraiton          'D' Set kpMag/kiMag                      DkpMag;kiMag\n");
 			   	cliPrint("                                           'E' Set h dot est/h est Comp Filter A/B  EA;B\n");
+			   	cliPrint("                                           'F' Set Gyro FIFO/Decimator              FEnable;Taps;Cutoff\n");
+			   	cliPrint("                                           'G' Set Estimator (0 MARG, 1 EKF)/Noise  GEst;Gyro;Bias;Acc;Hdg\n");
 			   	cliPrint("                                           'M' Set Mag Variation (+ East, - West)   MMagVar\n");
+			   	cliPrint("                                           'R' Set Rate Loop (0 500 Hz, 1 Sample)   REnable\n");
 			   	cliPrint("                                           'V' Set Battery Voltage Divider          VbatVoltDivider\n");
 			   	cliPrint("                                           'W' Write EEPROM Parameters\n");
 			   	cliPrint("'x' Exit Sensor CLI                        '?' Command Summary\n");
@@ -1140,6 +1303,371 @@ void sensorCLI()
 
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Filter CLI
+///////////////////////////////////////////////////////////////////////////////
+
+static const char * const filterChainNames[NUMBER_OF_FILTER_CHAINS] =
+{
+    "500 Hz Gyro        ",
+    "500 Hz Accel       ",
+    "100 Hz Accel       ",
+    "50 Hz Pressure Alt ",
+    "100 Hz Earth Accel ",
+};
+
+static const char * const filterTypeNames[NUMBER_OF_FILTER_TYPES] =
+{
+    "None     ",
+    "Lowpass1 ",
+    "Highpass1",
+    "Lowpass2 ",
+    "Notch    ",
+    "Bandstop ",
+};
+
+///////////////////////////////////////
+
+void filterCLI()
+{
+    filterSectionConfig_t section;
+    float32_t             coefficients[5];
+    uint8_t               axis, chain, index;
+    uint8_t               enabled;
+    float                 minHz, maxHz, q;
+    uint8_t               filterQuery;
+    uint8_t               validQuery = false;
+
+    cliBusy = true;
+
+    cliPrint("\nEntering Filter CLI....\n\n");
+
+    while(true)
+    {
+        cliPrint("Filter CLI -> ");
+
+		while ((cliAvailable() == false) && (validQuery == false));
+
+		if (validQuery == false)
+		    filterQuery = cliRead();
+
+		cliPrint("\n");
+
+		switch(filterQuery)
+		{
+            ///////////////////////////
+
+            case 'a': // Filter Chains
+                cliPrint("\n");
+
+                for (chain = 0; chain < NUMBER_OF_FILTER_CHAINS; chain++)
+                {
+                    cliPrintF("%1d %s%5.1f Hz, %1d Sections\n", chain, filterChainNames[chain],
+                                                              filterChains[chain].sampleRate,
+                                                              filterChains[chain].sections);
+
+                    for (index = 0; index < FILTER_SECTIONS; index++)
+                    {
+                        section = eepromConfig.filters[chain][index];
+
+                        if (section.type == FILTER_NONE)
+                            break;
+
+                        cliPrintF("    %1d %s  %9.4f  %9.4f\n", index,
+                                                                 filterTypeNames[section.type < NUMBER_OF_FILTER_TYPES ? section.type : FILTER_NONE],
+                                                                 section.frequency,
+                                                                 section.parameter);
+                    }
+                }
+
+                cliPrintF("\nDynamic Notch %s, %5.1f to %5.1f Hz, Q %4.1f\n", eepromConfig.dynamicNotchEnabled ? "Enabled" : "Disabled",
+                                                                             eepromConfig.dynamicNotchMinHz,
+                                                                             eepromConfig.dynamicNotchMaxHz,
+                                                                             eepromConfig.dynamicNotchQ);
+
+                if (dynamicNotch.enabled)
+                {
+                    for (axis = 0; axis < 3; axis++)
+                        cliPrintF("    Axis %1d Centers  %6.1f  %6.1f Hz\n", axis, dynamicNotch.center[axis][0],
+                                                                           dynamicNotch.center[axis][1]);
+                }
+
+                cliPrint("\n");
+
+                validQuery = false;
+                break;
+
+            ///////////////////////////
+
+			case 'x':
+			    cliPrint("\nExiting Filter CLI....\n\n");
+			    cliBusy = false;
+			    return;
+			    break;
+
+            ///////////////////////////
+
+            case 'A': // Read Filter Section
+                chain             = (uint8_t)readFloatCLI();
+                index             = (uint8_t)readFloatCLI();
+                section.type      = (uint8_t)readFloatCLI();
+                section.frequency = readFloatCLI();
+                section.parameter = readFloatCLI();
+
+                if ((chain >= NUMBER_OF_FILTER_CHAINS) || (index >= FILTER_SECTIONS))
+                {
+                    cliPrint("\nInvalid Chain or Section....\n\n");
+                }
+                else if ((section.type != FILTER_NONE) &&
+                         (filterSectionDesign(&section, filterChains[chain].sampleRate, coefficients) == false))
+                {
+                    cliPrint("\nSection Cannot Be Realized at This Sample Rate....\n\n");
+                }
+                else
+                {
+                    eepromConfig.filters[chain][index] = section;
+
+                    rateLoopStop();
+                    filterBankInitChain(chain);
+                    rateLoopInit();
+
+                    filterQuery = 'a';
+                    validQuery = true;
+                }
+                break;
+
+            ///////////////////////////
+
+            case 'B': // Clear Filter Chain
+                chain = (uint8_t)readFloatCLI();
+
+                if (chain < NUMBER_OF_FILTER_CHAINS)
+                {
+                    memset(eepromConfig.filters[chain], 0, sizeof(eepromConfig.filters[chain]));
+
+                    rateLoopStop();
+                    filterBankInitChain(chain);
+                    rateLoopInit();
+                }
+
+                filterQuery = 'a';
+                validQuery = true;
+                break;
+
+            ///////////////////////////
+
+            case 'C': // Read Dynamic Notch Parameters
+                enabled = (uint8_t)readFloatCLI();
+                minHz   = readFloatCLI();
+                maxHz   = readFloatCLI();
+                q       = readFloatCLI();
+
+                if ((minHz <= 0.0f) || (minHz >= maxHz) || (maxHz >= 0.5f * dynamicNotch.sampleRate) || (q <= 0.0f))
+                {
+                    cliPrint("\nInvalid Dynamic Notch Range or Q....\n\n");
+                }
+                else
+                {
+                    eepromConfig.dynamicNotchEnabled = enabled ? true : false;
+                    eepromConfig.dynamicNotchMinHz   = minHz;
+                    eepromConfig.dynamicNotchMaxHz   = maxHz;
+                    eepromConfig.dynamicNotchQ       = q;
+
+                    rateLoopStop();
+                    dynamicNotchInit();
+                    rateLoopInit();
+
+                    filterQuery = 'a';
+                    validQuery = true;
+                }
+                break;
+
+            ///////////////////////////
+
+            case 'W': // Write EEPROM Parameters
+                cliPrint("\nWriting EEPROM Parameters....\n\n");
+                writeEEPROM();
+                break;
+
+			///////////////////////////
+
+			case '?':
+			   	cliPrint("\n");
+			   	cliPrint("'a' Display Filter Chains                  'A' Set Filter Section                   AChain;Section;Type;Freq;Param\n");
+			   	cliPrint("                                           'B' Clear Filter Chain                   BChain\n");
+			   	cliPrint("                                           'C' Set Dynamic Notch                    CEnable;MinHz;MaxHz;Q\n");
+			   	cliPrint("                                           'W' Write EEPROM Parameters\n");
+			   	cliPrint("'x' Exit Filter CLI                        '?' Command Summary\n");
+			   	cliPrint("\n");
+			   	cliPrint("Types 0 None, 1 Lowpass1, 2 Highpass1, 3 Lowpass2 (Param Q), 4 Notch (Param Q),\n");
+			   	cliPrint("      5 Bandstop (Freq lower edge, Param upper edge), all in Hz\n");
+			    cliPrint("\n");
+	    	    break;
+
+	    	///////////////////////////
+	    }
+	}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry CLI
+///////////////////////////////////////////////////////////////////////////////
+
+void telemetryCLI()
+{
+    telemStreamSchedule_t *schedule;
+    uint8_t               stream;
+    uint16_t              rate;
+    float                 budget;
+    uint8_t               enable;
+    uint8_t               telemetryQuery;
+    uint8_t               validQuery = false;
+
+    cliBusy = true;
+
+    cliPrint("\nEntering Telemetry CLI....\n\n");
+
+    while(true)
+    {
+        cliPrint("Telemetry CLI -> ");
+
+		while ((cliAvailable() == false) && (validQuery == false));
+
+		if (validQuery == false)
+		    telemetryQuery = cliRead();
+
+		cliPrint("\n");
+
+		switch(telemetryQuery)
+		{
+            ///////////////////////////
+
+            case 'a': // Telemetry Streams
+                cliPrint("\nStream           On   Rate  Granted  Bytes       Sent   Deferred\n");
+
+                for (stream = 1; stream <= NUMBER_OF_TELEM_MESSAGES; stream++)
+                {
+                    schedule = &telemScheduler.stream[stream - 1];
+
+                    cliPrintF("%2d %-12s  %3s  %5d  %7.2f  %5d  %9ld  %9ld\n", stream, highSpeedTelemName(stream),
+                                                                               (highSpeedTelemEnabled & (1UL << (stream - 1))) ? "On" : "Off",
+                                                                               eepromConfig.telemRate[stream - 1],
+                                                                               (float)schedule->granted / 1000.0f,
+                                                                               highSpeedTelemBytes(stream),
+                                                                               schedule->sent,
+                                                                               schedule->deferred);
+                }
+
+                cliPrintF("\nBudget %ld Bytes/Sec, Planned %ld Bytes/Sec\n\n", telemScheduler.budget,
+                                                                              telemScheduler.planned);
+
+                cliPrintF("Transmit Ring %ld Bytes Queued, %ld Bytes Dropped in %ld Writes, Peak %d of %d Bytes\n\n",
+                                                                              telemetryTxRing.written,
+                                                                              telemetryTxRing.dropped,
+                                                                              telemetryTxRing.overflows,
+                                                                              telemetryTxRing.peak,
+                                                                              telemetryTxRing.size);
+
+                validQuery = false;
+                break;
+
+            ///////////////////////////
+
+			case 'x':
+			    cliPrint("\nExiting Telemetry CLI....\n\n");
+			    cliBusy = false;
+			    return;
+			    break;
+
+            ///////////////////////////
+
+            case 'A': // Read Stream Rate
+                stream = (uint8_t)readFloatCLI();
+                rate   = (uint16_t)readFloatCLI();
+
+                if ((stream < 1) || (stream > NUMBER_OF_TELEM_MESSAGES))
+                {
+                    cliPrint("\nInvalid Stream....\n\n");
+                }
+                else
+                {
+                    eepromConfig.telemRate[stream - 1] = rate;
+
+                    highSpeedTelemConfigure();
+
+                    telemetryQuery = 'a';
+                    validQuery = true;
+                }
+                break;
+
+            ///////////////////////////
+
+            case 'B': // Read Bandwidth Budget
+                budget = readFloatCLI();
+
+                if ((budget < 1.0f) || (budget > 65535.0f))
+                {
+                    cliPrint("\nInvalid Budget....\n\n");
+                }
+                else
+                {
+                    eepromConfig.telemBudget = (uint16_t)budget;
+
+                    highSpeedTelemConfigure();
+
+                    telemetryQuery = 'a';
+                    validQuery = true;
+                }
+                break;
+
+            ///////////////////////////
+
+            case 'C': // Read Stream Enable
+                stream = (uint8_t)readFloatCLI();
+                enable = (uint8_t)readFloatCLI();
+
+                if ((stream < 1) || (stream > NUMBER_OF_TELEM_MESSAGES))
+                {
+                    cliPrint("\nInvalid Stream....\n\n");
+                }
+                else
+                {
+                    highSpeedTelemEnable(stream, enable ? true : false);
+
+                    telemetryQuery = 'a';
+                    validQuery = true;
+                }
+                break;
+
+            ///////////////////////////
+
+            case 'W': // Write EEPROM Parameters
+                cliPrint("\nWriting EEPROM Parameters....\n\n");
+                writeEEPROM();
+                break;
+
+			///////////////////////////
+
+			case '?':
+			   	cliPrint("\n");
+			   	cliPrint("'a' Display Telemetry Streams              'A' Set Stream Rate                      AStream;Rate\n");
+			   	cliPrint("                                           'B' Set Bandwidth Budget                 BBytesPerSec\n");
+			   	cliPrint("                                           'C' Set Stream Enable                    CStream;Enable\n");
+			   	cliPrint("                                           'W' Write EEPROM Parameters\n");
+			   	cliPrint("'x' Exit Telemetry CLI                     '?' Command Summary\n");
+			   	cliPrint("\n");
+			   	cliPrint("Rates in Hz up to the 500 Hz telemetry task, lowered evenly when the enabled\n");
+			   	cliPrint("streams need more than the budget.  Enables are not saved to EEPROM.\n");
+			    cliPrint("\n");
+	    	    break;
+
+	    	///////////////////////////
+	    }
+	}
+
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // GPS CLI
 ///////////////////////////////////////////////////////////////////////////////
@@ -1478,9 +2006,6 @@ void eepromCLI()
                 {
                     // check to see if the newly received eeprom config
                     // actually differs from what's in-memory
-                    zeroPIDintegralError();
-                    zeroPIDstates();
-
                     int i;
                     for (i = 0; i < sz; i++)
                         if (((uint8_t*)&e)[i] != ((uint8_t*)&eepromConfig)[i])
@@ -1493,6 +2018,8 @@ void eepromCLI()
                     else
                     {
                         eepromConfig = e;
+                        initMixer();
+                        loadRatePIDs();
                         cliPrintF("In-memory config updated!\n");
                         cliPrintF("NOTE: config not written to EEPROM; use 'W' to do so.\n");
                     }
@@ -60,6 +60,18 @@ void receiverCLI(void);
 
 void sensorCLI(void);
 
+///////////////////////////////////////////////////////////////////////////////
+// Filter CLI
+///////////////////////////////////////////////////////////////////////////////
+
+void filterCLI(void);
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry CLI
+///////////////////////////////////////////////////////////////////////////////
+
+void telemetryCLI(void);
+
 ///////////////////////////////////////////////////////////////////////////////
 // GPS CLI
 ///////////////////////////////////////////////////////////////////////////////
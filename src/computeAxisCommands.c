@@ -56,22 +56,27 @@ uint8_t previousHeadingHoldEngaged = false;
 
 void computeAxisCommands(float dt)
 {
+    const float *attitude;
+    float       rateState[3];
+
     if (flightMode == ATTITUDE)
     {
-        attCmd[ROLL ] = rxCommand[ROLL ] * eepromConfig.attitudeScaling;
-        attCmd[PITCH] = rxCommand[PITCH] * eepromConfig.attitudeScaling;
+        attCmd[ROLL ] = rcSetpoint[ROLL ] * eepromConfig.attitudeScaling;
+        attCmd[PITCH] = rcSetpoint[PITCH] * eepromConfig.attitudeScaling;
     }
 
     if (flightMode >= ATTITUDE)
     {
-        attPID[ROLL]  = updatePID( attCmd[ROLL ],  sensors.attitude500Hz[ROLL ], dt, holdIntegrators, &eepromConfig.PID[ROLL_ATT_PID ] );
-        attPID[PITCH] = updatePID( attCmd[PITCH], -sensors.attitude500Hz[PITCH], dt, holdIntegrators, &eepromConfig.PID[PITCH_ATT_PID] );
+        attitude = getAttitude();
+
+        attPID[ROLL]  = updatePID( attCmd[ROLL ],  attitude[ROLL ], dt, holdIntegrators, ROLL_ATT_PID  );
+        attPID[PITCH] = updatePID( attCmd[PITCH], -attitude[PITCH], dt, holdIntegrators, PITCH_ATT_PID );
     }
 
     if (flightMode == RATE)
     {
-        rateCmd[ROLL ] = rxCommand[ROLL ] * eepromConfig.rateScaling;
-        rateCmd[PITCH] = rxCommand[PITCH] * eepromConfig.rateScaling;
+        rateCmd[ROLL ] = rcSetpoint[ROLL ] * eepromConfig.rateScaling;
+        rateCmd[PITCH] = rcSetpoint[PITCH] * eepromConfig.rateScaling;
     }
     else
     {
@@ -87,13 +92,14 @@ void computeAxisCommands(float dt)
         {
             setPIDintegralError(HEADING_PID, 0.0f);  // First pass heading hold engaged
             setPIDstates(YAW_RATE_PID,       0.0f);
+
+            headingReference = getHeading()->mag;    // Captured here so heading is not computed while hold is off
         }
-        rateCmd[YAW] = updatePID( headingReference, heading.mag, dt, holdIntegrators, &eepromConfig.PID[HEADING_PID] );
+        rateCmd[YAW] = updatePID( headingReference, getHeading()->mag, dt, holdIntegrators, HEADING_PID );
     }
     else  // Heading Hold is OFF
     {
-        rateCmd[YAW] = rxCommand[YAW] * eepromConfig.rateScaling;
-        headingReference = heading.mag;
+        rateCmd[YAW] = rcSetpoint[YAW] * eepromConfig.rateScaling;
     }
 
     if (previousHeadingHoldEngaged == true && headingHoldEngaged ==false)
@@ -106,9 +112,17 @@ void computeAxisCommands(float dt)
 
     ///////////////////////////////////
 
-    axisPID[ROLL ] = updatePID( rateCmd[ROLL ],  sensors.gyro500Hz[ROLL ], dt, holdIntegrators, &eepromConfig.PID[ROLL_RATE_PID ] );
-    axisPID[PITCH] = updatePID( rateCmd[PITCH], -sensors.gyro500Hz[PITCH], dt, holdIntegrators, &eepromConfig.PID[PITCH_RATE_PID] );
-    axisPID[YAW  ] = updatePID( rateCmd[YAW  ],  sensors.gyro500Hz[YAW  ], dt, holdIntegrators, &eepromConfig.PID[YAW_RATE_PID  ] );
+    if (rateLoop.enabled)
+    {
+        rateLoopSetpoint(rateCmd, holdIntegrators);  // Rate PIDs run with each gyro sample
+        return;
+    }
+
+    rateState[ROLL ] =  sensors.gyro500Hz[ROLL ];
+    rateState[PITCH] = -sensors.gyro500Hz[PITCH];
+    rateState[YAW  ] =  sensors.gyro500Hz[YAW  ];
+
+    updateRatePIDs( rateCmd, rateState, dt, holdIntegrators, axisPID );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
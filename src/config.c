@@ -42,11 +42,11 @@
 
 #define FLASH_WRITE_EEPROM_ADDR  0x08004000  // FLASH_Sector_1
 
-const char rcChannelLetters[] = "AERT1234";
+const char rcChannelLetters[] = "AERT123456789abc";  // Aux 10 thru 12 are a, b and c
 
 float vTailThrust;
 
-static uint8_t checkNewEEPROMConf = 1;
+static uint8_t checkNewEEPROMConf = 12;
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -54,7 +54,7 @@ void parseRcChannels(const char *input)
 {
     const char *c, *s;
 
-    for (c = input; *c; c++)
+    for (c = input; *c && (c - input < NUMBER_OF_RC_CHANNELS); c++)
     {
         s = strchr(rcChannelLetters, *c);
         if (s)
@@ -91,17 +91,14 @@ void readEEPROM(void)
 
     eepromConfig.yawDirection = constrain(eepromConfig.yawDirection, -1.0f, 1.0f);
 
-    vTailThrust = sinf(eepromConfig.vTailAngle);
+    initMixer();
+    loadRatePIDs();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 int writeEEPROM(void)
 {
-    // there's no reason to write these values to EEPROM, they'll just be noise
-    zeroPIDintegralError();
-    zeroPIDstates();
-
     FLASH_Status status;
 
     int i;
@@ -135,331 +132,351 @@ int writeEEPROM(void)
     return status;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Set EEPROM Defaults
 ///////////////////////////////////////////////////////////////////////////////
 
-void checkFirstTime(bool eepromReset)
+void setEEPROMDefaults(void)
 {
-    uint8_t test_val;
+    eepromConfig.version = checkNewEEPROMConf;
 
-    test_val = *(uint8_t *)FLASH_WRITE_EEPROM_ADDR;
+    ///////////////////////////////
 
-    if (eepromReset || test_val != checkNewEEPROMConf)
-    {
-		// Default settings
-        eepromConfig.version = checkNewEEPROMConf;
+    eepromConfig.accelTCBiasSlope[XAXIS] = 0.0f;
+    eepromConfig.accelTCBiasSlope[YAXIS] = 0.0f;
+    eepromConfig.accelTCBiasSlope[ZAXIS] = 0.0f;
+
+    ///////////////////////////////
+
+    eepromConfig.accelTCBiasIntercept[XAXIS] = 0.0f;
+    eepromConfig.accelTCBiasIntercept[YAXIS] = 0.0f;
+    eepromConfig.accelTCBiasIntercept[ZAXIS] = 0.0f;
+
+    ///////////////////////////////
+
+    eepromConfig.gyroTCBiasSlope[ROLL ] = 0.0f;
+    eepromConfig.gyroTCBiasSlope[PITCH] = 0.0f;
+    eepromConfig.gyroTCBiasSlope[YAW  ] = 0.0f;
+
+    ///////////////////////////////
+
+    eepromConfig.gyroTCBiasIntercept[ROLL ] = 0.0f;
+    eepromConfig.gyroTCBiasIntercept[PITCH] = 0.0f;
+    eepromConfig.gyroTCBiasIntercept[YAW  ] = 0.0f;
+
+    ///////////////////////////////
+
+    eepromConfig.magBias[XAXIS] = 0.0f;
+    eepromConfig.magBias[YAXIS] = 0.0f;
+    eepromConfig.magBias[ZAXIS] = 0.0f;
+
+	///////////////////////////////
+
+	eepromConfig.accelCutoff = 1.0f;
+
+	///////////////////////////////
+
+    eepromConfig.KpAcc = 5.0f;    // proportional gain governs rate of convergence to accelerometer
+    eepromConfig.KiAcc = 0.0f;    // integral gain governs rate of convergence of gyroscope biases
+    eepromConfig.KpMag = 5.0f;    // proportional gain governs rate of convergence to magnetometer
+    eepromConfig.KiMag = 0.0f;    // integral gain governs rate of convergence of gyroscope biases
+
+    ///////////////////////////////
+
+    eepromConfig.compFilterA =  0.005f;
+	eepromConfig.compFilterB =  0.005f;
+
+    ///////////////////////////////
+
+    eepromConfig.dlpfSetting = BITS_DLPF_CFG_98HZ;
+
+    eepromConfig.mpu6000FifoEnabled  = false;
+    eepromConfig.gyroDecimatorTaps   = 64;     // Least delay meeting the utils/sitl/decimate checks
+    eepromConfig.gyroDecimatorCutoff = 350.0f;
 
-	    ///////////////////////////////
+    eepromConfig.rateLoopEnabled     = false;  // Rate PIDs and motors in the 500 Hz loop
 
-        eepromConfig.accelTCBiasSlope[XAXIS] = 0.0f;
-        eepromConfig.accelTCBiasSlope[YAXIS] = 0.0f;
-        eepromConfig.accelTCBiasSlope[ZAXIS] = 0.0f;
+    ///////////////////////////////
 
-        ///////////////////////////////
+    eepromConfig.attitudeEstimator = MARG_AHRS;
 
-        eepromConfig.accelTCBiasIntercept[XAXIS] = 0.0f;
-        eepromConfig.accelTCBiasIntercept[YAXIS] = 0.0f;
-        eepromConfig.accelTCBiasIntercept[ZAXIS] = 0.0f;
+    eepromConfig.ekfGyroNoise     = 0.001f;    // rad/sec/sqrt(Hz)
+    eepromConfig.ekfGyroBiasNoise = 0.0001f;   // rad/sec^2/sqrt(Hz)
+    eepromConfig.ekfAccelNoise    = 0.5f;      // unit gravity vector, 1 sigma, mostly vibration
+    eepromConfig.ekfHeadingNoise  = 0.2f;      // rad, 1 sigma
 
-        ///////////////////////////////
+    ///////////////////////////////
 
-        eepromConfig.gyroTCBiasSlope[ROLL ] = 0.0f;
-        eepromConfig.gyroTCBiasSlope[PITCH] = 0.0f;
-        eepromConfig.gyroTCBiasSlope[YAW  ] = 0.0f;
+    // The first order sections match the previous fixed filters, 50 ms time
+    // constants on the accels and baro, 4 s on the earth axis high pass.
+    // The rate loop gyros are not filtered.
 
-	    ///////////////////////////////
+    memset(eepromConfig.filters, 0, sizeof(eepromConfig.filters));
 
-	    eepromConfig.gyroTCBiasIntercept[ROLL ] = 0.0f;
-	    eepromConfig.gyroTCBiasIntercept[PITCH] = 0.0f;
-	    eepromConfig.gyroTCBiasIntercept[YAW  ] = 0.0f;
+    eepromConfig.filters[ACCEL500HZ_FILTER][0].type            = FILTER_LOWPASS1;
+    eepromConfig.filters[ACCEL500HZ_FILTER][0].frequency       = 3.183f;   // Hz, 1 / (2 pi 0.05 s)
 
-	    ///////////////////////////////
+    eepromConfig.filters[ACCEL100HZ_FILTER][0].type            = FILTER_LOWPASS1;
+    eepromConfig.filters[ACCEL100HZ_FILTER][0].frequency       = 3.183f;
 
-	    eepromConfig.magBias[XAXIS] = 0.0f;
-	    eepromConfig.magBias[YAXIS] = 0.0f;
-	    eepromConfig.magBias[ZAXIS] = 0.0f;
+    eepromConfig.filters[PRESSURE_ALT50HZ_FILTER][0].type      = FILTER_LOWPASS1;
+    eepromConfig.filters[PRESSURE_ALT50HZ_FILTER][0].frequency = 3.183f;
 
-		///////////////////////////////
+    eepromConfig.filters[EARTH_ACCEL100HZ_FILTER][0].type      = FILTER_HIGHPASS1;
+    eepromConfig.filters[EARTH_ACCEL100HZ_FILTER][0].frequency = 0.0398f;  // Hz, 1 / (2 pi 4 s)
 
-		eepromConfig.accelCutoff = 1.0f;
+    eepromConfig.dynamicNotchEnabled = false;  // Tracks motor vibration in the rate loop gyros
+    eepromConfig.dynamicNotchMinHz   = 80.0f;
+    eepromConfig.dynamicNotchMaxHz   = 240.0f;  // Below the 250 Hz nyquist of the 500 Hz loop, 500 Hz with the rate loop
+    eepromConfig.dynamicNotchQ       = 3.0f;
 
-		///////////////////////////////
+    ///////////////////////////////////
 
-	    eepromConfig.KpAcc = 5.0f;    // proportional gain governs rate of convergence to accelerometer
-	    eepromConfig.KiAcc = 0.0f;    // integral gain governs rate of convergence of gyroscope biases
-	    eepromConfig.KpMag = 5.0f;    // proportional gain governs rate of convergence to magnetometer
-	    eepromConfig.KiMag = 0.0f;    // integral gain governs rate of convergence of gyroscope biases
-
-	    ///////////////////////////////
-
-	    eepromConfig.compFilterA =  0.005f;
-		eepromConfig.compFilterB =  0.005f;
-
-	    ///////////////////////////////
-
-	    eepromConfig.dlpfSetting = BITS_DLPF_CFG_98HZ;
-
-	    ///////////////////////////////////
-
-        eepromConfig.rateScaling     = 300.0 / 180000.0 * PI;  // Stick to rate scaling for 300 DPS
-
-        eepromConfig.attitudeScaling = 60.0  / 180000.0 * PI;  // Stick to att scaling for 60 degrees
-
-        eepromConfig.nDotEdotScaling = 0.009f;      // Stick to nDot/eDot scaling (9 mps)/(1000 RX PWM Steps) = 0.009
-
-        eepromConfig.hDotScaling     = 0.003f;      // Stick to hDot scaling (3 mps)/(1000 RX PWM Steps) = 0.003
-
-        ///////////////////////////////
-
-	    eepromConfig.receiverType  = PARALLEL_PWM;
-	    eepromConfig.spektrumChannels = 7;
-	    eepromConfig.spektrumHires = 0;
-
-	    parseRcChannels("TAER1234");
-
-	    eepromConfig.escPwmRate   = 450;
-        eepromConfig.servoPwmRate = 50;
-
-        eepromConfig.mixerConfiguration = MIXERTYPE_QUADX;
-        eepromConfig.yawDirection = 1.0f;
-
-        eepromConfig.midCommand   = 3000.0f;
-        eepromConfig.minCheck     = (float)(MINCOMMAND + 200);
-        eepromConfig.maxCheck     = (float)(MAXCOMMAND - 200);
-        eepromConfig.minThrottle  = (float)(MINCOMMAND + 200);
-        eepromConfig.maxThrottle  = (float)(MAXCOMMAND);
-
-        eepromConfig.PID[ROLL_RATE_PID].B               =   1.0f;
-        eepromConfig.PID[ROLL_RATE_PID].P               = 250.0f;
-        eepromConfig.PID[ROLL_RATE_PID].I               = 100.0f;
-        eepromConfig.PID[ROLL_RATE_PID].D               =   0.0f;
-        eepromConfig.PID[ROLL_RATE_PID].iTerm           =   0.0f;
-        eepromConfig.PID[ROLL_RATE_PID].windupGuard     = 100.0f;  // PWMs
-        eepromConfig.PID[ROLL_RATE_PID].lastDcalcValue  =   0.0f;
-        eepromConfig.PID[ROLL_RATE_PID].lastDterm       =   0.0f;
-        eepromConfig.PID[ROLL_RATE_PID].lastLastDterm   =   0.0f;
-        eepromConfig.PID[ROLL_RATE_PID].dErrorCalc      =   D_ERROR;
-        eepromConfig.PID[ROLL_RATE_PID].type            =   OTHER;
-
-        eepromConfig.PID[PITCH_RATE_PID].B              =   1.0f;
-        eepromConfig.PID[PITCH_RATE_PID].P              = 250.0f;
-        eepromConfig.PID[PITCH_RATE_PID].I              = 100.0f;
-        eepromConfig.PID[PITCH_RATE_PID].D              =   0.0f;
-        eepromConfig.PID[PITCH_RATE_PID].iTerm          =   0.0f;
-        eepromConfig.PID[PITCH_RATE_PID].windupGuard    = 100.0f;  // PWMs
-        eepromConfig.PID[PITCH_RATE_PID].lastDcalcValue =   0.0f;
-        eepromConfig.PID[PITCH_RATE_PID].lastDterm      =   0.0f;
-        eepromConfig.PID[PITCH_RATE_PID].lastLastDterm  =   0.0f;
-        eepromConfig.PID[PITCH_RATE_PID].dErrorCalc     =   D_ERROR;
-        eepromConfig.PID[PITCH_RATE_PID].type           =   OTHER;
-
-        eepromConfig.PID[YAW_RATE_PID].B                =   1.0f;
-        eepromConfig.PID[YAW_RATE_PID].P                = 350.0f;
-        eepromConfig.PID[YAW_RATE_PID].I                = 100.0f;
-        eepromConfig.PID[YAW_RATE_PID].D                =   0.0f;
-        eepromConfig.PID[YAW_RATE_PID].iTerm            =   0.0f;
-        eepromConfig.PID[YAW_RATE_PID].windupGuard      = 100.0f;  // PWMs
-        eepromConfig.PID[YAW_RATE_PID].lastDcalcValue   =   0.0f;
-        eepromConfig.PID[YAW_RATE_PID].lastDterm        =   0.0f;
-        eepromConfig.PID[YAW_RATE_PID].lastLastDterm    =   0.0f;
-        eepromConfig.PID[YAW_RATE_PID].dErrorCalc       =   D_ERROR;
-        eepromConfig.PID[YAW_RATE_PID].type             =   OTHER;
-
-        eepromConfig.PID[ROLL_ATT_PID].B                =   1.0f;
-        eepromConfig.PID[ROLL_ATT_PID].P                =   2.0f;
-        eepromConfig.PID[ROLL_ATT_PID].I                =   0.0f;
-        eepromConfig.PID[ROLL_ATT_PID].D                =   0.0f;
-        eepromConfig.PID[ROLL_ATT_PID].iTerm            =   0.0f;
-        eepromConfig.PID[ROLL_ATT_PID].windupGuard      =   0.5f;  // radians/sec
-        eepromConfig.PID[ROLL_ATT_PID].lastDcalcValue   =   0.0f;
-        eepromConfig.PID[ROLL_ATT_PID].lastDterm        =   0.0f;
-        eepromConfig.PID[ROLL_ATT_PID].lastLastDterm    =   0.0f;
-        eepromConfig.PID[ROLL_ATT_PID].dErrorCalc       =   D_ERROR;
-        eepromConfig.PID[ROLL_ATT_PID].type             =   ANGULAR;
-
-        eepromConfig.PID[PITCH_ATT_PID].B               =   1.0f;
-        eepromConfig.PID[PITCH_ATT_PID].P               =   2.0f;
-        eepromConfig.PID[PITCH_ATT_PID].I               =   0.0f;
-        eepromConfig.PID[PITCH_ATT_PID].D               =   0.0f;
-        eepromConfig.PID[PITCH_ATT_PID].iTerm           =   0.0f;
-        eepromConfig.PID[PITCH_ATT_PID].windupGuard     =   0.5f;  // radians/sec
-        eepromConfig.PID[PITCH_ATT_PID].lastDcalcValue  =   0.0f;
-        eepromConfig.PID[PITCH_ATT_PID].lastDterm       =   0.0f;
-        eepromConfig.PID[PITCH_ATT_PID].lastLastDterm   =   0.0f;
-        eepromConfig.PID[PITCH_ATT_PID].dErrorCalc      =   D_ERROR;
-        eepromConfig.PID[PITCH_ATT_PID].type            =   ANGULAR;
-
-        eepromConfig.PID[HEADING_PID].B                 =   1.0f;
-        eepromConfig.PID[HEADING_PID].P                 =   3.0f;
-        eepromConfig.PID[HEADING_PID].I                 =   0.0f;
-        eepromConfig.PID[HEADING_PID].D                 =   0.0f;
-        eepromConfig.PID[HEADING_PID].iTerm             =   0.0f;
-        eepromConfig.PID[HEADING_PID].windupGuard       =   0.5f;  // radians/sec
-        eepromConfig.PID[HEADING_PID].lastDcalcValue    =   0.0f;
-        eepromConfig.PID[HEADING_PID].lastDterm         =   0.0f;
-        eepromConfig.PID[HEADING_PID].lastLastDterm     =   0.0f;
-        eepromConfig.PID[HEADING_PID].dErrorCalc        =   D_ERROR;
-        eepromConfig.PID[HEADING_PID].type              =   ANGULAR;
-
-        eepromConfig.PID[NDOT_PID].B                    =   1.0f;
-        eepromConfig.PID[NDOT_PID].P                    =   3.0f;
-        eepromConfig.PID[NDOT_PID].I                    =   0.0f;
-        eepromConfig.PID[NDOT_PID].D                    =   0.0f;
-        eepromConfig.PID[NDOT_PID].iTerm                =   0.0f;
-        eepromConfig.PID[NDOT_PID].windupGuard          =   0.5f;
-        eepromConfig.PID[NDOT_PID].lastDcalcValue       =   0.0f;
-        eepromConfig.PID[NDOT_PID].lastDterm            =   0.0f;
-        eepromConfig.PID[NDOT_PID].lastLastDterm        =   0.0f;
-        eepromConfig.PID[NDOT_PID].dErrorCalc           =   D_ERROR;
-        eepromConfig.PID[NDOT_PID].type                 =   OTHER;
-
-        eepromConfig.PID[EDOT_PID].B                    =   1.0f;
-        eepromConfig.PID[EDOT_PID].P                    =   3.0f;
-        eepromConfig.PID[EDOT_PID].I                    =   0.0f;
-        eepromConfig.PID[EDOT_PID].D                    =   0.0f;
-        eepromConfig.PID[EDOT_PID].iTerm                =   0.0f;
-        eepromConfig.PID[EDOT_PID].windupGuard          =   0.5f;
-        eepromConfig.PID[EDOT_PID].lastDcalcValue       =   0.0f;
-        eepromConfig.PID[EDOT_PID].lastDterm            =   0.0f;
-        eepromConfig.PID[EDOT_PID].lastLastDterm        =   0.0f;
-        eepromConfig.PID[EDOT_PID].dErrorCalc           =   D_ERROR;
-        eepromConfig.PID[EDOT_PID].type                 =   OTHER;
-
-        eepromConfig.PID[HDOT_PID].B                    =   1.0f;
-        eepromConfig.PID[HDOT_PID].P                    =   2.0f;
-        eepromConfig.PID[HDOT_PID].I                    =   0.0f;
-        eepromConfig.PID[HDOT_PID].D                    =   0.0f;
-        eepromConfig.PID[HDOT_PID].iTerm                =   0.0f;
-        eepromConfig.PID[HDOT_PID].windupGuard          =   5.0f;
-        eepromConfig.PID[HDOT_PID].lastDcalcValue       =   0.0f;
-        eepromConfig.PID[HDOT_PID].lastDterm            =   0.0f;
-        eepromConfig.PID[HDOT_PID].lastLastDterm        =   0.0f;
-        eepromConfig.PID[HDOT_PID].dErrorCalc           =   D_ERROR;
-        eepromConfig.PID[HDOT_PID].type                 =   OTHER;
-
-        eepromConfig.PID[N_PID].B                       =   1.0f;
-        eepromConfig.PID[N_PID].P                       =   3.0f;
-        eepromConfig.PID[N_PID].I                       =   0.0f;
-        eepromConfig.PID[N_PID].D                       =   0.0f;
-        eepromConfig.PID[N_PID].iTerm                   =   0.0f;
-        eepromConfig.PID[N_PID].windupGuard             =   0.5f;
-        eepromConfig.PID[N_PID].lastDcalcValue          =   0.0f;
-        eepromConfig.PID[N_PID].lastDterm               =   0.0f;
-        eepromConfig.PID[N_PID].lastLastDterm           =   0.0f;
-        eepromConfig.PID[N_PID].dErrorCalc              =   D_ERROR;
-        eepromConfig.PID[N_PID].type                    =   OTHER;
-
-        eepromConfig.PID[E_PID].B                       =   1.0f;
-        eepromConfig.PID[E_PID].P                       =   3.0f;
-        eepromConfig.PID[E_PID].I                       =   0.0f;
-        eepromConfig.PID[E_PID].D                       =   0.0f;
-        eepromConfig.PID[E_PID].iTerm                   =   0.0f;
-        eepromConfig.PID[E_PID].windupGuard             =   0.5f;
-        eepromConfig.PID[E_PID].lastDcalcValue          =   0.0f;
-        eepromConfig.PID[E_PID].lastDterm               =   0.0f;
-        eepromConfig.PID[E_PID].lastLastDterm           =   0.0f;
-        eepromConfig.PID[E_PID].dErrorCalc              =   D_ERROR;
-        eepromConfig.PID[E_PID].type                    =   OTHER;
-
-        eepromConfig.PID[H_PID].B                       =   1.0f;
-        eepromConfig.PID[H_PID].P                       =   2.0f;
-        eepromConfig.PID[H_PID].I                       =   0.0f;
-        eepromConfig.PID[H_PID].D                       =   0.0f;
-        eepromConfig.PID[H_PID].iTerm                   =   0.0f;
-        eepromConfig.PID[H_PID].windupGuard             =   5.0f;
-        eepromConfig.PID[H_PID].lastDcalcValue          =   0.0f;
-        eepromConfig.PID[H_PID].lastDterm               =   0.0f;
-        eepromConfig.PID[H_PID].lastLastDterm           =   0.0f;
-        eepromConfig.PID[H_PID].dErrorCalc              =   D_ERROR;
-        eepromConfig.PID[H_PID].type                    =   OTHER;
-
-        eepromConfig.gimbalRollServoMin    = 2000.0f;
-		eepromConfig.gimbalRollServoMid    = 3000.0f;
-		eepromConfig.gimbalRollServoMax    = 4000.0f;
-		eepromConfig.gimbalRollServoGain   = 1.0f;
-
-		eepromConfig.gimbalPitchServoMin   = 2000.0f;
-		eepromConfig.gimbalPitchServoMid   = 3000.0f;
-		eepromConfig.gimbalPitchServoMax   = 4000.0f;
-		eepromConfig.gimbalPitchServoGain  = 1.0f;
-
-        eepromConfig.rollDirectionLeft     = -1.0f;
-        eepromConfig.rollDirectionRight    =  1.0f;
-        eepromConfig.pitchDirectionLeft    = -1.0f;
-        eepromConfig.pitchDirectionRight   =  1.0f;
-
-        eepromConfig.wingLeftMinimum       = 2000.0f;
-        eepromConfig.wingLeftMaximum       = 4000.0f;
-        eepromConfig.wingRightMinimum      = 2000.0f;
-        eepromConfig.wingRightMaximum      = 4000.0f;
-
-        eepromConfig.biLeftServoMin        = 2000.0f;
-        eepromConfig.biLeftServoMid        = 3000.0f;
-        eepromConfig.biLeftServoMax        = 4000.0f;
-
-        eepromConfig.biRightServoMin       = 2000.0f;
-        eepromConfig.biRightServoMid       = 3000.0f;
-        eepromConfig.biRightServoMax       = 4000.0f;
-
-        eepromConfig.triYawServoMin        = 2000.0f;
-        eepromConfig.triYawServoMid        = 3000.0f;
-        eepromConfig.triYawServoMax        = 4000.0f;
-
-        eepromConfig.vTailAngle            = 40.0f;
-
-        // Free Mix Defaults to Quad X
-		eepromConfig.freeMixMotors         = 4;
-
-		eepromConfig.freeMix[0][ROLL ]     =  1.0f;
-        eepromConfig.freeMix[0][PITCH]     = -1.0f;
-        eepromConfig.freeMix[0][YAW  ]     = -1.0f;
-
-        eepromConfig.freeMix[1][ROLL ]     = -1.0f;
-        eepromConfig.freeMix[1][PITCH]     = -1.0f;
-        eepromConfig.freeMix[1][YAW  ]     =  1.0f;
-
-        eepromConfig.freeMix[2][ROLL ]     = -1.0f;
-        eepromConfig.freeMix[2][PITCH]     =  1.0f;
-        eepromConfig.freeMix[2][YAW  ]     = -1.0f;
-
-        eepromConfig.freeMix[3][ROLL ]     =  1.0f;
-        eepromConfig.freeMix[3][PITCH]     =  1.0f;
-        eepromConfig.freeMix[3][YAW  ]     =  1.0f;
-
-        eepromConfig.freeMix[4][ROLL ]     =  0.0f;
-        eepromConfig.freeMix[4][PITCH]     =  0.0f;
-        eepromConfig.freeMix[4][YAW  ]     =  0.0f;
-
-        eepromConfig.freeMix[5][ROLL ]     =  0.0f;
-        eepromConfig.freeMix[5][PITCH]     =  0.0f;
-        eepromConfig.freeMix[5][YAW  ]     =  0.0f;
-
-        eepromConfig.osdEnabled            =  false;
-        eepromConfig.defaultVideoStandard  =  NTSC;
-        eepromConfig.metricUnits           =  false;
-        eepromConfig.osdDisplayAlt         =  true;
-        eepromConfig.osdDisplayAH          =  true;
-        eepromConfig.osdDisplayAtt         =  false;
-        eepromConfig.osdDisplayHdg         =  true;
-
-        eepromConfig.gpsType               =  NO_GPS;
-        eepromConfig.gpsBaudRate           =  38400;
-        eepromConfig.magVar                =  9.033333f * D2R;  // Albuquerque, NM Mag Var 9 degrees 2 minutes (+ East, - West)
-
-        eepromConfig.batteryVoltageDivider = (10.0f + 1.5f) / 1.5f;
-
-        eepromConfig.armCount              = 50;
-        eepromConfig.disarmCount           = 0;
-
-        eepromConfig.accelBiasMXR[XAXIS]        = 2048.0f;
-        eepromConfig.accelBiasMXR[YAXIS]        = 2048.0f;
-        eepromConfig.accelBiasMXR[ZAXIS]        = 2048.0f;
-
-        eepromConfig.accelScaleFactorMXR[XAXIS] = 0.04937965f;  // (3.3 / 4096) / 0.16 * 9.8065
-        eepromConfig.accelScaleFactorMXR[YAXIS] = 0.04937965f;  // (3.3 / 4096) / 0.16 * 9.8065
-        eepromConfig.accelScaleFactorMXR[ZAXIS] = 0.04937965f;  // (3.3 / 4096) / 0.16 * 9.8065
+    eepromConfig.rateScaling     = 300.0 / 180000.0 * PI;  // Stick to rate scaling for 300 DPS
+
+    eepromConfig.attitudeScaling = 60.0  / 180000.0 * PI;  // Stick to att scaling for 60 degrees
+
+    eepromConfig.nDotEdotScaling = 0.009f;      // Stick to nDot/eDot scaling (9 mps)/(1000 RX PWM Steps) = 0.009
+
+    eepromConfig.hDotScaling     = 0.003f;      // Stick to hDot scaling (3 mps)/(1000 RX PWM Steps) = 0.003
+
+    ///////////////////////////////
+
+    eepromConfig.receiverType  = PARALLEL_PWM;
+    eepromConfig.spektrumChannels = 7;
+    eepromConfig.spektrumHires = 0;
+
+    eepromConfig.rcSmoothing   = RC_SMOOTHING_OFF;  // Stick commands held from frame to frame
+
+    parseRcChannels("TAER123456789abc");
+
+    eepromConfig.escProtocol  = ESC_PROTOCOL_PWM;
+    eepromConfig.escPwmRate   = 450;
+    eepromConfig.servoPwmRate = 50;
+
+    eepromConfig.mixerConfiguration = MIXERTYPE_QUADX;
+    eepromConfig.yawDirection = 1.0f;
+
+    eepromConfig.midCommand   = 3000.0f;
+    eepromConfig.minCheck     = (float)(MINCOMMAND + 200);
+    eepromConfig.maxCheck     = (float)(MAXCOMMAND - 200);
+    eepromConfig.minThrottle  = (float)(MINCOMMAND + 200);
+    eepromConfig.maxThrottle  = (float)(MAXCOMMAND);
+
+    eepromConfig.PID[ROLL_RATE_PID].B               =   1.0f;
+    eepromConfig.PID[ROLL_RATE_PID].P               = 250.0f;
+    eepromConfig.PID[ROLL_RATE_PID].I               = 100.0f;
+    eepromConfig.PID[ROLL_RATE_PID].D               =   0.0f;
+    eepromConfig.PID[ROLL_RATE_PID].windupGuard     = 100.0f;  // PWMs
+    eepromConfig.PID[ROLL_RATE_PID].dErrorCalc      =   D_ERROR;
+    eepromConfig.PID[ROLL_RATE_PID].type            =   OTHER;
+
+    eepromConfig.PID[PITCH_RATE_PID].B              =   1.0f;
+    eepromConfig.PID[PITCH_RATE_PID].P              = 250.0f;
+    eepromConfig.PID[PITCH_RATE_PID].I              = 100.0f;
+    eepromConfig.PID[PITCH_RATE_PID].D              =   0.0f;
+    eepromConfig.PID[PITCH_RATE_PID].windupGuard    = 100.0f;  // PWMs
+    eepromConfig.PID[PITCH_RATE_PID].dErrorCalc     =   D_ERROR;
+    eepromConfig.PID[PITCH_RATE_PID].type           =   OTHER;
+
+    eepromConfig.PID[YAW_RATE_PID].B                =   1.0f;
+    eepromConfig.PID[YAW_RATE_PID].P                = 350.0f;
+    eepromConfig.PID[YAW_RATE_PID].I                = 100.0f;
+    eepromConfig.PID[YAW_RATE_PID].D                =   0.0f;
+    eepromConfig.PID[YAW_RATE_PID].windupGuard      = 100.0f;  // PWMs
+    eepromConfig.PID[YAW_RATE_PID].dErrorCalc       =   D_ERROR;
+    eepromConfig.PID[YAW_RATE_PID].type             =   OTHER;
+
+    eepromConfig.PID[ROLL_ATT_PID].B                =   1.0f;
+    eepromConfig.PID[ROLL_ATT_PID].P                =   2.0f;
+    eepromConfig.PID[ROLL_ATT_PID].I                =   0.0f;
+    eepromConfig.PID[ROLL_ATT_PID].D                =   0.0f;
+    eepromConfig.PID[ROLL_ATT_PID].windupGuard      =   0.5f;  // radians/sec
+    eepromConfig.PID[ROLL_ATT_PID].dErrorCalc       =   D_ERROR;
+    eepromConfig.PID[ROLL_ATT_PID].type             =   ANGULAR;
+
+    eepromConfig.PID[PITCH_ATT_PID].B               =   1.0f;
+    eepromConfig.PID[PITCH_ATT_PID].P               =   2.0f;
+    eepromConfig.PID[PITCH_ATT_PID].I               =   0.0f;
+    eepromConfig.PID[PITCH_ATT_PID].D               =   0.0f;
+    eepromConfig.PID[PITCH_ATT_PID].windupGuard     =   0.5f;  // radians/sec
+    eepromConfig.PID[PITCH_ATT_PID].dErrorCalc      =   D_ERROR;
+    eepromConfig.PID[PITCH_ATT_PID].type            =   ANGULAR;
+
+    eepromConfig.PID[HEADING_PID].B                 =   1.0f;
+    eepromConfig.PID[HEADING_PID].P                 =   3.0f;
+    eepromConfig.PID[HEADING_PID].I                 =   0.0f;
+    eepromConfig.PID[HEADING_PID].D                 =   0.0f;
+    eepromConfig.PID[HEADING_PID].windupGuard       =   0.5f;  // radians/sec
+    eepromConfig.PID[HEADING_PID].dErrorCalc        =   D_ERROR;
+    eepromConfig.PID[HEADING_PID].type              =   ANGULAR;
+
+    eepromConfig.PID[NDOT_PID].B                    =   1.0f;
+    eepromConfig.PID[NDOT_PID].P                    =   3.0f;
+    eepromConfig.PID[NDOT_PID].I                    =   0.0f;
+    eepromConfig.PID[NDOT_PID].D                    =   0.0f;
+    eepromConfig.PID[NDOT_PID].windupGuard          =   0.5f;
+    eepromConfig.PID[NDOT_PID].dErrorCalc           =   D_ERROR;
+    eepromConfig.PID[NDOT_PID].type                 =   OTHER;
+
+    eepromConfig.PID[EDOT_PID].B                    =   1.0f;
+    eepromConfig.PID[EDOT_PID].P                    =   3.0f;
+    eepromConfig.PID[EDOT_PID].I                    =   0.0f;
+    eepromConfig.PID[EDOT_PID].D                    =   0.0f;
+    eepromConfig.PID[EDOT_PID].windupGuard          =   0.5f;
+    eepromConfig.PID[EDOT_PID].dErrorCalc           =   D_ERROR;
+    eepromConfig.PID[EDOT_PID].type                 =   OTHER;
+
+    eepromConfig.PID[HDOT_PID].B                    =   1.0f;
+    eepromConfig.PID[HDOT_PID].P                    =   2.0f;
+    eepromConfig.PID[HDOT_PID].I                    =   0.0f;
+    eepromConfig.PID[HDOT_PID].D                    =   0.0f;
+    eepromConfig.PID[HDOT_PID].windupGuard          =   5.0f;
+    eepromConfig.PID[HDOT_PID].dErrorCalc           =   D_ERROR;
+    eepromConfig.PID[HDOT_PID].type                 =   OTHER;
+
+    eepromConfig.PID[N_PID].B                       =   1.0f;
+    eepromConfig.PID[N_PID].P                       =   3.0f;
+    eepromConfig.PID[N_PID].I                       =   0.0f;
+    eepromConfig.PID[N_PID].D                       =   0.0f;
+    eepromConfig.PID[N_PID].windupGuard             =   0.5f;
+    eepromConfig.PID[N_PID].dErrorCalc              =   D_ERROR;
+    eepromConfig.PID[N_PID].type                    =   OTHER;
+
+    eepromConfig.PID[E_PID].B                       =   1.0f;
+    eepromConfig.PID[E_PID].P                       =   3.0f;
+    eepromConfig.PID[E_PID].I                       =   0.0f;
+    eepromConfig.PID[E_PID].D                       =   0.0f;
+    eepromConfig.PID[E_PID].windupGuard             =   0.5f;
+    eepromConfig.PID[E_PID].dErrorCalc              =   D_ERROR;
+    eepromConfig.PID[E_PID].type                    =   OTHER;
+
+    eepromConfig.PID[H_PID].B                       =   1.0f;
+    eepromConfig.PID[H_PID].P                       =   2.0f;
+    eepromConfig.PID[H_PID].I                       =   0.0f;
+    eepromConfig.PID[H_PID].D                       =   0.0f;
+    eepromConfig.PID[H_PID].windupGuard             =   5.0f;
+    eepromConfig.PID[H_PID].dErrorCalc              =   D_ERROR;
+    eepromConfig.PID[H_PID].type                    =   OTHER;
+
+    eepromConfig.gimbalRollServoMin    = 2000.0f;
+	eepromConfig.gimbalRollServoMid    = 3000.0f;
+	eepromConfig.gimbalRollServoMax    = 4000.0f;
+	eepromConfig.gimbalRollServoGain   = 1.0f;
+
+	eepromConfig.gimbalPitchServoMin   = 2000.0f;
+	eepromConfig.gimbalPitchServoMid   = 3000.0f;
+	eepromConfig.gimbalPitchServoMax   = 4000.0f;
+	eepromConfig.gimbalPitchServoGain  = 1.0f;
+
+    eepromConfig.rollDirectionLeft     = -1.0f;
+    eepromConfig.rollDirectionRight    =  1.0f;
+    eepromConfig.pitchDirectionLeft    = -1.0f;
+    eepromConfig.pitchDirectionRight   =  1.0f;
+
+    eepromConfig.wingLeftMinimum       = 2000.0f;
+    eepromConfig.wingLeftMaximum       = 4000.0f;
+    eepromConfig.wingRightMinimum      = 2000.0f;
+    eepromConfig.wingRightMaximum      = 4000.0f;
+
+    eepromConfig.biLeftServoMin        = 2000.0f;
+    eepromConfig.biLeftServoMid        = 3000.0f;
+    eepromConfig.biLeftServoMax        = 4000.0f;
+
+    eepromConfig.biRightServoMin       = 2000.0f;
+    eepromConfig.biRightServoMid       = 3000.0f;
+    eepromConfig.biRightServoMax       = 4000.0f;
+
+    eepromConfig.triYawServoMin        = 2000.0f;
+    eepromConfig.triYawServoMid        = 3000.0f;
+    eepromConfig.triYawServoMax        = 4000.0f;
+
+    eepromConfig.vTailAngle            = 40.0f;
+
+    // Free Mix Defaults to Quad X
+	eepromConfig.freeMixMotors         = 4;
+
+	eepromConfig.freeMix[0][ROLL ]     =  1.0f;
+    eepromConfig.freeMix[0][PITCH]     = -1.0f;
+    eepromConfig.freeMix[0][YAW  ]     = -1.0f;
+
+    eepromConfig.freeMix[1][ROLL ]     = -1.0f;
+    eepromConfig.freeMix[1][PITCH]     = -1.0f;
+    eepromConfig.freeMix[1][YAW  ]     =  1.0f;
+
+    eepromConfig.freeMix[2][ROLL ]     = -1.0f;
+    eepromConfig.freeMix[2][PITCH]     =  1.0f;
+    eepromConfig.freeMix[2][YAW  ]     = -1.0f;
+
+    eepromConfig.freeMix[3][ROLL ]     =  1.0f;
+    eepromConfig.freeMix[3][PITCH]     =  1.0f;
+    eepromConfig.freeMix[3][YAW  ]     =  1.0f;
+
+    eepromConfig.freeMix[4][ROLL ]     =  0.0f;
+    eepromConfig.freeMix[4][PITCH]     =  0.0f;
+    eepromConfig.freeMix[4][YAW  ]     =  0.0f;
+
+    eepromConfig.freeMix[5][ROLL ]     =  0.0f;
+    eepromConfig.freeMix[5][PITCH]     =  0.0f;
+    eepromConfig.freeMix[5][YAW  ]     =  0.0f;
+
+    eepromConfig.osdEnabled            =  false;
+    eepromConfig.defaultVideoStandard  =  NTSC;
+    eepromConfig.metricUnits           =  false;
+    eepromConfig.osdDisplayAlt         =  true;
+    eepromConfig.osdDisplayAH          =  true;
+    eepromConfig.osdDisplayAtt         =  false;
+    eepromConfig.osdDisplayHdg         =  true;
+
+    eepromConfig.gpsType               =  NO_GPS;
+    eepromConfig.gpsBaudRate           =  38400;
+
+    eepromConfig.telemBudget           =  10000;  // Of the 11520 bytes/s at 115200 baud, the rest left for CLI and EVR text
+
+    eepromConfig.telemRate[TELEM_ACCELS       - 1] = 100;
+    eepromConfig.telemRate[TELEM_GYROS        - 1] = 100;
+    eepromConfig.telemRate[TELEM_EARTH_ACCELS - 1] = 100;
+    eepromConfig.telemRate[TELEM_ATTITUDE     - 1] = 100;
+    eepromConfig.telemRate[TELEM_VERTICAL     - 1] = 100;
+    eepromConfig.telemRate[TELEM_SENSORS      - 1] =  10;
+    eepromConfig.telemRate[TELEM_ADC_TEST     - 1] = 100;
+    eepromConfig.telemRate[TELEM_TASK_STATS   - 1] =  10;
+    eepromConfig.telemRate[TELEM_GPS          - 1] =  10;
+    eepromConfig.telemRate[TELEM_RC           - 1] =  50;
+    eepromConfig.telemRate[TELEM_MOTORS       - 1] = 100;
+
+    eepromConfig.magVar                =  9.033333f * D2R;  // Albuquerque, NM Mag Var 9 degrees 2 minutes (+ East, - West)
+
+    eepromConfig.batteryVoltageDivider = (10.0f + 1.5f) / 1.5f;
+
+    eepromConfig.armCount              = 50;
+    eepromConfig.disarmCount           = 0;
+
+    eepromConfig.accelBiasMXR[XAXIS]        = 2048.0f;
+    eepromConfig.accelBiasMXR[YAXIS]        = 2048.0f;
+    eepromConfig.accelBiasMXR[ZAXIS]        = 2048.0f;
+
+    eepromConfig.accelScaleFactorMXR[XAXIS] = 0.04937965f;  // (3.3 / 4096) / 0.16 * 9.8065
+    eepromConfig.accelScaleFactorMXR[YAXIS] = 0.04937965f;  // (3.3 / 4096) / 0.16 * 9.8065
+    eepromConfig.accelScaleFactorMXR[ZAXIS] = 0.04937965f;  // (3.3 / 4096) / 0.16 * 9.8065
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Check First Time
+///////////////////////////////////////////////////////////////////////////////
+
+void checkFirstTime(bool eepromReset)
+{
+    uint8_t test_val;
+
+    test_val = *(uint8_t *)FLASH_WRITE_EEPROM_ADDR;
+
+    if (eepromReset || test_val != checkNewEEPROMConf)
+    {
+        setEEPROMDefaults();
 
         writeEEPROM();
-	}
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
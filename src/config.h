@@ -38,7 +38,7 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
-extern const char rcChannelLetters[8];
+extern const char rcChannelLetters[];
 
 extern float vTailThrust;
 
@@ -60,6 +60,10 @@ int writeEEPROM(void);
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void setEEPROMDefaults(void);
+
+///////////////////////////////////////////////////////////////////////////////
+
 void checkFirstTime(bool eepromReset);
 
 ///////////////////////////////////////////////////////////////////////////////
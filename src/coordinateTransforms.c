@@ -42,66 +42,145 @@
 
 float earthAxisAccels[3] = { 0.0f, 0.0f, 0.0f };
 
-float rotationMatrix[9];
+///////////////////////////////////////////////////////////////////////////////
+// Quaternion To Rotation Matrix
+///////////////////////////////////////////////////////////////////////////////
+
+void quaternionToRotationMatrix(const margAHRS_t *ahrs, float matrix[9])
+{
+    matrix[0] = ahrs->q0q0 + ahrs->q1q1 - ahrs->q2q2 - ahrs->q3q3;
+
+    matrix[1] = 2.0f * (ahrs->q1q2 - ahrs->q0q3);
+
+    matrix[2] = 2.0f * (ahrs->q0q2 + ahrs->q1q3);
+
+    matrix[3] = 2.0f * (ahrs->q1q2 + ahrs->q0q3);
+
+    matrix[4] = ahrs->q0q0 - ahrs->q1q1 + ahrs->q2q2 - ahrs->q3q3;
+
+    matrix[5] = 2.0f * (ahrs->q2q3 - ahrs->q0q1);
+
+    matrix[6] = 2.0f * (ahrs->q1q3 - ahrs->q0q2);
+
+    matrix[7] = 2.0f * (ahrs->q0q1 + ahrs->q2q3);
+
+    matrix[8] = ahrs->q0q0 - ahrs->q1q1 - ahrs->q2q2 + ahrs->q3q3;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
-// Create Rotation Matrix
+// Accel and Mag To Quaternion
 ///////////////////////////////////////////////////////////////////////////////
 
-void createRotationMatrix(void)
+// Roll and pitch from the gravity vector, heading from the tilt compensated
+// magnetometer.  Used to start the attitude estimators.
+
+void accelMagToQuaternion(const float accel[3], const float mag[3], float q[4])
 {
-    rotationMatrix[0] = q0q0 + q1q1 -q2q2 - q3q3;
+    float initialRoll, initialPitch;
+    float cosRoll, sinRoll, cosPitch, sinPitch;
+    float magX, magY;
+    float initialHdg, cosHeading, sinHeading;
+
+    initialRoll  = fastAtan2f(-accel[YAXIS], -accel[ZAXIS]);
+    initialPitch = fastAtan2f( accel[XAXIS], -accel[ZAXIS]);
 
-    rotationMatrix[1] = 2.0f * (q1q2 - q0q3);
+    cosRoll  = cosf(initialRoll);
+    sinRoll  = sinf(initialRoll);
+    cosPitch = cosf(initialPitch);
+    sinPitch = sinf(initialPitch);
 
-    rotationMatrix[2] = 2.0f * (q0q2 + q1q3);
+    magX = mag[XAXIS] * cosPitch + mag[YAXIS] * sinRoll * sinPitch + mag[ZAXIS] * cosRoll * sinPitch;
 
-    rotationMatrix[3] = 2.0f * (q1q2 + q0q3);
+    magY = mag[YAXIS] * cosRoll - mag[ZAXIS] * sinRoll;
 
-    rotationMatrix[4] = q0q0 - q1q1 + q2q2 - q3q3;
+    initialHdg = fastAtan2f(-magY, magX);
 
-    rotationMatrix[5] = 2.0f * (q2q3 - q0q1);
+    cosRoll = cosf(initialRoll * 0.5f);
+    sinRoll = sinf(initialRoll * 0.5f);
 
-    rotationMatrix[6] = 2.0f * (q1q3 - q0q2);
+    cosPitch = cosf(initialPitch * 0.5f);
+    sinPitch = sinf(initialPitch * 0.5f);
 
-    rotationMatrix[7] = 2.0f * (q0q1 + q2q3);
+    cosHeading = cosf(initialHdg * 0.5f);
+    sinHeading = sinf(initialHdg * 0.5f);
 
-    rotationMatrix[8] = q0q0 - q1q1 - q2q2 + q3q3;
+    q[0] = cosRoll * cosPitch * cosHeading + sinRoll * sinPitch * sinHeading;
+    q[1] = sinRoll * cosPitch * cosHeading - cosRoll * sinPitch * sinHeading;
+    q[2] = cosRoll * sinPitch * cosHeading + sinRoll * cosPitch * sinHeading;
+    q[3] = cosRoll * cosPitch * sinHeading - sinRoll * sinPitch * cosHeading;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// Rotate Body Accels to Earth Accels
+// Rotate Quaternion
 ///////////////////////////////////////////////////////////////////////////////
 
-void bodyAccelToEarthAccel(void)
+// Applies a body axis rotation vector.  Uses the exponential map rather than
+// the first order step, the series are good to well past 0.1 rad per call.
+
+void rotateQuaternion(float q[4], float rx, float ry, float rz)
 {
-    arm_matrix_instance_f32 a;
-    arm_matrix_instance_f32 b;
-    arm_matrix_instance_f32 x;
+    float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    float halfAngleSquared, cosHalf, sinHalf;
+    float normR;
 
-    arm_mat_init_f32(&a, 3, 3, (float *)rotationMatrix);
+    halfAngleSquared = 0.25f * (rx * rx + ry * ry + rz * rz);
 
-    #if defined(MPU_ACCEL)
-        arm_mat_init_f32(&b, 3, 1, (float *)sensors.accel100Hz);
-    #endif
+    cosHalf = 1.0f - halfAngleSquared * (0.5f - halfAngleSquared / 24.0f);
+    sinHalf = 0.5f * (1.0f - halfAngleSquared * (1.0f / 6.0f - halfAngleSquared / 120.0f));  // sin(h) / h / 2
 
-    #if defined(MXR_ACCEL)
-        arm_mat_init_f32(&b, 3, 1, (float *)sensors.accel100HzMXR);
-    #endif
+    rx *= sinHalf;
+    ry *= sinHalf;
+    rz *= sinHalf;
 
-    arm_mat_init_f32(&x, 3, 1,          earthAxisAccels);
+    q[0] = q0 * cosHalf - q1 * rx - q2 * ry - q3 * rz;
+    q[1] = q1 * cosHalf + q0 * rx + q2 * rz - q3 * ry;
+    q[2] = q2 * cosHalf + q0 * ry - q1 * rz + q3 * rx;
+    q[3] = q3 * cosHalf + q0 * rz + q1 * ry - q2 * rx;
 
-    arm_mat_mult_f32(&a, &b, &x);
+    normR = 1.0f / fastSqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+
+    q[0] *= normR;
+    q[1] *= normR;
+    q[2] *= normR;
+    q[3] *= normR;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Rotate Body Accel To Earth Axes
+///////////////////////////////////////////////////////////////////////////////
+
+// Gravity is removed, a level and still aircraft reads zero on all axes
+
+void rotateBodyAccelToEarth(const float matrix[9], const float bodyAccel[3], float earthAccel[3])
+{
+    arm_matrix_instance_f32 a;
+    arm_matrix_instance_f32 b;
+    arm_matrix_instance_f32 x;
 
-    earthAxisAccels[ZAXIS] += accelOneG;
+    arm_mat_init_f32(&a, 3, 3, (float *)matrix);
+    arm_mat_init_f32(&b, 3, 1, (float *)bodyAccel);
+    arm_mat_init_f32(&x, 3, 1,          earthAccel);
 
-    earthAxisAccels[XAXIS] = firstOrderFilter(earthAxisAccels[XAXIS], &firstOrderFilters[EARTH_AXIS_ACCEL_X_HIGHPASS]);
-    earthAxisAccels[YAXIS] = firstOrderFilter(earthAxisAccels[YAXIS], &firstOrderFilters[EARTH_AXIS_ACCEL_Y_HIGHPASS]);
-    earthAxisAccels[ZAXIS] = firstOrderFilter(earthAxisAccels[ZAXIS], &firstOrderFilters[EARTH_AXIS_ACCEL_Z_HIGHPASS]);
+    arm_mat_mult_f32(&a, &b, &x);
+
+    earthAccel[ZAXIS] += accelOneG;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Rotate Body Accels to Earth Accels
 ///////////////////////////////////////////////////////////////////////////////
 
+void bodyAccelToEarthAccel(void)
+{
+    #if defined(MPU_ACCEL)
+        rotateBodyAccelToEarth(getRotationMatrix(), sensors.accel100Hz, earthAxisAccels);
+    #endif
 
+    #if defined(MXR_ACCEL)
+        rotateBodyAccelToEarth(getRotationMatrix(), sensors.accel100HzMXR, earthAxisAccels);
+    #endif
 
+    filterChainUpdate(&filterChains[EARTH_ACCEL100HZ_FILTER], earthAxisAccels, earthAxisAccels);
+}
 
+///////////////////////////////////////////////////////////////////////////////
@@ -42,11 +42,31 @@
 
 extern float earthAxisAccels[3];
 
+struct margAHRS_t;  // MargAHRS.h, included after this file in board.h
+
+///////////////////////////////////////////////////////////////////////////////
+// Quaternion To Rotation Matrix
+///////////////////////////////////////////////////////////////////////////////
+
+void quaternionToRotationMatrix(const struct margAHRS_t *ahrs, float matrix[9]);
+
+///////////////////////////////////////////////////////////////////////////////
+// Accel and Mag To Quaternion
+///////////////////////////////////////////////////////////////////////////////
+
+void accelMagToQuaternion(const float accel[3], const float mag[3], float q[4]);
+
+///////////////////////////////////////////////////////////////////////////////
+// Rotate Quaternion
+///////////////////////////////////////////////////////////////////////////////
+
+void rotateQuaternion(float q[4], float rx, float ry, float rz);
+
 ///////////////////////////////////////////////////////////////////////////////
-// Create Rotation Matrix
+// Rotate Body Accel To Earth Axes
 ///////////////////////////////////////////////////////////////////////////////
 
-void createRotationMatrix(void);
+void rotateBodyAccelToEarth(const float matrix[9], const float bodyAccel[3], float earthAccel[3]);
 
 ///////////////////////////////////////////////////////////////////////////////
 // Rotate Body Accels to Earth Accels
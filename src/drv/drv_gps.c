@@ -59,34 +59,27 @@
 volatile uint8_t rx2Buffer[UART2_BUFFER_SIZE];
 uint32_t rx2DMAPos = 0;
 
-volatile uint8_t tx2Buffer[UART2_BUFFER_SIZE];
-volatile uint16_t tx2BufferTail = 0;
-volatile uint16_t tx2BufferHead = 0;
+// Transmit ring, sent by DMA straight from the buffer, see txRing.c
+static uint8_t tx2Buffer[UART2_BUFFER_SIZE];
 
-volatile uint8_t  tx2DmaEnabled = false;
+txRing_t gpsTxRing;
 
 ///////////////////////////////////////////////////////////////////////////////
 // UART2 Transmit via DMA
 ///////////////////////////////////////////////////////////////////////////////
 
-static void uart2TxDMA(void)
+static void uart2TxDMA(txRing_t *ring)
 {
-	if ((tx2DmaEnabled == true) || (tx2BufferHead == tx2BufferTail))  // Ignore call if already active or no new data in buffer
-    	return;
+    const uint8_t *data;
+    uint16_t      length;
+
+    length = txRingSendStart(ring, &data);
 
-    DMA1_Stream6->M0AR = (uint32_t)&tx2Buffer[tx2BufferTail];
-    if (tx2BufferHead > tx2BufferTail)
-    {
-	    DMA_SetCurrDataCounter(DMA1_Stream6, tx2BufferHead - tx2BufferTail);
-	    tx2BufferTail = tx2BufferHead;
-    }
-    else
-    {
-	    DMA_SetCurrDataCounter(DMA1_Stream6, UART2_BUFFER_SIZE - tx2BufferTail);
-	    tx2BufferTail = 0;
-    }
+    if (length == 0)  // Ignore call if already active or no new data in buffer
+    	return;
 
-    tx2DmaEnabled = true;
+    DMA1_Stream6->M0AR = (uint32_t)data;
+    DMA_SetCurrDataCounter(DMA1_Stream6, length);
 
     DMA_Cmd(DMA1_Stream6, ENABLE);
 }
@@ -99,9 +92,9 @@ void DMA1_Stream6_IRQHandler(void)
 {
     DMA_ClearITPendingBit(DMA1_Stream6, DMA_IT_TCIF6);
 
-    tx2DmaEnabled = false;
+    txRingSendDone(&gpsTxRing);
 
-    uart2TxDMA();
+    uart2TxDMA(&gpsTxRing);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -202,6 +195,8 @@ void gpsInit(void)
 
     DMA_SetCurrDataCounter(DMA1_Stream6, 0);
 
+    txRingInit(&gpsTxRing, tx2Buffer, UART2_BUFFER_SIZE, uart2TxDMA);
+
     DMA_ITConfig(DMA1_Stream6, DMA_IT_TC, ENABLE);
 
     USART_DMACmd(USART2, USART_DMAReq_Tx, ENABLE);
@@ -275,25 +270,19 @@ uint8_t gpsReadPoll(void)
 
 void gpsWrite(uint8_t ch)
 {
-    tx2Buffer[tx2BufferHead] = ch;
-    tx2BufferHead = (tx2BufferHead + 1) % UART2_BUFFER_SIZE;
-
-    uart2TxDMA();
+    txRingWrite(&gpsTxRing, &ch, 1);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // GPS Print
 ///////////////////////////////////////////////////////////////////////////////
 
+// Dropped whole when it does not fit in the transmit ring, counted in
+// gpsTxRing
+
 void gpsPrint(char *str)
 {
-    while (*str)
-    {
-    	tx2Buffer[tx2BufferHead] = *str++;
-    	tx2BufferHead = (tx2BufferHead + 1) % UART2_BUFFER_SIZE;
-    }
-
-	uart2TxDMA();
+    txRingWrite(&gpsTxRing, (const uint8_t *)str, (uint16_t)strlen(str));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
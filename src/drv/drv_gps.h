@@ -38,6 +38,10 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
+extern txRing_t gpsTxRing;
+
+///////////////////////////////////////////////////////////////////////////////
+
 void gpsInit(void);
 
 ///////////////////////////////////////////////////////////////////////////////
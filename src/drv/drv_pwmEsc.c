@@ -41,30 +41,50 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #define ESC_PULSE_1MS    2000  // 1ms pulse width
-#define ESC_PULSE_PERIOD 5000  // pulse period (400Hz)
 
-static volatile uint32_t *OutputChannels[] = { &(TIM8->CCR4),
-	                                           &(TIM8->CCR3),
-	                                           &(TIM8->CCR2),
-	                                           &(TIM8->CCR1),
-                                               &(TIM2->CCR2),
-                                               &(TIM3->CCR1),
-                                               &(TIM3->CCR2),
-                                               &(TIM2->CCR1), };
+static TIM_TypeDef * const escTimers[NUMBER_OF_ESC_TIMERS] = { TIM8, TIM2, TIM3 };
+
+static volatile uint32_t *OutputChannels[8];
+
+static escTiming_t escTiming;
+
+// DShot, one update DMA stream per timer bursting into CCR1 thru CCRn
+
+static const struct
+{
+    DMA_Stream_TypeDef *stream;
+    uint32_t           channel;
+    uint32_t           flags;
+} escDma[NUMBER_OF_ESC_TIMERS] =
+{
+    { DMA2_Stream1, DMA_Channel_7, DMA_FLAG_TCIF1 | DMA_FLAG_HTIF1 | DMA_FLAG_TEIF1 | DMA_FLAG_DMEIF1 | DMA_FLAG_FEIF1 },  // TIM8_UP
+    { DMA1_Stream1, DMA_Channel_3, DMA_FLAG_TCIF1 | DMA_FLAG_HTIF1 | DMA_FLAG_TEIF1 | DMA_FLAG_DMEIF1 | DMA_FLAG_FEIF1 },  // TIM2_UP
+    { DMA1_Stream2, DMA_Channel_5, DMA_FLAG_TCIF2 | DMA_FLAG_HTIF2 | DMA_FLAG_TEIF2 | DMA_FLAG_DMEIF2 | DMA_FLAG_FEIF2 },  // TIM3_UP
+};
+
+static uint32_t dshotBuffer[NUMBER_OF_ESC_TIMERS][DSHOT_BUFFER_BITS * DSHOT_MAX_CHANNELS];
+
+static uint32_t *dshotSlot[8];
+
+static uint8_t  dshotChannels[NUMBER_OF_ESC_TIMERS];
 
 ///////////////////////////////////////////////////////////////////////////////
 // PWM ESC Initialization
 ///////////////////////////////////////////////////////////////////////////////
 
-void pwmEscInit(uint16_t escPwmRate)
+void pwmEscInit(uint8_t escProtocol, uint16_t escPwmRate)
 {
     GPIO_InitTypeDef         GPIO_InitStructure;
     TIM_TimeBaseInitTypeDef  TIM_TimeBaseStructure;
     TIM_OCInitTypeDef        TIM_OCInitStructure;
+    DMA_InitTypeDef          DMA_InitStructure;
+    TIM_TypeDef              *timer;
+    uint8_t                  i, preload;
 
     GPIO_StructInit(&GPIO_InitStructure);
     TIM_TimeBaseStructInit(&TIM_TimeBaseStructure);
     TIM_OCStructInit(&TIM_OCInitStructure);
+    DMA_StructInit(&DMA_InitStructure);
 
     // Outputs
     // ESC PWM1 TIM8_CH4 PC9
@@ -84,6 +104,9 @@ void pwmEscInit(uint16_t escPwmRate)
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3,  ENABLE);
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_TIM8,  ENABLE);
 
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1,  ENABLE);
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2,  ENABLE);
+
     GPIO_InitStructure.GPIO_Pin   = GPIO_Pin_15;
     GPIO_InitStructure.GPIO_Mode  = GPIO_Mode_AF;
     GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
@@ -121,44 +144,116 @@ void pwmEscInit(uint16_t escPwmRate)
 
     // Output timers
 
-    TIM_TimeBaseStructure.TIM_Period            = (uint16_t)(2000000 / escPwmRate) - 1;
-    TIM_TimeBaseStructure.TIM_Prescaler         = 42 - 1;
+    escTimingInit(&escTiming, escProtocol, escPwmRate);
+
+    for (i = 0; i < NUMBER_OF_ESC_TIMERS; i++)
+    {
+        dshotChannels[i] = escTimerChannels(i);
+
+        memset(dshotBuffer[i], 0, sizeof(dshotBuffer[i]));
+    }
+
+    for (i = 0; i < 8; i++)
+    {
+        OutputChannels[i] = &escTimers[escOutputs[i].timer]->CCR1 + (escOutputs[i].channel - 1);
+        dshotSlot[i]      = &dshotBuffer[escOutputs[i].timer][escOutputs[i].channel - 1];
+    }
+
+    preload = escTiming.onePulse || (escTiming.dshotRate != 0);
+
+    TIM_TimeBaseStructure.TIM_Period            = escTiming.period;
+    TIM_TimeBaseStructure.TIM_Prescaler         = escTiming.prescaler - 1;
   //TIM_TimeBaseStructure.TIM_ClockDivision     = TIM_CKD_DIV1;
   //TIM_TimeBaseStructure.TIM_CounterMode       = TIM_CounterMode_Up;
   //TIM_TimeBaseStructure.TIM_RepititionCounter = 0x0000;
 
-    TIM_TimeBaseInit(TIM2, &TIM_TimeBaseStructure);
-    TIM_TimeBaseInit(TIM3, &TIM_TimeBaseStructure);
-    TIM_TimeBaseInit(TIM8, &TIM_TimeBaseStructure);
+    // PWM:     high from the update to the compare, every period
+    // OneShot: low until the compare, high to the end of a single period
+    // DShot:   high from the update to the compare, one period per bit,
+    //          low with a compare of 0 between frames
 
-    TIM_OCInitStructure.TIM_OCMode       = TIM_OCMode_PWM2;
+    TIM_OCInitStructure.TIM_OCMode       = (escTiming.dshotRate != 0) ? TIM_OCMode_PWM1 : TIM_OCMode_PWM2;
     TIM_OCInitStructure.TIM_OutputState  = TIM_OutputState_Enable;
   //TIM_OCInitStructure.TIM_OutputNState = TIM_OutputNState_Disable;
-    TIM_OCInitStructure.TIM_Pulse        = ESC_PULSE_1MS;
-    TIM_OCInitStructure.TIM_OCPolarity   = TIM_OCPolarity_Low;
+    TIM_OCInitStructure.TIM_Pulse        = (escTiming.dshotRate != 0) ? 0 : escCompare(&escTiming, ESC_PULSE_1MS);
+    TIM_OCInitStructure.TIM_OCPolarity   = (escProtocol == ESC_PROTOCOL_PWM) ? TIM_OCPolarity_Low : TIM_OCPolarity_High;
   //TIM_OCInitStructure.TIM_OCNPolarity  = TIM_OCPolarity_High;
-    TIM_OCInitStructure.TIM_OCIdleState  = TIM_OCIdleState_Set;
+    TIM_OCInitStructure.TIM_OCIdleState  = (escProtocol == ESC_PROTOCOL_PWM) ? TIM_OCIdleState_Set : TIM_OCIdleState_Reset;
   //TIM_OCInitStructure.TIM_OCNIdleState = TIM_OCNIdleState_Reset;
 
-    TIM_OC1Init(TIM2, &TIM_OCInitStructure);
-    TIM_OC2Init(TIM2, &TIM_OCInitStructure);
+  //DMA_InitStructure.DMA_Channel            = DMA_Channel_0;
+  //DMA_InitStructure.DMA_PeripheralBaseAddr = 0;
+  //DMA_InitStructure.DMA_Memory0BaseAddr    = 0;
+    DMA_InitStructure.DMA_DIR                = DMA_DIR_MemoryToPeripheral;
+  //DMA_InitStructure.DMA_BufferSize         = 0;
+  //DMA_InitStructure.DMA_PeripheralInc      = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc          = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+    DMA_InitStructure.DMA_MemoryDataSize     = DMA_MemoryDataSize_Word;
+  //DMA_InitStructure.DMA_Mode               = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority           = DMA_Priority_High;
+  //DMA_InitStructure.DMA_FIFOMode           = DMA_FIFOMode_Disable;
+  //DMA_InitStructure.DMA_FIFOThreshold      = DMA_FIFOThreshold_1QuarterFull;
+  //DMA_InitStructure.DMA_MemoryBurst        = DMA_MemoryBurst_Single;
+  //DMA_InitStructure.DMA_PeripheralBurst    = DMA_PeripheralBurst_Single;
+
+    for (i = 0; i < NUMBER_OF_ESC_TIMERS; i++)
+    {
+        timer = escTimers[i];
+
+        TIM_Cmd(timer, DISABLE);
+        TIM_DMACmd(timer, TIM_DMA_Update, DISABLE);
+
+        // DMA1 Stream1 is USART3 RX's only stream as well, leave it to the
+        // serial receiver unless DShot has it or is about to take it
+
+        if ((escTiming.dshotRate != 0) || ((escDma[i].stream->CR & DMA_SxCR_CHSEL) == escDma[i].channel))
+            DMA_DeInit(escDma[i].stream);
+
+        TIM_TimeBaseInit(timer, &TIM_TimeBaseStructure);
+
+        TIM_OC1Init(timer, &TIM_OCInitStructure);
+        TIM_OC2Init(timer, &TIM_OCInitStructure);
+
+        if (timer == TIM8)
+        {
+            TIM_OC3Init(timer, &TIM_OCInitStructure);
+            TIM_OC4Init(timer, &TIM_OCInitStructure);
+        }
+
+        // OneShot writes are preloaded and all land on the trigger's update,
+        // DShot bits are preloaded by the DMA and each lands on the next one
+
+        TIM_OC1PreloadConfig(timer, preload ? TIM_OCPreload_Enable : TIM_OCPreload_Disable);
+        TIM_OC2PreloadConfig(timer, preload ? TIM_OCPreload_Enable : TIM_OCPreload_Disable);
+        TIM_OC3PreloadConfig(timer, preload ? TIM_OCPreload_Enable : TIM_OCPreload_Disable);
+        TIM_OC4PreloadConfig(timer, preload ? TIM_OCPreload_Enable : TIM_OCPreload_Disable);
+        TIM_ARRPreloadConfig(timer, preload ? ENABLE : DISABLE);
+
+        TIM_SelectOnePulseMode(timer, escTiming.onePulse ? TIM_OPMode_Single : TIM_OPMode_Repetitive);
 
-    TIM_OC1Init(TIM3, &TIM_OCInitStructure);
-    TIM_OC2Init(TIM3, &TIM_OCInitStructure);
+        if (escTiming.dshotRate != 0)
+        {
+            // Each update requests one burst of dshotChannels words through
+            // DMAR into CCR1 onwards, the burst length field is count - 1
 
-    TIM_OC1Init(TIM8, &TIM_OCInitStructure);
-    TIM_OC2Init(TIM8, &TIM_OCInitStructure);
-    TIM_OC3Init(TIM8, &TIM_OCInitStructure);
-    TIM_OC4Init(TIM8, &TIM_OCInitStructure);
+            TIM_DMAConfig(timer, TIM_DMABase_CCR1, (uint16_t)((dshotChannels[i] - 1) << 8));
 
-    TIM_Cmd(TIM2, ENABLE);
-    TIM_Cmd(TIM3, ENABLE);
-    TIM_Cmd(TIM8, ENABLE);
+            DMA_InitStructure.DMA_Channel            = escDma[i].channel;
+            DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&timer->DMAR;
+            DMA_InitStructure.DMA_Memory0BaseAddr    = (uint32_t)dshotBuffer[i];
+            DMA_InitStructure.DMA_BufferSize         = DSHOT_BUFFER_BITS * dshotChannels[i];
 
-    TIM_CtrlPWMOutputs(TIM2, ENABLE);
-    TIM_CtrlPWMOutputs(TIM3, ENABLE);
-    TIM_CtrlPWMOutputs(TIM8, ENABLE);
+            DMA_Init(escDma[i].stream, &DMA_InitStructure);
 
+            TIM_DMACmd(timer, TIM_DMA_Update, ENABLE);
+        }
+
+        if (escTiming.onePulse == false)
+            TIM_Cmd(timer, ENABLE);
+
+        TIM_CtrlPWMOutputs(timer, ENABLE);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -167,7 +262,85 @@ void pwmEscInit(uint16_t escPwmRate)
 
 void pwmEscWrite(uint8_t channel, uint16_t value)
 {
-    *OutputChannels[channel] = value;
+    if (escTiming.dshotRate != 0)
+        dshotEncode(dshotSlot[channel], dshotChannels[escOutputs[channel].timer],
+                    dshotFrame(dshotValue(value), false), &escTiming.dshot);
+    else
+        *OutputChannels[channel] = escCompare(&escTiming, value);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PWM ESC Busy
+///////////////////////////////////////////////////////////////////////////////
+
+// True while DShot frames are going out.  The DMA reads the bits straight
+// from dshotBuffer, so pwmEscWrite() must not encode until it is done.
+// PWM and OneShot only write preload registers and are never busy.
+
+bool pwmEscBusy(void)
+{
+    uint8_t i;
+
+    if (escTiming.dshotRate == 0)
+        return false;
+
+    for (i = 0; i < NUMBER_OF_ESC_TIMERS; i++)
+        if (escDma[i].stream->CR & DMA_SxCR_EN)
+            return true;
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PWM ESC Trigger
+///////////////////////////////////////////////////////////////////////////////
+
+// Fires one OneShot pulse on every output with the values written since
+// the last trigger.  The update event moves all preloaded compares into
+// place and restarts the counters, then the three timers are started
+// back to back.  If the last pulse is still going out the trigger is
+// dropped and the new values go with the next one.  Nothing to do for PWM.
+//
+// For DShot the three DMA streams are restarted on the frames encoded
+// since the last trigger, the same three stream starts for one motor or
+// eight.  A frame takes 18 bit periods, 30 uSec at DShot600.  Unlike the
+// OneShot preloads the buffers are what is being sent, so writeMotors()
+// checks pwmEscBusy() before encoding and skips the whole write while a
+// frame is going out.  The check here keeps a trigger from restarting
+// the streams part way through a frame.
+
+void pwmEscTrigger(void)
+{
+    uint8_t i;
+
+    if (escTiming.dshotRate != 0)
+    {
+        if (pwmEscBusy())
+            return;
+
+        for (i = 0; i < NUMBER_OF_ESC_TIMERS; i++)
+        {
+            DMA_ClearFlag(escDma[i].stream, escDma[i].flags);
+            DMA_SetCurrDataCounter(escDma[i].stream, DSHOT_BUFFER_BITS * dshotChannels[i]);
+            DMA_Cmd(escDma[i].stream, ENABLE);
+        }
+
+        return;
+    }
+
+    if (escTiming.onePulse == false)
+        return;
+
+    if ((TIM8->CR1 | TIM2->CR1 | TIM3->CR1) & TIM_CR1_CEN)
+        return;
+
+    TIM8->EGR = TIM_EGR_UG;
+    TIM2->EGR = TIM_EGR_UG;
+    TIM3->EGR = TIM_EGR_UG;
+
+    TIM8->CR1 |= TIM_CR1_CEN;
+    TIM2->CR1 |= TIM_CR1_CEN;
+    TIM3->CR1 |= TIM_CR1_CEN;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -40,7 +40,7 @@
 // PWM ESC Initialization
 ///////////////////////////////////////////////////////////////////////////////
 
-void pwmEscInit(uint16_t escPwmRate);
+void pwmEscInit(uint8_t escProtocol, uint16_t escPwmRate);
 
 ///////////////////////////////////////////////////////////////////////////////
 // PWM ESC Write
@@ -48,4 +48,16 @@ void pwmEscInit(uint16_t escPwmRate);
 
 void pwmEscWrite(uint8_t channel, uint16_t value);
 
+///////////////////////////////////////////////////////////////////////////////
+// PWM ESC Busy
+///////////////////////////////////////////////////////////////////////////////
+
+bool pwmEscBusy(void);
+
+///////////////////////////////////////////////////////////////////////////////
+// PWM ESC Trigger
+///////////////////////////////////////////////////////////////////////////////
+
+void pwmEscTrigger(void);
+
 ///////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -45,6 +45,8 @@
 
 uint8_t rcActive = false;
 
+volatile uint64_t rxFrameTime = 0;  // micros64() at the end of the last complete frame
+
 ///////////////////////////////////////////////////////////////////////////////
 // PWM Receiver Defines and Variables
 ///////////////////////////////////////////////////////////////////////////////
@@ -69,7 +71,7 @@ static struct PWM_State { uint8_t  state;          // 0 = looking for rising edg
 static TIM_ICInitTypeDef  TIM_ICInitStructure;
 
 ///////////////////////////////////////////////////////////////////////////////
-// Spektrum Satellite Receiver Defines and Variables
+// Serial Receiver Defines and Variables, Spektrum Satellite, SBUS, SUMD, IBUS
 ///////////////////////////////////////////////////////////////////////////////
 
 #define SPEKTRUM_UART_PIN        GPIO_Pin_9
@@ -78,26 +80,50 @@ static TIM_ICInitTypeDef  TIM_ICInitStructure;
 #define SPEKTRUM_BIND_PIN        GPIO_Pin_14
 #define SPEKTRUM_BIND_GPIO       GPIOE
 
-#define SPEKTRUM_FRAME_SIZE 16
+// USART3 RX has one DMA stream, DMA1 Stream1 channel 4, and DShot's TIM2
+// update burst needs the same stream.  With DShot selected the receiver
+// takes an RXNE interrupt per byte instead, which only stores the byte.
+// Either way the idle line after each frame is the one frame interrupt.
+
+#define RX_SERIAL_BUFFER_SIZE  256     // 8 IBUS frames, 6 of 16 channel SUMD
+#define RX_FRAME_QUEUE_SIZE      8     // Frame ends waiting for rxUpdate(), power of 2
+
+#define RX_SERIAL_ERRORS  (USART_FLAG_PE | USART_FLAG_FE | USART_FLAG_NE | USART_FLAG_ORE)
 
 enum frameWatchDogConsts {
-  frameResetTime = 4 , // 4ms
   frameLostTime = 1000, // 1 second.
   };
 
 uint8_t  i;
 uint8_t  spektrumBindCount;
 
-uint32_t spektrumChannelData[SPEKTRUM_MAX_CHANNEL];
-uint8_t  spektrumChannelMask;
-uint8_t  spektrumChannelShift;
+static uint16_t spektrumChannelData[SPEKTRUM_MAX_CHANNEL];  // Positions, frames carry some channels each
+
+static uint8_t  rxSerialBuffer[RX_SERIAL_BUFFER_SIZE];
+static uint16_t rxSerialPosition;      // Byte interrupt write index
+static uint8_t  rxSerialDma;
+static uint8_t  rxSerialError;         // Parity, framing, noise or overrun since the last frame end
+static uint8_t  rxSerialChannels;      // In the last frame used
+
+static uint16_t          rxFrameEnd[RX_FRAME_QUEUE_SIZE];
+static uint8_t           rxFrameEndError[RX_FRAME_QUEUE_SIZE];
+static uint64_t          rxFrameEndTime[RX_FRAME_QUEUE_SIZE];
+static volatile uint8_t  rxFrameHead;
+static volatile uint8_t  rxFrameTail;
+static uint16_t          rxFrameStart;
+
+// Readers take rxChannelData[rxChannelFront], rxUpdate() fills the other
+// one and then flips, so an interrupt reading channels never sees half a
+// frame.  rxFrameSequence tells readers a new frame is in.
+
+static uint16_t         rxChannelData[2][RX_MAX_CHANNELS];
+static volatile uint8_t rxChannelFront;
 
-uint8_t  spektrumFrame[SPEKTRUM_FRAME_SIZE];
-bool     spektrumFrameComplete = false;
-uint8_t  spektrumFramePosition;
+volatile uint32_t rxFrameSequence = 0;
 
-uint32_t spektrumTimeInterval;
-uint32_t spektrumTimeLast;
+rxStats_t rxStats;
+
+static uint64_t rxPreviousFrameTime;
 
 ///////////////////////////////////////////////////////////////////////////////
 // Serial PWM Receiver Interrupt Handler
@@ -124,6 +150,7 @@ static void serialPWM_IRQHandler(TIM_TypeDef *tim)
     if (diff > 2700 * 2)   // Per http://www.rcgroups.com/forums/showpost.php?p=21996147&postcount=3960
     {                      // "So, if you use 2.5ms or higher as being the reset for the PPM stream start,
         chan = 0;          // you will be fine. I use 2.7ms just to be safe."
+        rxFrameTime = micros64();
     }
     else
     {
@@ -195,6 +222,9 @@ static void parallelPWM_IRQHandler(TIM_TypeDef *tim)
                 else
                     state->pulseWidth = ((0xFFFF - state->riseTime) + inputCaptureValue);
 
+                if (i == 0)
+                    rxFrameTime = micros64();
+
                 // switch state
                 state->state = 0;
 
@@ -242,51 +272,172 @@ void rxFrameLost()
 
 ///////////////////////////////////////
 
-void rxFrameReset()
-{
-  spektrumFramePosition = 0;
-}
-
-///////////////////////////////////////
-
-uint32_t frameReset;
 uint32_t frameLost;
 
+// Idle line, one character time after the last byte of a frame, plus the
+// received bytes themselves when DMA is not available.  Only records where
+// the frame ended, when, and whether any byte of it had a parity, framing,
+// noise or overrun error, rxUpdate() does the rest.  With DMA the error
+// flags stay set until the status and data register reads here.
+
 void USART3_IRQHandler(void)
 {
-    uint8_t  b;
-    uint8_t  spektrumChannel;
+    uint16_t status, position;
+    uint8_t  head;
+
+    status = USART3->SR;
 
-    if (USART_GetITStatus(USART3, USART_IT_RXNE) == SET)
+    if (status & RX_SERIAL_ERRORS)
+        rxSerialError = true;
+
+    if ((rxSerialDma == false) && (status & USART_FLAG_RXNE))
     {
-        rcActive = true;
+        rxSerialBuffer[rxSerialPosition] = (uint8_t)USART_ReceiveData(USART3);
 
-        watchDogReset(frameReset);
+        if (++rxSerialPosition == RX_SERIAL_BUFFER_SIZE)
+            rxSerialPosition = 0;
+    }
 
-        spektrumFrame[spektrumFramePosition] = USART_ReceiveData(USART3);
+    if (status & USART_FLAG_IDLE)
+    {
+        USART_ReceiveData(USART3);  // Status then data register read clears IDLE and the errors
 
-        if (spektrumFramePosition == SPEKTRUM_FRAME_SIZE - 1)
+        if (rxSerialDma)
+            position = (uint16_t)(RX_SERIAL_BUFFER_SIZE - DMA_GetCurrDataCounter(DMA1_Stream1)) % RX_SERIAL_BUFFER_SIZE;
+        else
+            position = rxSerialPosition;
+
+        head = (rxFrameHead + 1) & (RX_FRAME_QUEUE_SIZE - 1);
+
+        // A full queue drops this end, the next frame then spans two and
+        // is rejected on its length
+
+        if (head != rxFrameTail)
         {
-            spektrumFrameComplete = true;
-            //failsafeCnt = 0;
+            rxFrameEnd[rxFrameHead]      = position;
+            rxFrameEndError[rxFrameHead] = rxSerialError;
+            rxFrameEndTime[rxFrameHead]  = micros64();
+
+            COMPILER_BARRIER();         // Entry must be complete before it is published
+
+            rxFrameHead = head;
         }
-        else
+
+        rxSerialError = false;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Receiver Update
+///////////////////////////////////////////////////////////////////////////////
+
+void rxUpdate(void)
+{
+    uint8_t  frame[RX_FRAME_MAX_SIZE];
+    uint16_t decoded[RX_MAX_CHANNELS];
+    uint8_t  back, channel, channels, status, tail;
+    uint16_t length;
+    uint32_t interval;
+    uint64_t frameTime;
+
+    while (rxFrameTail != rxFrameHead)
+    {
+        tail = rxFrameTail;
+
+        COMPILER_BARRIER();             // Head read before the entry it published
+
+        length    = rxFrameExtract(rxSerialBuffer, RX_SERIAL_BUFFER_SIZE, rxFrameStart, rxFrameEnd[tail], frame);
+        frameTime = rxFrameEndTime[tail];
+        channels  = 0;
+        status    = 0;
+
+        if (rxFrameEndError[tail])
+            length = 0;
+
+        rxFrameStart = rxFrameEnd[tail];
+
+        COMPILER_BARRIER();             // Entry read before the slot is handed back
+
+        rxFrameTail = (tail + 1) & (RX_FRAME_QUEUE_SIZE - 1);
+
+        switch (eepromConfig.receiverType)
+        {
+            case SPEKTRUM:
+                if (spektrumFrameDecode(frame, length, eepromConfig.spektrumHires, eepromConfig.spektrumChannels, spektrumChannelData) != 0)
+                {
+                    channels = (eepromConfig.spektrumChannels < SPEKTRUM_MAX_CHANNEL) ? eepromConfig.spektrumChannels : SPEKTRUM_MAX_CHANNEL;
+
+                    for (channel = 0; channel < channels; channel++)
+                        decoded[channel] = spektrumCommand(spektrumChannelData[channel], eepromConfig.spektrumHires);
+                }
+                break;
+
+            case SBUS:
+                channels = sbusFrameDecode(frame, length, decoded, &status);
+                break;
+
+            case SUMD:
+                channels = sumdFrameDecode(frame, length, decoded, &status);
+                break;
+
+            case IBUS:
+                channels = ibusFrameDecode(frame, length, decoded, &status);
+                break;
+        }
+
+        if (channels == 0)
+        {
+            rxStats.rejects++;
+            continue;
+        }
+
+        ///////////////////////////////
+
+        if (rxStats.frames != 0)
+        {
+            interval = (uint32_t)(frameTime - rxPreviousFrameTime);
+
+            if (interval < rxStats.intervalMin)
+                rxStats.intervalMin = interval;
+
+            if (interval > rxStats.intervalMax)
+                rxStats.intervalMax = interval;
+
+            rxStats.intervalSum += interval;
+        }
+
+        rxPreviousFrameTime = frameTime;
+        rxStats.frames++;
+
+        if (status & RX_FRAME_LOST)
+            rxStats.lost++;
+
+        // Failsafe values never reach the flight code, the last good
+        // channels stay and the lost frame watchdog keeps running
+
+        if (status & RX_FRAME_FAILSAFE)
         {
-            spektrumFramePosition++;
+            rxStats.failsafes++;
+            continue;
         }
 
-        if (spektrumFrameComplete)
-		{
-		    watchDogReset(frameLost);
-		    for (b = 3; b < SPEKTRUM_FRAME_SIZE; b += 2)
-		    {
-		        spektrumChannel = 0x0F & (spektrumFrame[b - 1] >> spektrumChannelShift);
-		        if (spektrumChannel < eepromConfig.spektrumChannels)
-		            spektrumChannelData[spektrumChannel] = ((uint32_t)(spektrumFrame[b - 1] & spektrumChannelMask) << 8) + spektrumFrame[b];
-		    }
-
-		    spektrumFrameComplete = false;
-		}
+        ///////////////////////////////
+
+        back = rxChannelFront ^ 1;
+
+        for (channel = 0; channel < RX_MAX_CHANNELS; channel++)
+            rxChannelData[back][channel] = (channel < channels) ? decoded[channel] : MINCOMMAND;
+
+        COMPILER_BARRIER();             // Channels must be complete before they are published
+
+        rxChannelFront   = back;
+        rxSerialChannels = channels;
+        rxFrameSequence++;
+
+        rxFrameTime = frameTime;
+        rcActive    = true;
+
+        watchDogReset(frameLost);
     }
 }
 
@@ -300,10 +451,14 @@ void rxInit(void)
     TIM_TimeBaseInitTypeDef  TIM_TimeBaseStructure;
     NVIC_InitTypeDef         NVIC_InitStructure;
     USART_InitTypeDef        USART_InitStructure;
+    DMA_InitTypeDef          DMA_InitStructure;
+
+    static uint8_t frameLostRegistered = false;
 
     TIM_TimeBaseStructInit(&TIM_TimeBaseStructure);
     TIM_ICStructInit(&TIM_ICInitStructure);
     USART_StructInit(&USART_InitStructure);
+    DMA_StructInit(&DMA_InitStructure);
 
     ///////////////////////////////////
 
@@ -450,9 +605,9 @@ void rxInit(void)
 
 	///////////////////////////////////
 
-	else if (eepromConfig.receiverType == SPEKTRUM)
+	else if (SERIAL_RECEIVER(eepromConfig.receiverType))
 	{
-        // Spektrum Satellite RX Input
+        // Spektrum Satellite, SBUS, SUMD or IBUS RX Input
     	// USART3 RX P9
 
         RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOD, ENABLE);
@@ -482,30 +637,101 @@ void rxInit(void)
         USART_InitStructure.USART_Mode                = USART_Mode_Rx;
         USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
 
-        USART_Init(USART3, &USART_InitStructure);
+        // SBUS is 100 kbaud 8E2, the parity bit makes it a 9 bit word.  The
+        // F4 USART cannot invert its input, SBUS needs the usual inverter.
 
-        USART_ITConfig(USART3, USART_IT_RXNE, ENABLE);
-        USART_Cmd(USART3, ENABLE);
+        if (eepromConfig.receiverType == SBUS)
+        {
+            USART_InitStructure.USART_BaudRate   = 100000;
+            USART_InitStructure.USART_WordLength = USART_WordLength_9b;
+            USART_InitStructure.USART_StopBits   = USART_StopBits_2;
+            USART_InitStructure.USART_Parity     = USART_Parity_Even;
+        }
+
+        USART_Cmd(USART3, DISABLE);
+        USART_DMACmd(USART3, USART_DMAReq_Rx, DISABLE);
+
+        USART_Init(USART3, &USART_InitStructure);
 
         ///////////////////////////////
 
-        if (eepromConfig.spektrumHires)
+        // Called again after an ESC protocol change, DShot may have taken
+        // the stream since, only release it if it is still ours
+
+        RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
+
+        if ((DMA1_Stream1->CR & DMA_SxCR_CHSEL) == DMA_Channel_4)
+            DMA_DeInit(DMA1_Stream1);
+
+        rxSerialDma      = (eepromConfig.escProtocol < ESC_PROTOCOL_DSHOT150);
+        rxSerialPosition = 0;
+        rxSerialError    = false;
+        rxFrameHead      = 0;
+        rxFrameTail      = 0;
+        rxFrameStart     = 0;
+
+        switch (eepromConfig.receiverType)
+        {
+            case SPEKTRUM:
+                rxSerialChannels = (eepromConfig.spektrumChannels < SPEKTRUM_MAX_CHANNEL) ? eepromConfig.spektrumChannels : SPEKTRUM_MAX_CHANNEL;
+                break;
+            case SBUS:
+                rxSerialChannels = SBUS_CHANNELS;
+                break;
+            case SUMD:
+                rxSerialChannels = 8;  // Until the first frame says
+                break;
+            case IBUS:
+                rxSerialChannels = IBUS_CHANNELS;
+                break;
+        }
+
+        memset(&rxStats, 0, sizeof(rxStats));
+
+        rxStats.intervalMin = UINT32_MAX;
+
+        for (i = 0; i < RX_MAX_CHANNELS; i++)
         {
-		    // 11 bit frames
-		    spektrumChannelShift = 3;
-		    spektrumChannelMask  = 0x07;
-		}
-		else
-		{
-		    // 10 bit frames
-		    spektrumChannelShift = 2;
-		    spektrumChannelMask  = 0x03;
-		}
+            rxChannelData[0][i] = MINCOMMAND;
+            rxChannelData[1][i] = MINCOMMAND;
+        }
+
+        if (rxSerialDma)
+        {
+            DMA_InitStructure.DMA_Channel            = DMA_Channel_4;
+            DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&USART3->DR;
+            DMA_InitStructure.DMA_Memory0BaseAddr    = (uint32_t)rxSerialBuffer;
+          //DMA_InitStructure.DMA_DIR                = DMA_DIR_PeripheralToMemory;
+            DMA_InitStructure.DMA_BufferSize         = RX_SERIAL_BUFFER_SIZE;
+          //DMA_InitStructure.DMA_PeripheralInc      = DMA_PeripheralInc_Disable;
+            DMA_InitStructure.DMA_MemoryInc          = DMA_MemoryInc_Enable;
+          //DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+          //DMA_InitStructure.DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte;
+            DMA_InitStructure.DMA_Mode               = DMA_Mode_Circular;
+            DMA_InitStructure.DMA_Priority           = DMA_Priority_Medium;
+          //DMA_InitStructure.DMA_FIFOMode           = DMA_FIFOMode_Disable;
+          //DMA_InitStructure.DMA_FIFOThreshold      = DMA_FIFOThreshold_1QuarterFull;
+          //DMA_InitStructure.DMA_MemoryBurst        = DMA_MemoryBurst_Single;
+          //DMA_InitStructure.DMA_PeripheralBurst    = DMA_PeripheralBurst_Single;
+
+            DMA_Init(DMA1_Stream1, &DMA_InitStructure);
+
+            DMA_Cmd(DMA1_Stream1, ENABLE);
+
+            USART_DMACmd(USART3, USART_DMAReq_Rx, ENABLE);
+        }
+
+        USART_ITConfig(USART3, USART_IT_RXNE, rxSerialDma ? DISABLE : ENABLE);
+        USART_ITConfig(USART3, USART_IT_IDLE, ENABLE);
+        USART_Cmd(USART3, ENABLE);
 
         ///////////////////////////////
 
-	    watchDogRegister(&frameReset, frameResetTime, rxFrameReset, true );
-	    watchDogRegister(&frameLost,  frameLostTime,  rxFrameLost,  true );
+        if (frameLostRegistered == false)
+        {
+	        watchDogRegister(&frameLost, frameLostTime, rxFrameLost, true);
+	        frameLostRegistered = true;
+	    }
 	}
 
 	///////////////////////////////////
@@ -517,29 +743,46 @@ void rxInit(void)
 
 uint16_t rxRead(uint8_t channel)
 {
-    uint16_t data;
-
-    if (eepromConfig.receiverType == SPEKTRUM)
+    if (SERIAL_RECEIVER(eepromConfig.receiverType))
     {
-        if (channel >= eepromConfig.spektrumChannels)
-    	{
-    	    data = MINCOMMAND;
-    	}
-       	else
-       	{
-       	    if (eepromConfig.spektrumHires)
-       	        data = 1000 + spektrumChannelData[channel];         // 2048 mode
-       	    else
-       	        data = (1000 + spektrumChannelData[channel]) << 1;  // 1024 mode
-       	}
-        return data;
+        if (channel >= RX_MAX_CHANNELS)
+            return MINCOMMAND;
+
+        return rxChannelData[rxChannelFront][channel];
     }
     else
     {
+        if (channel >= 8)
+            return MINCOMMAND;
+
         return Inputs[channel].pulseWidth;
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Receiver Channel Count
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t rxChannelCount(void)
+{
+    if (SERIAL_RECEIVER(eepromConfig.receiverType))
+        return rxSerialChannels;
+    else
+        return 8;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Receiver Frame Interval
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t rxFrameIntervalMean(void)
+{
+    if (rxStats.frames < 2)
+        return 0;
+
+    return (uint32_t)(rxStats.intervalSum / (rxStats.frames - 1));
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Check Spektrum Bind
 ///////////////////////////////////////////////////////////////////////////////
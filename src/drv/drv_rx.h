@@ -42,13 +42,27 @@
 
 extern uint8_t rcActive;
 
+extern volatile uint64_t rxFrameTime;
+
 ///////////////////////////////////////////////////////////////////////////////
-// Spektrum Satellite Receiver Defines and Variables
+// Serial Receiver Defines and Variables
 ///////////////////////////////////////////////////////////////////////////////
 
-#define SPEKTRUM_MAX_CHANNEL 12
+extern volatile uint32_t rxFrameSequence;  // Bumped for every decoded frame
+
+typedef struct rxStats_t
+{
+    uint32_t frames;                       // Passed their checks, failsafe frames included
+    uint32_t rejects;                      // Length, header, checksum, parity or framing errors
+    uint32_t failsafes;                    // Flagged failsafe by the receiver, channels kept
+    uint32_t lost;                         // Flagged as a repeat by the receiver
 
-extern uint32_t spektrumChannelData[SPEKTRUM_MAX_CHANNEL];
+    uint32_t intervalMin;                  // uSec between good frames
+    uint32_t intervalMax;
+    uint64_t intervalSum;
+} rxStats_t;
+
+extern rxStats_t rxStats;
 
 ///////////////////////////////////////////////////////////////////////////////
 // Receiver Initialization
@@ -56,12 +70,30 @@ extern uint32_t spektrumChannelData[SPEKTRUM_MAX_CHANNEL];
 
 void rxInit(void);
 
+///////////////////////////////////////////////////////////////////////////////
+// Receiver Update, decodes the serial frames received since the last call
+///////////////////////////////////////////////////////////////////////////////
+
+void rxUpdate(void);
+
 ///////////////////////////////////////////////////////////////////////////////
 // Receiver Read
 ///////////////////////////////////////////////////////////////////////////////
 
 uint16_t rxRead(uint8_t channel);
 
+///////////////////////////////////////////////////////////////////////////////
+// Receiver Channel Count
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t rxChannelCount(void);
+
+///////////////////////////////////////////////////////////////////////////////
+// Receiver Frame Interval
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t rxFrameIntervalMean(void);
+
 ///////////////////////////////////////////////////////////////////////////////
 // Check Spektrum Bind
 ///////////////////////////////////////////////////////////////////////////////
@@ -49,13 +49,18 @@
 // Cycles per microsecond
 static volatile uint32_t usTicks = 0;
 
+static timebase_t timebase;
+
 ///////////////////////////////////////////////////////////////////////////////
 
-// Current uptime for 1kHz systick timer. will rollover after 49 days.
-// Hopefully we won't care.
+// Current uptime for 1kHz systick timer. will rollover after 49 days,
+// sysTickUptimeHigh extends it to 64 bits for micros64()/cycles64().
 static volatile uint32_t sysTickUptime = 0;
+static volatile uint32_t sysTickUptimeHigh = 0;
 static volatile uint32_t sysTickCycleCounter = 0;
 
+static uint8_t mpu6000Stalled = false;
+
 ///////////////////////////////////////////////////////////////////////////////
 // Cycle Counter
 ///////////////////////////////////////////////////////////////////////////////
@@ -66,6 +71,8 @@ static void cycleCounterInit(void)
     RCC_GetClocksFreq(&clocks);
     usTicks = clocks.SYSCLK_Frequency / 1000000;
 
+    timebaseInit(&timebase, clocks.SYSCLK_Frequency);
+
     // enable DWT access
     CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
     // enable the CPU cycle counter
@@ -78,13 +85,6 @@ static void cycleCounterInit(void)
 
 uint16_t frameCounter = 0;
 
-semaphore_t frame_500Hz = false;
-semaphore_t frame_100Hz = false;
-semaphore_t frame_50Hz  = false;
-semaphore_t frame_10Hz  = false;
-semaphore_t frame_5Hz   = false;
-semaphore_t frame_1Hz   = false;
-
 uint32_t deltaTime1000Hz, executionTime1000Hz, previous1000HzTime;
 uint32_t deltaTime500Hz,  executionTime500Hz,  previous500HzTime;
 uint32_t deltaTime100Hz,  executionTime100Hz,  previous100HzTime;
@@ -105,19 +105,158 @@ semaphore_t execUp = false;
 #endif
 
 
+///////////////////////////////////////
+// Deferred Work
+///////////////////////////////////////
+
+workQueue_t systemWorkQueue;
+
+uint32_t executionTimePendSV;
+
+isrTime_t sysTickTime, pendSVTime;
+
+///////////////////////////////////////////////////////////////////////////////
+// ISR Time Statistics
+///////////////////////////////////////////////////////////////////////////////
+
+void isrTimeUpdate(isrTime_t *isrTime, uint32_t executionTime)
+{
+    if ((isrTime->count == 0) || (executionTime < isrTime->min))
+        isrTime->min = executionTime;
+
+    if (executionTime > isrTime->max)
+        isrTime->max = executionTime;
+
+    isrTime->sum += executionTime;
+    isrTime->count++;
+}
+
+///////////////////////////////////////
+
+void isrTimeReset(void)
+{
+    memset(&sysTickTime, 0, sizeof(isrTime_t));
+    memset(&pendSVTime,  0, sizeof(isrTime_t));
+
+    memset(&rateLoop.executionTime, 0, sizeof(isrTime_t));
+    memset(&rateLoop.latency,       0, sizeof(isrTime_t));
+
+    systemWorkQueue.maxDepth     = 0;
+    systemWorkQueue.droppedCount = 0;
+}
+
+///////////////////////////////////////
+
+uint32_t isrTimeMean(isrTime_t *isrTime)
+{
+    if (isrTime->count == 0)
+        return 0;
+
+    return (uint32_t)(isrTime->sum / isrTime->count);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MXR9150 Accumulation Work
+///////////////////////////////////////////////////////////////////////////////
+
+static void mxr9150Work(uint32_t frame)
+{
+    uint8_t index;
+    float mxrTemp[3];
+
+    mxrTemp[XAXIS] = mxr9150Xaxis();
+    mxrTemp[YAXIS] = mxr9150Yaxis();
+    mxrTemp[ZAXIS] = mxr9150Zaxis();
+
+    accelSum500HzMXR[XAXIS] += mxrTemp[XAXIS];
+	accelSum500HzMXR[YAXIS] += mxrTemp[YAXIS];
+	accelSum500HzMXR[ZAXIS] += mxrTemp[ZAXIS];
+
+	accelSum100HzMXR[XAXIS] += mxrTemp[XAXIS];
+	accelSum100HzMXR[YAXIS] += mxrTemp[YAXIS];
+	accelSum100HzMXR[ZAXIS] += mxrTemp[ZAXIS];
+
+    if ((frame % COUNT_500HZ) == 0)
+    {
+        for (index = 0; index < 3; index++)
+        {
+        	accelSummedSamples500HzMXR[index] = accelSum500HzMXR[index];
+        	accelSum500HzMXR[index] = 0.0f;
+        }
+    }
+
+    if ((frame % COUNT_100HZ) == 0)
+    {
+        for (index = 0; index < 3; index++)
+        {
+            accelSummedSamples100HzMXR[index] = accelSum100HzMXR[index];
+            accelSum100HzMXR[index] = 0.0f;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MS5611 Work
+///////////////////////////////////////////////////////////////////////////////
+
+static void ms5611Work(uint32_t unused)
+{
+    if (!newTemperatureReading)
+	{
+		readTemperatureRequestPressure(MS5611_I2C);
+	    newTemperatureReading = true;
+	}
+	else
+	{
+	    readPressureRequestTemperature(MS5611_I2C);
+	    newPressureReading = true;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// HMC5883 Work
+///////////////////////////////////////////////////////////////////////////////
+
+static void hmc5883Work(uint32_t unused)
+{
+    newMagData = readMag(HMC5883L_I2C);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Disk Timer Work
+///////////////////////////////////////////////////////////////////////////////
+
+static void diskTimerWork(uint32_t unused)
+{
+    disk_timerproc();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // SysTick
+//
+// Runs above PendSV.  Only captures IMU data and posts the bus and float
+// work, which PendSV runs as soon as SysTick returns.  A slow I2C
+// transaction then delays PendSV, never the next SysTick.
 ///////////////////////////////////////////////////////////////////////////////
 
 void SysTick_Handler(void)
 {
-    uint8_t index;
     uint32_t currentTime;
-    float mxrTemp[3];
+    bool     handedOff;
+
+    // Published with interrupts masked, the rate loop handlers preempt
+    // SysTick and must never see the new cycle base with the old count
+
+    __disable_irq();
 
-    sysTickCycleCounter = *DWT_CYCCNT;
+    sysTickCycleCounter += timebase.cyclesPerTick;  // Where the tick was, not when the handler got to run
     sysTickUptime++;
 
+    if (sysTickUptime == 0)
+        sysTickUptimeHigh++;
+
+    __enable_irq();
+
     watchDogsTick();
 
     if ((systemReady         == true)  &&
@@ -142,48 +281,35 @@ void SysTick_Handler(void)
         deltaTime1000Hz = currentTime - previous1000HzTime;
         previous1000HzTime = currentTime;
 
-        readMPU6000();
-
-        accelSum500Hz[XAXIS] += rawAccel[XAXIS].value;
-        accelSum500Hz[YAXIS] += rawAccel[YAXIS].value;
-        accelSum500Hz[ZAXIS] += rawAccel[ZAXIS].value;
-
-        accelSum100Hz[XAXIS] += rawAccel[XAXIS].value;
-        accelSum100Hz[YAXIS] += rawAccel[YAXIS].value;
-        accelSum100Hz[ZAXIS] += rawAccel[ZAXIS].value;
-
-        gyroSum500Hz[ROLL ] += rawGyro[ROLL ].value;
-        gyroSum500Hz[PITCH] += rawGyro[PITCH].value;
-        gyroSum500Hz[YAW  ] += rawGyro[YAW  ].value;
+        mpu6000FifoRequest();
 
-        mxrTemp[XAXIS] = mxr9150Xaxis();
-        mxrTemp[YAXIS] = mxr9150Yaxis();
-        mxrTemp[ZAXIS] = mxr9150Zaxis();
-
-        accelSum500HzMXR[XAXIS] += mxrTemp[XAXIS];
-		accelSum500HzMXR[YAXIS] += mxrTemp[YAXIS];
-		accelSum500HzMXR[ZAXIS] += mxrTemp[ZAXIS];
-
-		accelSum100HzMXR[XAXIS] += mxrTemp[XAXIS];
-		accelSum100HzMXR[YAXIS] += mxrTemp[YAXIS];
-		accelSum100HzMXR[ZAXIS] += mxrTemp[ZAXIS];
+        workQueuePost(&systemWorkQueue, mxr9150Work, frameCounter);
 
         ///////////////////////////////
 
         if ((frameCounter % COUNT_500HZ) == 0)
         {
-            frame_500Hz = true;
+            __disable_irq();
+            handedOff = mpu6000AccumulatorHandoff(&mpu6000Sum500Hz, &mpu6000Summed500Hz);
+            __enable_irq();
+
+            // Not one sample in 2 mSec, the tasks keep their last sensor values
+            // and skip the integrations.  The first miss of a run raises the
+            // EVR, so a data ready line that never fires shows at once.
 
-            for (index = 0; index < 3; index++)
+            if (handedOff == true)
+            {
+                newMpu6000Data500Hz = true;
+                mpu6000Stalled      = false;
+            }
+            else
             {
-            	accelSummedSamples500Hz[index] = accelSum500Hz[index];
-            	accelSum500Hz[index] = 0;
+                mpu6000StallCount++;
 
-            	accelSummedSamples500HzMXR[index] = accelSum500HzMXR[index];
-            	accelSum500HzMXR[index] = 0.0f;
+                if (mpu6000Stalled == false)
+                    evrPush(EVR_Mpu6000DataStall, 0);
 
-            	gyroSummedSamples500Hz[index] = gyroSum500Hz[index];
-                gyroSum500Hz[index] = 0;
+                mpu6000Stalled = true;
             }
         }
 
@@ -191,59 +317,36 @@ void SysTick_Handler(void)
 
         if ((frameCounter % COUNT_100HZ) == 0)
         {
-            frame_100Hz = true;
+            __disable_irq();
+            handedOff = mpu6000AccumulatorHandoff(&mpu6000Sum100Hz, &mpu6000Summed100Hz);
+            __enable_irq();
 
-            for (index = 0; index < 3; index++)
-            {
-                accelSummedSamples100Hz[index] = accelSum100Hz[index];
-                accelSum100Hz[index] = 0;
-
-                accelSummedSamples100HzMXR[index] = accelSum100HzMXR[index];
-                accelSum100HzMXR[index] = 0.0f;
-            }
-
-            if (!newTemperatureReading)
-			{
-				readTemperatureRequestPressure(MS5611_I2C);
-			    newTemperatureReading = true;
-			}
-			else
-			{
-			    readPressureRequestTemperature(MS5611_I2C);
-			    newPressureReading = true;
-			}
-
-            disk_timerproc();
+            if (handedOff == true)
+                newMpu6000Data100Hz = true;
 
+            workQueuePost(&systemWorkQueue, ms5611Work,    0);
+            workQueuePost(&systemWorkQueue, diskTimerWork, 0);
         }
 
         ///////////////////////////////
 
-        if ((frameCounter % COUNT_50HZ) == 0)
-            frame_50Hz = true;
-
-        ///////////////////////////////
-
         if (((frameCounter + 1) % COUNT_10HZ) == 0)
-            newMagData = readMag(HMC5883L_I2C);
-
-        if ((frameCounter % COUNT_10HZ) == 0)
-            frame_10Hz = true;
+            workQueuePost(&systemWorkQueue, hmc5883Work, 0);
 
         ///////////////////////////////
 
-        if ((frameCounter % COUNT_5HZ) == 0)
-            frame_5Hz = true;
+        SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
 
         ///////////////////////////////
 
-        if ((frameCounter % COUNT_1HZ) == 0)
-            frame_1Hz = true;
+        schedulerTick(frameCounter, currentTime);
 
         ///////////////////////////////////
 
         executionTime1000Hz = micros() - currentTime;
 
+        isrTimeUpdate(&sysTickTime, executionTime1000Hz);
+
         ///////////////////////////////
 
         #ifdef _DTIMING
@@ -252,13 +355,34 @@ void SysTick_Handler(void)
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// PendSV
+//
+// Bottom half of SysTick, lowest priority of all interrupts.
+///////////////////////////////////////////////////////////////////////////////
+
+void PendSV_Handler(void)
+{
+    uint32_t startTime;
+
+    startTime = micros();
+
+    while (workQueueRun(&systemWorkQueue));
+
+    executionTimePendSV = micros() - startTime;
+
+    isrTimeUpdate(&pendSVTime, executionTimePendSV);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // System Time in Microseconds
 //
 // Note: This can be called from within IRQ Handlers, so uses LDREX/STREX.
 // If a higher priority IRQ or DMA or anything happens the STREX will fail
 // and restart the loop. Otherwise the same number that was read is harmlessly
-// written back.
+// written back.  A handler that preempts SysTick itself cannot retry its way
+// past it, SysTick publishes the count and the cycle base with interrupts
+// masked so such a reader sees both stores or neither.
 ///////////////////////////////////////////////////////////////////////////////
 
 uint32_t micros(void)
@@ -273,7 +397,49 @@ uint32_t micros(void)
     }
     while ( __STREXW( timeMs , &sysTickUptime ) );
 
-    return (timeMs * 1000) + (cycle - oldCycle) / usTicks;
+    return (timeMs * 1000) + timebaseCyclesToMicros(&timebase, cycle - oldCycle);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 64 Bit System Time in Microseconds and Cycles
+//
+// Same LDREX/STREX retry as micros(), a SysTick between the reads clears
+// the exclusive monitor so the high and low words always match, and the
+// same masked publish for readers that preempt SysTick.
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t micros64(void)
+{
+    register uint32_t oldCycle, cycle, timeMs, timeMsHigh;
+
+    do
+    {
+        timeMs = __LDREXW(&sysTickUptime);
+        timeMsHigh = sysTickUptimeHigh;
+        cycle = *DWT_CYCCNT;
+        oldCycle = sysTickCycleCounter;
+    }
+    while ( __STREXW( timeMs , &sysTickUptime ) );
+
+    return timebaseMicros(&timebase, ((uint64_t)timeMsHigh << 32) | timeMs, cycle - oldCycle);
+}
+
+///////////////////////////////////////
+
+uint64_t cycles64(void)
+{
+    register uint32_t oldCycle, cycle, timeMs, timeMsHigh;
+
+    do
+    {
+        timeMs = __LDREXW(&sysTickUptime);
+        timeMsHigh = sysTickUptimeHigh;
+        cycle = *DWT_CYCCNT;
+        oldCycle = sysTickCycleCounter;
+    }
+    while ( __STREXW( timeMs , &sysTickUptime ) );
+
+    return timebaseCycles(&timebase, ((uint64_t)timeMsHigh << 32) | timeMs, cycle - oldCycle);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -300,6 +466,31 @@ void checkResetType()
 
 ///////////////////////////////////////
 
+// One grouping for the whole firmware, 2 bits of preemption priority and
+// 2 of subpriority.  Drivers set their own channels as they init, these
+// are set again once all of them are up so the order below holds:
+//
+//   0  I2C event and error
+//   1  MPU6000 data ready and SPI DMA (rate loop), USART DMA, USB
+//   2  SysTick, receiver
+//   3  PendSV deferred work
+
+static void interruptPrioritiesInit(void)
+{
+    uint32_t grouping;
+
+    NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
+
+    grouping = NVIC_GetPriorityGrouping();
+
+    NVIC_SetPriority(MPU6000_INT_IRQn,  NVIC_EncodePriority(grouping, 1, 0));
+    NVIC_SetPriority(DMA1_Stream0_IRQn, NVIC_EncodePriority(grouping, 1, 0));
+    NVIC_SetPriority(SysTick_IRQn,      NVIC_EncodePriority(grouping, 2, 0));  // Above PendSV so it preempts deferred work
+    NVIC_SetPriority(PendSV_IRQn,       NVIC_EncodePriority(grouping, 3, 3));  // Lowest
+}
+
+///////////////////////////////////////
+
 void systemInit(void)
 {
 	// Init cycle counter
@@ -308,6 +499,8 @@ void systemInit(void)
     // SysTick
     SysTick_Config(SystemCoreClock / 1000);
 
+    sysTickCycleCounter = *DWT_CYCCNT;  // Ticks follow every cyclesPerTick from here
+
     checkResetType();
 
     checkFirstTime(false);
@@ -316,7 +509,7 @@ void systemInit(void)
 	if (eepromConfig.receiverType == SPEKTRUM)
 		checkSpektrumBind();
 
-	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);  // 2 bits for pre-emption priority, 2 bits for subpriority
+	interruptPrioritiesInit();
 
 	initMixer();
 
@@ -329,7 +522,7 @@ void systemInit(void)
     gpsInit();
     i2cInit(I2C1);
     i2cInit(I2C2);
-    pwmEscInit(eepromConfig.escPwmRate);
+    pwmEscInit(eepromConfig.escProtocol, eepromConfig.escPwmRate);
     pwmServoInit(eepromConfig.servoPwmRate);
     rxInit();
     spiInit(SPI2);
@@ -351,10 +544,17 @@ void systemInit(void)
 
     initMax7456();
 
-    initFirstOrderFilter();
+    interruptPrioritiesInit();  // Again, after every driver has set its own
+
+    filterBankInit();
+    dynamicNotchInit();
     logInit();
 
     initPID();
+    rcSmoothingInit(&rcSmoothing, eepromConfig.rcSmoothing);
+    rateLoopInit();
+
+    attitudeEKFreset(&attitudeEKF);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -59,13 +59,6 @@
 
 extern uint16_t frameCounter;
 
-extern semaphore_t frame_500Hz;
-extern semaphore_t frame_100Hz;
-extern semaphore_t frame_50Hz;
-extern semaphore_t frame_10Hz;
-extern semaphore_t frame_5Hz;
-extern semaphore_t frame_1Hz;
-
 extern uint32_t deltaTime1000Hz, executionTime1000Hz, previous1000HzTime;
 extern uint32_t deltaTime500Hz,  executionTime500Hz,  previous500HzTime;
 extern uint32_t deltaTime100Hz,  executionTime100Hz,  previous100HzTime;
@@ -76,6 +69,24 @@ extern uint32_t deltaTime1Hz,    executionTime1Hz,    previous1HzTime;
 
 extern float dt500Hz, dt100Hz;
 
+///////////////////////////////////////
+// Deferred Work Variables
+///////////////////////////////////////
+
+typedef struct isrTime_t
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} isrTime_t;
+
+extern workQueue_t systemWorkQueue;
+
+extern uint32_t executionTimePendSV;
+
+extern isrTime_t sysTickTime, pendSVTime;
+
 extern semaphore_t systemReady;
 
 extern semaphore_t execUp;
@@ -86,6 +97,18 @@ void systemInit(void);
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void isrTimeUpdate(isrTime_t *isrTime, uint32_t executionTime);
+
+///////////////////////////////////////////////////////////////////////////////
+
+void isrTimeReset(void);
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t isrTimeMean(isrTime_t *isrTime);
+
+///////////////////////////////////////////////////////////////////////////////
+
 void delayMicroseconds(uint32_t us);
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -98,6 +121,14 @@ uint32_t micros(void);
 
 ///////////////////////////////////////////////////////////////////////////////
 
+uint64_t micros64(void);
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t cycles64(void);
+
+///////////////////////////////////////////////////////////////////////////////
+
 uint32_t millis(void);
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -60,35 +60,27 @@
 volatile uint8_t rx1Buffer[UART1_BUFFER_SIZE];
 uint32_t rx1DMAPos = 0;
 
-volatile uint8_t tx1Buffer[UART1_BUFFER_SIZE];
-volatile uint16_t tx1BufferTail = 0;
-volatile uint16_t tx1BufferHead = 0;
+// Transmit ring, sent by DMA straight from the buffer, see txRing.c
+static uint8_t tx1Buffer[UART1_BUFFER_SIZE];
 
-volatile uint8_t  tx1DmaEnabled = false;
+txRing_t telemetryTxRing;
 
 ///////////////////////////////////////////////////////////////////////////////
 // UART1 Transmit via DMA
 ///////////////////////////////////////////////////////////////////////////////
 
-static void uart1TxDMA(void)
+static void uart1TxDMA(txRing_t *ring)
 {
-	if ((tx1DmaEnabled == true) || (tx1BufferHead == tx1BufferTail))  // Ignore call if already active or no new data in buffer
-        return;
+    const uint8_t *data;
+    uint16_t      length;
 
-    DMA2_Stream7->M0AR = (uint32_t)&tx1Buffer[tx1BufferTail];
+    length = txRingSendStart(ring, &data);
 
-    if (tx1BufferHead > tx1BufferTail)
-    {
-	    DMA_SetCurrDataCounter(DMA2_Stream7, tx1BufferHead - tx1BufferTail);
-	    tx1BufferTail = tx1BufferHead;
-    }
-    else
-    {
-	    DMA_SetCurrDataCounter(DMA2_Stream7, UART1_BUFFER_SIZE - tx1BufferTail);
-	    tx1BufferTail = 0;
-    }
+    if (length == 0)  // Ignore call if already active or no new data in buffer
+        return;
 
-    tx1DmaEnabled = true;
+    DMA2_Stream7->M0AR = (uint32_t)data;
+    DMA_SetCurrDataCounter(DMA2_Stream7, length);
 
     DMA_Cmd(DMA2_Stream7, ENABLE);
 }
@@ -101,9 +93,9 @@ void DMA2_Stream7_IRQHandler(void)
 {
     DMA_ClearITPendingBit(DMA2_Stream7, DMA_IT_TCIF7);
 
-    tx1DmaEnabled = false;
+    txRingSendDone(&telemetryTxRing);
 
-    uart1TxDMA();
+    uart1TxDMA(&telemetryTxRing);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -216,6 +208,8 @@ void telemetryInit(void)
 
     DMA_SetCurrDataCounter(DMA2_Stream7, 0);
 
+    txRingInit(&telemetryTxRing, tx1Buffer, UART1_BUFFER_SIZE, uart1TxDMA);
+
     DMA_ITConfig(DMA2_Stream7, DMA_IT_TC, ENABLE);
 
     USART_DMACmd(USART1, USART_DMAReq_Tx, ENABLE);
@@ -264,12 +258,30 @@ uint8_t telemetryReadPoll(void)
 // Telemetry Write
 ///////////////////////////////////////////////////////////////////////////////
 
+// Writes that do not fit in the transmit ring are dropped whole and
+// counted in telemetryTxRing, rather than written over data not yet sent.
+
 void telemetryWrite(uint8_t ch)
 {
-    tx1Buffer[tx1BufferHead] = ch;
-    tx1BufferHead = (tx1BufferHead + 1) % UART1_BUFFER_SIZE;
+    txRingWrite(&telemetryTxRing, &ch, 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Write Buffer
+///////////////////////////////////////////////////////////////////////////////
 
-    uart1TxDMA();
+void telemetryWriteBuffer(const uint8_t *data, uint16_t length)
+{
+    txRingWrite(&telemetryTxRing, data, length);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry TX Free
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t telemetryTxFree(void)
+{
+    return txRingFree(&telemetryTxRing);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -278,13 +290,7 @@ void telemetryWrite(uint8_t ch)
 
 void telemetryPrint(char *str)
 {
-    while (*str)
-    {
-    	tx1Buffer[tx1BufferHead] = *str++;
-    	tx1BufferHead = (tx1BufferHead + 1) % UART1_BUFFER_SIZE;
-    }
-
-	uart1TxDMA();
+    txRingWrite(&telemetryTxRing, (const uint8_t *)str, (uint16_t)strlen(str));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -38,6 +38,10 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
+extern txRing_t telemetryTxRing;
+
+///////////////////////////////////////////////////////////////////////////////
+
 void telemetryInit(void);
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -58,6 +62,14 @@ void telemetryWrite(uint8_t ch);
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void telemetryWriteBuffer(const uint8_t *data, uint16_t length);
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t telemetryTxFree(void);
+
+///////////////////////////////////////////////////////////////////////////////
+
 void telemetryPrint(char *str);
 
 ///////////////////////////////////////////////////////////////////////////////
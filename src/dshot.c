@@ -0,0 +1,121 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// DShot frames and the timer compare values that send them, for the DMA
+// outputs in drv_pwmEsc.c.  A frame is the 11 bit throttle value, the
+// telemetry request bit and a 4 bit checksum, the XOR of the three
+// nibbles above it, sent MSB first.  Each bit is one timer period, high
+// for 75 % of it for a 1 and 37.5 % for a 0.
+//
+// A timer's update DMA writes all of its compare channels in one burst,
+// so the buffer for a timer interleaves its channels: entry bit * stride
+// + channel - 1.  Two zero entries after the frame hold the lines low
+// until the next one.  No hardware access in here, the host build checks
+// the frames and buffers and times them.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "escProtocol.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// DShot Timing Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void dshotTimingInit(dshotTiming_t *timing, uint32_t timerClock, uint32_t bitRate)
+{
+    timing->bitTicks  = timerClock / bitRate;
+    timing->oneTicks  = (timing->bitTicks * 3 + 2) / 4;
+    timing->zeroTicks = (timing->bitTicks * 3 + 4) / 8;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DShot Value
+///////////////////////////////////////////////////////////////////////////////
+
+// Motor commands, MINCOMMAND to MAXCOMMAND, onto the throttle values.
+// MINCOMMAND and below send 0, stop, which is what a disarmed mix gives.
+
+uint16_t dshotValue(uint16_t command)
+{
+    const uint32_t span = DSHOT_MAX_THROTTLE - DSHOT_MIN_THROTTLE;
+    const uint32_t full = ESC_COMMAND_MAX - ESC_COMMAND_MIN;
+
+    if (command <= ESC_COMMAND_MIN)
+        return 0;
+
+    if (command >= ESC_COMMAND_MAX)
+        return DSHOT_MAX_THROTTLE;
+
+    return (uint16_t)(DSHOT_MIN_THROTTLE + (command - ESC_COMMAND_MIN) * span / full);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DShot Frame
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t dshotFrame(uint16_t value, uint8_t telemetry)
+{
+    uint16_t packet = (uint16_t)(((value & 0x07FF) << 1) | (telemetry ? 1 : 0));
+
+    return (uint16_t)((packet << 4) | ((packet ^ (packet >> 4) ^ (packet >> 8)) & 0x0F));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DShot Encode
+///////////////////////////////////////////////////////////////////////////////
+
+// slot is the channel's first entry in its timer's buffer, stride the
+// number of channels in the burst.
+
+void dshotEncode(uint32_t *slot, uint8_t stride, uint16_t frame, const dshotTiming_t *timing)
+{
+    uint8_t bit;
+
+    for (bit = 0; bit < DSHOT_FRAME_BITS; bit++)
+    {
+        *slot  = (frame & 0x8000) ? timing->oneTicks : timing->zeroTicks;
+        slot  += stride;
+        frame  = (uint16_t)(frame << 1);
+    }
+
+    for (; bit < DSHOT_BUFFER_BITS; bit++)
+    {
+        *slot  = 0;
+        slot  += stride;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
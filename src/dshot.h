@@ -0,0 +1,85 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// DShot Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define DSHOT_FRAME_BITS      16       // 11 bit value, telemetry request, 4 bit checksum
+#define DSHOT_BUFFER_BITS     18       // Frame then two low bit periods
+#define DSHOT_MAX_CHANNELS     4       // Compare channels per timer, one DMA burst
+
+#define DSHOT_MIN_THROTTLE    48       // Values below are stop and ESC commands
+#define DSHOT_MAX_THROTTLE  2047
+
+typedef struct dshotTiming_t
+{
+    uint32_t bitTicks;                 // Timer ticks per bit
+    uint32_t oneTicks;                 // High time of a 1, 75 %
+    uint32_t zeroTicks;                // High time of a 0, 37.5 %
+} dshotTiming_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// DShot Timing Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void dshotTimingInit(dshotTiming_t *timing, uint32_t timerClock, uint32_t bitRate);
+
+///////////////////////////////////////////////////////////////////////////////
+// DShot Value
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t dshotValue(uint16_t command);
+
+///////////////////////////////////////////////////////////////////////////////
+// DShot Frame
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t dshotFrame(uint16_t value, uint8_t telemetry);
+
+///////////////////////////////////////////////////////////////////////////////
+// DShot Encode
+///////////////////////////////////////////////////////////////////////////////
+
+void dshotEncode(uint32_t *slot, uint8_t stride, uint16_t frame, const dshotTiming_t *timing);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,333 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Notch filters in the rate loop gyro path that follow the motor and prop
+// vibration peaks as they move with throttle.  The rate loop, the 500 Hz
+// task or the gyro sample interrupt, keeps the last DYNAMIC_NOTCH_FFT_SIZE
+// unfiltered samples of each axis and runs the notches.  The peak tracker
+// is a background task that does one stage of one axis per call, window,
+// real FFT, peak search, notch retune, so no single call costs more than
+// one 128 point FFT.  The notch sections keep their state when retuned,
+// and hold their last center while no peak stands out of the band.
+//
+// The retuned coefficients of an axis are staged and installed by the
+// rate loop before its next sample, so it never filters with a section
+// half written.  A window taken while the interrupt adds a sample may
+// hold one sample out of order, which the FFT does not notice.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic Notch Variables
+///////////////////////////////////////////////////////////////////////////////
+
+dynamicNotch_t dynamicNotch;
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic Notch Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void dynamicNotchInit(void)
+{
+    filterSectionConfig_t config[FILTER_SECTIONS];
+    filterSectionConfig_t passThrough = { FILTER_NONE, 0.0f, 0.0f };
+    float                 binWidth;
+    uint8_t               axis, index;
+
+    memset(&dynamicNotch, 0, sizeof(dynamicNotch));
+
+    dynamicNotch.sampleRate  = rateLoopGyroRate();
+    dynamicNotch.stagedAxis = DYNAMIC_NOTCH_NONE_STAGED;
+
+    binWidth = dynamicNotch.sampleRate / DYNAMIC_NOTCH_FFT_SIZE;
+
+    // Bins either side of the peak are needed for the interpolation
+
+    dynamicNotch.minBin = (uint8_t)constrain(eepromConfig.dynamicNotchMinHz / binWidth, 2.0f, DYNAMIC_NOTCH_FFT_SIZE / 2 - 2);
+    dynamicNotch.maxBin = (uint8_t)constrain(eepromConfig.dynamicNotchMaxHz / binWidth + 1.0f, dynamicNotch.minBin, DYNAMIC_NOTCH_FFT_SIZE / 2 - 2);
+
+    // Hann window
+
+    for (index = 0; index < DYNAMIC_NOTCH_FFT_SIZE; index++)
+        dynamicNotch.window[index] = 0.5f - 0.5f * cosf(TWO_PI * (float)index / DYNAMIC_NOTCH_FFT_SIZE);
+
+    arm_rfft_init_f32(&dynamicNotch.rfft, &dynamicNotch.cfft, DYNAMIC_NOTCH_FFT_SIZE, 0, 1);
+
+    // Every section starts as a pass through until its first peak is found
+
+    memset(config, 0, sizeof(config));
+
+    for (index = 0; index < DYNAMIC_NOTCH_PEAKS; index++)
+    {
+        config[index].type      = FILTER_NOTCH;
+        config[index].frequency = eepromConfig.dynamicNotchMinHz;
+        config[index].parameter = eepromConfig.dynamicNotchQ;
+    }
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        if (filterChainInit(&dynamicNotch.notch[axis], config, 1, dynamicNotch.sampleRate) == false)
+            return;  // Left disabled
+
+        for (index = 0; index < DYNAMIC_NOTCH_PEAKS; index++)
+            filterChainRetune(&dynamicNotch.notch[axis], index, &passThrough);
+    }
+
+    dynamicNotch.enabled = eepromConfig.dynamicNotchEnabled;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic Notch Filter
+///////////////////////////////////////////////////////////////////////////////
+
+void dynamicNotchFilter(float gyro[3])
+{
+    uint8_t axis;
+
+    if (dynamicNotch.enabled == false)
+        return;
+
+    if (dynamicNotch.stagedAxis != DYNAMIC_NOTCH_NONE_STAGED)
+    {
+        memcpy(dynamicNotch.notch[dynamicNotch.stagedAxis].coefficients, dynamicNotch.staged, sizeof(dynamicNotch.staged));
+
+        dynamicNotch.stagedAxis = DYNAMIC_NOTCH_NONE_STAGED;
+    }
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        dynamicNotch.samples[axis][dynamicNotch.sampleIndex] = gyro[axis];
+
+        filterChainUpdate(&dynamicNotch.notch[axis], &gyro[axis], &gyro[axis]);
+    }
+
+    dynamicNotch.sampleIndex = (dynamicNotch.sampleIndex + 1) & (DYNAMIC_NOTCH_FFT_SIZE - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Peak Search
+//
+// Up to DYNAMIC_NOTCH_PEAKS of the strongest local maxima in the band that
+// stand DYNAMIC_NOTCH_THRESHOLD over the noise floor, each placed between
+// bins by a parabola through the magnitudes around it, in ascending
+// frequency.  The floor is the mean of the bins below the band mean, so a
+// strong fundamental does not hide its harmonic.
+///////////////////////////////////////////////////////////////////////////////
+
+static void findPeaks(void)
+{
+    const float32_t *power = dynamicNotch.fftInput;
+    float           bandPower = 0.0f, floorPower = 0.0f, below, at, above, offset, swap;
+    uint8_t         strongest[DYNAMIC_NOTCH_PEAKS];
+    uint8_t         bin, index, found = 0, floorBins = 0;
+
+    for (bin = dynamicNotch.minBin; bin <= dynamicNotch.maxBin; bin++)
+        bandPower += power[bin];
+
+    bandPower /= (float)(dynamicNotch.maxBin - dynamicNotch.minBin + 1);
+
+    for (bin = dynamicNotch.minBin; bin <= dynamicNotch.maxBin; bin++)
+    {
+        if (power[bin] <= bandPower)
+        {
+            floorPower += power[bin];
+            floorBins++;
+        }
+    }
+
+    floorPower /= (float)((floorBins > 0) ? floorBins : 1);
+
+    for (bin = dynamicNotch.minBin; bin <= dynamicNotch.maxBin; bin++)
+    {
+        if ((power[bin] <= power[bin - 1]) || (power[bin] < power[bin + 1]) ||
+            (power[bin] < DYNAMIC_NOTCH_THRESHOLD * floorPower))
+            continue;
+
+        // Insertion into the strongest so far, the weakest falls off the end
+
+        for (index = found; index > 0; index--)
+        {
+            if (power[bin] <= power[strongest[index - 1]])
+                break;
+
+            if (index < DYNAMIC_NOTCH_PEAKS)
+                strongest[index] = strongest[index - 1];
+        }
+
+        if (index < DYNAMIC_NOTCH_PEAKS)
+        {
+            strongest[index] = bin;
+
+            if (found < DYNAMIC_NOTCH_PEAKS)
+                found++;
+        }
+    }
+
+    for (index = 0; index < found; index++)
+    {
+        bin = strongest[index];
+
+        below = sqrtf(power[bin - 1]);
+        at    = sqrtf(power[bin    ]);
+        above = sqrtf(power[bin + 1]);
+
+        offset = 0.5f * (above - below) / (2.0f * at - below - above);
+
+        dynamicNotch.peak[index] = ((float)bin + offset) * dynamicNotch.sampleRate / DYNAMIC_NOTCH_FFT_SIZE;
+    }
+
+    for (index = 1; index < found; index++)
+    {
+        for (bin = index; (bin > 0) && (dynamicNotch.peak[bin - 1] > dynamicNotch.peak[bin]); bin--)
+        {
+            swap                       = dynamicNotch.peak[bin - 1];
+            dynamicNotch.peak[bin - 1] = dynamicNotch.peak[bin];
+            dynamicNotch.peak[bin]     = swap;
+        }
+    }
+
+    dynamicNotch.peaksFound = found;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Notch Retune
+///////////////////////////////////////////////////////////////////////////////
+
+static void retuneNotches(void)
+{
+    filterSectionConfig_t config;
+    float                 *center = dynamicNotch.center[dynamicNotch.axis];
+    float                 distance, nearest;
+    uint8_t               index, section, target;
+
+    config.type      = FILTER_NOTCH;
+    config.parameter = eepromConfig.dynamicNotchQ;
+
+    // Nothing is staged, so the rate loop leaves these coefficients alone
+
+    memcpy(dynamicNotch.staged, dynamicNotch.notch[dynamicNotch.axis].coefficients, sizeof(dynamicNotch.staged));
+
+    for (index = 0; index < dynamicNotch.peaksFound; index++)
+    {
+        // A full set of peaks maps in order, a single one to the closest
+        // tracked center, or the first idle section
+
+        if (dynamicNotch.peaksFound == DYNAMIC_NOTCH_PEAKS)
+        {
+            target = index;
+        }
+        else
+        {
+            target  = 0;
+            nearest = 1.0e6f;
+
+            for (section = 0; section < DYNAMIC_NOTCH_PEAKS; section++)
+            {
+                distance = (center[section] == 0.0f) ? 1.0e5f : fabsf(center[section] - dynamicNotch.peak[index]);
+
+                if (distance < nearest)
+                {
+                    nearest = distance;
+                    target  = section;
+                }
+            }
+        }
+
+        if (center[target] == 0.0f)
+            center[target] = dynamicNotch.peak[index];
+        else
+            center[target] += DYNAMIC_NOTCH_SMOOTHING * (dynamicNotch.peak[index] - center[target]);
+
+        config.frequency = constrain(center[target], eepromConfig.dynamicNotchMinHz, eepromConfig.dynamicNotchMaxHz);
+
+        filterSectionDesign(&config, dynamicNotch.sampleRate, &dynamicNotch.staged[5 * target]);  // Section kept if not realizable
+    }
+
+    COMPILER_BARRIER();
+
+    dynamicNotch.stagedAxis = dynamicNotch.axis;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic Notch Update
+///////////////////////////////////////////////////////////////////////////////
+
+void dynamicNotchUpdate(void)
+{
+    uint8_t index, sample;
+
+    if (dynamicNotch.enabled == false)
+        return;
+
+    switch (dynamicNotch.stage)
+    {
+        case DYNAMIC_NOTCH_WINDOW:
+            sample = dynamicNotch.sampleIndex;
+
+            for (index = 0; index < DYNAMIC_NOTCH_FFT_SIZE; index++)
+            {
+                dynamicNotch.fftInput[index] = dynamicNotch.samples[dynamicNotch.axis][sample] * dynamicNotch.window[index];
+
+                sample = (sample + 1) & (DYNAMIC_NOTCH_FFT_SIZE - 1);
+            }
+            break;
+
+        case DYNAMIC_NOTCH_FFT:
+            arm_rfft_f32(&dynamicNotch.rfft, dynamicNotch.fftInput, dynamicNotch.fftOutput);
+            break;
+
+        case DYNAMIC_NOTCH_PEAK:
+            arm_cmplx_mag_squared_f32(dynamicNotch.fftOutput, dynamicNotch.fftInput, DYNAMIC_NOTCH_FFT_SIZE / 2);
+            findPeaks();
+            break;
+
+        case DYNAMIC_NOTCH_RETUNE:
+            if (dynamicNotch.stagedAxis != DYNAMIC_NOTCH_NONE_STAGED)
+                return;  // Last retune not installed yet, try again next call
+
+            retuneNotches();
+
+            dynamicNotch.axis = (dynamicNotch.axis + 1) % 3;
+            dynamicNotch.updateCount++;
+            break;
+    }
+
+    dynamicNotch.stage = (dynamicNotch.stage + 1) % NUMBER_OF_DYNAMIC_NOTCH_STAGES;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,126 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "arm_math.h"
+
+#include "filterBank.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic Notch Defines
+///////////////////////////////////////////////////////////////////////////////
+
+#define DYNAMIC_NOTCH_FFT_SIZE   128   // 3.9 Hz bins, 256 ms window at 500 Hz, 7.8 Hz and 128 ms at 1 kHz
+
+#define DYNAMIC_NOTCH_PEAKS      2     // Notch sections per axis
+
+#define DYNAMIC_NOTCH_THRESHOLD  25.0f // Peak power over the noise floor, 10x the mean for white noise
+
+#define DYNAMIC_NOTCH_SMOOTHING  0.4f  // Per axis update, about 50 ms time constant
+
+#define DYNAMIC_NOTCH_NONE_STAGED  3   // stagedAxis with nothing waiting
+
+// Work done by one call of dynamicNotchUpdate(), one axis at a time
+
+enum { DYNAMIC_NOTCH_WINDOW,
+       DYNAMIC_NOTCH_FFT,
+       DYNAMIC_NOTCH_PEAK,
+       DYNAMIC_NOTCH_RETUNE,
+       NUMBER_OF_DYNAMIC_NOTCH_STAGES
+     };
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic Notch Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct dynamicNotch_t
+{
+    uint8_t   enabled;
+    float     sampleRate;
+
+    float32_t samples[3][DYNAMIC_NOTCH_FFT_SIZE];             // Ring of unfiltered gyros
+    uint8_t   sampleIndex;                                    // Oldest sample
+
+    float32_t window[DYNAMIC_NOTCH_FFT_SIZE];
+    float32_t fftInput[DYNAMIC_NOTCH_FFT_SIZE];               // Also the bin powers after the FFT
+    float32_t fftOutput[2 * DYNAMIC_NOTCH_FFT_SIZE];
+
+    arm_rfft_instance_f32        rfft;
+    arm_cfft_radix4_instance_f32 cfft;
+
+    uint8_t   minBin, maxBin;
+
+    uint8_t   axis;
+    uint8_t   stage;
+    uint8_t   peaksFound;
+    float     peak[DYNAMIC_NOTCH_PEAKS];                      // Hz, found for the current axis
+
+    float     center[3][DYNAMIC_NOTCH_PEAKS];                 // Hz, tracked, 0 until first found
+    filterChain_t notch[3];                                   // One axis each
+
+    float32_t staged[5 * FILTER_SECTIONS];                    // Retuned coefficients of stagedAxis
+    volatile uint8_t stagedAxis;                              // DYNAMIC_NOTCH_NONE_STAGED once installed
+
+    uint32_t  updateCount;                                    // Completed axis updates
+} dynamicNotch_t;
+
+extern dynamicNotch_t dynamicNotch;
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic Notch Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void dynamicNotchInit(void);
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic Notch Filter, rate loop
+///////////////////////////////////////////////////////////////////////////////
+
+void dynamicNotchFilter(float gyro[3]);
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic Notch Update, one bounded slice of the peak tracker
+///////////////////////////////////////////////////////////////////////////////
+
+void dynamicNotchUpdate(void);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,165 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Timer settings and pulse widths for the ESC outputs in drv_pwmEsc.c.
+// Motor commands stay in the 0.5 uSec counts of the PWM outputs, 2000 to
+// 4000 for 1 to 2 mSec, whatever the protocol.
+//
+// PWM runs the timers free at escPwmRate with the pulse at the start of
+// each period, as before.  OneShot runs them at the full 84 MHz in one
+// pulse mode.  Each write triggers a single period ESC_ONESHOT_LEAD
+// ticks longer than the longest pulse, and every pulse is placed at the
+// end of it, so all motors finish together one period after the trigger.
+// The counter stops at zero, below every compare value, so the outputs
+// idle low.  DShot runs them at 84 MHz with one period per bit, the bits
+// themselves come from dshot.c.  No hardware access in here, the host
+// build checks the arithmetic and the output map.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "escProtocol.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Outputs
+// ESC PWM1 TIM8_CH4 PC9
+// ESC PWM2 TIM8_CH3 PC8
+// ESC PWM3 TIM8_CH2 PC7
+// ESC PWM4 TIM8_CH1 PC6
+// ESC PWM5 TIM2_CH2 PB3
+// ESC PWM6 TIM3_CH1 PB4
+// ESC PWM7 TIM3_CH2 PB5
+// ESC PWM8 TIM2_CH1 PA15
+
+const escOutput_t escOutputs[8] = { { ESC_TIMER_TIM8, 4 },
+                                    { ESC_TIMER_TIM8, 3 },
+                                    { ESC_TIMER_TIM8, 2 },
+                                    { ESC_TIMER_TIM8, 1 },
+                                    { ESC_TIMER_TIM2, 2 },
+                                    { ESC_TIMER_TIM3, 1 },
+                                    { ESC_TIMER_TIM3, 2 },
+                                    { ESC_TIMER_TIM2, 1 }, };
+
+static const struct
+{
+    uint16_t prescaler;
+    uint16_t divisor;
+    uint32_t dshotRate;
+} protocols[NUMBER_OF_ESC_PROTOCOLS] = { { 42,  1,      0 },    // PWM,        2 MHz
+                                         {  1,  8,      0 },    // OneShot125, 84 MHz
+                                         {  1, 24,      0 },    // OneShot42,  84 MHz
+                                         {  1,  1, 150000 },    // DShot150,   84 MHz
+                                         {  1,  1, 300000 },    // DShot300,   84 MHz
+                                         {  1,  1, 600000 }, }; // DShot600,   84 MHz
+
+///////////////////////////////////////////////////////////////////////////////
+// ESC Timing Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void escTimingInit(escTiming_t *timing, uint8_t protocol, uint16_t escPwmRate)
+{
+    if (protocol >= NUMBER_OF_ESC_PROTOCOLS)
+        protocol = ESC_PROTOCOL_PWM;
+
+    timing->protocol  = protocol;
+    timing->onePulse  = (protocol == ESC_PROTOCOL_ONESHOT125) || (protocol == ESC_PROTOCOL_ONESHOT42);
+    timing->prescaler = protocols[protocol].prescaler;
+    timing->divisor   = protocols[protocol].divisor;
+    timing->dshotRate = protocols[protocol].dshotRate;
+
+    if (timing->dshotRate != 0)
+    {
+        dshotTimingInit(&timing->dshot, ESC_TIMER_CLOCK / timing->prescaler, timing->dshotRate);
+
+        timing->period = timing->dshot.bitTicks - 1;
+    }
+    else if (timing->onePulse)
+        timing->period = escPulseTicks(timing, ESC_COMMAND_MAX) + ESC_ONESHOT_LEAD - 1;
+    else
+        timing->period = (uint16_t)(ESC_COMMAND_CLOCK / escPwmRate) - 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ESC Timer Channels
+///////////////////////////////////////////////////////////////////////////////
+
+// Compare channels 1 thru the highest one mapped to an output, the DShot
+// DMA burst length
+
+uint8_t escTimerChannels(uint8_t timer)
+{
+    uint8_t i, channels = 0;
+
+    for (i = 0; i < 8; i++)
+        if ((escOutputs[i].timer == timer) && (escOutputs[i].channel > channels))
+            channels = escOutputs[i].channel;
+
+    return channels;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ESC Pulse Ticks
+///////////////////////////////////////////////////////////////////////////////
+
+// Rounded to the nearest tick, 84000 * 4000 fits in 32 bits
+
+uint32_t escPulseTicks(const escTiming_t *timing, uint16_t command)
+{
+    const uint32_t numerator   = ESC_TIMER_CLOCK / 1000 / timing->prescaler;
+    const uint32_t denominator = ESC_COMMAND_CLOCK / 1000 * timing->divisor;
+
+    if (timing->onePulse && (command > ESC_COMMAND_MAX))
+        command = ESC_COMMAND_MAX;
+
+    return ((uint32_t)command * numerator + denominator / 2) / denominator;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ESC Compare Value
+///////////////////////////////////////////////////////////////////////////////
+
+// One pulse outputs are high from the compare value through the auto
+// reload value, period + 1 - compare ticks.
+
+uint32_t escCompare(const escTiming_t *timing, uint16_t command)
+{
+    if (timing->onePulse)
+        return timing->period + 1 - escPulseTicks(timing, command);
+    else
+        return escPulseTicks(timing, command);
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,112 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+#include "dshot.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// ESC Protocol Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+enum { ESC_PROTOCOL_PWM,               // Free running, escPwmRate
+       ESC_PROTOCOL_ONESHOT125,        // 125 to 250 uSec, one pulse per write
+       ESC_PROTOCOL_ONESHOT42,         // 42 to 84 uSec, one pulse per write
+       ESC_PROTOCOL_DSHOT150,          // Digital frames by timer DMA, 150 kbit/s
+       ESC_PROTOCOL_DSHOT300,
+       ESC_PROTOCOL_DSHOT600,
+       NUMBER_OF_ESC_PROTOCOLS };
+
+enum { ESC_TIMER_TIM8,
+       ESC_TIMER_TIM2,
+       ESC_TIMER_TIM3,
+       NUMBER_OF_ESC_TIMERS };
+
+#define ESC_TIMER_CLOCK   84000000     // TIM2, TIM3 and TIM8 counter clock, Hz
+#define ESC_COMMAND_CLOCK  2000000     // Motor commands are 0.5 uSec counts
+#define ESC_COMMAND_MIN       2000     // MINCOMMAND, 1 mSec
+#define ESC_COMMAND_MAX       4000     // MAXCOMMAND, 2 mSec
+
+#define ESC_ONESHOT_LEAD  168          // Timer ticks from trigger to the longest pulse, 2 uSec
+
+typedef struct escOutput_t
+{
+    uint8_t timer;                     // ESC_TIMER_xxx
+    uint8_t channel;                   // Compare channel, 1 thru 4
+} escOutput_t;
+
+extern const escOutput_t escOutputs[8];
+
+typedef struct escTiming_t
+{
+    uint8_t  protocol;
+    uint8_t  onePulse;                 // Counter stops after each pulse
+    uint16_t prescaler;
+    uint16_t divisor;                  // Pulse width is the PWM width / divisor
+    uint32_t period;                   // Auto reload value
+    uint32_t dshotRate;                // Bits per second, 0 for pulse widths
+    dshotTiming_t dshot;
+} escTiming_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// ESC Timing Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void escTimingInit(escTiming_t *timing, uint8_t protocol, uint16_t escPwmRate);
+
+///////////////////////////////////////////////////////////////////////////////
+// ESC Timer Channels
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t escTimerChannels(uint8_t timer);
+
+///////////////////////////////////////////////////////////////////////////////
+// ESC Pulse Ticks
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t escPulseTicks(const escTiming_t *timing, uint16_t command);
+
+///////////////////////////////////////////////////////////////////////////////
+// ESC Compare Value
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t escCompare(const escTiming_t *timing, uint16_t command);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -68,6 +68,7 @@ enum evrErrorList {
   EVR_FlashCRCFail,
   EVR_FlashEraseFail,
   EVR_FlashProgramFail,
+  EVR_Mpu6000DataStall,
   };
 
 //enum evrFatalList {
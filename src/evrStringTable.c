@@ -27,7 +27,8 @@ constStrArr_t evrError = {
     "Battery dangerously Low!",
     "Flash CRC failed! Bad History Set",
     "Flash erase failed",
-    "Flash programming failed"
+    "Flash programming failed",
+    "MPU6000 data stalled, no samples for 2 mSec"
 };
 
 constStrArr_t evrFatal = {
@@ -0,0 +1,162 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Fast Math Defines and Variables
+///////////////////////////////////////////////////////////////////////////////
+
+#define HALF_PI_F   1.57079632679f
+#define SQRT2_F     1.41421356237f
+#define LOG2E_F     1.44269504089f
+#define LN2_F       0.69314718056f
+
+typedef union
+{
+    float    f;
+    uint32_t i;
+} floatBits_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// Fast Arc Tangent, four quadrant
+///////////////////////////////////////////////////////////////////////////////
+
+// Abramowitz and Stegun 4.4.48 on the octant, |error| <= 1e-5 rad before
+// rounding.  atan2(0, 0) returns 0 like libm.
+
+float fastAtan2f(float y, float x)
+{
+    float absX = fabsf(x);
+    float absY = fabsf(y);
+    float a, s, result;
+
+    if ((absX == 0.0f) && (absY == 0.0f))
+        return 0.0f;
+
+    if (absY > absX)
+        a = absX / absY;
+    else
+        a = absY / absX;
+
+    s = a * a;
+
+    result = a * (0.9998660f + s * (-0.3302995f + s * (0.1801410f + s * (-0.0851330f + s * 0.0208351f))));
+
+    if (absY > absX)
+        result = HALF_PI_F - result;
+
+    if (x < 0.0f)
+        result = PI - result;
+
+    if (y < 0.0f)
+        result = -result;
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Fast Arc Sine
+///////////////////////////////////////////////////////////////////////////////
+
+// Clamped so rounding in a unit quaternion can not make a NaN
+
+float fastAsinf(float x)
+{
+    x = constrain(x, -1.0f, 1.0f);
+
+    return fastAtan2f(x, fastSqrtf((1.0f - x) * (1.0f + x)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Fast Power
+///////////////////////////////////////////////////////////////////////////////
+
+// x^y as 2^(y * log2(x)).  log2 splits off the exponent and takes the
+// mantissa, folded to 0.707 to 1.414, through an atanh series.  2^f, for f
+// within half of an integer, is a 7th order series.  Denormal x is not
+// supported.
+
+float fastPowf(float x, float y)
+{
+    floatBits_t bits;
+    int32_t     exponent;
+    float       mantissa, t, t2, log2x, z, f, w, result;
+
+    if (x <= 0.0f)
+        return 0.0f;
+
+    bits.f   = x;
+    exponent = (int32_t)((bits.i >> 23) & 0xff) - 127;
+    bits.i   = (bits.i & 0x007fffff) | 0x3f800000;
+    mantissa = bits.f;
+
+    if (mantissa > SQRT2_F)
+    {
+        mantissa *= 0.5f;
+        exponent++;
+    }
+
+    t  = (mantissa - 1.0f) / (mantissa + 1.0f);
+    t2 = t * t;
+
+    log2x = (float)exponent +
+            2.0f * LOG2E_F * t * (1.0f + t2 * (1.0f / 3.0f + t2 * (1.0f / 5.0f + t2 * (1.0f / 7.0f + t2 * (1.0f / 9.0f)))));
+
+    ///////////////////////////////////
+
+    z = y * log2x;
+
+    if (z > 127.0f)
+        return INFINITY;
+
+    if (z < -125.0f)
+        return 0.0f;
+
+    exponent = (int32_t)floorf(z + 0.5f);
+    f        = z - (float)exponent;
+    w        = f * LN2_F;
+
+    result = 1.0f + w * (1.0f + w * (1.0f / 2.0f + w * (1.0f / 6.0f + w * (1.0f / 24.0f +
+             w * (1.0f / 120.0f + w * (1.0f / 720.0f + w * (1.0f / 5040.0f)))))));
+
+    bits.f  = result;
+    bits.i += (uint32_t)exponent << 23;
+
+    return bits.f;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,93 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Fast Float Math
+///////////////////////////////////////////////////////////////////////////////
+
+// Single precision stand ins for the libm calls on the control, estimation
+// and OSD paths.  Nothing in here goes through a double, so the FPU does all
+// of the work instead of the soft double library.  Worst case errors below
+// are measured against libm in double by utils/sitl/fastmath.
+//
+//   fastSqrtf    exact, correctly rounded
+//   fastAtan2f   2.0e-5 rad absolute
+//   fastAsinf    2.0e-5 rad absolute, input clamped to -1 to 1
+//   fastPowf     5.0e-6 relative for |y * log2(x)| < 64, rounding of that
+//                product dominates, x > 0 only, returns 0 otherwise
+
+///////////////////////////////////////////////////////////////////////////////
+// Fast Square Root, a single VSQRT.F32 on the board
+///////////////////////////////////////////////////////////////////////////////
+
+static inline float fastSqrtf(float x)
+{
+    #if defined(__ARM_FP)
+        float result;
+
+        __asm__ ("vsqrt.f32 %0, %1" : "=t" (result) : "t" (x));
+
+        return result;
+    #else
+        return __builtin_sqrtf(x);
+    #endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Fast Arc Tangent, four quadrant
+///////////////////////////////////////////////////////////////////////////////
+
+float fastAtan2f(float y, float x);
+
+///////////////////////////////////////////////////////////////////////////////
+// Fast Arc Sine
+///////////////////////////////////////////////////////////////////////////////
+
+float fastAsinf(float x);
+
+///////////////////////////////////////////////////////////////////////////////
+// Fast Power
+///////////////////////////////////////////////////////////////////////////////
+
+float fastPowf(float x, float y);
+
+///////////////////////////////////////////////////////////////////////////////
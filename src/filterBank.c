@@ -0,0 +1,337 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Runtime configurable biquad filter chains.  Each chain is up to
+// FILTER_SECTIONS second order sections described in eepromConfig.filters,
+// designed when the chain is initialized for the rate of the task that runs
+// it, and applied to all of its axes with arm_biquad_cascade_df1_f32().
+// Everything but filterBankInitChain() works only on the chain it is given,
+// so the responses can be checked on a host build.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Bank Variables
+///////////////////////////////////////////////////////////////////////////////
+
+filterChain_t filterChains[NUMBER_OF_FILTER_CHAINS];
+
+static const uint8_t chainAxes[NUMBER_OF_FILTER_CHAINS] = { 3, 3, 3, 1, 3 };
+
+static const float chainSampleRate[NUMBER_OF_FILTER_CHAINS] =
+{
+    1000.0f / COUNT_500HZ,
+    1000.0f / COUNT_500HZ,
+    1000.0f / COUNT_100HZ,
+    1000.0f / COUNT_50HZ,
+    1000.0f / COUNT_100HZ,
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Section Design
+//
+// Coefficients in CMSIS order and sign, y = b0 x + b1 x1 + b2 x2 + a1 y1 + a2 y2.
+// Returns false, coefficients untouched, for a type or frequency that
+// cannot be realized at this sample rate.
+///////////////////////////////////////////////////////////////////////////////
+
+bool filterSectionDesign(const filterSectionConfig_t *config, float sampleRate, float32_t coefficients[5])
+{
+    float nyquist = sampleRate / 2.0f;
+    float k, kUpper, q, norm;
+
+    if ((config->frequency <= 0.0f) || (config->frequency >= nyquist))
+        return false;
+
+    k = tanf(PI * config->frequency / sampleRate);
+
+    switch (config->type)
+    {
+        case FILTER_LOWPASS1:
+            norm = 1.0f / (1.0f + k);
+
+            coefficients[0] = k * norm;
+            coefficients[1] = k * norm;
+            coefficients[2] = 0.0f;
+            coefficients[3] = (1.0f - k) * norm;
+            coefficients[4] = 0.0f;
+            return true;
+
+        case FILTER_HIGHPASS1:
+            norm = 1.0f / (1.0f + k);
+
+            coefficients[0] =  norm;
+            coefficients[1] = -norm;
+            coefficients[2] =  0.0f;
+            coefficients[3] = (1.0f - k) * norm;
+            coefficients[4] =  0.0f;
+            return true;
+
+        case FILTER_LOWPASS2:
+            q = config->parameter;
+
+            if (q <= 0.0f)
+                return false;
+
+            norm = 1.0f / (1.0f + k / q + k * k);
+
+            coefficients[0] = k * k * norm;
+            coefficients[1] = 2.0f * coefficients[0];
+            coefficients[2] = coefficients[0];
+            coefficients[3] = -2.0f * (k * k - 1.0f) * norm;
+            coefficients[4] = -(1.0f - k / q + k * k) * norm;
+            return true;
+
+        case FILTER_NOTCH:
+        case FILTER_BANDSTOP:
+            if (config->type == FILTER_NOTCH)
+            {
+                q = config->parameter;
+
+                if (q <= 0.0f)
+                    return false;
+            }
+            else
+            {
+                // Center and Q from the prewarped edges, so both land at -3 dB
+
+                if ((config->parameter <= config->frequency) || (config->parameter >= nyquist))
+                    return false;
+
+                kUpper = tanf(PI * config->parameter / sampleRate);
+
+                q = sqrtf(k * kUpper) / (kUpper - k);
+                k = sqrtf(k * kUpper);
+            }
+
+            norm = 1.0f / (1.0f + k / q + k * k);
+
+            coefficients[0] = (1.0f + k * k) * norm;
+            coefficients[1] = 2.0f * (k * k - 1.0f) * norm;
+            coefficients[2] = coefficients[0];
+            coefficients[3] = -coefficients[1];
+            coefficients[4] = -(1.0f - k / q + k * k) * norm;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Chain Initialization
+//
+// An invalid section leaves the chain empty, a pass through, and returns
+// false.  State starts at zero, see filterChainSettle().
+///////////////////////////////////////////////////////////////////////////////
+
+bool filterChainInit(filterChain_t *chain, const filterSectionConfig_t config[FILTER_SECTIONS], uint8_t axes, float sampleRate)
+{
+    uint8_t axis, section, sections;
+
+    memset(chain, 0, sizeof(filterChain_t));
+
+    chain->axes       = (axes > FILTER_MAX_AXES) ? FILTER_MAX_AXES : axes;
+    chain->sampleRate = sampleRate;
+
+    for (sections = 0; sections < FILTER_SECTIONS; sections++)
+    {
+        if (config[sections].type == FILTER_NONE)
+            break;
+    }
+
+    for (section = 0; section < sections; section++)
+    {
+        if (filterSectionDesign(&config[section], sampleRate, &chain->coefficients[5 * section]) == false)
+        {
+            memset(chain->coefficients, 0, sizeof(chain->coefficients));
+            return false;
+        }
+    }
+
+    chain->sections = sections;
+
+    for (axis = 0; axis < chain->axes; axis++)
+        arm_biquad_cascade_df1_init_f32(&chain->instance[axis], sections, chain->coefficients, chain->state[axis]);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Chain Retune
+//
+// Redesigns one section in place and keeps the state of every axis, so a
+// moving notch does not restart the chain.  FILTER_NONE makes the section
+// a pass through.  Returns false, section untouched, for an invalid design.
+///////////////////////////////////////////////////////////////////////////////
+
+bool filterChainRetune(filterChain_t *chain, uint8_t section, const filterSectionConfig_t *config)
+{
+    float32_t coefficients[5] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+
+    if (section >= chain->sections)
+        return false;
+
+    if ((config->type != FILTER_NONE) && (filterSectionDesign(config, chain->sampleRate, coefficients) == false))
+        return false;
+
+    memcpy(&chain->coefficients[5 * section], coefficients, sizeof(coefficients));
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Chain Settle
+//
+// Loads the state one axis would have after a long constant input, so a
+// chain started on a nonzero signal, the z accel or the baro altitude,
+// does not ring on its first samples.
+///////////////////////////////////////////////////////////////////////////////
+
+void filterChainSettle(filterChain_t *chain, uint8_t axis, float value)
+{
+    const float32_t *b;
+    float32_t       *state;
+    float           output;
+    uint8_t         section;
+
+    if (axis >= chain->axes)
+        return;
+
+    for (section = 0; section < chain->sections; section++)
+    {
+        b     = &chain->coefficients[5 * section];
+        state = &chain->state[axis][4 * section];
+
+        output = value * (b[0] + b[1] + b[2]) / (1.0f - b[3] - b[4]);
+
+        state[0] = value;
+        state[1] = value;
+        state[2] = output;
+        state[3] = output;
+
+        value = output;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Chain Update
+//
+// One new sample per axis, input and output may be the same array.
+///////////////////////////////////////////////////////////////////////////////
+
+void filterChainUpdate(filterChain_t *chain, const float *input, float *output)
+{
+    uint8_t axis;
+
+    for (axis = 0; axis < chain->axes; axis++)
+    {
+        if (chain->sections == 0)
+            output[axis] = input[axis];
+        else
+            arm_biquad_cascade_df1_f32(&chain->instance[axis], (float32_t *)&input[axis], &output[axis], 1);  // CMSIS does not write the input
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Chain Block
+//
+// A block of samples of one axis.
+///////////////////////////////////////////////////////////////////////////////
+
+void filterChainBlock(filterChain_t *chain, uint8_t axis, const float32_t *input, float32_t *output, uint32_t samples)
+{
+    if (axis >= chain->axes)
+        return;
+
+    if (chain->sections == 0)
+        memmove(output, input, samples * sizeof(float32_t));
+    else
+        arm_biquad_cascade_df1_f32(&chain->instance[axis], (float32_t *)input, output, samples);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Bank Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+// Designs one chain from eepromConfig for the rate of its task and settles
+// it on the signal it will first see.  Safe from the CLI, flight tasks do
+// not run while it is busy, but the gyro chain may belong to the sample
+// interrupt, see rateLoopStop().
+
+bool filterBankInitChain(uint8_t chain)
+{
+    float sampleRate;
+    bool  valid;
+
+    if (chain >= NUMBER_OF_FILTER_CHAINS)
+        return false;
+
+    if (chain == GYRO500HZ_FILTER)
+        sampleRate = rateLoopGyroRate();
+    else
+        sampleRate = chainSampleRate[chain];
+
+    valid = filterChainInit(&filterChains[chain], eepromConfig.filters[chain], chainAxes[chain], sampleRate);
+
+    switch (chain)
+    {
+        case ACCEL500HZ_FILTER:
+        case ACCEL100HZ_FILTER:
+            filterChainSettle(&filterChains[chain], ZAXIS, -accelOneG);
+            break;
+
+        case PRESSURE_ALT50HZ_FILTER:
+            filterChainSettle(&filterChains[chain], 0, sensors.pressureAlt50Hz);
+            break;
+    }
+
+    return valid;
+}
+
+///////////////////////////////////////
+
+void filterBankInit(void)
+{
+    uint8_t chain;
+
+    for (chain = 0; chain < NUMBER_OF_FILTER_CHAINS; chain++)
+        filterBankInitChain(chain);
+}
+
+///////////////////////////////////////////////////////////////////////////////
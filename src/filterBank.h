@@ -0,0 +1,154 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "arm_math.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Bank Defines
+///////////////////////////////////////////////////////////////////////////////
+
+#define FILTER_SECTIONS  4             // Biquad sections per chain
+
+#define FILTER_MAX_AXES  3
+
+// Chains, each run once per pass of the task that owns it
+
+enum { GYRO500HZ_FILTER,               // Rate loop gyros, 1 kHz with rateLoopEnabled
+       ACCEL500HZ_FILTER,              // Attitude estimator accels
+       ACCEL100HZ_FILTER,              // Vertical channel accels
+       PRESSURE_ALT50HZ_FILTER,
+       EARTH_ACCEL100HZ_FILTER,        // Earth axis accels, high pass
+       NUMBER_OF_FILTER_CHAINS
+     };
+
+// Section types
+//
+//                     frequency     parameter
+//   FILTER_LOWPASS1   cutoff        unused       first order
+//   FILTER_HIGHPASS1  cutoff        unused       first order
+//   FILTER_LOWPASS2   cutoff        Q            0.7071 is Butterworth
+//   FILTER_NOTCH      center        Q
+//   FILTER_BANDSTOP   lower edge    upper edge   -3 dB at both edges
+//
+// All in Hz, bilinear transform prewarped at the given frequency.  A chain
+// ends at the first FILTER_NONE section.
+
+enum { FILTER_NONE,
+       FILTER_LOWPASS1,
+       FILTER_HIGHPASS1,
+       FILTER_LOWPASS2,
+       FILTER_NOTCH,
+       FILTER_BANDSTOP,
+       NUMBER_OF_FILTER_TYPES
+     };
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Bank Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct filterSectionConfig_t
+{
+    uint8_t type;
+    float   frequency;
+    float   parameter;
+} filterSectionConfig_t;
+
+typedef struct filterChain_t
+{
+    arm_biquad_casd_df1_inst_f32 instance[FILTER_MAX_AXES];
+
+    float32_t coefficients[5 * FILTER_SECTIONS];               // b0 b1 b2 a1 a2, CMSIS signs
+    float32_t state[FILTER_MAX_AXES][4 * FILTER_SECTIONS];
+
+    uint8_t   axes;
+    uint8_t   sections;
+    float     sampleRate;
+} filterChain_t;
+
+extern filterChain_t filterChains[NUMBER_OF_FILTER_CHAINS];
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Section Design
+///////////////////////////////////////////////////////////////////////////////
+
+bool filterSectionDesign(const filterSectionConfig_t *config, float sampleRate, float32_t coefficients[5]);
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Chain Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+bool filterChainInit(filterChain_t *chain, const filterSectionConfig_t config[FILTER_SECTIONS], uint8_t axes, float sampleRate);
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Chain Retune
+///////////////////////////////////////////////////////////////////////////////
+
+bool filterChainRetune(filterChain_t *chain, uint8_t section, const filterSectionConfig_t *config);
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Chain Settle
+///////////////////////////////////////////////////////////////////////////////
+
+void filterChainSettle(filterChain_t *chain, uint8_t axis, float value);
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Chain Update
+///////////////////////////////////////////////////////////////////////////////
+
+void filterChainUpdate(filterChain_t *chain, const float *input, float *output);
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Chain Block
+///////////////////////////////////////////////////////////////////////////////
+
+void filterChainBlock(filterChain_t *chain, uint8_t axis, const float32_t *input, float32_t *output, uint32_t samples);
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter Bank Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+bool filterBankInitChain(uint8_t chain);
+
+void filterBankInit(void);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -40,7 +40,12 @@
 // Process Pilot Commands Defines and Variables
 ///////////////////////////////////////////////////////////////////////////////
 
-float    rxCommand[8] = { 0.0f, 0.0f, 0.0f, 2000.0f, 2000.0f, 2000.0f, 2000.0f, 2000.0f };
+float    rxCommand[NUMBER_OF_RC_CHANNELS] = { 0.0f, 0.0f, 0.0f, 2000.0f, 2000.0f, 2000.0f, 2000.0f, 2000.0f,
+                                           2000.0f, 2000.0f, 2000.0f, 2000.0f, 2000.0f, 2000.0f, 2000.0f, 2000.0f };
+
+float    rcSetpoint[3];
+
+rcSmoothing_t rcSmoothing;
 
 uint8_t  commandInDetent[3]         = { true, true, true };
 uint8_t  previousCommandInDetent[3] = { true, true, true };
@@ -70,6 +75,20 @@ uint16_t previousAUX2State = MINCOMMAND;
 
 float    altitudeHoldThrottleValue = 0.0f;
 
+///////////////////////////////////////////////////////////////////////////////
+// Apply Deadband
+///////////////////////////////////////////////////////////////////////////////
+
+static float applyDeadband(float command)
+{
+    if ((command <= DEADBAND) && (command >= -DEADBAND))
+        return 0.0f;
+    else if (command > 0)
+        return (command - DEADBAND) * DEADBAND_SLOPE;
+    else
+        return (command + DEADBAND) * DEADBAND_SLOPE;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Read Flight Commands
 ///////////////////////////////////////////////////////////////////////////////
@@ -81,18 +100,15 @@ void processFlightCommands(void)
     if ( rcActive == true )
     {
 		// Read receiver commands
-        for (channel = 0; channel < 8; channel++)
+        for (channel = 0; channel < NUMBER_OF_RC_CHANNELS; channel++)
             rxCommand[channel] = (float)rxRead(eepromConfig.rcMap[channel]);
 
         rxCommand[ROLL]  -= eepromConfig.midCommand;                  // Roll Range    -1000:1000
         rxCommand[PITCH] -= eepromConfig.midCommand;                  // Pitch Range   -1000:1000
         rxCommand[YAW]   -= eepromConfig.midCommand;                  // Yaw Range     -1000:1000
 
-        rxCommand[THROTTLE] -= eepromConfig.midCommand - MIDCOMMAND;  // Throttle Range 2000:4000
-        rxCommand[AUX1]     -= eepromConfig.midCommand - MIDCOMMAND;  // Aux1 Range     2000:4000
-        rxCommand[AUX2]     -= eepromConfig.midCommand - MIDCOMMAND;  // Aux2 Range     2000:4000
-        rxCommand[AUX3]     -= eepromConfig.midCommand - MIDCOMMAND;  // Aux3 Range     2000:4000
-        rxCommand[AUX4]     -= eepromConfig.midCommand - MIDCOMMAND;  // Aux4 Range     2000:4000
+        for (channel = THROTTLE; channel < NUMBER_OF_RC_CHANNELS; channel++)
+            rxCommand[channel] -= eepromConfig.midCommand - MIDCOMMAND;  // Throttle and Aux Range 2000:4000
     }
 
     // Set past command in detent values
@@ -102,23 +118,9 @@ void processFlightCommands(void)
     // Apply deadbands and set detent discretes'
     for (channel = 0; channel < 3; channel++)
     {
-    	if ((rxCommand[channel] <= DEADBAND) && (rxCommand[channel] >= -DEADBAND))
-        {
-            rxCommand[channel] = 0;
-  	        commandInDetent[channel] = true;
-  	    }
-        else
-  	    {
-  	        commandInDetent[channel] = false;
-  	        if (rxCommand[channel] > 0)
-  	        {
-  		        rxCommand[channel] = (rxCommand[channel] - DEADBAND) * DEADBAND_SLOPE;
-  	        }
-  	        else
-  	        {
-  	            rxCommand[channel] = (rxCommand[channel] + DEADBAND) * DEADBAND_SLOPE;
-  	        }
-        }
+    	commandInDetent[channel] = ((rxCommand[channel] <= DEADBAND) && (rxCommand[channel] >= -DEADBAND)) ? true : false;
+
+        rxCommand[channel] = applyDeadband(rxCommand[channel]);
     }
 
     ///////////////////////////////////
@@ -149,8 +151,10 @@ void processFlightCommands(void)
 		     (rxCommand[ROLL ] > (eepromConfig.maxCheck - MIDCOMMAND)) &&
 		     (rxCommand[PITCH] < (eepromConfig.minCheck - MIDCOMMAND)) )
 		{
+			rateLoopStop();  // Keeps the pulses from being mixed over
 			computeMPU6000RTData();
 			pulseMotors(3);
+			rateLoopInit();
 		}
 
 		// Check for arm command ( low throttle, right yaw)
@@ -229,14 +233,40 @@ void processFlightCommands(void)
 		altitudeHoldState = DISENGAGED;
 	}
 
-	previousAUX2State = rxCommand[AUX2];
+	previousAUX2State = (uint16_t)rxCommand[AUX2];
 
 
 	///////////////////////////////////
 }
 
 ///////////////////////////////////////////////////////////////////////////////
+// Update RC Setpoint
+///////////////////////////////////////////////////////////////////////////////
+
+// Picks up each new receiver frame by its time, as soon as the 500 Hz task
+// runs after it, rather than at the next 50 Hz processFlightCommands(),
+// and hands the loop the smoothed roll, pitch and yaw setpoint.
+
+void updateRcSetpoint(void)
+{
+    float    command[3];
+    uint64_t frameTime;
+    uint8_t  axis;
+
+    do
+    {
+        frameTime = rxFrameTime;             // 64 bits, the PWM capture interrupts write it
+    } while (frameTime != rxFrameTime);
 
+    if ((rcActive == true) && (frameTime != rcSmoothing.frameTime))
+    {
+        for (axis = ROLL; axis <= YAW; axis++)
+            command[axis] = applyDeadband((float)rxRead(eepromConfig.rcMap[axis]) - eepromConfig.midCommand);
 
+        rcSmoothingFrame(&rcSmoothing, command, frameTime);
+    }
 
+    rcSmoothingUpdate(&rcSmoothing, micros64(), rcSetpoint);
+}
 
+///////////////////////////////////////////////////////////////////////////////
@@ -43,7 +43,11 @@
 #define DEADBAND       24
 #define DEADBAND_SLOPE (1000/(1000-DEADBAND))
 
-extern float rxCommand[8];
+extern float rxCommand[NUMBER_OF_RC_CHANNELS];
+
+extern float rcSetpoint[3];            // Roll, pitch, yaw stick commands at loop rate
+
+extern rcSmoothing_t rcSmoothing;
 
 extern uint8_t commandInDetent[3];
 extern uint8_t previousCommandInDetent[3];
@@ -79,3 +83,9 @@ extern uint8_t altitudeHoldState;
 void processFlightCommands(void);
 
 ///////////////////////////////////////////////////////////////////////////////
+// Update RC Setpoint, 500 Hz
+///////////////////////////////////////////////////////////////////////////////
+
+void updateRcSetpoint(void);
+
+///////////////////////////////////////////////////////////////////////////////
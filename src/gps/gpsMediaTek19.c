@@ -181,6 +181,8 @@ uint8_t decodeMediaTek3329BinaryMsg(void)
                         sensors.gpsLongitude = (float)mtk19Message.data.longitude * 0.0000001f * D2R; // Radians
 				    }
 
+                    sensors.gpsTimestamp     = micros64();
+
                     sensors.gpsAltitude		 = (float)mtk19Message.data.altitude    * 0.01f;          // Meters
                     sensors.gpsGroundSpeed	 = (float)mtk19Message.data.groundSpeed * 0.01f;          // Meters/Sec
                     sensors.gpsGroundTrack	 = (float)mtk19Message.data.groundTrack * 0.01f * D2R;    // Radians
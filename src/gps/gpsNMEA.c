@@ -181,6 +181,8 @@ void nmeaProcessSentence()
         sensors.gpsLatitude    = (nmeaGetLatLong(&p,   &work, 5)) ? (float)work * 0.0000001f * D2R   : GPS_INVALID_ANGLE;
         sensors.gpsLongitude   = (nmeaGetLatLong(&p,   &work, 5)) ? (float)work * 0.0000001f * D2R   : GPS_INVALID_ANGLE;
 
+        sensors.gpsTimestamp   = micros64();
+
         p += 2;  // Skip Quality (1 character and ',')  //nmeaGetScaledInt(&p, NULL,  0); // Position Fix Indicator - Not Used
 
         sensors.gpsNumSats     = (nmeaGetScaledInt(&p, &work, 0)) ? work                             : GPS_INVALID_SATS;
@@ -220,6 +222,8 @@ void nmeaProcessSentence()
         sensors.gpsGroundSpeed = (nmeaGetScaledInt(&p, &work, 3)) ? (float)work * 0.001f * KNOTS2MPS : GPS_INVALID_SPEED;
         sensors.gpsGroundTrack = (nmeaGetScaledInt(&p, &work, 3)) ? (float)work * 0.001f * D2R       : GPS_INVALID_ANGLE;
         sensors.gpsDate        = (nmeaGetScaledInt(&p, &work, 0)) ? work                             : GPS_INVALID_DATE;
+
+        sensors.gpsTimestamp   = micros64();
     }
 
     ///////////////////////////////////
@@ -152,6 +152,8 @@ void ubloxParseData()
             sensors.gpsLatitude  = (float)ubloxMessage.nav_posllh.lat    * 0.0000001f * D2R; // Radians;
             sensors.gpsLongitude = (float)ubloxMessage.nav_posllh.lon    * 0.0000001f * D2R; // Radians;
             sensors.gpsAltitude  = (float)ubloxMessage.nav_posllh.height * 0.01f;            // Meters
+
+            sensors.gpsTimestamp = micros64();
         }
         else if (ubloxId == 3)   // NAV:STATUS
         {
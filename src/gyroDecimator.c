@@ -0,0 +1,137 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Anti-alias decimation of the 8 kHz MPU6000 gyro stream.  Kept free of
+// board dependencies so alias rejection can be checked on a host build
+// against synthetic vibration spectra.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <string.h>
+
+#include "gyroDecimator.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Gyro Decimator Design
+//
+// Hamming windowed sinc low pass, normalized to unity DC gain.  Transition
+// width is roughly 3.3 * sampleRate / taps, stopband about -53 dB.
+///////////////////////////////////////////////////////////////////////////////
+
+void gyroDecimatorDesign(float32_t *coefficients, uint8_t taps, float cutoff, float sampleRate)
+{
+    uint8_t index;
+    float   fc, n, sum;
+
+    fc  = cutoff / sampleRate;
+    sum = 0.0f;
+
+    for (index = 0; index < taps; index++)
+    {
+        n = (float)index - (float)(taps - 1) / 2.0f;
+
+        if (n == 0.0f)
+            coefficients[index] = 2.0f * fc;
+        else
+            coefficients[index] = sinf(2.0f * PI * fc * n) / (PI * n);
+
+        if (taps > 1)
+            coefficients[index] *= 0.54f - 0.46f * cosf(2.0f * PI * (float)index / (float)(taps - 1));
+
+        sum += coefficients[index];
+    }
+
+    for (index = 0; index < taps; index++)
+        coefficients[index] /= sum;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Gyro Decimator Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+bool gyroDecimatorInit(gyroDecimator_t *decimator, uint8_t taps, uint8_t factor, float cutoff, float sampleRate)
+{
+    uint8_t axis;
+
+    if ((taps   == 0) || (taps   > GYRO_DECIMATOR_MAX_TAPS)   ||
+        (factor == 0) || (factor > GYRO_DECIMATOR_MAX_FACTOR) ||
+        (cutoff <= 0.0f) || (cutoff >= sampleRate / 2.0f))
+        return false;
+
+    memset(decimator, 0, sizeof(gyroDecimator_t));
+
+    gyroDecimatorDesign(decimator->coefficients, taps, cutoff, sampleRate);
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        if (arm_fir_decimate_init_f32(&decimator->instance[axis], taps, factor,
+                                      decimator->coefficients, decimator->state[axis], factor) != ARM_MATH_SUCCESS)
+            return false;
+    }
+
+    decimator->factor = factor;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Gyro Decimator Update
+//
+// Feed one input sample per axis.  Returns true, with output filled, once
+// every factor samples.
+///////////////////////////////////////////////////////////////////////////////
+
+bool gyroDecimatorUpdate(gyroDecimator_t *decimator, const float32_t input[3], float32_t output[3])
+{
+    uint8_t axis;
+
+    for (axis = 0; axis < 3; axis++)
+        decimator->input[axis][decimator->inputCount] = input[axis];
+
+    if (++decimator->inputCount < decimator->factor)
+        return false;
+
+    decimator->inputCount = 0;
+
+    for (axis = 0; axis < 3; axis++)
+        arm_fir_decimate_f32(&decimator->instance[axis], decimator->input[axis], &output[axis], decimator->factor);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
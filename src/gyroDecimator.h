@@ -0,0 +1,89 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "arm_math.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Gyro Decimator Defines
+///////////////////////////////////////////////////////////////////////////////
+
+#define GYRO_DECIMATOR_MAX_TAPS    96
+
+#define GYRO_DECIMATOR_MAX_FACTOR  16
+
+///////////////////////////////////////////////////////////////////////////////
+// Gyro Decimator Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct gyroDecimator_t
+{
+    arm_fir_decimate_instance_f32 instance[3];
+
+    float32_t coefficients[GYRO_DECIMATOR_MAX_TAPS];
+    float32_t state[3][GYRO_DECIMATOR_MAX_TAPS + GYRO_DECIMATOR_MAX_FACTOR - 1];
+    float32_t input[3][GYRO_DECIMATOR_MAX_FACTOR];
+
+    uint8_t   factor;
+    uint8_t   inputCount;
+} gyroDecimator_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// Gyro Decimator Design
+///////////////////////////////////////////////////////////////////////////////
+
+void gyroDecimatorDesign(float32_t *coefficients, uint8_t taps, float cutoff, float sampleRate);
+
+///////////////////////////////////////////////////////////////////////////////
+// Gyro Decimator Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+bool gyroDecimatorInit(gyroDecimator_t *decimator, uint8_t taps, uint8_t factor, float cutoff, float sampleRate);
+
+///////////////////////////////////////////////////////////////////////////////
+// Gyro Decimator Update
+///////////////////////////////////////////////////////////////////////////////
+
+bool gyroDecimatorUpdate(gyroDecimator_t *decimator, const float32_t input[3], float32_t output[3]);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,444 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Each message in telemMessages.h is a stream, numbered by its id.  Any
+// set of them can be on at once, the scheduler in telemScheduler.c picks
+// which are due on each tick of the telemetry task at the rates in
+// eepromConfig.telemRate, lowered where needed to keep all of them inside
+// eepromConfig.telemBudget.
+//
+// Streams go out as binary frames, see telemFrame.c, and utils/telemetry
+// turns them back into the comma separated lines the text streams used
+// to print.  Logging to the SD card keeps the text lines.
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t highSpeedTelemEnabled = 0;
+
+telemScheduler_t telemScheduler;
+
+static uint8_t telemSequence = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Send
+///////////////////////////////////////////////////////////////////////////////
+
+// The frame is built in place in the transmit ring when it has the room
+// in one piece, otherwise it is built here and copied in around the wrap
+
+static void telemSend(uint8_t id, const void *payload, uint8_t length)
+{
+    uint8_t  *frame, buffer[TELEM_MAX_FRAME];
+    uint16_t frameLength = TELEM_HEADER_SIZE + length + TELEM_CRC_SIZE;
+
+    if (frameLength <= txRingFreeContiguous(&telemetryTxRing))
+    {
+        frame = txRingReserve(&telemetryTxRing, frameLength);
+
+        telemFrameEncode(frame, id, telemSequence++, payload, length);
+        txRingCommit(&telemetryTxRing, frameLength);
+    }
+    else
+    {
+        frameLength = telemFrameEncode(buffer, id, telemSequence++, payload, length);
+        telemetryWriteBuffer(buffer, frameLength);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Streams
+///////////////////////////////////////////////////////////////////////////////
+
+static void sendAccels(void)
+{
+    // 500 Hz Accels
+    telemAccels_t accels;
+
+    memcpy(accels.accel,    sensors.accel500Hz,    sizeof(accels.accel));
+    memcpy(accels.accelMXR, sensors.accel500HzMXR, sizeof(accels.accelMXR));
+
+    telemSend(TELEM_ACCELS, &accels, sizeof(accels));
+
+    #if (TELEM_LOG == 1)
+        logPrintF("%9.4f, %9.4f, %9.4f, %9.4f, %9.4f, %9.4f\n", sensors.accel500Hz[XAXIS],
+                                                                sensors.accel500Hz[YAXIS],
+                                                                sensors.accel500Hz[ZAXIS],
+                                                                sensors.accel500HzMXR[XAXIS],
+                                                                sensors.accel500HzMXR[YAXIS],
+                                                                sensors.accel500HzMXR[ZAXIS]);
+    #endif
+}
+
+///////////////////////////////////////
+
+static void sendGyros(void)
+{
+    // 500 Hz Gyros
+    telemGyros_t gyros;
+
+    memcpy(gyros.gyro, sensors.gyro500Hz, sizeof(gyros.gyro));
+
+    telemSend(TELEM_GYROS, &gyros, sizeof(gyros));
+
+    #if (TELEM_LOG == 1)
+         logPrintF("%9.4f, %9.4f, %9.4f\n", sensors.gyro500Hz[ROLL ],
+                                            sensors.gyro500Hz[PITCH],
+                                            sensors.gyro500Hz[YAW  ]);
+    #endif
+}
+
+///////////////////////////////////////
+
+static void sendEarthAccels(void)
+{
+    // Earth Axis Accels
+    telemEarthAccels_t earthAccels;
+
+    memcpy(earthAccels.accel, earthAxisAccels, sizeof(earthAccels.accel));
+
+    telemSend(TELEM_EARTH_ACCELS, &earthAccels, sizeof(earthAccels));
+
+    #if (TELEM_LOG == 1)
+         logPrintF("%9.4f, %9.4f, %9.4f\n", earthAxisAccels[XAXIS],
+                                            earthAxisAccels[YAXIS],
+                                            earthAxisAccels[ZAXIS]);
+    #endif
+}
+
+///////////////////////////////////////
+
+static void sendAttitude(void)
+{
+    // 500 Hz Attitudes
+    telemAttitude_t attitude;
+
+    memcpy(attitude.attitude, getAttitude(), sizeof(attitude.attitude));
+
+    telemSend(TELEM_ATTITUDE, &attitude, sizeof(attitude));
+
+    #if (TELEM_LOG == 1)
+        logPrintF("%9.4f, %9.4f, %9.4f\n", getAttitude()[ROLL ],
+                                           getAttitude()[PITCH],
+                                           getAttitude()[YAW  ]);
+    #endif
+}
+
+///////////////////////////////////////
+
+static void sendVertical(void)
+{
+    // Vertical Variables
+    telemVertical_t vertical;
+
+    vertical.earthAccelZ  = earthAxisAccels[ZAXIS];
+    vertical.pressureAlt  = sensors.pressureAlt50Hz;
+    vertical.hDotEstimate = vertComp.hDotEstimate;
+    vertical.hEstimate    = vertComp.hEstimate;
+    vertical.temperature  = ms5611Temperature;
+
+    telemSend(TELEM_VERTICAL, &vertical, sizeof(vertical));
+
+    #if (TELEM_LOG == 1)
+        logPrintF("%9.4f, %9.4f, %9.4f, %9.4f, %4ld\n", earthAxisAccels[ZAXIS],
+                                                        sensors.pressureAlt50Hz,
+                                                        vertComp.hDotEstimate,
+                                                        vertComp.hEstimate,
+                                                        ms5611Temperature);
+    #endif
+}
+
+///////////////////////////////////////
+
+static void sendSensors(void)
+{
+    // Sensors
+    telemSensors_t sensorData;
+
+    memcpy(sensorData.accel, sensors.accel500Hz, sizeof(sensorData.accel));
+    memcpy(sensorData.gyro,  sensors.gyro500Hz,  sizeof(sensorData.gyro));
+    memcpy(sensorData.mag,   sensors.mag10Hz,    sizeof(sensorData.mag));
+
+    telemSend(TELEM_SENSORS, &sensorData, sizeof(sensorData));
+
+    #if (TELEM_LOG == 1)
+        logPrintF("%9.4f, %9.4f, %9.4f, %9.4f, %9.4f, %9.4f, %9.4f, %9.4f, %9.4f\n", sensors.accel500Hz[XAXIS],
+                                                                                     sensors.accel500Hz[YAXIS],
+                                                                                     sensors.accel500Hz[ZAXIS],
+                                                                                     sensors.gyro500Hz[ROLL ],
+                                                                                     sensors.gyro500Hz[PITCH],
+                                                                                     sensors.gyro500Hz[YAW  ],
+                                                                                     sensors.mag10Hz[XAXIS],
+                                                                                     sensors.mag10Hz[YAXIS],
+                                                                                     sensors.mag10Hz[ZAXIS]);
+    #endif
+}
+
+///////////////////////////////////////
+
+static void sendAdcTest(void)
+{
+    // Accel Test Variables
+    telemAdcTest_t adcTest;
+
+    adcTest.mxr[XAXIS] = mxr9150X();
+    adcTest.mxr[YAXIS] = mxr9150Y();
+    adcTest.mxr[ZAXIS] = mxr9150Z();
+    adcTest.vbatt      = vbatt();
+
+    telemSend(TELEM_ADC_TEST, &adcTest, sizeof(adcTest));
+
+    #if (TELEM_LOG == 1)
+        logPrintF("%5ld, %5ld, %5ld, %5ld\n", mxr9150X(),
+                                              mxr9150Y(),
+                                              mxr9150Z(),
+                                              vbatt());
+    #endif
+}
+
+///////////////////////////////////////
+
+static void sendTaskStats(void)
+{
+    // Task Statistics, one message per task
+    telemTaskStats_t taskStats;
+    uint8_t          index;
+
+    for (index = 0; index < schedulerNumberOfTasks; index++)
+    {
+        strncpy(taskStats.name, schedulerTasks[index].name, sizeof(taskStats.name) - 1);
+        taskStats.name[sizeof(taskStats.name) - 1] = '\0';
+
+        taskStats.runCount      = schedulerTasks[index].stats.runCount;
+        taskStats.overrunCount  = schedulerTasks[index].stats.overrunCount;
+        taskStats.skippedCount  = schedulerTasks[index].stats.skippedCount;
+        taskStats.executionMean = schedulerExecutionMean(&schedulerTasks[index]);
+        taskStats.executionMax  = schedulerTasks[index].stats.executionMax;
+        taskStats.jitterMax     = schedulerTasks[index].stats.jitterMax;
+
+        telemSend(TELEM_TASK_STATS, &taskStats, sizeof(taskStats));
+
+        #if (TELEM_LOG == 1)
+            logPrintF("%s, %ld, %ld, %ld, %ld, %ld, %ld\n", schedulerTasks[index].name,
+                                                            schedulerTasks[index].stats.runCount,
+                                                            schedulerTasks[index].stats.overrunCount,
+                                                            schedulerTasks[index].stats.skippedCount,
+                                                            schedulerExecutionMean(&schedulerTasks[index]),
+                                                            schedulerTasks[index].stats.executionMax,
+                                                            schedulerTasks[index].stats.jitterMax);
+        #endif
+    }
+}
+
+///////////////////////////////////////
+
+static void sendGps(void)
+{
+    telemGps_t gps;
+
+    gps.latitude    = sensors.gpsLatitude;
+    gps.longitude   = sensors.gpsLongitude;
+    gps.altitude    = sensors.gpsAltitude;
+    gps.groundSpeed = sensors.gpsGroundSpeed;
+    gps.groundTrack = sensors.gpsGroundTrack;
+    gps.time        = sensors.gpsTime;
+    gps.hdop        = sensors.gpsHdop;
+    gps.date        = sensors.gpsDate;
+    gps.numSats     = sensors.gpsNumSats;
+    gps.fix         = sensors.gpsFix;
+
+    telemSend(TELEM_GPS, &gps, sizeof(gps));
+}
+
+///////////////////////////////////////
+
+static void sendRc(void)
+{
+    telemRc_t rc;
+    uint8_t   index;
+
+    memcpy(rc.setpoint, rcSetpoint, sizeof(rc.setpoint));
+
+    for (index = 0; index < 8; index++)
+        rc.command[index] = (int16_t)lrintf(rxCommand[index]);
+
+    telemSend(TELEM_RC, &rc, sizeof(rc));
+}
+
+///////////////////////////////////////
+
+static void sendMotors(void)
+{
+    telemMotors_t motors;
+    uint8_t       index;
+
+    for (index = 0; index < 8; index++)
+        motors.motor[index] = (uint16_t)lrintf(motor[index]);
+
+    for (index = 0; index < 3; index++)
+        motors.servo[index] = (uint16_t)lrintf(servo[index]);
+
+    telemSend(TELEM_MOTORS, &motors, sizeof(motors));
+}
+
+///////////////////////////////////////
+
+#define STREAM_NAME(id, NAME, Name)   [id - 1] = #Name,
+
+#define STREAM_BYTES(id, NAME, Name)  [id - 1] = TELEM_HEADER_SIZE + sizeof(telem##Name##_t) + TELEM_CRC_SIZE,
+
+static const char * const streamNames[NUMBER_OF_TELEM_MESSAGES] = { TELEM_MESSAGES(STREAM_NAME) };
+
+static const uint8_t streamBytes[NUMBER_OF_TELEM_MESSAGES] = { TELEM_MESSAGES(STREAM_BYTES) };
+
+static void (* const streamSend[NUMBER_OF_TELEM_MESSAGES])(void) =
+{
+    [TELEM_ACCELS       - 1] = sendAccels,
+    [TELEM_GYROS        - 1] = sendGyros,
+    [TELEM_EARTH_ACCELS - 1] = sendEarthAccels,
+    [TELEM_ATTITUDE     - 1] = sendAttitude,
+    [TELEM_VERTICAL     - 1] = sendVertical,
+    [TELEM_SENSORS      - 1] = sendSensors,
+    [TELEM_ADC_TEST     - 1] = sendAdcTest,
+    [TELEM_TASK_STATS   - 1] = sendTaskStats,
+    [TELEM_GPS          - 1] = sendGps,
+    [TELEM_RC           - 1] = sendRc,
+    [TELEM_MOTORS       - 1] = sendMotors,
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// High Speed Telemetry Streams
+///////////////////////////////////////////////////////////////////////////////
+
+const char *highSpeedTelemName(uint8_t stream)
+{
+    return ((stream >= 1) && (stream <= NUMBER_OF_TELEM_MESSAGES)) ? streamNames[stream - 1] : "";
+}
+
+///////////////////////////////////////
+
+// Link bytes one send takes, the task statistics send a frame per task
+
+uint16_t highSpeedTelemBytes(uint8_t stream)
+{
+    if ((stream < 1) || (stream > NUMBER_OF_TELEM_MESSAGES))
+        return 0;
+
+    if (stream == TELEM_TASK_STATS)
+        return (uint16_t)(streamBytes[stream - 1] * schedulerNumberOfTasks);
+
+    return streamBytes[stream - 1];
+}
+
+///////////////////////////////////////
+
+// Hands the scheduler the rate of every stream that is on, call after a
+// stream is turned on or off or eepromConfig.telemRate changes
+
+static void highSpeedTelemSchedule(void)
+{
+    uint8_t stream;
+
+    for (stream = 1; stream <= NUMBER_OF_TELEM_MESSAGES; stream++)
+        telemSchedulerSetStream(&telemScheduler, stream - 1,
+                                (highSpeedTelemEnabled & (1UL << (stream - 1))) ? eepromConfig.telemRate[stream - 1] : 0,
+                                highSpeedTelemBytes(stream));
+}
+
+///////////////////////////////////////
+
+void highSpeedTelemInit(void)
+{
+    telemSchedulerInit(&telemScheduler, HIGH_SPEED_TELEM_TICK_RATE, eepromConfig.telemBudget, NUMBER_OF_TELEM_MESSAGES);
+
+    highSpeedTelemSchedule();
+}
+
+///////////////////////////////////////
+
+void highSpeedTelemEnable(uint8_t stream, uint8_t enable)
+{
+    if ((stream < 1) || (stream > NUMBER_OF_TELEM_MESSAGES))
+        return;
+
+    if (enable)
+        highSpeedTelemEnabled |=  (1UL << (stream - 1));
+    else
+        highSpeedTelemEnabled &= ~(1UL << (stream - 1));
+
+    highSpeedTelemSchedule();
+}
+
+///////////////////////////////////////
+
+void highSpeedTelemDisable(void)
+{
+    highSpeedTelemEnabled = 0;
+
+    highSpeedTelemSchedule();
+}
+
+///////////////////////////////////////
+
+void highSpeedTelemConfigure(void)
+{
+    telemSchedulerSetBudget(&telemScheduler, eepromConfig.telemBudget);
+
+    highSpeedTelemSchedule();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// High Speed Telemetry Update, from the telemetry task
+///////////////////////////////////////////////////////////////////////////////
+
+void highSpeedTelemUpdate(void)
+{
+    uint32_t due;
+    uint8_t  stream;
+
+    if (highSpeedTelemEnabled == 0)
+        return;
+
+    due = telemSchedulerTick(&telemScheduler, telemetryTxFree());
+
+    for (stream = 0; due != 0; stream++, due >>= 1)
+        if (due & 1)
+            streamSend[stream]();
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,74 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// High Speed Telemetry Defines and Variables
+///////////////////////////////////////////////////////////////////////////////
+
+#define HIGH_SPEED_TELEM_TICK_RATE  500    // Hz, the telemetry task runs at COUNT_500HZ
+
+extern uint32_t highSpeedTelemEnabled;     // Bit n - 1 set when stream n is on
+
+extern telemScheduler_t telemScheduler;
+
+///////////////////////////////////////////////////////////////////////////////
+// High Speed Telemetry Streams
+///////////////////////////////////////////////////////////////////////////////
+
+const char *highSpeedTelemName(uint8_t stream);
+
+uint16_t highSpeedTelemBytes(uint8_t stream);
+
+///////////////////////////////////////////////////////////////////////////////
+// High Speed Telemetry Init, Enable and Disable
+///////////////////////////////////////////////////////////////////////////////
+
+void highSpeedTelemInit(void);
+
+void highSpeedTelemEnable(uint8_t stream, uint8_t enable);
+
+void highSpeedTelemDisable(void);
+
+void highSpeedTelemConfigure(void);
+
+///////////////////////////////////////////////////////////////////////////////
+// High Speed Telemetry Update, from the telemetry task
+///////////////////////////////////////////////////////////////////////////////
+
+void highSpeedTelemUpdate(void);
+
+///////////////////////////////////////////////////////////////////////////////
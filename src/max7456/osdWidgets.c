@@ -176,8 +176,8 @@ void displayArtificialHorizon(float roll, float pitch, uint8_t flightMode)
 
     for (i = 0; i < 6; i++)
     {
-        row = constrain(ahCenter +
-			           (14.5 - (float)ahColumns[i]) * 12 * 1.4 * roll +
+        row = (uint8_t)constrain(ahCenter +
+			           (14.5f - (float)ahColumns[i]) * 12.0f * 1.4f * roll +
 			           (pitch/AH_MAX_PITCH_ANGLE*(ahCenter - ahTopPixel)),
 			            ahTopPixel, ahBottomPixel);
 
@@ -240,7 +240,7 @@ void displayAttitude(float roll, float pitch, uint8_t flightMode)
     uint16_t distNear;
 
     //Calculate row of new pitch lines
-    aiRows[0] = constrain((int)aiCenter +
+    aiRows[0] = (uint8_t)constrain((int)aiCenter +
     		              (int)((pitch / AI_MAX_PITCH_ANGLE) * (aiCenter - aiTopPixel)),
     		               aiTopPixel, aiBottomPixel);
 
@@ -263,10 +263,10 @@ void displayAttitude(float roll, float pitch, uint8_t flightMode)
     distNear = (ROLL_COLUMNS[2] - (RETICLE_COL + 1))*12 + 6;
     gradient = 1.4f * roll; // was "tan(roll)", yes rude but damn fast !!
 
-    aiRows[1] = constrain( 2 * aiCenter - aiRows[4], aiTopPixel, aiBottomPixel);
-    aiRows[2] = constrain( 2 * aiCenter - aiRows[3], aiTopPixel, aiBottomPixel);
-    aiRows[3] = constrain(aiCenter - (int)(((float)distNear) * gradient), aiTopPixel, aiBottomPixel);
-    aiRows[4] = constrain(aiCenter - (int)(((float)distFar)  * gradient), aiTopPixel, aiBottomPixel);
+    aiRows[1] = (uint8_t)constrain( 2 * aiCenter - aiRows[4], aiTopPixel, aiBottomPixel);
+    aiRows[2] = (uint8_t)constrain( 2 * aiCenter - aiRows[3], aiTopPixel, aiBottomPixel);
+    aiRows[3] = (uint8_t)constrain(aiCenter - (int)(((float)distNear) * gradient), aiTopPixel, aiBottomPixel);
+    aiRows[4] = (uint8_t)constrain(aiCenter - (int)(((float)distFar)  * gradient), aiTopPixel, aiBottomPixel);
 
     //writing new roll lines to screen
     for (i = 1; i < 5; i++ )
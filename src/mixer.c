@@ -44,60 +44,264 @@ float motor[8] = { 2000.0f, 2000.0f, 2000.0f, 2000.0f, 2000.0f, 2000.0f, 2000.0f
 
 float servo[3] = { 3000.0f, 3000.0f, 3000.0f, };
 
+float mixerMatrix[8][4];
+
+///////////////////////////////////////////////////////////////////////////////
+// Mixer Matrix Row
+///////////////////////////////////////////////////////////////////////////////
+
+// One motor's share of each command, yaw direction folded in.  Every motor
+// takes the full throttle.
+
+static void mixerRow(uint8_t motor, float roll, float pitch, float yaw)
+{
+    mixerMatrix[motor][ROLL    ] = roll;
+    mixerMatrix[motor][PITCH   ] = pitch;
+    mixerMatrix[motor][YAW     ] = eepromConfig.yawDirection * yaw;
+    mixerMatrix[motor][THROTTLE] = 1.0f;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Initialize Mixer
 ///////////////////////////////////////////////////////////////////////////////
 
+// Builds the motor matrix for the airframe.  Call again after any change
+// to the mixer configuration, free mix, V tail angle or yaw direction.
+
 void initMixer(void)
 {
+    uint8_t i;
+
+    vTailThrust = sinf(eepromConfig.vTailAngle);
+
     switch (eepromConfig.mixerConfiguration)
     {
         case MIXERTYPE_GIMBAL:
             numberMotor = 0;
             break;
 
+        ///////////////////////////////
+
         case MIXERTYPE_FLYING_WING:
-	        numberMotor = 1;
-	        break;
+            numberMotor = 1;
+            mixerRow(0,  0.0f, 0.0f, 0.0f);                // Throttle only, the servos steer
+            break;
+
+        ///////////////////////////////
 
         case MIXERTYPE_BI:
             numberMotor = 2;
+            mixerRow(0,  1.0f, 0.0f, 0.0f);                // Left Motor
+            mixerRow(1, -1.0f, 0.0f, 0.0f);                // Right Motor
             break;
 
+        ///////////////////////////////
+
         case MIXERTYPE_TRI:
             numberMotor = 3;
+            mixerRow(0,  1.0f, -0.666667f, 0.0f);          // Left  CW
+            mixerRow(1, -1.0f, -0.666667f, 0.0f);          // Right CCW
+            mixerRow(2,  0.0f,  1.333333f, 0.0f);          // Rear  CW or CCW
             break;
 
+        ///////////////////////////////
+
         case MIXERTYPE_QUADP:
+            numberMotor = 4;
+            mixerRow(0,  0.0f, -1.0f, -1.0f);              // Front CW
+            mixerRow(1, -1.0f,  0.0f,  1.0f);              // Right CCW
+            mixerRow(2,  0.0f,  1.0f, -1.0f);              // Rear  CW
+            mixerRow(3,  1.0f,  0.0f,  1.0f);              // Left  CCW
+            break;
+
+        ///////////////////////////////
+
         case MIXERTYPE_QUADX:
+            numberMotor = 4;
+            mixerRow(0,  1.0f, -1.0f, -1.0f);              // Front Left  CW
+            mixerRow(1, -1.0f, -1.0f,  1.0f);              // Front Right CCW
+            mixerRow(2, -1.0f,  1.0f, -1.0f);              // Rear Right  CW
+            mixerRow(3,  1.0f,  1.0f,  1.0f);              // Rear Left   CCW
+            break;
+
+        ///////////////////////////////
+
+        // NOTE rotation difference for the V tail configurations, front
+        // left CCW, front right CW, rear right CCW, rear left CW
+
         case MIXERTYPE_VTAIL4_NO_COMP:
+            numberMotor = 4;
+            mixerRow(0,  1.0f, -1.0f,  0.0f);              // Front Left
+            mixerRow(1, -1.0f, -1.0f,  0.0f);              // Front Right
+            mixerRow(2,  0.0f,  1.0f,  1.0f);              // Rear Right
+            mixerRow(3,  0.0f,  1.0f, -1.0f);              // Rear Left
+            break;
+
         case MIXERTYPE_VTAIL4_Y_COMP:
-		case MIXERTYPE_VTAIL4_RY_COMP:
-		case MIXERTYPE_VTAIL4_PY_COMP:
-		case MIXERTYPE_VTAIL4_RP_COMP:
+            numberMotor = 4;
+            mixerRow(0,  1.0f, -1.0f,  vTailThrust);
+            mixerRow(1, -1.0f, -1.0f, -vTailThrust);
+            mixerRow(2,  0.0f,  1.0f,  1.0f);
+            mixerRow(3,  0.0f,  1.0f, -1.0f);
+            break;
+
+        case MIXERTYPE_VTAIL4_RY_COMP:
+            numberMotor = 4;
+            mixerRow(0,  1.0f, -vTailThrust,  vTailThrust);
+            mixerRow(1, -1.0f, -vTailThrust, -vTailThrust);
+            mixerRow(2,  0.0f,  1.0f,          1.0f);
+            mixerRow(3,  0.0f,  1.0f,         -1.0f);
+            break;
+
+        case MIXERTYPE_VTAIL4_PY_COMP:
+            numberMotor = 4;
+            mixerRow(0,  vTailThrust, -1.0f,  vTailThrust);
+            mixerRow(1, -vTailThrust, -1.0f, -vTailThrust);
+            mixerRow(2, -1.0f,         1.0f,  1.0f);
+            mixerRow(3,  1.0f,         1.0f, -1.0f);
+            break;
+
+        case MIXERTYPE_VTAIL4_RP_COMP:
+            numberMotor = 4;
+            mixerRow(0,  vTailThrust, -vTailThrust,  0.0f);
+            mixerRow(1, -vTailThrust, -vTailThrust,  0.0f);
+            mixerRow(2, -1.0f,         1.0f,         1.0f);
+            mixerRow(3,  1.0f,         1.0f,        -1.0f);
+            break;
+
         case MIXERTYPE_VTAIL4_RPY_COMP:
+            numberMotor = 4;
+            mixerRow(0,  vTailThrust, -vTailThrust,  vTailThrust);
+            mixerRow(1, -vTailThrust, -vTailThrust, -vTailThrust);
+            mixerRow(2, -1.0f,         1.0f,         1.0f);
+            mixerRow(3,  1.0f,         1.0f,        -1.0f);
+            break;
+
+        ///////////////////////////////
+
         case MIXERTYPE_Y4:
             numberMotor = 4;
+            mixerRow(0,  1.0f, -1.0f,  0.0f);              // Front Left  CW
+            mixerRow(1, -1.0f, -1.0f,  0.0f);              // Front Right CCW
+            mixerRow(2,  0.0f,  1.0f, -1.0f);              // Top Rear    CW
+            mixerRow(3,  0.0f,  1.0f,  1.0f);              // Bottom Rear CCW
             break;
 
+        ///////////////////////////////
+
         case MIXERTYPE_HEX6P:
+            numberMotor = 6;
+            mixerRow(0,  0.0f, -0.866025f, -1.0f);         // Front       CW
+            mixerRow(1, -1.0f, -0.866025f,  1.0f);         // Front Right CCW
+            mixerRow(2, -1.0f,  0.866025f, -1.0f);         // Rear Right  CW
+            mixerRow(3,  0.0f,  0.866025f,  1.0f);         // Rear        CCW
+            mixerRow(4,  1.0f,  0.866025f, -1.0f);         // Rear Left   CW
+            mixerRow(5,  1.0f, -0.866025f,  1.0f);         // Front Left  CCW
+            break;
+
+        ///////////////////////////////
+
         case MIXERTYPE_HEX6X:
+            numberMotor = 6;
+            mixerRow(0,  0.866025f, -1.0f, -1.0f);         // Front Left  CW
+            mixerRow(1, -0.866025f, -1.0f,  1.0f);         // Front Right CCW
+            mixerRow(2, -0.866025f,  0.0f, -1.0f);         // Right       CW
+            mixerRow(3, -0.866025f,  1.0f,  1.0f);         // Rear Right  CCW
+            mixerRow(4,  0.866025f,  1.0f, -1.0f);         // Rear Left   CW
+            mixerRow(5,  0.866025f,  0.0f,  1.0f);         // Left        CCW
+            break;
+
+        ///////////////////////////////
+
         case MIXERTYPE_Y6:
             numberMotor = 6;
+            mixerRow(0,  1.0f, -0.666667f, -1.0f);         // Top Left     CW
+            mixerRow(1, -1.0f, -0.666667f, -1.0f);         // Top Right    CW
+            mixerRow(2,  0.0f,  1.333333f,  1.0f);         // Top Rear     CCW
+            mixerRow(3,  1.0f, -0.666667f,  1.0f);         // Bottom Left  CCW
+            mixerRow(4, -1.0f, -0.666667f,  1.0f);         // Bottom Right CCW
+            mixerRow(5,  0.0f,  1.333333f, -1.0f);         // Bottom Rear  CW
             break;
 
+        ///////////////////////////////
+
         case MIXERTYPE_OCTOF8P:
+            numberMotor = 8;
+            mixerRow(0,  0.0f, -1.0f, -1.0f);              // Front       CW
+            mixerRow(1, -0.7f, -0.7f,  1.0f);              // Front Right CCW
+            mixerRow(2, -1.0f,  0.0f, -1.0f);              // Right       CW
+            mixerRow(3, -0.7f,  0.7f,  1.0f);              // Rear Right  CCW
+            mixerRow(4,  0.0f,  1.0f, -1.0f);              // Rear        CW
+            mixerRow(5,  0.7f,  0.7f,  1.0f);              // Rear left   CCW
+            mixerRow(6,  1.0f,  0.0f, -1.0f);              // Left        CW
+            mixerRow(7,  0.7f, -0.7f,  1.0f);              // Front Left  CCW
+            break;
+
+        ///////////////////////////////
+
         case MIXERTYPE_OCTOF8X:
+            numberMotor = 8;
+            mixerRow(0,  0.5f, -1.0f, -1.0f);              // Front Left      CW
+            mixerRow(1, -0.5f, -1.0f,  1.0f);              // Front Right     CCW
+            mixerRow(2, -1.0f, -0.5f, -1.0f);              // Mid Front Right CW
+            mixerRow(3, -1.0f,  0.5f,  1.0f);              // Mid Rear Right  CCW
+            mixerRow(4, -0.5f,  1.0f, -1.0f);              // Rear Right      CW
+            mixerRow(5,  0.5f,  1.0f,  1.0f);              // Rear Left       CCW
+            mixerRow(6,  1.0f,  0.5f, -1.0f);              // Mid Rear left   CW
+            mixerRow(7,  1.0f, -0.5f,  1.0f);              // Mid Front Left  CCW
+            break;
+
+        ///////////////////////////////
+
         case MIXERTYPE_OCTOX8P:
+            numberMotor = 8;
+            mixerRow(0,  0.0f, -1.0f, -1.0f);              // Top Front    CW
+            mixerRow(1, -1.0f,  0.0f,  1.0f);              // Top Right    CCW
+            mixerRow(2,  0.0f,  1.0f, -1.0f);              // Top Rear     CW
+            mixerRow(3,  1.0f,  0.0f,  1.0f);              // Top Left     CCW
+            mixerRow(4,  0.0f, -1.0f, -1.0f);              // Bottom Front CCW
+            mixerRow(5, -1.0f,  0.0f,  1.0f);              // Bottom Right CW
+            mixerRow(6,  0.0f,  1.0f, -1.0f);              // Bottom Rear  CCW
+            mixerRow(7,  1.0f,  0.0f,  1.0f);              // Bottom Left  CW
+            break;
+
+        ///////////////////////////////
+
         case MIXERTYPE_OCTOX8X:
             numberMotor = 8;
+            mixerRow(0,  1.0f, -1.0f, -1.0f);              // Top Front Left     CW
+            mixerRow(1, -1.0f, -1.0f,  1.0f);              // Top Front Right    CCW
+            mixerRow(2, -1.0f,  1.0f, -1.0f);              // Top Rear Right     CW
+            mixerRow(3,  1.0f,  1.0f,  1.0f);              // Top Rear Left      CCW
+            mixerRow(4,  1.0f, -1.0f, -1.0f);              // Bottom Front Left  CCW
+            mixerRow(5, -1.0f, -1.0f,  1.0f);              // Bottom Front Right CW
+            mixerRow(6, -1.0f,  1.0f, -1.0f);              // Bottom Rear Right  CCW
+            mixerRow(7,  1.0f,  1.0f,  1.0f);              // Bottom Rear Left   CW
             break;
 
+        ///////////////////////////////
+
         case MIXERTYPE_FREEMIX:
-        	numberMotor = eepromConfig.freeMixMotors;
-        	break;
+            numberMotor = (eepromConfig.freeMixMotors > 8) ? 8 : eepromConfig.freeMixMotors;
 
+            for (i = 0; i < numberMotor; i++)
+                mixerRow(i, eepromConfig.freeMix[i][ROLL ],
+                            eepromConfig.freeMix[i][PITCH],
+                            eepromConfig.freeMix[i][YAW  ]);
+            break;
+
+        ///////////////////////////////
+
+        default:
+            numberMotor = 0;
+            break;
     }
+
+    // Rows are rewritten in place, a mix that lands partway through sees
+    // only the motor being changed half done
+
+    for (i = numberMotor; i < 8; i++)
+        memset(mixerMatrix[i], 0, sizeof(mixerMatrix[i]));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -119,8 +323,16 @@ void writeMotors(void)
 {
     uint8_t i;
 
+    // DShot frames still going out are read from the buffers a write
+    // encodes into, these commands wait for the next write
+
+    if (pwmEscBusy())
+        return;
+
     for (i = 0; i < numberMotor; i++)
         pwmEscWrite(i, (uint16_t)motor[i]);
+
+    pwmEscTrigger();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -137,6 +349,24 @@ void writeAllMotors(float mc)
     writeMotors();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Hold Motors
+///////////////////////////////////////////////////////////////////////////////
+
+// OneShot ESCs only see a pulse when the motors are written, so a command
+// held across a delay is rewritten every 2 mSec.
+
+void holdMotors(uint32_t ms)
+{
+    uint32_t i;
+
+    for (i = 0; i < ms; i += 2)
+    {
+        writeMotors();
+        delay(2);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Pulse Motors
 ///////////////////////////////////////////////////////////////////////////////
@@ -148,47 +378,31 @@ void pulseMotors(uint8_t quantity)
     for ( i = 0; i < quantity; i++ )
     {
         writeAllMotors( eepromConfig.minThrottle );
-        delay(250);
+        holdMotors(250);
         writeAllMotors( (float)MINCOMMAND );
-        delay(250);
+        holdMotors(250);
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// Mixer
+// Servo Mixer
 ///////////////////////////////////////////////////////////////////////////////
 
-#define PIDMIX(X,Y,Z) rxCommand[THROTTLE] + axisPID[ROLL] * (X) + axisPID[PITCH] * (Y) + eepromConfig.yawDirection * axisPID[YAW] * (Z)
-
-void mixTable(void)
+static void mixServos(void)
 {
-    int16_t maxMotor;
-    uint8_t i;
-
-    ///////////////////////////////////
-    /*
-    if ( numberMotor > 3 )
-    {
-        //prevent "yaw jump" during yaw correction
-        axisPID[YAW] = constrain(axisPID[YAW], -100 - fabs(rcCommand[YAW]), +100 + fabs(rcCommand[YAW]));
-    }
-    */
-    ///////////////////////////////////
-
     switch ( eepromConfig.mixerConfiguration )
     {
         case MIXERTYPE_GIMBAL:
-            servo[0] = constrain( eepromConfig.gimbalRollServoMid + eepromConfig.gimbalRollServoGain * sensors.attitude500Hz[ROLL] + rxCommand[ROLL],
+            servo[0] = constrain( eepromConfig.gimbalRollServoMid + eepromConfig.gimbalRollServoGain * getAttitude()[ROLL] + rxCommand[ROLL],
                                   eepromConfig.gimbalRollServoMin, eepromConfig.gimbalRollServoMax );
 
-            servo[1] = constrain( eepromConfig.gimbalPitchServoMid + eepromConfig.gimbalPitchServoGain * sensors.attitude500Hz[PITCH] + rxCommand[PITCH],
+            servo[1] = constrain( eepromConfig.gimbalPitchServoMid + eepromConfig.gimbalPitchServoGain * getAttitude()[PITCH] + rxCommand[PITCH],
                                   eepromConfig.gimbalPitchServoMin, eepromConfig.gimbalPitchServoMax );
             break;
 
         ///////////////////////////////
 
         case MIXERTYPE_FLYING_WING:
-            motor[0] = rxCommand[THROTTLE];
             if (flightMode != ATTITUDE)
             {   // do not use sensors for correction, simple 2 channel mixing
             	servo[0] = eepromConfig.pitchDirectionLeft  * (rxCommand[PITCH] - eepromConfig.midCommand) +
@@ -216,9 +430,6 @@ void mixTable(void)
         ///////////////////////////////
 
         case MIXERTYPE_BI:
-            motor[0] = PIDMIX(  1.0f, 0.0f, 0.0f );        // Left Motor
-            motor[1] = PIDMIX( -1.0f, 0.0f, 0.0f );        // Right Motor
-
             servo[0] = constrain( eepromConfig.biLeftServoMid + (eepromConfig.yawDirection * axisPID[YAW]) + axisPID[PITCH],
                                   eepromConfig.biLeftServoMin, eepromConfig.biLeftServoMax );   // Left Servo
 
@@ -229,208 +440,105 @@ void mixTable(void)
         ///////////////////////////////
 
         case MIXERTYPE_TRI:
-            motor[0] = PIDMIX(  1.0f, -0.666667f, 0.0f );  // Left  CW
-            motor[1] = PIDMIX( -1.0f, -0.666667f, 0.0f );  // Right CCW
-            motor[2] = PIDMIX(  0.0f,  1.333333f, 0.0f );  // Rear  CW or CCW
-
             servo[0] = constrain( eepromConfig.triYawServoMid + eepromConfig.yawDirection * axisPID[YAW],
                                   eepromConfig.triYawServoMin, eepromConfig.triYawServoMax ); // Tail Servo
             break;
+    }
+}
 
-        ///////////////////////////////
-
-        case MIXERTYPE_QUADP:
-            motor[0] = PIDMIX(  0.0f, -1.0f, -1.0f );      // Front CW
-            motor[1] = PIDMIX( -1.0f,  0.0f,  1.0f );      // Right CCW
-            motor[2] = PIDMIX(  0.0f,  1.0f, -1.0f );      // Rear  CW
-            motor[3] = PIDMIX(  1.0f,  0.0f,  1.0f );      // Left  CCW
-            break;
-
-        ///////////////////////////////
-
-        case MIXERTYPE_QUADX:
-            motor[0] = PIDMIX(  1.0f, -1.0f, -1.0f );      // Front Left  CW
-            motor[1] = PIDMIX( -1.0f, -1.0f,  1.0f );      // Front Right CCW
-            motor[2] = PIDMIX( -1.0f,  1.0f, -1.0f );      // Rear Right  CW
-            motor[3] = PIDMIX(  1.0f,  1.0f,  1.0f );      // Rear Left   CCW
-            break;
-
-        ///////////////////////////////
-
-        case MIXERTYPE_VTAIL4_NO_COMP:
-            motor[0] = PIDMIX(  1.0f, -1.0f,  0.0f );      // Front Left  CCW - NOTE rotation difference for vtail configurations
-            motor[1] = PIDMIX( -1.0f, -1.0f,  0.0f );      // Front Right CW  - NOTE rotation difference for vtail configurations
-            motor[2] = PIDMIX(  0.0f,  1.0f,  1.0f );      // Rear Right  CCW - NOTE rotation difference for vtail configurations
-            motor[3] = PIDMIX(  0.0f,  1.0f, -1.0f );      // Rear Left   CW  - NOTE rotation difference for vtail configurations
-            break;
-
-        ///////////////////////////////
-
-        case MIXERTYPE_VTAIL4_Y_COMP:
-		    motor[0] = PIDMIX(  1.0f, -1.0f,  vTailThrust ); // Front Left  CCW - NOTE rotation difference for vtail configurations
-		    motor[1] = PIDMIX( -1.0f, -1.0f, -vTailThrust ); // Front Right CW  - NOTE rotation difference for vtail configurations
-		    motor[2] = PIDMIX(  0.0f,  1.0f,  1.0f        ); // Rear Right  CCW - NOTE rotation difference for vtail configurations
-		    motor[3] = PIDMIX(  0.0f,  1.0f, -1.0f        ); // Rear Left   CW  - NOTE rotation difference for vtail configurations
-		    break;
-
-        ///////////////////////////////
-
-        case MIXERTYPE_VTAIL4_RY_COMP:
-        	motor[0] = PIDMIX(  1.0f, -vTailThrust,  vTailThrust ); // Front Left  CCW - NOTE rotation difference for vtail configurations
-			motor[1] = PIDMIX( -1.0f, -vTailThrust, -vTailThrust ); // Front Right CW  - NOTE rotation difference for vtail configurations
-			motor[2] = PIDMIX(  0.0f,  1.0f,          1.0f       ); // Rear Right  CCW - NOTE rotation difference for vtail configurations
-			motor[3] = PIDMIX(  0.0f,  1.0f,         -1.0f       ); // Rear Left   CW  - NOTE rotation difference for vtail configurations
-			break;
-
-        ///////////////////////////////
-
-        case MIXERTYPE_VTAIL4_PY_COMP:
-            motor[0] = PIDMIX(  vTailThrust, -1.0f,  vTailThrust ); // Front Left  CCW - NOTE rotation difference for vtail configurations
-			motor[1] = PIDMIX( -vTailThrust, -1.0f, -vTailThrust ); // Front Right CW  - NOTE rotation difference for vtail configurations
-			motor[2] = PIDMIX( -1.0f,         1.0f,  1.0f        ); // Rear Right  CCW - NOTE rotation difference for vtail configurations
-			motor[3] = PIDMIX(  1.0f,         1.0f, -1.0f        ); // Rear Left   CW  - NOTE rotation difference for vtail configurations
-			break;
-
-        ///////////////////////////////
-
-        case MIXERTYPE_VTAIL4_RP_COMP:
-            motor[0] = PIDMIX(  vTailThrust, -vTailThrust,  0.0f ); // Front Left  CCW - NOTE rotation difference for vtail configurations
-			motor[1] = PIDMIX( -vTailThrust, -vTailThrust, -0.0f ); // Front Right CW  - NOTE rotation difference for vtail configurations
-			motor[2] = PIDMIX( -1.0f,         1.0f,         1.0f ); // Rear Right  CCW - NOTE rotation difference for vtail configurations
-			motor[3] = PIDMIX(  1.0f,         1.0f,        -1.0f ); // Rear Left   CW  - NOTE rotation difference for vtail configurations
-			break;
-
-        ///////////////////////////////
-
-        case MIXERTYPE_VTAIL4_RPY_COMP:
-        	motor[0] = PIDMIX(  vTailThrust, -vTailThrust,  vTailThrust ); // Front Left  CCW - NOTE rotation difference for vtail configurations
-			motor[1] = PIDMIX( -vTailThrust, -vTailThrust, -vTailThrust ); // Front Right CW  - NOTE rotation difference for vtail configurations
-			motor[2] = PIDMIX( -1.0f,         1.0f,         1.0f        ); // Rear Right  CCW - NOTE rotation difference for vtail configurations
-			motor[3] = PIDMIX(  1.0f,         1.0f,        -1.0f        ); // Rear Left   CW  - NOTE rotation difference for vtail configurations
-			break;
-
-        ///////////////////////////////
-
-        case MIXERTYPE_Y4:
-            motor[0] = PIDMIX(  1.0f, -1.0f,  0.0f );      // Front Left  CW
-            motor[1] = PIDMIX( -1.0f, -1.0f,  0.0f );      // Front Right CCW
-            motor[2] = PIDMIX(  0.0f,  1.0f, -1.0f );      // Top Rear    CW
-            motor[3] = PIDMIX(  0.0f,  1.0f,  1.0f );      // Bottom Rear CCW
-            break;
+///////////////////////////////////////////////////////////////////////////////
+// Mixer Desaturation
+///////////////////////////////////////////////////////////////////////////////
 
-        ///////////////////////////////
+// Roll and pitch hold the airframe level, so they keep their full command
+// whenever it fits between minThrottle and maxThrottle.  The collective
+// moves first, up or down, to fit all three axes.  If it cannot, it fits
+// roll and pitch alone and yaw is scaled down into the room left.  Roll
+// and pitch are only scaled when their spread alone exceeds the range,
+// and then yaw gets nothing.
 
-        case MIXERTYPE_HEX6P:
-            motor[0] = PIDMIX(  0.0f, -0.866025f, -1.0f ); // Front       CW
-            motor[1] = PIDMIX( -1.0f, -0.866025f,  1.0f ); // Front Right CCW
-            motor[2] = PIDMIX( -1.0f,  0.866025f, -1.0f ); // Rear Right  CW
-            motor[3] = PIDMIX(  0.0f,  0.866025f,  1.0f ); // Rear        CCW
-            motor[4] = PIDMIX(  1.0f,  0.866025f, -1.0f ); // Rear Left   CW
-            motor[5] = PIDMIX(  1.0f, -0.866025f,  1.0f ); // Front Left  CCW
-            break;
+static void desaturate(const float rollPitch[8], const float yaw[8], float throttle)
+{
+    const float minThrottle = eepromConfig.minThrottle;
+    const float maxThrottle = eepromConfig.maxThrottle;
+    const float range       = maxThrottle - minThrottle;
+    float       rpMin, rpMax, allMin, allMax, rpScale = 1.0f, yawScale = 1.0f, level, limit;
+    uint8_t     i;
 
-        ///////////////////////////////
+    rpMin  = rpMax  = rollPitch[0];
+    allMin = allMax = rollPitch[0] + yaw[0];
 
-        case MIXERTYPE_HEX6X:
-            motor[0] = PIDMIX(  0.866025f, -1.0f, -1.0f ); // Front Left  CW
-            motor[1] = PIDMIX( -0.866025f, -1.0f,  1.0f ); // Front Right CCW
-            motor[2] = PIDMIX( -0.866025f,  0.0f, -1.0f ); // Right       CW
-            motor[3] = PIDMIX( -0.866025f,  1.0f,  1.0f ); // Rear Right  CCW
-            motor[4] = PIDMIX(  0.866025f,  1.0f, -1.0f ); // Rear Left   CW
-            motor[5] = PIDMIX(  0.866025f,  0.0f,  1.0f ); // Left        CCW
-            break;
+    for (i = 1; i < numberMotor; i++)
+    {
+        if (rollPitch[i] < rpMin) rpMin = rollPitch[i];
+        if (rollPitch[i] > rpMax) rpMax = rollPitch[i];
 
-        ///////////////////////////////
+        if ((rollPitch[i] + yaw[i]) < allMin) allMin = rollPitch[i] + yaw[i];
+        if ((rollPitch[i] + yaw[i]) > allMax) allMax = rollPitch[i] + yaw[i];
+    }
 
-        case MIXERTYPE_Y6:
-            motor[0] = PIDMIX(  1.0f, -0.666667, -1.0f );  // Top Left     CW
-            motor[1] = PIDMIX( -1.0f, -0.666667, -1.0f );  // Top Right    CW
-            motor[2] = PIDMIX(  0.0f,  1.333333,  1.0f );  // Top Rear     CCW
-            motor[3] = PIDMIX(  1.0f, -0.666667,  1.0f );  // Bottom Left  CCW
-            motor[4] = PIDMIX( -1.0f, -0.666667,  1.0f );  // Bottom Right CCW
-            motor[5] = PIDMIX(  0.0f,  1.333333, -1.0f );  // Bottom Rear  CW
-            break;
+    if ((allMax - allMin) <= range)
+    {
+        throttle = constrain(throttle, minThrottle - allMin, maxThrottle - allMax);
+    }
+    else if ((rpMax - rpMin) > range)
+    {
+        rpScale  = range / (rpMax - rpMin);
+        yawScale = 0.0f;
+        throttle = minThrottle - rpScale * rpMin;
+    }
+    else
+    {
+        throttle = constrain(throttle, minThrottle - rpMin, maxThrottle - rpMax);
 
-        ///////////////////////////////
+        for (i = 0; i < numberMotor; i++)
+        {
+            level = throttle + rollPitch[i];
 
-        case MIXERTYPE_OCTOF8P:
-            motor[0] = PIDMIX(  0.0f, -1.0f, -1.0f );      // Front       CW
-            motor[1] = PIDMIX( -0.7f, -0.7f,  1.0f );      // Front Right CCW
-            motor[2] = PIDMIX( -1.0f,  0.0f, -1.0f );      // Right       CW
-            motor[3] = PIDMIX( -0.7f,  0.7f,  1.0f );      // Rear Right  CCW
-            motor[4] = PIDMIX(  0.0f,  1.0f, -1.0f );      // Rear        CW
-            motor[5] = PIDMIX(  0.7f,  0.7f,  1.0f );      // Rear left   CCW
-            motor[6] = PIDMIX(  1.0f,  0.0f, -1.0f );      // Left        CW
-            motor[7] = PIDMIX(  0.7f, -0.7f,  1.0f );      // Front Left  CCW
-            break;
+            if (yaw[i] > 0.0f)
+                limit = (maxThrottle - level) / yaw[i];
+            else if (yaw[i] < 0.0f)
+                limit = (minThrottle - level) / yaw[i];
+            else
+                continue;
 
-        ///////////////////////////////
+            if (limit < yawScale)
+                yawScale = (limit > 0.0f) ? limit : 0.0f;
+        }
+    }
 
-        case MIXERTYPE_OCTOF8X:
-            motor[0] = PIDMIX(  0.5f, -1.0f, -1.0f );      // Front Left      CW
-            motor[1] = PIDMIX( -0.5f, -1.0f,  1.0f );      // Front Right     CCW
-            motor[2] = PIDMIX( -1.0f, -0.5f, -1.0f );      // Mid Front Right CW
-            motor[3] = PIDMIX( -1.0f,  0.5f,  1.0f );      // Mid Rear Right  CCW
-            motor[4] = PIDMIX( -0.5f,  1.0f, -1.0f );      // Rear Right      CW
-            motor[5] = PIDMIX(  0.5f,  1.0f,  1.0f );      // Rear Left       CCW
-            motor[6] = PIDMIX(  1.0f,  0.5f, -1.0f );      // Mid Rear left   CW
-            motor[7] = PIDMIX(  1.0f, -0.5f,  1.0f );      // Mid Front Left  CCW
-            break;
+    for (i = 0; i < numberMotor; i++)
+        motor[i] = mixerMatrix[i][THROTTLE] * throttle + rpScale * rollPitch[i] + yawScale * yaw[i];
+}
 
-        ///////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+// Mixer
+///////////////////////////////////////////////////////////////////////////////
 
-        case MIXERTYPE_OCTOX8P:
-            motor[0] = PIDMIX(  0.0f, -1.0f, -1.0f );      // Top Front    CW
-            motor[1] = PIDMIX( -1.0f,  0.0f,  1.0f );      // Top Right    CCW
-            motor[2] = PIDMIX(  0.0f,  1.0f, -1.0f );      // Top Rear     CW
-            motor[3] = PIDMIX(  1.0f,  0.0f,  1.0f );      // Top Left     CCW
-            motor[4] = PIDMIX(  0.0f, -1.0f, -1.0f );      // Bottom Front CCW
-            motor[5] = PIDMIX( -1.0f,  0.0f,  1.0f );      // Bottom Right CW
-            motor[6] = PIDMIX(  0.0f,  1.0f, -1.0f );      // Bottom Rear  CCW
-            motor[7] = PIDMIX(  1.0f,  0.0f,  1.0f );      // Bottom Left  CW
-            break;
+void mixTable(void)
+{
+    const float *m;
+    float       rollPitch[8], yaw[8];
+    uint8_t     i;
 
-        ///////////////////////////////
+    mixServos();
 
-        case MIXERTYPE_OCTOX8X:
-            motor[0] = PIDMIX(  1.0f, -1.0f, -1.0f );      // Top Front Left     CW
-            motor[1] = PIDMIX( -1.0f, -1.0f,  1.0f );      // Top Front Right    CCW
-            motor[2] = PIDMIX( -1.0f,  1.0f, -1.0f );      // Top Rear Right     CW
-            motor[3] = PIDMIX(  1.0f,  1.0f,  1.0f );      // Top Rear Left      CCW
-            motor[4] = PIDMIX(  1.0f, -1.0f, -1.0f );      // Bottom Front Left  CCW
-            motor[5] = PIDMIX( -1.0f, -1.0f,  1.0f );      // Bottom Front Right CW
-            motor[6] = PIDMIX( -1.0f,  1.0f, -1.0f );      // Bottom Rear Right  CCW
-            motor[7] = PIDMIX(  1.0f,  1.0f,  1.0f );      // Bottom Rear Left   CW
-            break;
+    // motor = mixerMatrix * [ roll pitch yaw throttle ], kept in parts for
+    // the desaturation, which moves the throttle term as one collective.
 
-        ///////////////////////////////
+    for (i = 0; i < numberMotor; i++)
+    {
+        m = mixerMatrix[i];
 
-        case MIXERTYPE_FREEMIX:
-        	for ( i = 0; i < numberMotor; i++ )
-        	{
-        		motor[i] = PIDMIX ( eepromConfig.freeMix[i][ROLL],
-        				            eepromConfig.freeMix[i][PITCH],
-        				            eepromConfig.freeMix[i][YAW] );
-        	}
-
-        	break;
+        rollPitch[i] = m[ROLL] * axisPID[ROLL] + m[PITCH] * axisPID[PITCH];
+        yaw[i]       = m[YAW ] * axisPID[YAW ];
     }
 
-    ///////////////////////////////////
-
-    // this is a way to still have good gyro corrections if any motor reaches its max.
-
-    maxMotor = motor[0];
-
-    for (i = 1; i < numberMotor; i++)
-        if (motor[i] > maxMotor)
-            maxMotor = motor[i];
+    if (numberMotor > 0)
+        desaturate(rollPitch, yaw, rxCommand[THROTTLE]);
 
     for (i = 0; i < numberMotor; i++)
     {
-        if (maxMotor > eepromConfig.maxThrottle)
-            motor[i] -= maxMotor - eepromConfig.maxThrottle;
-
         motor[i] = constrain(motor[i], eepromConfig.minThrottle, eepromConfig.maxThrottle);
 
         if ((rxCommand[THROTTLE]) < eepromConfig.minCheck)
@@ -44,6 +44,8 @@ extern float motor[8];
 
 extern float servo[3];
 
+extern float mixerMatrix[8][4];        // Per motor, indexed ROLL, PITCH, YAW, THROTTLE
+
 ///////////////////////////////////////////////////////////////////////////////
 // Initialize Mixer
 ///////////////////////////////////////////////////////////////////////////////
@@ -68,6 +70,12 @@ void writeMotors(void);
 
 void writeAllMotors(float mc);
 
+///////////////////////////////////////////////////////////////////////////////
+// Hold Motors
+///////////////////////////////////////////////////////////////////////////////
+
+void holdMotors(uint32_t ms);
+
 ///////////////////////////////////////////////////////////////////////////////
 // Pulse Motors
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,80 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// _sbrk
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * newlib_stubs.c
+ *
+ *  Created on: 2 Nov 2010
+ *      Author: nanoage.co.uk
+ */
+
+/*
+ sbrk
+ Increase program data space.
+ Malloc and related functions depend on this
+ */
+
+caddr_t _sbrk(int incr)
+{
+    extern char _ebss; // Defined by the linker
+    static char *heap_end;
+    char *prev_heap_end;
+
+    char * stack;
+
+    if (heap_end == 0)
+        heap_end = &_ebss;
+
+    prev_heap_end = heap_end;
+
+    stack = (char*) __get_MSP();
+    if (heap_end + incr >  stack)
+    {
+        errno = ENOMEM;
+        return  (caddr_t) -1;
+    }
+
+    heap_end += incr;
+    return (caddr_t) prev_heap_end;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -32,6 +32,7 @@
   along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "board.h"
@@ -43,27 +44,73 @@ uint8_t holdIntegrators = true;
 #define F_CUT 20.0f
 float rc;
 
+///////////////////////////////////////
+
+// Controller state, indexed by PID number.  Kept out of eepromConfig so
+// writing the configuration never touches a running controller.
+
+static struct
+{
+    float iTerm[NUMBER_OF_PIDS];
+    float lastDcalcValue[NUMBER_OF_PIDS];
+    float lastDterm[NUMBER_OF_PIDS];
+    float lastLastDterm[NUMBER_OF_PIDS];
+} pidState;
+
+// Rate loop gains, one entry per axis, copied from eepromConfig.PID[ROLL_RATE_PID..YAW_RATE_PID]
+// by loadRatePIDs().  dErrorCalc is folded into weights so updateRatePIDs() never branches on it.
+
+static struct
+{
+    float PB[3];
+    float P[3];
+    float I[3];
+    float D[3];
+    float windupGuard[3];
+    float dErrorWeight[3];   // 1 for D_ERROR, 0 for D_STATE
+    float dStateWeight[3];   // 0 for D_ERROR, 1 for D_STATE
+    float dSign[3];          // D_STATE differentiates the negated state
+} rateGains;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void initPID(void)
 {
-    uint8_t index;
-
     rc = 1.0f / ( TWO_PI * F_CUT );
 
-    for (index = 0; index < NUMBER_OF_PIDS; index++)
+    memset(&pidState, 0, sizeof(pidState));
+
+    loadRatePIDs();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void loadRatePIDs(void)
+{
+    const PIDdata_t *pid;
+    uint8_t         axis;
+
+    for (axis = 0; axis < 3; axis++)
     {
-    	eepromConfig.PID[index].iTerm          = 0.0f;
-    	eepromConfig.PID[index].lastDcalcValue = 0.0f;
-    	eepromConfig.PID[index].lastDterm      = 0.0f;
-    	eepromConfig.PID[index].lastLastDterm  = 0.0f;
-	}
+        pid = &eepromConfig.PID[ROLL_RATE_PID + axis];
+
+        rateGains.PB[axis]           = pid->P * pid->B;
+        rateGains.P[axis]            = pid->P;
+        rateGains.I[axis]            = pid->I;
+        rateGains.D[axis]            = pid->D;
+        rateGains.windupGuard[axis]  = pid->windupGuard;
+        rateGains.dErrorWeight[axis] = (pid->dErrorCalc == D_ERROR) ? 1.0f : 0.0f;
+        rateGains.dStateWeight[axis] = (pid->dErrorCalc == D_ERROR) ? 0.0f : 1.0f;
+        rateGains.dSign[axis]        = (pid->dErrorCalc == D_ERROR) ? 1.0f : -1.0f;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-float updatePID(float command, float state, float deltaT, uint8_t iHold, struct PIDdata *PIDparameters)
+float updatePID(float command, float state, float deltaT, uint8_t iHold, uint8_t IDPid)
 {
+    const PIDdata_t *PIDparameters = &eepromConfig.PID[IDPid];
+
     float error;
     float dTerm;
     float dTermFiltered;
@@ -80,56 +127,111 @@ float updatePID(float command, float state, float deltaT, uint8_t iHold, struct
 
     if (iHold == false)
     {
-    	PIDparameters->iTerm += error * deltaT;
-    	PIDparameters->iTerm = constrain(PIDparameters->iTerm, -PIDparameters->windupGuard, PIDparameters->windupGuard);
+    	pidState.iTerm[IDPid] += error * deltaT;
+    	pidState.iTerm[IDPid] = constrain(pidState.iTerm[IDPid], -PIDparameters->windupGuard, PIDparameters->windupGuard);
     }
 
     ///////////////////////////////////
 
     if (PIDparameters->dErrorCalc == D_ERROR)  // Calculate D term from error
     {
-		dTerm = (error - PIDparameters->lastDcalcValue) / deltaT;
-        PIDparameters->lastDcalcValue = error;
+		dTerm = (error - pidState.lastDcalcValue[IDPid]) / deltaT;
+        pidState.lastDcalcValue[IDPid] = error;
 	}
 	else                                       // Calculate D term from state
 	{
-		dTerm = (PIDparameters->lastDcalcValue - state) / deltaT;
+		dTerm = (pidState.lastDcalcValue[IDPid] - state) / deltaT;
 
 		if (PIDparameters->type == ANGULAR)
 		    dTerm = standardRadianFormat(dTerm);
 
-		PIDparameters->lastDcalcValue = state;
+		pidState.lastDcalcValue[IDPid] = state;
 	}
 
     ///////////////////////////////////
 
-    dTermFiltered = PIDparameters->lastDterm + deltaT / (rc + deltaT) * (dTerm - PIDparameters->lastDterm);
+    dTermFiltered = pidState.lastDterm[IDPid] + deltaT / (rc + deltaT) * (dTerm - pidState.lastDterm[IDPid]);
 
-    dAverage = (dTermFiltered + PIDparameters->lastDterm + PIDparameters->lastLastDterm) * 0.333333f;
+    dAverage = (dTermFiltered + pidState.lastDterm[IDPid] + pidState.lastLastDterm[IDPid]) * 0.333333f;
 
-    PIDparameters->lastLastDterm = PIDparameters->lastDterm;
-    PIDparameters->lastDterm = dTermFiltered;
+    pidState.lastLastDterm[IDPid] = pidState.lastDterm[IDPid];
+    pidState.lastDterm[IDPid] = dTermFiltered;
 
     ///////////////////////////////////
 
     if (PIDparameters->type == ANGULAR)
-        return(PIDparameters->P * error                +
-	           PIDparameters->I * PIDparameters->iTerm +
+        return(PIDparameters->P * error                 +
+	           PIDparameters->I * pidState.iTerm[IDPid] +
 	           PIDparameters->D * dAverage);
     else
         return(PIDparameters->P * PIDparameters->B * command +
-               PIDparameters->I * PIDparameters->iTerm       +
+               PIDparameters->I * pidState.iTerm[IDPid]      +
                PIDparameters->D * dAverage                   -
                PIDparameters->P * state);
 
     ///////////////////////////////////
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Rate PIDs
+///////////////////////////////////////////////////////////////////////////////
+
+// updatePID() for one OTHER type rate loop axis, operation for operation,
+// with the gains and the D filter gain prepared ahead of time.
+
+static inline float updateRatePIDaxis(uint8_t axis, float command, float state, float deltaT, float dFilterGain, uint8_t iHold)
+{
+    float error;
+    float dTerm;
+    float dTermFiltered;
+    float dAverage;
+    float dCalcValue;
+
+    error = command - state;
+
+    if (iHold == false)
+    {
+        pidState.iTerm[axis] += error * deltaT;
+        pidState.iTerm[axis] = constrain(pidState.iTerm[axis], -rateGains.windupGuard[axis], rateGains.windupGuard[axis]);
+    }
+
+    dCalcValue = rateGains.dErrorWeight[axis] * error + rateGains.dStateWeight[axis] * state;
+
+    dTerm = rateGains.dSign[axis] * (dCalcValue - pidState.lastDcalcValue[axis]) / deltaT;
+
+    pidState.lastDcalcValue[axis] = dCalcValue;
+
+    dTermFiltered = pidState.lastDterm[axis] + dFilterGain * (dTerm - pidState.lastDterm[axis]);
+
+    dAverage = (dTermFiltered + pidState.lastDterm[axis] + pidState.lastLastDterm[axis]) * 0.333333f;
+
+    pidState.lastLastDterm[axis] = pidState.lastDterm[axis];
+    pidState.lastDterm[axis] = dTermFiltered;
+
+    return(rateGains.PB[axis] * command              +
+           rateGains.I[axis]  * pidState.iTerm[axis] +
+           rateGains.D[axis]  * dAverage             -
+           rateGains.P[axis]  * state);
+}
+
+///////////////////////////////////////
+
+// Roll, pitch and yaw rate loops in one call, state in body axis order
+
+void updateRatePIDs(const float command[3], const float state[3], float deltaT, uint8_t iHold, float output[3])
+{
+    float dFilterGain = deltaT / (rc + deltaT);
+
+    output[ROLL ] = updateRatePIDaxis(ROLL_RATE_PID,  command[ROLL ], state[ROLL ], deltaT, dFilterGain, iHold);
+    output[PITCH] = updateRatePIDaxis(PITCH_RATE_PID, command[PITCH], state[PITCH], deltaT, dFilterGain, iHold);
+    output[YAW  ] = updateRatePIDaxis(YAW_RATE_PID,   command[YAW  ], state[YAW  ], deltaT, dFilterGain, iHold);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void setPIDintegralError(uint8_t IDPid, float value)
 {
-	eepromConfig.PID[IDPid].iTerm = value;
+	pidState.iTerm[IDPid] = value;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -146,9 +248,9 @@ void zeroPIDintegralError(void)
 
 void setPIDstates(uint8_t IDPid, float value)
 {
-    eepromConfig.PID[IDPid].lastDcalcValue = value;
-    eepromConfig.PID[IDPid].lastDterm      = value;
-    eepromConfig.PID[IDPid].lastLastDterm  = value;
+    pidState.lastDcalcValue[IDPid] = value;
+    pidState.lastDterm[IDPid]      = value;
+    pidState.lastLastDterm[IDPid]  = value;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -162,5 +264,3 @@ void zeroPIDstates(void)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-
-
@@ -44,14 +44,10 @@
 #define D_ERROR true
 #define D_STATE false
 
-// PID Variables
+// PID Parameters, the runtime state is kept in pid.c
 typedef struct PIDdata {
   float   B, P, I, D;
-  float   iTerm;
   float   windupGuard;
-  float   lastDcalcValue;
-  float   lastDterm;
-  float   lastLastDterm;
   uint8_t dErrorCalc;
   uint8_t type;
 } PIDdata_t;
@@ -64,7 +60,15 @@ void initPID(void);
 
 ///////////////////////////////////////////////////////////////////////////////
 
-float updatePID(float command, float state, float deltaT, uint8_t iHold, struct PIDdata *PIDparameters);
+void loadRatePIDs(void);
+
+///////////////////////////////////////////////////////////////////////////////
+
+float updatePID(float command, float state, float deltaT, uint8_t iHold, uint8_t IDPid);
+
+///////////////////////////////////////////////////////////////////////////////
+
+void updateRatePIDs(const float command[3], const float state[3], float deltaT, uint8_t iHold, float output[3]);
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -0,0 +1,200 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+
+// Runs the rate PIDs, the mixer and the motor write from the gyro sample
+// interrupt, once per 1 kHz sample, so the motors see a gyro sample as
+// soon as it is read instead of after the next 500 Hz task.  The attitude
+// and heading loops stay in the 500 Hz task and pass the rate commands
+// down through a pair of setpoint buffers.  The task fills the one the
+// interrupt is not reading and then flips published, and the interrupt
+// runs to completion, so it never sees half a setpoint and neither side
+// waits on the other.
+//
+// The rate PID state and gains and the mixer matrix are still reset and
+// reloaded from the tasks and the CLI.  The interrupt may run between two
+// axes of a reset or a gain load, which costs one sample of mixed old and
+// new values, the same as a reset that lands one frame later.
+//
+// With rateLoopEnabled false none of this runs, the 500 Hz task does the
+// whole chain as before and only the latency is measured here.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Variables
+///////////////////////////////////////////////////////////////////////////////
+
+rateLoop_t rateLoop;
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Gyro Sample Rate
+//
+// The gyro filter chain and the dynamic notch are designed for the loop
+// that runs them.
+///////////////////////////////////////////////////////////////////////////////
+
+float rateLoopGyroRate(void)
+{
+    if (eepromConfig.rateLoopEnabled)
+        return RATE_LOOP_SAMPLE_RATE;
+    else
+        return 1000.0f / COUNT_500HZ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Initialization
+//
+// Call after the gyro filters are designed for rateLoopGyroRate().  The
+// first samples run on a zero, integrator held, setpoint until the 500 Hz
+// loop publishes one.
+///////////////////////////////////////////////////////////////////////////////
+
+void rateLoopInit(void)
+{
+    rateLoopStop();
+
+    memset(rateLoop.setpoint, 0, sizeof(rateLoop.setpoint));
+
+    rateLoop.setpoint[0].holdIntegrators = true;
+    rateLoop.setpoint[1].holdIntegrators = true;
+
+    rateLoop.published          = 0;
+    rateLoop.previousSampleTime = 0;
+
+    rateLoop.enabled = eepromConfig.rateLoopEnabled;
+
+    COMPILER_BARRIER();
+
+    rateLoop.running = rateLoop.enabled;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Stop
+//
+// The sample interrupt preempts the caller, so once running is clear it
+// is not partway through a pass, and the gyro filters may be rebuilt.
+// The motors hold their last command until rateLoopInit().
+///////////////////////////////////////////////////////////////////////////////
+
+void rateLoopStop(void)
+{
+    rateLoop.running = false;
+
+    COMPILER_BARRIER();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Setpoint
+///////////////////////////////////////////////////////////////////////////////
+
+void rateLoopSetpoint(const float rateCmd[3], uint8_t iHold)
+{
+    rateSetpoint_t *setpoint = &rateLoop.setpoint[rateLoop.published ^ 1];
+
+    setpoint->rateCmd[ROLL ]   = rateCmd[ROLL ];
+    setpoint->rateCmd[PITCH]   = rateCmd[PITCH];
+    setpoint->rateCmd[YAW  ]   = rateCmd[YAW  ];
+    setpoint->holdIntegrators = iHold;
+
+    COMPILER_BARRIER();
+
+    rateLoop.published ^= 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Update
+///////////////////////////////////////////////////////////////////////////////
+
+void rateLoopUpdate(const mpu6000Sample_t *sample)
+{
+    const rateSetpoint_t *setpoint;
+    float                rateState[3];
+    float                dt;
+    uint32_t             startTime;
+
+    if (rateLoop.running == false)
+        return;
+
+    if ((rateLoop.previousSampleTime != 0) &&
+        ((sample->time - rateLoop.previousSampleTime) < RATE_LOOP_MIN_INTERVAL))
+        return;
+
+    startTime = micros();
+
+    dt = timebaseSampleInterval(&rateLoop.previousSampleTime, sample->time, 1.0f / RATE_LOOP_SAMPLE_RATE);
+
+    // Same scaling and axis flips as scaleSensors500Hz(), one sample
+
+    rateLoop.gyro[ROLL ] =  ((float)sample->gyro[ROLL ] - gyroRTBias[ROLL ] - gyroTCBias[ROLL ]) * GYRO_SCALE_FACTOR;
+    rateLoop.gyro[PITCH] = -((float)sample->gyro[PITCH] - gyroRTBias[PITCH] - gyroTCBias[PITCH]) * GYRO_SCALE_FACTOR;
+    rateLoop.gyro[YAW  ] = -((float)sample->gyro[YAW  ] - gyroRTBias[YAW  ] - gyroTCBias[YAW  ]) * GYRO_SCALE_FACTOR;
+
+    dynamicNotchFilter(rateLoop.gyro);
+    filterChainUpdate(&filterChains[GYRO500HZ_FILTER], rateLoop.gyro, rateLoop.gyro);
+
+    rateState[ROLL ] =  rateLoop.gyro[ROLL ];
+    rateState[PITCH] = -rateLoop.gyro[PITCH];
+    rateState[YAW  ] =  rateLoop.gyro[YAW  ];
+
+    setpoint = &rateLoop.setpoint[rateLoop.published];
+
+    updateRatePIDs(setpoint->rateCmd, rateState, dt, setpoint->holdIntegrators, axisPID);
+
+    mixTable();
+    writeMotors();
+
+    motorLatencyUpdate(sample->time);
+
+    isrTimeUpdate(&rateLoop.executionTime, micros() - startTime);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Motor Latency Update
+//
+// Gyro sample time to the motor write that used it.  The ESC timers load
+// the new pulse width at their next period, which adds up to one PWM
+// period on top of this.
+///////////////////////////////////////////////////////////////////////////////
+
+void motorLatencyUpdate(uint64_t sampleTime)
+{
+    isrTimeUpdate(&rateLoop.latency, (uint32_t)(micros64() - sampleTime));
+}
+
+///////////////////////////////////////////////////////////////////////////////
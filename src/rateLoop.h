@@ -0,0 +1,115 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Defines
+///////////////////////////////////////////////////////////////////////////////
+
+#define RATE_LOOP_SAMPLE_RATE   1000.0f  // Hz, burst data ready and FIFO drain rate
+
+#define RATE_LOOP_MIN_INTERVAL  900      // uSec, skips the extra samples of an 8 kHz gyro
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct rateSetpoint_t
+{
+    float   rateCmd[3];
+    uint8_t holdIntegrators;
+} rateSetpoint_t;
+
+typedef struct rateLoop_t
+{
+    uint8_t          enabled;                                  // From eepromConfig, 500 Hz loop leaves the rate PIDs alone
+    volatile uint8_t running;                                  // Cleared while the CLI rebuilds the filters
+
+    rateSetpoint_t   setpoint[2];
+    volatile uint8_t published;                                // Setpoint the rate loop reads
+
+    float            gyro[3];                                  // rad/sec, filtered, body axes
+    uint64_t         previousSampleTime;
+
+    isrTime_t        executionTime;                            // uSec, whole rate loop
+    isrTime_t        latency;                                  // uSec, gyro sample to motor write, either loop
+} rateLoop_t;
+
+extern rateLoop_t rateLoop;
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Gyro Sample Rate
+///////////////////////////////////////////////////////////////////////////////
+
+float rateLoopGyroRate(void);
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void rateLoopInit(void);
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Stop, until the next rateLoopInit()
+///////////////////////////////////////////////////////////////////////////////
+
+void rateLoopStop(void);
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Setpoint, 500 Hz loop
+///////////////////////////////////////////////////////////////////////////////
+
+void rateLoopSetpoint(const float rateCmd[3], uint8_t iHold);
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate Loop Update, gyro sample interrupt
+///////////////////////////////////////////////////////////////////////////////
+
+void rateLoopUpdate(const mpu6000Sample_t *sample);
+
+///////////////////////////////////////////////////////////////////////////////
+// Motor Latency Update
+///////////////////////////////////////////////////////////////////////////////
+
+void motorLatencyUpdate(uint64_t sampleTime);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,213 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// RC setpoint smoothing between receiver frames.  processFlightCommands()
+// runs at 50 Hz and receivers send every 9 to 22 ms, so the attitude and
+// rate loops saw a stick command that jumped once per frame and held, and
+// the rate D term turned each jump into a spike.  Each new frame comes in
+// here with the time it was received, the frame interval is measured
+// from those times, and the loop reads a setpoint that moves between
+// frames:
+//
+//   RC_SMOOTHING_OFF          the frame as it came, held until the next
+//   RC_SMOOTHING_LINEAR       carried on along the slope of the last two
+//                             frames for up to one interval, no added
+//                             delay, it takes back half an interval, but
+//                             overshoots a stick that stops
+//   RC_SMOOTHING_FIRST_ORDER  the held frames through a lowpass with a
+//                             time constant of half a measured interval,
+//                             smooth, adds that much delay
+//
+// No hardware access in here, so the host build replays recorded and
+// generated RC streams through it.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "rcSmoothing.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// RC Smoothing Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void rcSmoothingInit(rcSmoothing_t *rc, uint8_t method)
+{
+    memset(rc, 0, sizeof(rcSmoothing_t));
+
+    rc->method   = (method < NUMBER_OF_RC_SMOOTHING_METHODS) ? method : RC_SMOOTHING_OFF;
+    rc->interval = RC_SMOOTHING_INTERVAL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// RC Smoothing Frame, a new frame of stick commands and its time
+///////////////////////////////////////////////////////////////////////////////
+
+void rcSmoothingFrame(rcSmoothing_t *rc, const float command[3], uint64_t frameTime)
+{
+    float   interval;
+    uint8_t axis;
+
+    interval = (float)(frameTime - rc->frameTime) * 0.000001f;
+
+    // A 12 channel Spektrum sends two frames back to back, the second is
+    // the same instant as far as the sticks go
+
+    if ((rc->frames > 0) && (interval < RC_SMOOTHING_MIN_INTERVAL))
+    {
+        for (axis = 0; axis < 3; axis++)
+            rc->sample[axis] = command[axis];
+
+        return;
+    }
+
+    if ((rc->frames > 0) && (interval <= RC_SMOOTHING_MAX_INTERVAL))
+    {
+        if (rc->intervals == 0)
+            rc->interval = interval;
+        else
+            rc->interval += RC_SMOOTHING_AVERAGE * (interval - rc->interval);
+
+        rc->intervals++;
+
+        for (axis = 0; axis < 3; axis++)
+            rc->slope[axis] = (command[axis] - rc->sample[axis]) / interval;
+
+        rc->frames = 2;
+    }
+    else
+    {
+        // First frame or the first after a gap, nothing to carry on from
+
+        for (axis = 0; axis < 3; axis++)
+            rc->slope[axis] = 0.0f;
+
+        rc->frames = 1;
+    }
+
+    for (axis = 0; axis < 3; axis++)
+        rc->sample[axis] = command[axis];
+
+    rc->frameTime = frameTime;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// RC Smoothing Update, the setpoint at loop time
+///////////////////////////////////////////////////////////////////////////////
+
+void rcSmoothingUpdate(rcSmoothing_t *rc, uint64_t time, float setpoint[3])
+{
+    float   since, dt, alpha, value;
+    uint8_t axis;
+
+    switch (rc->method)
+    {
+        case RC_SMOOTHING_LINEAR:
+            since = (time > rc->frameTime) ? (float)(time - rc->frameTime) * 0.000001f : 0.0f;
+
+            if (since > rc->interval)
+                since = rc->interval;  // Lost frames hold the last extrapolation
+
+            for (axis = 0; axis < 3; axis++)
+            {
+                value = rc->sample[axis] + rc->slope[axis] * since;
+
+                // Never out through the centre detent, a stick let go stops there
+
+                if ((value * rc->sample[axis]) <= 0.0f)
+                    value = 0.0f;
+
+                if (value > RC_SMOOTHING_LIMIT)
+                    value = RC_SMOOTHING_LIMIT;
+                else if (value < -RC_SMOOTHING_LIMIT)
+                    value = -RC_SMOOTHING_LIMIT;
+
+                rc->setpoint[axis] = value;
+            }
+            break;
+
+        case RC_SMOOTHING_FIRST_ORDER:
+            if (rc->updateTime == 0)
+            {
+                for (axis = 0; axis < 3; axis++)
+                    rc->setpoint[axis] = rc->sample[axis];
+
+                break;
+            }
+
+            dt    = (time > rc->updateTime) ? (float)(time - rc->updateTime) * 0.000001f : 0.0f;
+            alpha = dt / (RC_SMOOTHING_TAU * rc->interval + dt);
+
+            for (axis = 0; axis < 3; axis++)
+                rc->setpoint[axis] += alpha * (rc->sample[axis] - rc->setpoint[axis]);
+            break;
+
+        default:
+            for (axis = 0; axis < 3; axis++)
+                rc->setpoint[axis] = rc->sample[axis];
+            break;
+    }
+
+    rc->updateTime = time;
+
+    for (axis = 0; axis < 3; axis++)
+        setpoint[axis] = rc->setpoint[axis];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// RC Smoothing Latency, seconds added to the frame staircase, negative is a lead
+///////////////////////////////////////////////////////////////////////////////
+
+// For a steady stick movement.  The staircase itself trails the stick by
+// half an interval on average, linear extrapolation gives that back and
+// the lowpass adds its time constant.
+
+float rcSmoothingLatency(const rcSmoothing_t *rc)
+{
+    switch (rc->method)
+    {
+        case RC_SMOOTHING_LINEAR:
+            return -0.5f * rc->interval;
+
+        case RC_SMOOTHING_FIRST_ORDER:
+            return RC_SMOOTHING_TAU * rc->interval;
+
+        default:
+            return 0.0f;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,105 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// RC Smoothing Defines
+///////////////////////////////////////////////////////////////////////////////
+
+enum { RC_SMOOTHING_OFF,           // Each frame held until the next, the old staircase
+       RC_SMOOTHING_LINEAR,        // Extrapolated along the last two frames for one interval
+       RC_SMOOTHING_FIRST_ORDER,   // Staircase through a first order lowpass
+       NUMBER_OF_RC_SMOOTHING_METHODS
+     };
+
+#define RC_SMOOTHING_INTERVAL      0.02f   // Seconds, assumed until two frames are in
+#define RC_SMOOTHING_MIN_INTERVAL  0.002f  // Seconds, shorter gaps are split frames, not a new interval
+#define RC_SMOOTHING_MAX_INTERVAL  0.1f    // Seconds, longer gaps are lost frames
+#define RC_SMOOTHING_AVERAGE       0.1f    // Per frame interval update, about 10 frame time constant
+
+#define RC_SMOOTHING_TAU           0.5f    // First order time constant, frame intervals
+
+#define RC_SMOOTHING_LIMIT         1000.0f // Stick command range, +/-
+
+///////////////////////////////////////////////////////////////////////////////
+// RC Smoothing Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct rcSmoothing_t
+{
+    uint8_t  method;
+    uint8_t  frames;                       // Since the last gap, counts to 2, a slope needs two
+    uint32_t intervals;                    // Frame intervals measured
+
+    uint64_t frameTime;                    // uSec, last frame
+    uint64_t updateTime;                   // uSec, last setpoint
+    float    interval;                     // Seconds, averaged frame interval
+
+    float    sample[3];                    // Last frame, roll, pitch, yaw
+    float    slope[3];                     // Per second, last two frames
+    float    setpoint[3];
+} rcSmoothing_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// RC Smoothing Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void rcSmoothingInit(rcSmoothing_t *rc, uint8_t method);
+
+///////////////////////////////////////////////////////////////////////////////
+// RC Smoothing Frame, a new frame of stick commands and its time
+///////////////////////////////////////////////////////////////////////////////
+
+void rcSmoothingFrame(rcSmoothing_t *rc, const float command[3], uint64_t frameTime);
+
+///////////////////////////////////////////////////////////////////////////////
+// RC Smoothing Update, the setpoint at loop time
+///////////////////////////////////////////////////////////////////////////////
+
+void rcSmoothingUpdate(rcSmoothing_t *rc, uint64_t time, float setpoint[3]);
+
+///////////////////////////////////////////////////////////////////////////////
+// RC Smoothing Latency, seconds added to the frame staircase, negative is a lead
+///////////////////////////////////////////////////////////////////////////////
+
+float rcSmoothingLatency(const rcSmoothing_t *rc);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -87,11 +87,12 @@ void readRFPID(unsigned char PIDid)
   pid->I              = readFloatRF();
   pid->D              = readFloatRF();
   pid->windupGuard    = readFloatRF();
-  pid->iTerm          = 0.0f;
-  pid->lastDcalcValue = 0.0f;
-  pid->lastDterm      = 0.0f;
-  pid->lastLastDterm  = 0.0f;
   pid->dErrorCalc     = (uint8_t)readFloatRF();
+
+  setPIDintegralError(PIDid, 0.0f);
+  setPIDstates(PIDid, 0.0f);
+
+  loadRatePIDs();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -221,8 +222,7 @@ void rfCom(void)
         ///////////////////////////////
 
         case '1': // Turn high speed telemetry 1 on
-        	highSpeedTelemDisable();
-          	highSpeedTelem1Enabled = true;
+        	highSpeedTelemEnable(1, true);
 
         	rfQueryType = 'x';
             break;
@@ -230,8 +230,7 @@ void rfCom(void)
         ///////////////////////////////
 
         case '2': // Turn high speed telemetry 2 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem2Enabled = true;
+           	highSpeedTelemEnable(2, true);
 
             rfQueryType = 'x';
            	break;
@@ -239,8 +238,7 @@ void rfCom(void)
         ///////////////////////////////
 
         case '3': // Turn high speed telemetry 3 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem3Enabled = true;
+           	highSpeedTelemEnable(3, true);
 
             rfQueryType = 'x';
            	break;
@@ -248,8 +246,7 @@ void rfCom(void)
         ///////////////////////////////
 
         case '4': // Turn high speed telemetry 4 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem4Enabled = true;
+           	highSpeedTelemEnable(4, true);
 
             rfQueryType = 'x';
            	break;
@@ -257,8 +254,7 @@ void rfCom(void)
         ///////////////////////////////
 
         case '5': // Turn high speed telemetry 5 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem5Enabled = true;
+           	highSpeedTelemEnable(5, true);
 
             rfQueryType = 'x';
            	break;
@@ -266,8 +262,7 @@ void rfCom(void)
         ///////////////////////////////
 
         case '6': // Turn high speed telemetry 6 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem6Enabled = true;
+           	highSpeedTelemEnable(6, true);
 
             rfQueryType = 'x';
            	break;
@@ -275,8 +270,7 @@ void rfCom(void)
         ///////////////////////////////
 
         case '7': // Turn high speed telemetry 7 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem7Enabled = true;
+           	highSpeedTelemEnable(7, true);
 
             rfQueryType = 'x';
            	break;
@@ -284,8 +278,7 @@ void rfCom(void)
         ///////////////////////////////
 
         case '8': // Turn high speed telemetry 8 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem8Enabled = true;
+           	highSpeedTelemEnable(8, true);
 
             rfQueryType = 'x';
            	break;
@@ -293,8 +286,7 @@ void rfCom(void)
         ///////////////////////////////
 
         case '9': // Turn high speed telemetry 9 on
-           	highSpeedTelemDisable();
-           	highSpeedTelem9Enabled = true;
+           	highSpeedTelemEnable(9, true);
 
             rfQueryType = 'x';
            	break;
@@ -0,0 +1,282 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+///////////////////////////////////////////////////////////////////////////////
+
+// Frame handling for the serial receivers in drv_rx.c.  The driver only
+// collects bytes into a ring and marks where each frame ended, the USART
+// idle line between frames does the framing.  Everything from there on is
+// in here with no hardware access, so the host build can check it and
+// time it against recorded and generated byte streams.
+//
+// The SBUS, SUMD and IBUS decoders return every channel of the frame in
+// the 0.5 uSec command counts rxRead() hands out, with the receiver's
+// failsafe and lost frame flags in status.  Each returns the number of
+// channels decoded, 0 for a frame that fails its checks.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "rxFrame.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Receive Ring Frame Extract
+///////////////////////////////////////////////////////////////////////////////
+
+// Copies the bytes from start up to end, both ring indices, out of the
+// ring into frame.  Returns the frame length, 0 for an empty or over long
+// frame, which is left where it is.
+
+uint16_t rxFrameExtract(const uint8_t *ring, uint16_t ringSize, uint16_t start, uint16_t end, uint8_t *frame)
+{
+    uint16_t length, first;
+
+    length = (end >= start) ? (uint16_t)(end - start) : (uint16_t)(ringSize - start + end);
+
+    if ((length == 0) || (length > RX_FRAME_MAX_SIZE))
+        return 0;
+
+    first = (uint16_t)(ringSize - start);
+
+    if (length <= first)
+    {
+        memcpy(frame, &ring[start], length);
+    }
+    else
+    {
+        memcpy(frame,         &ring[start], first);
+        memcpy(&frame[first], ring,         length - first);
+    }
+
+    return length;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Spektrum Frame Decode
+///////////////////////////////////////////////////////////////////////////////
+
+// A satellite frame is a fades byte, a system byte and seven big endian
+// channel words.  Each word is the channel number over a 10 or 11 bit
+// position, 0xFFFF marks an unused slot.  12 channel systems send their
+// channels over two frames, so only the channels carried are written.
+// Spektrum has no checksum, the frame length is all there is to check.
+// Returns the number of channels written, 0 for a rejected frame.
+
+uint8_t spektrumFrameDecode(const uint8_t *frame, uint16_t length, uint8_t hires, uint8_t channels, uint16_t *channelData)
+{
+    uint8_t  b, channel, shift, written = 0;
+    uint16_t mask;
+
+    if (length != SPEKTRUM_FRAME_SIZE)
+        return 0;
+
+    if (channels > SPEKTRUM_MAX_CHANNEL)
+        channels = SPEKTRUM_MAX_CHANNEL;
+
+    shift = hires ? 11 : 10;
+    mask  = (uint16_t)((1 << shift) - 1);
+
+    for (b = 2; b < SPEKTRUM_FRAME_SIZE; b += 2)
+    {
+        uint16_t word = (uint16_t)((frame[b] << 8) | frame[b + 1]);
+
+        if (word == SPEKTRUM_UNUSED)
+            continue;
+
+        channel = (uint8_t)((word >> shift) & 0x0F);
+
+        if (channel < channels)
+        {
+            channelData[channel] = word & mask;
+            written++;
+        }
+    }
+
+    return written;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Spektrum Command
+///////////////////////////////////////////////////////////////////////////////
+
+// Position to 0.5 uSec command counts, 2048 mode counts are already
+// 0.5 uSec, 1024 mode counts are twice that
+
+uint16_t spektrumCommand(uint16_t value, uint8_t hires)
+{
+    if (hires)
+        return (uint16_t)(1000 + value);
+    else
+        return (uint16_t)((1000 + value) << 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SBUS Frame Decode
+///////////////////////////////////////////////////////////////////////////////
+
+// 16 channels of 11 bits packed LSB first, then a flags byte.  Each byte
+// carries even parity, checked by the USART, so here it is only the
+// length, the header and the footer, 0x00 or an SBUS2 slot marker.
+// 172 to 1811 is 988 to 2012 uSec, the two digital channels are not used.
+
+uint8_t sbusFrameDecode(const uint8_t *frame, uint16_t length, uint16_t *channelData, uint8_t *status)
+{
+    uint32_t bits = 0;
+    uint8_t  bitCount = 0, b = 1, channel;
+
+    if ((length != SBUS_FRAME_SIZE) || (frame[0] != SBUS_HEADER))
+        return 0;
+
+    if ((frame[24] != 0x00) && ((frame[24] & 0x0F) != 0x04))
+        return 0;
+
+    for (channel = 0; channel < SBUS_CHANNELS; channel++)
+    {
+        while (bitCount < 11)
+        {
+            bits     |= (uint32_t)frame[b++] << bitCount;
+            bitCount += 8;
+        }
+
+        channelData[channel] = (uint16_t)((5 * (bits & 0x7FF) + 7044) / 4);
+
+        bits    >>= 11;
+        bitCount -= 11;
+    }
+
+    *status = 0;
+
+    if (frame[23] & 0x08)
+        *status |= RX_FRAME_FAILSAFE;
+
+    if (frame[23] & 0x04)
+        *status |= RX_FRAME_LOST;
+
+    return SBUS_CHANNELS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SUMD Frame Decode
+///////////////////////////////////////////////////////////////////////////////
+
+// CRC16 CCITT, polynomial 0x1021 from 0, over everything before the CRC
+
+uint16_t sumdCrc(const uint8_t *data, uint16_t length)
+{
+    uint16_t crc = 0, i;
+    uint8_t  bit;
+
+    for (i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)(data[i] << 8);
+
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+
+    return crc;
+}
+
+///////////////////////////////////////
+
+// Header, status, channel count, big endian channels in 1/8 uSec, 12000
+// for 1500 uSec, then the CRC high byte first.  Channels past
+// RX_MAX_CHANNELS are checked but not returned.
+
+uint8_t sumdFrameDecode(const uint8_t *frame, uint16_t length, uint16_t *channelData, uint8_t *status)
+{
+    uint8_t  channels, channel;
+    uint16_t value;
+
+    if ((length < 3) || (frame[0] != SUMD_HEADER))
+        return 0;
+
+    if ((frame[1] != SUMD_STATUS_LIVE) && (frame[1] != SUMD_STATUS_FAILSAFE))
+        return 0;
+
+    channels = frame[2];
+
+    if ((channels == 0) || (channels > SUMD_MAX_CHANNELS) || (length != 5 + 2 * channels))
+        return 0;
+
+    if (sumdCrc(frame, (uint16_t)(length - 2)) != ((frame[length - 2] << 8) | frame[length - 1]))
+        return 0;
+
+    if (channels > RX_MAX_CHANNELS)
+        channels = RX_MAX_CHANNELS;
+
+    for (channel = 0; channel < channels; channel++)
+    {
+        value = (uint16_t)((frame[3 + 2 * channel] << 8) | frame[4 + 2 * channel]);
+
+        channelData[channel] = (uint16_t)((value + 2) / 4);
+    }
+
+    *status = (frame[1] == SUMD_STATUS_FAILSAFE) ? RX_FRAME_FAILSAFE : 0;
+
+    return channels;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// IBUS Frame Decode
+///////////////////////////////////////////////////////////////////////////////
+
+// Frame length, command, 14 little endian channels in uSec, then 0xFFFF
+// less the sum of every byte before it.  The top nibbles that carry
+// channels 15 to 18 on some receivers are not used.  IBUS has no
+// failsafe flag, receivers send their failsafe values or go quiet.
+
+uint8_t ibusFrameDecode(const uint8_t *frame, uint16_t length, uint16_t *channelData, uint8_t *status)
+{
+    uint16_t sum = 0xFFFF;
+    uint8_t  b, channel;
+
+    if ((length != IBUS_FRAME_SIZE) || (frame[0] != IBUS_FRAME_SIZE) || (frame[1] != IBUS_COMMAND))
+        return 0;
+
+    for (b = 0; b < IBUS_FRAME_SIZE - 2; b++)
+        sum = (uint16_t)(sum - frame[b]);
+
+    if (sum != ((frame[31] << 8) | frame[30]))
+        return 0;
+
+    for (channel = 0; channel < IBUS_CHANNELS; channel++)
+        channelData[channel] = (uint16_t)((((frame[3 + 2 * channel] & 0x0F) << 8) | frame[2 + 2 * channel]) << 1);
+
+    *status = 0;
+
+    return IBUS_CHANNELS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
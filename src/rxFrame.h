@@ -0,0 +1,107 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Serial Receiver Frame Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define RX_MAX_CHANNELS        16      // Channel array size for every serial receiver
+#define RX_FRAME_MAX_SIZE      80      // Longest frame taken out of the receive ring
+
+#define RX_FRAME_FAILSAFE    0x01      // Receiver has no link, the channels are its failsafe values
+#define RX_FRAME_LOST        0x02      // Receiver missed a frame and repeated the last one
+
+#define SPEKTRUM_MAX_CHANNEL   12
+#define SPEKTRUM_FRAME_SIZE    16      // Fades, system, then 7 channel words
+#define SPEKTRUM_UNUSED    0xFFFF      // Empty channel word
+
+#define SBUS_FRAME_SIZE        25      // Header, 16 11 bit channels, flags, footer
+#define SBUS_HEADER          0x0F
+#define SBUS_CHANNELS          16
+
+#define SUMD_HEADER          0xA8
+#define SUMD_STATUS_LIVE     0x01
+#define SUMD_STATUS_FAILSAFE 0x81
+#define SUMD_MAX_CHANNELS      32      // Header, status, count, 2 bytes each, CRC16
+
+#define IBUS_FRAME_SIZE        32      // Length, command, 14 channels, checksum
+#define IBUS_COMMAND         0x40
+#define IBUS_CHANNELS          14
+
+///////////////////////////////////////////////////////////////////////////////
+// Receive Ring Frame Extract
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t rxFrameExtract(const uint8_t *ring, uint16_t ringSize, uint16_t start, uint16_t end, uint8_t *frame);
+
+///////////////////////////////////////////////////////////////////////////////
+// Spektrum Frame Decode
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t spektrumFrameDecode(const uint8_t *frame, uint16_t length, uint8_t hires, uint8_t channels, uint16_t *channelData);
+
+///////////////////////////////////////////////////////////////////////////////
+// Spektrum Command
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t spektrumCommand(uint16_t value, uint8_t hires);
+
+///////////////////////////////////////////////////////////////////////////////
+// SBUS Frame Decode
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t sbusFrameDecode(const uint8_t *frame, uint16_t length, uint16_t *channelData, uint8_t *status);
+
+///////////////////////////////////////////////////////////////////////////////
+// SUMD Frame Decode
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t sumdCrc(const uint8_t *data, uint16_t length);
+
+uint8_t sumdFrameDecode(const uint8_t *frame, uint16_t length, uint16_t *channelData, uint8_t *status);
+
+///////////////////////////////////////////////////////////////////////////////
+// IBUS Frame Decode
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t ibusFrameDecode(const uint8_t *frame, uint16_t length, uint16_t *channelData, uint8_t *status);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,229 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+// The dispatcher only depends on the task table and the time source handed
+// to schedulerInit(), so it compiles natively for checking its accounting
+// against a simulated tick.
+
+#include <stddef.h>
+#include <string.h>
+
+#include "scheduler.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+task_t  *schedulerTasks         = NULL;
+uint8_t  schedulerNumberOfTasks = 0;
+
+uint8_t  schedulerMaxBacklog    = 0;
+
+static uint32_t (*schedulerTime)(void) = NULL;
+
+///////////////////////////////////////////////////////////////////////////////
+// Histogram Bin
+///////////////////////////////////////////////////////////////////////////////
+
+static uint8_t histogramBin(uint32_t value)
+{
+    uint8_t bin = 0;
+
+    value >>= SCHEDULER_HISTOGRAM_SHIFT;
+
+    while ((value != 0) && (bin < (SCHEDULER_HISTOGRAM_BINS - 1)))
+    {
+        value >>= 1;
+        bin++;
+    }
+
+    return bin;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scheduler Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void schedulerInit(task_t *taskTable, uint8_t numberOfTasks, uint32_t (*timeSource)(void))
+{
+    uint8_t index;
+
+    schedulerTasks         = taskTable;
+    schedulerNumberOfTasks = numberOfTasks;
+    schedulerTime          = timeSource;
+
+    for (index = 0; index < schedulerNumberOfTasks; index++)
+        schedulerTasks[index].pending = false;
+
+    schedulerResetStats();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scheduler Tick
+///////////////////////////////////////////////////////////////////////////////
+
+void schedulerTick(uint16_t frame, uint32_t currentTime)
+{
+    uint8_t index;
+    task_t  *task;
+
+    for (index = 0; index < schedulerNumberOfTasks; index++)
+    {
+        task = &schedulerTasks[index];
+
+        if ((frame % task->period) == 0)
+        {
+            if (task->pending)
+            {
+                task->stats.skippedCount++;
+            }
+            else
+            {
+                task->releaseTime = currentTime;
+                task->pending     = true;
+            }
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scheduler Run
+///////////////////////////////////////////////////////////////////////////////
+
+bool schedulerRun(void)
+{
+    uint8_t  index;
+    uint8_t  backlog = 0;
+    uint32_t releaseTime, startTime, executionTime, jitter;
+    task_t   *task = NULL;
+
+    for (index = 0; index < schedulerNumberOfTasks; index++)
+    {
+        if (schedulerTasks[index].pending)
+        {
+            backlog++;
+
+            if ((task == NULL) || (schedulerTasks[index].priority < task->priority))
+                task = &schedulerTasks[index];
+        }
+    }
+
+    if (task == NULL)
+        return false;
+
+    if (backlog > schedulerMaxBacklog)
+        schedulerMaxBacklog = backlog;
+
+    ///////////////////////////////////
+
+    releaseTime   = task->releaseTime;
+    task->pending = false;
+
+    startTime = schedulerTime();
+
+    task->function();
+
+    executionTime = schedulerTime() - startTime;
+    jitter        = startTime - releaseTime;
+
+    ///////////////////////////////////
+
+    task->stats.runCount++;
+
+    if (executionTime > task->budget)
+        task->stats.overrunCount++;
+
+    if (executionTime < task->stats.executionMin)
+        task->stats.executionMin = executionTime;
+
+    if (executionTime > task->stats.executionMax)
+        task->stats.executionMax = executionTime;
+
+    task->stats.executionSum += executionTime;
+
+    if (jitter < task->stats.jitterMin)
+        task->stats.jitterMin = jitter;
+
+    if (jitter > task->stats.jitterMax)
+        task->stats.jitterMax = jitter;
+
+    task->stats.jitterSum += jitter;
+
+    task->stats.executionHistogram[histogramBin(executionTime)]++;
+    task->stats.jitterHistogram[histogramBin(jitter)]++;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scheduler Statistics
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t schedulerExecutionMean(task_t *task)
+{
+    if (task->stats.runCount == 0)
+        return 0;
+
+    return (uint32_t)(task->stats.executionSum / task->stats.runCount);
+}
+
+///////////////////////////////////////
+
+uint32_t schedulerJitterMean(task_t *task)
+{
+    if (task->stats.runCount == 0)
+        return 0;
+
+    return (uint32_t)(task->stats.jitterSum / task->stats.runCount);
+}
+
+///////////////////////////////////////
+
+void schedulerResetStats(void)
+{
+    uint8_t index;
+
+    for (index = 0; index < schedulerNumberOfTasks; index++)
+    {
+        memset(&schedulerTasks[index].stats, 0, sizeof(taskStats_t));
+
+        schedulerTasks[index].stats.executionMin = UINT32_MAX;
+        schedulerTasks[index].stats.jitterMin    = UINT32_MAX;
+    }
+
+    schedulerMaxBacklog = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,122 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Task Scheduler Defines
+///////////////////////////////////////////////////////////////////////////////
+
+#define SCHEDULER_HISTOGRAM_BINS   8
+
+#define SCHEDULER_HISTOGRAM_SHIFT  4   // First bin is 0 to 15 uSec, each following bin doubles
+
+///////////////////////////////////////////////////////////////////////////////
+// Task Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct taskStats_t
+{
+    uint32_t runCount;
+    uint32_t overrunCount;             // Executions longer than the task budget
+    uint32_t skippedCount;             // Activations lost because the previous one had not started
+
+    uint32_t executionMin;
+    uint32_t executionMax;
+    uint64_t executionSum;
+
+    uint32_t jitterMin;                // Release to start latency
+    uint32_t jitterMax;
+    uint64_t jitterSum;
+
+    uint32_t executionHistogram[SCHEDULER_HISTOGRAM_BINS];
+    uint32_t jitterHistogram[SCHEDULER_HISTOGRAM_BINS];
+} taskStats_t;
+
+typedef struct task_t
+{
+    const char *name;
+    uint16_t    period;                // Number of 1000 Hz frames between activations
+    uint8_t     priority;              // 0 = highest, rate monotonic tables use shortest period first
+    uint32_t    budget;                // uSec
+    void        (*function)(void);
+
+    volatile uint8_t  pending;
+    volatile uint32_t releaseTime;
+
+    taskStats_t stats;
+} task_t;
+
+extern task_t  *schedulerTasks;
+extern uint8_t  schedulerNumberOfTasks;
+
+extern uint8_t  schedulerMaxBacklog;
+
+///////////////////////////////////////////////////////////////////////////////
+// Scheduler Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void schedulerInit(task_t *taskTable, uint8_t numberOfTasks, uint32_t (*timeSource)(void));
+
+///////////////////////////////////////////////////////////////////////////////
+// Scheduler Tick, called from the 1000 Hz frame
+///////////////////////////////////////////////////////////////////////////////
+
+void schedulerTick(uint16_t frame, uint32_t currentTime);
+
+///////////////////////////////////////////////////////////////////////////////
+// Scheduler Run, dispatches the highest priority pending task
+///////////////////////////////////////////////////////////////////////////////
+
+bool schedulerRun(void);
+
+///////////////////////////////////////////////////////////////////////////////
+// Scheduler Statistics
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t schedulerExecutionMean(task_t *task);
+
+uint32_t schedulerJitterMean(task_t *task);
+
+void schedulerResetStats(void);
+
+///////////////////////////////////////////////////////////////////////////////
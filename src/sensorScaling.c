@@ -0,0 +1,137 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Scale 500 Hz Sensors
+///////////////////////////////////////////////////////////////////////////////
+
+// Converts the summed raw samples handed off by the 1 kHz frame into
+// sensor axes and SI units.  Kept out of main.c so the host builds run the
+// same conversion the board does.  dt is the time the handed off samples
+// span, it sets the sample period the delta angle is integrated over.
+
+void scaleSensors500Hz(float dt)
+{
+    float bias[3], deltaAngle[3];
+
+    if (mpu6000Summed500Hz.samples == 0)  // Nothing handed off, keep the last values
+        return;
+
+    sensors.accel500Hz[XAXIS] =  ((float)mpu6000Summed500Hz.accel[XAXIS] / mpu6000Summed500Hz.samples - accelTCBias[XAXIS]) * ACCEL_SCALE_FACTOR;
+    sensors.accel500Hz[YAXIS] = -((float)mpu6000Summed500Hz.accel[YAXIS] / mpu6000Summed500Hz.samples - accelTCBias[YAXIS]) * ACCEL_SCALE_FACTOR;
+    sensors.accel500Hz[ZAXIS] = -((float)mpu6000Summed500Hz.accel[ZAXIS] / mpu6000Summed500Hz.samples - accelTCBias[ZAXIS]) * ACCEL_SCALE_FACTOR;
+
+    sensors.accel500HzMXR[XAXIS] = -(accelSummedSamples500HzMXR[XAXIS] / 2.0f - eepromConfig.accelBiasMXR[XAXIS]) * eepromConfig.accelScaleFactorMXR[XAXIS];
+    sensors.accel500HzMXR[YAXIS] = -(accelSummedSamples500HzMXR[YAXIS] / 2.0f - eepromConfig.accelBiasMXR[YAXIS]) * eepromConfig.accelScaleFactorMXR[YAXIS];
+    sensors.accel500HzMXR[ZAXIS] =  (accelSummedSamples500HzMXR[ZAXIS] / 2.0f - eepromConfig.accelBiasMXR[ZAXIS]) * eepromConfig.accelScaleFactorMXR[ZAXIS];
+    /*
+    sensors.accel500Hz[XAXIS] =  ((float)mpu6000Summed500Hz.accel[XAXIS] / mpu6000Summed500Hz.samples  +
+                                  eepromConfig.accelBiasP0[XAXIS]               +
+                                  eepromConfig.accelBiasP1[XAXIS] * sensorTemp1 +
+                                  eepromConfig.accelBiasP2[XAXIS] * sensorTemp2 +
+                                  eepromConfig.accelBiasP3[XAXIS] * sensorTemp3 ) * ACCEL_SCALE_FACTOR;
+
+    sensors.accel500Hz[YAXIS] = -((float)mpu6000Summed500Hz.accel[YAXIS] / mpu6000Summed500Hz.samples  +
+                                  eepromConfig.accelBiasP0[YAXIS]               +
+                                  eepromConfig.accelBiasP1[YAXIS] * sensorTemp1 +
+                                  eepromConfig.accelBiasP2[YAXIS] * sensorTemp2 +
+                                  eepromConfig.accelBiasP3[YAXIS] * sensorTemp3 ) * ACCEL_SCALE_FACTOR;
+
+    sensors.accel500Hz[ZAXIS] = -((float)mpu6000Summed500Hz.accel[ZAXIS] / mpu6000Summed500Hz.samples  +
+                                  eepromConfig.accelBiasP0[ZAXIS]               +
+                                  eepromConfig.accelBiasP1[ZAXIS] * sensorTemp1 +
+                                  eepromConfig.accelBiasP2[ZAXIS] * sensorTemp2 +
+                                  eepromConfig.accelBiasP3[ZAXIS] * sensorTemp3 ) * ACCEL_SCALE_FACTOR;
+    */
+    sensors.gyro500Hz[ROLL ] =  ((float)mpu6000Summed500Hz.gyro[ROLL ] / mpu6000Summed500Hz.samples - gyroRTBias[ROLL ] - gyroTCBias[ROLL ]) * GYRO_SCALE_FACTOR;
+    sensors.gyro500Hz[PITCH] = -((float)mpu6000Summed500Hz.gyro[PITCH] / mpu6000Summed500Hz.samples - gyroRTBias[PITCH] - gyroTCBias[PITCH]) * GYRO_SCALE_FACTOR;
+    sensors.gyro500Hz[YAW  ] = -((float)mpu6000Summed500Hz.gyro[YAW  ] / mpu6000Summed500Hz.samples - gyroRTBias[YAW  ] - gyroTCBias[YAW  ]) * GYRO_SCALE_FACTOR;
+
+    // The axis flips are a rotation, so the coning terms may be worked in
+    // sensor axes and flipped afterwards like the rates
+
+    bias[ROLL ] = gyroRTBias[ROLL ] + gyroTCBias[ROLL ];
+    bias[PITCH] = gyroRTBias[PITCH] + gyroTCBias[PITCH];
+    bias[YAW  ] = gyroRTBias[YAW  ] + gyroTCBias[YAW  ];
+
+    mpu6000DeltaAngle(&mpu6000Summed500Hz, bias, GYRO_SCALE_FACTOR * dt / mpu6000Summed500Hz.samples, deltaAngle);
+
+    sensors.deltaAngle500Hz[ROLL ] =  deltaAngle[ROLL ];
+    sensors.deltaAngle500Hz[PITCH] = -deltaAngle[PITCH];
+    sensors.deltaAngle500Hz[YAW  ] = -deltaAngle[YAW  ];
+
+    /*
+    sensors.gyro500Hz[ROLL ] =  ((float)mpu6000Summed500Hz.gyro[ROLL ] / mpu6000Summed500Hz.samples  +
+                                 gyroBiasP0[ROLL ]                            +
+                                 eepromConfig.gyroBiasP1[ROLL ] * sensorTemp1 +
+                                 eepromConfig.gyroBiasP2[ROLL ] * sensorTemp2 +
+                                 eepromConfig.gyroBiasP3[ROLL ] * sensorTemp3 ) * GYRO_SCALE_FACTOR;
+
+    sensors.gyro500Hz[PITCH] = -((float)mpu6000Summed500Hz.gyro[PITCH] / mpu6000Summed500Hz.samples  +
+                                 gyroBiasP0[PITCH]                            +
+                                 eepromConfig.gyroBiasP1[PITCH] * sensorTemp1 +
+                                 eepromConfig.gyroBiasP2[PITCH] * sensorTemp2 +
+                                 eepromConfig.gyroBiasP3[PITCH] * sensorTemp3 ) * GYRO_SCALE_FACTOR;
+
+    sensors.gyro500Hz[YAW  ] = -((float)mpu6000Summed500Hz.gyro[YAW  ] / mpu6000Summed500Hz.samples  +
+                                 gyroBiasP0[YAW  ]                            +
+                                 eepromConfig.gyroBiasP1[YAW  ] * sensorTemp1 +
+                                 eepromConfig.gyroBiasP2[YAW  ] * sensorTemp2 +
+                                 eepromConfig.gyroBiasP3[YAW  ] * sensorTemp3 ) * GYRO_SCALE_FACTOR;
+    */
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scale 100 Hz Sensors
+///////////////////////////////////////////////////////////////////////////////
+
+void scaleSensors100Hz(void)
+{
+    if (mpu6000Summed100Hz.samples == 0)
+        return;
+
+    sensors.accel100Hz[XAXIS] =  ((float)mpu6000Summed100Hz.accel[XAXIS] / mpu6000Summed100Hz.samples - accelTCBias[XAXIS]) * ACCEL_SCALE_FACTOR;
+    sensors.accel100Hz[YAXIS] = -((float)mpu6000Summed100Hz.accel[YAXIS] / mpu6000Summed100Hz.samples - accelTCBias[YAXIS]) * ACCEL_SCALE_FACTOR;
+    sensors.accel100Hz[ZAXIS] = -((float)mpu6000Summed100Hz.accel[ZAXIS] / mpu6000Summed100Hz.samples - accelTCBias[ZAXIS]) * ACCEL_SCALE_FACTOR;
+
+    sensors.accel100HzMXR[XAXIS] = -(accelSummedSamples100HzMXR[XAXIS] / 10.0f - eepromConfig.accelBiasMXR[XAXIS]) * eepromConfig.accelScaleFactorMXR[XAXIS];
+    sensors.accel100HzMXR[YAXIS] = -(accelSummedSamples100HzMXR[YAXIS] / 10.0f - eepromConfig.accelBiasMXR[YAXIS]) * eepromConfig.accelScaleFactorMXR[YAXIS];
+    sensors.accel100HzMXR[ZAXIS] =  (accelSummedSamples100HzMXR[ZAXIS] / 10.0f - eepromConfig.accelBiasMXR[ZAXIS]) * eepromConfig.accelScaleFactorMXR[ZAXIS];
+}
+
+///////////////////////////////////////////////////////////////////////////////
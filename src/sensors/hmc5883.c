@@ -89,6 +89,8 @@ uint8_t newMagData = false;
 
 int16andUint8_t rawMag[3];
 
+uint64_t magSampleTime;
+
 ///////////////////////////////////////////////////////////////////////////////
 // Read Magnetometer
 ///////////////////////////////////////////////////////////////////////////////
@@ -99,6 +101,8 @@ uint8_t readMag(I2C_TypeDef *I2Cx)
 
     i2cRead(I2Cx, HMC5883_ADDRESS, HMC5883_DATA_X_MSB_REG, 6, I2C_Buffer_Rx);
 
+    magSampleTime = micros64();
+
     rawMag[YAXIS].bytes[1] = I2C_Buffer_Rx[0];
     rawMag[YAXIS].bytes[0] = I2C_Buffer_Rx[1];
     rawMag[ZAXIS].bytes[1] = I2C_Buffer_Rx[2];
@@ -148,9 +152,9 @@ void initMag(I2C_TypeDef *I2Cx)
         magScaleFactor[ZAXIS] += (1.08f * 1090.0f) / (float)rawMag[ZAXIS].value;
     }
 
-    magScaleFactor[XAXIS] = fabs(magScaleFactor[XAXIS] / 10.0f);
-    magScaleFactor[YAXIS] = fabs(magScaleFactor[YAXIS] / 10.0f);
-    magScaleFactor[ZAXIS] = fabs(magScaleFactor[ZAXIS] / 10.0f);
+    magScaleFactor[XAXIS] = fabsf(magScaleFactor[XAXIS] / 10.0f);
+    magScaleFactor[YAXIS] = fabsf(magScaleFactor[YAXIS] / 10.0f);
+    magScaleFactor[ZAXIS] = fabsf(magScaleFactor[ZAXIS] / 10.0f);
 
     i2cWrite(I2Cx, HMC5883_ADDRESS, HMC5883_CONFIG_REG_A, SENSOR_CONFIG | NORMAL_MEASUREMENT_CONFIGURATION);
     delay(50);
@@ -44,6 +44,8 @@ extern uint8_t magDataUpdate;
 
 extern uint8_t newMagData;
 
+extern uint64_t magSampleTime;
+
 extern int16andUint8_t rawMag[3];
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -97,18 +97,24 @@
 #define BIT_RAW_RDY_EN			    0x01
 #define BIT_I2C_IF_DIS              0x10
 #define BIT_INT_STATUS_DATA		    0x01
+#define BIT_FIFO_RESET              0x04
+#define BIT_FIFO_EN                 0x40
+#define BITS_FIFO_TEMP_GYRO_ACCEL   0xF8
 
 ///////////////////////////////////////
 
-float accelOneG = 9.8065;
-
-int32_t accelSum100Hz[3] = { 0, 0, 0 };
+#define MPU6000_FIFO_MAX_RECORDS    16       // 2 mSec of 8 kHz data per drain
+#define MPU6000_FIFO_READ_LENGTH    (1 + MPU6000_FIFO_MAX_RECORDS * MPU6000_RECORD_LENGTH)
+#define MPU6000_FIFO_SAMPLE_RATE    8000.0f
+#define MPU6000_FIFO_SAMPLE_PERIOD  125      // uSec
+#define MPU6000_FIFO_DECIMATION     8        // 8 kHz to 1 kHz, summed into the 500 Hz and 100 Hz loops
+#define MPU6000_FIFO_STALE_TIME     5000     // uSec, an overflow after a longer gap is a resync, not an error
 
-int32_t accelSum500Hz[3] = { 0, 0, 0 };
+enum { MPU6000_DMA_BURST, MPU6000_DMA_FIFO_COUNT, MPU6000_DMA_FIFO_RESET, MPU6000_DMA_FIFO_DATA };
 
-int32_t accelSummedSamples100Hz[3];
+///////////////////////////////////////
 
-int32_t accelSummedSamples500Hz[3];
+float accelOneG = 9.8065;
 
 float accelTCBias[3] = { 0.0f, 0.0f, 0.0f };
 
@@ -118,10 +124,6 @@ int16andUint8_t rawAccel[3];
 
 float gyroRTBias[3];
 
-int32_t gyroSum500Hz[3] = { 0, 0, 0 };
-
-int32_t gyroSummedSamples500Hz[3];
-
 float gyroTCBias[3];
 
 int16andUint8_t rawGyro[3];
@@ -136,6 +138,422 @@ float   mpu6000Temperature;
 
 int16andUint8_t rawMPU6000Temperature;
 
+///////////////////////////////////////
+
+mpu6000Accumulator_t mpu6000Sum100Hz;
+
+mpu6000Accumulator_t mpu6000Sum500Hz;
+
+mpu6000Accumulator_t mpu6000Summed100Hz = { .samples = 1 };  // Zero until the first handoff, never 0/0
+
+mpu6000Accumulator_t mpu6000Summed500Hz = { .samples = 1 };
+
+semaphore_t newMpu6000Data100Hz = false;  // Set by a handoff with samples, cleared by the task
+
+semaphore_t newMpu6000Data500Hz = false;
+
+uint32_t mpu6000StallCount = 0;
+
+mpu6000Burst_t mpu6000Burst;
+
+uint8_t mpu6000DmaEnabled = false;
+
+uint32_t mpu6000FifoOverflowCount = 0;
+
+gyroDecimator_t gyroDecimator;
+
+static uint8_t  mpu6000DmaTx[MPU6000_FIFO_READ_LENGTH];
+
+static uint8_t  mpu6000FifoBuffer[MPU6000_FIFO_READ_LENGTH];
+
+static volatile uint8_t mpu6000DmaState;
+
+static uint16_t mpu6000FifoRecordCount;
+
+static uint64_t mpu6000FifoDrainTime;
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 DMA Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+static void initMPU6000Dma(void)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    EXTI_InitTypeDef EXTI_InitStructure;
+    DMA_InitTypeDef  DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    GPIO_StructInit(&GPIO_InitStructure);
+    EXTI_StructInit(&EXTI_InitStructure);
+    DMA_StructInit(&DMA_InitStructure);
+
+    RCC_AHB1PeriphClockCmd(MPU6000_INT_GPIO_CLOCK, ENABLE);
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1,    ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG,  ENABLE);
+
+    GPIO_InitStructure.GPIO_Pin   = MPU6000_INT_PIN;
+    GPIO_InitStructure.GPIO_Mode  = GPIO_Mode_IN;
+  //GPIO_InitStructure.GPIO_Speed = GPIO_Speed_2MHz;
+  //GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+    GPIO_InitStructure.GPIO_PuPd  = GPIO_PuPd_DOWN;
+
+    GPIO_Init(MPU6000_INT_GPIO, &GPIO_InitStructure);
+
+    // SPI3 RX, DMA1 Stream 0 Channel 0
+
+    DMA_DeInit(DMA1_Stream0);
+
+    DMA_InitStructure.DMA_Channel            = DMA_Channel_0;
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&MPU6000_SPI->DR;
+    DMA_InitStructure.DMA_Memory0BaseAddr    = (uint32_t)mpu6000Burst.buffer[0];
+  //DMA_InitStructure.DMA_DIR                = DMA_DIR_PeripheralToMemory;
+    DMA_InitStructure.DMA_BufferSize         = MPU6000_BURST_LENGTH;
+  //DMA_InitStructure.DMA_PeripheralInc      = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc          = DMA_MemoryInc_Enable;
+  //DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+  //DMA_InitStructure.DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte;
+  //DMA_InitStructure.DMA_Mode               = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority           = DMA_Priority_High;
+  //DMA_InitStructure.DMA_FIFOMode           = DMA_FIFOMode_Disable;
+
+    DMA_Init(DMA1_Stream0, &DMA_InitStructure);
+
+    DMA_ITConfig(DMA1_Stream0, DMA_IT_TC, ENABLE);
+
+    // SPI3 TX, DMA1 Stream 7 Channel 0
+
+    DMA_DeInit(DMA1_Stream7);
+
+    DMA_InitStructure.DMA_Memory0BaseAddr    = (uint32_t)mpu6000DmaTx;
+    DMA_InitStructure.DMA_DIR                = DMA_DIR_MemoryToPeripheral;
+
+    DMA_Init(DMA1_Stream7, &DMA_InitStructure);
+
+    // RX complete ends the burst, TX always finishes first
+
+    NVIC_InitStructure.NVIC_IRQChannel                   = DMA1_Stream0_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority        = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd                = ENABLE;
+
+    NVIC_Init(&NVIC_InitStructure);
+
+    // Data ready
+
+    SYSCFG_EXTILineConfig(MPU6000_INT_EXTI_PORT, MPU6000_INT_EXTI_PIN);
+
+    EXTI_InitStructure.EXTI_Line    = MPU6000_INT_EXTI_LINE;
+    EXTI_InitStructure.EXTI_Mode    = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising;
+    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+
+    EXTI_Init(&EXTI_InitStructure);
+
+    NVIC_InitStructure.NVIC_IRQChannel                   = MPU6000_INT_IRQn;
+  //NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+  //NVIC_InitStructure.NVIC_IRQChannelSubPriority        = 0;
+  //NVIC_InitStructure.NVIC_IRQChannelCmd                = ENABLE;
+
+    NVIC_Init(&NVIC_InitStructure);
+
+    mpu6000DmaEnabled = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Start DMA
+//
+// Clocks length bytes of mpu6000DmaTx out and the replies into buffer.
+// mpu6000StartDma() reads registers from address on into buffer[1] on.
+///////////////////////////////////////////////////////////////////////////////
+
+static void mpu6000StartTransfer(uint8_t *buffer, uint16_t length)
+{
+    DMA1_Stream0->M0AR = (uint32_t)buffer;
+
+    DMA_SetCurrDataCounter(DMA1_Stream0, length);
+    DMA_SetCurrDataCounter(DMA1_Stream7, length);
+
+    ENABLE_MPU6000;
+
+    DMA_Cmd(DMA1_Stream0, ENABLE);
+    DMA_Cmd(DMA1_Stream7, ENABLE);
+
+    SPI_I2S_DMACmd(MPU6000_SPI, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+}
+
+///////////////////////////////////////
+
+static void mpu6000StartDma(uint8_t *buffer, uint8_t address, uint16_t length)
+{
+    mpu6000DmaTx[0] = address | 0x80;
+    mpu6000DmaTx[1] = 0x00;
+
+    mpu6000StartTransfer(buffer, length);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Write Register
+///////////////////////////////////////////////////////////////////////////////
+
+static void mpu6000WriteRegister(uint8_t address, uint8_t data)
+{
+    ENABLE_MPU6000;
+    spiTransfer(MPU6000_SPI, address);
+    spiTransfer(MPU6000_SPI, data);
+    DISABLE_MPU6000;
+
+    delayMicroseconds(1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 FIFO Reset
+//
+// Register writes need the slow SPI clock.  The reset goes out as one more
+// transfer of the drain, so the handler does not spin on a 2 byte write at
+// 656 kHz, and the divisor goes back up when it completes.
+///////////////////////////////////////////////////////////////////////////////
+
+static void mpu6000FifoReset(void)
+{
+    setSPIdivisor(MPU6000_SPI, 64);                        // 0.65625 MHz SPI clock, register writes
+
+    mpu6000DmaTx[0] = MPU6000_USER_CTRL;
+    mpu6000DmaTx[1] = BIT_I2C_IF_DIS | BIT_FIFO_EN | BIT_FIFO_RESET;
+
+    mpu6000DmaState = MPU6000_DMA_FIFO_RESET;
+
+    mpu6000StartTransfer(mpu6000FifoBuffer, 2);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Data Ready Interrupt Handler
+///////////////////////////////////////////////////////////////////////////////
+
+void MPU6000_INT_IRQHandler(void)
+{
+    uint8_t *buffer;
+
+    if (EXTI_GetITStatus(MPU6000_INT_EXTI_LINE) == RESET)
+        return;
+
+    EXTI_ClearITPendingBit(MPU6000_INT_EXTI_LINE);
+
+    // Same conditions SysTick uses to consume the sums, blocking reads own the bus otherwise
+
+    if ((mpu6000DmaEnabled   == false) ||
+        (eepromConfig.mpu6000FifoEnabled == true) ||
+        (systemReady         == false) ||
+        (cliBusy             == true)  ||
+        (accelCalibrating    == true)  ||
+        (escCalibrating      == true)  ||
+        (magCalibrating      == true)  ||
+        (mpu6000Calibrating  == true))
+        return;
+
+    buffer = mpu6000BurstStart(&mpu6000Burst, micros64());
+
+    if (buffer == NULL)
+        return;
+
+    mpu6000DmaState = MPU6000_DMA_BURST;
+
+    mpu6000StartDma(buffer, MPU6000_ACCEL_XOUT_H, MPU6000_BURST_LENGTH);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 FIFO Drain Request
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000FifoRequest(void)
+{
+    uint8_t *buffer;
+
+    if ((mpu6000DmaEnabled == false) || (eepromConfig.mpu6000FifoEnabled == false))
+        return;
+
+    buffer = mpu6000BurstStart(&mpu6000Burst, micros64());
+
+    if (buffer == NULL)
+        return;
+
+    mpu6000DmaState = MPU6000_DMA_FIFO_COUNT;
+
+    mpu6000StartDma(buffer, MPU6000_FIFO_COUNTH, 3);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 FIFO Process
+///////////////////////////////////////////////////////////////////////////////
+
+static void mpu6000FifoProcess(void)
+{
+    uint16_t        record;
+    uint8_t         axis;
+    float32_t       gyroIn[3], gyroOut[3];
+    mpu6000Sample_t sample;
+
+    for (record = 0; record < mpu6000FifoRecordCount; record++)
+    {
+        // Records are oldest first, the newest was written just before the drain started
+
+        mpu6000BurstParse(&mpu6000FifoBuffer[1 + record * MPU6000_RECORD_LENGTH],
+                          mpu6000Burst.requestTime - (uint64_t)(mpu6000FifoRecordCount - 1 - record) * MPU6000_FIFO_SAMPLE_PERIOD,
+                          &sample);
+
+        for (axis = 0; axis < 3; axis++)
+            gyroIn[axis] = (float32_t)sample.gyro[axis];
+
+        if (gyroDecimatorUpdate(&gyroDecimator, gyroIn, gyroOut) == false)
+            continue;
+
+        for (axis = 0; axis < 3; axis++)
+            sample.gyro[axis] = (int16_t)constrain(roundf(gyroOut[axis]), -32768.0f, 32767.0f);
+
+        rawAccel[XAXIS].value        = sample.accel[XAXIS];
+        rawAccel[YAXIS].value        = sample.accel[YAXIS];
+        rawAccel[ZAXIS].value        = sample.accel[ZAXIS];
+
+        rawMPU6000Temperature.value  = sample.temperature;
+
+        rawGyro[ROLL ].value         = sample.gyro[ROLL ];
+        rawGyro[PITCH].value         = sample.gyro[PITCH];
+        rawGyro[YAW  ].value         = sample.gyro[YAW  ];
+
+        mpu6000Accumulate(&mpu6000Sum500Hz, &sample);
+        mpu6000Accumulate(&mpu6000Sum100Hz, &sample);
+
+        rateLoopUpdate(&sample);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Transfer Complete Interrupt Handler
+///////////////////////////////////////////////////////////////////////////////
+
+void DMA1_Stream0_IRQHandler(void)
+{
+    uint8_t         *buffer;
+    bool            overflow;
+    mpu6000Sample_t sample;
+
+    DMA_ClearFlag(DMA1_Stream0, DMA_FLAG_TCIF0 | DMA_FLAG_HTIF0);
+    DMA_ClearFlag(DMA1_Stream7, DMA_FLAG_TCIF7 | DMA_FLAG_HTIF7);
+
+    DISABLE_MPU6000;
+
+    SPI_I2S_DMACmd(MPU6000_SPI, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+
+    switch (mpu6000DmaState)
+    {
+        ///////////////////////////////
+
+        case MPU6000_DMA_BURST:
+            mpu6000BurstComplete(&mpu6000Burst, &sample);
+
+            rawAccel[XAXIS].value        = sample.accel[XAXIS];
+            rawAccel[YAXIS].value        = sample.accel[YAXIS];
+            rawAccel[ZAXIS].value        = sample.accel[ZAXIS];
+
+            rawMPU6000Temperature.value  = sample.temperature;
+
+            rawGyro[ROLL ].value         = sample.gyro[ROLL ];
+            rawGyro[PITCH].value         = sample.gyro[PITCH];
+            rawGyro[YAW  ].value         = sample.gyro[YAW  ];
+
+            mpu6000Accumulate(&mpu6000Sum500Hz, &sample);
+            mpu6000Accumulate(&mpu6000Sum100Hz, &sample);
+
+            rateLoopUpdate(&sample);
+            break;
+
+        ///////////////////////////////
+
+        case MPU6000_DMA_FIFO_COUNT:
+            buffer = mpu6000Burst.buffer[mpu6000Burst.active];
+
+            mpu6000FifoRecordCount = mpu6000FifoRecords((buffer[1] << 8) | buffer[2], MPU6000_FIFO_MAX_RECORDS, &overflow);
+
+            if (overflow && ((mpu6000Burst.requestTime - mpu6000FifoDrainTime) < MPU6000_FIFO_STALE_TIME))
+                mpu6000FifoOverflowCount++;
+
+            mpu6000FifoDrainTime = mpu6000Burst.requestTime;
+
+            if (overflow)
+            {
+                mpu6000FifoReset();
+                break;
+            }
+
+            if (mpu6000FifoRecordCount == 0)
+            {
+                mpu6000BurstRelease(&mpu6000Burst);
+                break;
+            }
+
+            mpu6000DmaState = MPU6000_DMA_FIFO_DATA;
+
+            mpu6000StartDma(mpu6000FifoBuffer, MPU6000_FIFO_R_W, 1 + mpu6000FifoRecordCount * MPU6000_RECORD_LENGTH);
+            break;
+
+        ///////////////////////////////
+
+        case MPU6000_DMA_FIFO_RESET:
+            setSPIdivisor(MPU6000_SPI, 2);                 // 21 MHz SPI clock (within 20 +/- 10%)
+
+            mpu6000BurstRelease(&mpu6000Burst);
+            break;
+
+        ///////////////////////////////
+
+        case MPU6000_DMA_FIFO_DATA:
+            mpu6000BurstRelease(&mpu6000Burst);
+
+            mpu6000FifoProcess();
+            break;
+
+        ///////////////////////////////
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Configure Acquisition
+//
+// Burst mode reads one sample per data ready edge at the DLPF rate.  FIFO
+// mode opens the DLPF to 256 Hz so the gyro samples at 8 kHz, queues every
+// record in the FIFO and drains it once per mSec through the decimator.
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000ConfigureAcquisition(void)
+{
+    while (mpu6000Burst.busy);
+
+    if ((eepromConfig.mpu6000FifoEnabled == true) &&
+        (gyroDecimatorInit(&gyroDecimator, eepromConfig.gyroDecimatorTaps, MPU6000_FIFO_DECIMATION,
+                           eepromConfig.gyroDecimatorCutoff, MPU6000_FIFO_SAMPLE_RATE) == false))
+        eepromConfig.mpu6000FifoEnabled = false;
+
+    setSPIdivisor(MPU6000_SPI, 64);                        // 0.65625 MHz SPI clock, register writes
+
+    if (eepromConfig.mpu6000FifoEnabled == true)
+    {
+        mpu6000WriteRegister(MPU6000_INT_ENABLE, 0x00);
+        mpu6000WriteRegister(MPU6000_CONFIG,     BITS_DLPF_CFG_256HZ);
+        mpu6000WriteRegister(MPU6000_FIFO_EN,    BITS_FIFO_TEMP_GYRO_ACCEL);
+        mpu6000WriteRegister(MPU6000_USER_CTRL,  BIT_I2C_IF_DIS | BIT_FIFO_EN | BIT_FIFO_RESET);
+    }
+    else
+    {
+        mpu6000WriteRegister(MPU6000_FIFO_EN,    0x00);
+        mpu6000WriteRegister(MPU6000_USER_CTRL,  BIT_I2C_IF_DIS);
+        mpu6000WriteRegister(MPU6000_CONFIG,     eepromConfig.dlpfSetting);
+        mpu6000WriteRegister(MPU6000_INT_ENABLE, BIT_RAW_RDY_EN);
+    }
+
+    setSPIdivisor(MPU6000_SPI, 2);                         // 21 MHz SPI clock (within 20 +/- 10%)
+
+    mpu6000FifoDrainTime = micros64();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // MPU6000 Initialization
 ///////////////////////////////////////////////////////////////////////////////
@@ -198,6 +616,14 @@ void initMPU6000(void)
     spiTransfer(MPU6000_SPI, BITS_FS_1000DPS);
     DISABLE_MPU6000;
 
+    delayMicroseconds(1);
+
+    ENABLE_MPU6000;
+    spiTransfer(MPU6000_SPI, MPU6000_INT_PIN_CFG);         // INT active high, push-pull, 50 uSec pulse
+    spiTransfer(MPU6000_SPI, BIT_INT_ANYRD_2CLEAR);
+    DISABLE_MPU6000;
+
+
     ///////////////////////////////////
 
     setSPIdivisor(MPU6000_SPI, 2);                         // 21 MHz SPI clock (within 20 +/- 10%)
@@ -207,6 +633,10 @@ void initMPU6000(void)
     delay(100);
 
     computeMPU6000RTData();
+
+    initMPU6000Dma();
+
+    mpu6000ConfigureAcquisition();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -215,6 +645,8 @@ void initMPU6000(void)
 
 void readMPU6000(void)
 {
+    while (mpu6000Burst.busy);                             // Let an in flight DMA burst finish
+
     ENABLE_MPU6000;
 
                                      spiTransfer(MPU6000_SPI, MPU6000_ACCEL_XOUT_H | 0x80);
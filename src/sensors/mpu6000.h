@@ -54,6 +54,19 @@
 #define DISABLE_MPU6000       GPIO_SetBits(MPU6000_CS_GPIO,   MPU6000_CS_PIN)
 #define ENABLE_MPU6000        GPIO_ResetBits(MPU6000_CS_GPIO, MPU6000_CS_PIN);
 
+// Data ready.  Not confirmed against the AQ32 schematic, a wrong line
+// leaves burst mode without samples, which SysTick reports as an
+// EVR_Mpu6000DataStall from the first frame.
+
+#define MPU6000_INT_GPIO       GPIOC
+#define MPU6000_INT_GPIO_CLOCK RCC_AHB1Periph_GPIOC
+#define MPU6000_INT_PIN        GPIO_Pin_13
+#define MPU6000_INT_EXTI_PORT  EXTI_PortSourceGPIOC
+#define MPU6000_INT_EXTI_PIN   EXTI_PinSource13
+#define MPU6000_INT_EXTI_LINE  EXTI_Line13
+#define MPU6000_INT_IRQn       EXTI15_10_IRQn
+#define MPU6000_INT_IRQHandler EXTI15_10_IRQHandler
+
 #define ACCEL_SCALE_FACTOR 0.00119708f  // (1/8192) * 9.8065  (8192 LSB = 1 G)
 #define GYRO_SCALE_FACTOR  0.00053292f  // (4/131) * pi/180   (32.75 LSB = 1 DPS)
 
@@ -65,14 +78,6 @@ extern float   accelOneG;
 
 extern float   accelTCBias[3];
 
-extern int32_t accelSum100Hz[3];
-
-extern int32_t accelSum500Hz[3];
-
-extern int32_t accelSummedSamples100Hz[3];
-
-extern int32_t accelSummedSamples500Hz[3];
-
 extern int16andUint8_t rawAccel[3];
 
 ///////////////////////////////////////
@@ -81,10 +86,6 @@ extern float gyroRTBias[3];
 
 extern float gyroTCBias[3];
 
-extern int32_t gyroSum500Hz[3];
-
-extern int32_t gyroSummedSamples500Hz[3];
-
 extern int16andUint8_t rawGyro[3];
 
 ///////////////////////////////////////
@@ -97,6 +98,30 @@ extern float   mpu6000Temperature;
 
 extern int16andUint8_t rawMPU6000Temperature;
 
+///////////////////////////////////////
+
+extern mpu6000Accumulator_t mpu6000Sum100Hz;
+
+extern mpu6000Accumulator_t mpu6000Sum500Hz;
+
+extern mpu6000Accumulator_t mpu6000Summed100Hz;
+
+extern mpu6000Accumulator_t mpu6000Summed500Hz;
+
+extern semaphore_t newMpu6000Data100Hz;
+
+extern semaphore_t newMpu6000Data500Hz;
+
+extern uint32_t mpu6000StallCount;
+
+extern mpu6000Burst_t mpu6000Burst;
+
+extern uint8_t mpu6000DmaEnabled;
+
+extern uint32_t mpu6000FifoOverflowCount;
+
+extern gyroDecimator_t gyroDecimator;
+
 ///////////////////////////////////////////////////////////////////////////////
 // MPU6000 Initialization
 ///////////////////////////////////////////////////////////////////////////////
@@ -109,6 +134,18 @@ void initMPU6000(void);
 
 void readMPU6000(void);
 
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 FIFO Drain Request
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000FifoRequest(void);
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Configure Acquisition
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000ConfigureAcquisition(void);
+
 ///////////////////////////////////////////////////////////////////////////////
 // Compute MPU6000 Runtime Data
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,250 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Hardware independent half of the MPU6000 DMA acquisition.  The EXTI and
+// DMA handlers in mpu6000.c only move bytes and call into here, so the
+// buffer ownership and sample handoff can be exercised on a host build.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include <string.h>
+
+#include "mpu6000Burst.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Burst Start
+//
+// Called on the data ready edge.  Returns the buffer the DMA should fill,
+// or NULL if the previous transfer has not completed yet.
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t *mpu6000BurstStart(mpu6000Burst_t *burst, uint64_t requestTime)
+{
+    if (burst->busy)
+    {
+        burst->overrunCount++;
+        return NULL;
+    }
+
+    burst->busy        = true;
+    burst->requestTime = requestTime;
+
+    return burst->buffer[burst->active];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Burst Complete
+//
+// Called from the DMA transfer complete interrupt.  Hands the DMA the other
+// buffer before parsing, so the next data ready edge never waits on us.
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000BurstComplete(mpu6000Burst_t *burst, mpu6000Sample_t *sample)
+{
+    uint8_t completed = burst->active;
+
+    burst->active = completed ^ 1;
+    burst->busy   = false;
+
+    burst->completeCount++;
+
+    mpu6000BurstParse(&burst->buffer[completed][1], burst->requestTime, sample);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Burst Release
+//
+// Ends a transfer chain that does not produce a single burst sample, the
+// FIFO drain for example.
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000BurstRelease(mpu6000Burst_t *burst)
+{
+    burst->busy = false;
+
+    burst->completeCount++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Burst Parse
+//
+// One record, the byte clocked in with the register address already
+// skipped.  FIFO records use the same layout when accel, temperature and
+// gyro are all enabled in FIFO_EN.
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000BurstParse(const uint8_t *record, uint64_t time, mpu6000Sample_t *sample)
+{
+    uint8_t axis;
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        sample->accel[axis] = (int16_t)((record[0 + 2 * axis] << 8) | record[1 + 2 * axis]);
+        sample->gyro[axis]  = (int16_t)((record[8 + 2 * axis] << 8) | record[9 + 2 * axis]);
+    }
+
+    sample->temperature = (int16_t)((record[6] << 8) | record[7]);
+
+    sample->time = time;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 FIFO Records
+//
+// Number of whole records to drain for a FIFO_COUNT reading, capped at
+// maxRecords.  Once there is no room left for another record the MPU6000
+// overwrites the oldest data and record alignment is lost, which is
+// reported through overflow so the caller can reset the FIFO.
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t mpu6000FifoRecords(uint16_t fifoCount, uint16_t maxRecords, bool *overflow)
+{
+    uint16_t records;
+
+    *overflow = (fifoCount > (MPU6000_FIFO_SIZE - MPU6000_RECORD_LENGTH));
+
+    if (*overflow)
+        return 0;
+
+    records = fifoCount / MPU6000_RECORD_LENGTH;
+
+    if (records > maxRecords)
+        records = maxRecords;
+
+    return records;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Accumulate
+//
+// Besides the plain sums, keeps the second order coning terms of the gyro
+// samples so the consumer can rebuild the rotation vector of the interval
+// rather than just its average rate.  With g the raw samples and A the
+// running sum before sample k
+//
+//   gyroConing = sum (6 A + g[k-1]) x g[k]
+//   gyroMoment = sum  A - (k-1) g[k]
+//
+// both in raw counts, so this stays integer in interrupt context and the
+// bias, which is only known to the consumer, can be taken out afterwards.
+// See mpu6000DeltaAngle().
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000Accumulate(mpu6000Accumulator_t *accumulator, const mpu6000Sample_t *sample)
+{
+    uint8_t       axis;
+    int32_t       weighted[3];
+    const int16_t *previous;
+
+    previous = (accumulator->samples == 0) ? accumulator->gyroPrevious : accumulator->gyroLast;
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        weighted[axis] = 6 * accumulator->gyro[axis] + previous[axis];
+
+        accumulator->gyroMoment[axis] += accumulator->gyro[axis] - (int32_t)accumulator->samples * sample->gyro[axis];
+    }
+
+    accumulator->gyroConing[0] += (int64_t)weighted[1] * sample->gyro[2] - (int64_t)weighted[2] * sample->gyro[1];
+    accumulator->gyroConing[1] += (int64_t)weighted[2] * sample->gyro[0] - (int64_t)weighted[0] * sample->gyro[2];
+    accumulator->gyroConing[2] += (int64_t)weighted[0] * sample->gyro[1] - (int64_t)weighted[1] * sample->gyro[0];
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        accumulator->accel[axis]   += sample->accel[axis];
+        accumulator->gyro[axis]    += sample->gyro[axis];
+        accumulator->gyroLast[axis] = sample->gyro[axis];
+    }
+
+    accumulator->samples++;
+    accumulator->lastSampleTime = sample->time;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Accumulator Handoff
+//
+// Copies the running sums to the consumer copy and restarts them.  If no
+// sample arrived since the last handoff the previous summed values are kept,
+// so consumers never divide by zero.  The caller must keep the accumulating
+// interrupt out while this runs.
+///////////////////////////////////////////////////////////////////////////////
+
+bool mpu6000AccumulatorHandoff(mpu6000Accumulator_t *accumulator, mpu6000Accumulator_t *summed)
+{
+    if (accumulator->samples == 0)
+        return false;
+
+    *summed = *accumulator;
+
+    memset(accumulator, 0, sizeof(mpu6000Accumulator_t));
+
+    memcpy(accumulator->gyroPrevious, summed->gyroLast, sizeof(accumulator->gyroPrevious));
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Delta Angle
+//
+// Rotation vector over a handed off interval, in sensor axes.  scale is
+// radians per count per sample, bias in counts.  Savage's two sample
+// form, the half running angle cross each new sample plus a twelfth of
+// consecutive samples crossed, with the bias worked back out of the raw
+// count terms kept by mpu6000Accumulate():
+//
+//   phi = s (sum g - N b) + s^2 / 12 (gyroConing - (6 gyroMoment + g0 - gN) x b)
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000DeltaAngle(const mpu6000Accumulator_t *summed, const float bias[3], float scale, float deltaAngle[3])
+{
+    uint8_t axis;
+    float   moment[3], coning[3];
+
+    for (axis = 0; axis < 3; axis++)
+        moment[axis] = 6.0f * (float)summed->gyroMoment[axis] + (float)summed->gyroPrevious[axis] - (float)summed->gyroLast[axis];
+
+    coning[0] = (float)summed->gyroConing[0] - (moment[1] * bias[2] - moment[2] * bias[1]);
+    coning[1] = (float)summed->gyroConing[1] - (moment[2] * bias[0] - moment[0] * bias[2]);
+    coning[2] = (float)summed->gyroConing[2] - (moment[0] * bias[1] - moment[1] * bias[0]);
+
+    for (axis = 0; axis < 3; axis++)
+        deltaAngle[axis] = scale * ((float)summed->gyro[axis] - (float)summed->samples * bias[axis]) +
+                           scale * scale * coning[axis] / 12.0f;
+}
+
+///////////////////////////////////////////////////////////////////////////////
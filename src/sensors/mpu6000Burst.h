@@ -0,0 +1,139 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Burst Defines
+///////////////////////////////////////////////////////////////////////////////
+
+#define MPU6000_RECORD_LENGTH  14                              // Accel XYZ, temperature, gyro XYZ, big endian
+
+#define MPU6000_BURST_LENGTH   (1 + MPU6000_RECORD_LENGTH)     // Register address byte + one record
+
+#define MPU6000_FIFO_SIZE      1024
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Burst Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct mpu6000Sample_t
+{
+    int16_t  accel[3];
+    int16_t  temperature;
+    int16_t  gyro[3];
+    uint64_t time;                     // micros64() at the data ready edge or FIFO drain
+} mpu6000Sample_t;
+
+typedef struct mpu6000Accumulator_t
+{
+    int32_t  accel[3];
+    int32_t  gyro[3];
+    uint16_t samples;
+    uint64_t lastSampleTime;
+
+    // Coning terms in raw counts, see mpu6000Accumulate()
+    int64_t  gyroConing[3];
+    int32_t  gyroMoment[3];
+    int16_t  gyroPrevious[3];          // Last sample of the previous interval
+    int16_t  gyroLast[3];
+} mpu6000Accumulator_t;
+
+typedef struct mpu6000Burst_t
+{
+    uint8_t           buffer[2][MPU6000_BURST_LENGTH];
+    volatile uint8_t  active;          // Buffer currently owned by the DMA
+    volatile bool     busy;
+    volatile uint64_t requestTime;
+    uint32_t          completeCount;
+    uint32_t          overrunCount;    // Data ready edges lost because a transfer was in progress
+} mpu6000Burst_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Burst Start
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t *mpu6000BurstStart(mpu6000Burst_t *burst, uint64_t requestTime);
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Burst Complete
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000BurstComplete(mpu6000Burst_t *burst, mpu6000Sample_t *sample);
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Burst Release
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000BurstRelease(mpu6000Burst_t *burst);
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Burst Parse
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000BurstParse(const uint8_t *record, uint64_t time, mpu6000Sample_t *sample);
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 FIFO Records
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t mpu6000FifoRecords(uint16_t fifoCount, uint16_t maxRecords, bool *overflow);
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Accumulate
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000Accumulate(mpu6000Accumulator_t *accumulator, const mpu6000Sample_t *sample);
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Accumulator Handoff
+///////////////////////////////////////////////////////////////////////////////
+
+bool mpu6000AccumulatorHandoff(mpu6000Accumulator_t *accumulator, mpu6000Accumulator_t *summed);
+
+///////////////////////////////////////////////////////////////////////////////
+// MPU6000 Delta Angle
+///////////////////////////////////////////////////////////////////////////////
+
+void mpu6000DeltaAngle(const mpu6000Accumulator_t *summed, const float bias[3], float scale, float deltaAngle[3]);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -64,6 +64,8 @@ int32_t ms5611Temperature;
 
 uint8_t newPressureReading = false;
 
+uint64_t pressureSampleTime;
+
 uint8_t newTemperatureReading = false;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -103,6 +105,8 @@ void readPressureRequestPressure(I2C_TypeDef *I2Cx)
 
     i2cRead(I2Cx, MS5611_ADDRESS, 0x00, 3, data);    // Request pressure read
 
+    pressureSampleTime = micros64();
+
     d1.bytes[2] = data[0];
     d1.bytes[1] = data[1];
     d1.bytes[0] = data[2];
@@ -201,7 +205,7 @@ void calculatePressureAltitude(void)
 
 	p = (((d1Value * sensitivity) >> 21) - offset) >> 15;
 
-	sensors.pressureAlt50Hz = 44330.0f * (1.0f - pow((float)p / 101325.0f, 1.0f / 5.255f));
+	sensors.pressureAlt50Hz = 44330.0f * (1.0f - fastPowf((float)p / 101325.0f, 1.0f / 5.255f));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -50,6 +50,8 @@ extern int32_t ms5611Temperature;
 
 extern uint8_t newPressureReading;
 
+extern uint64_t pressureSampleTime;
+
 extern uint8_t newTemperatureReading;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -146,9 +146,9 @@ void DebugMon_Handler(void)
   * @param  None
   * @retval None
   */
-void PendSV_Handler(void)
-{
-}
+// HJI void PendSV_Handler(void)
+// HJI {
+// HJI }
 
 /**
   * @brief  This function handles SysTick Handler.
@@ -0,0 +1,407 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// The flight tasks and the table the scheduler runs them from.  The board
+// build and utils/sitl compile this same file, the simulation supplies the
+// drivers the tasks call, so both run one task list.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+#include "tasks.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+static uint8_t  execUpCount = 0;
+
+static uint64_t previousImu500HzTimestamp = 0;
+static uint64_t previousImu100HzTimestamp = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+// 500 Hz Task
+///////////////////////////////////////////////////////////////////////////////
+
+static void task500Hz(void)
+{
+    uint32_t currentTime;
+
+    #ifdef _DTIMING
+        LA1_ENABLE;
+    #endif
+
+    currentTime       = micros();
+    deltaTime500Hz    = currentTime - previous500HzTime;
+    previous500HzTime = currentTime;
+
+    // Only samples that are new, a stalled sensor must not turn the
+    // attitude on the last delta angle every 2 mSec
+
+    if (newMpu6000Data500Hz == true)
+    {
+        newMpu6000Data500Hz = false;
+
+        sensors.imu500HzTimestamp = mpu6000Summed500Hz.lastSampleTime;
+
+        dt500Hz = timebaseSampleInterval(&previousImu500HzTimestamp, sensors.imu500HzTimestamp, 0.002f);  // For integrations in 500 Hz loop
+
+        computeMPU6000TCBias();
+        /*
+        sensorTemp1 = computeMPU6000SensorTemp();
+        sensorTemp2 = sensorTemp1 * sensorTemp1;
+        sensorTemp3 = sensorTemp2 * sensorTemp1;
+        */
+
+        scaleSensors500Hz(dt500Hz);
+
+        // Rate loop gyros only, the estimators integrate deltaAngle500Hz.  The
+        // decoupled rate loop filters its own samples.
+
+        if (rateLoop.enabled == false)
+        {
+            dynamicNotchFilter(sensors.gyro500Hz);
+            filterChainUpdate(&filterChains[GYRO500HZ_FILTER], sensors.gyro500Hz, sensors.gyro500Hz);
+        }
+
+        #if defined(MPU_ACCEL)
+            filterChainUpdate(&filterChains[ACCEL500HZ_FILTER], sensors.accel500Hz, sensors.accel500Hz);
+
+            MargAHRSupdate(sensors.deltaAngle500Hz,
+                           sensors.accel500Hz[XAXIS], sensors.accel500Hz[YAXIS], sensors.accel500Hz[ZAXIS],
+                           sensors.mag10Hz[XAXIS],    sensors.mag10Hz[YAXIS],    sensors.mag10Hz[ZAXIS],
+                           eepromConfig.accelCutoff,
+                           magDataUpdate,
+                           dt500Hz);
+        #endif
+
+        #if defined(MXR_ACCEL)
+            filterChainUpdate(&filterChains[ACCEL500HZ_FILTER], sensors.accel500HzMXR, sensors.accel500HzMXR);
+
+            MargAHRSupdate(sensors.deltaAngle500Hz,
+                           sensors.accel500HzMXR[XAXIS], sensors.accel500HzMXR[YAXIS], sensors.accel500HzMXR[ZAXIS],
+                           sensors.mag10Hz[XAXIS],       sensors.mag10Hz[YAXIS],       sensors.mag10Hz[ZAXIS],
+                           eepromConfig.accelCutoff,
+                           magDataUpdate,
+                           dt500Hz);
+        #endif
+
+        magDataUpdate = false;
+    }
+
+    updateRcSetpoint();
+
+    computeAxisCommands(dt500Hz);
+
+    if (rateLoop.enabled == false)
+    {
+        mixTable();
+        writeMotors();
+
+        motorLatencyUpdate(sensors.imu500HzTimestamp);
+    }
+
+    writeServos();
+
+    executionTime500Hz = micros() - currentTime;
+
+    #ifdef _DTIMING
+        LA1_DISABLE;
+    #endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Receiver Task, decodes the serial receiver frames in since the last run
+///////////////////////////////////////////////////////////////////////////////
+
+static void taskRx(void)
+{
+    rxUpdate();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 100 Hz Task
+///////////////////////////////////////////////////////////////////////////////
+
+static void task100Hz(void)
+{
+    uint32_t currentTime;
+
+    #ifdef _DTIMING
+        LA3_ENABLE;
+    #endif
+
+    currentTime       = micros();
+    deltaTime100Hz    = currentTime - previous100HzTime;
+    previous100HzTime = currentTime;
+
+    if (newMpu6000Data100Hz == true)
+    {
+        newMpu6000Data100Hz = false;
+
+        sensors.imu100HzTimestamp = mpu6000Summed100Hz.lastSampleTime;
+
+        dt100Hz = timebaseSampleInterval(&previousImu100HzTimestamp, sensors.imu100HzTimestamp, 0.01f);   // For integrations in 100 Hz loop
+
+        scaleSensors100Hz();
+
+        #if defined(MPU_ACCEL)
+            filterChainUpdate(&filterChains[ACCEL100HZ_FILTER], sensors.accel100Hz, sensors.accel100Hz);
+        #endif
+
+        #if defined(MXR_ACCEL)
+            filterChainUpdate(&filterChains[ACCEL100HZ_FILTER], sensors.accel100HzMXR, sensors.accel100HzMXR);
+        #endif
+
+        bodyAccelToEarthAccel();
+        vertCompFilter(dt100Hz);
+    }
+
+    executionTime100Hz = micros() - currentTime;
+
+    #ifdef _DTIMING
+        LA3_DISABLE;
+    #endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 50 Hz Task
+///////////////////////////////////////////////////////////////////////////////
+
+static void task50Hz(void)
+{
+    uint32_t currentTime;
+
+    #ifdef _DTIMING
+        LA2_ENABLE;
+    #endif
+
+    currentTime      = micros();
+    deltaTime50Hz    = currentTime - previous50HzTime;
+    previous50HzTime = currentTime;
+
+    sensors.rxTimestamp = rxFrameTime;
+
+    processFlightCommands();
+
+    if (newTemperatureReading && newPressureReading)
+    {
+        d1Value = d1.value;
+        d2Value = d2.value;
+
+        calculateTemperature();
+        calculatePressureAltitude();
+
+        sensors.pressureAlt50HzTimestamp = pressureSampleTime;
+
+        newTemperatureReading = false;
+        newPressureReading    = false;
+    }
+
+    filterChainUpdate(&filterChains[PRESSURE_ALT50HZ_FILTER], &sensors.pressureAlt50Hz, &sensors.pressureAlt50Hz);
+
+    if (eepromConfig.osdEnabled)
+    {
+        if (eepromConfig.osdDisplayAlt)
+            displayAltitude(sensors.pressureAlt50Hz, 0.0f, DISENGAGED);
+
+        if (eepromConfig.osdDisplayAH)
+            displayArtificialHorizon(getAttitude()[ROLL], getAttitude()[PITCH], flightMode);
+
+        if (eepromConfig.osdDisplayAtt)
+            displayAttitude(getAttitude()[ROLL], getAttitude()[PITCH], flightMode);
+
+        if (eepromConfig.osdDisplayHdg)
+            displayHeading(getHeading()->mag);
+    }
+
+    executionTime50Hz = micros() - currentTime;
+
+    #ifdef _DTIMING
+        LA2_DISABLE;
+    #endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 10 Hz Task
+///////////////////////////////////////////////////////////////////////////////
+
+static void task10Hz(void)
+{
+    uint32_t currentTime;
+
+    #ifdef _DTIMING
+        LA4_ENABLE;
+    #endif
+
+    currentTime      = micros();
+    deltaTime10Hz    = currentTime - previous10HzTime;
+    previous10HzTime = currentTime;
+
+    if (newMagData == true)
+    {
+        sensors.mag10Hz[XAXIS] =   (float)rawMag[XAXIS].value * magScaleFactor[XAXIS] - eepromConfig.magBias[XAXIS];
+        sensors.mag10Hz[YAXIS] =   (float)rawMag[YAXIS].value * magScaleFactor[YAXIS] - eepromConfig.magBias[YAXIS];
+        sensors.mag10Hz[ZAXIS] = -((float)rawMag[ZAXIS].value * magScaleFactor[ZAXIS] - eepromConfig.magBias[ZAXIS]);
+
+        sensors.mag10HzTimestamp = magSampleTime;
+
+        newMagData = false;
+        magDataUpdate = true;
+    }
+
+    switch (eepromConfig.gpsType)
+    {
+            ///////////////////////
+
+        case NO_GPS:                // No GPS installed
+            break;
+
+            ///////////////////////
+
+        case MEDIATEK_3329_BINARY:  // MediaTek 3329 in binary mode
+            decodeMediaTek3329BinaryMsg();
+            break;
+
+            ///////////////////////
+
+        case MEDIATEK_3329_NMEA:    // MediaTek 3329 in NMEA mode
+            decodeNMEAsentence();
+            break;
+
+            ///////////////////////
+
+        case UBLOX:                 // UBLOX in binary mode
+            decodeUbloxMsg();
+            break;
+
+            ///////////////////////
+    }
+
+    cliCom();
+
+    rfCom();
+
+    batMonTick();
+
+    ///////////////////////////
+
+    batMonTick();
+
+    executionTime10Hz = micros() - currentTime;
+
+    #ifdef _DTIMING
+        LA4_DISABLE;
+    #endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 5 Hz Task
+///////////////////////////////////////////////////////////////////////////////
+
+static void task5Hz(void)
+{
+    uint32_t currentTime;
+
+    currentTime     = micros();
+    deltaTime5Hz    = currentTime - previous5HzTime;
+    previous5HzTime = currentTime;
+
+    if (execUp == true)
+        BLUE_LED_TOGGLE;
+
+    executionTime5Hz = micros() - currentTime;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 1 Hz Task
+///////////////////////////////////////////////////////////////////////////////
+
+static void task1Hz(void)
+{
+    uint32_t currentTime;
+
+    currentTime     = micros();
+    deltaTime1Hz    = currentTime - previous1HzTime;
+    previous1HzTime = currentTime;
+
+    if (execUp == true)
+        GREEN_LED_TOGGLE;
+
+    if (execUp == false)
+        execUpCount++;
+
+    if ((execUpCount == 5) && (execUp == false))
+        execUp = true;
+
+    executionTime1Hz = micros() - currentTime;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Task, sends the high speed telemetry streams that are due
+///////////////////////////////////////////////////////////////////////////////
+
+static void taskTelem(void)
+{
+    highSpeedTelemUpdate();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic Notch Task, background, one slice of the peak tracker
+///////////////////////////////////////////////////////////////////////////////
+
+static void taskDynamicNotch(void)
+{
+    dynamicNotchUpdate();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Task Table
+///////////////////////////////////////////////////////////////////////////////
+
+task_t tasks[NUMBER_OF_TASKS] =
+{
+    // Name     Period       Priority  Budget (uSec)  Function
+    { "500Hz",  COUNT_500HZ,  0,        1000,         task500Hz },
+    { "Rx",     COUNT_500HZ,  1,         100,         taskRx    },
+    { "100Hz",  COUNT_100HZ,  2,        2000,         task100Hz },
+    { "50Hz",   COUNT_50HZ,   3,        5000,         task50Hz  },
+    { "10Hz",   COUNT_10HZ,   4,       20000,         task10Hz  },
+    { "5Hz",    COUNT_5HZ,    5,       20000,         task5Hz   },
+    { "1Hz",    COUNT_1HZ,    6,       20000,         task1Hz   },
+    { "Telem",  COUNT_500HZ,  7,         200,         taskTelem },
+    { "Notch",  COUNT_500HZ,  8,         200,         taskDynamicNotch },  // Lowest priority, fills idle time
+};
+
+///////////////////////////////////////////////////////////////////////////////
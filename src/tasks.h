@@ -0,0 +1,64 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Task Timing Pins, logic analyzer outputs while each task runs
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _DTIMING
+
+    #define LA1_ENABLE       GPIO_SetBits(GPIOA,   GPIO_Pin_4)
+    #define LA1_DISABLE      GPIO_ResetBits(GPIOA, GPIO_Pin_4)
+    #define LA4_ENABLE       GPIO_SetBits(GPIOC,   GPIO_Pin_5)
+    #define LA4_DISABLE      GPIO_ResetBits(GPIOC, GPIO_Pin_5)
+    #define LA2_ENABLE       GPIO_SetBits(GPIOC,   GPIO_Pin_2)
+    #define LA2_DISABLE      GPIO_ResetBits(GPIOC, GPIO_Pin_2)
+    #define LA3_ENABLE       GPIO_SetBits(GPIOC,   GPIO_Pin_3)
+    #define LA3_DISABLE      GPIO_ResetBits(GPIOC, GPIO_Pin_3)
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Task Table
+///////////////////////////////////////////////////////////////////////////////
+
+#define NUMBER_OF_TASKS 9
+
+extern task_t tasks[NUMBER_OF_TASKS];
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,242 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Framing for the binary telemetry streams.  Each message goes out as
+//
+//   0xA5 0x5A length id sequence payload[length] crcLow crcHigh
+//
+// with the payload a little endian struct from telemMessages.h and the
+// sequence counting every frame sent, so a receiver can tell how many it
+// lost.  The CRC is CRC-16/CCITT-FALSE, polynomial 0x1021 seeded with
+// 0xFFFF, over the length, id, sequence and payload bytes.
+//
+// CLI replies and EVR lines share the port as plain text.  The parser
+// drops anything that is not a frame with a good CRC, so a reader just
+// sees fewer bytes used.  Nothing in here touches hardware, the host
+// decoders in utils/telemetry build this same file.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "telemFrame.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry CRC
+///////////////////////////////////////////////////////////////////////////////
+
+static const uint16_t crcTable[256] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+///////////////////////////////////////
+
+// Pass 0xFFFF as crc to start, or the last result to carry on.
+
+uint16_t telemCrc16(uint16_t crc, const uint8_t *data, uint16_t length)
+{
+    while (length--)
+        crc = (uint16_t)((crc << 8) ^ crcTable[(uint8_t)((crc >> 8) ^ *data++)]);
+
+    return crc;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Frame Encode
+///////////////////////////////////////////////////////////////////////////////
+
+// Builds the frame in frame, which must hold TELEM_MAX_FRAME bytes.
+// Returns the frame length, 0 for a payload over TELEM_MAX_PAYLOAD.
+
+uint16_t telemFrameEncode(uint8_t *frame, uint8_t id, uint8_t sequence, const void *payload, uint8_t length)
+{
+    uint16_t crc;
+
+    if (length > TELEM_MAX_PAYLOAD)
+        return 0;
+
+    frame[0] = TELEM_SYNC1;
+    frame[1] = TELEM_SYNC2;
+    frame[2] = length;
+    frame[3] = id;
+    frame[4] = sequence;
+
+    memcpy(&frame[TELEM_HEADER_SIZE], payload, length);
+
+    crc = telemCrc16(0xFFFF, &frame[2], (uint16_t)(length + 3));
+
+    frame[TELEM_HEADER_SIZE + length]     = (uint8_t)(crc & 0xFF);
+    frame[TELEM_HEADER_SIZE + length + 1] = (uint8_t)(crc >> 8);
+
+    return (uint16_t)(TELEM_HEADER_SIZE + length + TELEM_CRC_SIZE);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Frame Parser
+///////////////////////////////////////////////////////////////////////////////
+
+void telemParserInit(telemParser_t *parser)
+{
+    memset(parser, 0, sizeof(telemParser_t));
+}
+
+///////////////////////////////////////
+
+static void parserDrop(telemParser_t *parser, uint16_t count)
+{
+    parser->count = (uint16_t)(parser->count - count);
+
+    memmove(parser->buffer, &parser->buffer[count], parser->count);
+}
+
+///////////////////////////////////////
+
+// Call telemParserGet after every byte put, the buffer only holds one
+// frame.
+
+void telemParserPut(telemParser_t *parser, uint8_t data)
+{
+    if (parser->consumed)
+    {
+        parserDrop(parser, parser->consumed);
+        parser->consumed = 0;
+    }
+
+    if (parser->count == sizeof(parser->buffer))
+    {
+        parserDrop(parser, 1);
+        parser->skipped++;
+    }
+
+    parser->buffer[parser->count++] = data;
+}
+
+///////////////////////////////////////
+
+// Returns 1 with the frame in id, sequence, length and payload, which
+// stay good until the next put.  Keep calling until it returns 0, a CRC
+// failure rescans the bytes after the false sync and can turn up more
+// than one frame.
+
+uint8_t telemParserGet(telemParser_t *parser)
+{
+    uint16_t size, crc;
+
+    if (parser->consumed)
+    {
+        parserDrop(parser, parser->consumed);
+        parser->consumed = 0;
+    }
+
+    while (parser->count > 0)
+    {
+        if ((parser->buffer[0] != TELEM_SYNC1) ||
+            ((parser->count > 1) && (parser->buffer[1] != TELEM_SYNC2)) ||
+            ((parser->count > 2) && (parser->buffer[2] > TELEM_MAX_PAYLOAD)))
+        {
+            parserDrop(parser, 1);
+            parser->skipped++;
+            continue;
+        }
+
+        if (parser->count < 3)
+            return 0;
+
+        size = (uint16_t)(TELEM_HEADER_SIZE + parser->buffer[2] + TELEM_CRC_SIZE);
+
+        if (parser->count < size)
+            return 0;
+
+        crc = telemCrc16(0xFFFF, &parser->buffer[2], (uint16_t)(parser->buffer[2] + 3));
+
+        if (crc != (parser->buffer[size - 2] | (parser->buffer[size - 1] << 8)))
+        {
+            parser->crcErrors++;
+            parserDrop(parser, 1);
+            parser->skipped++;
+            continue;
+        }
+
+        if (parser->frames > 0)
+            parser->sequenceGaps += (uint8_t)(parser->buffer[4] - parser->sequence - 1);
+
+        parser->length   = parser->buffer[2];
+        parser->id       = parser->buffer[3];
+        parser->sequence = parser->buffer[4];
+        parser->payload  = &parser->buffer[TELEM_HEADER_SIZE];
+
+        parser->frames++;
+        parser->consumed = size;
+
+        return 1;
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,95 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Frame Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define TELEM_SYNC1          0xA5
+#define TELEM_SYNC2          0x5A
+
+#define TELEM_HEADER_SIZE       5      // Sync, sync, length, id, sequence
+#define TELEM_CRC_SIZE          2      // CRC16 low byte first
+#define TELEM_MAX_PAYLOAD      64
+
+#define TELEM_MAX_FRAME      (TELEM_HEADER_SIZE + TELEM_MAX_PAYLOAD + TELEM_CRC_SIZE)
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry CRC
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t telemCrc16(uint16_t crc, const uint8_t *data, uint16_t length);
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Frame Encode
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t telemFrameEncode(uint8_t *frame, uint8_t id, uint8_t sequence, const void *payload, uint8_t length);
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Frame Parser
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct telemParser_t
+{
+    uint8_t  buffer[TELEM_MAX_FRAME];
+    uint16_t count;                    // Bytes held in buffer
+    uint16_t consumed;                 // Frame handed out by the last telemParserGet, dropped on the next call
+
+    uint8_t  id;                       // Last frame handed out
+    uint8_t  sequence;
+    uint8_t  length;
+    const uint8_t *payload;
+
+    uint32_t frames;                   // Good frames
+    uint32_t crcErrors;                // Complete frames that failed their CRC
+    uint32_t sequenceGaps;             // Frames missing between good frames, by sequence number
+    uint32_t skipped;                  // Bytes dropped while looking for a frame
+} telemParser_t;
+
+void telemParserInit(telemParser_t *parser);
+
+void telemParserPut(telemParser_t *parser, uint8_t data);
+
+uint8_t telemParserGet(telemParser_t *parser);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,188 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Message Table
+///////////////////////////////////////////////////////////////////////////////
+
+// Every binary telemetry message, one line each in TELEM_MESSAGES and a
+// field list under the same name.  The payload structs below, the host
+// decoder in utils/telemetry and its Python reader are all built from
+// this table, so a message is added or changed here and nowhere else.
+//
+//   TELEM_MESSAGE(id, NAME, Name)      id 1 up, consecutive, never reused
+//   TELEM_FIELD(type, name, [count], format)
+//
+// type is float, int32_t, uint32_t, int16_t, uint16_t, uint8_t or char,
+// leave the count out for a single value.  format is how the host tools
+// print the field, the same as the text streams did, char arrays print
+// as one string.
+//
+// Payloads go out in the struct's memory layout, little endian on both
+// the STM32 and the hosts.  Keep each field on its natural alignment so
+// the struct has no padding, the size check below fails the build if it
+// does.  The Python reader reads this file, keep one macro per line.
+//
+// Each message is also a high speed telemetry stream with the id as its
+// stream number, '1' to '9' in the CLI turn on the first nine.
+
+#define TELEM_MESSAGES(TELEM_MESSAGE)                         \
+    TELEM_MESSAGE(0x01, ACCELS,       Accels)                 \
+    TELEM_MESSAGE(0x02, GYROS,        Gyros)                  \
+    TELEM_MESSAGE(0x03, EARTH_ACCELS, EarthAccels)            \
+    TELEM_MESSAGE(0x04, ATTITUDE,     Attitude)               \
+    TELEM_MESSAGE(0x05, VERTICAL,     Vertical)               \
+    TELEM_MESSAGE(0x06, SENSORS,      Sensors)                \
+    TELEM_MESSAGE(0x07, ADC_TEST,     AdcTest)                \
+    TELEM_MESSAGE(0x08, TASK_STATS,   TaskStats)              \
+    TELEM_MESSAGE(0x09, GPS,          Gps)                    \
+    TELEM_MESSAGE(0x0A, RC,           Rc)                     \
+    TELEM_MESSAGE(0x0B, MOTORS,       Motors)
+
+// Stream 1, 500 Hz accels, MPU6000 then MXR9150, m/s^2
+
+#define TELEM_ACCELS_FIELDS(TELEM_FIELD)                      \
+    TELEM_FIELD(float,    accel,          [3], "%9.4f")       \
+    TELEM_FIELD(float,    accelMXR,       [3], "%9.4f")
+
+// Stream 2, 500 Hz gyros, rad/s
+
+#define TELEM_GYROS_FIELDS(TELEM_FIELD)                       \
+    TELEM_FIELD(float,    gyro,           [3], "%9.4f")
+
+// Stream 3, earth axis accels, m/s^2
+
+#define TELEM_EARTH_ACCELS_FIELDS(TELEM_FIELD)                \
+    TELEM_FIELD(float,    accel,          [3], "%9.4f")
+
+// Stream 4, roll, pitch, heading, radians
+
+#define TELEM_ATTITUDE_FIELDS(TELEM_FIELD)                    \
+    TELEM_FIELD(float,    attitude,       [3], "%9.4f")
+
+// Stream 5, vertical channel, m/s^2, m, m/s, m, 0.01 degC
+
+#define TELEM_VERTICAL_FIELDS(TELEM_FIELD)                    \
+    TELEM_FIELD(float,    earthAccelZ,    ,    "%9.4f")       \
+    TELEM_FIELD(float,    pressureAlt,    ,    "%9.4f")       \
+    TELEM_FIELD(float,    hDotEstimate,   ,    "%9.4f")       \
+    TELEM_FIELD(float,    hEstimate,      ,    "%9.4f")       \
+    TELEM_FIELD(int32_t,  temperature,    ,    "%4ld")
+
+// Stream 6, 10 Hz sensors, m/s^2, rad/s, gauss
+
+#define TELEM_SENSORS_FIELDS(TELEM_FIELD)                     \
+    TELEM_FIELD(float,    accel,          [3], "%9.4f")       \
+    TELEM_FIELD(float,    gyro,           [3], "%9.4f")       \
+    TELEM_FIELD(float,    mag,            [3], "%9.4f")
+
+// Stream 7, raw MXR9150 and battery ADC counts
+
+#define TELEM_ADC_TEST_FIELDS(TELEM_FIELD)                    \
+    TELEM_FIELD(uint16_t, mxr,            [3], "%5ld")        \
+    TELEM_FIELD(uint16_t, vbatt,          ,    "%5ld")
+
+// Stream 8, one per scheduler task at 10 Hz, uSec
+
+#define TELEM_TASK_STATS_FIELDS(TELEM_FIELD)                  \
+    TELEM_FIELD(char,     name,           [8], "%s")          \
+    TELEM_FIELD(uint32_t, runCount,       ,    "%ld")         \
+    TELEM_FIELD(uint32_t, overrunCount,   ,    "%ld")         \
+    TELEM_FIELD(uint32_t, skippedCount,   ,    "%ld")         \
+    TELEM_FIELD(uint32_t, executionMean,  ,    "%ld")         \
+    TELEM_FIELD(uint32_t, executionMax,   ,    "%ld")         \
+    TELEM_FIELD(uint32_t, jitterMax,      ,    "%ld")
+
+// Stream 9, GPS solution, radians, m, m/s, radians, s of day, fix as gps.h
+
+#define TELEM_GPS_FIELDS(TELEM_FIELD)                         \
+    TELEM_FIELD(float,    latitude,       ,    "%12.9f")      \
+    TELEM_FIELD(float,    longitude,      ,    "%12.9f")      \
+    TELEM_FIELD(float,    altitude,       ,    "%7.2f")       \
+    TELEM_FIELD(float,    groundSpeed,    ,    "%6.2f")       \
+    TELEM_FIELD(float,    groundTrack,    ,    "%7.4f")       \
+    TELEM_FIELD(float,    time,           ,    "%9.2f")       \
+    TELEM_FIELD(float,    hdop,           ,    "%5.2f")       \
+    TELEM_FIELD(uint32_t, date,           ,    "%6ld")        \
+    TELEM_FIELD(uint16_t, numSats,        ,    "%2ld")        \
+    TELEM_FIELD(uint16_t, fix,            ,    "%ld")
+
+// Stream 10, smoothed roll, pitch and yaw setpoints, then the processed
+// receiver commands, 0.5 uSec counts
+
+#define TELEM_RC_FIELDS(TELEM_FIELD)                          \
+    TELEM_FIELD(float,    setpoint,       [3], "%8.2f")       \
+    TELEM_FIELD(int16_t,  command,        [8], "%5ld")
+
+// Stream 11, motor and servo commands, 0.5 uSec counts
+
+#define TELEM_MOTORS_FIELDS(TELEM_FIELD)                      \
+    TELEM_FIELD(uint16_t, motor,          [8], "%4ld")        \
+    TELEM_FIELD(uint16_t, servo,          [3], "%4ld")
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Message IDs and Payloads, from the table
+///////////////////////////////////////////////////////////////////////////////
+
+#define TELEM_ENUM_ID(id, NAME, Name)        TELEM_##NAME = id,
+
+enum { TELEM_MESSAGES(TELEM_ENUM_ID) };
+
+#define TELEM_ENUM_COUNT(id, NAME, Name)     + 1
+
+#define NUMBER_OF_TELEM_MESSAGES             (0 TELEM_MESSAGES(TELEM_ENUM_COUNT))
+
+#define TELEM_STRUCT_FIELD(type, name, dimension, format) type name dimension;
+
+#define TELEM_STRUCT(id, NAME, Name)         typedef struct telem##Name##_t { TELEM_##NAME##_FIELDS(TELEM_STRUCT_FIELD) } telem##Name##_t;
+
+TELEM_MESSAGES(TELEM_STRUCT)
+
+// Sum of the field sizes, what goes on the wire
+
+#define TELEM_FIELD_SIZE(type, name, dimension, format) + sizeof(type dimension)
+
+#define TELEM_SIZE_CHECK(id, NAME, Name)     typedef char telem##Name##SizeCheck[(sizeof(telem##Name##_t) == (0 TELEM_##NAME##_FIELDS(TELEM_FIELD_SIZE))) ? 1 : -1];
+
+TELEM_MESSAGES(TELEM_SIZE_CHECK)
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,242 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Rate scheduler for the high speed telemetry streams.  Any set of streams
+// can run at once, each at its own rate, inside a bytes per second budget
+// for the link.
+//
+// telemSchedulerPlan() shares the budget out whenever a rate or the budget
+// changes.  Streams that fit their share get their full rate, what they
+// leave over is split evenly between the rest, whose rates are lowered to
+// fit.  A slow stream such as the task statistics keeps its rate when a
+// fast IMU stream asks for more than the link has.
+//
+// telemSchedulerTick() runs at a fixed tick rate and returns the streams
+// to send now.  Each stream adds its granted rate to a phase every tick
+// and is due when the phase passes the tick rate, so a 30 Hz stream on a
+// 500 Hz tick goes every 16 or 17 ticks.  A credit of budget / tickRate
+// bytes a tick, and the room left in the transmit ring, hold a due send
+// back when the link is busy with text, it goes on a later tick instead
+// of overflowing the ring and the stream runs slower for a while.
+//
+// Nothing in here touches hardware, utils/sitl/telemsched checks it.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "telemScheduler.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Scheduler Init
+///////////////////////////////////////////////////////////////////////////////
+
+void telemSchedulerInit(telemScheduler_t *scheduler, uint16_t tickRate, uint32_t budget, uint8_t streams)
+{
+    memset(scheduler, 0, sizeof(telemScheduler_t));
+
+    scheduler->tickRate = tickRate;
+    scheduler->budget   = budget;
+    scheduler->streams  = (streams < TELEM_MAX_STREAMS) ? streams : TELEM_MAX_STREAMS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Scheduler Set Stream
+///////////////////////////////////////////////////////////////////////////////
+
+// Rate 0 turns the stream off.  Rates above the tick rate run at the tick
+// rate.  Streams start spread over one period so equal rates do not all
+// fall on the same tick.
+
+void telemSchedulerSetStream(telemScheduler_t *scheduler, uint8_t stream, uint16_t rate, uint16_t bytes)
+{
+    telemStreamSchedule_t *schedule;
+
+    if (stream >= scheduler->streams)
+        return;
+
+    schedule = &scheduler->stream[stream];
+
+    schedule->rate  = (rate < scheduler->tickRate) ? rate : scheduler->tickRate;
+    schedule->bytes = bytes;
+    schedule->phase = (uint32_t)stream * scheduler->tickRate * 1000 / TELEM_MAX_STREAMS;
+
+    telemSchedulerPlan(scheduler);
+}
+
+///////////////////////////////////////
+
+void telemSchedulerSetBudget(telemScheduler_t *scheduler, uint32_t budget)
+{
+    scheduler->budget = budget;
+
+    telemSchedulerPlan(scheduler);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Scheduler Plan
+///////////////////////////////////////////////////////////////////////////////
+
+// Max-min fair share of the budget in bytes.  Streams are taken cheapest
+// first, each gets what it asks for if that is no more than an even split
+// of what is left, otherwise the even split.
+
+void telemSchedulerPlan(telemScheduler_t *scheduler)
+{
+    telemStreamSchedule_t *schedule;
+    uint8_t  order[TELEM_MAX_STREAMS], active = 0, n, m, left;
+    uint32_t demand, share, remaining, used;
+
+    scheduler->planned = 0;
+
+    for (n = 0; n < scheduler->streams; n++)
+    {
+        schedule = &scheduler->stream[n];
+
+        schedule->granted = 0;
+
+        if ((schedule->rate == 0) || (schedule->bytes == 0))
+            continue;
+
+        demand = (uint32_t)schedule->rate * schedule->bytes;
+
+        // Insertion sort on demand, 16 streams at most
+
+        for (m = active; (m > 0) && ((uint32_t)scheduler->stream[order[m - 1]].rate * scheduler->stream[order[m - 1]].bytes > demand); m--)
+            order[m] = order[m - 1];
+
+        order[m] = n;
+        active++;
+    }
+
+    remaining = scheduler->budget;
+
+    for (n = 0, left = active; n < active; n++, left--)
+    {
+        schedule = &scheduler->stream[order[n]];
+
+        demand = (uint32_t)schedule->rate * schedule->bytes;
+        share  = remaining / left;
+
+        if (demand <= share)
+            schedule->granted = (uint32_t)schedule->rate * 1000;
+        else
+            schedule->granted = (uint32_t)((uint64_t)share * 1000 / schedule->bytes);
+
+        used = (uint32_t)((uint64_t)schedule->granted * schedule->bytes / 1000);
+
+        remaining          -= used;
+        scheduler->planned += used;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Scheduler Tick
+///////////////////////////////////////////////////////////////////////////////
+
+// txFree is the room in the transmit ring.  Returns the streams to send
+// now, bit n for stream n, with their bytes already taken off the credit.
+
+uint32_t telemSchedulerTick(telemScheduler_t *scheduler, uint32_t txFree)
+{
+    telemStreamSchedule_t *schedule;
+    uint32_t due = 0, full, cap;
+    uint8_t  n, stream;
+
+    if (scheduler->streams == 0)
+        return 0;
+
+    full = (uint32_t)scheduler->tickRate * 1000;
+
+    scheduler->credit          += (int32_t)(scheduler->budget / scheduler->tickRate);
+    scheduler->creditRemainder += scheduler->budget % scheduler->tickRate;
+
+    if (scheduler->creditRemainder >= scheduler->tickRate)
+    {
+        scheduler->credit++;
+        scheduler->creditRemainder -= scheduler->tickRate;
+    }
+
+    // Enough saved for the largest send, no more than a burst
+
+    cap = scheduler->budget / TELEM_BURST_DIVISOR;
+
+    for (n = 0; n < scheduler->streams; n++)
+        if ((scheduler->stream[n].granted > 0) && (scheduler->stream[n].bytes > cap))
+            cap = scheduler->stream[n].bytes;
+
+    if (scheduler->credit > (int32_t)cap)
+        scheduler->credit = (int32_t)cap;
+
+    // Served in turn from a different stream each tick, so none is always
+    // the one left waiting
+
+    for (n = 0; n < scheduler->streams; n++)
+    {
+        stream   = (uint8_t)((scheduler->first + n) % scheduler->streams);
+        schedule = &scheduler->stream[stream];
+
+        if (schedule->granted == 0)
+            continue;
+
+        if (schedule->phase < full)
+            schedule->phase += schedule->granted;
+
+        if (schedule->phase < full)
+            continue;
+
+        if ((scheduler->credit >= (int32_t)schedule->bytes) && (txFree >= schedule->bytes))
+        {
+            due |= 1UL << stream;
+
+            schedule->phase   -= full;
+            scheduler->credit -= schedule->bytes;
+            txFree            -= schedule->bytes;
+
+            schedule->sent++;
+        }
+        else
+        {
+            schedule->deferred++;
+        }
+    }
+
+    scheduler->first = (uint8_t)((scheduler->first + 1) % scheduler->streams);
+
+    return due;
+}
+
+///////////////////////////////////////////////////////////////////////////////
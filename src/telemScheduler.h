@@ -0,0 +1,89 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Scheduler Defines
+///////////////////////////////////////////////////////////////////////////////
+
+#define TELEM_MAX_STREAMS      16      // Streams in one scheduler, bits of the due mask
+
+#define TELEM_BURST_DIVISOR    10      // Credit saved up is capped at a tenth of a second of budget
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Scheduler
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct telemStreamSchedule_t
+{
+    uint16_t rate;                     // Sends per second asked for, 0 for off
+    uint16_t bytes;                    // Link bytes one send takes
+    uint32_t granted;                  // Sends per second after the budget, in 1/1000 Hz
+    uint32_t phase;                    // Granted rate summed each tick, due at tickRate * 1000
+    uint32_t sent;
+    uint32_t deferred;                 // Ticks a due send waited for credit or transmit space
+} telemStreamSchedule_t;
+
+typedef struct telemScheduler_t
+{
+    uint16_t tickRate;                 // Hz telemSchedulerTick is called at
+    uint32_t budget;                   // Link bytes per second for every stream together
+    uint32_t planned;                  // Bytes per second the granted rates add up to
+    int32_t  credit;                   // Bytes that may go out now
+    uint32_t creditRemainder;          // budget % tickRate carried between ticks
+    uint8_t  first;                    // Stream served first, turns each tick
+    uint8_t  streams;
+    telemStreamSchedule_t stream[TELEM_MAX_STREAMS];
+} telemScheduler_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+void telemSchedulerInit(telemScheduler_t *scheduler, uint16_t tickRate, uint32_t budget, uint8_t streams);
+
+void telemSchedulerSetStream(telemScheduler_t *scheduler, uint8_t stream, uint16_t rate, uint16_t bytes);
+
+void telemSchedulerSetBudget(telemScheduler_t *scheduler, uint32_t budget);
+
+void telemSchedulerPlan(telemScheduler_t *scheduler);
+
+uint32_t telemSchedulerTick(telemScheduler_t *scheduler, uint32_t txFree);
+
+///////////////////////////////////////////////////////////////////////////////
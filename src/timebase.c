@@ -0,0 +1,117 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+// 64 bit time from the 1 kHz SysTick count plus the DWT cycles since the
+// last tick.  The tick count carries the long term, so the DWT counter
+// only ever spans a few mSec and its 32 bit wrap never shows.  The sub
+// tick cycles are converted with one 32x32->64 multiply instead of a
+// divide.  No hardware access in here, the host build checks the
+// arithmetic.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "timebase.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Timebase Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void timebaseInit(timebase_t *timebase, uint32_t coreClock)
+{
+    uint32_t error;
+
+    timebase->cyclesPerMicro = coreClock / 1000000;
+    timebase->cyclesPerTick  = coreClock / 1000;
+
+    timebase->reciprocal = (uint32_t)((0x100000000ULL + timebase->cyclesPerMicro - 1) / timebase->cyclesPerMicro);
+
+    // floor(n * reciprocal / 2^32) == floor(n / cyclesPerMicro) while n * error < 2^32
+
+    error = (uint32_t)((uint64_t)timebase->reciprocal * timebase->cyclesPerMicro - 0x100000000ULL);
+
+    timebase->exactLimit = (error == 0) ? 0xFFFFFFFF : (uint32_t)(0xFFFFFFFFUL / error);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Timebase Cycles to Microseconds
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t timebaseCyclesToMicros(const timebase_t *timebase, uint32_t cycles)
+{
+    return (uint32_t)(((uint64_t)cycles * timebase->reciprocal) >> 32);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Timebase Microseconds
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t timebaseMicros(const timebase_t *timebase, uint64_t ticks, uint32_t cyclesSinceTick)
+{
+    return ticks * 1000 + timebaseCyclesToMicros(timebase, cyclesSinceTick);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Timebase Cycles
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t timebaseCycles(const timebase_t *timebase, uint64_t ticks, uint32_t cyclesSinceTick)
+{
+    return ticks * timebase->cyclesPerTick + cyclesSinceTick;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Timebase Sample Interval
+///////////////////////////////////////////////////////////////////////////////
+
+// Seconds between two sample timestamps.  Falls back to the nominal
+// interval for the first sample, if no new sample arrived since the last
+// call, or after a gap too long for 32 bits of uSec.
+
+float timebaseSampleInterval(uint64_t *previousTimestamp, uint64_t timestamp, float nominalInterval)
+{
+    float interval = nominalInterval;
+
+    if ((*previousTimestamp != 0) && (timestamp > *previousTimestamp) && (timestamp - *previousTimestamp <= UINT32_MAX))
+        interval = (float)(uint32_t)(timestamp - *previousTimestamp) * 0.000001f;
+
+    if (timestamp > *previousTimestamp)
+        *previousTimestamp = timestamp;
+
+    return interval;
+}
+
+///////////////////////////////////////////////////////////////////////////////
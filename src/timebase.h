@@ -0,0 +1,86 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Timebase Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct timebase_t
+{
+    uint32_t cyclesPerMicro;
+    uint32_t cyclesPerTick;            // 1 mSec SysTick period
+    uint32_t reciprocal;               // ceil(2^32 / cyclesPerMicro)
+    uint32_t exactLimit;               // Largest cycle count converted without error
+} timebase_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// Timebase Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void timebaseInit(timebase_t *timebase, uint32_t coreClock);
+
+///////////////////////////////////////////////////////////////////////////////
+// Timebase Cycles to Microseconds
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t timebaseCyclesToMicros(const timebase_t *timebase, uint32_t cycles);
+
+///////////////////////////////////////////////////////////////////////////////
+// Timebase Microseconds
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t timebaseMicros(const timebase_t *timebase, uint64_t ticks, uint32_t cyclesSinceTick);
+
+///////////////////////////////////////////////////////////////////////////////
+// Timebase Cycles
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t timebaseCycles(const timebase_t *timebase, uint64_t ticks, uint32_t cyclesSinceTick);
+
+///////////////////////////////////////////////////////////////////////////////
+// Timebase Sample Interval
+///////////////////////////////////////////////////////////////////////////////
+
+float timebaseSampleInterval(uint64_t *previousTimestamp, uint64_t timestamp, float nominalInterval);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,330 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+///////////////////////////////////////////////////////////////////////////////
+
+// Transmit ring for the DMA UARTs.  Producers take room in the ring,
+// write into it in place and commit it, the DMA sends it straight out of
+// the ring and frees it when the transfer completes.
+//
+//   txRingReserve()       contiguous room, wraps early to the start of the
+//                         buffer when the end is too short, the bytes
+//                         skipped at the end are not sent
+//   txRingReserveSpans()  room as up to two spans, nothing skipped
+//   txRingCommit()        publishes what was written, starts the DMA
+//   txRingWrite()         copy in, both spans, and commit
+//
+// A write that does not fit is refused whole and counted in dropped and
+// overflows, data not yet sent is never written over.  Room is freed when
+// a transfer completes, not when it starts, so the block going out is
+// never handed to a producer.
+//
+// One producer and the DMA are the two sides.  The producer only moves
+// head and limit, the transfer complete interrupt only moves tail and
+// sending, so neither locks or waits on the other and either can run in
+// an interrupt.  A ring written from more than one context, or from an
+// interrupt above the DMA interrupt's priority, needs the writers to
+// keep out of each other.  One reservation at a time, a new one replaces
+// one not committed.
+//
+// Nothing in here touches hardware, utils/sitl/txring checks it.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "txRing.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Transmit Ring Init
+///////////////////////////////////////////////////////////////////////////////
+
+void txRingInit(txRing_t *ring, uint8_t *buffer, uint16_t size, txRingStart_t start)
+{
+    memset(ring, 0, sizeof(txRing_t));
+
+    ring->buffer = buffer;
+    ring->size   = size;
+    ring->limit  = size;
+    ring->start  = start;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Transmit Ring Producer
+///////////////////////////////////////////////////////////////////////////////
+
+static void txRingRefuse(txRing_t *ring, uint16_t length)
+{
+    ring->reserved = 0;
+
+    ring->dropped += length;
+    ring->overflows++;
+}
+
+///////////////////////////////////////
+
+// length bytes in one piece, NULL when the ring does not have them
+
+uint8_t *txRingReserve(txRing_t *ring, uint16_t length)
+{
+    uint16_t head = ring->head, tail = ring->tail, end;
+    uint16_t at;                       // Where the room starts, size for none
+
+    if (length == 0)
+        return NULL;
+
+    if (head >= tail)
+    {
+        end = (uint16_t)(ring->size - head - ((tail == 0) ? 1 : 0));
+
+        if (length <= end)
+            at = head;
+        else if (length < tail)
+            at = 0;
+        else
+            at = ring->size;
+    }
+    else
+    {
+        at = (length < tail - head) ? head : ring->size;
+    }
+
+    if (at == ring->size)
+    {
+        txRingRefuse(ring, length);
+        return NULL;
+    }
+
+    ring->reservedAt = at;
+    ring->reserved = length;
+
+    return &ring->buffer[ring->reservedAt];
+}
+
+///////////////////////////////////////
+
+// length bytes as the rest of the buffer then its start, returns length
+// or 0 when the ring does not have them
+
+uint16_t txRingReserveSpans(txRing_t *ring, uint16_t length, txRingSpans_t *spans)
+{
+    uint16_t head = ring->head, tail = ring->tail, first;
+
+    if ((length == 0) || (length > txRingFree(ring)))
+    {
+        txRingRefuse(ring, length);
+        return 0;
+    }
+
+    first = (head >= tail) ? (uint16_t)(ring->size - head) : (uint16_t)(tail - head);
+
+    if (first > length)
+        first = length;
+
+    spans->data[0]   = &ring->buffer[head];
+    spans->length[0] = first;
+    spans->data[1]   = ring->buffer;
+    spans->length[1] = (uint16_t)(length - first);
+
+    ring->reserved   = length;
+    ring->reservedAt = head;
+
+    return length;
+}
+
+///////////////////////////////////////
+
+// Publishes the first length bytes of the reservation, less than was
+// reserved is fine, and starts the DMA when it is idle
+
+void txRingCommit(txRing_t *ring, uint16_t length)
+{
+    uint16_t head = ring->head, pending;
+
+    if (length > ring->reserved)
+        length = ring->reserved;
+
+    ring->reserved = 0;
+
+    if (length == 0)
+        return;
+
+    // limit before head, the DMA side reads them the other way round
+
+    if (ring->reservedAt != head)
+    {
+        ring->limit = head;
+        head        = length;
+    }
+    else if (head + length >= ring->size)
+    {
+        ring->limit = ring->size;
+        head        = (uint16_t)(head + length - ring->size);
+    }
+    else
+    {
+        head = (uint16_t)(head + length);
+    }
+
+    ring->head     = head;
+    ring->written += length;
+
+    pending = txRingPending(ring);
+
+    if (pending > ring->peak)
+        ring->peak = pending;
+
+    if (ring->start != NULL)
+        ring->start(ring);
+}
+
+///////////////////////////////////////
+
+uint16_t txRingWrite(txRing_t *ring, const uint8_t *data, uint16_t length)
+{
+    txRingSpans_t spans;
+
+    if (txRingReserveSpans(ring, length, &spans) == 0)
+        return 0;
+
+    memcpy(spans.data[0], data,                   spans.length[0]);
+    memcpy(spans.data[1], &data[spans.length[0]], spans.length[1]);
+
+    txRingCommit(ring, length);
+
+    return length;
+}
+
+///////////////////////////////////////
+
+// Bytes txRingReserveSpans() and txRingWrite() can take now
+
+uint16_t txRingFree(const txRing_t *ring)
+{
+    uint16_t head = ring->head, tail = ring->tail;
+
+    if (head >= tail)
+        return (uint16_t)(ring->size - 1 - (head - tail));
+    else
+        return (uint16_t)(tail - head - 1);
+}
+
+///////////////////////////////////////
+
+// Most bytes txRingReserve() can take now
+
+uint16_t txRingFreeContiguous(const txRing_t *ring)
+{
+    uint16_t head = ring->head, tail = ring->tail, end;
+
+    if (head >= tail)
+    {
+        end = (uint16_t)(ring->size - head - ((tail == 0) ? 1 : 0));
+
+        return ((tail > 0) && (tail - 1 > end)) ? (uint16_t)(tail - 1) : end;
+    }
+    else
+    {
+        return (uint16_t)(tail - head - 1);
+    }
+}
+
+///////////////////////////////////////
+
+// Bytes committed and not yet sent, the transfer under way included
+
+uint16_t txRingPending(const txRing_t *ring)
+{
+    uint16_t head = ring->head, tail = ring->tail;
+
+    if (head >= tail)
+        return (uint16_t)(head - tail);
+    else
+        return (uint16_t)(ring->limit - tail + head);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Transmit Ring Consumer, the DMA side
+///////////////////////////////////////////////////////////////////////////////
+
+// Tail onto the start of the buffer once the lap before head wrapped is
+// all sent
+
+static void txRingWrapTail(txRing_t *ring)
+{
+    uint16_t head = ring->head, tail = ring->tail;
+
+    if ((tail == ring->size) || ((head < tail) && (tail >= ring->limit)))
+        ring->tail = 0;
+}
+
+///////////////////////////////////////
+
+// The next contiguous block to send, 0 when a transfer is under way or
+// there is nothing.  Call txRingSendDone() when it has gone.
+
+uint16_t txRingSendStart(txRing_t *ring, const uint8_t **data)
+{
+    uint16_t head, tail, length;
+
+    if (ring->sending != 0)
+        return 0;
+
+    txRingWrapTail(ring);
+
+    head = ring->head;
+    tail = ring->tail;
+
+    length = (head >= tail) ? (uint16_t)(head - tail) : (uint16_t)(ring->limit - tail);
+
+    if (length == 0)
+        return 0;
+
+    ring->sending = length;
+
+    *data = &ring->buffer[tail];
+
+    return length;
+}
+
+///////////////////////////////////////
+
+void txRingSendDone(txRing_t *ring)
+{
+    ring->tail    = (uint16_t)(ring->tail + ring->sending);
+    ring->sending = 0;
+
+    txRingWrapTail(ring);
+}
+
+///////////////////////////////////////////////////////////////////////////////
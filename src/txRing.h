@@ -0,0 +1,105 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Transmit Ring
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct txRing_t txRing_t;
+
+typedef void (*txRingStart_t)(txRing_t *ring);
+
+struct txRing_t
+{
+    uint8_t           *buffer;
+    uint16_t          size;
+    volatile uint16_t head;            // Next byte the producer fills, producer only
+    volatile uint16_t tail;            // First byte not yet sent, consumer only
+    volatile uint16_t limit;           // End of the data on the lap before head wrapped, producer only
+    volatile uint16_t sending;         // Bytes from tail in the DMA transfer under way
+    uint16_t          reserved;        // Bytes reserved and not yet committed
+    uint16_t          reservedAt;      // Where they start, 0 when the reservation wrapped early
+    txRingStart_t     start;           // Starts the DMA on the next block, from commit and the TC interrupt
+    uint32_t          written;         // Bytes committed
+    uint32_t          dropped;         // Bytes refused for lack of room
+    uint32_t          overflows;       // Writes refused for lack of room
+    uint16_t          peak;            // Most bytes waiting to go
+};
+
+typedef struct txRingSpans_t
+{
+    uint8_t  *data[2];
+    uint16_t length[2];
+} txRingSpans_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// Transmit Ring Init
+///////////////////////////////////////////////////////////////////////////////
+
+void txRingInit(txRing_t *ring, uint8_t *buffer, uint16_t size, txRingStart_t start);
+
+///////////////////////////////////////////////////////////////////////////////
+// Transmit Ring Producer
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t *txRingReserve(txRing_t *ring, uint16_t length);
+
+uint16_t txRingReserveSpans(txRing_t *ring, uint16_t length, txRingSpans_t *spans);
+
+void txRingCommit(txRing_t *ring, uint16_t length);
+
+uint16_t txRingWrite(txRing_t *ring, const uint8_t *data, uint16_t length);
+
+uint16_t txRingFree(const txRing_t *ring);
+
+uint16_t txRingFreeContiguous(const txRing_t *ring);
+
+uint16_t txRingPending(const txRing_t *ring);
+
+///////////////////////////////////////////////////////////////////////////////
+// Transmit Ring Consumer, the DMA side
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t txRingSendStart(txRing_t *ring, const uint8_t **data);
+
+void txRingSendDone(txRing_t *ring);
+
+///////////////////////////////////////////////////////////////////////////////
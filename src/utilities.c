@@ -50,47 +50,6 @@ float constrain(float input, float minValue, float maxValue)
         return input;
 }
 
-///////////////////////////////////////////////////////////////////////////////
-// _sbrk
-///////////////////////////////////////////////////////////////////////////////
-
-/*
- * newlib_stubs.c
- *
- *  Created on: 2 Nov 2010
- *      Author: nanoage.co.uk
- */
-
-/*
- sbrk
- Increase program data space.
- Malloc and related functions depend on this
- */
-
-caddr_t _sbrk(int incr)
-{
-    extern char _ebss; // Defined by the linker
-    static char *heap_end;
-    char *prev_heap_end;
-
-    char * stack;
-
-    if (heap_end == 0)
-        heap_end = &_ebss;
-
-    prev_heap_end = heap_end;
-
-    stack = (char*) __get_MSP();
-    if (heap_end + incr >  stack)
-    {
-        errno = ENOMEM;
-        return  (caddr_t) -1;
-    }
-
-    heap_end += incr;
-    return (caddr_t) prev_heap_end;
-}
-
 ///////////////////////////////////////////////////////////////////////////////
 //  Least Squares Fit a Sphere to 3D Data
 ////////////////////////////////////////////////////////////////////////////////
@@ -37,29 +37,20 @@
 #pragma once
 
 ///////////////////////////////////////////////////////////////////////////////
-// Constrain
+// Compiler Barrier
 ///////////////////////////////////////////////////////////////////////////////
 
-float constrain(float input, float minValue, float maxValue);
+// Keeps the compiler from moving memory accesses across it.  Enough to
+// hand data to an interrupt on this single core, the M4 does not reorder
+// its own stores as seen by its own interrupts.
+
+#define COMPILER_BARRIER()  __asm__ volatile ("" ::: "memory")
 
 ///////////////////////////////////////////////////////////////////////////////
-// _sbrk
+// Constrain
 ///////////////////////////////////////////////////////////////////////////////
 
-/*
- * newlib_stubs.c
- *
- *  Created on: 2 Nov 2010
- *      Author: nanoage.co.uk
- */
-
-/*
- sbrk
- Increase program data space.
- Malloc and related functions depend on this
- */
-
-caddr_t _sbrk(int incr);
+float constrain(float input, float minValue, float maxValue);
 
 ///////////////////////////////////////////////////////////////////////////////
 //  Least Squares Fit a Sphere to 3D Data
@@ -40,37 +40,54 @@
 // Vertical Complementary Filter Defines and Variables
 ///////////////////////////////////////////////////////////////////////////////
 
-float   accelZ;
-float   estimationError = 0.0f;
-float   hDotEstimate    = 0.0f;
-float   hEstimate;
-uint8_t previousExecUp  = false;
+vertCompFilter_t vertComp;
 
 ///////////////////////////////////////////////////////////////////////////////
-// Vertical Complementary Filter
+// Vertical Complementary Filter Reset
 ///////////////////////////////////////////////////////////////////////////////
 
-void vertCompFilter(float dt)
+void vertCompFilterReset(vertCompFilter_t *filter)
+{
+    filter->accelZ          = 0.0f;
+    filter->estimationError = 0.0f;
+    filter->hDotEstimate    = 0.0f;
+    filter->hEstimate       = 0.0f;
+    filter->previousExecUp  = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Vertical Complementary Filter, any instance
+///////////////////////////////////////////////////////////////////////////////
+
+void vertCompFilterUpdate(vertCompFilter_t *filter, float earthAccelZ, float pressureAlt, uint8_t execUp, float dt)
 {
-    if ((execUp == true) && (previousExecUp == false))
-    	hEstimate = sensors.pressureAlt50Hz;
+    if ((execUp == true) && (filter->previousExecUp == false))
+    	filter->hEstimate = pressureAlt;
 
-    previousExecUp = execUp;
+    filter->previousExecUp = execUp;
 
 	if (execUp == true)
     {
-    	accelZ = -earthAxisAccels[ZAXIS] + eepromConfig.compFilterB * estimationError;
+    	filter->accelZ = -earthAccelZ + filter->compFilterB * filter->estimationError;
 
-        hDotEstimate += accelZ * dt;
+        filter->hDotEstimate += filter->accelZ * dt;
 
-        hEstimate += (hDotEstimate + eepromConfig.compFilterA * estimationError) * dt;
+        filter->hEstimate += (filter->hDotEstimate + filter->compFilterA * filter->estimationError) * dt;
 
-        estimationError = sensors.pressureAlt50Hz - hEstimate;
+        filter->estimationError = pressureAlt - filter->hEstimate;
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Vertical Complementary Filter, flight code instance
 ///////////////////////////////////////////////////////////////////////////////
 
+void vertCompFilter(float dt)
+{
+    vertComp.compFilterA = eepromConfig.compFilterA;
+    vertComp.compFilterB = eepromConfig.compFilterB;
 
+    vertCompFilterUpdate(&vertComp, earthAxisAccels[ZAXIS], sensors.pressureAlt50Hz, execUp, dt);
+}
 
-
+///////////////////////////////////////////////////////////////////////////////
@@ -40,13 +40,33 @@
 // Vertical Complementary Filter Defines and Variables
 ///////////////////////////////////////////////////////////////////////////////
 
-extern float accelZ;
-extern float estimationError;
-extern float hDotEstimate;
-extern float hEstimate;
+typedef struct vertCompFilter_t
+{
+    float   compFilterA;
+    float   compFilterB;
+    float   accelZ;
+    float   estimationError;
+    float   hDotEstimate;
+    float   hEstimate;
+    uint8_t previousExecUp;
+} vertCompFilter_t;
+
+extern vertCompFilter_t vertComp;
 
 ///////////////////////////////////////////////////////////////////////////////
-// Vertical Complementary Filter
+// Vertical Complementary Filter Reset
+///////////////////////////////////////////////////////////////////////////////
+
+void vertCompFilterReset(vertCompFilter_t *filter);
+
+///////////////////////////////////////////////////////////////////////////////
+// Vertical Complementary Filter, any instance
+///////////////////////////////////////////////////////////////////////////////
+
+void vertCompFilterUpdate(vertCompFilter_t *filter, float earthAccelZ, float pressureAlt, uint8_t execUp, float dt);
+
+///////////////////////////////////////////////////////////////////////////////
+// Vertical Complementary Filter, flight code instance
 ///////////////////////////////////////////////////////////////////////////////
 
 void vertCompFilter(float dt);
@@ -0,0 +1,116 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Single producer, single consumer ring of deferred work.  One interrupt
+// level posts, a lower one runs the items, so neither side ever needs to
+// mask interrupts.  Indices are free running and wrap at 256, the
+// power of 2 size keeps the masking exact across the wrap.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "workQueue.h"
+#include "utilities.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define WORK_QUEUE_MASK     (WORK_QUEUE_SIZE - 1)
+
+///////////////////////////////////////////////////////////////////////////////
+// Work Queue Post
+///////////////////////////////////////////////////////////////////////////////
+
+bool workQueuePost(workQueue_t *queue, workFunction_t function, uint32_t argument)
+{
+    uint8_t head  = queue->head;
+    uint8_t depth = (uint8_t)(head - queue->tail);
+
+    if (depth >= WORK_QUEUE_SIZE)
+    {
+        queue->droppedCount++;
+        return false;
+    }
+
+    queue->items[head & WORK_QUEUE_MASK].function = function;
+    queue->items[head & WORK_QUEUE_MASK].argument = argument;
+
+    COMPILER_BARRIER();                // Item must be complete before it is published
+
+    queue->head = head + 1;
+
+    if (depth + 1 > queue->maxDepth)
+        queue->maxDepth = depth + 1;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Work Queue Run
+//
+// Runs the oldest item, returns false if the queue was empty.
+///////////////////////////////////////////////////////////////////////////////
+
+bool workQueueRun(workQueue_t *queue)
+{
+    uint8_t    tail = queue->tail;
+    workItem_t item;
+
+    if (tail == queue->head)
+        return false;
+
+    COMPILER_BARRIER();
+
+    item = queue->items[tail & WORK_QUEUE_MASK];
+
+    COMPILER_BARRIER();                // Copy out before the slot is handed back
+
+    queue->tail = tail + 1;
+
+    item.function(item.argument);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Work Queue Depth
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t workQueueDepth(workQueue_t *queue)
+{
+    return (uint8_t)(queue->head - queue->tail);
+}
+
+///////////////////////////////////////////////////////////////////////////////
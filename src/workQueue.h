@@ -0,0 +1,90 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Work Queue Defines
+///////////////////////////////////////////////////////////////////////////////
+
+#define WORK_QUEUE_SIZE  16            // Power of 2, 128 max
+
+///////////////////////////////////////////////////////////////////////////////
+// Work Queue Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+typedef void (*workFunction_t)(uint32_t argument);
+
+typedef struct workItem_t
+{
+    workFunction_t function;
+    uint32_t       argument;
+} workItem_t;
+
+typedef struct workQueue_t
+{
+    workItem_t        items[WORK_QUEUE_SIZE];
+    volatile uint8_t  head;            // Written by the posting interrupt only
+    volatile uint8_t  tail;            // Written by the running interrupt only
+    uint8_t           maxDepth;
+    uint32_t          droppedCount;
+} workQueue_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// Work Queue Post
+///////////////////////////////////////////////////////////////////////////////
+
+bool workQueuePost(workQueue_t *queue, workFunction_t function, uint32_t argument);
+
+///////////////////////////////////////////////////////////////////////////////
+// Work Queue Run
+///////////////////////////////////////////////////////////////////////////////
+
+bool workQueueRun(workQueue_t *queue);
+
+///////////////////////////////////////////////////////////////////////////////
+// Work Queue Depth
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t workQueueDepth(workQueue_t *queue);
+
+///////////////////////////////////////////////////////////////////////////////
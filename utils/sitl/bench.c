@@ -0,0 +1,922 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Host micro-benchmarks for the 500 Hz chain.  Replays a recording made by
+// "sitl -r" through the same flight code the board runs and times each
+// stage on its own:
+//
+//   scaling       computeMPU6000TCBias() and scaleSensors500Hz()
+//   filter        dynamicNotchFilter() and the gyro and accel filter chains
+//   ahrs          MargAHRSupdate()
+//   ekf           MargAHRSupdate() with the attitude EKF selected
+//   axisCommands  computeAxisCommands(), the attitude and rate PIDs
+//   pidLegacy     the three rate PIDs as updatePID() ran them with the state
+//                 inside eepromConfig.PID[], kept here for comparison
+//   ratePIDs      the three rate PIDs through updateRatePIDs()
+//   mixer         mixTable() and writeMotors()
+//   rateLoop      rateLoopUpdate(), one gyro sample through the decoupled
+//                 rate loop, gyro filters, rate PIDs, mixer and motors
+//   chain         all of the above in task500Hz() order
+//   dshot         DShot600 frames and DMA buffers for all eight outputs from
+//                 the chain's motor commands, pwmEscWrite() with DShot
+//
+// A reference pass runs the whole chain once and keeps every stage's
+// inputs, so each stage is fed exactly what it sees in flight.  Every stage
+// restarts from power up state on each repetition and the fastest
+// repetition is reported, which keeps scheduler noise out of the numbers.
+// Instruction counts come from the Linux perf counters when the kernel
+// allows them.  The checksum is an FNV-1a hash over the stage outputs of
+// the first repetition, any change in floating point results shows up
+// there even when the flight is unchanged to the eye.
+//
+// pidLegacy and ratePIDs are fed the same rate commands, matching checksums
+// show the two paths give the same outputs.  rateLoop runs once per record
+// on the mean of its samples, the board runs it once per sample, twice
+// for every 500 Hz chain.
+//
+// Usage: bench -i vectors [-n repeats] [-o file] [-c baseline]
+//
+//   -i  Recording from "sitl -r"
+//   -n  Repetitions per stage, default 20
+//   -o  Results file, CSV, default bench.csv
+//   -c  Results file from an earlier build to compare against
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <getopt.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "board.h"
+
+#include "sitlHal.h"
+#include "sitlRecord.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define BENCH_STAGES     11
+#define BENCH_MAX_MOTORS 8
+
+float dt500Hz, dt100Hz;
+
+///////////////////////////////////////
+
+// Flight code state not declared in its headers
+
+extern float   headingReference;
+extern uint8_t previousHeadingHoldEngaged;
+extern float   rateCmd[3];
+extern float   rc;
+
+///////////////////////////////////////
+
+typedef struct benchInput_t
+{
+    float   dt;
+    float   accel[3];          // Scaled, before the lowpass
+    float   accelFiltered[3];
+    float   gyro[3];
+    float   gyroFiltered[3];
+    float   deltaAngle[3];
+    float   quaternion[4];     // Euler angles are derived from it on demand
+    uint8_t ahrsInitialized;
+    float   rateCmd[3];
+    float   axisPID[3];
+    float   motor[BENCH_MAX_MOTORS];
+} benchInput_t;
+
+// PIDdata_t and updatePID() before the state moved out of eepromConfig
+
+typedef struct legacyPIDdata_t
+{
+    float   B, P, I, D;
+    float   iTerm;
+    float   windupGuard;
+    float   lastDcalcValue;
+    float   lastDterm;
+    float   lastLastDterm;
+    uint8_t dErrorCalc;
+    uint8_t type;
+} legacyPIDdata_t;
+
+typedef struct benchResult_t
+{
+    const char *name;
+    double      nsPerCall;
+    double      instructionsPerCall;  // Negative when counters are unavailable
+    uint32_t    checksum;
+} benchResult_t;
+
+///////////////////////////////////////
+
+static sitlRecord_t   *records;
+static benchInput_t   *inputs;
+static uint32_t       recordCount;
+
+static eepromConfig_t powerUpConfig;
+
+static legacyPIDdata_t legacyPID[3];
+
+static int            perfFd = -1;
+
+///////////////////////////////////////////////////////////////////////////////
+// Checksum
+///////////////////////////////////////////////////////////////////////////////
+
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t length)
+{
+    const uint8_t *bytes = data;
+
+    while (length--)
+    {
+        hash ^= *bytes++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Instruction Counter
+///////////////////////////////////////////////////////////////////////////////
+
+static void perfOpen(void)
+{
+    #ifdef __linux__
+        struct perf_event_attr attr;
+
+        memset(&attr, 0, sizeof(attr));
+
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof(attr);
+        attr.config         = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+
+        perfFd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    #endif
+}
+
+///////////////////////////////////////
+
+static void perfStart(void)
+{
+    #ifdef __linux__
+        if (perfFd >= 0)
+        {
+            ioctl(perfFd, PERF_EVENT_IOC_RESET,  0);
+            ioctl(perfFd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    #endif
+}
+
+///////////////////////////////////////
+
+static int64_t perfStop(void)
+{
+    #ifdef __linux__
+        uint64_t count;
+
+        if (perfFd >= 0)
+        {
+            ioctl(perfFd, PERF_EVENT_IOC_DISABLE, 0);
+
+            if (read(perfFd, &count, sizeof(count)) == sizeof(count))
+                return (int64_t)count;
+        }
+    #endif
+
+    return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Power Up State
+///////////////////////////////////////////////////////////////////////////////
+
+static void resetFlightCode(void)
+{
+    uint8_t axis;
+
+    eepromConfig = powerUpConfig;   // stageEKF() switches the estimator
+
+    filterBankInit();
+    dynamicNotchInit();
+    initPID();
+    rateLoopInit();
+    MargAHRSreset(&margAHRS);
+    attitudeEKFreset(&attitudeEKF);
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        memset(&legacyPID[axis], 0, sizeof(legacyPID[axis]));
+
+        legacyPID[axis].B           = eepromConfig.PID[ROLL_RATE_PID + axis].B;
+        legacyPID[axis].P           = eepromConfig.PID[ROLL_RATE_PID + axis].P;
+        legacyPID[axis].I           = eepromConfig.PID[ROLL_RATE_PID + axis].I;
+        legacyPID[axis].D           = eepromConfig.PID[ROLL_RATE_PID + axis].D;
+        legacyPID[axis].windupGuard = eepromConfig.PID[ROLL_RATE_PID + axis].windupGuard;
+        legacyPID[axis].dErrorCalc  = eepromConfig.PID[ROLL_RATE_PID + axis].dErrorCalc;
+        legacyPID[axis].type        = eepromConfig.PID[ROLL_RATE_PID + axis].type;
+    }
+
+    previousHeadingHoldEngaged = false;
+    headingReference           = 0.0f;
+
+    memset(&sensors, 0, sizeof(sensors));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Stage Inputs
+///////////////////////////////////////////////////////////////////////////////
+
+static void loadRecord(const sitlRecord_t *record)
+{
+    mpu6000Summed500Hz = record->summed500Hz;
+
+    memcpy(accelSummedSamples500HzMXR, record->accelSummedMXR, sizeof(record->accelSummedMXR));
+    memcpy(sensors.mag10Hz,            record->mag,            sizeof(record->mag));
+    memcpy(rxCommand,                  record->rxCommand,      sizeof(record->rxCommand));
+    memcpy(rcSetpoint,                 record->rxCommand,      sizeof(rcSetpoint));  // As flown, smoothing off
+
+    magDataUpdate      = record->magDataUpdate;
+    flightMode         = record->flightMode;
+    headingHoldEngaged = record->headingHoldEngaged;
+    holdIntegrators    = record->holdIntegrators;
+    armed              = record->armed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Stages
+///////////////////////////////////////////////////////////////////////////////
+
+static uint32_t stageScaling(uint32_t i, uint32_t hash)
+{
+    loadRecord(&records[i]);
+
+    computeMPU6000TCBias();
+    scaleSensors500Hz(inputs[i].dt);
+
+    if (hash != 0)
+    {
+        hash = fnv1a(hash, sensors.accel500Hz,      sizeof(sensors.accel500Hz));
+        hash = fnv1a(hash, sensors.accel500HzMXR,   sizeof(sensors.accel500HzMXR));
+        hash = fnv1a(hash, sensors.gyro500Hz,       sizeof(sensors.gyro500Hz));
+        hash = fnv1a(hash, sensors.deltaAngle500Hz, sizeof(sensors.deltaAngle500Hz));
+    }
+
+    return hash;
+}
+
+///////////////////////////////////////
+
+static uint32_t stageFilter(uint32_t i, uint32_t hash)
+{
+    memcpy(sensors.gyro500Hz, inputs[i].gyro, sizeof(sensors.gyro500Hz));
+
+    dynamicNotchFilter(sensors.gyro500Hz);
+    filterChainUpdate(&filterChains[GYRO500HZ_FILTER],  sensors.gyro500Hz, sensors.gyro500Hz);
+    filterChainUpdate(&filterChains[ACCEL500HZ_FILTER], inputs[i].accel,   sensors.accel500Hz);
+
+    if (hash != 0)
+    {
+        hash = fnv1a(hash, sensors.gyro500Hz,  sizeof(sensors.gyro500Hz));
+        hash = fnv1a(hash, sensors.accel500Hz, sizeof(sensors.accel500Hz));
+    }
+
+    return hash;
+}
+
+///////////////////////////////////////
+
+static uint32_t stageAHRS(uint32_t i, uint32_t hash)
+{
+    const benchInput_t *input = &inputs[i];
+    const sitlRecord_t *record = &records[i];
+
+    MargAHRSupdate(input->deltaAngle,
+                   input->accelFiltered[XAXIS], input->accelFiltered[YAXIS], input->accelFiltered[ZAXIS],
+                   record->mag[XAXIS],          record->mag[YAXIS],          record->mag[ZAXIS],
+                   powerUpConfig.accelCutoff,
+                   record->magDataUpdate,
+                   input->dt);
+
+    if (hash != 0)
+    {
+        hash = fnv1a(hash, getAttitude(),     sizeof(float) * 3);
+        hash = fnv1a(hash, &getHeading()->mag, sizeof(float));
+    }
+
+    return hash;
+}
+
+///////////////////////////////////////
+
+static uint32_t stageEKF(uint32_t i, uint32_t hash)
+{
+    eepromConfig.attitudeEstimator = ATTITUDE_EKF;
+
+    return stageAHRS(i, hash);
+}
+
+///////////////////////////////////////
+
+static uint32_t stageAxisCommands(uint32_t i, uint32_t hash)
+{
+    const benchInput_t *input = &inputs[i];
+    const sitlRecord_t *record = &records[i];
+
+    memcpy(rxCommand,         record->rxCommand,   sizeof(record->rxCommand));
+    memcpy(rcSetpoint,        record->rxCommand,   sizeof(rcSetpoint));
+    memcpy(sensors.gyro500Hz, input->gyroFiltered, sizeof(input->gyroFiltered));
+
+    MargAHRSsetQuaternion(&margAHRS, input->quaternion);
+
+    margAHRS.initialized = input->ahrsInitialized;
+
+    flightMode         = record->flightMode;
+    headingHoldEngaged = record->headingHoldEngaged;
+    holdIntegrators    = record->holdIntegrators;
+
+    computeAxisCommands(input->dt);
+
+    if (hash != 0)
+        hash = fnv1a(hash, axisPID, sizeof(axisPID));
+
+    return hash;
+}
+
+///////////////////////////////////////
+
+static float legacyUpdatePID(float command, float state, float deltaT, uint8_t iHold, legacyPIDdata_t *PIDparameters)
+{
+    float error;
+    float dTerm;
+    float dTermFiltered;
+    float dAverage;
+
+    error = command - state;
+
+    if (PIDparameters->type == ANGULAR)
+        error = standardRadianFormat(error);
+
+    if (iHold == false)
+    {
+        PIDparameters->iTerm += error * deltaT;
+        PIDparameters->iTerm = constrain(PIDparameters->iTerm, -PIDparameters->windupGuard, PIDparameters->windupGuard);
+    }
+
+    if (PIDparameters->dErrorCalc == D_ERROR)
+    {
+        dTerm = (error - PIDparameters->lastDcalcValue) / deltaT;
+        PIDparameters->lastDcalcValue = error;
+    }
+    else
+    {
+        dTerm = (PIDparameters->lastDcalcValue - state) / deltaT;
+
+        if (PIDparameters->type == ANGULAR)
+            dTerm = standardRadianFormat(dTerm);
+
+        PIDparameters->lastDcalcValue = state;
+    }
+
+    dTermFiltered = PIDparameters->lastDterm + deltaT / (rc + deltaT) * (dTerm - PIDparameters->lastDterm);
+
+    dAverage = (dTermFiltered + PIDparameters->lastDterm + PIDparameters->lastLastDterm) * 0.333333f;
+
+    PIDparameters->lastLastDterm = PIDparameters->lastDterm;
+    PIDparameters->lastDterm = dTermFiltered;
+
+    if (PIDparameters->type == ANGULAR)
+        return(PIDparameters->P * error                +
+               PIDparameters->I * PIDparameters->iTerm +
+               PIDparameters->D * dAverage);
+    else
+        return(PIDparameters->P * PIDparameters->B * command +
+               PIDparameters->I * PIDparameters->iTerm       +
+               PIDparameters->D * dAverage                   -
+               PIDparameters->P * state);
+}
+
+///////////////////////////////////////
+
+static uint32_t stagePIDlegacy(uint32_t i, uint32_t hash)
+{
+    const benchInput_t *input = &inputs[i];
+    const sitlRecord_t *record = &records[i];
+
+    axisPID[ROLL ] = legacyUpdatePID(input->rateCmd[ROLL ],  input->gyroFiltered[ROLL ], input->dt, record->holdIntegrators, &legacyPID[ROLL ]);
+    axisPID[PITCH] = legacyUpdatePID(input->rateCmd[PITCH], -input->gyroFiltered[PITCH], input->dt, record->holdIntegrators, &legacyPID[PITCH]);
+    axisPID[YAW  ] = legacyUpdatePID(input->rateCmd[YAW  ],  input->gyroFiltered[YAW  ], input->dt, record->holdIntegrators, &legacyPID[YAW  ]);
+
+    if (hash != 0)
+        hash = fnv1a(hash, axisPID, sizeof(axisPID));
+
+    return hash;
+}
+
+///////////////////////////////////////
+
+static uint32_t stageRatePIDs(uint32_t i, uint32_t hash)
+{
+    const benchInput_t *input = &inputs[i];
+    float              state[3];
+
+    state[ROLL ] =  input->gyroFiltered[ROLL ];
+    state[PITCH] = -input->gyroFiltered[PITCH];
+    state[YAW  ] =  input->gyroFiltered[YAW  ];
+
+    updateRatePIDs(input->rateCmd, state, input->dt, records[i].holdIntegrators, axisPID);
+
+    if (hash != 0)
+        hash = fnv1a(hash, axisPID, sizeof(axisPID));
+
+    return hash;
+}
+
+///////////////////////////////////////
+
+static uint32_t stageMixer(uint32_t i, uint32_t hash)
+{
+    memcpy(axisPID,   inputs[i].axisPID,    sizeof(axisPID));
+    memcpy(rxCommand, records[i].rxCommand, sizeof(records[i].rxCommand));
+
+    flightMode = records[i].flightMode;
+    armed      = records[i].armed;
+
+    mixTable();
+    writeMotors();
+
+    if (hash != 0)
+        hash = fnv1a(hash, motor, sizeof(float) * numberMotor);
+
+    return hash;
+}
+
+///////////////////////////////////////
+
+// The DMA interrupt's call with rateLoopEnabled, fed the rate commands the
+// 500 Hz loop published for this record
+
+static uint32_t stageRateLoop(uint32_t i, uint32_t hash)
+{
+    const sitlRecord_t *record = &records[i];
+    mpu6000Sample_t    sample;
+    uint8_t            axis;
+
+    if (i == 0)
+    {
+        eepromConfig.rateLoopEnabled = true;
+
+        filterBankInitChain(GYRO500HZ_FILTER);
+        dynamicNotchInit();
+        rateLoopInit();
+    }
+
+    memcpy(rxCommand, record->rxCommand, sizeof(record->rxCommand));
+
+    flightMode = record->flightMode;
+    armed      = record->armed;
+
+    for (axis = 0; axis < 3; axis++)
+        sample.gyro[axis] = (int16_t)(record->summed500Hz.gyro[axis] / record->summed500Hz.samples);
+
+    sample.time = record->summed500Hz.lastSampleTime;
+
+    rateLoopSetpoint(inputs[i].rateCmd, record->holdIntegrators);
+    rateLoopUpdate(&sample);
+
+    if (hash != 0)
+        hash = fnv1a(hash, motor, sizeof(float) * numberMotor);
+
+    return hash;
+}
+
+///////////////////////////////////////
+
+// task500Hz() from tasks.c without the timing and logic analyzer lines
+
+static uint32_t stageChain(uint32_t i, uint32_t hash)
+{
+    static uint64_t previousTimestamp;
+
+    if (i == 0)
+        previousTimestamp = 0;
+
+    loadRecord(&records[i]);
+
+    sensors.imu500HzTimestamp = mpu6000Summed500Hz.lastSampleTime;
+
+    dt500Hz = timebaseSampleInterval(&previousTimestamp, sensors.imu500HzTimestamp, 0.002f);
+
+    computeMPU6000TCBias();
+    scaleSensors500Hz(dt500Hz);
+
+    dynamicNotchFilter(sensors.gyro500Hz);
+    filterChainUpdate(&filterChains[GYRO500HZ_FILTER],  sensors.gyro500Hz,  sensors.gyro500Hz);
+    filterChainUpdate(&filterChains[ACCEL500HZ_FILTER], sensors.accel500Hz, sensors.accel500Hz);
+
+    MargAHRSupdate(sensors.deltaAngle500Hz,
+                   sensors.accel500Hz[XAXIS], sensors.accel500Hz[YAXIS], sensors.accel500Hz[ZAXIS],
+                   sensors.mag10Hz[XAXIS],    sensors.mag10Hz[YAXIS],    sensors.mag10Hz[ZAXIS],
+                   eepromConfig.accelCutoff,
+                   magDataUpdate,
+                   dt500Hz);
+
+    magDataUpdate = false;
+
+    computeAxisCommands(dt500Hz);
+    mixTable();
+    writeMotors();
+
+    if (hash != 0)
+        hash = fnv1a(hash, motor, sizeof(float) * numberMotor);
+
+    return hash;
+}
+
+///////////////////////////////////////
+
+// What drv_pwmEsc.c does for each output in DShot mode before the DMA
+// trigger.  All eight outputs are encoded whatever the airframe, the
+// transmission itself is three DMA stream starts on the board.
+
+static escTiming_t dshotTiming;
+static uint8_t     dshotChannels[NUMBER_OF_ESC_TIMERS];
+static uint32_t    dshotBuffer[NUMBER_OF_ESC_TIMERS][DSHOT_BUFFER_BITS * DSHOT_MAX_CHANNELS];
+
+static uint32_t stageDshot(uint32_t i, uint32_t hash)
+{
+    uint8_t output, timer;
+
+    for (output = 0; output < BENCH_MAX_MOTORS; output++)
+    {
+        timer = escOutputs[output].timer;
+
+        dshotEncode(&dshotBuffer[timer][escOutputs[output].channel - 1], dshotChannels[timer],
+                    dshotFrame(dshotValue((uint16_t)inputs[i].motor[output]), false), &dshotTiming.dshot);
+    }
+
+    if (hash != 0)
+        hash = fnv1a(hash, dshotBuffer, sizeof(dshotBuffer));
+
+    return hash;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Reference Pass, keeps what each stage is fed in flight
+///////////////////////////////////////////////////////////////////////////////
+
+static void referencePass(void)
+{
+    uint32_t     i;
+    benchInput_t *input;
+
+    resetFlightCode();
+
+    for (i = 0; i < recordCount; i++)
+    {
+        input = &inputs[i];
+
+        stageChain(i, 0);
+
+        // stageChain() filtered in place, scale again for the raw values
+
+        input->dt = dt500Hz;
+
+        memcpy(input->accelFiltered, sensors.accel500Hz,    sizeof(input->accelFiltered));
+        memcpy(input->gyroFiltered,  sensors.gyro500Hz,     sizeof(input->gyroFiltered));
+        memcpy(input->rateCmd,       rateCmd,               sizeof(input->rateCmd));
+        memcpy(input->axisPID,       axisPID,               sizeof(input->axisPID));
+        memcpy(input->motor,         motor,                 sizeof(input->motor));
+
+        getQuaternion(input->quaternion);
+
+        input->ahrsInitialized = margAHRS.initialized;
+
+        scaleSensors500Hz(dt500Hz);
+
+        memcpy(input->accel,      sensors.accel500Hz,      sizeof(input->accel));
+        memcpy(input->gyro,       sensors.gyro500Hz,       sizeof(input->gyro));
+        memcpy(input->deltaAngle, sensors.deltaAngle500Hz, sizeof(input->deltaAngle));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Run One Stage
+///////////////////////////////////////////////////////////////////////////////
+
+static void runStage(const char *name, uint32_t (*stage)(uint32_t i, uint32_t hash),
+                     uint32_t repeats, benchResult_t *result)
+{
+    uint32_t        repeat, i, hash;
+    struct timespec start, end;
+    double          ns, bestNs = 0.0;
+    int64_t         instructions, totalInstructions = 0;
+
+    result->name = name;
+
+    for (repeat = 0; repeat < repeats; repeat++)
+    {
+        resetFlightCode();
+
+        if (repeat == 0)
+        {
+            hash = 2166136261u;
+
+            for (i = 0; i < recordCount; i++)
+                hash = stage(i, hash);
+
+            result->checksum = hash;
+
+            resetFlightCode();
+        }
+
+        perfStart();
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        for (i = 0; i < recordCount; i++)
+            stage(i, 0);
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        instructions = perfStop();
+
+        ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+
+        if ((repeat == 0) || (ns < bestNs))
+            bestNs = ns;
+
+        if ((instructions < 0) || (totalInstructions < 0))
+            totalInstructions = -1;
+        else
+            totalInstructions += instructions;
+    }
+
+    result->nsPerCall = bestNs / recordCount;
+
+    if (totalInstructions < 0)
+        result->instructionsPerCall = -1.0;
+    else
+        result->instructionsPerCall = (double)totalInstructions / ((double)repeats * recordCount);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Load Recording
+///////////////////////////////////////////////////////////////////////////////
+
+static int loadRecording(const char *name)
+{
+    FILE               *file;
+    sitlRecordHeader_t header;
+    long               length;
+
+    file = fopen(name, "rb");
+
+    if (file == NULL)
+    {
+        perror(name);
+        return -1;
+    }
+
+    if ((fread(&header, sizeof(header), 1, file) != 1) ||
+        (header.magic      != SITL_RECORD_MAGIC)        ||
+        (header.version    != SITL_RECORD_VERSION)      ||
+        (header.recordSize != sizeof(sitlRecord_t)))
+    {
+        fprintf(stderr, "%s: not a recording from this sitl build\n", name);
+        fclose(file);
+        return -1;
+    }
+
+    fseek(file, 0, SEEK_END);
+    length = ftell(file) - (long)sizeof(header);
+    fseek(file, sizeof(header), SEEK_SET);
+
+    recordCount = (uint32_t)(length / sizeof(sitlRecord_t));
+
+    records = malloc(recordCount * sizeof(sitlRecord_t));
+    inputs  = malloc(recordCount * sizeof(benchInput_t));
+
+    if ((recordCount == 0) || (records == NULL) || (inputs == NULL) ||
+        (fread(records, sizeof(sitlRecord_t), recordCount, file) != recordCount))
+    {
+        fprintf(stderr, "%s: no records\n", name);
+        fclose(file);
+        return -1;
+    }
+
+    fclose(file);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Baseline Comparison
+///////////////////////////////////////////////////////////////////////////////
+
+static void compareBaseline(const char *name, const benchResult_t *results)
+{
+    FILE     *file;
+    char     line[128], stage[32];
+    double   nsPerCall, instructionsPerCall;
+    uint32_t calls, checksum;
+    uint8_t  i;
+
+    file = fopen(name, "r");
+
+    if (file == NULL)
+    {
+        perror(name);
+        return;
+    }
+
+    printf("\n%-14s %10s %10s  %s\n", "vs baseline", "ns", "instr", "checksum");
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (sscanf(line, "%31[^,],%u,%lf,%lf,%x", stage, &calls, &nsPerCall, &instructionsPerCall, &checksum) != 5)
+            continue;
+
+        for (i = 0; i < BENCH_STAGES; i++)
+        {
+            if (strcmp(stage, results[i].name) != 0)
+                continue;
+
+            printf("%-14s %+9.1f%% ", stage, 100.0 * (results[i].nsPerCall / nsPerCall - 1.0));
+
+            if ((instructionsPerCall > 0.0) && (results[i].instructionsPerCall > 0.0))
+                printf("%+9.1f%% ", 100.0 * (results[i].instructionsPerCall / instructionsPerCall - 1.0));
+            else
+                printf("%10s ", "n/a");
+
+            printf(" %s\n", (checksum == results[i].checksum) ? "same" : "CHANGED");
+        }
+    }
+
+    fclose(file);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    int           option;
+    uint32_t      repeats = 20;
+    const char    *inputName = NULL;
+    const char    *outputName = "bench.csv";
+    const char    *baselineName = NULL;
+    FILE          *outputFile;
+    benchResult_t results[BENCH_STAGES];
+    uint8_t       i;
+
+    while ((option = getopt(argc, argv, "i:n:o:c:")) != -1)
+    {
+        switch (option)
+        {
+            case 'i':
+                inputName = optarg;
+                break;
+
+            case 'n':
+                repeats = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'o':
+                outputName = optarg;
+                break;
+
+            case 'c':
+                baselineName = optarg;
+                break;
+
+            default:
+                inputName = NULL;
+                break;
+        }
+    }
+
+    if ((inputName == NULL) || (repeats == 0))
+    {
+        fprintf(stderr, "usage: %s -i vectors [-n repeats] [-o file] [-c baseline]\n", argv[0]);
+        return 1;
+    }
+
+    if (loadRecording(inputName) != 0)
+        return 1;
+
+    ///////////////////////////////////
+
+    // systemInit() without the hardware, as in sitl.c
+
+    setEEPROMDefaults();
+
+    accConfidenceDecay = 1.0f / sqrtf(eepromConfig.accelCutoff);
+
+    initMixer();
+
+    powerUpConfig = eepromConfig;
+
+    escTimingInit(&dshotTiming, ESC_PROTOCOL_DSHOT600, eepromConfig.escPwmRate);
+
+    for (i = 0; i < NUMBER_OF_ESC_TIMERS; i++)
+        dshotChannels[i] = escTimerChannels(i);
+
+    perfOpen();
+
+    referencePass();
+
+    ///////////////////////////////////
+
+    runStage("scaling",      stageScaling,      repeats, &results[0]);
+    runStage("filter",       stageFilter,       repeats, &results[1]);
+    runStage("ahrs",         stageAHRS,         repeats, &results[2]);
+    runStage("ekf",          stageEKF,          repeats, &results[3]);
+    runStage("axisCommands", stageAxisCommands, repeats, &results[4]);
+    runStage("pidLegacy",    stagePIDlegacy,    repeats, &results[5]);
+    runStage("ratePIDs",     stageRatePIDs,     repeats, &results[6]);
+    runStage("mixer",        stageMixer,        repeats, &results[7]);
+    runStage("rateLoop",     stageRateLoop,     repeats, &results[8]);
+    runStage("chain",        stageChain,        repeats, &results[9]);
+    runStage("dshot",        stageDshot,        repeats, &results[10]);
+
+    ///////////////////////////////////
+
+    outputFile = fopen(outputName, "w");
+
+    if (outputFile == NULL)
+    {
+        perror(outputName);
+        return 1;
+    }
+
+    fprintf(outputFile, "stage,calls,ns_per_call,instructions_per_call,checksum\n");
+
+    printf("%u vectors, %u repeats, instruction counts %s\n\n",
+           recordCount, repeats, (perfFd >= 0) ? "from perf" : "not available");
+
+    printf("%-14s %10s %10s  %s\n", "stage", "ns/call", "instr/call", "checksum");
+
+    for (i = 0; i < BENCH_STAGES; i++)
+    {
+        fprintf(outputFile, "%s,%u,%.2f,%.1f,%08x\n",
+                results[i].name, recordCount, results[i].nsPerCall, results[i].instructionsPerCall, results[i].checksum);
+
+        printf("%-14s %10.2f ", results[i].name, results[i].nsPerCall);
+
+        if (results[i].instructionsPerCall >= 0.0)
+            printf("%10.1f ", results[i].instructionsPerCall);
+        else
+            printf("%10s ", "n/a");
+
+        printf(" %08x\n", results[i].checksum);
+    }
+
+    fclose(outputFile);
+
+    if (baselineName != NULL)
+        compareBaseline(baselineName, results);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
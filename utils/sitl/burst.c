@@ -0,0 +1,444 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+///////////////////////////////////////////////////////////////////////////////
+
+// src/sensors/mpu6000Burst.c, the half of the MPU6000 DMA acquisition the
+// EXTI and DMA handlers call into, against a model of the sensor and the
+// SPI DMA.  Checks:
+//
+//   parse      a record clocked in behind the address byte, big endian,
+//              signed extremes, the request time carried through
+//   pingpong   each transfer fills the buffer the last one did not, the
+//              completed one is parsed while the next is being filled
+//   overrun    a data ready edge during a transfer is refused and counted,
+//              the transfer under way keeps its request time
+//   release    a FIFO chain ends without flipping the buffers
+//   stream     1 kHz edges, transfers that sometimes outlast the period,
+//              500 Hz handoffs, every completed sample summed once
+//   handoff    no samples since the last handoff keeps the consumer copy
+//              and the coning history
+//   fifo       record counts and overflow at the FIFO size edges
+//
+// Exits non zero on any failure.
+//
+// Usage: burst
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+
+#include "sitlCheck.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define STREAM_EDGES  1000000
+#define EDGE_PERIOD   1000             // uSec between data ready edges
+
+static uint32_t randomState = 1;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static uint32_t random32(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Sensor and DMA Model
+///////////////////////////////////////////////////////////////////////////////
+
+// The sample the MPU6000 holds at data ready edge n
+
+static void sensorSample(uint32_t n, int16_t values[7])
+{
+    uint8_t i;
+
+    for (i = 0; i < 7; i++)
+        values[i] = (int16_t)(n * (2 * i + 3) + i * 4099);
+}
+
+///////////////////////////////////////
+
+// Bytes the SPI clocks in for edge n, the first one as the address goes out
+
+static void sensorBytes(uint32_t n, uint8_t bytes[MPU6000_BURST_LENGTH])
+{
+    int16_t values[7];
+    uint8_t i;
+
+    sensorSample(n, values);
+
+    bytes[0] = 0xFF;
+
+    for (i = 0; i < 7; i++)
+    {
+        bytes[1 + 2 * i] = (uint8_t)((uint16_t)values[i] >> 8);
+        bytes[2 + 2 * i] = (uint8_t)values[i];
+    }
+}
+
+///////////////////////////////////////
+
+static int sampleIs(const mpu6000Sample_t *sample, uint32_t n)
+{
+    int16_t values[7];
+
+    sensorSample(n, values);
+
+    return (sample->accel[0]    == values[0]) && (sample->accel[1] == values[1]) && (sample->accel[2] == values[2]) &&
+           (sample->temperature == values[3]) &&
+           (sample->gyro[0]     == values[4]) && (sample->gyro[1]  == values[5]) && (sample->gyro[2]  == values[6]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Checks
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkParse(void)
+{
+    static const uint8_t record[MPU6000_BURST_LENGTH] =
+    {
+        0xA5,                          // Clocked in with the address, skipped
+        0x80, 0x00,  0x7F, 0xFF,  0xFF, 0xFE,
+        0x0C, 0x35,
+        0x00, 0x01,  0xFF, 0xFF,  0x12, 0x34,
+    };
+
+    mpu6000Sample_t sample;
+
+    mpu6000BurstParse(&record[1], 0x123456789AULL, &sample);
+
+    check((sample.accel[0] == -32768) && (sample.accel[1] == 32767) && (sample.accel[2] == -2) &&
+          (sample.temperature == 3125) &&
+          (sample.gyro[0] == 1) && (sample.gyro[1] == -1) && (sample.gyro[2] == 0x1234),
+          "Accel, temperature and gyro big endian and signed");
+
+    check(sample.time == 0x123456789AULL, "Request time carried into the sample");
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+static void checkPingPong(void)
+{
+    mpu6000Burst_t  burst;
+    mpu6000Sample_t sample;
+    uint8_t         *buffer, *previous = NULL;
+    uint32_t        n;
+    int             alternates = true, parsed = true;
+
+    memset(&burst, 0, sizeof(burst));
+
+    for (n = 0; n < 8; n++)
+    {
+        buffer = mpu6000BurstStart(&burst, 1000 * n);
+
+        if ((buffer == NULL) || (buffer != burst.buffer[n & 1]) || (buffer == previous))
+            alternates = false;
+
+        sensorBytes(n, buffer);
+
+        mpu6000BurstComplete(&burst, &sample);
+
+        // The next transfer starts filling the other buffer, this sample is already out
+
+        memset(burst.buffer[burst.active], 0xEE, MPU6000_BURST_LENGTH);
+
+        if ((sampleIs(&sample, n) == false) || (sample.time != 1000 * n))
+            parsed = false;
+
+        previous = buffer;
+    }
+
+    check(alternates, "Transfers alternate between the two buffers");
+    check(parsed, "Completed buffer parsed, not the one being filled");
+    check((burst.completeCount == 8) && (burst.overrunCount == 0) && (burst.busy == false), "8 completed, none overrun, idle");
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+static void checkOverrun(void)
+{
+    mpu6000Burst_t  burst;
+    mpu6000Sample_t sample;
+    uint8_t         *buffer;
+
+    memset(&burst, 0, sizeof(burst));
+
+    buffer = mpu6000BurstStart(&burst, 5000);
+
+    check((buffer == burst.buffer[0]) && burst.busy, "First edge starts a transfer");
+
+    check((mpu6000BurstStart(&burst, 6000) == NULL) && (mpu6000BurstStart(&burst, 7000) == NULL) &&
+          (burst.overrunCount == 2), "Two edges while busy refused and counted");
+
+    sensorBytes(5, buffer);
+
+    mpu6000BurstComplete(&burst, &sample);
+
+    check(sampleIs(&sample, 5) && (sample.time == 5000), "Transfer under way keeps its own request time");
+
+    check((mpu6000BurstStart(&burst, 8000) == burst.buffer[1]) && (burst.overrunCount == 2), "Next edge after completion starts again");
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+static void checkRelease(void)
+{
+    mpu6000Burst_t burst;
+    uint8_t        *buffer;
+
+    memset(&burst, 0, sizeof(burst));
+
+    buffer = mpu6000BurstStart(&burst, 1000);
+
+    mpu6000BurstRelease(&burst);
+
+    check((burst.busy == false) && (burst.active == 0) && (burst.completeCount == 1),
+          "Release ends the transfer, buffers not flipped");
+
+    check(mpu6000BurstStart(&burst, 2000) == buffer, "Next transfer reuses the same buffer");
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+static void checkStream(void)
+{
+    mpu6000Burst_t       burst;
+    mpu6000Accumulator_t accumulator, summed;
+    mpu6000Sample_t      sample;
+    uint8_t              *buffer = NULL, *next;
+    uint32_t             edge, pending = 0, starts = 0, handoffs = 0, duration;
+    int64_t              gyroSum[3] = { 0, 0, 0 }, handedSum[3] = { 0, 0, 0 };
+    uint64_t             samples = 0, handedSamples = 0, completeTime = 0;
+    int16_t              values[7];
+    uint8_t              axis;
+    int                  ordered = true, parsed = true;
+
+    memset(&burst,       0, sizeof(burst));
+    memset(&accumulator, 0, sizeof(accumulator));
+    memset(&summed,      0, sizeof(summed));
+
+    for (edge = 0; edge < STREAM_EDGES; edge++)
+    {
+        // A transfer that outlasted the period completes before this edge
+
+        if ((buffer != NULL) && (completeTime <= (uint64_t)edge * EDGE_PERIOD))
+        {
+            mpu6000BurstComplete(&burst, &sample);
+            buffer = NULL;
+
+            if ((sampleIs(&sample, pending) == false) || (sample.time != (uint64_t)pending * EDGE_PERIOD))
+                parsed = false;
+
+            if ((accumulator.samples != 0) && (sample.time <= accumulator.lastSampleTime))
+                ordered = false;
+
+            mpu6000Accumulate(&accumulator, &sample);
+
+            sensorSample(pending, values);
+
+            for (axis = 0; axis < 3; axis++)
+                gyroSum[axis] += values[4 + axis];
+
+            samples++;
+        }
+
+        // Data ready, most transfers take 20 uSec, one in 50 is held off past the next edge
+
+        duration = (random32() % 50 == 0) ? EDGE_PERIOD + random32() % (2 * EDGE_PERIOD) : 20;
+
+        next = mpu6000BurstStart(&burst, (uint64_t)edge * EDGE_PERIOD);
+
+        if (next != NULL)
+        {
+            sensorBytes(edge, next);
+
+            buffer       = next;
+            pending      = edge;
+            completeTime = (uint64_t)edge * EDGE_PERIOD + duration;
+            starts++;
+        }
+
+        // SysTick takes the sums every other mSec, sometimes skipping one
+
+        if ((edge & 1) && (random32() % 10 != 0))
+        {
+            if (mpu6000AccumulatorHandoff(&accumulator, &summed))
+            {
+                for (axis = 0; axis < 3; axis++)
+                    handedSum[axis] += summed.gyro[axis];
+
+                handedSamples += summed.samples;
+                handoffs++;
+            }
+        }
+    }
+
+    if (buffer != NULL)
+    {
+        mpu6000BurstComplete(&burst, &sample);
+        mpu6000Accumulate(&accumulator, &sample);
+
+        sensorSample(pending, values);
+
+        for (axis = 0; axis < 3; axis++)
+            gyroSum[axis] += values[4 + axis];
+
+        samples++;
+    }
+
+    if (mpu6000AccumulatorHandoff(&accumulator, &summed))
+    {
+        for (axis = 0; axis < 3; axis++)
+            handedSum[axis] += summed.gyro[axis];
+
+        handedSamples += summed.samples;
+        handoffs++;
+    }
+
+    printf("Stream, %d edges, %lu transfers, %lu overruns, %lu handoffs\n", STREAM_EDGES,
+           (unsigned long)starts, (unsigned long)burst.overrunCount, (unsigned long)handoffs);
+
+    check((starts + burst.overrunCount == STREAM_EDGES) && (burst.overrunCount > 0), "Every edge a transfer or an overrun");
+
+    check((burst.completeCount == starts) && (samples == starts), "Every transfer completed once");
+
+    check(parsed && ordered, "Each sample the one at its own edge, in order");
+
+    check((handedSamples == samples) && (handedSum[0] == gyroSum[0]) && (handedSum[1] == gyroSum[1]) && (handedSum[2] == gyroSum[2]),
+          "Handoffs carry every sample once, sums exact");
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+static void checkHandoff(void)
+{
+    mpu6000Accumulator_t accumulator, summed, before;
+    mpu6000Sample_t      sample;
+
+    memset(&accumulator, 0, sizeof(accumulator));
+    memset(&summed, 0x5A, sizeof(summed));
+
+    before = summed;
+
+    check((mpu6000AccumulatorHandoff(&accumulator, &summed) == false) && (memcmp(&summed, &before, sizeof(summed)) == 0),
+          "Nothing accumulated yet, false, consumer copy untouched");
+
+    memset(&sample, 0, sizeof(sample));
+
+    sample.gyro[0] = 100;
+    sample.gyro[1] = -200;
+    sample.gyro[2] = 300;
+    sample.time    = 1000;
+
+    mpu6000Accumulate(&accumulator, &sample);
+
+    sample.gyro[0] = 110;
+    sample.time    = 2000;
+
+    mpu6000Accumulate(&accumulator, &sample);
+
+    check(mpu6000AccumulatorHandoff(&accumulator, &summed) && (summed.samples == 2) && (summed.gyro[0] == 210) &&
+          (summed.lastSampleTime == 2000), "Two samples handed off");
+
+    before = summed;
+
+    check((mpu6000AccumulatorHandoff(&accumulator, &summed) == false) && (memcmp(&summed, &before, sizeof(summed)) == 0),
+          "Handoff with no new samples keeps the last sums");
+
+    check((accumulator.samples == 0) && (accumulator.gyro[0] == 0) && (accumulator.gyroPrevious[0] == 110) &&
+          (accumulator.gyroPrevious[1] == -200) && (accumulator.gyroPrevious[2] == 300),
+          "Restarted sums keep the last sample for the coning terms");
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+static void checkFifo(void)
+{
+    static const uint16_t counts[]   = { 0, 13, 14, 27, 28, 140, 1008, 1010, 1011, 1024 };
+    static const uint16_t records[]  = { 0,  0,  1,  1,  2,  10,   10,   10,    0,    0 };
+    static const bool     overflow[] = { false, false, false, false, false, false, false, false, true, true };
+
+    uint8_t n;
+    bool    flag;
+    int     ok = true;
+
+    for (n = 0; n < sizeof(counts) / sizeof(counts[0]); n++)
+    {
+        if ((mpu6000FifoRecords(counts[n], 10, &flag) != records[n]) || (flag != overflow[n]))
+        {
+            printf("    FIFO count %d gave %d records\n", counts[n], mpu6000FifoRecords(counts[n], 10, &flag));
+            ok = false;
+        }
+    }
+
+    check(ok && (mpu6000FifoRecords(1010, 100, &flag) == 72), "Whole records, capped, overflow above 1010 bytes");
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+    checkParse();
+    checkPingPong();
+    checkOverrun();
+    checkRelease();
+    checkStream();
+    checkHandoff();
+    checkFifo();
+
+    printf("%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,311 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Attitude error of the flight code gyro path against classic coning
+// motion, where the body axis sweeps a cone at a fixed rate and the true
+// attitude never drifts.  An average rate per 500 Hz update misses the
+// non commuting part of that motion and walks off in yaw, the coning
+// compensated delta angle from mpu6000Accumulate() should not.
+//
+// Each 1 kHz sample is the exact integral of the body rate over its period,
+// quantized to MPU6000 counts with a constant bias added, so the sample
+// path, the bias removal and scaleSensors500Hz() all run as in flight.
+// Both variants drive MargAHRSupdateInstance() with every gain at zero,
+// starting at the true attitude.  Exits non zero when the delta angle
+// error grows faster than its bound, so it can gate a change to the gyro
+// path.
+//
+// Usage: coning [-t seconds] [-a half angle deg]
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <getopt.h>
+
+#include "board.h"
+
+#include "sitlHal.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define CONING_SUBSTEPS     16      // Simpson intervals per 1 kHz sample
+
+#define CONING_DRIFT_BOUND  (0.002 * D2R)  // Largest error over run length, rad/s
+
+static const float coningRate[] = { 5.0f, 10.0f, 20.0f, 40.0f };  // Hz
+
+static const float coningBias[3] = { 12.3f, -7.6f, 5.2f };        // Counts
+
+static int failures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+// Truth
+///////////////////////////////////////////////////////////////////////////////
+
+static void quaternionMultiply(const double a[4], const double b[4], double c[4])
+{
+    c[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    c[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    c[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    c[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+}
+
+///////////////////////////////////////
+
+// q = [cos(a/2), sin(a/2) cos(wt), sin(a/2) sin(wt), 0], body to earth
+
+static void coningAttitude(double halfAngle, double omega, double t, double q[4])
+{
+    q[0] = cos(halfAngle / 2.0);
+    q[1] = sin(halfAngle / 2.0) * cos(omega * t);
+    q[2] = sin(halfAngle / 2.0) * sin(omega * t);
+    q[3] = 0.0;
+}
+
+///////////////////////////////////////
+
+// Body rate, the vector part of 2 q* dq/dt
+
+static void coningBodyRate(double halfAngle, double omega, double t, double rate[3])
+{
+    double q[4], qDot[4], w[4];
+
+    coningAttitude(halfAngle, omega, t, q);
+
+    q[1] = -q[1];
+    q[2] = -q[2];
+
+    qDot[0] = 0.0;
+    qDot[1] = -sin(halfAngle / 2.0) * omega * sin(omega * t);
+    qDot[2] =  sin(halfAngle / 2.0) * omega * cos(omega * t);
+    qDot[3] = 0.0;
+
+    quaternionMultiply(q, qDot, w);
+
+    rate[0] = 2.0 * w[1];
+    rate[1] = 2.0 * w[2];
+    rate[2] = 2.0 * w[3];
+}
+
+///////////////////////////////////////
+
+// What an ideal rate integrating gyro reports for one sample, the body
+// rate averaged over the sample period
+
+static void coningGyro(double halfAngle, double omega, double t, double period, double rate[3])
+{
+    double  h = period / CONING_SUBSTEPS;
+    double  w[3], weight;
+    uint8_t axis, step;
+
+    rate[0] = rate[1] = rate[2] = 0.0;
+
+    for (step = 0; step <= CONING_SUBSTEPS; step++)
+    {
+        weight = ((step == 0) || (step == CONING_SUBSTEPS)) ? 1.0 : ((step % 2) ? 4.0 : 2.0);
+
+        coningBodyRate(halfAngle, omega, t - period + step * h, w);
+
+        for (axis = 0; axis < 3; axis++)
+            rate[axis] += weight * w[axis] * h / 3.0 / period;
+    }
+}
+
+///////////////////////////////////////
+
+// Sensor noise, about the MPU6000 datasheet figure.  Without it the steady
+// part of the coning rate rounds the same way every sample and the
+// quantization error integrates like a bias.
+
+static double coningNoise(void)
+{
+    double sum = 0.0;
+    uint8_t i;
+
+    for (i = 0; i < 4; i++)
+        sum += (double)rand() / RAND_MAX - 0.5;
+
+    return 3.0 * sum;  // Triangular-ish, 1.7 counts RMS
+}
+
+///////////////////////////////////////
+
+// Angle of the rotation between the estimate and the truth
+
+static double attitudeError(const margAHRS_t *ahrs, const double truth[4])
+{
+    const double estimate[4] = { ahrs->q0, ahrs->q1, ahrs->q2, ahrs->q3 };
+    double       conjugate[4], error[4];
+
+    conjugate[0] =  truth[0];
+    conjugate[1] = -truth[1];
+    conjugate[2] = -truth[2];
+    conjugate[3] = -truth[3];
+
+    quaternionMultiply(conjugate, estimate, error);
+
+    return 2.0 * atan2(sqrt(error[1] * error[1] + error[2] * error[2] + error[3] * error[3]), fabs(error[0]));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// One Coning Run
+///////////////////////////////////////////////////////////////////////////////
+
+static void coningRun(float rate, float halfAngleDeg, float seconds)
+{
+    const double halfAngle = halfAngleDeg * D2R;
+    const double omega     = 2.0 * M_PI * rate;
+    const double period    = 0.001;
+
+    margAHRS_t      averaged, delta;
+    mpu6000Sample_t sample;
+    double          truth[4], gyro[3], error, maxAveraged, maxDelta;
+    float           deltaAngle[3], q[4];
+    uint32_t        frame, frames;
+    uint8_t         axis, pass;
+
+    memset(&mpu6000Sum500Hz,    0, sizeof(mpu6000Sum500Hz));
+    memset(&mpu6000Summed500Hz, 0, sizeof(mpu6000Summed500Hz));
+
+    memset(&sample, 0, sizeof(sample));
+
+    srand(1);
+
+    coningAttitude(halfAngle, omega, 0.0, truth);
+
+    for (axis = 0; axis < 4; axis++)
+        q[axis] = (float)truth[axis];
+
+    MargAHRSreset(&averaged);
+    MargAHRSsetQuaternion(&averaged, q);
+
+    MargAHRSreset(&delta);
+    MargAHRSsetQuaternion(&delta, q);
+
+    maxAveraged = 0.0;
+    maxDelta    = 0.0;
+
+    frames = (uint32_t)(seconds * 1000.0f);
+
+    for (frame = 1; frame <= frames; frame++)
+    {
+        coningGyro(halfAngle, omega, frame * period, period, gyro);
+
+        sample.gyro[ROLL ] = (int16_t)lrint( gyro[ROLL ] / GYRO_SCALE_FACTOR + coningBias[ROLL ] + coningNoise());
+        sample.gyro[PITCH] = (int16_t)lrint(-gyro[PITCH] / GYRO_SCALE_FACTOR + coningBias[PITCH] + coningNoise());
+        sample.gyro[YAW  ] = (int16_t)lrint(-gyro[YAW  ] / GYRO_SCALE_FACTOR + coningBias[YAW  ] + coningNoise());
+        sample.time        = (uint64_t)frame * 1000;
+
+        mpu6000Accumulate(&mpu6000Sum500Hz, &sample);
+
+        if ((frame % COUNT_500HZ) != 0)
+            continue;
+
+        mpu6000AccumulatorHandoff(&mpu6000Sum500Hz, &mpu6000Summed500Hz);
+
+        scaleSensors500Hz(0.002f);
+
+        for (axis = 0; axis < 3; axis++)
+            deltaAngle[axis] = sensors.gyro500Hz[axis] * 0.002f;
+
+        MargAHRSupdateInstance(&averaged, deltaAngle,              0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, false, 0.002f);
+        MargAHRSupdateInstance(&delta,    sensors.deltaAngle500Hz, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, false, 0.002f);
+
+        coningAttitude(halfAngle, omega, frame * period, truth);
+
+        error = attitudeError(&averaged, truth);
+
+        if (error > maxAveraged)
+            maxAveraged = error;
+
+        error = attitudeError(&delta, truth);
+
+        if (error > maxDelta)
+            maxDelta = error;
+    }
+
+    pass = (maxDelta <= CONING_DRIFT_BOUND * seconds);
+
+    printf("%5.1f Hz %4.1f deg  %5.0f deg/s peak  average rate %9.4f deg  delta angle %9.4f deg  %s\n",
+           rate, halfAngleDeg, 2.0 * sin(halfAngle / 2.0) * omega * R2D,
+           maxAveraged * R2D, maxDelta * R2D,
+           pass ? "ok" : "FAIL");
+
+    if (pass == false)
+        failures++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    float   seconds = 60.0f, halfAngle = 2.0f;
+    uint8_t index;
+    int     option;
+
+    while ((option = getopt(argc, argv, "t:a:")) != -1)
+    {
+        switch (option)
+        {
+            case 't':
+                seconds = strtof(optarg, NULL);
+                break;
+
+            case 'a':
+                halfAngle = strtof(optarg, NULL);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-t seconds] [-a half angle deg]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    // Bias as calibration would leave it, taken out by scaleSensors500Hz()
+
+    memcpy(gyroRTBias, coningBias, sizeof(gyroRTBias));
+    memset(gyroTCBias, 0,          sizeof(gyroTCBias));
+
+    printf("Largest attitude error over %.0f s, bound %.3f deg\n", seconds, CONING_DRIFT_BOUND * R2D * seconds);
+
+    for (index = 0; index < sizeof(coningRate) / sizeof(coningRate[0]); index++)
+        coningRun(coningRate[index], halfAngle, seconds);
+
+    return (failures > 0) ? 1 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,540 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Alias rejection of src/gyroDecimator.c, the 8 kHz to 1 kHz decimation of
+// the MPU6000 FIFO gyro stream.  Anything above 500 Hz in the 8 kHz stream
+// folds back into the 1 kHz samples the rate loop runs on, a tone at f
+// lands at |f - 1000 n|, so motor harmonics near 1, 2 and 3 kHz show up
+// as slow rate errors the filters further down cannot tell from motion.
+// Checks, against the design set by setEEPROMDefaults():
+//
+//   response   sines through gyroDecimatorUpdate(), the CMSIS decimator
+//              the board runs, fitted at their folded frequency and
+//              compared with the analytic response of the coefficients
+//   design     pass band at 200 and 300 Hz, rejection at 500 Hz, where
+//              tones fold onto the output Nyquist, and from 600 Hz up,
+//              group delay
+//   spectra    synthetic vibration, motor and blade pass harmonics, frame
+//              resonance and ESC noise, run through the decimator.  The
+//              folded power at the output against the power above 500 Hz
+//              at the input, overall and inside the 100 Hz control band,
+//              with the old 32 tap 300 Hz default and plain decimation
+//              for comparison
+//
+// The MPU6000 256 Hz DLPF ahead of the FIFO is not modelled, so the
+// figures are the decimator's own, a worst case for the sensor.
+//
+// -s sweeps taps and cutoff and marks the designs meeting the design
+// checks.  The default is the passing design with the least delay.
+//
+// Exits non zero on any failure.
+//
+// Usage: decimate [-s]
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <getopt.h>
+
+#include "board.h"
+
+#include "sitlCheck.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define SAMPLE_RATE      8000.0f       // As mpu6000.c, FIFO mode
+#define FACTOR           8
+#define OUTPUT_RATE      (SAMPLE_RATE / FACTOR)
+
+#define FIT_CYCLES       20            // Folded sine periods in each gain fit
+#define SETTLE_OUTPUTS   32            // Longer than the longest filter
+#define SPECTRUM_OUTPUTS 4000          // 4 seconds of output per spectrum
+
+#define MEASURE_TOLERANCE  1.0e-4      // Absolute, fitted against analytic gain
+#define POWER_TOLERANCE    0.25        // dB, folded power against analytic
+
+#define PASS_200HZ       -0.5          // dB, minimum gain
+#define PASS_300HZ       -3.5
+#define STOP_500HZ       25.0          // dB, minimum rejection
+#define STOP_600HZ       50.0          // From 600 Hz to the input Nyquist
+#define MAX_DELAY        4.0e-3        // Seconds
+
+#define CONTROL_BAND     100.0         // Hz
+#define SPECTRUM_REJECTION 45.0        // dB, minimum folded power rejection
+
+#define OLD_TAPS         32
+#define OLD_CUTOFF       300.0f
+
+#define MAX_TONES        80
+
+static uint32_t randomState = 1;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static uint32_t random32(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+
+///////////////////////////////////////
+
+static double dB(double gain)
+{
+    return 20.0 * log10(gain > 1e-12 ? gain : 1e-12);
+}
+
+///////////////////////////////////////
+
+// Where a tone at frequency lands in the 1 kHz output
+
+static double folded(double frequency)
+{
+    double f = fmod(frequency, OUTPUT_RATE);
+
+    return (f > OUTPUT_RATE / 2.0) ? OUTPUT_RATE - f : f;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Analytic Gain of the Designed Coefficients
+///////////////////////////////////////////////////////////////////////////////
+
+static double analyticGain(const gyroDecimator_t *decimator, uint8_t taps, double frequency)
+{
+    double  w = 2.0 * M_PI * frequency / SAMPLE_RATE, re = 0.0, im = 0.0;
+    uint8_t k;
+
+    for (k = 0; k < taps; k++)
+    {
+        re += decimator->coefficients[k] * cos(w * k);
+        im -= decimator->coefficients[k] * sin(w * k);
+    }
+
+    return sqrt(re * re + im * im);
+}
+
+///////////////////////////////////////
+
+// Smallest rejection from frequency up to the input Nyquist, 1 Hz steps
+
+static double minimumRejection(const gyroDecimator_t *decimator, uint8_t taps, double frequency)
+{
+    double rejection = 1000.0;
+
+    for (; frequency < SAMPLE_RATE / 2.0; frequency += 1.0)
+        rejection = fmin(rejection, -dB(analyticGain(decimator, taps, frequency)));
+
+    return rejection;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Measured Gain, least squares fit of the folded sine to the settled output
+///////////////////////////////////////////////////////////////////////////////
+
+static double measuredGain(uint8_t taps, float cutoff, double frequency, uint8_t axis)
+{
+    gyroDecimator_t decimator;
+    float32_t       in[3] = { 0.0f, 0.0f, 0.0f }, out[3];
+    uint32_t        n = 0, m = 0, fit;
+    double          w, wf, s, c, ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0, det, a, b;
+
+    gyroDecimatorInit(&decimator, taps, FACTOR, cutoff, SAMPLE_RATE);
+
+    fit = (uint32_t)(FIT_CYCLES * OUTPUT_RATE / folded(frequency));
+
+    if (fit < 200)
+        fit = 200;
+
+    w  = 2.0 * M_PI * frequency / SAMPLE_RATE;
+    wf = 2.0 * M_PI * folded(frequency) / OUTPUT_RATE;
+
+    while (m < SETTLE_OUTPUTS + fit)
+    {
+        in[axis] = (float32_t)sin(w * n++);
+
+        if (gyroDecimatorUpdate(&decimator, in, out) == false)
+            continue;
+
+        if (m++ < SETTLE_OUTPUTS)
+            continue;
+
+        s = sin(wf * m);
+        c = cos(wf * m);
+
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        ys += out[axis] * s;
+        yc += out[axis] * c;
+    }
+
+    det = ss * cc - sc * sc;
+    a   = (ys * cc - yc * sc) / det;
+    b   = (yc * ss - ys * sc) / det;
+
+    return sqrt(a * a + b * b);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Response Against the Analytic Gain
+///////////////////////////////////////////////////////////////////////////////
+
+// None folds onto 0 or 500 Hz, where a sine cannot be fitted
+
+static const double responseFrequencies[] =
+{
+      25.0,  100.0,  200.0,  250.0,  300.0,  350.0,  400.0,  450.0,  480.0,  520.0,
+     550.0,  600.0,  700.0,  800.0,  920.0, 1050.0, 1530.0, 1990.0, 2600.0, 3100.0,
+    3950.0,
+};
+
+#define NUMBER_OF_RESPONSE_FREQUENCIES (sizeof(responseFrequencies) / sizeof(responseFrequencies[0]))
+
+static void checkResponse(uint8_t taps, float cutoff)
+{
+    gyroDecimator_t decimator;
+    double          measured, expected, worst = 0.0;
+    uint32_t        i;
+    uint8_t         axis;
+    char            what[80];
+
+    printf("\nResponse, %d taps %.0f Hz\n", taps, cutoff);
+
+    gyroDecimatorInit(&decimator, taps, FACTOR, cutoff, SAMPLE_RATE);
+
+    for (i = 0; i < NUMBER_OF_RESPONSE_FREQUENCIES; i++)
+    {
+        expected = analyticGain(&decimator, taps, responseFrequencies[i]);
+
+        for (axis = 0; axis < 3; axis++)
+        {
+            measured = measuredGain(taps, cutoff, responseFrequencies[i], axis);
+            worst    = fmax(worst, fabs(measured - expected));
+        }
+
+        printf("    %6.0f Hz folds to %5.0f Hz  %8.2f dB  (analytic %8.2f dB)\n", responseFrequencies[i],
+               folded(responseFrequencies[i]), dB(measured), dB(expected));
+    }
+
+    snprintf(what, sizeof(what), "measured within %.0e of analytic, worst %.1e", MEASURE_TOLERANCE, worst);
+    check(worst <= MEASURE_TOLERANCE, what);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Design Points
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct designPoints_t
+{
+    double pass200, pass300, stop500, stop600, delay;
+} designPoints_t;
+
+static uint8_t designPoints(uint8_t taps, float cutoff, designPoints_t *points)
+{
+    gyroDecimator_t decimator;
+
+    if (gyroDecimatorInit(&decimator, taps, FACTOR, cutoff, SAMPLE_RATE) == false)
+        return false;
+
+    points->pass200 = dB(analyticGain(&decimator, taps, 200.0));
+    points->pass300 = dB(analyticGain(&decimator, taps, 300.0));
+    points->stop500 = -dB(analyticGain(&decimator, taps, 500.0));
+    points->stop600 = minimumRejection(&decimator, taps, 600.0);
+    points->delay   = (taps - 1) / 2.0 / SAMPLE_RATE;
+
+    return ((points->pass200 >= PASS_200HZ) &&
+            (points->pass300 >= PASS_300HZ) &&
+            (points->stop500 >= STOP_500HZ) &&
+            (points->stop600 >= STOP_600HZ) &&
+            (points->delay   <= MAX_DELAY));
+}
+
+///////////////////////////////////////
+
+static void checkDesign(uint8_t taps, float cutoff)
+{
+    gyroDecimator_t decimator;
+    designPoints_t  points, old;
+    char            what[80];
+
+    printf("\nDesign, %d taps %.0f Hz, old default %d taps %.0f Hz\n", taps, cutoff, OLD_TAPS, OLD_CUTOFF);
+
+    check(gyroDecimatorInit(&decimator, taps, FACTOR, cutoff, SAMPLE_RATE), "default design accepted by gyroDecimatorInit()");
+
+    designPoints(taps,     cutoff,     &points);
+    designPoints(OLD_TAPS, OLD_CUTOFF, &old);
+
+    snprintf(what, sizeof(what), "200 Hz %6.2f dB >= %.1f  (old %6.2f)", points.pass200, PASS_200HZ, old.pass200);
+    check(points.pass200 >= PASS_200HZ, what);
+
+    snprintf(what, sizeof(what), "300 Hz %6.2f dB >= %.1f  (old %6.2f)", points.pass300, PASS_300HZ, old.pass300);
+    check(points.pass300 >= PASS_300HZ, what);
+
+    snprintf(what, sizeof(what), "500 Hz rejection %5.1f dB >= %.0f  (old %5.1f)", points.stop500, STOP_500HZ, old.stop500);
+    check(points.stop500 >= STOP_500HZ, what);
+
+    snprintf(what, sizeof(what), "600 Hz up rejection %5.1f dB >= %.0f  (old %5.1f)", points.stop600, STOP_600HZ, old.stop600);
+    check(points.stop600 >= STOP_600HZ, what);
+
+    snprintf(what, sizeof(what), "group delay %.2f mSec <= %.1f  (old %.2f)", points.delay * 1e3, MAX_DELAY * 1e3, old.delay * 1e3);
+    check(points.delay <= MAX_DELAY, what);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Synthetic Vibration Spectra
+//
+// Tone frequencies are picked so no two fold onto the same output
+// frequency, their powers then add.  Tones at or below 500 Hz are flight
+// and vibration the rate loop is meant to see, left out here.
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct tone_t
+{
+    double frequency, amplitude, phase;
+} tone_t;
+
+typedef struct spectrum_t
+{
+    const char *name;
+    double     fundamental;            // Harmonic series, 0 for a comb
+    double     first, step, last;      // Comb
+    double     amplitude;
+} spectrum_t;
+
+static const spectrum_t spectra[] =
+{
+    { "5 inch, 2 blade, hover",      230.0,    0.0,  0.0,    0.0, 100.0 },
+    { "5 inch, 2 blade, full power", 430.0,    0.0,  0.0,    0.0, 150.0 },
+    { "7 inch, 3 blade pass",        315.0,    0.0,  0.0,    0.0, 100.0 },
+    { "frame resonance",               0.0,  607.0, 23.0, 1400.0,  20.0 },
+    { "ESC and bearing noise",         0.0, 1511.0, 37.0, 3999.0,  10.0 },
+};
+
+#define NUMBER_OF_SPECTRA (sizeof(spectra) / sizeof(spectra[0]))
+
+static uint8_t spectrumTones(const spectrum_t *spectrum, tone_t tones[MAX_TONES])
+{
+    double  frequency;
+    uint8_t count = 0, harmonic;
+
+    if (spectrum->fundamental > 0.0)
+    {
+        // Harmonics falling off as 1/h
+
+        for (harmonic = 1; (frequency = harmonic * spectrum->fundamental) < SAMPLE_RATE / 2.0; harmonic++)
+        {
+            if (frequency <= OUTPUT_RATE / 2.0)
+                continue;
+
+            tones[count].frequency = frequency;
+            tones[count].amplitude = spectrum->amplitude / harmonic;
+            count++;
+        }
+    }
+    else
+    {
+        for (frequency = spectrum->first; frequency <= spectrum->last; frequency += spectrum->step)
+        {
+            tones[count].frequency = frequency;
+            tones[count].amplitude = spectrum->amplitude;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+///////////////////////////////////////
+
+typedef struct foldedPower_t
+{
+    double input, output, analytic, controlBand;
+} foldedPower_t;
+
+static void runSpectrum(const tone_t *tones, uint8_t count, uint8_t taps, float cutoff, foldedPower_t *power)
+{
+    gyroDecimator_t decimator;
+    float32_t       in[3], out[3];
+    double          w[MAX_TONES], x, gain;
+    uint32_t        n = 0, m = 0;
+    uint8_t         i;
+
+    gyroDecimatorInit(&decimator, taps, FACTOR, cutoff, SAMPLE_RATE);
+
+    memset(power, 0, sizeof(foldedPower_t));
+
+    for (i = 0; i < count; i++)
+    {
+        w[i] = 2.0 * M_PI * tones[i].frequency / SAMPLE_RATE;
+        gain = analyticGain(&decimator, taps, tones[i].frequency);
+
+        power->input    += tones[i].amplitude * tones[i].amplitude / 2.0;
+        power->analytic += tones[i].amplitude * tones[i].amplitude * gain * gain / 2.0;
+
+        if (folded(tones[i].frequency) <= CONTROL_BAND)
+            power->controlBand += tones[i].amplitude * tones[i].amplitude * gain * gain / 2.0;
+    }
+
+    while (m < SETTLE_OUTPUTS + SPECTRUM_OUTPUTS)
+    {
+        x = 0.0;
+
+        for (i = 0; i < count; i++)
+            x += tones[i].amplitude * sin(w[i] * n + tones[i].phase);
+
+        n++;
+
+        in[ROLL] = in[PITCH] = in[YAW] = (float32_t)x;
+
+        if (gyroDecimatorUpdate(&decimator, in, out) == false)
+            continue;
+
+        if (m++ < SETTLE_OUTPUTS)
+            continue;
+
+        power->output += out[ROLL] * out[ROLL];
+    }
+
+    power->output /= SPECTRUM_OUTPUTS;
+}
+
+///////////////////////////////////////
+
+static void checkSpectra(uint8_t taps, float cutoff)
+{
+    foldedPower_t power, old, plain;
+    tone_t        tones[MAX_TONES];
+    uint32_t      i;
+    uint8_t       count, k;
+    double        rejection, controlBand;
+    char          what[80];
+
+    printf("\nSpectra, folded power rejection in dB, %d taps %.0f Hz, old %d taps %.0f Hz, plain decimation\n",
+           taps, cutoff, OLD_TAPS, OLD_CUTOFF);
+
+    for (i = 0; i < NUMBER_OF_SPECTRA; i++)
+    {
+        count = spectrumTones(&spectra[i], tones);
+
+        for (k = 0; k < count; k++)
+            tones[k].phase = 2.0 * M_PI * random32() / 4294967296.0;
+
+        runSpectrum(tones, count, taps,       cutoff,     &power);
+        runSpectrum(tones, count, OLD_TAPS,   OLD_CUTOFF, &old);
+        runSpectrum(tones, count, 1,          OLD_CUTOFF, &plain);
+
+        rejection   = 10.0 * log10(power.input / power.output);
+        controlBand = 10.0 * log10(power.input / fmax(power.controlBand, 1e-24));
+
+        printf("%s, %d tones above 500 Hz\n", spectra[i].name, count);
+        printf("    overall       %6.1f  old %6.1f  plain %6.1f\n", rejection,
+               10.0 * log10(old.input / old.output), 10.0 * log10(plain.input / plain.output));
+        printf("    100 Hz band   %6.1f  old %6.1f  plain %6.1f\n", controlBand,
+               10.0 * log10(old.input / fmax(old.controlBand, 1e-24)),
+               10.0 * log10(plain.input / fmax(plain.controlBand, 1e-24)));
+
+        snprintf(what, sizeof(what), "    folded power within %.2f dB of analytic", POWER_TOLERANCE);
+        check((fabs(10.0 * log10(power.output / power.analytic)) <= POWER_TOLERANCE) &&
+              (fabs(10.0 * log10(old.output   / old.analytic))   <= POWER_TOLERANCE) &&
+              (fabs(10.0 * log10(plain.output / plain.analytic)) <= POWER_TOLERANCE), what);
+
+        snprintf(what, sizeof(what), "    overall and 100 Hz band rejection >= %.0f dB", SPECTRUM_REJECTION);
+        check((rejection >= SPECTRUM_REJECTION) && (controlBand >= SPECTRUM_REJECTION), what);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Taps and Cutoff Sweep
+///////////////////////////////////////////////////////////////////////////////
+
+static void sweep(void)
+{
+    designPoints_t points;
+    uint8_t        taps, pass;
+    float          cutoff;
+
+    printf("taps cutoff    200 Hz  300 Hz   500 Hz  600 Hz up  delay\n");
+
+    for (taps = 32; taps <= GYRO_DECIMATOR_MAX_TAPS; taps += 8)
+    {
+        for (cutoff = 200.0f; cutoff <= 500.0f; cutoff += 25.0f)
+        {
+            pass = designPoints(taps, cutoff, &points);
+
+            printf("%4d %6.0f  %8.2f %7.2f %8.1f %10.1f %6.2f  %s%s\n", taps, cutoff,
+                   points.pass200, points.pass300, points.stop500, points.stop600, points.delay * 1e3,
+                   pass ? "pass" : "",
+                   ((taps == eepromConfig.gyroDecimatorTaps) && (cutoff == eepromConfig.gyroDecimatorCutoff)) ? " default" : "");
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    int option;
+
+    setEEPROMDefaults();
+
+    while ((option = getopt(argc, argv, "s")) != -1)
+    {
+        switch (option)
+        {
+            case 's':
+                sweep();
+                return 0;
+
+            default:
+                fprintf(stderr, "Usage: %s [-s]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    checkResponse(eepromConfig.gyroDecimatorTaps, eepromConfig.gyroDecimatorCutoff);
+    checkDesign(eepromConfig.gyroDecimatorTaps, eepromConfig.gyroDecimatorCutoff);
+    checkSpectra(eepromConfig.gyroDecimatorTaps, eepromConfig.gyroDecimatorCutoff);
+
+    printf("\n%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
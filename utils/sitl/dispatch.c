@@ -0,0 +1,562 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+///////////////////////////////////////////////////////////////////////////////
+
+// src/scheduler.c driven by a fake uSec clock.  Each test task moves the
+// clock on by its execution time, so every count and time it records is
+// known exactly.  Checks:
+//
+//   order      highest priority pending task first, backlog high water
+//   skipped    a release while still pending is counted, not queued
+//   overrun    only executions longer than the budget
+//   timing     execution and release to start jitter min, mean and max
+//   histogram  bin edges, 0 to 15 uSec then each bin doubling, the last
+//              taking everything above
+//   wrap       jitter and execution across the 32 bit clock wrap
+//   reset      schedulerResetStats() clears counts, minimums start over
+//   load       1 kHz frames with ticks landing during a task, runs plus
+//              skips plus still pending always equal releases
+//
+// then the cost of schedulerTick() and schedulerRun() on the main.c task
+// table shape.  Exits non zero on any failure.
+//
+// Usage: dispatch
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <time.h>
+
+#include "board.h"
+
+#include "sitlCheck.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define MAX_TEST_TASKS  9
+
+#define LOAD_FRAMES     10000
+#define SPEED_FRAMES    10000000
+
+static uint32_t fakeTime;
+
+static uint32_t taskCost[MAX_TEST_TASKS];          // uSec each run adds to fakeTime
+
+static uint8_t  runOrder[64];
+static uint8_t  runs;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static double now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+///////////////////////////////////////
+
+static uint32_t fakeTimeSource(void)
+{
+    return fakeTime;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Test Tasks
+///////////////////////////////////////////////////////////////////////////////
+
+static void runTask(uint8_t index)
+{
+    if (runs < sizeof(runOrder))
+        runOrder[runs++] = index;
+
+    fakeTime += taskCost[index];
+}
+
+static void task0(void) { runTask(0); }
+static void task1(void) { runTask(1); }
+static void task2(void) { runTask(2); }
+static void task3(void) { runTask(3); }
+static void task4(void) { runTask(4); }
+static void task5(void) { runTask(5); }
+static void task6(void) { runTask(6); }
+static void task7(void) { runTask(7); }
+static void task8(void) { runTask(8); }
+
+static void (* const taskFunctions[MAX_TEST_TASKS])(void) = { task0, task1, task2, task3, task4, task5, task6, task7, task8 };
+
+static task_t tasks[MAX_TEST_TASKS];
+
+///////////////////////////////////////
+
+// Table entry n runs taskn, costs are set per check
+
+static void setTask(uint8_t index, uint16_t period, uint8_t priority, uint32_t budget)
+{
+    memset(&tasks[index], 0, sizeof(task_t));
+
+    tasks[index].name     = "test";
+    tasks[index].period   = period;
+    tasks[index].priority = priority;
+    tasks[index].budget   = budget;
+    tasks[index].function = taskFunctions[index];
+
+    taskCost[index] = 0;
+}
+
+///////////////////////////////////////
+
+static void start(uint8_t numberOfTasks, uint32_t time)
+{
+    fakeTime = time;
+    runs     = 0;
+
+    schedulerInit(tasks, numberOfTasks, fakeTimeSource);
+}
+
+///////////////////////////////////////
+
+static void runAll(void)
+{
+    while (schedulerRun());
+}
+
+///////////////////////////////////////
+
+// 1 kHz frames, a tick is delivered as soon as the clock passes it, which
+// is between two tasks when one runs across a frame boundary just as the
+// SysTick interrupt would set the flags while it ran
+
+static void simulate(uint32_t frames)
+{
+    uint32_t frame = 0, tickTime = fakeTime;
+
+    while (frame < frames)
+    {
+        while (((int32_t)(fakeTime - tickTime) >= 0) && (frame < frames))
+        {
+            schedulerTick((uint16_t)frame, tickTime);
+            frame++;
+            tickTime += 1000;
+        }
+
+        if (schedulerRun() == false)
+            fakeTime = tickTime;
+    }
+
+    runAll();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Checks
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkOrder(void)
+{
+    // Table order is not priority order
+
+    setTask(0, 10, 2, 1000);
+    setTask(1,  1, 0, 1000);
+    setTask(2,  2, 1, 1000);
+    setTask(3,  5, 3, 1000);
+
+    start(4, 0);
+
+    schedulerTick(10, 0);
+    runAll();
+
+    check((runs == 4) && (runOrder[0] == 1) && (runOrder[1] == 2) && (runOrder[2] == 0) && (runOrder[3] == 3),
+          "Frame 10 releases all four, run by priority");
+
+    check(schedulerMaxBacklog == 4, "Backlog high water 4");
+
+    runs = 0;
+
+    schedulerTick(11, 0);
+    schedulerTick(12, 0);
+    runAll();
+
+    check((runs == 2) && (runOrder[0] == 1) && (runOrder[1] == 2), "Frame 11 then 12, period 1 once, period 2 once");
+
+    runs = 0;
+
+    schedulerTick(15, 0);
+    runAll();
+
+    check((runs == 2) && (runOrder[0] == 1) && (runOrder[1] == 3), "Frame 15 releases periods 1 and 5");
+
+    check((schedulerRun() == false) && (schedulerMaxBacklog == 4), "Nothing pending, schedulerRun() false");
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+static void checkSkipped(void)
+{
+    setTask(0, 1, 0, 1000);
+
+    start(1, 100);
+
+    schedulerTick(0, 100);
+    fakeTime = 900;
+    schedulerTick(1, 900);
+    schedulerTick(2, 950);
+    fakeTime = 1000;
+    runAll();
+
+    check((tasks[0].stats.runCount == 1) && (tasks[0].stats.skippedCount == 2), "Two releases while pending, one run, two skipped");
+
+    check(tasks[0].stats.jitterMax == 900, "Jitter from the first release, 900 uSec");
+
+    schedulerTick(3, 1000);
+    runAll();
+
+    check((tasks[0].stats.runCount == 2) && (tasks[0].stats.skippedCount == 2), "Next release after the run is not skipped");
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+static void checkOverrun(void)
+{
+    static const uint32_t costs[] = { 0, 99, 100, 101, 5000 };
+
+    uint8_t n;
+
+    setTask(0, 1, 0, 100);
+
+    start(1, 0);
+
+    for (n = 0; n < sizeof(costs) / sizeof(costs[0]); n++)
+    {
+        taskCost[0] = costs[n];
+        schedulerTick(n, fakeTime);
+        runAll();
+    }
+
+    check((tasks[0].stats.runCount == 5) && (tasks[0].stats.overrunCount == 2), "Budget 100, runs of 0, 99, 100, 101, 5000 uSec, 2 overruns");
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+static void checkTiming(void)
+{
+    static const uint32_t costs[]  = { 10, 20, 60 };
+    static const uint32_t delays[] = { 5, 0, 40 };
+
+    uint8_t n;
+
+    setTask(0, 1, 0, 1000);
+
+    start(1, 0);
+
+    check((schedulerExecutionMean(&tasks[0]) == 0) && (schedulerJitterMean(&tasks[0]) == 0), "Means 0 before any run");
+
+    for (n = 0; n < 3; n++)
+    {
+        taskCost[0] = costs[n];
+        schedulerTick(n, fakeTime);
+        fakeTime += delays[n];
+        runAll();
+    }
+
+    check((tasks[0].stats.executionMin == 10) && (schedulerExecutionMean(&tasks[0]) == 30) && (tasks[0].stats.executionMax == 60),
+          "Execution 10, 20, 60 uSec, min 10 mean 30 max 60");
+
+    check((tasks[0].stats.jitterMin == 0) && (schedulerJitterMean(&tasks[0]) == 15) && (tasks[0].stats.jitterMax == 40),
+          "Jitter 5, 0, 40 uSec, min 0 mean 15 max 40");
+
+    check((tasks[0].stats.executionSum == 90) && (tasks[0].stats.jitterSum == 45), "Sums 90 and 45");
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+static void checkHistogram(void)
+{
+    // Each value with the bin it must land in
+
+    static const uint32_t values[] = { 0, 15, 16, 31, 32, 63, 64, 127, 128, 255, 256, 511, 512, 1023, 1024, 100000, UINT32_MAX };
+    static const uint8_t  bins[]   = { 0,  0,  1,  1,  2,  2,  3,   3,   4,   4,   5,   5,   6,    6,    7,      7,          7 };
+
+    uint8_t n, bin;
+    int     ok = true;
+    char    what[80];
+
+    setTask(0, 1, 0, UINT32_MAX);
+
+    start(1, 0);
+
+    for (n = 0; n < sizeof(values) / sizeof(values[0]); n++)
+    {
+        schedulerResetStats();
+
+        taskCost[0] = values[n];
+        schedulerTick(0, fakeTime - values[n]);   // Jitter the same as the execution time
+        runAll();
+
+        for (bin = 0; bin < SCHEDULER_HISTOGRAM_BINS; bin++)
+        {
+            if ((tasks[0].stats.executionHistogram[bin] != ((bin == bins[n]) ? 1 : 0)) ||
+                (tasks[0].stats.jitterHistogram[bin]    != ((bin == bins[n]) ? 1 : 0)))
+            {
+                printf("    %lu uSec landed in bin %d, expected %d\n", (unsigned long)values[n], bin, bins[n]);
+                ok = false;
+            }
+        }
+    }
+
+    snprintf(what, sizeof(what), "Bin edges 16, 32, 64 ... 1024 uSec, %d bins", SCHEDULER_HISTOGRAM_BINS);
+    check(ok, what);
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+static void checkWrap(void)
+{
+    setTask(0, 1, 0, 1000);
+
+    start(1, UINT32_MAX - 15);
+
+    taskCost[0] = 50;
+    schedulerTick(0, fakeTime);
+    fakeTime += 20;                              // Starts 4 uSec after the wrap
+    runAll();
+
+    check((tasks[0].stats.jitterMax == 20) && (tasks[0].stats.executionMax == 50) && (tasks[0].stats.overrunCount == 0),
+          "Release before the clock wrap, jitter 20 and execution 50 uSec");
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+static void checkReset(void)
+{
+    uint8_t bin;
+    int     ok = true;
+
+    setTask(0, 1, 0, 10);
+    setTask(1, 1, 1, 10);
+
+    start(2, 0);
+
+    taskCost[0] = 30;
+    taskCost[1] = 30;
+
+    schedulerTick(0, 0);
+    schedulerTick(1, 0);
+    runAll();
+
+    schedulerResetStats();
+
+    for (bin = 0; bin < SCHEDULER_HISTOGRAM_BINS; bin++)
+        if (tasks[0].stats.executionHistogram[bin] || tasks[0].stats.jitterHistogram[bin])
+            ok = false;
+
+    check(ok && (tasks[0].stats.runCount == 0) && (tasks[0].stats.overrunCount == 0) && (tasks[1].stats.skippedCount == 0) &&
+          (tasks[0].stats.executionSum == 0) && (tasks[0].stats.jitterMax == 0) && (schedulerMaxBacklog == 0),
+          "Counts, sums, maximums, histograms and backlog cleared");
+
+    check((tasks[0].stats.executionMin == UINT32_MAX) && (tasks[0].stats.jitterMin == UINT32_MAX), "Minimums start over");
+
+    taskCost[0] = 7;
+    schedulerTick(2, fakeTime);
+    runAll();
+
+    check((tasks[0].stats.executionMin == 7) && (tasks[0].stats.executionMax == 7) && (tasks[0].stats.runCount == 1),
+          "First run after the reset sets min and max");
+
+    printf("\n");
+}
+
+///////////////////////////////////////
+
+// Every release is run, skipped or still pending
+
+static int accounted(uint8_t numberOfTasks, uint32_t frames)
+{
+    uint8_t index;
+
+    for (index = 0; index < numberOfTasks; index++)
+    {
+        if (tasks[index].stats.runCount + tasks[index].stats.skippedCount + (tasks[index].pending ? 1 : 0) !=
+            (frames + tasks[index].period - 1) / tasks[index].period)
+            return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////
+
+static void checkLoad(void)
+{
+    // 700 then 400 uSec every other frame, the second runs past the
+    // frame boundary and delays the next frame's first task by 100 uSec
+
+    setTask(0, 1, 0, 650);
+    setTask(1, 2, 1, 500);
+
+    start(2, 0);
+
+    taskCost[0] = 700;
+    taskCost[1] = 400;
+
+    simulate(LOAD_FRAMES);
+
+    check((tasks[0].stats.runCount == LOAD_FRAMES) && (tasks[1].stats.runCount == LOAD_FRAMES / 2) &&
+          (tasks[0].stats.skippedCount == 0) && (tasks[1].stats.skippedCount == 0),
+          "1.1 ms every 2 ms, every release runs");
+
+    check((tasks[0].stats.jitterMin == 0) && (tasks[0].stats.jitterMax == 100) && (schedulerJitterMean(&tasks[0]) == 50) &&
+          (tasks[1].stats.jitterMin == 700) && (tasks[1].stats.jitterMax == 700),
+          "Jitter 0 and 100 uSec alternately, 700 for the second task");
+
+    check((tasks[0].stats.overrunCount == LOAD_FRAMES) && (tasks[1].stats.overrunCount == 0), "First task over its 650 uSec budget every run");
+
+    check(accounted(2, LOAD_FRAMES), "Runs, skips and pending add up to releases");
+
+    // 900 plus 300 uSec every frame, the second task starves
+
+    setTask(0, 1, 0, 1000);
+    setTask(1, 1, 1, 1000);
+    setTask(2, 7, 2, 1000);
+
+    start(3, 0);
+
+    taskCost[0] = 900;
+    taskCost[1] = 300;
+    taskCost[2] = 10;
+
+    simulate(LOAD_FRAMES);
+
+    printf("Overload, %d frames, runs/skipped %lu/%lu, %lu/%lu, %lu/%lu\n", LOAD_FRAMES,
+           (unsigned long)tasks[0].stats.runCount, (unsigned long)tasks[0].stats.skippedCount,
+           (unsigned long)tasks[1].stats.runCount, (unsigned long)tasks[1].stats.skippedCount,
+           (unsigned long)tasks[2].stats.runCount, (unsigned long)tasks[2].stats.skippedCount);
+
+    check((tasks[0].stats.runCount == LOAD_FRAMES) && (tasks[0].stats.skippedCount == 0), "1.2 ms every 1 ms, highest priority still runs every frame");
+
+    // 900 uSec every frame leaves 100, the 300 uSec task fits once in
+    // every three frames and the lowest only runs once the load stops
+
+    check((tasks[1].stats.runCount == (LOAD_FRAMES + 2) / 3) && (tasks[2].stats.runCount == 1),
+          "Second task every third frame, third starved until the end");
+
+    check(accounted(3, LOAD_FRAMES), "Runs, skips and pending add up to releases");
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Dispatch Cost
+///////////////////////////////////////////////////////////////////////////////
+
+static void speed(void)
+{
+    // The main.c table, periods in frames and priorities
+
+    static const uint16_t periods[MAX_TEST_TASKS]    = { 2, 2, 10, 20, 100, 200, 1000, 2, 2 };
+    static const uint8_t  priorities[MAX_TEST_TASKS] = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    uint32_t frame, dispatched = 0;
+    uint8_t  index;
+    double   begin, tickTime, frameTime;
+
+    for (index = 0; index < MAX_TEST_TASKS; index++)
+        setTask(index, periods[index], priorities[index], 1000);
+
+    // Ticks alone, nothing run, every release after the first is skipped
+
+    start(MAX_TEST_TASKS, 0);
+
+    begin = now();
+
+    for (frame = 0; frame < SPEED_FRAMES; frame++)
+        schedulerTick((uint16_t)frame, frame);
+
+    tickTime = now() - begin;
+
+    // Ticks and every release run, the empty scan ending each frame included
+
+    start(MAX_TEST_TASKS, 0);
+
+    begin = now();
+
+    for (frame = 0; frame < SPEED_FRAMES; frame++)
+    {
+        schedulerTick((uint16_t)frame, frame);
+
+        while (schedulerRun())
+            dispatched++;
+    }
+
+    frameTime = now() - begin;
+
+    printf("Dispatch cost, %d tasks, %lu dispatches in %d frames\n", MAX_TEST_TASKS, (unsigned long)dispatched, SPEED_FRAMES);
+    printf("    schedulerTick()  %6.1f nSec a frame\n", tickTime / SPEED_FRAMES);
+    printf("    schedulerRun()   %6.1f nSec a dispatch, the frame less its tick\n", (frameTime - tickTime) / dispatched);
+    printf("    frame            %6.1f nSec\n", frameTime / SPEED_FRAMES);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+    checkOrder();
+    checkSkipped();
+    checkOverrun();
+    checkTiming();
+    checkHistogram();
+    checkWrap();
+    checkReset();
+    checkLoad();
+
+    speed();
+
+    printf("\n%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,260 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Check of src/dshot.c, the DShot frames and DMA buffers drv_pwmEsc.c
+// sends, against an independent encoder written from the protocol:
+//
+//   - every 11 bit value with and without the telemetry bit, value, bit
+//     and checksum in place, the published 1046 example
+//   - motor commands onto throttle values, stop at and below MINCOMMAND,
+//     48 just above it, 2047 at and above MAXCOMMAND, never decreasing
+//   - DShot150, 300 and 600 bit timing inside the ESC tolerances
+//   - interleaved buffers for each timer's burst, decoded back to the
+//     frame, low after it and no other channel touched
+//
+// Exits non zero on any failure.  The encode throughput is the dshot
+// stage of bench.
+//
+// Usage: dshotout
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+
+#include "sitlCheck.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define SENTINEL 0xA5A5A5A5
+
+///////////////////////////////////////////////////////////////////////////////
+// Reference Encoder, bit by bit from the protocol description
+///////////////////////////////////////////////////////////////////////////////
+
+static uint16_t referenceFrame(uint16_t value, uint8_t telemetry)
+{
+    uint8_t  bits[12], crc[4] = { 0, 0, 0, 0 }, i;
+    uint16_t frame = 0;
+
+    for (i = 0; i < 11; i++)
+        bits[i] = (value >> (10 - i)) & 1;
+
+    bits[11] = telemetry;
+
+    // Checksum bit n is the XOR of bit n of each of the three nibbles
+
+    for (i = 0; i < 12; i++)
+        crc[i % 4] ^= bits[i];
+
+    for (i = 0; i < 12; i++)
+        frame = (uint16_t)((frame << 1) | bits[i]);
+
+    for (i = 0; i < 4; i++)
+        frame = (uint16_t)((frame << 1) | crc[i]);
+
+    return frame;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Frames
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkFrames(void)
+{
+    uint32_t value;
+    uint8_t  telemetry;
+    int      ok = true;
+
+    for (value = 0; value <= DSHOT_MAX_THROTTLE; value++)
+        for (telemetry = 0; telemetry < 2; telemetry++)
+            if (dshotFrame((uint16_t)value, telemetry) != referenceFrame((uint16_t)value, telemetry))
+                ok = false;
+
+    check(ok, "Frames match the reference encoder, 4096 cases");
+
+    check(dshotFrame(1046, 0) == 0x82C6, "1046 without telemetry is 0x82C6");
+    check(dshotFrame(0, 0) == 0x0000, "Stop is an all zero frame");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Motor Commands
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkValues(void)
+{
+    uint32_t command;
+    uint16_t value, last = 0;
+    int      ok = true;
+
+    for (command = 0; command <= 2 * MAXCOMMAND; command++)
+    {
+        value = dshotValue((uint16_t)command);
+
+        if ((command <= MINCOMMAND) && (value != 0))
+            ok = false;
+
+        if ((command > MINCOMMAND) && ((value < DSHOT_MIN_THROTTLE) || (value > DSHOT_MAX_THROTTLE)))
+            ok = false;
+
+        if (value < last)
+            ok = false;
+
+        last = value;
+    }
+
+    check(ok, "Commands map to stop or 48 to 2047, never decreasing");
+
+    check((dshotValue(MINCOMMAND + 1) == DSHOT_MIN_THROTTLE) && (dshotValue(MAXCOMMAND) == DSHOT_MAX_THROTTLE),
+          "MINCOMMAND + 1 is 48, MAXCOMMAND is 2047");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Bit Timing
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkTiming(uint8_t protocol, const char *name, double bitRate)
+{
+    escTiming_t timing;
+    char        what[80];
+    double      tick, bit, one, zero;
+
+    escTimingInit(&timing, protocol, 450);
+
+    tick = 1.0e9 / ESC_TIMER_CLOCK;
+    bit  = timing.dshot.bitTicks  * tick;
+    one  = timing.dshot.oneTicks  * tick;
+    zero = timing.dshot.zeroTicks * tick;
+
+    snprintf(what, sizeof(what), "%s bit %.1f ns, 1 high %.1f ns, 0 high %.1f ns", name, bit, one, zero);
+
+    // Within 2 % of the bit rate and 1 % of a bit on each high time
+
+    check((timing.period == timing.dshot.bitTicks - 1) && (timing.onePulse == false) &&
+          (fabs(bit - 1.0e9 / bitRate) < 0.02 * bit) &&
+          (fabs(one  - 0.750 * bit) < 0.01 * bit) &&
+          (fabs(zero - 0.375 * bit) < 0.01 * bit), what);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DMA Buffers
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkBuffers(void)
+{
+    escTiming_t timing;
+    uint32_t    buffer[NUMBER_OF_ESC_TIMERS][DSHOT_BUFFER_BITS * DSHOT_MAX_CHANNELS];
+    uint16_t    frames[8], decoded;
+    uint8_t     output, timer, channels, bit, slot;
+    uint32_t    trial, entry;
+    int         decodes = true, trailing = true, untouched = true, layout = true;
+
+    escTimingInit(&timing, ESC_PROTOCOL_DSHOT600, 450);
+
+    for (timer = 0; timer < NUMBER_OF_ESC_TIMERS; timer++)
+        if ((escTimerChannels(timer) < 1) || (escTimerChannels(timer) > DSHOT_MAX_CHANNELS))
+            layout = false;
+
+    check(layout && (escTimerChannels(ESC_TIMER_TIM8) == 4) &&
+          (escTimerChannels(ESC_TIMER_TIM2) == 2) && (escTimerChannels(ESC_TIMER_TIM3) == 2),
+          "Bursts of 4, 2 and 2 channels for TIM8, TIM2 and TIM3");
+
+    srand(1);
+
+    for (trial = 0; trial < 1000; trial++)
+    {
+        for (timer = 0; timer < NUMBER_OF_ESC_TIMERS; timer++)
+            for (entry = 0; entry < DSHOT_BUFFER_BITS * DSHOT_MAX_CHANNELS; entry++)
+                buffer[timer][entry] = SENTINEL;
+
+        // One output at a time so the others still hold the sentinel
+
+        output = (uint8_t)(trial % 8);
+        timer  = escOutputs[output].timer;
+
+        channels       = escTimerChannels(timer);
+        slot           = escOutputs[output].channel - 1;
+        frames[output] = dshotFrame((uint16_t)(rand() % (DSHOT_MAX_THROTTLE + 1)), (uint8_t)(rand() & 1));
+
+        dshotEncode(&buffer[timer][slot], channels, frames[output], &timing.dshot);
+
+        for (bit = 0, decoded = 0; bit < DSHOT_FRAME_BITS; bit++)
+        {
+            entry   = buffer[timer][bit * channels + slot];
+            decoded = (uint16_t)((decoded << 1) | ((entry == timing.dshot.oneTicks) ? 1 : 0));
+
+            if ((entry != timing.dshot.oneTicks) && (entry != timing.dshot.zeroTicks))
+                decodes = false;
+        }
+
+        if (decoded != frames[output])
+            decodes = false;
+
+        for (; bit < DSHOT_BUFFER_BITS; bit++)
+            if (buffer[timer][bit * channels + slot] != 0)
+                trailing = false;
+
+        for (timer = 0; timer < NUMBER_OF_ESC_TIMERS; timer++)
+            for (entry = 0; entry < DSHOT_BUFFER_BITS * DSHOT_MAX_CHANNELS; entry++)
+                if ((timer != escOutputs[output].timer) || (entry % channels != slot) ||
+                    (entry >= (uint32_t)DSHOT_BUFFER_BITS * channels))
+                    if (buffer[timer][entry] != SENTINEL)
+                        untouched = false;
+    }
+
+    check(decodes,   "Buffers decode back to the frame on every output");
+    check(trailing,  "Two low bit periods after each frame");
+    check(untouched, "No other channel or timer touched");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+    checkFrames();
+    checkValues();
+
+    checkTiming(ESC_PROTOCOL_DSHOT150, "DShot150", 150000.0);
+    checkTiming(ESC_PROTOCOL_DSHOT300, "DShot300", 300000.0);
+    checkTiming(ESC_PROTOCOL_DSHOT600, "DShot600", 600000.0);
+
+    checkBuffers();
+
+    printf("\n%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,204 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Check of src/escProtocol.c, the part of the ESC outputs that does not
+// touch the timers.  For each protocol every motor command from 0 to past
+// MAXCOMMAND is converted the way pwmEscWrite() does and checked for:
+//
+//   - PWM compare values equal to the command, period from escPwmRate
+//   - OneShot pulse widths of PWM width / 8 or / 24, to half a tick
+//   - OneShot compare values that leave the pin low with the counter
+//     stopped at zero and give exactly the pulse width before the end of
+//     the period, all inside a 16 bit timer
+//   - commands past MAXCOMMAND held at the longest pulse
+//
+// The output map is checked against the board's pin list.  Exits non zero
+// on any failure.
+//
+// Usage: escout
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+
+#include "sitlCheck.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define TICK_US  (1.0e6 / ESC_TIMER_CLOCK)   // OneShot timer tick
+
+///////////////////////////////////////////////////////////////////////////////
+// PWM
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkPwm(uint16_t escPwmRate)
+{
+    escTiming_t timing;
+    char        what[80];
+    uint32_t    command;
+    int         ok;
+
+    escTimingInit(&timing, ESC_PROTOCOL_PWM, escPwmRate);
+
+    ok = (timing.onePulse == false) && (timing.prescaler == 42) &&
+         (timing.period == (uint16_t)(2000000 / escPwmRate) - 1);
+
+    for (command = 0; ok && (command <= 2 * MAXCOMMAND); command++)
+        ok = (escCompare(&timing, (uint16_t)command) == command);
+
+    snprintf(what, sizeof(what), "PWM %3u Hz, period %5u, compare equals command", escPwmRate, timing.period);
+    check(ok, what);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// OneShot
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkOneShot(uint8_t protocol, const char *name, double minWidth, double maxWidth)
+{
+    escTiming_t timing;
+    char        what[80];
+    double      exact, error, worst = 0.0;
+    uint32_t    command, ticks, compare, last = 0;
+    int         widths = true, compares = true, held = true, monotonic = true;
+
+    escTimingInit(&timing, protocol, 450);
+
+    for (command = 0; command <= 2 * MAXCOMMAND; command++)
+    {
+        ticks   = escPulseTicks(&timing, (uint16_t)command);
+        compare = escCompare(&timing, (uint16_t)command);
+
+        if (command <= MAXCOMMAND)
+        {
+            exact = (command / 2.0) / timing.divisor / TICK_US;
+            error = fabs(ticks - exact);
+
+            if (error > worst)
+                worst = error;
+        }
+        else if (ticks != escPulseTicks(&timing, MAXCOMMAND))
+        {
+            held = false;
+        }
+
+        if ((compare < 1) || (compare > timing.period + 1) || (timing.period + 1 - compare != ticks))
+            compares = false;
+
+        if (ticks < last)
+            monotonic = false;
+
+        last = ticks;
+    }
+
+    if ((worst > 0.5) ||
+        (fabs(escPulseTicks(&timing, MINCOMMAND) * TICK_US - minWidth) > TICK_US) ||
+        (fabs(escPulseTicks(&timing, MAXCOMMAND) * TICK_US - maxWidth) > TICK_US))
+        widths = false;
+
+    snprintf(what, sizeof(what), "%s width %.2f to %.2f uSec, max error %.3f ticks", name,
+             escPulseTicks(&timing, MINCOMMAND) * TICK_US, escPulseTicks(&timing, MAXCOMMAND) * TICK_US, worst);
+    check(widths && monotonic && timing.onePulse && (timing.prescaler == 1), what);
+
+    snprintf(what, sizeof(what), "%s compare idles low, gives the width", name);
+    check(compares, what);
+
+    snprintf(what, sizeof(what), "%s past MAXCOMMAND held at the longest pulse", name);
+    check(held, what);
+
+    snprintf(what, sizeof(what), "%s period %5u fits 16 bits, trigger to end %.1f uSec", name,
+             timing.period, (timing.period + 1) * TICK_US);
+    check((timing.period <= 0xFFFF) && ((timing.period + 1) * TICK_US <= maxWidth + ESC_ONESHOT_LEAD * TICK_US + TICK_US), what);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Output Map
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkOutputs(void)
+{
+    // ESC PWM1 TIM8_CH4 PC9    ESC PWM5 TIM2_CH2 PB3
+    // ESC PWM2 TIM8_CH3 PC8    ESC PWM6 TIM3_CH1 PB4
+    // ESC PWM3 TIM8_CH2 PC7    ESC PWM7 TIM3_CH2 PB5
+    // ESC PWM4 TIM8_CH1 PC6    ESC PWM8 TIM2_CH1 PA15
+
+    static const escOutput_t pins[8] = { { ESC_TIMER_TIM8, 4 }, { ESC_TIMER_TIM8, 3 },
+                                         { ESC_TIMER_TIM8, 2 }, { ESC_TIMER_TIM8, 1 },
+                                         { ESC_TIMER_TIM2, 2 }, { ESC_TIMER_TIM3, 1 },
+                                         { ESC_TIMER_TIM3, 2 }, { ESC_TIMER_TIM2, 1 }, };
+    uint8_t i, j;
+    int     ok = true;
+
+    for (i = 0; i < 8; i++)
+    {
+        if ((escOutputs[i].timer >= NUMBER_OF_ESC_TIMERS) || (escOutputs[i].channel < 1) || (escOutputs[i].channel > 4))
+            ok = false;
+
+        if ((escOutputs[i].timer != pins[i].timer) || (escOutputs[i].channel != pins[i].channel))
+            ok = false;
+
+        for (j = 0; j < i; j++)
+            if ((escOutputs[i].timer == escOutputs[j].timer) && (escOutputs[i].channel == escOutputs[j].channel))
+                ok = false;
+    }
+
+    check(ok, "Output map matches the pin list, no shared channels");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+    escTiming_t timing;
+
+    checkPwm(50);
+    checkPwm(400);
+    checkPwm(450);
+
+    checkOneShot(ESC_PROTOCOL_ONESHOT125, "OneShot125", 125.0, 250.0);
+    checkOneShot(ESC_PROTOCOL_ONESHOT42,  "OneShot42",  1000.0 / 24.0, 2000.0 / 24.0);
+
+    escTimingInit(&timing, NUMBER_OF_ESC_PROTOCOLS, 450);
+    check(timing.protocol == ESC_PROTOCOL_PWM, "Unknown protocol falls back to PWM");
+
+    checkOutputs();
+
+    printf("\n%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
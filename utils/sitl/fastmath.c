@@ -0,0 +1,245 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Accuracy and speed check of src/fastMath.c against libm.  Errors are
+// measured against the double precision libm result over dense sweeps of
+// the input ranges the flight code uses, and checked against the bounds
+// documented in fastMath.h.  Speed is ns/call for the fast version and the
+// float libm version over the same inputs.  Exits non zero when a bound is
+// exceeded, so it can gate a change to the approximations.
+//
+// Usage: fastmath
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <time.h>
+
+#include "board.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define SAMPLES 1000000
+
+static float inputA[SAMPLES], inputB[SAMPLES];
+
+static volatile float sink;
+
+static int failures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static double now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+///////////////////////////////////////
+
+static void report(const char *name, double error, double bound, const char *unit, double fastNs, double libmNs)
+{
+    uint8_t pass = (error <= bound);
+
+    printf("%-11s %10.3g %-4s (bound %8.3g)  %6.2f ns  libm %6.2f ns  %s\n",
+           name, error, unit, bound, fastNs, libmNs, pass ? "ok" : "FAIL");
+
+    if (pass == false)
+        failures++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Timing, the same loop around each function
+///////////////////////////////////////////////////////////////////////////////
+
+#define TIME_LOOP(result, expression)                    \
+    do                                                   \
+    {                                                    \
+        double start = now();                            \
+        float  sum   = 0.0f;                             \
+        for (i = 0; i < SAMPLES; i++)                    \
+            sum += (expression);                         \
+        sink   = sum;                                    \
+        result = (now() - start) / SAMPLES;              \
+    } while (0)
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+    uint32_t i;
+    double   error, maxError, reference, fastNs, libmNs;
+    float    angle;
+
+    ///////////////////////////////////
+
+    // sqrt, whole positive range up to 1e6, must be exact
+
+    for (i = 0; i < SAMPLES; i++)
+        inputA[i] = 1e6f * (float)i / SAMPLES;
+
+    maxError = 0.0;
+
+    for (i = 0; i < SAMPLES; i++)
+    {
+        error = fabs((double)fastSqrtf(inputA[i]) - (double)sqrtf(inputA[i]));
+
+        if (error > maxError)
+            maxError = error;
+    }
+
+    TIME_LOOP(fastNs, fastSqrtf(inputA[i]));
+    TIME_LOOP(libmNs, sqrtf(inputA[i]));
+
+    report("fastSqrtf", maxError, 0.0, "abs", fastNs, libmNs);
+
+    ///////////////////////////////////
+
+    // atan2, points on circles of several radii all the way round plus
+    // the axes and the origin
+
+    for (i = 0; i < SAMPLES; i++)
+    {
+        angle     = TWO_PI * (float)i / SAMPLES - PI;
+        inputA[i] = powf(10.0f, (float)(i % 7) - 3.0f) * sinf(angle);
+        inputB[i] = powf(10.0f, (float)(i % 7) - 3.0f) * cosf(angle);
+    }
+
+    inputA[0] = 0.0f;  inputB[0] =  0.0f;
+    inputA[1] = 0.0f;  inputB[1] = -1.0f;
+    inputA[2] = 1.0f;  inputB[2] =  0.0f;
+
+    maxError = 0.0;
+
+    for (i = 0; i < SAMPLES; i++)
+    {
+        error = fabs((double)fastAtan2f(inputA[i], inputB[i]) - atan2((double)inputA[i], (double)inputB[i]));
+
+        if (error > PI)
+            error = fabs(error - 2.0 * M_PI);  // +pi and -pi on the negative x axis
+
+        if (error > maxError)
+            maxError = error;
+    }
+
+    TIME_LOOP(fastNs, fastAtan2f(inputA[i], inputB[i]));
+    TIME_LOOP(libmNs, atan2f(inputA[i], inputB[i]));
+
+    report("fastAtan2f", maxError, 2.0e-5, "rad", fastNs, libmNs);
+
+    ///////////////////////////////////
+
+    // asin, -1 to 1 and a little past either end
+
+    for (i = 0; i < SAMPLES; i++)
+        inputA[i] = -1.0f + 2.0f * (float)i / (SAMPLES - 1);
+
+    maxError = 0.0;
+
+    for (i = 0; i < SAMPLES; i++)
+    {
+        error = fabs((double)fastAsinf(inputA[i]) - asin((double)inputA[i]));
+
+        if (error > maxError)
+            maxError = error;
+    }
+
+    if (fabsf(fastAsinf(1.0000001f) - PI / 2.0f) > 2.0e-5f)
+        maxError = INFINITY;
+
+    TIME_LOOP(fastNs, fastAsinf(inputA[i]));
+    TIME_LOOP(libmNs, asinf(inputA[i]));
+
+    report("fastAsinf", maxError, 2.0e-5, "rad", fastNs, libmNs);
+
+    ///////////////////////////////////
+
+    // pow, the barometer's pressure ratio and exponent first, then a wide
+    // sweep of bases and exponents
+
+    for (i = 0; i < SAMPLES; i++)
+    {
+        if (i < SAMPLES / 2)
+        {
+            inputA[i] = 0.3f + 0.8f * (float)i / (SAMPLES / 2);
+            inputB[i] = 1.0f / 5.255f;
+        }
+        else
+        {
+            inputA[i] = powf(10.0f, -6.0f + 12.0f * (float)(i - SAMPLES / 2) / (SAMPLES / 2));
+            inputB[i] = -3.0f + 6.0f * (float)(i % 1000) / 1000.0f;
+        }
+    }
+
+    maxError = 0.0;
+
+    for (i = 0; i < SAMPLES; i++)
+    {
+        reference = pow((double)inputA[i], (double)inputB[i]);
+        error     = fabs((double)fastPowf(inputA[i], inputB[i]) - reference) / reference;
+
+        if (error > maxError)
+            maxError = error;
+    }
+
+    TIME_LOOP(fastNs, fastPowf(inputA[i], inputB[i]));
+    TIME_LOOP(libmNs, powf(inputA[i], inputB[i]));
+
+    report("fastPowf", maxError, 5.0e-6, "rel", fastNs, libmNs);
+
+    // Altitude the barometer would report, error in meters over 0 to 9 km
+
+    maxError = 0.0;
+
+    for (i = 0; i < 100000; i++)
+    {
+        float pressure = 30000.0f + 75000.0f * (float)i / 100000;
+
+        reference = 44330.0 * (1.0 - pow(pressure / 101325.0, 1.0 / 5.255));
+        error     = fabs(44330.0f * (1.0f - fastPowf(pressure / 101325.0f, 1.0f / 5.255f)) - reference);
+
+        if (error > maxError)
+            maxError = error;
+    }
+
+    report("  altitude", maxError, 0.05, "m", 0.0, 0.0);
+
+    return (failures > 0) ? 1 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,466 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Frequency response check of src/filterBank.c.  Every default chain from
+// setEEPROMDefaults() and a set of sample chains of each section type are
+// driven with sines through filterChainBlock(), the float path the board
+// runs, and the gain fitted from the output is compared with the analytic
+// response of the designed coefficients.  The analytic response is then
+// checked at the design points of each type: unity pass band, -3 dB at
+// cutoffs and band edges, notch depth at the center.  Sections that
+// cannot be realized must be rejected and leave a pass through chain.
+// Exits non zero on any failure, so it can gate a change to the designs.
+//
+// Usage: filters [-o file]
+//
+//   -o  CSV of frequency, analytic and measured gain in dB for plotting
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <getopt.h>
+
+#include "board.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define POINTS           24            // Log spaced test frequencies per chain
+#define FIT_CYCLES       20            // Sine periods in each gain fit
+#define MAX_SAMPLES      400000
+
+#define MEASURE_TOLERANCE  1.0e-4      // Absolute, fitted against analytic gain
+#define DESIGN_TOLERANCE   0.05        // dB at the design points
+
+static float32_t input[MAX_SAMPLES], output[MAX_SAMPLES];
+
+static FILE *csv = NULL;
+
+static int failures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct filterTest_t
+{
+    const char            *name;
+    float                 sampleRate;
+    filterSectionConfig_t config[FILTER_SECTIONS];
+} filterTest_t;
+
+static const filterTest_t tests[] =
+{
+    { "lowpass1 50",          500.0f, { { FILTER_LOWPASS1,   50.0f,  0.0f    } } },
+    { "highpass1 5",          500.0f, { { FILTER_HIGHPASS1,   5.0f,  0.0f    } } },
+    { "lowpass2 80 Q0.707",   500.0f, { { FILTER_LOWPASS2,   80.0f,  0.7071f } } },
+    { "lowpass2 80 Q2",       500.0f, { { FILTER_LOWPASS2,   80.0f,  2.0f    } } },
+    { "lowpass2 200 Q0.707",  500.0f, { { FILTER_LOWPASS2,  200.0f,  0.7071f } } },
+    { "notch 120 Q3",         500.0f, { { FILTER_NOTCH,     120.0f,  3.0f    } } },
+    { "notch 20 Q10",         100.0f, { { FILTER_NOTCH,      20.0f, 10.0f    } } },
+    { "bandstop 100-160",     500.0f, { { FILTER_BANDSTOP,  100.0f, 160.0f   } } },
+    { "cascade",              500.0f, { { FILTER_LOWPASS2,   90.0f,  0.7071f },
+                                        { FILTER_NOTCH,     150.0f,  4.0f    },
+                                        { FILTER_BANDSTOP,  180.0f, 220.0f   },
+                                        { FILTER_HIGHPASS1,   1.0f,  0.0f    } } },
+};
+
+#define NUMBER_OF_TESTS (sizeof(tests) / sizeof(tests[0]))
+
+static const filterTest_t invalidTests[] =
+{
+    { "cutoff at nyquist",    500.0f, { { FILTER_LOWPASS1,  250.0f,  0.0f    } } },
+    { "zero frequency",       500.0f, { { FILTER_HIGHPASS1,   0.0f,  0.0f    } } },
+    { "zero Q",               500.0f, { { FILTER_NOTCH,     100.0f,  0.0f    } } },
+    { "edges reversed",       500.0f, { { FILTER_BANDSTOP,  160.0f, 100.0f   } } },
+    { "upper edge nyquist",   500.0f, { { FILTER_BANDSTOP,  100.0f, 250.0f   } } },
+    { "bad second section",   500.0f, { { FILTER_LOWPASS1,   50.0f,  0.0f    },
+                                        { NUMBER_OF_FILTER_TYPES, 50.0f, 0.0f } } },
+};
+
+#define NUMBER_OF_INVALID_TESTS (sizeof(invalidTests) / sizeof(invalidTests[0]))
+
+///////////////////////////////////////////////////////////////////////////////
+// Analytic Gain of the Designed Coefficients
+///////////////////////////////////////////////////////////////////////////////
+
+static double analyticGain(const filterChain_t *chain, double frequency)
+{
+    const float32_t *c;
+    double          w = 2.0 * M_PI * frequency / chain->sampleRate;
+    double          gain = 1.0, nr, ni, dr, di;
+    uint8_t         section;
+
+    for (section = 0; section < chain->sections; section++)
+    {
+        c = &chain->coefficients[5 * section];
+
+        // CMSIS signs, the denominator is 1 - a1 z^-1 - a2 z^-2
+
+        nr = c[0] + c[1] * cos(w) + c[2] * cos(2.0 * w);
+        ni =      - c[1] * sin(w) - c[2] * sin(2.0 * w);
+        dr = 1.0  - c[3] * cos(w) - c[4] * cos(2.0 * w);
+        di =        c[3] * sin(w) + c[4] * sin(2.0 * w);
+
+        gain *= sqrt((nr * nr + ni * ni) / (dr * dr + di * di));
+    }
+
+    return gain;
+}
+
+///////////////////////////////////////
+
+static double dB(double gain)
+{
+    return 20.0 * log10(gain > 1e-12 ? gain : 1e-12);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Measured Gain, least squares fit of a sine to the settled output
+///////////////////////////////////////////////////////////////////////////////
+
+static double measuredGain(const filterTest_t *test, double frequency, uint32_t settle)
+{
+    filterChain_t chain;
+    uint32_t      fit, i;
+    double        w, s, c, ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0, det, a, b;
+
+    filterChainInit(&chain, test->config, 1, test->sampleRate);
+
+    fit    = (uint32_t)(FIT_CYCLES * test->sampleRate / frequency);
+
+    if (fit < 200)
+        fit = 200;
+
+    if (settle + fit > MAX_SAMPLES)
+        settle = MAX_SAMPLES - fit;
+
+    w = 2.0 * M_PI * frequency / test->sampleRate;
+
+    for (i = 0; i < settle + fit; i++)
+        input[i] = (float32_t)sin(w * i);
+
+    filterChainBlock(&chain, 0, input, output, settle + fit);
+
+    for (i = settle; i < settle + fit; i++)
+    {
+        s = sin(w * i);
+        c = cos(w * i);
+
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        ys += output[i] * s;
+        yc += output[i] * c;
+    }
+
+    det = ss * cc - sc * sc;
+    a   = (ys * cc - yc * sc) / det;
+    b   = (yc * ss - ys * sc) / det;
+
+    return sqrt(a * a + b * b);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Check One Design Point
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkPoint(const char *name, const char *what, double measured, double expected)
+{
+    uint8_t pass = (fabs(dB(measured) - dB(expected)) <= DESIGN_TOLERANCE);
+
+    printf("    %-22s %8.3f dB  (expected %8.3f dB)  %s\n", what, dB(measured), dB(expected), pass ? "ok" : "FAIL");
+
+    if (pass == false)
+    {
+        printf("        in %s\n", name);
+        failures++;
+    }
+}
+
+///////////////////////////////////////
+
+static void checkDepth(const char *name, const char *what, double measured, double bound)
+{
+    uint8_t pass = (dB(measured) <= bound);
+
+    printf("    %-22s %8.3f dB  (bound    %8.3f dB)  %s\n", what, dB(measured), bound, pass ? "ok" : "FAIL");
+
+    if (pass == false)
+    {
+        printf("        in %s\n", name);
+        failures++;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Design Points of a Single Section
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkDesign(const filterTest_t *test, const filterChain_t *chain)
+{
+    const filterSectionConfig_t *config = &test->config[0];
+    double                      nyquist = test->sampleRate / 2.0, halfPower = M_SQRT1_2, k1, k2, center;
+
+    if ((chain->sections != 1) || (test->config[1].type != FILTER_NONE))
+        return;
+
+    switch (config->type)
+    {
+        case FILTER_LOWPASS1:
+            checkPoint(test->name, "dc",     analyticGain(chain, 0.0),               1.0);
+            checkPoint(test->name, "cutoff", analyticGain(chain, config->frequency), halfPower);
+            checkDepth(test->name, "nyquist", analyticGain(chain, nyquist), -60.0);
+            break;
+
+        case FILTER_HIGHPASS1:
+            checkPoint(test->name, "nyquist", analyticGain(chain, nyquist),           1.0);
+            checkPoint(test->name, "cutoff",  analyticGain(chain, config->frequency), halfPower);
+            checkDepth(test->name, "dc",      analyticGain(chain, 0.0), -60.0);
+            break;
+
+        case FILTER_LOWPASS2:
+            // Gain at the prewarped cutoff is Q, -3 dB for Butterworth
+
+            checkPoint(test->name, "dc",     analyticGain(chain, 0.0),               1.0);
+            checkPoint(test->name, "cutoff", analyticGain(chain, config->frequency), config->parameter);
+            checkDepth(test->name, "nyquist", analyticGain(chain, nyquist), -60.0);
+            break;
+
+        case FILTER_NOTCH:
+            checkPoint(test->name, "dc",      analyticGain(chain, 0.0),     1.0);
+            checkPoint(test->name, "nyquist", analyticGain(chain, nyquist), 1.0);
+            checkDepth(test->name, "center",  analyticGain(chain, config->frequency), -40.0);
+            break;
+
+        case FILTER_BANDSTOP:
+            // Deepest at the prewarped geometric center of the edges
+
+            k1     = tan(M_PI * config->frequency / test->sampleRate);
+            k2     = tan(M_PI * config->parameter / test->sampleRate);
+            center = atan(sqrt(k1 * k2)) * test->sampleRate / M_PI;
+
+            checkPoint(test->name, "dc",         analyticGain(chain, 0.0),               1.0);
+            checkPoint(test->name, "lower edge", analyticGain(chain, config->frequency), halfPower);
+            checkPoint(test->name, "upper edge", analyticGain(chain, config->parameter), halfPower);
+            checkDepth(test->name, "center",     analyticGain(chain, center), -40.0);
+            break;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Run One Chain
+///////////////////////////////////////////////////////////////////////////////
+
+static void runTest(const filterTest_t *test)
+{
+    filterChain_t chain;
+    double        lowest = test->sampleRate / 2.0, frequency, analytic, measured, error, maxError = 0.0;
+    double        a1, a2, radius, slowest = 0.0, value;
+    uint32_t      settle;
+    uint8_t       section, point;
+
+    if (filterChainInit(&chain, test->config, 1, test->sampleRate) == false)
+    {
+        printf("%-22s design rejected  FAIL\n", test->name);
+        failures++;
+        return;
+    }
+
+    // Sweep from a decade below the lowest design frequency to near nyquist,
+    // settling until the slowest pole has decayed to float resolution
+
+    for (section = 0; section < chain.sections; section++)
+    {
+        if (test->config[section].frequency < lowest)
+            lowest = test->config[section].frequency;
+
+        a1 = chain.coefficients[5 * section + 3];
+        a2 = chain.coefficients[5 * section + 4];
+
+        if (a1 * a1 + 4.0 * a2 < 0.0)
+            radius = sqrt(-a2);
+        else
+            radius = (fabs(a1) + sqrt(a1 * a1 + 4.0 * a2)) / 2.0;
+
+        if (radius > slowest)
+            slowest = radius;
+    }
+
+    settle = (slowest > 0.0) ? (uint32_t)(log(1e-8) / log(slowest)) : 0;
+
+    for (point = 0; point < POINTS; point++)
+    {
+        frequency = lowest / 10.0 * pow(0.45 * test->sampleRate / (lowest / 10.0), (double)point / (POINTS - 1));
+        analytic  = analyticGain(&chain, frequency);
+        measured  = measuredGain(test, frequency, settle);
+        error     = fabs(measured - analytic);
+
+        if (error > maxError)
+            maxError = error;
+
+        if (csv != NULL)
+            fprintf(csv, "%s,%.6f,%.4f,%.4f\n", test->name, frequency, dB(analytic), dB(measured));
+    }
+
+    printf("%-22s %1d sections  %6.1f Hz  fitted gain error %9.2e  %s\n",
+           test->name, chain.sections, test->sampleRate, maxError, maxError <= MEASURE_TOLERANCE ? "ok" : "FAIL");
+
+    if (maxError > MEASURE_TOLERANCE)
+        failures++;
+
+    checkDesign(test, &chain);
+
+    // A settled chain passes a constant at its dc gain from the first sample
+
+    value = 1.5;
+
+    filterChainSettle(&chain, 0, (float)value);
+
+    input[0] = (float32_t)value;
+
+    filterChainBlock(&chain, 0, input, output, 1);
+
+    error = fabs(output[0] - value * analyticGain(&chain, 0.0));
+
+    if (error > 1e-4)
+    {
+        printf("    settle                 %9.2e  FAIL\n", error);
+        failures++;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    filterTest_t  test;
+    filterChain_t chain;
+    uint32_t      i;
+    uint8_t       rejected;
+    int           option;
+
+    while ((option = getopt(argc, argv, "o:")) != -1)
+    {
+        switch (option)
+        {
+            case 'o':
+                if ((csv = fopen(optarg, "w")) == NULL)
+                {
+                    perror(optarg);
+                    return 1;
+                }
+
+                fprintf(csv, "chain,frequency,analytic dB,measured dB\n");
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-o file]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    ///////////////////////////////////
+
+    // Default chains, at the rates of the tasks that run them
+
+    setEEPROMDefaults();
+    filterBankInit();
+
+    printf("Default chains\n");
+
+    for (i = 0; i < NUMBER_OF_FILTER_CHAINS; i++)
+    {
+        memset(&test, 0, sizeof(test));
+
+        test.name       = (i == GYRO500HZ_FILTER)        ? "default gyro 500" :
+                          (i == ACCEL500HZ_FILTER)       ? "default accel 500" :
+                          (i == ACCEL100HZ_FILTER)       ? "default accel 100" :
+                          (i == PRESSURE_ALT50HZ_FILTER) ? "default pressure 50" : "default earth 100";
+        test.sampleRate = filterChains[i].sampleRate;
+
+        memcpy(test.config, eepromConfig.filters[i], sizeof(test.config));
+
+        if (filterChains[i].sections == 0)
+        {
+            // Empty chain, a pass through
+
+            input[0] = 0.25f;
+
+            filterChainBlock(&filterChains[i], 0, input, output, 1);
+
+            printf("%-22s pass through  %s\n", test.name, (output[0] == input[0]) ? "ok" : "FAIL");
+
+            if (output[0] != input[0])
+                failures++;
+
+            continue;
+        }
+
+        runTest(&test);
+    }
+
+    ///////////////////////////////////
+
+    printf("\nSection types\n");
+
+    for (i = 0; i < NUMBER_OF_TESTS; i++)
+        runTest(&tests[i]);
+
+    ///////////////////////////////////
+
+    printf("\nRejected designs\n");
+
+    for (i = 0; i < NUMBER_OF_INVALID_TESTS; i++)
+    {
+        rejected = (filterChainInit(&chain, invalidTests[i].config, 1, invalidTests[i].sampleRate) == false) &&
+                   (chain.sections == 0);
+
+        printf("%-22s %s\n", invalidTests[i].name, rejected ? "ok" : "FAIL");
+
+        if (rejected == false)
+            failures++;
+    }
+
+    ///////////////////////////////////
+
+    if (csv != NULL)
+        fclose(csv);
+
+    printf("\n%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,616 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Check of the matrix mixer in src/mixer.c.  Each airframe's mixerMatrix
+// from initMixer() is multiplied out against random commands and compared
+// with the PIDMIX switch mixTable() used before the matrix, kept below as
+// legacyMix().  Both yaw directions and a non default V tail angle are
+// covered.  mixTable() is then driven hard enough to saturate and every
+// output is checked for the desaturation rules:
+//
+//   - all motors between minThrottle and maxThrottle
+//   - an unsaturated mix comes out exactly as the matrix product
+//   - roll and pitch are passed whole whenever their spread fits, only the
+//     collective moves and yaw is scaled by a factor from 0 to 1
+//   - a roll and pitch spread wider than the range is scaled to just fit,
+//     with no yaw
+//
+// Exits non zero on any failure, so it can gate a change to the mixer.
+//
+// Usage: mixtable [-n trials] [-s seed]
+//
+//   -n  Random commands per airframe and check, default 2000
+//   -s  Seed, default 1
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <getopt.h>
+
+#include "board.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define MATRIX_TOLERANCE  1.0e-3       // PWM counts, float rounding of the product
+#define FIT_TOLERANCE     1.0e-2       // PWM counts, residual of the desaturation fit
+
+static int failures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct airframe_t
+{
+    uint8_t    type;
+    const char *name;
+    uint8_t    motors;                 // What the old initMixer() switch gave
+} airframe_t;
+
+static const airframe_t airframes[] =
+{
+    { MIXERTYPE_GIMBAL,          "gimbal",          0 },
+    { MIXERTYPE_FLYING_WING,     "flying wing",     1 },
+    { MIXERTYPE_BI,              "bi",              2 },
+    { MIXERTYPE_TRI,             "tri",             3 },
+    { MIXERTYPE_QUADP,           "quad +",          4 },
+    { MIXERTYPE_QUADX,           "quad x",          4 },
+    { MIXERTYPE_VTAIL4_NO_COMP,  "vtail",           4 },
+    { MIXERTYPE_VTAIL4_Y_COMP,   "vtail y",         4 },
+    { MIXERTYPE_VTAIL4_RY_COMP,  "vtail ry",        4 },
+    { MIXERTYPE_VTAIL4_PY_COMP,  "vtail py",        4 },
+    { MIXERTYPE_VTAIL4_RP_COMP,  "vtail rp",        4 },
+    { MIXERTYPE_VTAIL4_RPY_COMP, "vtail rpy",       4 },
+    { MIXERTYPE_Y4,              "y4",              4 },
+    { MIXERTYPE_HEX6P,           "hex +",           6 },
+    { MIXERTYPE_HEX6X,           "hex x",           6 },
+    { MIXERTYPE_Y6,              "y6",              6 },
+    { MIXERTYPE_OCTOF8P,         "octo flat +",     8 },
+    { MIXERTYPE_OCTOF8X,         "octo flat x",     8 },
+    { MIXERTYPE_OCTOX8P,         "octo coax +",     8 },
+    { MIXERTYPE_OCTOX8X,         "octo coax x",     8 },
+    { MIXERTYPE_FREEMIX,         "free mix",        4 },
+};
+
+#define NUMBER_OF_AIRFRAMES (sizeof(airframes) / sizeof(airframes[0]))
+
+///////////////////////////////////////////////////////////////////////////////
+// Random Numbers, repeatable across hosts
+///////////////////////////////////////////////////////////////////////////////
+
+static uint32_t randomState;
+
+static float uniform(float min, float max)
+{
+    randomState = randomState * 1664525u + 1013904223u;
+
+    return min + (max - min) * (float)(randomState >> 8) / 16777216.0f;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Legacy Mixer, the motor half of the mixTable() switch before the matrix
+///////////////////////////////////////////////////////////////////////////////
+
+#define PIDMIX(X,Y,Z) rxCommand[THROTTLE] + axisPID[ROLL] * (X) + axisPID[PITCH] * (Y) + eepromConfig.yawDirection * axisPID[YAW] * (Z)
+
+            static void legacyMix(float output[8])
+{
+    uint8_t i;
+
+    switch ( eepromConfig.mixerConfiguration )
+    {
+        case MIXERTYPE_GIMBAL:
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_FLYING_WING:
+            output[0] = rxCommand[THROTTLE];
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_BI:
+            output[0] = PIDMIX(  1.0f, 0.0f, 0.0f );        // Left Motor
+            output[1] = PIDMIX( -1.0f, 0.0f, 0.0f );        // Right Motor
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_TRI:
+            output[0] = PIDMIX(  1.0f, -0.666667f, 0.0f );  // Left  CW
+            output[1] = PIDMIX( -1.0f, -0.666667f, 0.0f );  // Right CCW
+            output[2] = PIDMIX(  0.0f,  1.333333f, 0.0f );  // Rear  CW or CCW
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_QUADP:
+            output[0] = PIDMIX(  0.0f, -1.0f, -1.0f );      // Front CW
+            output[1] = PIDMIX( -1.0f,  0.0f,  1.0f );      // Right CCW
+            output[2] = PIDMIX(  0.0f,  1.0f, -1.0f );      // Rear  CW
+            output[3] = PIDMIX(  1.0f,  0.0f,  1.0f );      // Left  CCW
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_QUADX:
+            output[0] = PIDMIX(  1.0f, -1.0f, -1.0f );      // Front Left  CW
+            output[1] = PIDMIX( -1.0f, -1.0f,  1.0f );      // Front Right CCW
+            output[2] = PIDMIX( -1.0f,  1.0f, -1.0f );      // Rear Right  CW
+            output[3] = PIDMIX(  1.0f,  1.0f,  1.0f );      // Rear Left   CCW
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_VTAIL4_NO_COMP:
+            output[0] = PIDMIX(  1.0f, -1.0f,  0.0f );      // Front Left  CCW - NOTE rotation difference for vtail configurations
+            output[1] = PIDMIX( -1.0f, -1.0f,  0.0f );      // Front Right CW  - NOTE rotation difference for vtail configurations
+            output[2] = PIDMIX(  0.0f,  1.0f,  1.0f );      // Rear Right  CCW - NOTE rotation difference for vtail configurations
+            output[3] = PIDMIX(  0.0f,  1.0f, -1.0f );      // Rear Left   CW  - NOTE rotation difference for vtail configurations
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_VTAIL4_Y_COMP:
+            output[0] = PIDMIX(  1.0f, -1.0f,  vTailThrust ); // Front Left  CCW - NOTE rotation difference for vtail configurations
+            output[1] = PIDMIX( -1.0f, -1.0f, -vTailThrust ); // Front Right CW  - NOTE rotation difference for vtail configurations
+            output[2] = PIDMIX(  0.0f,  1.0f,  1.0f        ); // Rear Right  CCW - NOTE rotation difference for vtail configurations
+            output[3] = PIDMIX(  0.0f,  1.0f, -1.0f        ); // Rear Left   CW  - NOTE rotation difference for vtail configurations
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_VTAIL4_RY_COMP:
+            output[0] = PIDMIX(  1.0f, -vTailThrust,  vTailThrust ); // Front Left  CCW - NOTE rotation difference for vtail configurations
+            output[1] = PIDMIX( -1.0f, -vTailThrust, -vTailThrust ); // Front Right CW  - NOTE rotation difference for vtail configurations
+            output[2] = PIDMIX(  0.0f,  1.0f,          1.0f       ); // Rear Right  CCW - NOTE rotation difference for vtail configurations
+            output[3] = PIDMIX(  0.0f,  1.0f,         -1.0f       ); // Rear Left   CW  - NOTE rotation difference for vtail configurations
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_VTAIL4_PY_COMP:
+            output[0] = PIDMIX(  vTailThrust, -1.0f,  vTailThrust ); // Front Left  CCW - NOTE rotation difference for vtail configurations
+            output[1] = PIDMIX( -vTailThrust, -1.0f, -vTailThrust ); // Front Right CW  - NOTE rotation difference for vtail configurations
+            output[2] = PIDMIX( -1.0f,         1.0f,  1.0f        ); // Rear Right  CCW - NOTE rotation difference for vtail configurations
+            output[3] = PIDMIX(  1.0f,         1.0f, -1.0f        ); // Rear Left   CW  - NOTE rotation difference for vtail configurations
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_VTAIL4_RP_COMP:
+            output[0] = PIDMIX(  vTailThrust, -vTailThrust,  0.0f ); // Front Left  CCW - NOTE rotation difference for vtail configurations
+            output[1] = PIDMIX( -vTailThrust, -vTailThrust, -0.0f ); // Front Right CW  - NOTE rotation difference for vtail configurations
+            output[2] = PIDMIX( -1.0f,         1.0f,         1.0f ); // Rear Right  CCW - NOTE rotation difference for vtail configurations
+            output[3] = PIDMIX(  1.0f,         1.0f,        -1.0f ); // Rear Left   CW  - NOTE rotation difference for vtail configurations
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_VTAIL4_RPY_COMP:
+            output[0] = PIDMIX(  vTailThrust, -vTailThrust,  vTailThrust ); // Front Left  CCW - NOTE rotation difference for vtail configurations
+            output[1] = PIDMIX( -vTailThrust, -vTailThrust, -vTailThrust ); // Front Right CW  - NOTE rotation difference for vtail configurations
+            output[2] = PIDMIX( -1.0f,         1.0f,         1.0f        ); // Rear Right  CCW - NOTE rotation difference for vtail configurations
+            output[3] = PIDMIX(  1.0f,         1.0f,        -1.0f        ); // Rear Left   CW  - NOTE rotation difference for vtail configurations
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_Y4:
+            output[0] = PIDMIX(  1.0f, -1.0f,  0.0f );      // Front Left  CW
+            output[1] = PIDMIX( -1.0f, -1.0f,  0.0f );      // Front Right CCW
+            output[2] = PIDMIX(  0.0f,  1.0f, -1.0f );      // Top Rear    CW
+            output[3] = PIDMIX(  0.0f,  1.0f,  1.0f );      // Bottom Rear CCW
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_HEX6P:
+            output[0] = PIDMIX(  0.0f, -0.866025f, -1.0f ); // Front       CW
+            output[1] = PIDMIX( -1.0f, -0.866025f,  1.0f ); // Front Right CCW
+            output[2] = PIDMIX( -1.0f,  0.866025f, -1.0f ); // Rear Right  CW
+            output[3] = PIDMIX(  0.0f,  0.866025f,  1.0f ); // Rear        CCW
+            output[4] = PIDMIX(  1.0f,  0.866025f, -1.0f ); // Rear Left   CW
+            output[5] = PIDMIX(  1.0f, -0.866025f,  1.0f ); // Front Left  CCW
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_HEX6X:
+            output[0] = PIDMIX(  0.866025f, -1.0f, -1.0f ); // Front Left  CW
+            output[1] = PIDMIX( -0.866025f, -1.0f,  1.0f ); // Front Right CCW
+            output[2] = PIDMIX( -0.866025f,  0.0f, -1.0f ); // Right       CW
+            output[3] = PIDMIX( -0.866025f,  1.0f,  1.0f ); // Rear Right  CCW
+            output[4] = PIDMIX(  0.866025f,  1.0f, -1.0f ); // Rear Left   CW
+            output[5] = PIDMIX(  0.866025f,  0.0f,  1.0f ); // Left        CCW
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_Y6:
+            output[0] = PIDMIX(  1.0f, -0.666667f, -1.0f );  // Top Left     CW
+            output[1] = PIDMIX( -1.0f, -0.666667f, -1.0f );  // Top Right    CW
+            output[2] = PIDMIX(  0.0f,  1.333333f,  1.0f );  // Top Rear     CCW
+            output[3] = PIDMIX(  1.0f, -0.666667f,  1.0f );  // Bottom Left  CCW
+            output[4] = PIDMIX( -1.0f, -0.666667f,  1.0f );  // Bottom Right CCW
+            output[5] = PIDMIX(  0.0f,  1.333333f, -1.0f );  // Bottom Rear  CW
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_OCTOF8P:
+            output[0] = PIDMIX(  0.0f, -1.0f, -1.0f );      // Front       CW
+            output[1] = PIDMIX( -0.7f, -0.7f,  1.0f );      // Front Right CCW
+            output[2] = PIDMIX( -1.0f,  0.0f, -1.0f );      // Right       CW
+            output[3] = PIDMIX( -0.7f,  0.7f,  1.0f );      // Rear Right  CCW
+            output[4] = PIDMIX(  0.0f,  1.0f, -1.0f );      // Rear        CW
+            output[5] = PIDMIX(  0.7f,  0.7f,  1.0f );      // Rear left   CCW
+            output[6] = PIDMIX(  1.0f,  0.0f, -1.0f );      // Left        CW
+            output[7] = PIDMIX(  0.7f, -0.7f,  1.0f );      // Front Left  CCW
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_OCTOF8X:
+            output[0] = PIDMIX(  0.5f, -1.0f, -1.0f );      // Front Left      CW
+            output[1] = PIDMIX( -0.5f, -1.0f,  1.0f );      // Front Right     CCW
+            output[2] = PIDMIX( -1.0f, -0.5f, -1.0f );      // Mid Front Right CW
+            output[3] = PIDMIX( -1.0f,  0.5f,  1.0f );      // Mid Rear Right  CCW
+            output[4] = PIDMIX( -0.5f,  1.0f, -1.0f );      // Rear Right      CW
+            output[5] = PIDMIX(  0.5f,  1.0f,  1.0f );      // Rear Left       CCW
+            output[6] = PIDMIX(  1.0f,  0.5f, -1.0f );      // Mid Rear left   CW
+            output[7] = PIDMIX(  1.0f, -0.5f,  1.0f );      // Mid Front Left  CCW
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_OCTOX8P:
+            output[0] = PIDMIX(  0.0f, -1.0f, -1.0f );      // Top Front    CW
+            output[1] = PIDMIX( -1.0f,  0.0f,  1.0f );      // Top Right    CCW
+            output[2] = PIDMIX(  0.0f,  1.0f, -1.0f );      // Top Rear     CW
+            output[3] = PIDMIX(  1.0f,  0.0f,  1.0f );      // Top Left     CCW
+            output[4] = PIDMIX(  0.0f, -1.0f, -1.0f );      // Bottom Front CCW
+            output[5] = PIDMIX( -1.0f,  0.0f,  1.0f );      // Bottom Right CW
+            output[6] = PIDMIX(  0.0f,  1.0f, -1.0f );      // Bottom Rear  CCW
+            output[7] = PIDMIX(  1.0f,  0.0f,  1.0f );      // Bottom Left  CW
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_OCTOX8X:
+            output[0] = PIDMIX(  1.0f, -1.0f, -1.0f );      // Top Front Left     CW
+            output[1] = PIDMIX( -1.0f, -1.0f,  1.0f );      // Top Front Right    CCW
+            output[2] = PIDMIX( -1.0f,  1.0f, -1.0f );      // Top Rear Right     CW
+            output[3] = PIDMIX(  1.0f,  1.0f,  1.0f );      // Top Rear Left      CCW
+            output[4] = PIDMIX(  1.0f, -1.0f, -1.0f );      // Bottom Front Left  CCW
+            output[5] = PIDMIX( -1.0f, -1.0f,  1.0f );      // Bottom Front Right CW
+            output[6] = PIDMIX( -1.0f,  1.0f, -1.0f );      // Bottom Rear Right  CCW
+            output[7] = PIDMIX(  1.0f,  1.0f,  1.0f );      // Bottom Rear Left   CW
+            break;
+
+        ///////////////////////////////
+
+        case MIXERTYPE_FREEMIX:
+            for ( i = 0; i < eepromConfig.freeMixMotors; i++ )
+            {
+                output[i] = PIDMIX ( eepromConfig.freeMix[i][ROLL],
+                                     eepromConfig.freeMix[i][PITCH],
+                                     eepromConfig.freeMix[i][YAW] );
+            }
+
+            break;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Least Squares Fit, target = a + b x
+///////////////////////////////////////////////////////////////////////////////
+
+// Returns the largest residual.  With no spread in x, b is 0.
+
+static double fitLine(const double *x, const double *target, uint8_t n, double *a, double *b)
+{
+    double  meanX = 0.0, meanT = 0.0, sxx = 0.0, sxt = 0.0, residual, worst = 0.0;
+    uint8_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        meanX += x[i] / n;
+        meanT += target[i] / n;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        sxx += (x[i] - meanX) * (x[i] - meanX);
+        sxt += (x[i] - meanX) * (target[i] - meanT);
+    }
+
+    *b = (sxx > 1.0e-9) ? sxt / sxx : 0.0;
+    *a = meanT - *b * meanX;
+
+    for (i = 0; i < n; i++)
+    {
+        residual = fabs(target[i] - *a - *b * x[i]);
+
+        if (residual > worst)
+            worst = residual;
+    }
+
+    return worst;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Matrix Check
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkMatrix(const airframe_t *airframe, const char *variant, uint32_t trials)
+{
+    float    legacy[8], product, worst = 0.0f;
+    uint32_t trial;
+    uint8_t  i, ok;
+
+    initMixer();
+
+    ok = (numberMotor == airframe->motors);
+
+    for (trial = 0; ok && (trial < trials); trial++)
+    {
+        axisPID[ROLL ]       = uniform(-500.0f, 500.0f);
+        axisPID[PITCH]       = uniform(-500.0f, 500.0f);
+        axisPID[YAW  ]       = uniform(-500.0f, 500.0f);
+        rxCommand[THROTTLE]  = uniform(MINCOMMAND, MAXCOMMAND);
+
+        legacyMix(legacy);
+
+        for (i = 0; i < numberMotor; i++)
+        {
+            product = mixerMatrix[i][ROLL    ] * axisPID[ROLL ] +
+                      mixerMatrix[i][PITCH   ] * axisPID[PITCH] +
+                      mixerMatrix[i][YAW     ] * axisPID[YAW  ] +
+                      mixerMatrix[i][THROTTLE] * rxCommand[THROTTLE];
+
+            if (fabsf(product - legacy[i]) > worst)
+                worst = fabsf(product - legacy[i]);
+        }
+    }
+
+    if (worst > MATRIX_TOLERANCE)
+        ok = false;
+
+    printf("%-14s %-10s %d motors  max error %9.6f  %s\n", airframe->name, variant, numberMotor, (double)worst, ok ? "ok" : "FAIL");
+
+    if (ok == false)
+        failures++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Desaturation Check
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkDesaturation(const airframe_t *airframe, uint32_t trials)
+{
+    const double minThrottle = eepromConfig.minThrottle;
+    const double maxThrottle = eepromConfig.maxThrottle;
+    const double range       = maxThrottle - minThrottle;
+    double       rollPitch[8], yaw[8], target[8], a, b, residual, worst = 0.0;
+    double       rpMin = 0.0, rpMax = 0.0, allMin = 0.0, allMax = 0.0, yawMin, yawMax;
+    uint32_t     trial, shifted = 0, yawScaled = 0, rpScaled = 0;
+    uint8_t      i, ok = true, trialOk;
+
+    initMixer();
+
+    if (numberMotor == 0)
+        return;
+
+    armed = true;
+
+    for (trial = 0; trial < trials; trial++)
+    {
+        // Up to four times the range, so all three cases come up
+
+        axisPID[ROLL ]      = uniform(-1.0f, 1.0f) * uniform(0.0f, 2.0f * (float)range);
+        axisPID[PITCH]      = uniform(-1.0f, 1.0f) * uniform(0.0f, 2.0f * (float)range);
+        axisPID[YAW  ]      = uniform(-1.0f, 1.0f) * uniform(0.0f, 2.0f * (float)range);
+        rxCommand[THROTTLE] = uniform(eepromConfig.minCheck, MAXCOMMAND);
+
+        mixTable();
+
+        trialOk = true;
+
+        for (i = 0; i < numberMotor; i++)
+        {
+            if ((motor[i] < minThrottle - FIT_TOLERANCE) || (motor[i] > maxThrottle + FIT_TOLERANCE))
+                trialOk = false;
+
+            rollPitch[i] = (double)mixerMatrix[i][ROLL] * axisPID[ROLL] + (double)mixerMatrix[i][PITCH] * axisPID[PITCH];
+            yaw[i]       = (double)mixerMatrix[i][YAW ] * axisPID[YAW ];
+
+            if ((i == 0) || (rollPitch[i] < rpMin)) rpMin = rollPitch[i];
+            if ((i == 0) || (rollPitch[i] > rpMax)) rpMax = rollPitch[i];
+
+            if ((i == 0) || (rollPitch[i] + yaw[i] < allMin)) allMin = rollPitch[i] + yaw[i];
+            if ((i == 0) || (rollPitch[i] + yaw[i] > allMax)) allMax = rollPitch[i] + yaw[i];
+        }
+
+        if ((allMax - allMin) <= range)
+        {
+            // Everything fits, at most the collective moves
+
+            for (i = 0; i < numberMotor; i++)
+                target[i] = motor[i] - (rollPitch[i] + yaw[i]);
+
+            a        = target[0];
+            residual = 0.0;
+
+            for (i = 1; i < numberMotor; i++)
+                residual = fmax(residual, fabs(target[i] - a));
+
+            if ((rxCommand[THROTTLE] + allMin >= minThrottle) && (rxCommand[THROTTLE] + allMax <= maxThrottle))
+                residual = fmax(residual, fabs(a - rxCommand[THROTTLE]));
+            else
+                shifted++;
+        }
+        else if ((rpMax - rpMin) <= range)
+        {
+            // Roll and pitch whole, motor - rollPitch = collective + k yaw
+
+            for (i = 0; i < numberMotor; i++)
+                target[i] = motor[i] - rollPitch[i];
+
+            residual = fitLine(yaw, target, numberMotor, &a, &b);
+
+            // The fitted scale is only as good as the yaw spread allows
+
+            for (i = 0, yawMin = yawMax = yaw[0]; i < numberMotor; i++)
+            {
+                yawMin = fmin(yawMin, yaw[i]);
+                yawMax = fmax(yawMax, yaw[i]);
+            }
+
+            if ((yawMax - yawMin) > 1.0)
+                if ((b < -FIT_TOLERANCE / (yawMax - yawMin)) || (b > 1.0 + FIT_TOLERANCE / (yawMax - yawMin)))
+                    trialOk = false;
+
+            yawScaled++;
+        }
+        else
+        {
+            // Roll and pitch scaled to the range, motor = collective + s rollPitch
+
+            for (i = 0; i < numberMotor; i++)
+                target[i] = motor[i];
+
+            residual = fitLine(rollPitch, target, numberMotor, &a, &b);
+
+            if (fabs(b * (rpMax - rpMin) - range) > FIT_TOLERANCE)
+                trialOk = false;
+
+            rpScaled++;
+        }
+
+        if (residual > FIT_TOLERANCE)
+            trialOk = false;
+
+        if (residual > worst)
+            worst = residual;
+
+        if ((trialOk == false) && ok)
+        {
+            printf("  first failure, roll %.1f pitch %.1f yaw %.1f throttle %.1f:", axisPID[ROLL], axisPID[PITCH], axisPID[YAW], rxCommand[THROTTLE]);
+
+            for (i = 0; i < numberMotor; i++)
+                printf(" %.2f", motor[i]);
+
+            printf("\n");
+
+            ok = false;
+        }
+    }
+
+    printf("%-14s %-10s %5u shifted, %5u yaw scaled, %5u roll/pitch scaled  max residual %8.5f  %s\n",
+           airframe->name, "desat", shifted, yawScaled, rpScaled, worst, ok ? "ok" : "FAIL");
+
+    if (ok == false)
+        failures++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    uint32_t trials = 2000, seed = 1;
+    uint8_t  i;
+    int      option;
+
+    while ((option = getopt(argc, argv, "n:s:")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':
+                trials = strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                seed = strtoul(optarg, NULL, 0);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-n trials] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    randomState = seed;
+
+    setEEPROMDefaults();
+
+    ///////////////////////////////////
+
+    printf("Matrix against the PIDMIX switch\n");
+
+    for (i = 0; i < NUMBER_OF_AIRFRAMES; i++)
+    {
+        eepromConfig.mixerConfiguration = airframes[i].type;
+
+        eepromConfig.yawDirection = 1.0f;
+        eepromConfig.vTailAngle   = 40.0f;
+        checkMatrix(&airframes[i], "yaw +1", trials);
+
+        eepromConfig.yawDirection = -1.0f;
+        checkMatrix(&airframes[i], "yaw -1", trials);
+
+        eepromConfig.yawDirection = 1.0f;
+        eepromConfig.vTailAngle   = 0.3f;
+        checkMatrix(&airframes[i], "vtail 0.3", trials);
+    }
+
+    ///////////////////////////////////
+
+    printf("\nDesaturation\n");
+
+    setEEPROMDefaults();
+
+    for (i = 0; i < NUMBER_OF_AIRFRAMES; i++)
+    {
+        eepromConfig.mixerConfiguration = airframes[i].type;
+
+        checkDesaturation(&airframes[i], trials);
+    }
+
+    printf("\n%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,336 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Dynamic notch check against synthetic throttle sweeps.  A motor
+// vibration tone and its second harmonic ride on the body rates of all
+// three gyro axes, their frequency and level following a throttle profile
+// of idle, ramps, a hold and a chop.  The samples go through
+// dynamicNotchFilter() at 500 Hz with one dynamicNotchUpdate() slice per
+// sample, as the background task runs on the board, and three results are
+// checked after the first second:
+//
+//   tracking     notch centers against the true tone frequencies
+//   attenuation  vibration left in the filtered gyros
+//   quiet        peaks are rarely found when there is only body motion and noise
+//
+// The vibration left is measured exactly by running the body motion alone
+// through shadow chains given the same coefficients at every sample.  The
+// longest slice of each stage is reported, the board figure scales with
+// the clock.  Exits non zero when a bound is exceeded.
+//
+// Usage: notch [-t seconds] [-o file]
+//
+//   -o  CSV of time, true frequencies and notch centers for plotting
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <getopt.h>
+#include <time.h>
+
+#include "board.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define SAMPLE_RATE        500.0
+
+#define SETTLE_TIME        1.0         // Seconds before the checks start
+
+#define TRACK_BOUND        5.0         // Hz, 95th percentile of the center error
+#define ATTENUATION_BOUND  -12.0       // dB, vibration power left, window lag on ramps and the chop
+#define FALSE_PEAK_BOUND   0.005       // Axis updates finding a peak in noise
+
+#define MAX_ERRORS         200000
+
+static const double axisLevel[3] = { 1.0, 0.8, 0.4 };
+
+static double trackErrors[MAX_ERRORS];
+static uint32_t errorCount;
+
+static FILE *csv = NULL;
+
+static int failures = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+// Throttle Profile
+///////////////////////////////////////////////////////////////////////////////
+
+static double throttle(double time)
+{
+    double cycle = fmod(time, 14.0);
+
+    if (cycle < 2.0)
+        return 0.0;                            // Idle
+    else if (cycle < 7.0)
+        return (cycle - 2.0) / 5.0;            // Ramp to full
+    else if (cycle < 9.0)
+        return 1.0;                            // Hold
+    else if (cycle < 10.0)
+        return 0.3;                            // Chop
+    else
+        return 0.3 - 0.3 * (cycle - 10.0) / 4.0;
+}
+
+///////////////////////////////////////
+
+static double fundamental(double time)
+{
+    return 80.0 + 40.0 * throttle(time);       // Hz, harmonic 160 to 240 Hz
+}
+
+///////////////////////////////////////
+
+static double noise(void)
+{
+    double sum = 0.0;
+    uint8_t i;
+
+    for (i = 0; i < 4; i++)
+        sum += (double)rand() / RAND_MAX - 0.5;
+
+    return 0.01 * sum;                         // rad/s, about 6 mrad/s RMS
+}
+
+///////////////////////////////////////
+
+static double now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+///////////////////////////////////////
+
+static int compareDouble(const void *a, const void *b)
+{
+    double difference = *(const double *)a - *(const double *)b;
+
+    return (difference > 0.0) - (difference < 0.0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// One Run
+///////////////////////////////////////////////////////////////////////////////
+
+static void notchRun(double seconds, uint8_t vibration)
+{
+    filterSectionConfig_t config[FILTER_SECTIONS];
+    filterChain_t         shadow[3];
+    float                 gyro[3], body[3];
+    double                time, level, phase = 0.0, vibrationPower = 0.0, residualPower = 0.0;
+    double                stageNs[NUMBER_OF_DYNAMIC_NOTCH_STAGES] = { 0.0 }, start, elapsed;
+    double                error, percentile = 0.0, sum = 0.0, attenuation;
+    uint32_t              sample, samples = (uint32_t)(seconds * SAMPLE_RATE), lastUpdate = 0, falsePeaks = 0;
+    uint8_t               axis, index, stage;
+
+    srand(1);
+
+    setEEPROMDefaults();
+
+    eepromConfig.dynamicNotchEnabled = true;
+
+    dynamicNotchInit();
+
+    // Shadow chains, same layout as the tracked notches
+
+    memset(config, 0, sizeof(config));
+
+    for (index = 0; index < DYNAMIC_NOTCH_PEAKS; index++)
+    {
+        config[index].type      = FILTER_NOTCH;
+        config[index].frequency = eepromConfig.dynamicNotchMinHz;
+        config[index].parameter = eepromConfig.dynamicNotchQ;
+    }
+
+    for (axis = 0; axis < 3; axis++)
+        filterChainInit(&shadow[axis], config, 1, dynamicNotch.sampleRate);
+
+    errorCount = 0;
+
+    for (sample = 0; sample < samples; sample++)
+    {
+        time  = sample / SAMPLE_RATE;
+        level = vibration ? 0.05 + 0.15 * throttle(time) : 0.0;
+        phase = fmod(phase + 2.0 * M_PI * fundamental(time) / SAMPLE_RATE, 2.0 * M_PI);
+
+        for (axis = 0; axis < 3; axis++)
+        {
+            body[axis] = (float)(0.5 * sin(2.0 * M_PI * 1.3 * time + axis) + noise());
+            gyro[axis] = body[axis] + (float)(axisLevel[axis] * level * (sin(phase + axis) + 0.4 * sin(2.0 * phase + 2.0 * axis)));
+
+            memcpy(shadow[axis].coefficients, dynamicNotch.notch[axis].coefficients, sizeof(shadow[axis].coefficients));
+        }
+
+        if (time >= SETTLE_TIME)
+        {
+            for (axis = 0; axis < 3; axis++)
+                vibrationPower += (double)(gyro[axis] - body[axis]) * (gyro[axis] - body[axis]);
+        }
+
+        dynamicNotchFilter(gyro);
+
+        for (axis = 0; axis < 3; axis++)
+            filterChainUpdate(&shadow[axis], &body[axis], &body[axis]);
+
+        if (time >= SETTLE_TIME)
+        {
+            for (axis = 0; axis < 3; axis++)
+                residualPower += (double)(gyro[axis] - body[axis]) * (gyro[axis] - body[axis]);
+        }
+
+        // The background task, one slice per 500 Hz frame
+
+        stage = dynamicNotch.stage;
+        start = now();
+
+        dynamicNotchUpdate();
+
+        elapsed = now() - start;
+
+        if (elapsed > stageNs[stage])
+            stageNs[stage] = elapsed;
+
+        if (dynamicNotch.updateCount == lastUpdate)
+            continue;
+
+        lastUpdate = dynamicNotch.updateCount;
+        axis       = (dynamicNotch.axis + 2) % 3;  // The axis just retuned
+
+        if (dynamicNotch.peaksFound > 0)
+            falsePeaks++;
+
+        if (csv != NULL)
+            fprintf(csv, "%s,%.4f,%1d,%.2f,%.2f,%.2f,%.2f\n", vibration ? "sweep" : "quiet", time, axis,
+                    fundamental(time), 2.0 * fundamental(time),
+                    dynamicNotch.center[axis][0], dynamicNotch.center[axis][1]);
+
+        if ((vibration == false) || (time < SETTLE_TIME) || (errorCount + DYNAMIC_NOTCH_PEAKS > MAX_ERRORS))
+            continue;
+
+        for (index = 0; index < DYNAMIC_NOTCH_PEAKS; index++)
+        {
+            error = fabs(dynamicNotch.center[axis][index] - (index + 1) * fundamental(time));
+
+            trackErrors[errorCount++] = error;
+            sum += error * error;
+        }
+    }
+
+    ///////////////////////////////////
+
+    printf("%s, %.0f s, %lu axis updates\n", vibration ? "Throttle sweep" : "Quiet", seconds, (unsigned long)dynamicNotch.updateCount);
+
+    for (stage = 0; stage < NUMBER_OF_DYNAMIC_NOTCH_STAGES; stage++)
+        printf("    stage %1d longest slice  %8.0f ns\n", stage, stageNs[stage]);
+
+    if (vibration)
+    {
+        qsort(trackErrors, errorCount, sizeof(double), compareDouble);
+
+        if (errorCount > 0)
+            percentile = trackErrors[(uint32_t)(0.95 * (errorCount - 1))];
+
+        attenuation = 10.0 * log10(residualPower / vibrationPower);
+
+        printf("    tracking    RMS %6.2f Hz  95%% %6.2f Hz  (bound %5.1f Hz)  %s\n",
+               sqrt(sum / (errorCount > 0 ? errorCount : 1)), percentile, TRACK_BOUND, (percentile <= TRACK_BOUND) ? "ok" : "FAIL");
+        printf("    attenuation %8.1f dB              (bound %5.1f dB)  %s\n",
+               attenuation, ATTENUATION_BOUND, (attenuation <= ATTENUATION_BOUND) ? "ok" : "FAIL");
+
+        if ((errorCount == 0) || (percentile > TRACK_BOUND))
+            failures++;
+
+        if (attenuation > ATTENUATION_BOUND)
+            failures++;
+    }
+    else
+    {
+        error = (double)falsePeaks / dynamicNotch.updateCount;
+
+        printf("    peaks found in noise  %5.3f%% of updates  (bound %5.3f%%)  %s\n",
+               100.0 * error, 100.0 * FALSE_PEAK_BOUND, (error <= FALSE_PEAK_BOUND) ? "ok" : "FAIL");
+
+        if (error > FALSE_PEAK_BOUND)
+            failures++;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    double seconds = 28.0;
+    int    option;
+
+    while ((option = getopt(argc, argv, "t:o:")) != -1)
+    {
+        switch (option)
+        {
+            case 't':
+                seconds = strtod(optarg, NULL);
+                break;
+
+            case 'o':
+                if ((csv = fopen(optarg, "w")) == NULL)
+                {
+                    perror(optarg);
+                    return 2;
+                }
+
+                fprintf(csv, "run,time,axis,fundamental,harmonic,center0,center1\n");
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-t seconds] [-o file]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    notchRun(seconds, true);
+    notchRun(seconds, false);
+
+    if (csv != NULL)
+        fclose(csv);
+
+    return (failures > 0) ? 1 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
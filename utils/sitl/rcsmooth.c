@@ -0,0 +1,660 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// RC streams through src/rcSmoothing.c at the 500 Hz loop rate, the way
+// updateRcSetpoint() feeds it, newest frame only, picked up at the first
+// loop after it arrived.  For every stream and method it reports:
+//
+//   rms      setpoint error against the stick, in command counts
+//   step     largest change from one loop to the next, what the rate D
+//            term sees, in command counts
+//   over     furthest the setpoint went past every frame in force over
+//            the last 100 ms, extrapolation overshoot
+//   lag      measured delay behind the stick on top of the staircase, and
+//            what rcSmoothingLatency() reports for it
+//
+// The generated streams are a 1 Hz roll sine, pitch steps out and back to
+// the centre detent and a wandering yaw, at the frame timing of the common
+// receivers, PPM with its jitter, Spektrum 12 channels as two frames back
+// to back, and SBUS with a 200 ms dropout.  The checks run on those, exits
+// non zero on any failure.
+//
+// A recorded stream is a text file, one frame per line, the receive time
+// in uSec then roll, pitch and yaw as rxRead() gives them, comma or space
+// separated.  The stick is then the frames joined by straight lines, so
+// rms and lag are against that.  -w writes the first generated stream in
+// the same format.
+//
+// Usage: rcsmooth [-i recording] [-w file]
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <getopt.h>
+#include <time.h>
+
+#include "board.h"
+
+#include "sitlCheck.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define LOOP_INTERVAL   2000            // uSec, 500 Hz task
+#define STREAM_LENGTH   20000000        // uSec of generated frames
+#define MAX_FRAMES      10000
+#define HISTORY         100000          // uSec of frames the overshoot is measured against
+#define MAX_LAG_SHIFT   40              // 0.5 ms steps searched either side for the lag
+
+#define SPEED_UPDATES   20000000
+
+static volatile float sink;
+
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct frame_t
+{
+    uint64_t time;                      // uSec
+    float    command[3];                // rxRead() counts
+} frame_t;
+
+typedef struct stream_t
+{
+    const char *name;
+    uint32_t   interval;                // uSec
+    uint32_t   jitter;                  // uSec, +/-
+    uint8_t    split;                   // Two frames 1.4 ms apart
+    uint8_t    dropout;                 // 200 ms without frames at 10 s
+} stream_t;
+
+static const stream_t streams[] =
+{
+    { "Spektrum 11 ms",       11000,   0, false, false },
+    { "Spektrum 22 ms split", 22000,   0, true,  false },
+    { "SBUS 9 ms",             9000,   0, false, false },
+    { "SBUS 14 ms dropout",   14000,   0, false, true  },
+    { "PPM 22.5 ms",          22500, 500, false, false },
+    { "50 Hz",                20000,   0, false, false },
+};
+
+#define NUMBER_OF_STREAMS (sizeof(streams) / sizeof(streams[0]))
+
+typedef struct result_t
+{
+    float rms[3];
+    float step[3];
+    float over[3];
+    float lag;                          // Seconds, roll, behind the staircase
+    float interval;                     // Seconds, rcSmoothing's at the end
+    float latency;                      // Seconds, rcSmoothingLatency()
+    int   detentHeld;
+    int   inRange;
+    int   staircase;                    // Off only, setpoint always the newest frame
+} result_t;
+
+static frame_t frames[MAX_FRAMES];
+static uint32_t frameCount;
+
+static const char *methodNames[NUMBER_OF_RC_SMOOTHING_METHODS] = { "off", "linear", "first order" };
+
+///////////////////////////////////////////////////////////////////////////////
+
+static double now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+///////////////////////////////////////
+
+// Centre and deadband, as processFlightCommands() and updateRcSetpoint()
+
+static float stickCommand(float count)
+{
+    float command = count - MIDCOMMAND;
+
+    if ((command <= DEADBAND) && (command >= -DEADBAND))
+        return 0.0f;
+    else if (command > 0)
+        return (command - DEADBAND) * DEADBAND_SLOPE;
+    else
+        return (command + DEADBAND) * DEADBAND_SLOPE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Generated Streams
+///////////////////////////////////////////////////////////////////////////////
+
+// The pilot, in rxRead() counts at time t seconds
+
+static float stick(double t, uint8_t axis)
+{
+    double phase;
+
+    switch (axis)
+    {
+        case ROLL:
+            return (float)(MIDCOMMAND + 500.0 * sin(2.0 * M_PI * 1.0 * t));
+
+        case PITCH:
+            phase = fmod(t, 2.0);           // Out, centre, the other way, centre
+
+            if (phase < 0.5)
+                return MIDCOMMAND + 400.0f;
+            else if ((phase >= 1.0) && (phase < 1.5))
+                return MIDCOMMAND - 400.0f;
+            else
+                return MIDCOMMAND;
+
+        default:
+            return (float)(MIDCOMMAND + 250.0 * sin(2.0 * M_PI * 0.3 * t) +
+                                        150.0 * sin(2.0 * M_PI * 0.7 * t + 1.0) +
+                                         80.0 * sin(2.0 * M_PI * 1.9 * t + 2.0));
+    }
+}
+
+///////////////////////////////////////
+
+static void generate(const stream_t *stream)
+{
+    uint64_t time = 1137;               // Past the jitter, off the stick step edges
+    uint8_t  axis;
+
+    frameCount = 0;
+
+    srand(7);
+
+    while ((time < STREAM_LENGTH) && (frameCount < MAX_FRAMES - 1))
+    {
+        uint64_t sent = time;
+
+        if (stream->jitter != 0)
+            sent += (uint64_t)(rand() % (2 * stream->jitter + 1)) - stream->jitter;
+
+        if (stream->dropout && (sent > 10000000) && (sent < 10200000))
+        {
+            time += stream->interval;
+            continue;
+        }
+
+        frames[frameCount].time = sent;
+
+        for (axis = 0; axis < 3; axis++)
+            frames[frameCount].command[axis] = roundf(stick(sent * 0.000001, axis));  // 0.5 uSec counts
+
+        frameCount++;
+
+        if (stream->split)
+        {
+            frames[frameCount]       = frames[frameCount - 1];
+            frames[frameCount].time += 1400;
+            frameCount++;
+        }
+
+        time += stream->interval;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Recorded Streams
+///////////////////////////////////////////////////////////////////////////////
+
+static int load(const char *name)
+{
+    FILE               *file;
+    char               line[200];
+    unsigned long long time;
+    float              roll, pitch, yaw;
+
+    file = fopen(name, "r");
+
+    if (file == NULL)
+    {
+        perror(name);
+        return false;
+    }
+
+    frameCount = 0;
+
+    while ((fgets(line, sizeof(line), file) != NULL) && (frameCount < MAX_FRAMES))
+    {
+        if ((sscanf(line, "%llu , %f , %f , %f", &time, &roll, &pitch, &yaw) != 4) &&
+            (sscanf(line, "%llu %f %f %f",       &time, &roll, &pitch, &yaw) != 4))
+            continue;
+
+        frames[frameCount].time       = time;
+        frames[frameCount].command[0] = roll;
+        frames[frameCount].command[1] = pitch;
+        frames[frameCount].command[2] = yaw;
+        frameCount++;
+    }
+
+    fclose(file);
+
+    return (frameCount > 1);
+}
+
+///////////////////////////////////////
+
+static void save(const char *name)
+{
+    FILE     *file;
+    uint32_t i;
+
+    file = fopen(name, "w");
+
+    if (file == NULL)
+    {
+        perror(name);
+        return;
+    }
+
+    for (i = 0; i < frameCount; i++)
+        fprintf(file, "%llu, %.0f, %.0f, %.0f\n", (unsigned long long)frames[i].time,
+                frames[i].command[0], frames[i].command[1], frames[i].command[2]);
+
+    fclose(file);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Replay
+///////////////////////////////////////////////////////////////////////////////
+
+// Stick command at time t, the pilot for generated streams, the frames
+// joined by straight lines for recorded ones
+
+static float truth(const stream_t *stream, uint64_t t, uint8_t axis)
+{
+    static uint32_t i = 0;
+    float           fraction;
+
+    if (stream != NULL)
+        return stickCommand(roundf(stick(t * 0.000001, axis)));
+
+    if ((i >= frameCount) || (frames[i].time > t))
+        i = 0;
+
+    while ((i + 1 < frameCount) && (frames[i + 1].time <= t))
+        i++;
+
+    if ((i + 1 >= frameCount) || (frames[i + 1].time == frames[i].time))
+        return stickCommand(frames[i].command[axis]);
+
+    fraction = (float)(t - frames[i].time) / (float)(frames[i + 1].time - frames[i].time);
+
+    return stickCommand(frames[i].command[axis] + fraction * (frames[i + 1].command[axis] - frames[i].command[axis]));
+}
+
+///////////////////////////////////////
+
+static void replay(const stream_t *stream, uint8_t method, result_t *result)
+{
+    static float  setpoints[STREAM_LENGTH / LOOP_INTERVAL + 1], sticks[STREAM_LENGTH / LOOP_INTERVAL + 1];
+    rcSmoothing_t rc;
+    uint64_t      t, end;
+    uint32_t      newest = 0, oldest = 0, i, loops = 0, count, best;
+    float         setpoint[3], previous[3], command[3], lo, hi, error, sum, bestSum;
+    double        squares[3] = { 0.0, 0.0, 0.0 };
+    int           shift;
+    uint8_t       axis, received = false;
+
+    memset(result, 0, sizeof(result_t));
+
+    result->detentHeld = true;
+    result->inRange    = true;
+    result->staircase  = true;
+
+    rcSmoothingInit(&rc, method);
+
+    end = frames[frameCount - 1].time;
+
+    if (end > STREAM_LENGTH)
+        end = STREAM_LENGTH;
+
+    for (t = frames[0].time + 1333; t < end; t += LOOP_INTERVAL)  // Loops not lined up with the frames
+    {
+        // updateRcSetpoint(), the newest frame in by now
+
+        while ((newest + 1 < frameCount) && (frames[newest + 1].time <= t))
+            newest++;
+
+        if (frames[newest].time != rc.frameTime)
+        {
+            for (axis = 0; axis < 3; axis++)
+                command[axis] = stickCommand(frames[newest].command[axis]);
+
+            rcSmoothingFrame(&rc, command, frames[newest].time);
+
+            received = true;
+        }
+
+        rcSmoothingUpdate(&rc, t, setpoint);
+
+        while ((oldest < newest) && (frames[oldest + 1].time + HISTORY < t))
+            oldest++;
+
+        for (axis = 0; axis < 3; axis++)
+        {
+            command[axis] = stickCommand(frames[newest].command[axis]);
+
+            if ((method == RC_SMOOTHING_OFF) && (setpoint[axis] != command[axis]))
+                result->staircase = false;
+
+            if ((method == RC_SMOOTHING_LINEAR) && (command[axis] == 0.0f) && (setpoint[axis] != 0.0f))
+                result->detentHeld = false;
+
+            if (fabsf(setpoint[axis]) > RC_SMOOTHING_LIMIT)
+                result->inRange = false;
+
+            if (received && (loops > 0))
+                result->step[axis] = fmaxf(result->step[axis], fabsf(setpoint[axis] - previous[axis]));
+
+            lo = hi = stickCommand(frames[newest].command[axis]);
+
+            for (i = oldest; i < newest; i++)
+            {
+                lo = fminf(lo, stickCommand(frames[i].command[axis]));
+                hi = fmaxf(hi, stickCommand(frames[i].command[axis]));
+            }
+
+            result->over[axis] = fmaxf(result->over[axis], fmaxf(setpoint[axis] - hi, lo - setpoint[axis]));
+
+            error = setpoint[axis] - truth(stream, t, axis);
+
+            squares[axis] += error * error;
+
+            previous[axis] = setpoint[axis];
+        }
+
+        setpoints[loops] = setpoint[ROLL];
+        sticks[loops]    = truth(stream, t, ROLL);
+
+        loops++;
+    }
+
+    for (axis = 0; axis < 3; axis++)
+        result->rms[axis] = (float)sqrt(squares[axis] / loops);
+
+    // Roll lag, the shift of the stick that best matches the setpoint, in
+    // whole loops and then to a quarter loop by interpolating the stick
+
+    best    = 0;
+    bestSum = INFINITY;
+
+    for (shift = -4 * MAX_LAG_SHIFT; shift <= 4 * MAX_LAG_SHIFT; shift++)
+    {
+        int   whole = (shift >= 0) ? shift / 4 : -((-shift + 3) / 4);
+        float part  = (float)(shift - 4 * whole) / 4.0f;
+
+        sum   = 0.0f;
+        count = 0;
+
+        for (i = MAX_LAG_SHIFT + 1; i + MAX_LAG_SHIFT + 1 < loops; i++)
+        {
+            float delayed = sticks[i - whole] + part * (sticks[i - whole - 1] - sticks[i - whole]);
+
+            error = setpoints[i] - delayed;
+            sum  += error * error;
+            count++;
+        }
+
+        if (sum < bestSum)
+        {
+            bestSum = sum;
+            best    = (uint32_t)(shift + 4 * MAX_LAG_SHIFT);
+        }
+    }
+
+    result->lag      = ((float)best - 4 * MAX_LAG_SHIFT) * LOOP_INTERVAL * 0.000001f / 4.0f;
+    result->interval = rc.interval;
+    result->latency  = rcSmoothingLatency(&rc);
+}
+
+///////////////////////////////////////
+
+static void report(const char *name, result_t results[NUMBER_OF_RC_SMOOTHING_METHODS])
+{
+    uint8_t method;
+
+    printf("%s, frame interval %.2f ms\n", name, results[0].interval * 1000.0f);
+
+    for (method = 0; method < NUMBER_OF_RC_SMOOTHING_METHODS; method++)
+        printf("  %-12s rms %6.1f %6.1f %6.1f  step %6.1f %6.1f %6.1f  over %5.1f %5.1f %5.1f  lag %6.2f ms, reported %6.2f\n",
+               methodNames[method],
+               results[method].rms[0],  results[method].rms[1],  results[method].rms[2],
+               results[method].step[0], results[method].step[1], results[method].step[2],
+               results[method].over[0], results[method].over[1], results[method].over[2],
+               (results[method].lag - results[RC_SMOOTHING_OFF].lag) * 1000.0f,
+               results[method].latency * 1000.0f);
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Checks
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkStream(const stream_t *stream, result_t results[NUMBER_OF_RC_SMOOTHING_METHODS])
+{
+    char    what[80];
+    float   added, tolerance;
+    uint8_t method;
+
+    snprintf(what, sizeof(what), "%s off is the frame staircase", stream->name);
+    check(results[RC_SMOOTHING_OFF].staircase, what);
+
+    snprintf(what, sizeof(what), "%s interval measured to 2%%", stream->name);
+    check(fabsf(results[RC_SMOOTHING_OFF].interval * 1000000.0f - stream->interval) < 0.02f * stream->interval, what);
+
+    for (method = RC_SMOOTHING_LINEAR; method < NUMBER_OF_RC_SMOOTHING_METHODS; method++)
+    {
+        // The reported figure is for a steady stick movement, the 1 Hz sine
+        // bends a little within an interval
+
+        added     = results[method].lag - results[RC_SMOOTHING_OFF].lag;
+        tolerance = fmaxf(0.001f, 0.15f * stream->interval * 0.000001f);
+
+        snprintf(what, sizeof(what), "%s %s lag as reported", stream->name, methodNames[method]);
+        check(fabsf(added - results[method].latency) < tolerance, what);
+    }
+
+    snprintf(what, sizeof(what), "%s first order pitch step under a third", stream->name);
+    check(results[RC_SMOOTHING_FIRST_ORDER].step[PITCH] < results[RC_SMOOTHING_OFF].step[PITCH] / 3.0f, what);
+
+    snprintf(what, sizeof(what), "%s first order no overshoot", stream->name);
+    check((results[RC_SMOOTHING_FIRST_ORDER].over[0] < 1.0f) &&
+          (results[RC_SMOOTHING_FIRST_ORDER].over[1] < 1.0f) &&
+          (results[RC_SMOOTHING_FIRST_ORDER].over[2] < 1.0f), what);
+
+    snprintf(what, sizeof(what), "%s linear holds the centre detent", stream->name);
+    check(results[RC_SMOOTHING_LINEAR].detentHeld, what);
+
+    snprintf(what, sizeof(what), "%s every setpoint within the stick range", stream->name);
+    check(results[0].inRange && results[1].inRange && results[2].inRange, what);
+}
+
+///////////////////////////////////////
+
+// Lost frames, extrapolation stops one interval after the last frame and
+// the first frame after the gap starts over without a slope
+
+static void checkDropout(void)
+{
+    rcSmoothing_t rc;
+    float         command[3] = { 100.0f, 0.0f, 0.0f }, setpoint[3], held;
+    uint64_t      t;
+    int           ok = true;
+
+    rcSmoothingInit(&rc, RC_SMOOTHING_LINEAR);
+
+    rcSmoothingFrame(&rc, command, 1000000);
+
+    command[ROLL] = 200.0f;
+    rcSmoothingFrame(&rc, command, 1010000);
+
+    rcSmoothingUpdate(&rc, 1020000, setpoint);
+    held = setpoint[ROLL];
+
+    for (t = 1020000; t < 1300000; t += LOOP_INTERVAL)
+    {
+        rcSmoothingUpdate(&rc, t, setpoint);
+
+        if (setpoint[ROLL] != held)
+            ok = false;
+    }
+
+    ok = ok && (held == 300.0f);
+
+    command[ROLL] = 250.0f;
+    rcSmoothingFrame(&rc, command, 1300000);
+    rcSmoothingUpdate(&rc, 1305000, setpoint);
+
+    ok = ok && (setpoint[ROLL] == 250.0f) && (rc.interval == 0.01f);
+
+    check(ok, "Lost frames hold one interval on, no slope after the gap");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Throughput
+///////////////////////////////////////////////////////////////////////////////
+
+static void speed(uint8_t method)
+{
+    rcSmoothing_t rc;
+    float         command[3] = { 0.0f, 0.0f, 0.0f }, setpoint[3];
+    uint64_t      t = 1000;
+    uint32_t      n;
+    double        begin, elapsed;
+
+    rcSmoothingInit(&rc, method);
+
+    begin = now();
+
+    for (n = 0; n < SPEED_UPDATES; n++)
+    {
+        // A frame every fifth loop, 10 ms
+
+        if ((n % 5) == 0)
+        {
+            command[ROLL] = (float)(n & 0x1FF);
+            rcSmoothingFrame(&rc, command, t);
+        }
+
+        rcSmoothingUpdate(&rc, t, setpoint);
+
+        t += LOOP_INTERVAL;
+    }
+
+    elapsed = now() - begin;
+    sink    = setpoint[ROLL];
+
+    printf("%-12s %6.1f ns per loop, a frame every fifth\n", methodNames[method], elapsed / SPEED_UPDATES);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char **argv)
+{
+    result_t   results[NUMBER_OF_RC_SMOOTHING_METHODS];
+    const char *inputName = NULL, *writeName = NULL;
+    uint32_t   s;
+    uint8_t    method;
+    int        option;
+
+    while ((option = getopt(argc, argv, "i:w:")) != -1)
+    {
+        switch (option)
+        {
+            case 'i':
+                inputName = optarg;
+                break;
+
+            case 'w':
+                writeName = optarg;
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-i recording] [-w file]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (inputName != NULL)
+    {
+        if (load(inputName) == false)
+        {
+            fprintf(stderr, "%s: no frames\n", inputName);
+            return 1;
+        }
+
+        for (method = 0; method < NUMBER_OF_RC_SMOOTHING_METHODS; method++)
+            replay(NULL, method, &results[method]);
+
+        report(inputName, results);
+
+        return 0;
+    }
+
+    for (s = 0; s < NUMBER_OF_STREAMS; s++)
+    {
+        generate(&streams[s]);
+
+        if ((s == 0) && (writeName != NULL))
+            save(writeName);
+
+        for (method = 0; method < NUMBER_OF_RC_SMOOTHING_METHODS; method++)
+            replay(&streams[s], method, &results[method]);
+
+        report(streams[s].name, results);
+        checkStream(&streams[s], results);
+
+        printf("\n");
+    }
+
+    checkDropout();
+
+    printf("\n");
+
+    for (method = 0; method < NUMBER_OF_RC_SMOOTHING_METHODS; method++)
+        speed(method);
+
+    printf("\n%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,756 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Offline parameter sweeps for the attitude and altitude estimators.  A
+// recording from "sitl -r" is memory mapped once, scaled and lowpassed once,
+// then every candidate parameter set replays it through its own
+// attitude estimator and vertCompFilterUpdate() instances.  The sets
+// are spread over a pool of worker threads, each with its own deque, and
+// an idle worker steals half of the largest remaining deque, so long and
+// short runs balance out without a shared queue to fight over.  Results
+// are ranked by RMS error against the model truth in the recording.
+//
+// Usage: replay -i vectors [-j threads] [-n top] [-r metric] [-o file] [name=values ...]
+//
+//   -i  Recording from "sitl -r"
+//   -j  Worker threads, default one per online CPU
+//   -n  Number of best sets to print, default 10
+//   -r  Ranking, "attitude" (default) or "altitude"
+//   -o  All results as CSV, best first, default replay.csv
+//
+// Parameters are estimator (0 MARG, 1 EKF), KpAcc, KiAcc, KpMag, KiMag,
+// accelCutoff, ekfGyroNoise, ekfBiasNoise, ekfAccelNoise, ekfHdgNoise,
+// compFilterA and compFilterB.  Values are either a single number or
+// min:max:count, the sweep is every combination.  Anything not given keeps
+// its default.  Only the swept parameters are printed.
+//
+//   replay -i vectors.bin KpAcc=0.5:8:16 KiAcc=0:0.002:5 accelCutoff=0.5:2:4
+//   replay -i vectors.bin estimator=0:1:2
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "board.h"
+
+#include "sitlHal.h"
+#include "sitlRecord.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define REPLAY_PARAMETERS 12
+
+enum { ESTIMATOR, KP_ACC, KI_ACC, KP_MAG, KI_MAG, ACCEL_CUTOFF,
+       EKF_GYRO_NOISE, EKF_BIAS_NOISE, EKF_ACCEL_NOISE, EKF_HDG_NOISE,
+       COMP_FILTER_A, COMP_FILTER_B };
+
+static const char * const parameterNames[REPLAY_PARAMETERS] =
+{
+    "estimator", "KpAcc", "KiAcc", "KpMag", "KiMag", "accelCutoff",
+    "ekfGyroNoise", "ekfBiasNoise", "ekfAccelNoise", "ekfHdgNoise",
+    "compFilterA", "compFilterB"
+};
+
+#define REPLAY_500HZ_PER_100HZ 5      // COUNT_100HZ / COUNT_500HZ
+
+#define REPLAY_MIN_ALTITUDE    0.1f   // Meters, samples below count as on the ground
+
+///////////////////////////////////////
+
+typedef struct replaySweep_t
+{
+    float    min, max;
+    uint32_t count;
+} replaySweep_t;
+
+typedef struct replayResult_t
+{
+    float    parameter[REPLAY_PARAMETERS];
+    float    attitudeRMS[3];            // Roll, pitch, heading, radians
+    float    attitudeScore;             // RMS over all three axes
+    float    altitudeRMS;               // Meters
+} replayResult_t;
+
+typedef struct replayPrepared_t         // 500 Hz, parameter independent
+{
+    float    deltaAngle[3];
+    float    accel[3];                  // Scaled and lowpassed
+    float    dt;
+} replayPrepared_t;
+
+typedef struct replayPrepared100Hz_t    // 100 Hz, parameter independent
+{
+    float    accel[3];
+    float    dt;
+} replayPrepared100Hz_t;
+
+typedef struct replayQueue_t
+{
+    pthread_mutex_t lock;
+    uint32_t        head;               // Thieves take from here
+    uint32_t        tail;               // Owner takes from here
+} replayQueue_t;
+
+///////////////////////////////////////
+
+float dt500Hz, dt100Hz;
+
+static const sitlRecord_t   *records;
+static uint32_t             recordCount;
+
+static replayPrepared_t      *prepared;
+static replayPrepared100Hz_t *prepared100Hz;
+
+static replaySweep_t        sweep[REPLAY_PARAMETERS];
+static replayResult_t       *results;
+static uint32_t             resultCount;
+
+static replayQueue_t        *queues;
+static uint32_t             workerCount;
+
+static uint8_t              rankByAltitude = false;
+
+///////////////////////////////////////////////////////////////////////////////
+// Map Recording
+///////////////////////////////////////////////////////////////////////////////
+
+static int mapRecording(const char *name)
+{
+    int                      fd;
+    struct stat              info;
+    const uint8_t            *base;
+    const sitlRecordHeader_t *header;
+
+    fd = open(name, O_RDONLY);
+
+    if ((fd < 0) || (fstat(fd, &info) != 0))
+    {
+        perror(name);
+        return -1;
+    }
+
+    if ((size_t)info.st_size < sizeof(sitlRecordHeader_t) + sizeof(sitlRecord_t))
+    {
+        fprintf(stderr, "%s: no records\n", name);
+        close(fd);
+        return -1;
+    }
+
+    base = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (base == MAP_FAILED)
+    {
+        perror(name);
+        return -1;
+    }
+
+    header = (const sitlRecordHeader_t *)base;
+
+    if ((header->magic      != SITL_RECORD_MAGIC)   ||
+        (header->version    != SITL_RECORD_VERSION) ||
+        (header->recordSize != sizeof(sitlRecord_t)))
+    {
+        fprintf(stderr, "%s: not a recording from this sitl build\n", name);
+        return -1;
+    }
+
+    records     = (const sitlRecord_t *)(base + sizeof(sitlRecordHeader_t));
+    recordCount = (info.st_size - sizeof(sitlRecordHeader_t)) / sizeof(sitlRecord_t);
+
+    // Whole 100 Hz frames only
+
+    recordCount -= recordCount % REPLAY_500HZ_PER_100HZ;
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Prepare, the parameter independent front end of task500Hz and task100Hz
+///////////////////////////////////////////////////////////////////////////////
+
+static void prepare(void)
+{
+    uint32_t i, j;
+    uint8_t  axis;
+    uint64_t previous500HzTimestamp = 0;
+    uint64_t previous100HzTimestamp = 0;
+
+    prepared      = malloc(recordCount * sizeof(replayPrepared_t));
+    prepared100Hz = malloc(recordCount / REPLAY_500HZ_PER_100HZ * sizeof(replayPrepared100Hz_t));
+
+    filterBankInit();
+
+    for (i = 0; i < recordCount; i++)
+    {
+        mpu6000Summed500Hz = records[i].summed500Hz;
+
+        memcpy(accelSummedSamples500HzMXR, records[i].accelSummedMXR, sizeof(accelSummedSamples500HzMXR));
+
+        prepared[i].dt = timebaseSampleInterval(&previous500HzTimestamp, mpu6000Summed500Hz.lastSampleTime, 0.002f);
+
+        computeMPU6000TCBias();
+        scaleSensors500Hz(prepared[i].dt);
+
+        #if defined(MPU_ACCEL)
+            filterChainUpdate(&filterChains[ACCEL500HZ_FILTER], sensors.accel500Hz, prepared[i].accel);
+        #endif
+
+        #if defined(MXR_ACCEL)
+            filterChainUpdate(&filterChains[ACCEL500HZ_FILTER], sensors.accel500HzMXR, prepared[i].accel);
+        #endif
+
+        memcpy(prepared[i].deltaAngle, sensors.deltaAngle500Hz, sizeof(prepared[i].deltaAngle));
+
+        ///////////////////////////////
+
+        // The 100 Hz sums are the last five 500 Hz sums, the 100 Hz task
+        // runs on the frame of every fifth 500 Hz task
+
+        if ((i % REPLAY_500HZ_PER_100HZ) != (REPLAY_500HZ_PER_100HZ - 1))
+            continue;
+
+        memset(&mpu6000Summed100Hz,        0, sizeof(mpu6000Summed100Hz));
+        memset(accelSummedSamples100HzMXR, 0, sizeof(accelSummedSamples100HzMXR));
+
+        for (j = i + 1 - REPLAY_500HZ_PER_100HZ; j <= i; j++)
+        {
+            for (axis = 0; axis < 3; axis++)
+            {
+                mpu6000Summed100Hz.accel[axis]   += records[j].summed500Hz.accel[axis];
+                mpu6000Summed100Hz.gyro[axis]    += records[j].summed500Hz.gyro[axis];
+                accelSummedSamples100HzMXR[axis] += records[j].accelSummedMXR[axis];
+            }
+
+            mpu6000Summed100Hz.samples       += records[j].summed500Hz.samples;
+            mpu6000Summed100Hz.lastSampleTime = records[j].summed500Hz.lastSampleTime;
+        }
+
+        j = i / REPLAY_500HZ_PER_100HZ;
+
+        prepared100Hz[j].dt = timebaseSampleInterval(&previous100HzTimestamp, mpu6000Summed100Hz.lastSampleTime, 0.01f);
+
+        scaleSensors100Hz();
+
+        #if defined(MPU_ACCEL)
+            filterChainUpdate(&filterChains[ACCEL100HZ_FILTER], sensors.accel100Hz, prepared100Hz[j].accel);
+        #endif
+
+        #if defined(MXR_ACCEL)
+            filterChainUpdate(&filterChains[ACCEL100HZ_FILTER], sensors.accel100HzMXR, prepared100Hz[j].accel);
+        #endif
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Replay One Parameter Set
+///////////////////////////////////////////////////////////////////////////////
+
+static void replay(replayResult_t *result)
+{
+    margAHRS_t             ahrs;
+    attitudeEKF_t          ekf;
+    uint8_t                useEKF;
+    vertCompFilter_t       altitude;
+    filterChain_t          highPass;
+    const sitlRecord_t     *record;
+    float                  earthAccel[3], error;
+    double                 attitudeSum[3] = { 0.0, 0.0, 0.0 }, altitudeSum = 0.0;
+    uint32_t               attitudeCount = 0, altitudeCount = 0;
+    uint32_t               i;
+    uint8_t                axis;
+
+    MargAHRSreset(&ahrs);
+
+    // Own copy of the z axis of the earth accel high pass, the CMSIS
+    // instance points into the chain so it cannot be copied by value
+
+    filterChainInit(&highPass, eepromConfig.filters[EARTH_ACCEL100HZ_FILTER], 1,
+                    filterChains[EARTH_ACCEL100HZ_FILTER].sampleRate);
+
+    ahrs.KpAcc              = result->parameter[KP_ACC];
+    ahrs.KiAcc              = result->parameter[KI_ACC];
+    ahrs.KpMag              = result->parameter[KP_MAG];
+    ahrs.KiMag              = result->parameter[KI_MAG];
+    ahrs.accConfidenceDecay = 1.0f / sqrtf(result->parameter[ACCEL_CUTOFF]);
+
+    // The EKF publishes through the MARG instance, as MargAHRSupdate() does
+
+    useEKF = (result->parameter[ESTIMATOR] >= 0.5f);
+
+    attitudeEKFreset(&ekf);
+
+    ekf.gyroNoise     = result->parameter[EKF_GYRO_NOISE];
+    ekf.gyroBiasNoise = result->parameter[EKF_BIAS_NOISE];
+    ekf.accelNoise    = result->parameter[EKF_ACCEL_NOISE];
+    ekf.headingNoise  = result->parameter[EKF_HDG_NOISE];
+
+    vertCompFilterReset(&altitude);
+
+    altitude.compFilterA = result->parameter[COMP_FILTER_A];
+    altitude.compFilterB = result->parameter[COMP_FILTER_B];
+
+    for (i = 0; i < recordCount; i++)
+    {
+        record = &records[i];
+
+        if (useEKF == true)
+        {
+            attitudeEKFupdate(&ekf,
+                              prepared[i].deltaAngle,
+                              prepared[i].accel[XAXIS], prepared[i].accel[YAXIS], prepared[i].accel[ZAXIS],
+                              record->mag[XAXIS],       record->mag[YAXIS],       record->mag[ZAXIS],
+                              record->magDataUpdate,
+                              prepared[i].dt);
+
+            if (ekf.initialized == true)
+                MargAHRSsetQuaternion(&ahrs, ekf.q);
+        }
+        else
+        {
+            MargAHRSupdateInstance(&ahrs,
+                                   prepared[i].deltaAngle,
+                                   prepared[i].accel[XAXIS], prepared[i].accel[YAXIS], prepared[i].accel[ZAXIS],
+                                   record->mag[XAXIS],       record->mag[YAXIS],       record->mag[ZAXIS],
+                                   record->magDataUpdate,
+                                   prepared[i].dt);
+        }
+
+        if ((ahrs.initialized == true) && (record->armed == true) && (record->truthAltitude > REPLAY_MIN_ALTITUDE))
+        {
+            for (axis = 0; axis < 3; axis++)
+            {
+                error = standardRadianFormat(MargAHRSattitude(&ahrs)[axis] - record->truthAttitude[axis]);
+
+                attitudeSum[axis] += error * error;
+            }
+
+            attitudeCount++;
+        }
+
+        ///////////////////////////////
+
+        if ((i % REPLAY_500HZ_PER_100HZ) != (REPLAY_500HZ_PER_100HZ - 1))
+            continue;
+
+        rotateBodyAccelToEarth(MargAHRSrotationMatrix(&ahrs), prepared100Hz[i / REPLAY_500HZ_PER_100HZ].accel, earthAccel);
+
+        filterChainUpdate(&highPass, &earthAccel[ZAXIS], &earthAccel[ZAXIS]);
+
+        vertCompFilterUpdate(&altitude, earthAccel[ZAXIS], record->pressureAlt, record->execUp,
+                             prepared100Hz[i / REPLAY_500HZ_PER_100HZ].dt);
+
+        if ((record->execUp == true) && (record->armed == true))
+        {
+            error = altitude.hEstimate - record->truthAltitude;
+
+            altitudeSum += error * error;
+            altitudeCount++;
+        }
+    }
+
+    for (axis = 0; axis < 3; axis++)
+        result->attitudeRMS[axis] = (attitudeCount > 0) ? (float)sqrt(attitudeSum[axis] / attitudeCount) : INFINITY;
+
+    result->attitudeScore = sqrtf((SQR(result->attitudeRMS[ROLL]) + SQR(result->attitudeRMS[PITCH]) + SQR(result->attitudeRMS[YAW])) / 3.0f);
+
+    result->altitudeRMS = (altitudeCount > 0) ? (float)sqrt(altitudeSum / altitudeCount) : INFINITY;
+
+    // A diverged filter ranks last rather than first
+
+    if (isnan(result->attitudeScore))
+        result->attitudeScore = INFINITY;
+
+    if (isnan(result->altitudeRMS))
+        result->altitudeRMS = INFINITY;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Work Stealing Pool
+///////////////////////////////////////////////////////////////////////////////
+
+static uint8_t takeOwn(replayQueue_t *queue, uint32_t *job)
+{
+    uint8_t found = false;
+
+    pthread_mutex_lock(&queue->lock);
+
+    if (queue->tail > queue->head)
+    {
+        *job  = --queue->tail;
+        found = true;
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return found;
+}
+
+///////////////////////////////////////
+
+// Moves the older half of the fullest other queue into our own, the owner
+// keeps working from the other end while this runs
+
+static uint8_t steal(uint32_t self)
+{
+    uint32_t victim = 0, most = 0, size, half, head;
+    uint32_t i;
+
+    for (i = 0; i < workerCount; i++)
+    {
+        if (i == self)
+            continue;
+
+        pthread_mutex_lock(&queues[i].lock);
+        size = queues[i].tail - queues[i].head;
+        pthread_mutex_unlock(&queues[i].lock);
+
+        if (size > most)
+        {
+            most   = size;
+            victim = i;
+        }
+    }
+
+    if (most == 0)
+        return false;
+
+    pthread_mutex_lock(&queues[victim].lock);
+
+    size = queues[victim].tail - queues[victim].head;
+    half = (size + 1) / 2;
+    head = queues[victim].head;
+
+    queues[victim].head += half;
+
+    pthread_mutex_unlock(&queues[victim].lock);
+
+    if (half == 0)
+        return true;  // Drained since the look, look again
+
+    pthread_mutex_lock(&queues[self].lock);
+
+    queues[self].head = head;
+    queues[self].tail = head + half;
+
+    pthread_mutex_unlock(&queues[self].lock);
+
+    return true;
+}
+
+///////////////////////////////////////
+
+static void *worker(void *argument)
+{
+    uint32_t self = (uint32_t)(uintptr_t)argument;
+    uint32_t job;
+
+    for (;;)
+    {
+        if (takeOwn(&queues[self], &job))
+            replay(&results[job]);
+        else if (steal(self) == false)
+            break;
+    }
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Parameter Sets
+///////////////////////////////////////////////////////////////////////////////
+
+static int parseSweep(const char *text)
+{
+    char          name[32];
+    const char    *values;
+    replaySweep_t value;
+    uint8_t       i;
+
+    values = strchr(text, '=');
+
+    if ((values == NULL) || ((size_t)(values - text) >= sizeof(name)))
+        return -1;
+
+    memcpy(name, text, values - text);
+    name[values - text] = '\0';
+    values++;
+
+    if (sscanf(values, "%f:%f:%u", &value.min, &value.max, &value.count) != 3)
+    {
+        if (sscanf(values, "%f", &value.min) != 1)
+            return -1;
+
+        value.max   = value.min;
+        value.count = 1;
+    }
+
+    if (value.count == 0)
+        return -1;
+
+    for (i = 0; i < REPLAY_PARAMETERS; i++)
+    {
+        if (strcmp(name, parameterNames[i]) == 0)
+        {
+            sweep[i] = value;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+///////////////////////////////////////
+
+static void buildParameterSets(void)
+{
+    uint32_t index, remainder;
+    uint8_t  i;
+
+    resultCount = 1;
+
+    for (i = 0; i < REPLAY_PARAMETERS; i++)
+        resultCount *= sweep[i].count;
+
+    results = calloc(resultCount, sizeof(replayResult_t));
+
+    for (index = 0; index < resultCount; index++)
+    {
+        remainder = index;
+
+        for (i = 0; i < REPLAY_PARAMETERS; i++)
+        {
+            if (sweep[i].count == 1)
+                results[index].parameter[i] = sweep[i].min;
+            else
+                results[index].parameter[i] = sweep[i].min + (sweep[i].max - sweep[i].min) *
+                                              (float)(remainder % sweep[i].count) / (sweep[i].count - 1);
+
+            remainder /= sweep[i].count;
+        }
+    }
+}
+
+///////////////////////////////////////
+
+static int compareResults(const void *a, const void *b)
+{
+    const replayResult_t *x = a;
+    const replayResult_t *y = b;
+    float                scoreX, scoreY;
+
+    scoreX = rankByAltitude ? x->altitudeRMS : x->attitudeScore;
+    scoreY = rankByAltitude ? y->altitudeRMS : y->attitudeScore;
+
+    return (scoreX > scoreY) - (scoreX < scoreY);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    int             option;
+    const char      *inputName = NULL;
+    const char      *outputName = "replay.csv";
+    uint32_t        top = 10;
+    uint32_t        i, share;
+    uint8_t         p;
+    pthread_t       *threads;
+    FILE            *outputFile;
+    struct timespec start, end;
+    double          wallTime;
+
+    workerCount = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+
+    while ((option = getopt(argc, argv, "i:j:n:r:o:")) != -1)
+    {
+        switch (option)
+        {
+            case 'i':
+                inputName = optarg;
+                break;
+
+            case 'j':
+                workerCount = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                top = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                rankByAltitude = (strcmp(optarg, "altitude") == 0);
+                break;
+
+            case 'o':
+                outputName = optarg;
+                break;
+
+            default:
+                inputName = NULL;
+                break;
+        }
+    }
+
+    ///////////////////////////////////
+
+    setEEPROMDefaults();
+
+    sweep[ESTIMATOR      ] = (replaySweep_t){ eepromConfig.attitudeEstimator, eepromConfig.attitudeEstimator, 1 };
+    sweep[KP_ACC         ] = (replaySweep_t){ eepromConfig.KpAcc,             eepromConfig.KpAcc,             1 };
+    sweep[KI_ACC         ] = (replaySweep_t){ eepromConfig.KiAcc,             eepromConfig.KiAcc,             1 };
+    sweep[KP_MAG         ] = (replaySweep_t){ eepromConfig.KpMag,             eepromConfig.KpMag,             1 };
+    sweep[KI_MAG         ] = (replaySweep_t){ eepromConfig.KiMag,             eepromConfig.KiMag,             1 };
+    sweep[ACCEL_CUTOFF   ] = (replaySweep_t){ eepromConfig.accelCutoff,       eepromConfig.accelCutoff,       1 };
+    sweep[EKF_GYRO_NOISE ] = (replaySweep_t){ eepromConfig.ekfGyroNoise,      eepromConfig.ekfGyroNoise,      1 };
+    sweep[EKF_BIAS_NOISE ] = (replaySweep_t){ eepromConfig.ekfGyroBiasNoise,  eepromConfig.ekfGyroBiasNoise,  1 };
+    sweep[EKF_ACCEL_NOISE] = (replaySweep_t){ eepromConfig.ekfAccelNoise,     eepromConfig.ekfAccelNoise,     1 };
+    sweep[EKF_HDG_NOISE  ] = (replaySweep_t){ eepromConfig.ekfHeadingNoise,   eepromConfig.ekfHeadingNoise,   1 };
+    sweep[COMP_FILTER_A  ] = (replaySweep_t){ eepromConfig.compFilterA,       eepromConfig.compFilterA,       1 };
+    sweep[COMP_FILTER_B  ] = (replaySweep_t){ eepromConfig.compFilterB,       eepromConfig.compFilterB,       1 };
+
+    for (i = optind; (int)i < argc; i++)
+    {
+        if (parseSweep(argv[i]) != 0)
+        {
+            fprintf(stderr, "%s: bad parameter \"%s\"\n", argv[0], argv[i]);
+            return 1;
+        }
+    }
+
+    if ((inputName == NULL) || (workerCount == 0))
+    {
+        fprintf(stderr, "usage: %s -i vectors [-j threads] [-n top] [-r attitude|altitude] [-o file] [name=values ...]\n", argv[0]);
+        return 1;
+    }
+
+    if (mapRecording(inputName) != 0)
+        return 1;
+
+    prepare();
+
+    buildParameterSets();
+
+    ///////////////////////////////////
+
+    // Each worker starts with an equal slice of the sets
+
+    queues  = calloc(workerCount, sizeof(replayQueue_t));
+    threads = calloc(workerCount, sizeof(pthread_t));
+    share   = (resultCount + workerCount - 1) / workerCount;
+
+    for (i = 0; i < workerCount; i++)
+    {
+        pthread_mutex_init(&queues[i].lock, NULL);
+
+        queues[i].head = (i * share     < resultCount) ? i * share       : resultCount;
+        queues[i].tail = ((i + 1) * share < resultCount) ? (i + 1) * share : resultCount;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (i = 0; i < workerCount; i++)
+        pthread_create(&threads[i], NULL, worker, (void *)(uintptr_t)i);
+
+    for (i = 0; i < workerCount; i++)
+        pthread_join(threads[i], NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    wallTime = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+
+    ///////////////////////////////////
+
+    qsort(results, resultCount, sizeof(replayResult_t), compareResults);
+
+    outputFile = fopen(outputName, "w");
+
+    if (outputFile == NULL)
+    {
+        perror(outputName);
+        return 1;
+    }
+
+    for (p = 0; p < REPLAY_PARAMETERS; p++)
+        fprintf(outputFile, "%s,", parameterNames[p]);
+
+    fprintf(outputFile, "rollRMS,pitchRMS,headingRMS,attitudeRMS,altitudeRMS\n");
+
+    for (i = 0; i < resultCount; i++)
+    {
+        for (p = 0; p < REPLAY_PARAMETERS; p++)
+            fprintf(outputFile, "%g,", results[i].parameter[p]);
+
+        fprintf(outputFile, "%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                results[i].attitudeRMS[ROLL] * R2D, results[i].attitudeRMS[PITCH] * R2D, results[i].attitudeRMS[YAW] * R2D,
+                results[i].attitudeScore * R2D, results[i].altitudeRMS);
+    }
+
+    fclose(outputFile);
+
+    ///////////////////////////////////
+
+    printf("%u sets x %u samples on %u threads in %.3f s, %.1f sets/s, %.1f M samples/s\n\n",
+           resultCount, recordCount, workerCount, wallTime,
+           resultCount / wallTime, (double)resultCount * recordCount / wallTime * 1e-6);
+
+    for (p = 0; p < REPLAY_PARAMETERS; p++)
+        if (sweep[p].count > 1)
+            printf("%13s ", parameterNames[p]);
+
+    printf("   att deg   alt m\n");
+
+    for (i = 0; (i < top) && (i < resultCount); i++)
+    {
+        for (p = 0; p < REPLAY_PARAMETERS; p++)
+            if (sweep[p].count > 1)
+                printf("%13g ", results[i].parameter[p]);
+
+        printf("%10.3f %7.3f\n", results[i].attitudeScore * R2D, results[i].altitudeRMS);
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
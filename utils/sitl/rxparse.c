@@ -0,0 +1,722 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Check and throughput of src/rxFrame.c, the serial receiver frame
+// handling behind drv_rx.c:
+//
+//   - Spektrum 10 and 11 bit positions back out of the frame on every
+//     channel, 12 channel systems over two frames, unused slots and
+//     channels beyond the configured count left alone
+//   - SBUS, SUMD and IBUS frames as the receivers send them, sticks and
+//     switches in known places, decoded to the expected commands, their
+//     failsafe and lost frame flags, and random frames from encoders here
+//   - short, long and merged frames, bad headers and footers rejected,
+//     every single bit error caught by the SUMD CRC and the IBUS sum
+//   - frames cut out of the receive ring at the idle line ends, across
+//     the wrap at every offset
+//
+// The speed figures are bytes per second through ring extract and decode
+// for each protocol, the whole of rxUpdate() less the channel copy.
+// Exits non zero on any failure.
+//
+// Usage: rxparse
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <time.h>
+
+#include "board.h"
+
+#include "sitlCheck.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define RING_SIZE      256             // RX_SERIAL_BUFFER_SIZE in drv_rx.c
+#define SPEED_FRAMES   4000000
+
+static volatile uint32_t sink;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static double now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Reference Frame, fades and system bytes then up to 7 channel words
+///////////////////////////////////////////////////////////////////////////////
+
+static void referenceFrame(uint8_t *frame, uint8_t hires, const uint8_t *channels, const uint16_t *positions, uint8_t count)
+{
+    uint8_t  slot;
+    uint16_t word;
+
+    frame[0] = 0x00;
+    frame[1] = hires ? 0xB2 : 0x01;
+
+    for (slot = 0; slot < 7; slot++)
+    {
+        if (slot < count)
+            word = hires ? (uint16_t)((channels[slot] << 11) | (positions[slot] & 0x7FF))
+                         : (uint16_t)((channels[slot] << 10) | (positions[slot] & 0x3FF));
+        else
+            word = SPEKTRUM_UNUSED;
+
+        frame[2 + 2 * slot] = (uint8_t)(word >> 8);
+        frame[3 + 2 * slot] = (uint8_t)(word & 0xFF);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Positions
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkPositions(uint8_t hires)
+{
+    uint8_t  frame[SPEKTRUM_FRAME_SIZE], channels[7], first, count, i;
+    uint16_t positions[SPEKTRUM_MAX_CHANNEL], data[SPEKTRUM_MAX_CHANNEL];
+    uint32_t trial;
+    char     what[80];
+    int      ok = true;
+
+    srand(hires + 1);
+
+    for (trial = 0; trial < 100000; trial++)
+    {
+        for (i = 0; i < SPEKTRUM_MAX_CHANNEL; i++)
+        {
+            positions[i] = (uint16_t)(rand() & (hires ? 0x7FF : 0x3FF));
+            data[i]      = 0xDEAD;
+        }
+
+        // Channels 0 to 6 then 7 to 11, the way 12 channel systems alternate
+
+        for (first = 0; first < SPEKTRUM_MAX_CHANNEL; first += 7)
+        {
+            count = (uint8_t)((SPEKTRUM_MAX_CHANNEL - first < 7) ? SPEKTRUM_MAX_CHANNEL - first : 7);
+
+            for (i = 0; i < count; i++)
+                channels[i] = first + i;
+
+            referenceFrame(frame, hires, channels, &positions[first], count);
+
+            if (spektrumFrameDecode(frame, SPEKTRUM_FRAME_SIZE, hires, SPEKTRUM_MAX_CHANNEL, data) != count)
+                ok = false;
+        }
+
+        for (i = 0; i < SPEKTRUM_MAX_CHANNEL; i++)
+            if (data[i] != positions[i])
+                ok = false;
+    }
+
+    snprintf(what, sizeof(what), "%s positions decode on all 12 channels over two frames", hires ? "11 bit" : "10 bit");
+
+    check(ok, what);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Skipped Slots and Rejected Frames
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkRejects(void)
+{
+    uint8_t  frame[2 * SPEKTRUM_FRAME_SIZE], channels[7] = { 0, 1, 2, 3, 8, 9, 10 };
+    uint16_t positions[7] = { 100, 200, 300, 400, 500, 600, 700 }, data[SPEKTRUM_MAX_CHANNEL];
+    uint16_t length;
+    uint8_t  i;
+    int      ok;
+
+    for (i = 0; i < SPEKTRUM_MAX_CHANNEL; i++)
+        data[i] = 0xDEAD;
+
+    referenceFrame(frame, true, channels, positions, 4);
+
+    ok = (spektrumFrameDecode(frame, SPEKTRUM_FRAME_SIZE, true, 8, data) == 4);
+
+    for (i = 4; i < SPEKTRUM_MAX_CHANNEL; i++)
+        if (data[i] != 0xDEAD)
+            ok = false;
+
+    check(ok, "Unused slots leave their channels alone");
+
+    referenceFrame(frame, true, channels, positions, 7);
+
+    ok = (spektrumFrameDecode(frame, SPEKTRUM_FRAME_SIZE, true, 8, data) == 4) &&
+         (data[8] == 0xDEAD) && (data[9] == 0xDEAD) && (data[10] == 0xDEAD);
+
+    check(ok, "Channels past the configured count ignored");
+
+    ok = true;
+
+    for (length = 0; length <= 2 * SPEKTRUM_FRAME_SIZE; length++)
+        if ((length != SPEKTRUM_FRAME_SIZE) && (spektrumFrameDecode(frame, length, true, 8, data) != 0))
+            ok = false;
+
+    check(ok, "Every length but 16 rejected, 15 and 17 for a lost or extra byte");
+
+    referenceFrame(frame, true, channels, positions, 0);
+
+    check(spektrumFrameDecode(frame, SPEKTRUM_FRAME_SIZE, true, 8, data) == 0, "A frame with no channels rejected");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Commands
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkCommands(void)
+{
+    uint16_t value;
+    int      ok = true;
+
+    for (value = 0; value < 2048; value++)
+    {
+        if (spektrumCommand(value, true) != 1000 + value)
+            ok = false;
+
+        if ((value < 1024) && (spektrumCommand(value, false) != (1000 + value) * 2))
+            ok = false;
+    }
+
+    check(ok, "Positions to commands as rxRead() always scaled them");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Ring Extract
+///////////////////////////////////////////////////////////////////////////////
+
+// Writes a stream of frames into the ring the way the DMA does, marking
+// each end the way the idle line interrupt does, and cuts them back out
+
+static void checkExtract(void)
+{
+    uint8_t  ring[RING_SIZE], frame[SPEKTRUM_FRAME_SIZE], out[RX_FRAME_MAX_SIZE], channels[7] = { 0, 1, 2, 3, 4, 5, 6 };
+    uint16_t positions[7], data[SPEKTRUM_MAX_CHANNEL], start, end, offset, b, length;
+    uint8_t  n, i;
+    int      ok = true, merged = true, tooLong;
+
+    for (offset = 0; offset < RING_SIZE; offset++)
+    {
+        start = offset;
+
+        for (n = 0; n < 20; n++)
+        {
+            for (i = 0; i < 7; i++)
+                positions[i] = (uint16_t)((offset * 7 + n * 13 + i * 131) & 0x7FF);
+
+            referenceFrame(frame, true, channels, positions, 7);
+
+            for (b = 0, end = start; b < SPEKTRUM_FRAME_SIZE; b++)
+            {
+                ring[end] = frame[b];
+                end       = (uint16_t)((end + 1) % RING_SIZE);
+            }
+
+            length = rxFrameExtract(ring, RING_SIZE, start, end, out);
+
+            if ((length != SPEKTRUM_FRAME_SIZE) || (memcmp(out, frame, SPEKTRUM_FRAME_SIZE) != 0))
+                ok = false;
+
+            if (spektrumFrameDecode(out, length, true, 7, data) != 7)
+                ok = false;
+
+            for (i = 0; i < 7; i++)
+                if (data[i] != positions[i])
+                    ok = false;
+
+            // A lost idle mark runs two frames together
+
+            if (spektrumFrameDecode(out, rxFrameExtract(ring, RING_SIZE, start, (uint16_t)((end + SPEKTRUM_FRAME_SIZE) % RING_SIZE), out), true, 7, data) != 0)
+                merged = false;
+
+            start = end;
+        }
+    }
+
+    check(ok,     "Frames cut from the ring at every offset across the wrap");
+    check(merged, "Two frames run together rejected");
+
+    tooLong = (rxFrameExtract(ring, RING_SIZE, 0, RX_FRAME_MAX_SIZE + 1, out) == 0) &&
+              (rxFrameExtract(ring, RING_SIZE, 5, 5, out) == 0);
+
+    check(tooLong, "Empty and over long frames give 0");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Frames as Sent
+///////////////////////////////////////////////////////////////////////////////
+
+// Roll, pitch centred, throttle low, yaw centred, then a switch high and
+// one low, the rest centred.  The IBUS frame is the example published
+// with the protocol description, sticks near centre, throttle low.
+
+static const uint8_t sbusFrame[SBUS_FRAME_SIZE] =
+{
+    0x0F, 0xE0, 0x03, 0x1F, 0x2B, 0xC0, 0x37, 0x71, 0x56, 0x80, 0x0F, 0x7C,
+    0xE0, 0x03, 0x1F, 0xF8, 0xC0, 0x07, 0x3E, 0xF0, 0x81, 0x0F, 0x7C, 0x00,
+    0x00
+};
+
+static const uint8_t sbusFailsafeFrame[SBUS_FRAME_SIZE] =
+{
+    0x0F, 0xE0, 0x03, 0x1F, 0xF8, 0xC0, 0x07, 0x3E, 0xF0, 0x81, 0x0F, 0x7C,
+    0xE0, 0x03, 0x1F, 0xF8, 0xC0, 0x07, 0x3E, 0xF0, 0x81, 0x0F, 0x7C, 0x0C,
+    0x00
+};
+
+static const uint16_t sbusCommands[SBUS_CHANNELS] =
+{
+    3001, 3001, 1976, 3001, 4024, 1976, 3001, 3001, 3001, 3001, 3001, 3001, 3001, 3001, 3001, 3001
+};
+
+static const uint8_t sumdFrame[21] =
+{
+    0xA8, 0x01, 0x08, 0x2E, 0xE0, 0x2E, 0xE0, 0x22, 0x60, 0x2E, 0xE0, 0x3B,
+    0x60, 0x22, 0x60, 0x2E, 0xE0, 0x2E, 0xE0, 0x76, 0x06
+};
+
+static const uint8_t sumdFailsafeFrame[21] =
+{
+    0xA8, 0x81, 0x08, 0x2E, 0xE0, 0x2E, 0xE0, 0x22, 0x60, 0x2E, 0xE0, 0x3B,
+    0x60, 0x22, 0x60, 0x2E, 0xE0, 0x2E, 0xE0, 0x91, 0x19
+};
+
+static const uint16_t sumdCommands[8] =
+{
+    3000, 3000, 2200, 3000, 3800, 2200, 3000, 3000
+};
+
+static const uint8_t ibusFrame[IBUS_FRAME_SIZE] =
+{
+    0x20, 0x40, 0xDB, 0x05, 0xDC, 0x05, 0x54, 0x05, 0xDC, 0x05, 0xE8, 0x03,
+    0xD0, 0x07, 0xD2, 0x05, 0xE8, 0x03, 0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05,
+    0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05, 0xDA, 0xF3
+};
+
+static const uint16_t ibusCommands[IBUS_CHANNELS] =
+{
+    2998, 3000, 2728, 3000, 2000, 4000, 2980, 2000, 3000, 3000, 3000, 3000, 3000, 3000
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Reference Encoders
+///////////////////////////////////////////////////////////////////////////////
+
+static void referenceSbus(uint8_t *frame, const uint16_t *values, uint8_t flags)
+{
+    uint8_t channel, bit;
+
+    memset(frame, 0, SBUS_FRAME_SIZE);
+
+    frame[0] = SBUS_HEADER;
+
+    for (channel = 0; channel < SBUS_CHANNELS; channel++)
+        for (bit = 0; bit < 11; bit++)
+            if (values[channel] & (1 << bit))
+                frame[1 + (channel * 11 + bit) / 8] |= (uint8_t)(1 << ((channel * 11 + bit) % 8));
+
+    frame[23] = flags;
+}
+
+///////////////////////////////////////
+
+static uint16_t referenceSumd(uint8_t *frame, const uint16_t *values, uint8_t channels, uint8_t status)
+{
+    uint16_t crc = 0, length = 3 + 2 * channels, i;
+    uint8_t  channel, bit;
+
+    frame[0] = SUMD_HEADER;
+    frame[1] = status;
+    frame[2] = channels;
+
+    for (channel = 0; channel < channels; channel++)
+    {
+        frame[3 + 2 * channel] = (uint8_t)(values[channel] >> 8);
+        frame[4 + 2 * channel] = (uint8_t)(values[channel] & 0xFF);
+    }
+
+    // Bit serial, one bit at a time through the polynomial
+
+    for (i = 0; i < length; i++)
+        for (bit = 0; bit < 8; bit++)
+        {
+            uint8_t in = ((frame[i] >> (7 - bit)) & 1) ^ (crc >> 15);
+
+            crc = (uint16_t)((crc << 1) ^ (in ? 0x1021 : 0));
+        }
+
+    frame[length]     = (uint8_t)(crc >> 8);
+    frame[length + 1] = (uint8_t)(crc & 0xFF);
+
+    return length + 2;
+}
+
+///////////////////////////////////////
+
+static void referenceIbus(uint8_t *frame, const uint16_t *values)
+{
+    uint16_t sum = 0;
+    uint8_t  channel, b;
+
+    frame[0] = IBUS_FRAME_SIZE;
+    frame[1] = IBUS_COMMAND;
+
+    for (channel = 0; channel < IBUS_CHANNELS; channel++)
+    {
+        frame[2 + 2 * channel] = (uint8_t)(values[channel] & 0xFF);
+        frame[3 + 2 * channel] = (uint8_t)(values[channel] >> 8);
+    }
+
+    for (b = 0; b < IBUS_FRAME_SIZE - 2; b++)
+        sum = (uint16_t)(sum + frame[b]);
+
+    sum = (uint16_t)(0xFFFF - sum);
+
+    frame[30] = (uint8_t)(sum & 0xFF);
+    frame[31] = (uint8_t)(sum >> 8);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Single Bit Errors
+///////////////////////////////////////////////////////////////////////////////
+
+typedef uint8_t (*decoder_t)(const uint8_t *frame, uint16_t length, uint16_t *channelData, uint8_t *status);
+
+static int bitErrorsCaught(decoder_t decode, const uint8_t *frame, uint16_t length)
+{
+    uint8_t  copy[RX_FRAME_MAX_SIZE], status;
+    uint16_t data[RX_MAX_CHANNELS], bit;
+
+    for (bit = 0; bit < 8 * length; bit++)
+    {
+        memcpy(copy, frame, length);
+
+        copy[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+
+        if (decode(copy, length, data, &status) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////
+
+static int lengthsRejected(decoder_t decode, const uint8_t *frame, uint16_t length)
+{
+    uint16_t data[RX_MAX_CHANNELS], trial;
+    uint8_t  status;
+
+    for (trial = 0; trial <= RX_FRAME_MAX_SIZE; trial++)
+        if ((trial != length) && (decode(frame, trial, data, &status) != 0))
+            return false;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SBUS
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkSbus(void)
+{
+    uint8_t  frame[SBUS_FRAME_SIZE], status, channel;
+    uint16_t values[SBUS_CHANNELS], data[RX_MAX_CHANNELS], last;
+    uint32_t trial;
+    int      ok;
+
+    ok = (sbusFrameDecode(sbusFrame, SBUS_FRAME_SIZE, data, &status) == SBUS_CHANNELS) && (status == 0) &&
+         (memcmp(data, sbusCommands, sizeof(sbusCommands)) == 0);
+
+    check(ok, "SBUS frame decodes to 988, 1500 and 2012 uSec commands");
+
+    ok = (sbusFrameDecode(sbusFailsafeFrame, SBUS_FRAME_SIZE, data, &status) == SBUS_CHANNELS) &&
+         (status == (RX_FRAME_FAILSAFE | RX_FRAME_LOST));
+
+    check(ok, "SBUS failsafe and lost frame flags");
+
+    ok = true;
+
+    srand(3);
+
+    for (trial = 0; trial < 100000; trial++)
+    {
+        for (channel = 0; channel < SBUS_CHANNELS; channel++)
+            values[channel] = (uint16_t)(rand() & 0x7FF);
+
+        referenceSbus(frame, values, 0);
+
+        if (sbusFrameDecode(frame, SBUS_FRAME_SIZE, data, &status) != SBUS_CHANNELS)
+            ok = false;
+
+        for (channel = 0; channel < SBUS_CHANNELS; channel++)
+            if (data[channel] != (5 * values[channel] + 7044) / 4)
+                ok = false;
+    }
+
+    check(ok, "SBUS random frames decode on all 16 channels");
+
+    for (channel = 0, last = 0; channel < SBUS_CHANNELS; channel++)
+        values[channel] = 0;
+
+    ok = true;
+
+    for (trial = 0; trial < 2048; trial++)
+    {
+        values[0] = (uint16_t)trial;
+
+        referenceSbus(frame, values, 0);
+        sbusFrameDecode(frame, SBUS_FRAME_SIZE, data, &status);
+
+        if ((trial > 0) && (data[0] < last))
+            ok = false;
+
+        last = data[0];
+    }
+
+    check(ok, "SBUS commands never decrease with the value");
+
+    memcpy(frame, sbusFrame, SBUS_FRAME_SIZE);
+    frame[24] = 0x14;
+
+    ok = (sbusFrameDecode(frame, SBUS_FRAME_SIZE, data, &status) == SBUS_CHANNELS);
+
+    frame[0] = 0x0E;
+
+    ok = ok && (sbusFrameDecode(frame, SBUS_FRAME_SIZE, data, &status) == 0);
+
+    memcpy(frame, sbusFrame, SBUS_FRAME_SIZE);
+    frame[24] = 0x01;
+
+    ok = ok && (sbusFrameDecode(frame, SBUS_FRAME_SIZE, data, &status) == 0);
+
+    check(ok, "SBUS2 footers taken, bad headers and footers rejected");
+
+    check(lengthsRejected(sbusFrameDecode, sbusFrame, SBUS_FRAME_SIZE), "SBUS every length but 25 rejected");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SUMD
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkSumd(void)
+{
+    uint8_t  frame[RX_FRAME_MAX_SIZE], status, channel, channels;
+    uint16_t values[SUMD_MAX_CHANNELS], data[RX_MAX_CHANNELS], length;
+    uint32_t trial;
+    int      ok;
+
+    check(sumdCrc((const uint8_t *)"123456789", 9) == 0x31C3, "SUMD CRC16 check value 0x31C3");
+
+    ok = (sumdFrameDecode(sumdFrame, sizeof(sumdFrame), data, &status) == 8) && (status == 0) &&
+         (memcmp(data, sumdCommands, sizeof(sumdCommands)) == 0);
+
+    check(ok, "SUMD frame decodes to 1100, 1500 and 1900 uSec commands");
+
+    ok = (sumdFrameDecode(sumdFailsafeFrame, sizeof(sumdFailsafeFrame), data, &status) == 8) &&
+         (status == RX_FRAME_FAILSAFE);
+
+    check(ok, "SUMD failsafe status");
+
+    ok = true;
+
+    srand(4);
+
+    for (trial = 0; trial < 100000; trial++)
+    {
+        channels = (uint8_t)(1 + trial % SUMD_MAX_CHANNELS);
+
+        for (channel = 0; channel < channels; channel++)
+            values[channel] = (uint16_t)(7000 + rand() % 10000);
+
+        length = referenceSumd(frame, values, channels, SUMD_STATUS_LIVE);
+
+        if (sumdFrameDecode(frame, length, data, &status) != ((channels < RX_MAX_CHANNELS) ? channels : RX_MAX_CHANNELS))
+            ok = false;
+
+        for (channel = 0; (channel < channels) && (channel < RX_MAX_CHANNELS); channel++)
+            if (data[channel] != (values[channel] + 2) / 4)
+                ok = false;
+    }
+
+    check(ok, "SUMD random frames of 1 to 32 channels, first 16 kept");
+
+    check(bitErrorsCaught(sumdFrameDecode, sumdFrame, sizeof(sumdFrame)), "SUMD every single bit error rejected");
+    check(lengthsRejected(sumdFrameDecode, sumdFrame, sizeof(sumdFrame)), "SUMD every other length rejected");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// IBUS
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkIbus(void)
+{
+    uint8_t  frame[IBUS_FRAME_SIZE], status, channel;
+    uint16_t values[IBUS_CHANNELS], data[RX_MAX_CHANNELS];
+    uint32_t trial;
+    int      ok;
+
+    ok = (ibusFrameDecode(ibusFrame, IBUS_FRAME_SIZE, data, &status) == IBUS_CHANNELS) && (status == 0) &&
+         (memcmp(data, ibusCommands, sizeof(ibusCommands)) == 0);
+
+    check(ok, "IBUS published frame decodes to its commands");
+
+    ok = true;
+
+    srand(5);
+
+    for (trial = 0; trial < 100000; trial++)
+    {
+        for (channel = 0; channel < IBUS_CHANNELS; channel++)
+            values[channel] = (uint16_t)(800 + rand() % 1400);
+
+        referenceIbus(frame, values);
+
+        if (ibusFrameDecode(frame, IBUS_FRAME_SIZE, data, &status) != IBUS_CHANNELS)
+            ok = false;
+
+        for (channel = 0; channel < IBUS_CHANNELS; channel++)
+            if (data[channel] != 2 * values[channel])
+                ok = false;
+    }
+
+    check(ok, "IBUS random frames decode on all 14 channels");
+
+    check(bitErrorsCaught(ibusFrameDecode, ibusFrame, IBUS_FRAME_SIZE), "IBUS every single bit error rejected");
+    check(lengthsRejected(ibusFrameDecode, ibusFrame, IBUS_FRAME_SIZE), "IBUS every length but 32 rejected");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Throughput
+///////////////////////////////////////////////////////////////////////////////
+
+static uint8_t spektrumDecode(const uint8_t *frame, uint16_t length, uint16_t *channelData, uint8_t *status)
+{
+    *status = 0;
+
+    return spektrumFrameDecode(frame, length, true, SPEKTRUM_MAX_CHANNEL, channelData);
+}
+
+///////////////////////////////////////
+
+// Fills the ring with copies of one frame and goes round it the way
+// rxUpdate() does, the frame contents make no difference to the work
+
+static void speed(const char *name, decoder_t decode, const uint8_t *frame, uint16_t size, uint8_t channels, uint32_t baud)
+{
+    uint8_t  ring[RING_SIZE], out[RX_FRAME_MAX_SIZE], status;
+    uint16_t data[RX_MAX_CHANNELS], ends[RING_SIZE], count, start, end, length;
+    uint32_t n, decoded = 0;
+    double   begin, elapsed, bytesPerSecond;
+    char     what[80];
+
+    count = RING_SIZE / size;
+
+    for (n = 0; n < count; n++)
+    {
+        memcpy(&ring[n * size], frame, size);
+
+        ends[n] = (uint16_t)(((n + 1) * size) % RING_SIZE);
+    }
+
+    // The last frame ends short of the ring end, start from there so the
+    // first frame crosses nothing it should not
+
+    start = ends[count - 1];
+
+    if (start != 0)
+        memcpy(&ring[start], frame, RING_SIZE - start);
+
+    start = 0;
+    begin = now();
+
+    for (n = 0; n < SPEED_FRAMES; n++)
+    {
+        end    = ends[n % count];
+        length = rxFrameExtract(ring, RING_SIZE, start, end, out);
+        start  = (end == ends[count - 1]) ? 0 : end;
+
+        decoded += decode(out, length, data, &status);
+    }
+
+    elapsed        = now() - begin;
+    sink           = decoded + data[0];
+    bytesPerSecond = (double)SPEED_FRAMES * size / (elapsed * 1.0e-9);
+
+    printf("%-9s %6.1f ns per frame, %6.1f Mbyte/s, %6.0f times the line rate\n",
+           name, elapsed / SPEED_FRAMES, bytesPerSecond * 1.0e-6, bytesPerSecond / (baud / 10.0));
+
+    snprintf(what, sizeof(what), "%s every frame decoded in the timed run", name);
+
+    check(decoded == (uint32_t)SPEED_FRAMES * channels, what);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+    uint8_t  spektrum[SPEKTRUM_FRAME_SIZE], channels[7] = { 0, 1, 2, 3, 4, 5, 6 };
+    uint16_t positions[7] = { 1024, 1024, 342, 1024, 1706, 342, 1024 };
+
+    checkPositions(false);
+    checkPositions(true);
+    checkRejects();
+    checkCommands();
+    checkExtract();
+
+    checkSbus();
+    checkSumd();
+    checkIbus();
+
+    printf("\n");
+
+    referenceFrame(spektrum, true, channels, positions, 7);
+
+    speed("Spektrum", spektrumDecode,  spektrum,  SPEKTRUM_FRAME_SIZE, 7,  115200);
+    speed("SBUS",     sbusFrameDecode, sbusFrame, SBUS_FRAME_SIZE,     16, 100000);
+    speed("SUMD",     sumdFrameDecode, sumdFrame, sizeof(sumdFrame),   8,  115200);
+    speed("IBUS",     ibusFrameDecode, ibusFrame, IBUS_FRAME_SIZE,     14, 115200);
+
+    printf("\n%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
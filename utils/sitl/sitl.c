@@ -0,0 +1,597 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Software in the loop build of the flight stack.  The estimator, command
+// processing, PID, mixer and filter modules are compiled from src/ without
+// changes and run against sitlModel.c.  The tasks and their table are
+// src/tasks.c, the file the board builds, with the receiver, barometer and
+// magnetometer drivers below fed from the model and the other drivers the
+// tasks call idle in sitlHal.c.  The simulation is lock-stepped, simulated time only advances a 1 kHz
+// frame after every due task has run, so runs are repeatable and go as
+// fast as the host allows.
+//
+// Usage: sitl [-t seconds] [-s seed] [-e estimator] [-R] [-S method] [-T streams] [-o file] [-r file]
+//
+//   -t  Flight length in seconds, default 600
+//   -s  Noise seed, default 1
+//   -e  Attitude estimator, "marg" (default) or "ekf"
+//   -R  Run the rate PIDs and the mixer with each 1 kHz gyro sample, see
+//       rateLoop.c
+//   -S  RC smoothing, 0 off (default), 1 linear, 2 first order, see
+//       rcSmoothing.c, the pilot sends a frame every 20 ms
+//   -T  High speed telemetry streams to enable, e.g. -T 45b, one hex digit
+//       a stream, the message ids in telemMessages.h, at the rates and
+//       budget in the EEPROM defaults
+//   -o  Telemetry output file, default stdout, binary frames as the board
+//       sends them, ../telemetry/telemcsv turns them into text
+//   -r  Record the 500 Hz chain inputs for the bench, see sitlRecord.h
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <ctype.h>
+#include <getopt.h>
+#include <time.h>
+
+#include "board.h"
+#include "tasks.h"
+
+#include "sitlHal.h"
+#include "sitlModel.h"
+#include "sitlRecord.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define SITL_MODEL_STEPS_PER_FRAME 4  // 4 kHz rigid body integration
+
+#define SITL_ARM_START      6.0f      // Seconds, after execUp
+#define SITL_ARM_END        8.0f
+#define SITL_MANEUVER_START 15.0f
+#define SITL_LANDING_TIME   15.0f     // Seconds before the end to start down
+
+#define SITL_CRUISE_ALT     5.0f      // Meters
+
+#define SITL_RX_FRAME_TIME  20000     // uSec, the pilot's transmitter
+
+#define SITL_MAG_COUNTS     1090.0f   // HMC5883 counts per gauss at the default gain
+
+///////////////////////////////////////////////////////////////////////////////
+
+static sitlModel_t model;
+
+static float       flightLength = 600.0f;
+
+float              dt500Hz, dt100Hz;
+
+static float       sitlPressureAlt;
+
+static FILE        *recordFile = NULL;
+
+///////////////////////////////////////
+
+static double   attitudeErrorSum[3];
+static uint32_t attitudeErrorCount;
+static float    attitudeErrorMax[3];
+static float    maxAltitude;
+
+///////////////////////////////////////////////////////////////////////////////
+// Sensor Quantization, what the MPU6000 and MXR9150 would deliver
+///////////////////////////////////////////////////////////////////////////////
+
+// Inverts the axis signs and scale factors scaleSensors500Hz() applies, so
+// the flight code sees raw counts with real resolution and range.
+
+static int16_t sitlCounts(float value, float min, float max)
+{
+    return (int16_t)lrintf(constrain(value, min, max));
+}
+
+///////////////////////////////////////
+
+static void sitlSample(const float accel[3], const float gyro[3], mpu6000Sample_t *sample, float mxr[3])
+{
+    sample->accel[XAXIS] = sitlCounts( accel[XAXIS] / ACCEL_SCALE_FACTOR, -32768.0f, 32767.0f);
+    sample->accel[YAXIS] = sitlCounts(-accel[YAXIS] / ACCEL_SCALE_FACTOR, -32768.0f, 32767.0f);
+    sample->accel[ZAXIS] = sitlCounts(-accel[ZAXIS] / ACCEL_SCALE_FACTOR, -32768.0f, 32767.0f);
+
+    sample->temperature  = 0;
+
+    sample->gyro[ROLL ]  = sitlCounts( gyro[ROLL ] / GYRO_SCALE_FACTOR, -32768.0f, 32767.0f);
+    sample->gyro[PITCH]  = sitlCounts(-gyro[PITCH] / GYRO_SCALE_FACTOR, -32768.0f, 32767.0f);
+    sample->gyro[YAW  ]  = sitlCounts(-gyro[YAW  ] / GYRO_SCALE_FACTOR, -32768.0f, 32767.0f);
+
+    sample->time = sitlTime;
+
+    mxr[XAXIS] = sitlCounts(eepromConfig.accelBiasMXR[XAXIS] - accel[XAXIS] / eepromConfig.accelScaleFactorMXR[XAXIS], 0.0f, 4095.0f);
+    mxr[YAXIS] = sitlCounts(eepromConfig.accelBiasMXR[YAXIS] - accel[YAXIS] / eepromConfig.accelScaleFactorMXR[YAXIS], 0.0f, 4095.0f);
+    mxr[ZAXIS] = sitlCounts(eepromConfig.accelBiasMXR[ZAXIS] + accel[ZAXIS] / eepromConfig.accelScaleFactorMXR[ZAXIS], 0.0f, 4095.0f);
+}
+
+///////////////////////////////////////
+
+static void sitlHandoffMXR(float sum[3], float summed[3])
+{
+    uint8_t axis;
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        summed[axis] = sum[axis];
+        sum[axis]    = 0.0f;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Input Recording
+///////////////////////////////////////////////////////////////////////////////
+
+static void sitlRecord(void)
+{
+    sitlRecord_t record;
+
+    memset(&record, 0, sizeof(record));
+
+    record.summed500Hz = mpu6000Summed500Hz;
+
+    memcpy(record.accelSummedMXR, accelSummedSamples500HzMXR, sizeof(record.accelSummedMXR));
+    memcpy(record.mag,            sensors.mag10Hz,            sizeof(record.mag));
+    memcpy(record.rxCommand,      rxCommand,                  sizeof(record.rxCommand));
+
+    record.pressureAlt = sensors.pressureAlt50Hz;
+
+    sitlModelAttitude(&model, record.truthAttitude);
+
+    record.truthAttitude[YAW] = standardRadianFormat(record.truthAttitude[YAW] - eepromConfig.magVar);
+    record.truthAltitude      = (float)-model.position[2];
+
+    record.execUp             = execUp;
+    record.magDataUpdate      = magDataUpdate;
+    record.flightMode         = flightMode;
+    record.headingHoldEngaged = headingHoldEngaged;
+    record.holdIntegrators    = holdIntegrators;
+    record.armed              = armed;
+
+    fwrite(&record, sizeof(record), 1, recordFile);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Pilot, flies a fixed profile so runs can be compared
+///////////////////////////////////////////////////////////////////////////////
+
+static void sitlStick(uint8_t channel, float value)
+{
+    sitlRxChannel[eepromConfig.rcMap[channel]] = (uint16_t)constrain(value, MINCOMMAND, MAXCOMMAND);
+}
+
+///////////////////////////////////////
+
+static void sitlPilot(void)
+{
+    float t = (float)sitlTime * 0.000001f;
+    float altitude, climbRate, targetAltitude, hoverCommand, throttle;
+    float maneuver;
+    uint8_t axis;
+
+    sitlStick(ROLL,     MIDCOMMAND);
+    sitlStick(PITCH,    MIDCOMMAND);
+    sitlStick(YAW,      MIDCOMMAND);
+    sitlStick(THROTTLE, MINCOMMAND);
+    sitlStick(AUX1,     MAXCOMMAND);  // Attitude mode
+    sitlStick(AUX2,     MINCOMMAND);
+    sitlStick(AUX3,     MINCOMMAND);
+    sitlStick(AUX4,     MINCOMMAND);
+
+    if (t < SITL_ARM_START)
+        return;
+
+    if (t < SITL_ARM_END)
+    {
+        sitlStick(YAW, MAXCOMMAND);   // Low throttle, right yaw arms
+        return;
+    }
+
+    if (t > flightLength - 3.0f)
+    {
+        sitlStick(YAW, MINCOMMAND);   // Low throttle, left yaw disarms
+        return;
+    }
+
+    ///////////////////////////////////
+
+    // Altitude by eye, uses the true state like a pilot watching the aircraft
+
+    altitude  = (float)-model.position[2];
+    climbRate = (float)-model.velocity[2];
+
+    targetAltitude = fminf((t - SITL_ARM_END) * 1.0f, SITL_CRUISE_ALT);
+
+    if (t > flightLength - SITL_LANDING_TIME)
+        targetAltitude = fmaxf(SITL_CRUISE_ALT - (t - (flightLength - SITL_LANDING_TIME)) * 0.5f, -1.0f);
+
+    hoverCommand = MINCOMMAND + (MAXCOMMAND - MINCOMMAND) *
+                   sqrtf((float)(model.mass * 9.8065 / (model.numberMotor * model.motorMaxThrust)));
+
+    throttle = hoverCommand + 150.0f * (targetAltitude - altitude) - 200.0f * climbRate;
+
+    if ((targetAltitude <= 0.0f) && model.onGround)
+        throttle = MINCOMMAND;
+
+    sitlStick(THROTTLE, throttle);
+
+    ///////////////////////////////////
+
+    // Repeating 12 second sequence of half second stick pulses, roll, pitch
+    // and yaw, each one way and then back two seconds later
+
+    if ((t < SITL_MANEUVER_START) || (t > flightLength - SITL_LANDING_TIME))
+        return;
+
+    maneuver = fmodf(t - SITL_MANEUVER_START, 12.0f);
+    axis     = (uint8_t)(maneuver / 4.0f);
+    maneuver = fmodf(maneuver, 4.0f);
+
+    if (maneuver < 0.5f)
+        sitlStick(axis, MIDCOMMAND + 300.0f);
+    else if ((maneuver >= 2.0f) && (maneuver < 2.5f))
+        sitlStick(axis, MIDCOMMAND - 300.0f);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Estimator Statistics
+///////////////////////////////////////////////////////////////////////////////
+
+static void sitlStatistics(void)
+{
+    uint8_t axis;
+    float   truth[3], error;
+
+    if ((armed == false) || model.onGround)
+        return;
+
+    sitlModelAttitude(&model, truth);
+
+    truth[YAW] -= eepromConfig.magVar;  // The estimator reports magnetic heading
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        error = standardRadianFormat(getAttitude()[axis] - truth[axis]);
+
+        attitudeErrorSum[axis] += error * error;
+
+        if (fabsf(error) > attitudeErrorMax[axis])
+            attitudeErrorMax[axis] = fabsf(error);
+    }
+
+    attitudeErrorCount++;
+
+    maxAltitude = fmaxf(maxAltitude, (float)-model.position[2]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Receiver, a pilot frame every 20 mSec as the Rx task polls
+///////////////////////////////////////////////////////////////////////////////
+
+void rxUpdate(void)
+{
+    if ((sitlTime - rxFrameTime) < SITL_RX_FRAME_TIME)
+        return;
+
+    sitlPilot();
+
+    rcActive    = true;
+    rxFrameTime = sitlTime;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Barometer, the reading sitlFrame() took from the model
+///////////////////////////////////////////////////////////////////////////////
+
+void calculateTemperature(void)
+{
+}
+
+///////////////////////////////////////
+
+void calculatePressureAltitude(void)
+{
+    sensors.pressureAlt50Hz = sitlPressureAlt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Simulation Frame, the 1 kHz SysTick
+///////////////////////////////////////////////////////////////////////////////
+
+static void sitlFrame(uint16_t frame)
+{
+    uint8_t         i;
+    float           accel[3], gyro[3], mxr[3], mag[3];
+    mpu6000Sample_t sample;
+
+    for (i = 0; i < model.numberMotor; i++)
+        model.command[i] = constrain(((float)sitlEscOutput[i] - MINCOMMAND) / (MAXCOMMAND - MINCOMMAND), 0.0f, 1.0f);
+
+    for (i = 0; i < SITL_MODEL_STEPS_PER_FRAME; i++)
+        sitlModelStep(&model, 0.001 / SITL_MODEL_STEPS_PER_FRAME);
+
+    sitlTime += 1000;
+
+    sitlModelAccel(&model, accel);
+    sitlModelGyro(&model, gyro);
+
+    sitlSample(accel, gyro, &sample, mxr);
+
+    mpu6000Accumulate(&mpu6000Sum500Hz, &sample);
+    mpu6000Accumulate(&mpu6000Sum100Hz, &sample);
+
+    rateLoopUpdate(&sample);
+
+    for (i = 0; i < 3; i++)
+    {
+        accelSum500HzMXR[i] += mxr[i];
+        accelSum100HzMXR[i] += mxr[i];
+    }
+
+    // Barometer and magnetometer readings land as the tasks that use them
+    // come due, what the I2C drivers leave for them on the board
+
+    if ((frame % COUNT_50HZ) == 0)
+    {
+        sitlPressureAlt    = sitlModelPressureAlt(&model);
+        pressureSampleTime = sitlTime;
+
+        newTemperatureReading = true;
+        newPressureReading    = true;
+    }
+
+    if ((frame % COUNT_10HZ) == 0)
+    {
+        sitlModelMag(&model, mag);
+
+        rawMag[XAXIS].value = sitlCounts( (mag[XAXIS] + eepromConfig.magBias[XAXIS]) / magScaleFactor[XAXIS], -2048.0f, 2047.0f);
+        rawMag[YAXIS].value = sitlCounts( (mag[YAXIS] + eepromConfig.magBias[YAXIS]) / magScaleFactor[YAXIS], -2048.0f, 2047.0f);
+        rawMag[ZAXIS].value = sitlCounts((-mag[ZAXIS] + eepromConfig.magBias[ZAXIS]) / magScaleFactor[ZAXIS], -2048.0f, 2047.0f);
+
+        magSampleTime = sitlTime;
+        newMagData    = true;
+    }
+
+    if ((frame % COUNT_500HZ) == 0)
+    {
+        if (mpu6000AccumulatorHandoff(&mpu6000Sum500Hz, &mpu6000Summed500Hz))
+            newMpu6000Data500Hz = true;
+        else
+            mpu6000StallCount++;
+
+        sitlHandoffMXR(accelSum500HzMXR, accelSummedSamples500HzMXR);
+    }
+
+    if ((frame % COUNT_100HZ) == 0)
+    {
+        if (mpu6000AccumulatorHandoff(&mpu6000Sum100Hz, &mpu6000Summed100Hz))
+            newMpu6000Data100Hz = true;
+
+        sitlHandoffMXR(accelSum100HzMXR, accelSummedSamples100HzMXR);
+    }
+
+    // The 500 Hz task runs first, record its inputs before and check its
+    // attitude after
+
+    if ((recordFile != NULL) && ((frame % COUNT_500HZ) == 0))
+        sitlRecord();
+
+    schedulerTick(frame, micros());
+
+    while (schedulerRun());
+
+    if ((frame % COUNT_500HZ) == 0)
+        sitlStatistics();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    int             option;
+    uint32_t        seed = 1;
+    uint16_t        frame = 0;
+    const char      *streams = "";
+    uint8_t         estimator = MARG_AHRS;
+    uint8_t         rateLoopEnabled = false;
+    uint8_t         rcSmoothingMethod = RC_SMOOTHING_OFF;
+    const char      *outputName = NULL;
+    const char      *recordName = NULL;
+    sitlRecordHeader_t recordHeader;
+    struct timespec start, end;
+    double          wallTime;
+
+    while ((option = getopt(argc, argv, "t:s:e:RS:T:o:r:")) != -1)
+    {
+        switch (option)
+        {
+            case 't':
+                flightLength = strtof(optarg, NULL);
+                break;
+
+            case 's':
+                seed = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'e':
+                estimator = (strcmp(optarg, "ekf") == 0) ? ATTITUDE_EKF : MARG_AHRS;
+                break;
+
+            case 'R':
+                rateLoopEnabled = true;
+                break;
+
+            case 'S':
+                rcSmoothingMethod = (uint8_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'T':
+                streams = optarg;
+                break;
+
+            case 'o':
+                outputName = optarg;
+                break;
+
+            case 'r':
+                recordName = optarg;
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-t seconds] [-s seed] [-e marg|ekf] [-R] [-S method] [-T streams] [-o file] [-r file]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    sitlTelemetryFile = stdout;
+
+    if (outputName != NULL)
+    {
+        sitlTelemetryFile = fopen(outputName, "w");
+
+        if (sitlTelemetryFile == NULL)
+        {
+            perror(outputName);
+            return 1;
+        }
+    }
+
+    if (recordName != NULL)
+    {
+        recordFile = fopen(recordName, "wb");
+
+        if (recordFile == NULL)
+        {
+            perror(recordName);
+            return 1;
+        }
+
+        recordHeader.magic      = SITL_RECORD_MAGIC;
+        recordHeader.version    = SITL_RECORD_VERSION;
+        recordHeader.recordSize = sizeof(sitlRecord_t);
+        recordHeader.seed       = seed;
+
+        fwrite(&recordHeader, sizeof(recordHeader), 1, recordFile);
+    }
+
+    ///////////////////////////////////
+
+    // systemInit() without the hardware
+
+    setEEPROMDefaults();
+
+    eepromConfig.attitudeEstimator = estimator;
+    eepromConfig.rateLoopEnabled   = rateLoopEnabled;
+    eepromConfig.rcSmoothing       = rcSmoothingMethod;
+
+    accConfidenceDecay = 1.0f / sqrtf(eepromConfig.accelCutoff);
+
+    magScaleFactor[XAXIS] = 1.0f / SITL_MAG_COUNTS;
+    magScaleFactor[YAXIS] = 1.0f / SITL_MAG_COUNTS;
+    magScaleFactor[ZAXIS] = 1.0f / SITL_MAG_COUNTS;
+
+    initMixer();
+    filterBankInit();
+    dynamicNotchInit();
+    initPID();
+    rcSmoothingInit(&rcSmoothing, eepromConfig.rcSmoothing);
+    rateLoopInit();
+
+    attitudeEKFreset(&attitudeEKF);
+
+    sitlModelInit(&model, seed);
+
+    schedulerInit(tasks, NUMBER_OF_TASKS, micros);
+
+    highSpeedTelemInit();
+
+    for (; *streams != '\0'; streams++)
+    {
+        if (isdigit((unsigned char)*streams))
+            highSpeedTelemEnable((uint8_t)(*streams - '0'), true);
+        else if (isxdigit((unsigned char)*streams))
+            highSpeedTelemEnable((uint8_t)(tolower((unsigned char)*streams) - 'a' + 10), true);
+    }
+
+    ///////////////////////////////////
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (sitlTime < (uint64_t)(flightLength * 1000000.0f))
+    {
+        frame++;
+        if (frame > FRAME_COUNT)
+            frame = 1;
+
+        sitlFrame(frame);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    wallTime = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+
+    ///////////////////////////////////
+
+    sitlTelemetryFlush();
+
+    if (sitlTelemetryFile != stdout)
+        fclose(sitlTelemetryFile);
+
+    if (recordFile != NULL)
+        fclose(recordFile);
+
+    fprintf(stderr, "Simulated %.1f s in %.3f s, %.0fx real time\n",
+            (double)sitlTime * 1e-6, wallTime, (double)sitlTime * 1e-6 / wallTime);
+
+    fprintf(stderr, "Max altitude %.2f m, final altitude %.2f m, %s\n",
+            maxAltitude, -model.position[2], (armed == true) ? "armed" : "disarmed");
+
+    if ((telemetryTxRing.written > 0) || (telemetryTxRing.overflows > 0))
+        fprintf(stderr, "Telemetry %ld bytes, %ld dropped in %ld writes, transmit ring peak %d bytes\n",
+                (long)telemetryTxRing.written, (long)telemetryTxRing.dropped,
+                (long)telemetryTxRing.overflows, telemetryTxRing.peak);
+
+    if (attitudeErrorCount > 0)
+        fprintf(stderr, "Attitude error deg RMS/max  roll %.3f/%.3f  pitch %.3f/%.3f  yaw %.3f/%.3f\n",
+                sqrt(attitudeErrorSum[ROLL ] / attitudeErrorCount) * R2D, attitudeErrorMax[ROLL ] * R2D,
+                sqrt(attitudeErrorSum[PITCH] / attitudeErrorCount) * R2D, attitudeErrorMax[PITCH] * R2D,
+                sqrt(attitudeErrorSum[YAW  ] / attitudeErrorCount) * R2D, attitudeErrorMax[YAW  ] * R2D);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
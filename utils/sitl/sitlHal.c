@@ -0,0 +1,466 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Stands in for the drivers the flight code calls.  Time only moves when
+// the simulation loop advances sitlTime, so everything is lock-stepped to
+// the model.  The prototypes come from the real board.h, so a driver API
+// change breaks this build instead of silently diverging from it.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "board.h"
+
+#include "sitlHal.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Variables owned by main.c and the drivers on the board
+///////////////////////////////////////////////////////////////////////////////
+
+eepromConfig_t eepromConfig;
+
+sensors_t      sensors;
+
+semaphore_t    execUp = false;
+
+uint8_t        rcActive = false;
+
+volatile uint64_t rxFrameTime = 0;
+
+uint8_t        magDataUpdate = false;
+
+float          accelOneG = 9.8065f;
+
+int32_t        ms5611Temperature = 2500;
+
+mpu6000Accumulator_t mpu6000Sum100Hz;
+mpu6000Accumulator_t mpu6000Sum500Hz;
+
+mpu6000Accumulator_t mpu6000Summed100Hz = { .samples = 1 };
+mpu6000Accumulator_t mpu6000Summed500Hz = { .samples = 1 };
+
+semaphore_t    newMpu6000Data100Hz = false;
+semaphore_t    newMpu6000Data500Hz = false;
+
+uint32_t       mpu6000StallCount = 0;
+
+float          accelTCBias[3];
+float          gyroRTBias[3];
+float          gyroTCBias[3];
+
+float          accelSum100HzMXR[3];
+float          accelSum500HzMXR[3];
+
+float          accelSummedSamples100HzMXR[3];
+float          accelSummedSamples500HzMXR[3];
+
+uint32_t       deltaTime500Hz,  executionTime500Hz,  previous500HzTime;
+uint32_t       deltaTime100Hz,  executionTime100Hz,  previous100HzTime;
+uint32_t       deltaTime50Hz,   executionTime50Hz,   previous50HzTime;
+uint32_t       deltaTime10Hz,   executionTime10Hz,   previous10HzTime;
+uint32_t       deltaTime5Hz,    executionTime5Hz,    previous5HzTime;
+uint32_t       deltaTime1Hz,    executionTime1Hz,    previous1HzTime;
+
+// Barometer and magnetometer readings, filled by sitl.c from the model
+
+uint32andUint8_t d1, d2;
+uint32_t       d1Value, d2Value;
+uint8_t        newPressureReading    = false;
+uint8_t        newTemperatureReading = false;
+uint64_t       pressureSampleTime;
+
+int16andUint8_t rawMag[3];
+float          magScaleFactor[3];
+uint8_t        newMagData = false;
+uint64_t       magSampleTime;
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t sitlTime = 0;
+
+uint16_t sitlRxChannel[NUMBER_OF_RC_CHANNELS] = { 3000, 3000, 3000, 2000, 2000, 2000, 2000, 2000,
+                                                 2000, 2000, 2000, 2000, 2000, 2000, 2000, 2000 };
+
+uint16_t sitlEscOutput[8];
+
+uint16_t sitlServoOutput[3];
+
+FILE     *sitlTelemetryFile = NULL;
+
+///////////////////////////////////////////////////////////////////////////////
+// System Timing
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t micros(void)
+{
+    return (uint32_t)sitlTime;
+}
+
+///////////////////////////////////////
+
+uint64_t micros64(void)
+{
+    return sitlTime;
+}
+
+///////////////////////////////////////
+
+uint32_t millis(void)
+{
+    return (uint32_t)(sitlTime / 1000);
+}
+
+///////////////////////////////////////
+
+// Blocking delays stall the flight code on the board, here they only
+// move the clock.  The model does not step while the flight code blocks.
+
+void delayMicroseconds(uint32_t us)
+{
+    sitlTime += us;
+}
+
+///////////////////////////////////////
+
+void delay(uint32_t ms)
+{
+    sitlTime += (uint64_t)ms * 1000;
+}
+
+///////////////////////////////////////
+
+// Same statistics as drv_system.c, times are simulated so mostly zero
+
+void isrTimeUpdate(isrTime_t *isrTime, uint32_t executionTime)
+{
+    if ((isrTime->count == 0) || (executionTime < isrTime->min))
+        isrTime->min = executionTime;
+
+    if (executionTime > isrTime->max)
+        isrTime->max = executionTime;
+
+    isrTime->sum += executionTime;
+    isrTime->count++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Receiver
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t rxRead(uint8_t channel)
+{
+    if (channel < NUMBER_OF_RC_CHANNELS)
+        return sitlRxChannel[channel];
+    else
+        return 2000;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ESC and Servo Outputs
+///////////////////////////////////////////////////////////////////////////////
+
+void pwmEscWrite(uint8_t channel, uint16_t value)
+{
+    if (channel < 8)
+        sitlEscOutput[channel] = value;
+}
+
+///////////////////////////////////////
+
+bool pwmEscBusy(void)
+{
+    return false;
+}
+
+///////////////////////////////////////
+
+void pwmEscTrigger(void)
+{
+    // The model reads sitlEscOutput directly, nothing to latch
+}
+
+///////////////////////////////////////
+
+void pwmServoWrite(uint8_t channel, uint16_t value)
+{
+    if (channel < 3)
+        sitlServoOutput[channel] = value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry and Logging
+///////////////////////////////////////////////////////////////////////////////
+
+// USART1 runs the flight code's transmit ring, src/txRing.c, with the
+// DMA modelled as sending at the 115200 baud byte rate as sitlTime moves
+// on.  A block goes to sitlTelemetryFile as its transfer starts, so the
+// file holds what the board would put on the wire, and the telemetry
+// scheduler sees the transmit space it would have.
+
+#define SITL_TX_BUFFER_SIZE  2048
+#define SITL_TX_BYTE_RATE    11520
+
+static uint8_t sitlTxBuffer[SITL_TX_BUFFER_SIZE];
+
+// As txRingInit() leaves it, the DMA is started by sitlTxDrain() instead
+// of from the commit
+
+txRing_t telemetryTxRing = { .buffer = sitlTxBuffer, .size = SITL_TX_BUFFER_SIZE, .limit = SITL_TX_BUFFER_SIZE };
+
+static uint64_t sitlTxTime = 0;         // sitlTime the link has sent up to
+static uint32_t sitlTxLeft = 0;         // Bytes of the transfer under way still to go
+
+///////////////////////////////////////
+
+static void sitlTxSend(uint64_t bytes)
+{
+    const uint8_t *data;
+    uint32_t      step;
+
+    while (bytes > 0)
+    {
+        if (telemetryTxRing.sending == 0)
+        {
+            sitlTxLeft = txRingSendStart(&telemetryTxRing, &data);
+
+            if (sitlTxLeft == 0)
+                return;
+
+            if (sitlTelemetryFile != NULL)
+                fwrite(data, 1, sitlTxLeft, sitlTelemetryFile);
+        }
+
+        step = (bytes < sitlTxLeft) ? (uint32_t)bytes : sitlTxLeft;
+
+        sitlTxLeft -= step;
+        bytes      -= step;
+
+        if (sitlTxLeft == 0)
+            txRingSendDone(&telemetryTxRing);
+    }
+}
+
+///////////////////////////////////////
+
+static void sitlTxDrain(void)
+{
+    uint64_t bytes;
+
+    bytes       = (sitlTime - sitlTxTime) * SITL_TX_BYTE_RATE / 1000000;
+    sitlTxTime += bytes * 1000000 / SITL_TX_BYTE_RATE;
+
+    sitlTxSend(bytes);
+
+    if (txRingPending(&telemetryTxRing) == 0)
+        sitlTxTime = sitlTime;
+}
+
+///////////////////////////////////////
+
+// Everything still in the ring to the file, at the end of a run
+
+void sitlTelemetryFlush(void)
+{
+    sitlTxSend(UINT64_MAX);
+}
+
+///////////////////////////////////////
+
+void telemetryPrintF(const char * fmt, ...)
+{
+    char    buf[256];
+    va_list vlist;
+
+    va_start(vlist, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, vlist);
+    va_end(vlist);
+
+    sitlTxDrain();
+
+    txRingWrite(&telemetryTxRing, (const uint8_t *)buf, (uint16_t)strlen(buf));
+}
+
+///////////////////////////////////////
+
+uint16_t telemetryTxFree(void)
+{
+    sitlTxDrain();
+
+    return txRingFree(&telemetryTxRing);
+}
+
+///////////////////////////////////////
+
+void telemetryWriteBuffer(const uint8_t *data, uint16_t length)
+{
+    sitlTxDrain();
+
+    txRingWrite(&telemetryTxRing, data, length);
+}
+
+///////////////////////////////////////
+
+void logPrintF(const char *text, ...)
+{
+    (void)text;
+}
+
+///////////////////////////////////////
+
+void evrPush(uint16_t evr, uint16_t reason)
+{
+    (void)evr;
+    (void)reason;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Sensors read directly by flight code
+///////////////////////////////////////////////////////////////////////////////
+
+// The model has no gyro bias to calibrate out
+
+void computeMPU6000RTData(void)
+{
+}
+
+///////////////////////////////////////
+
+// Same correction mpu6000.c applies, at a fixed die temperature
+
+#define SITL_MPU6000_TEMPERATURE 25.0f
+
+void computeMPU6000TCBias(void)
+{
+    uint8_t axis;
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        accelTCBias[axis] = eepromConfig.accelTCBiasSlope[axis] * SITL_MPU6000_TEMPERATURE + eepromConfig.accelTCBiasIntercept[axis];
+        gyroTCBias[axis]  = eepromConfig.gyroTCBiasSlope[axis]  * SITL_MPU6000_TEMPERATURE + eepromConfig.gyroTCBiasIntercept[axis];
+    }
+}
+
+///////////////////////////////////////
+
+uint16_t mxr9150X(void) { return 2048; }
+uint16_t mxr9150Y(void) { return 2048; }
+uint16_t mxr9150Z(void) { return 2048; }
+
+uint16_t vbatt(void)    { return 0; }
+
+float batteryVoltage(void) { return 0.0f; }    // No battery, batMon.c stays quiet
+
+///////////////////////////////////////////////////////////////////////////////
+// Drivers the tasks call with nothing attached in the simulation
+///////////////////////////////////////////////////////////////////////////////
+
+void GPIO_ToggleBits(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin)
+{
+    (void)GPIOx;
+    (void)GPIO_Pin;
+}
+
+///////////////////////////////////////
+
+uint8_t decodeMediaTek3329BinaryMsg(void) { return false; }
+uint8_t decodeNMEAsentence(void)          { return false; }
+uint8_t decodeUbloxMsg(void)              { return false; }
+
+///////////////////////////////////////
+
+void displayAltitude(float pressureAltitude, float altitudeReference, uint8_t altHoldState)
+{
+    (void)pressureAltitude;
+    (void)altitudeReference;
+    (void)altHoldState;
+}
+
+void displayArtificialHorizon(float roll, float pitch, uint8_t flightMode)
+{
+    (void)roll;
+    (void)pitch;
+    (void)flightMode;
+}
+
+void displayAttitude(float roll, float pitch, uint8_t flightMode)
+{
+    (void)roll;
+    (void)pitch;
+    (void)flightMode;
+}
+
+void displayHeading(float currentHeading)
+{
+    (void)currentHeading;
+}
+
+///////////////////////////////////////
+
+void cliCom(void) {}
+void rfCom(void)  {}
+
+///////////////////////////////////////////////////////////////////////////////
+// EEPROM, config.c links but the simulation never writes flash
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t crc32B(uint32_t* start, uint32_t* end)
+{
+    (void)start;
+    (void)end;
+
+    return 0;
+}
+
+void FLASH_Unlock(void) {}
+void FLASH_Lock(void) {}
+void FLASH_ClearFlag(uint32_t FLASH_FLAG) { (void)FLASH_FLAG; }
+
+FLASH_Status FLASH_EraseSector(uint32_t FLASH_Sector, uint8_t VoltageRange)
+{
+    (void)FLASH_Sector;
+    (void)VoltageRange;
+
+    return FLASH_ERROR_PROGRAM;
+}
+
+FLASH_Status FLASH_ProgramWord(uint32_t Address, uint32_t Data)
+{
+    (void)Address;
+    (void)Data;
+
+    return FLASH_ERROR_PROGRAM;
+}
+
+///////////////////////////////////////////////////////////////////////////////
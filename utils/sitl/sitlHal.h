@@ -38,43 +38,27 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
-#define NUMBER_OF_FIRST_ORDER_FILTERS 10
+#include <stdint.h>
+#include <stdio.h>
 
-#define ACCEL500HZ_X_LOWPASS 0
-#define ACCEL500HZ_Y_LOWPASS 1
-#define ACCEL500HZ_Z_LOWPASS 2
+///////////////////////////////////////////////////////////////////////////////
+// SITL Hardware Shim Variables
+///////////////////////////////////////////////////////////////////////////////
 
-#define ACCEL100HZ_X_LOWPASS 3
-#define ACCEL100HZ_Y_LOWPASS 4
-#define ACCEL100HZ_Z_LOWPASS 5
+extern uint64_t sitlTime;                  // Simulated uSec since power up
 
-#define PRESSURE_ALT_LOWPASS 6
+extern uint16_t sitlRxChannel[NUMBER_OF_RC_CHANNELS];  // Receiver channel order, 2000 to 4000
 
-#define EARTH_AXIS_ACCEL_X_HIGHPASS 7
-#define EARTH_AXIS_ACCEL_Y_HIGHPASS 8
-#define EARTH_AXIS_ACCEL_Z_HIGHPASS 9
+extern uint16_t sitlEscOutput[8];          // Last pwmEscWrite values
 
-///////////////////////////////////////////////////////////////////////////////
+extern uint16_t sitlServoOutput[3];        // Last pwmServoWrite values
 
-typedef struct firstOrderFilterData {
-  float   gx1;
-  float   gx2;
-  float   gx3;
-  float   previousInput;
-  float   previousOutput;
-} firstOrderFilterData_t;
-
-firstOrderFilterData_t firstOrderFilters[NUMBER_OF_FIRST_ORDER_FILTERS];
+extern FILE     *sitlTelemetryFile;       // What the telemetry port sends, from its transmit ring
 
 ///////////////////////////////////////////////////////////////////////////////
-
-void initFirstOrderFilter();
-
+// SITL Telemetry Flush, what is still in the transmit ring at the end
 ///////////////////////////////////////////////////////////////////////////////
 
-float firstOrderFilter(float input, struct firstOrderFilterData *filterParameters);
+void sitlTelemetryFlush(void);
 
 ///////////////////////////////////////////////////////////////////////////////
-
-
-
@@ -0,0 +1,321 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Rigid body multicopter for the SITL build.  Body axes are X forward,
+// Y right, Z down, earth axes are NED, the same frames the firmware uses.
+// Motors are first order lags on thrust, thrust goes with the square of
+// the normalized ESC command.  The sensor functions return what the
+// firmware expects in sensors_t after scaling and bias removal, so the
+// flight code sees the same units it gets from the real drivers.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <string.h>
+
+#include "sitlModel.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define GRAVITY 9.8065
+
+///////////////////////////////////////////////////////////////////////////////
+// Gaussian Noise
+///////////////////////////////////////////////////////////////////////////////
+
+static double uniform(uint32_t *seed)
+{
+    // xorshift32, never returns 0
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+
+    return (double)*seed / 4294967296.0;
+}
+
+static double gaussian(uint32_t *seed)
+{
+    double u1 = uniform(seed);
+    double u2 = uniform(seed);
+
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Rotations
+///////////////////////////////////////////////////////////////////////////////
+
+static void bodyToEarth(const double q[4], const double b[3], double e[3])
+{
+    e[0] = (1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3])) * b[0] + 2.0 * (q[1] * q[2] - q[0] * q[3]) * b[1] + 2.0 * (q[1] * q[3] + q[0] * q[2]) * b[2];
+    e[1] = 2.0 * (q[1] * q[2] + q[0] * q[3]) * b[0] + (1.0 - 2.0 * (q[1] * q[1] + q[3] * q[3])) * b[1] + 2.0 * (q[2] * q[3] - q[0] * q[1]) * b[2];
+    e[2] = 2.0 * (q[1] * q[3] - q[0] * q[2]) * b[0] + 2.0 * (q[2] * q[3] + q[0] * q[1]) * b[1] + (1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2])) * b[2];
+}
+
+///////////////////////////////////////
+
+static void earthToBody(const double q[4], const double e[3], double b[3])
+{
+    b[0] = (1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3])) * e[0] + 2.0 * (q[1] * q[2] + q[0] * q[3]) * e[1] + 2.0 * (q[1] * q[3] - q[0] * q[2]) * e[2];
+    b[1] = 2.0 * (q[1] * q[2] - q[0] * q[3]) * e[0] + (1.0 - 2.0 * (q[1] * q[1] + q[3] * q[3])) * e[1] + 2.0 * (q[2] * q[3] + q[0] * q[1]) * e[2];
+    b[2] = 2.0 * (q[1] * q[3] + q[0] * q[2]) * e[0] + 2.0 * (q[2] * q[3] - q[0] * q[1]) * e[1] + (1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2])) * e[2];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Model Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void sitlModelInit(sitlModel_t *model, uint32_t seed)
+{
+    double a;
+
+    memset(model, 0, sizeof(sitlModel_t));
+
+    model->mass        = 1.2;
+    model->armLength   = 0.225;
+    model->inertia[0]  = 0.0125;
+    model->inertia[1]  = 0.0125;
+    model->inertia[2]  = 0.0220;
+    model->drag[0]     = 0.6;
+    model->drag[1]     = 0.6;
+    model->drag[2]     = 0.2;
+    model->angularDrag = 0.002;
+
+    // Same order and rotation as MIXERTYPE_QUADX in mixer.c
+
+    a = model->armLength * M_SQRT1_2;
+
+    model->numberMotor = 4;
+
+    model->motorPosition[0][0] =  a;  model->motorPosition[0][1] = -a;  model->motorDirection[0] = -1.0;  // Front Left  CW
+    model->motorPosition[1][0] =  a;  model->motorPosition[1][1] =  a;  model->motorDirection[1] =  1.0;  // Front Right CCW
+    model->motorPosition[2][0] = -a;  model->motorPosition[2][1] =  a;  model->motorDirection[2] = -1.0;  // Rear Right  CW
+    model->motorPosition[3][0] = -a;  model->motorPosition[3][1] = -a;  model->motorDirection[3] =  1.0;  // Rear Left   CCW
+
+    model->motorMaxThrust    = 8.0;
+    model->motorTorqueRatio  = 0.016;
+    model->motorTimeConstant = 0.035;
+
+    model->gyroNoise  = 0.01;
+    model->accelNoise = 0.15;
+    model->vibration  = 1.0;
+    model->magNoise   = 0.005;
+    model->baroNoise  = 0.15;
+
+    // Albuquerque, NM, 9 degrees east declination, matches the magVar default
+
+    model->magField[0] = 0.24 * cos(9.0 * M_PI / 180.0);
+    model->magField[1] = 0.24 * sin(9.0 * M_PI / 180.0);
+    model->magField[2] = 0.45;
+
+    model->q[0] = 1.0;
+
+    model->specificForce[2] = -GRAVITY;
+
+    model->onGround = 1;
+
+    model->seed = (seed == 0) ? 1 : seed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Model Step
+///////////////////////////////////////////////////////////////////////////////
+
+void sitlModelStep(sitlModel_t *model, double dt)
+{
+    uint8_t i;
+    double  alpha, target;
+    double  force[3] = { 0.0, 0.0, 0.0 };
+    double  torque[3] = { 0.0, 0.0, 0.0 };
+    double  velocityBody[3], accel[3], h[3], dq[4];
+    double  *q = model->q;
+    double  *w = model->rate;
+
+    ///////////////////////////////////
+
+    alpha = 1.0 - exp(-dt / model->motorTimeConstant);
+
+    for (i = 0; i < model->numberMotor; i++)
+    {
+        target = model->command[i] * model->command[i] * model->motorMaxThrust;
+
+        model->thrust[i] += (target - model->thrust[i]) * alpha;
+
+        force[2]  -= model->thrust[i];
+
+        torque[0] -= model->motorPosition[i][1] * model->thrust[i];
+        torque[1] += model->motorPosition[i][0] * model->thrust[i];
+        torque[2] += model->motorDirection[i] * model->motorTorqueRatio * model->thrust[i];
+    }
+
+    ///////////////////////////////////
+
+    // Translation, drag in body axes, integration in earth axes
+
+    earthToBody(q, model->velocity, velocityBody);
+
+    for (i = 0; i < 3; i++)
+        force[i] -= model->drag[i] * velocityBody[i];
+
+    bodyToEarth(q, force, accel);
+
+    accel[0] = accel[0] / model->mass;
+    accel[1] = accel[1] / model->mass;
+    accel[2] = accel[2] / model->mass + GRAVITY;
+
+    if (model->onGround && (accel[2] >= 0.0))
+    {
+        // Resting on the ground, the ground carries the difference
+
+        accel[0] = accel[1] = accel[2] = 0.0;
+
+        model->velocity[0] = model->velocity[1] = model->velocity[2] = 0.0;
+        w[0] = w[1] = w[2] = 0.0;
+    }
+    else
+    {
+        model->onGround = 0;
+
+        for (i = 0; i < 3; i++)
+        {
+            model->velocity[i] += accel[i] * dt;
+            model->position[i] += model->velocity[i] * dt;
+        }
+
+        if (model->position[2] >= 0.0)
+        {
+            model->position[2] = 0.0;
+            model->onGround    = 1;
+        }
+
+        // Rotation, body axes, Euler's equation
+
+        for (i = 0; i < 3; i++)
+        {
+            torque[i] -= model->angularDrag * w[i];
+            h[i] = model->inertia[i] * w[i];
+        }
+
+        w[0] += (torque[0] - (w[1] * h[2] - w[2] * h[1])) / model->inertia[0] * dt;
+        w[1] += (torque[1] - (w[2] * h[0] - w[0] * h[2])) / model->inertia[1] * dt;
+        w[2] += (torque[2] - (w[0] * h[1] - w[1] * h[0])) / model->inertia[2] * dt;
+
+        dq[0] = 0.5 * (-q[1] * w[0] - q[2] * w[1] - q[3] * w[2]);
+        dq[1] = 0.5 * ( q[0] * w[0] + q[2] * w[2] - q[3] * w[1]);
+        dq[2] = 0.5 * ( q[0] * w[1] - q[1] * w[2] + q[3] * w[0]);
+        dq[3] = 0.5 * ( q[0] * w[2] + q[1] * w[1] - q[2] * w[0]);
+
+        for (i = 0; i < 4; i++)
+            q[i] += dq[i] * dt;
+
+        alpha = 1.0 / sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+
+        for (i = 0; i < 4; i++)
+            q[i] *= alpha;
+    }
+
+    ///////////////////////////////////
+
+    // What an accelerometer measures, acceleration less gravity, body axes
+
+    accel[2] -= GRAVITY;
+
+    earthToBody(q, accel, model->specificForce);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Model Sensors
+///////////////////////////////////////////////////////////////////////////////
+
+void sitlModelGyro(sitlModel_t *model, float gyro[3])
+{
+    uint8_t i;
+
+    for (i = 0; i < 3; i++)
+        gyro[i] = (float)(model->rate[i] + model->gyroBias[i] + model->gyroNoise * gaussian(&model->seed));
+}
+
+///////////////////////////////////////
+
+void sitlModelAccel(sitlModel_t *model, float accel[3])
+{
+    uint8_t i;
+    double  totalThrust = 0.0;
+    double  sigma;
+
+    for (i = 0; i < model->numberMotor; i++)
+        totalThrust += model->thrust[i];
+
+    sigma = model->accelNoise + model->vibration * totalThrust / (model->numberMotor * model->motorMaxThrust);
+
+    for (i = 0; i < 3; i++)
+        accel[i] = (float)(model->specificForce[i] + sigma * gaussian(&model->seed));
+}
+
+///////////////////////////////////////
+
+void sitlModelMag(sitlModel_t *model, float mag[3])
+{
+    uint8_t i;
+    double  body[3];
+
+    earthToBody(model->q, model->magField, body);
+
+    for (i = 0; i < 3; i++)
+        mag[i] = (float)(body[i] + model->magNoise * gaussian(&model->seed));
+}
+
+///////////////////////////////////////
+
+float sitlModelPressureAlt(sitlModel_t *model)
+{
+    return (float)(-model->position[2] + model->baroNoise * gaussian(&model->seed));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Model Truth
+///////////////////////////////////////////////////////////////////////////////
+
+void sitlModelAttitude(const sitlModel_t *model, float attitude[3])
+{
+    const double *q = model->q;
+
+    attitude[0] = (float)atan2(2.0 * (q[0] * q[1] + q[2] * q[3]), 1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2]));
+    attitude[1] = (float)asin(2.0 * (q[0] * q[2] - q[1] * q[3]));
+    attitude[2] = (float)atan2(2.0 * (q[0] * q[3] + q[1] * q[2]), 1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3]));
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,118 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Multicopter Model Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define SITL_MAX_MOTORS 8
+
+typedef struct sitlModel_t
+{
+    // Airframe, quad X with the AQ32Plus motor order and rotation
+    double   mass;                          // kg
+    double   armLength;                     // m, motor to center
+    double   inertia[3];                    // kg m^2, principal axes
+    double   drag[3];                       // N / (m/s), body axes, rotor drag in X and Y
+    double   angularDrag;                   // N m / (rad/s)
+
+    // Motors
+    uint8_t  numberMotor;
+    double   motorPosition[SITL_MAX_MOTORS][2];  // Body X, Y
+    double   motorDirection[SITL_MAX_MOTORS];    // +1 CCW from above, -1 CW
+    double   motorMaxThrust;                // N per motor at full command
+    double   motorTorqueRatio;              // Reaction torque / thrust, m
+    double   motorTimeConstant;             // s
+
+    // Sensors
+    double   gyroNoise;                     // rad/s, 1 sigma per sample
+    double   gyroBias[3];                   // rad/s
+    double   accelNoise;                    // m/s^2, 1 sigma per sample
+    double   vibration;                     // m/s^2 at full thrust
+    double   magField[3];                   // Earth field, NED, gauss
+    double   magNoise;                      // gauss
+    double   baroNoise;                     // m
+
+    // State
+    double   position[3];                   // NED, m
+    double   velocity[3];                   // NED, m/s
+    double   q[4];                          // Body to NED
+    double   rate[3];                       // Body, rad/s
+    double   specificForce[3];              // Body, m/s^2
+    double   command[SITL_MAX_MOTORS];      // 0 to 1
+    double   thrust[SITL_MAX_MOTORS];       // N
+    uint8_t  onGround;
+
+    uint32_t seed;
+} sitlModel_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// Model Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void sitlModelInit(sitlModel_t *model, uint32_t seed);
+
+///////////////////////////////////////////////////////////////////////////////
+// Model Step
+///////////////////////////////////////////////////////////////////////////////
+
+void sitlModelStep(sitlModel_t *model, double dt);
+
+///////////////////////////////////////////////////////////////////////////////
+// Model Sensors, firmware units and body axes
+///////////////////////////////////////////////////////////////////////////////
+
+void sitlModelGyro(sitlModel_t *model, float gyro[3]);
+
+void sitlModelAccel(sitlModel_t *model, float accel[3]);
+
+void sitlModelMag(sitlModel_t *model, float mag[3]);
+
+float sitlModelPressureAlt(sitlModel_t *model);
+
+///////////////////////////////////////////////////////////////////////////////
+// Model Truth
+///////////////////////////////////////////////////////////////////////////////
+
+void sitlModelAttitude(const sitlModel_t *model, float attitude[3]);
+
+///////////////////////////////////////////////////////////////////////////////
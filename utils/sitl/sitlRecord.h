@@ -0,0 +1,82 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+#include "mpu6000Burst.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// 500 Hz Input Vector Recording
+///////////////////////////////////////////////////////////////////////////////
+
+// "sitl -r file" writes one header and then one record per 500 Hz task, the
+// inputs the 500 Hz chain reads as it starts and the model truth at that
+// instant.  The layout is the host's native one, recordings are only meant
+// for the bench and replay tools built next to them.
+
+#define SITL_RECORD_MAGIC   0x35485141  // "AQH5"
+#define SITL_RECORD_VERSION 3
+
+typedef struct sitlRecordHeader_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t seed;
+} sitlRecordHeader_t;
+
+typedef struct sitlRecord_t
+{
+    mpu6000Accumulator_t summed500Hz;       // Raw MPU6000 sums
+    float    accelSummedMXR[3];             // Raw MXR9150 sums
+    float    mag[3];                        // sensors.mag10Hz
+    float    rxCommand[8];                 // Roll thru Aux4
+    float    pressureAlt;                   // sensors.pressureAlt50Hz
+    float    truthAttitude[3];              // Roll, pitch, magnetic heading
+    float    truthAltitude;
+    uint8_t  execUp;
+    uint8_t  magDataUpdate;
+    uint8_t  flightMode;
+    uint8_t  headingHoldEngaged;
+    uint8_t  holdIntegrators;
+    uint8_t  armed;
+} sitlRecord_t;
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,525 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Check and cost of the binary telemetry, src/telemFrame.c with the
+// message table in src/telemMessages.h:
+//
+//   - the CRC against the CRC-16/CCITT-FALSE check value
+//   - every message through encode and parse at every sequence number,
+//     payload bytes back unchanged
+//   - every single bit error in a frame rejected, with the next frame
+//     still found
+//   - frames found again after EVR and CLI text, random bytes, false
+//     sync bytes and cut off frames between them
+//   - lost frames counted from the sequence numbers
+//
+// Then the link budget, the bytes each message takes as the old text line
+// and as a frame, and what every stream together needs out of the 11520
+// bytes/s a 115200 baud port moves, and the host time to build the line
+// with snprintf against building the frame.  On the STM32 the gap is wider,
+// its printf formats floats through double precision soft float.
+// Exits non zero on any failure.
+//
+// Usage: telemout
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <time.h>
+
+#include "board.h"
+
+#include "sitlCheck.h"
+#include "telemDecode.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define LINK_BYTES_PER_SECOND  11520.0 // 115200 baud, 10 bits a byte
+#define SPEED_MESSAGES         2000000
+
+static volatile uint32_t sink;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static double now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+///////////////////////////////////////
+
+static void randomBytes(uint8_t *data, uint16_t length)
+{
+    while (length--)
+        *data++ = (uint8_t)(rand() >> 4);
+}
+
+///////////////////////////////////////
+
+// Parses a byte stream, returns the number of frames found and copies
+// out the first max of them in order
+
+typedef struct found_t
+{
+    uint8_t id, sequence, length;
+    uint8_t payload[TELEM_MAX_PAYLOAD];
+} found_t;
+
+static uint32_t parseStream(telemParser_t *parser, const uint8_t *data, uint32_t length, found_t *found, uint32_t max)
+{
+    uint32_t n, count = 0;
+
+    telemParserInit(parser);
+
+    for (n = 0; n < length; n++)
+    {
+        telemParserPut(parser, data[n]);
+
+        while (telemParserGet(parser))
+        {
+            if (count < max)
+            {
+                found[count].id       = parser->id;
+                found[count].sequence = parser->sequence;
+                found[count].length   = parser->length;
+                memcpy(found[count].payload, parser->payload, parser->length);
+            }
+
+            count++;
+        }
+    }
+
+    return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CRC and Round Trips
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkCrc(void)
+{
+    check(telemCrc16(0xFFFF, (const uint8_t *)"123456789", 9) == 0x29B1, "CRC-16/CCITT-FALSE check value 0x29B1");
+
+    check(telemCrc16(telemCrc16(0xFFFF, (const uint8_t *)"1234", 4), (const uint8_t *)"56789", 5) == 0x29B1,
+          "CRC carried across calls");
+}
+
+///////////////////////////////////////
+
+static void checkRoundTrips(void)
+{
+    telemParser_t parser;
+    found_t  found;
+    uint8_t  frame[TELEM_MAX_FRAME], payload[TELEM_MAX_PAYLOAD], index;
+    uint16_t sequence, length, n;
+    int      ok = true, sizes = true;
+    char     what[80];
+
+    for (index = 0; index < telemNumberOfMessages; index++)
+    {
+        const telemMessageInfo_t *info = &telemMessageInfo[index];
+
+        for (sequence = 0; sequence < 256; sequence++)
+        {
+            randomBytes(payload, info->length);
+
+            length = telemFrameEncode(frame, info->id, (uint8_t)sequence, payload, info->length);
+
+            if (length != TELEM_HEADER_SIZE + info->length + TELEM_CRC_SIZE)
+                sizes = false;
+
+            if ((parseStream(&parser, frame, length, &found, 1) != 1) ||
+                (found.id != info->id) || (found.sequence != sequence) || (found.length != info->length) ||
+                (memcmp(found.payload, payload, info->length) != 0))
+                ok = false;
+        }
+    }
+
+    check(sizes, "Frame is the payload plus 7 bytes");
+    check(ok,    "Every message back unchanged at every sequence number");
+
+    // Longest payload, and one over
+
+    randomBytes(payload, TELEM_MAX_PAYLOAD);
+
+    length = telemFrameEncode(frame, 0xFF, 0, payload, TELEM_MAX_PAYLOAD);
+
+    check((length == TELEM_MAX_FRAME) && (parseStream(&parser, frame, length, &found, 1) == 1) &&
+          (memcmp(found.payload, payload, TELEM_MAX_PAYLOAD) == 0), "64 byte payload");
+
+    check(telemFrameEncode(frame, 0xFF, 0, payload, TELEM_MAX_PAYLOAD + 1) == 0, "65 byte payload refused");
+
+    // An empty payload is a frame too
+
+    length = telemFrameEncode(frame, 0x80, 7, payload, 0);
+
+    check((parseStream(&parser, frame, length, &found, 1) == 1) && (found.length == 0), "Empty payload");
+
+    // Table sizes against the structs the firmware fills
+
+    for (index = 0; index < telemNumberOfMessages; index++)
+    {
+        const telemMessageInfo_t *info = &telemMessageInfo[index];
+        uint16_t fieldBytes = 0;
+
+        for (n = 0; n < info->fieldCount; n++)
+            fieldBytes += info->fields[n].count * info->fields[n].size;
+
+        snprintf(what, sizeof(what), "%s fields fill its %d byte payload", info->name, info->length);
+
+        check((fieldBytes == info->length) && (info->length <= TELEM_MAX_PAYLOAD), what);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Bit Errors
+///////////////////////////////////////////////////////////////////////////////
+
+// Each bit of a frame flipped in turn, followed by a good frame and a
+// frame's worth of idle bytes, which a length byte turned longer waits
+// for.  The bad frame must never come out, the good one always must.
+
+static void checkBitErrors(void)
+{
+    telemParser_t parser;
+    found_t  found[4];
+    uint8_t  stream[3 * TELEM_MAX_FRAME], payload[TELEM_MAX_PAYLOAD], index;
+    uint16_t first, second, bit;
+    int      caught = true, recovered = true;
+    char     what[80];
+
+    for (index = 0; index < telemNumberOfMessages; index++)
+    {
+        const telemMessageInfo_t *info = &telemMessageInfo[index];
+
+        randomBytes(payload, info->length);
+
+        memset(stream, 0, sizeof(stream));
+
+        first  = telemFrameEncode(stream,         info->id, 10, payload, info->length);
+        second = telemFrameEncode(&stream[first], info->id, 11, payload, info->length);
+
+        for (bit = 0; bit < first * 8; bit++)
+        {
+            stream[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+
+            if (parseStream(&parser, stream, first + second + TELEM_MAX_FRAME, found, 4) != 1)
+                caught = false;
+            else if ((found[0].sequence != 11) || (memcmp(found[0].payload, payload, info->length) != 0))
+                recovered = false;
+
+            stream[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+        }
+    }
+
+    snprintf(what, sizeof(what), "Every single bit error caught, all %d messages", telemNumberOfMessages);
+    check(caught, what);
+
+    check(recovered, "Frame after the damaged one still found");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Resync
+///////////////////////////////////////////////////////////////////////////////
+
+// A long run of frames with text, noise, stray sync bytes and cut off
+// frames between them, as the port carries when the CLI and EVR listener
+// talk over the streams.  Every whole frame must come out, in order.
+
+#define RESYNC_FRAMES  5000
+
+static void checkResync(void)
+{
+    static uint8_t stream[RESYNC_FRAMES * 2 * (TELEM_MAX_FRAME + 64)];
+    static found_t found[RESYNC_FRAMES];
+    static uint8_t sent[RESYNC_FRAMES][TELEM_MAX_PAYLOAD];
+
+    telemParser_t parser;
+    const char *text[] = { "EVR:0001d4c0 0005 0000\n", "\r\n#", "Entering Receiver CLI....\n\n", "\xA5", "\xA5\x5A", "\xA5\x5A\xFF" };
+    uint32_t length = 0, n, count, ok = true;
+    uint8_t  frame[TELEM_MAX_FRAME];
+    uint16_t size;
+
+    for (n = 0; n < RESYNC_FRAMES; n++)
+    {
+        const telemMessageInfo_t *info = &telemMessageInfo[n % telemNumberOfMessages];
+
+        switch (rand() % 5)
+        {
+            case 0:
+                memcpy(&stream[length], text[n % 6], strlen(text[n % 6]));
+                length += strlen(text[n % 6]);
+                break;
+
+            case 1:
+                size = (uint16_t)(rand() % 64);
+                randomBytes(&stream[length], size);
+                length += size;
+                break;
+
+            case 2:
+                // A frame cut off part way, the next one must survive it
+                randomBytes(frame, info->length);
+                size = telemFrameEncode(frame, info->id, 0xEE, frame, info->length);
+                size = (uint16_t)(1 + rand() % (size - 1));
+                memcpy(&stream[length], frame, size);
+                length += size;
+                break;
+        }
+
+        randomBytes(sent[n], info->length);
+
+        length += telemFrameEncode(&stream[length], info->id, (uint8_t)n, sent[n], info->length);
+    }
+
+    count = parseStream(&parser, stream, length, found, RESYNC_FRAMES);
+
+    for (n = 0; (n < RESYNC_FRAMES) && (n < count); n++)
+        if ((found[n].sequence != (uint8_t)n) || (memcmp(found[n].payload, sent[n], found[n].length) != 0))
+            ok = false;
+
+    printf("  %u frames in %u bytes, %lu CRC errors, %lu bytes skipped\n", RESYNC_FRAMES, length,
+           (unsigned long)parser.crcErrors, (unsigned long)parser.skipped);
+
+    check((count == RESYNC_FRAMES) && ok, "Every frame found through text, noise and cut off frames");
+    check(parser.sequenceGaps == 0, "No frames counted lost");
+}
+
+///////////////////////////////////////
+
+static void checkSequenceGaps(void)
+{
+    static uint8_t stream[1000 * TELEM_MAX_FRAME];
+
+    telemParser_t parser;
+    found_t  found;
+    uint8_t  payload[TELEM_MAX_PAYLOAD] = { 0 };
+    uint32_t length = 0, dropped = 0, n;
+
+    // 1000 frames with every seventh and a run of 300 dropped, the run
+    // wraps the 8 bit sequence
+
+    for (n = 0; n < 1000; n++)
+    {
+        if ((n % 7 == 3) || ((n >= 500) && (n < 800)))
+        {
+            dropped++;
+            continue;
+        }
+
+        length += telemFrameEncode(&stream[length], TELEM_ATTITUDE, (uint8_t)n, payload, sizeof(telemAttitude_t));
+    }
+
+    parseStream(&parser, stream, length, &found, 1);
+
+    // The run of 300 loses 256 to the wrap
+
+    check(parser.sequenceGaps == dropped - 256, "Lost frames counted, modulo 256 in a run");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Link Budget
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct stream_t
+{
+    uint8_t     id;
+    const char *stream;
+    double      rate;                  // Messages per second
+} stream_t;
+
+// Stream 8 sends a message for each of the 8 firmware tasks at 10 Hz
+
+static const stream_t streams[] =
+{
+    { TELEM_ACCELS,       "1", 100.0 },
+    { TELEM_GYROS,        "2", 100.0 },
+    { TELEM_EARTH_ACCELS, "3", 100.0 },
+    { TELEM_ATTITUDE,     "4", 100.0 },
+    { TELEM_VERTICAL,     "5", 100.0 },
+    { TELEM_SENSORS,      "6",  10.0 },
+    { TELEM_ADC_TEST,     "7", 100.0 },
+    { TELEM_TASK_STATS,   "8",  80.0 },
+};
+
+///////////////////////////////////////
+
+// Representative values, the text widths barely move with them
+
+static void samplePayload(uint8_t id, uint8_t *payload)
+{
+    telemAccels_t      accels      = { {  0.1234f, -0.0567f, -9.8066f }, { 0.1301f, -0.0612f, -9.7990f } };
+    telemGyros_t       gyros       = { {  0.0123f, -0.0045f,  0.0007f } };
+    telemEarthAccels_t earthAccels = { { -0.0213f,  0.0311f, -0.0452f } };
+    telemAttitude_t    attitude    = { {  0.0314f, -0.0271f,  1.5708f } };
+    telemVertical_t    vertical    = { -0.0452f, 12.3456f, 0.1234f, 12.2101f, 2534 };
+    telemSensors_t     sensorData  = { { 0.1234f, -0.0567f, -9.8066f }, { 0.0123f, -0.0045f, 0.0007f }, { 0.2110f, -0.0310f, 0.4120f } };
+    telemAdcTest_t     adcTest     = { { 2048, 2051, 1320 }, 2874 };
+    telemTaskStats_t   taskStats   = { "500Hz", 300000, 12, 0, 212, 389, 23 };
+
+    switch (id)
+    {
+        case TELEM_ACCELS:       memcpy(payload, &accels,      sizeof(accels));      break;
+        case TELEM_GYROS:        memcpy(payload, &gyros,       sizeof(gyros));       break;
+        case TELEM_EARTH_ACCELS: memcpy(payload, &earthAccels, sizeof(earthAccels)); break;
+        case TELEM_ATTITUDE:     memcpy(payload, &attitude,    sizeof(attitude));    break;
+        case TELEM_VERTICAL:     memcpy(payload, &vertical,    sizeof(vertical));    break;
+        case TELEM_SENSORS:      memcpy(payload, &sensorData,  sizeof(sensorData));  break;
+        case TELEM_ADC_TEST:     memcpy(payload, &adcTest,     sizeof(adcTest));     break;
+        case TELEM_TASK_STATS:   memcpy(payload, &taskStats,   sizeof(taskStats));   break;
+    }
+}
+
+///////////////////////////////////////
+
+// The text line is what telemcsv prints for the frame, which is byte for
+// byte what the text streams printed
+
+static void linkBudget(void)
+{
+    uint8_t  payload[TELEM_MAX_PAYLOAD];
+    char     line[512];
+    uint16_t n;
+    size_t   textBytes;
+    double   textTotal = 0.0, binaryTotal = 0.0;
+    int      smaller = true;
+    FILE     *file;
+
+    printf("\nstream  message        text  frame   text B/s  frame B/s   link as text  as frames\n");
+
+    for (n = 0; n < sizeof(streams) / sizeof(streams[0]); n++)
+    {
+        const telemMessageInfo_t *info = telemMessageFind(streams[n].id);
+        uint16_t frameBytes = TELEM_HEADER_SIZE + info->length + TELEM_CRC_SIZE;
+
+        samplePayload(info->id, payload);
+
+        file = fmemopen(line, sizeof(line), "w");
+        telemMessagePrint(file, info, payload, info->length);
+        textBytes = (size_t)ftell(file);
+        fclose(file);
+
+        printf("  %s     %-13s %5zu  %5d   %8.0f   %8.0f         %5.1f%%     %5.1f%%\n", streams[n].stream, info->name,
+               textBytes, frameBytes, textBytes * streams[n].rate, frameBytes * streams[n].rate,
+               100.0 * textBytes * streams[n].rate / LINK_BYTES_PER_SECOND, 100.0 * frameBytes * streams[n].rate / LINK_BYTES_PER_SECOND);
+
+        // The task statistics are mostly short integers, their text is
+        // about as small as the frame
+
+        if ((info->id != TELEM_TASK_STATS) && (frameBytes >= textBytes * 0.6))
+            smaller = false;
+
+        textTotal   += textBytes  * streams[n].rate;
+        binaryTotal += frameBytes * streams[n].rate;
+    }
+
+    printf("  all                                 %8.0f   %8.0f         %5.1f%%     %5.1f%%\n", textTotal, binaryTotal,
+           100.0 * textTotal / LINK_BYTES_PER_SECOND, 100.0 * binaryTotal / LINK_BYTES_PER_SECOND);
+
+    check(smaller, "Sensor and estimate frames under 60% of their text bytes");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Build Cost
+///////////////////////////////////////////////////////////////////////////////
+
+// The accels line, stream 1, both ways, as the text stream built it and as
+// sendAccels() in highSpeedTelem.c does now
+
+static void buildCost(void)
+{
+    telemAccels_t accels;
+    uint8_t  frame[TELEM_MAX_FRAME];
+    uint32_t n, total = 0;
+    double   begin, text, binary;
+    char     line[256];
+
+    samplePayload(TELEM_ACCELS, (uint8_t *)&accels);
+
+    begin = now();
+
+    for (n = 0; n < SPEED_MESSAGES; n++)
+    {
+        accels.accel[XAXIS] += 1.0e-6f;
+
+        total += (uint32_t)snprintf(line, sizeof(line), "%9.4f, %9.4f, %9.4f, %9.4f, %9.4f, %9.4f\n",
+                                    accels.accel[XAXIS],    accels.accel[YAXIS],    accels.accel[ZAXIS],
+                                    accels.accelMXR[XAXIS], accels.accelMXR[YAXIS], accels.accelMXR[ZAXIS]);
+    }
+
+    text  = (now() - begin) / SPEED_MESSAGES;
+    begin = now();
+
+    for (n = 0; n < SPEED_MESSAGES; n++)
+    {
+        accels.accel[XAXIS] += 1.0e-6f;
+
+        total += telemFrameEncode(frame, TELEM_ACCELS, (uint8_t)n, &accels, sizeof(accels));
+    }
+
+    binary = (now() - begin) / SPEED_MESSAGES;
+    sink   = total + frame[TELEM_HEADER_SIZE];
+
+    printf("\nACCELS line  %6.1f ns with snprintf, %6.1f ns as a frame, %4.1f times faster (host)\n",
+           text, binary, text / binary);
+
+    check(binary < text, "Frame builds faster than the text line");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+    srand(1);
+
+    checkCrc();
+    checkRoundTrips();
+    checkBitErrors();
+    checkResync();
+    checkSequenceGaps();
+
+    linkBudget();
+    buildCost();
+
+    printf("\n%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,494 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+///////////////////////////////////////////////////////////////////////////////
+
+// src/telemScheduler.c at the 500 Hz telemetry task rate, against a model
+// of the USART1 transmit ring draining at 115200 baud.  Checks:
+//
+//   fit      streams that fit the budget all get their exact rate
+//   share    the EEPROM default rates with every stream on, well over the
+//            budget, are cut to a max-min fair share that uses the budget
+//            and never goes over it
+//   jitter   a send every floor or ceil of tick rate / rate ticks
+//   clamp    rates above the tick rate send every tick
+//   bursts   CLI text dropped into the ring on top of the streams, the
+//            ring never overflows, the sends are deferred instead
+//   budget   a lower budget takes effect on the next tick
+//
+// then the time one tick takes.  Exits non zero on any failure.
+//
+// Usage: telemsched
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <time.h>
+
+#include "board.h"
+
+#include "sitlCheck.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define TICK_RATE       HIGH_SPEED_TELEM_TICK_RATE
+#define TX_BUFFER_SIZE  2048            // UART1_BUFFER_SIZE in drv_telemetry.c
+#define TX_BYTE_RATE    11520           // 115200 baud, 10 bits a byte
+#define FLIGHT_TASKS    9               // Task statistics frames a send, src/tasks.c's task table
+
+#define SPEED_TICKS     10000000
+
+static volatile uint32_t sink;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define STREAM_BYTES(id, NAME, Name)  [id - 1] = TELEM_HEADER_SIZE + sizeof(telem##Name##_t) + TELEM_CRC_SIZE,
+
+#define STREAM_NAME(id, NAME, Name)   [id - 1] = #NAME,
+
+static const uint16_t frameBytes[NUMBER_OF_TELEM_MESSAGES] = { TELEM_MESSAGES(STREAM_BYTES) };
+
+static const char * const streamNames[NUMBER_OF_TELEM_MESSAGES] = { TELEM_MESSAGES(STREAM_NAME) };
+
+static uint16_t streamBytes(uint8_t stream)
+{
+    return (uint16_t)(frameBytes[stream] * ((stream == TELEM_TASK_STATS - 1) ? FLIGHT_TASKS : 1));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Transmit ring fill, drained a tick at a time, the bytes only
+
+typedef struct txModel_t
+{
+    uint32_t used;
+    uint32_t drainRemainder;
+    uint32_t peak;
+    uint32_t overflows;                 // Stream frames that did not fit
+    uint32_t textDropped;               // Text bytes that did not fit
+} txModel_t;
+
+typedef struct run_t
+{
+    uint32_t sent[TELEM_MAX_STREAMS];
+    uint32_t bytes;                     // Stream bytes written
+    uint32_t lastTick[TELEM_MAX_STREAMS];
+    uint32_t minInterval[TELEM_MAX_STREAMS];
+    uint32_t maxInterval[TELEM_MAX_STREAMS];
+} run_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static double now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+///////////////////////////////////////
+
+static void txWrite(txModel_t *ring, uint32_t bytes, uint8_t text)
+{
+    ring->used += bytes;
+
+    if (ring->used > TX_BUFFER_SIZE - 1)
+    {
+        if (text)
+            ring->textDropped += ring->used - (TX_BUFFER_SIZE - 1);
+        else
+            ring->overflows++;
+
+        ring->used = TX_BUFFER_SIZE - 1;
+    }
+
+    if (ring->used > ring->peak)
+        ring->peak = ring->used;
+}
+
+///////////////////////////////////////
+
+static void txDrain(txModel_t *ring)
+{
+    uint32_t drained;
+
+    ring->drainRemainder += TX_BYTE_RATE;
+    drained               = ring->drainRemainder / TICK_RATE;
+    ring->drainRemainder %= TICK_RATE;
+
+    ring->used = (ring->used > drained) ? ring->used - drained : 0;
+}
+
+///////////////////////////////////////
+
+// Runs ticks through the scheduler and the ring, text bytes dropped into
+// the ring every textEvery ticks when textEvery is not 0
+
+static void run(telemScheduler_t *scheduler, txModel_t *ring, run_t *result, uint32_t ticks,
+                uint32_t textEvery, uint32_t textBytes)
+{
+    uint32_t tick, due, interval;
+    uint8_t  n;
+
+    memset(result, 0, sizeof(run_t));
+
+    for (n = 0; n < TELEM_MAX_STREAMS; n++)
+        result->minInterval[n] = UINT32_MAX;
+
+    for (tick = 1; tick <= ticks; tick++)
+    {
+        txDrain(ring);
+
+        if ((textEvery != 0) && ((tick % textEvery) == 0))
+            txWrite(ring, textBytes, true);
+
+        due = telemSchedulerTick(scheduler, TX_BUFFER_SIZE - 1 - ring->used);
+
+        for (n = 0; n < scheduler->streams; n++)
+        {
+            if ((due & (1UL << n)) == 0)
+                continue;
+
+            txWrite(ring, scheduler->stream[n].bytes, false);
+
+            result->bytes += scheduler->stream[n].bytes;
+            result->sent[n]++;
+
+            if (result->lastTick[n] != 0)
+            {
+                interval = tick - result->lastTick[n];
+
+                if (interval < result->minInterval[n]) result->minInterval[n] = interval;
+                if (interval > result->maxInterval[n]) result->maxInterval[n] = interval;
+            }
+
+            result->lastTick[n] = tick;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Streams That Fit
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkFit(void)
+{
+    static const uint16_t rates[] = { 10, 50, 100, 333 };
+    static const uint16_t bytes[] = { 39, 31, 19, 15 };
+
+    telemScheduler_t scheduler;
+    txModel_t         ring = { 0 };
+    run_t            result;
+    char             what[80];
+    uint8_t          n;
+    int              exact = true;
+
+    telemSchedulerInit(&scheduler, TICK_RATE, 10000, 4);
+
+    for (n = 0; n < 4; n++)
+        telemSchedulerSetStream(&scheduler, n, rates[n], bytes[n]);
+
+    run(&scheduler, &ring, &result, 10 * TICK_RATE, 0, 0);
+
+    printf("Fit, %ld of %ld bytes/s planned\n", (long)scheduler.planned, (long)scheduler.budget);
+
+    for (n = 0; n < 4; n++)
+    {
+        printf("    %3d Hz x %2d bytes  sent %5ld in 10 s  deferred %ld\n", rates[n], bytes[n],
+               (long)result.sent[n], (long)scheduler.stream[n].deferred);
+
+        if (labs((long)result.sent[n] - 10L * rates[n]) > 1)
+            exact = false;
+    }
+
+    check(exact, "Streams inside the budget send at their rate, within one in 10 s");
+
+    snprintf(what, sizeof(what), "No transmit ring overflow, peak %ld bytes", (long)ring.peak);
+    check(ring.overflows == 0, what);
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Every Stream On at the Default Rates
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkShare(void)
+{
+    telemScheduler_t scheduler;
+    txModel_t         ring = { 0 };
+    run_t            result;
+    uint32_t         demand, granted, maxCut = 0, minCut = UINT32_MAX;
+    char             what[80];
+    uint8_t          n;
+    int              fair = true, measured = true;
+
+    setEEPROMDefaults();
+
+    telemSchedulerInit(&scheduler, TICK_RATE, eepromConfig.telemBudget, NUMBER_OF_TELEM_MESSAGES);
+
+    demand = 0;
+
+    for (n = 0; n < NUMBER_OF_TELEM_MESSAGES; n++)
+    {
+        telemSchedulerSetStream(&scheduler, n, eepromConfig.telemRate[n], streamBytes(n));
+        demand += (uint32_t)eepromConfig.telemRate[n] * streamBytes(n);
+    }
+
+    run(&scheduler, &ring, &result, 10 * TICK_RATE, 0, 0);
+
+    printf("Every stream on, %ld bytes/s asked for, %ld budget, %ld planned, %ld sent\n",
+           (long)demand, (long)scheduler.budget, (long)scheduler.planned, (long)(result.bytes / 10));
+
+    printf("    Stream          Rate  Granted  Bytes  Bytes/s     Sent\n");
+
+    for (n = 0; n < NUMBER_OF_TELEM_MESSAGES; n++)
+    {
+        granted = scheduler.stream[n].granted * scheduler.stream[n].bytes / 1000;
+
+        printf("    %-14s %5d  %7.2f  %5d  %7ld  %7ld\n", streamNames[n], eepromConfig.telemRate[n],
+               scheduler.stream[n].granted / 1000.0, scheduler.stream[n].bytes, (long)granted, (long)result.sent[n]);
+
+        // Cut streams share the same bytes/s, every stream that kept its
+        // rate uses no more than that
+
+        if (scheduler.stream[n].granted < (uint32_t)scheduler.stream[n].rate * 1000)
+        {
+            if (granted < minCut) minCut = granted;
+            if (granted > maxCut) maxCut = granted;
+        }
+
+        if (labs((long)result.sent[n] - (long)(scheduler.stream[n].granted / 100)) > 2)
+            measured = false;
+    }
+
+    for (n = 0; n < NUMBER_OF_TELEM_MESSAGES; n++)
+        if ((scheduler.stream[n].granted == (uint32_t)scheduler.stream[n].rate * 1000) &&
+            ((uint32_t)scheduler.stream[n].rate * scheduler.stream[n].bytes > minCut + scheduler.stream[n].bytes))
+            fair = false;
+
+    check(demand > scheduler.budget, "Default rates with every stream on ask for more than the budget");
+
+    check(scheduler.planned <= scheduler.budget, "Planned bytes/s inside the budget");
+
+    check(scheduler.planned >= scheduler.budget * 95 / 100, "Planned bytes/s use at least 95% of the budget");
+
+    check(result.bytes / 10 <= scheduler.budget, "Bytes sent a second inside the budget");
+
+    check((minCut != UINT32_MAX) && (maxCut - minCut <= 64) && fair, "Max-min fair, cut streams share equally, none under a kept one");
+
+    check(measured, "Streams send at their granted rate, within two in 10 s");
+
+    snprintf(what, sizeof(what), "No transmit ring overflow, peak %ld bytes", (long)ring.peak);
+    check(ring.overflows == 0, what);
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Jitter and Clamping
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkJitter(void)
+{
+    static const uint16_t rates[] = { 1, 7, 30, 45, 120, 499 };
+
+    telemScheduler_t scheduler;
+    txModel_t         ring = { 0 };
+    run_t            result;
+    uint32_t         low, high;
+    uint8_t          n;
+    int              ok = true;
+
+    printf("Jitter, ticks between sends\n");
+
+    for (n = 0; n < sizeof(rates) / sizeof(rates[0]); n++)
+    {
+        telemSchedulerInit(&scheduler, TICK_RATE, 100000, 1);
+        telemSchedulerSetStream(&scheduler, 0, rates[n], 4);
+
+        run(&scheduler, &ring, &result, 10 * TICK_RATE, 0, 0);
+
+        low  = TICK_RATE / rates[n];
+        high = (TICK_RATE + rates[n] - 1) / rates[n];
+
+        printf("    %3d Hz  %3ld to %3ld, ideal %6.2f\n", rates[n], (long)result.minInterval[0],
+               (long)result.maxInterval[0], (double)TICK_RATE / rates[n]);
+
+        if ((result.minInterval[0] < low) || (result.maxInterval[0] > high))
+            ok = false;
+    }
+
+    check(ok, "Every send floor or ceil of tick rate / rate ticks after the last");
+
+    telemSchedulerInit(&scheduler, TICK_RATE, 100000, 1);
+    telemSchedulerSetStream(&scheduler, 0, 2000, 4);
+
+    run(&scheduler, &ring, &result, TICK_RATE, 0, 0);
+
+    check((scheduler.stream[0].rate == TICK_RATE) && (result.sent[0] == TICK_RATE),
+          "Rate above the tick rate sends every tick");
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Text Bursts in the Ring
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkBursts(void)
+{
+    telemScheduler_t scheduler;
+    txModel_t         ring = { 0 };
+    run_t            result;
+    uint32_t         deferred = 0;
+    char             what[80];
+    uint8_t          n;
+
+    setEEPROMDefaults();
+
+    telemSchedulerInit(&scheduler, TICK_RATE, eepromConfig.telemBudget, NUMBER_OF_TELEM_MESSAGES);
+
+    for (n = 0; n < NUMBER_OF_TELEM_MESSAGES; n++)
+        telemSchedulerSetStream(&scheduler, n, eepromConfig.telemRate[n], streamBytes(n));
+
+    // A 1500 byte CLI reply every half second, with the streams that is
+    // more than the link carries, so the ring fills
+
+    run(&scheduler, &ring, &result, 10 * TICK_RATE, TICK_RATE / 2, 1500);
+
+    for (n = 0; n < NUMBER_OF_TELEM_MESSAGES; n++)
+        deferred += scheduler.stream[n].deferred;
+
+    printf("Every stream on with 1500 bytes of text every 0.5 s, %ld stream bytes/s, peak %ld bytes, %ld deferred\n",
+           (long)(result.bytes / 10), (long)ring.peak, (long)deferred);
+
+    snprintf(what, sizeof(what), "Stream frames never overflow the ring, %ld text bytes dropped", (long)ring.textDropped);
+    check(ring.overflows == 0, what);
+
+    check(deferred > 0, "Sends held back while the text drains");
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Budget Change
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkBudget(void)
+{
+    telemScheduler_t scheduler;
+    txModel_t         ring = { 0 };
+    run_t            result;
+    uint8_t          n;
+
+    setEEPROMDefaults();
+
+    telemSchedulerInit(&scheduler, TICK_RATE, eepromConfig.telemBudget, NUMBER_OF_TELEM_MESSAGES);
+
+    for (n = 0; n < NUMBER_OF_TELEM_MESSAGES; n++)
+        telemSchedulerSetStream(&scheduler, n, eepromConfig.telemRate[n], streamBytes(n));
+
+    run(&scheduler, &ring, &result, 5 * TICK_RATE, 0, 0);
+
+    telemSchedulerSetBudget(&scheduler, 3000);
+
+    run(&scheduler, &ring, &result, 5 * TICK_RATE, 0, 0);
+
+    printf("Budget lowered to 3000 bytes/s, %ld planned, %ld sent over the next 5 s\n",
+           (long)scheduler.planned, (long)(result.bytes / 5));
+
+    // What was saved up at the old budget may still go out
+
+    check((scheduler.planned <= 3000) && (result.bytes <= 5 * 3000 + eepromConfig.telemBudget / TELEM_BURST_DIVISOR),
+          "Lower budget replans the rates and holds from the next tick");
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Throughput
+///////////////////////////////////////////////////////////////////////////////
+
+static void speed(void)
+{
+    telemScheduler_t scheduler;
+    uint32_t         n, due = 0;
+    double           begin, elapsed;
+
+    setEEPROMDefaults();
+
+    telemSchedulerInit(&scheduler, TICK_RATE, eepromConfig.telemBudget, NUMBER_OF_TELEM_MESSAGES);
+
+    for (n = 0; n < NUMBER_OF_TELEM_MESSAGES; n++)
+        telemSchedulerSetStream(&scheduler, (uint8_t)n, eepromConfig.telemRate[n], streamBytes((uint8_t)n));
+
+    begin = now();
+
+    for (n = 0; n < SPEED_TICKS; n++)
+        due ^= telemSchedulerTick(&scheduler, TX_BUFFER_SIZE - 1);
+
+    elapsed = now() - begin;
+    sink    = due;
+
+    printf("%6.1f ns per tick, %d streams\n", elapsed / SPEED_TICKS, NUMBER_OF_TELEM_MESSAGES);
+
+    begin = now();
+
+    for (n = 0; n < SPEED_TICKS / 100; n++)
+        telemSchedulerPlan(&scheduler);
+
+    elapsed = now() - begin;
+
+    printf("%6.1f ns per plan\n", elapsed / (SPEED_TICKS / 100));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+    checkFit();
+    checkShare();
+    checkJitter();
+    checkBursts();
+    checkBudget();
+
+    speed();
+
+    printf("\n%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,664 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+///////////////////////////////////////////////////////////////////////////////
+
+// src/txRing.c against a model of the UART transmit DMA, which reads each
+// byte out of the ring as it goes on the wire, so a byte written over
+// before it was sent shows up in the output.  Checks:
+//
+//   random     writes, in place reservations committed in part and two
+//              span reservations of random sizes, the DMA moving on at
+//              random and completing between reserve and commit, every
+//              accepted byte comes out once in order and every refused
+//              byte is counted
+//   full       a full ring refuses the next write whole and takes it
+//              once the transfer under way completes
+//   wrap       an in place reservation too long for the end of the
+//              buffer starts at its beginning, the end is not sent
+//   overload   telemetry frames at twice the link rate through this ring
+//              and the old byte at a time ring, parsed back
+//
+// then bytes per second through the old ring, txRingWrite() and in place
+// reservations, by write size.  Exits non zero on any failure.
+//
+// Usage: txring
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <time.h>
+
+#include "board.h"
+
+#include "sitlCheck.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define RING_SIZE       2048            // UART1_BUFFER_SIZE and UART2_BUFFER_SIZE
+#define RANDOM_STEPS    2000000
+#define OVERLOAD_FRAMES 200000
+#define SPEED_BYTES     100000000
+
+static volatile uint32_t sink;
+
+static uint32_t randomState = 1;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// The transmit DMA, a byte read from the ring each time it goes out
+
+typedef struct dma_t
+{
+    txRing_t      *ring;
+    const uint8_t *data;
+    uint16_t      length;
+    uint16_t      done;
+    uint32_t      starts;
+    uint8_t       paused;               // Commit does not start a transfer
+} dma_t;
+
+static dma_t dma;
+
+// Bytes out, checked against what was accepted
+
+typedef struct output_t
+{
+    uint64_t count;
+    uint64_t errors;
+} output_t;
+
+static output_t output;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static double now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+///////////////////////////////////////
+
+static uint32_t random32(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+
+///////////////////////////////////////
+
+// Byte n of everything accepted, the output is checked against it
+
+static uint8_t pattern(uint64_t n)
+{
+    return (uint8_t)(n * 131 + (n >> 8) + 7);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DMA Model
+///////////////////////////////////////////////////////////////////////////////
+
+// txRing_t start, what uart1TxDMA() does
+
+static void dmaStart(txRing_t *ring)
+{
+    if (dma.paused || (dma.length != 0))
+        return;
+
+    dma.length = txRingSendStart(ring, &dma.data);
+    dma.done   = 0;
+
+    if (dma.length != 0)
+        dma.starts++;
+}
+
+///////////////////////////////////////
+
+static void dmaInit(txRing_t *ring, uint8_t *buffer)
+{
+    memset(&dma,    0, sizeof(dma));
+    memset(&output, 0, sizeof(output));
+
+    dma.ring = ring;
+
+    txRingInit(ring, buffer, RING_SIZE, dmaStart);
+}
+
+///////////////////////////////////////
+
+// Sends bytes, the transfer complete interrupt starting the next block
+
+static void dmaRun(uint32_t bytes)
+{
+    while (bytes > 0)
+    {
+        if (dma.length == 0)
+        {
+            dmaStart(dma.ring);
+
+            if (dma.length == 0)
+                return;
+        }
+
+        if (dma.data[dma.done] != pattern(output.count))
+            output.errors++;
+
+        output.count++;
+        dma.done++;
+        bytes--;
+
+        if (dma.done == dma.length)
+        {
+            dma.length = 0;
+
+            txRingSendDone(dma.ring);
+            dmaStart(dma.ring);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Random Producer and DMA
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkRandom(void)
+{
+    static uint8_t buffer[RING_SIZE], data[RING_SIZE];
+
+    txRing_t      ring;
+    txRingSpans_t spans;
+    uint64_t      accepted = 0, refused = 0, refusals = 0;
+    uint32_t      step, n, length, commit;
+    uint8_t       *room;
+    int           accounting = true;
+
+    dmaInit(&ring, buffer);
+
+    for (step = 0; step < RANDOM_STEPS; step++)
+    {
+        length = 1 + random32() % ((random32() & 7) ? 80 : RING_SIZE);
+
+        switch (random32() % 3)
+        {
+            case 0:
+                for (n = 0; n < length; n++)
+                    data[n] = pattern(accepted + n);
+
+                if (txRingWrite(&ring, data, (uint16_t)length) == length)
+                    accepted += length;
+                else
+                {
+                    refused += length;
+                    refusals++;
+                }
+                break;
+
+            case 1:
+                room = txRingReserve(&ring, (uint16_t)length);
+
+                if (room == NULL)
+                {
+                    refused += length;
+                    refusals++;
+                    break;
+                }
+
+                commit = 1 + random32() % length;
+
+                for (n = 0; n < commit; n++)
+                    room[n] = pattern(accepted + n);
+
+                dmaRun(random32() % 64);   // Interrupts between reserve and commit
+
+                txRingCommit(&ring, (uint16_t)commit);
+                accepted += commit;
+                break;
+
+            case 2:
+                if (txRingReserveSpans(&ring, (uint16_t)length, &spans) == 0)
+                {
+                    refused += length;
+                    refusals++;
+                    break;
+                }
+
+                for (n = 0; n < spans.length[0]; n++)
+                    spans.data[0][n] = pattern(accepted + n);
+
+                for (n = 0; n < spans.length[1]; n++)
+                    spans.data[1][n] = pattern(accepted + spans.length[0] + n);
+
+                dmaRun(random32() % 64);
+
+                txRingCommit(&ring, (uint16_t)length);
+                accepted += length;
+                break;
+        }
+
+        if ((txRingPending(&ring) > RING_SIZE - 1) || (txRingFree(&ring) + txRingPending(&ring) > RING_SIZE - 1) ||
+            (txRingFreeContiguous(&ring) > txRingFree(&ring)))
+            accounting = false;
+
+        dmaRun(random32() % 160);
+    }
+
+    dmaRun(UINT32_MAX);
+
+    printf("Random, %ld bytes accepted, %ld refused in %ld writes, %ld transfers, peak %d bytes\n",
+           (long)accepted, (long)refused, (long)refusals, (long)dma.starts, ring.peak);
+
+    check((output.count == accepted) && (output.errors == 0), "Every accepted byte sent once, in order, none written over");
+
+    check((ring.written == accepted) && (ring.dropped == refused) && (ring.overflows == refusals),
+          "Written, dropped and overflow counters match");
+
+    check(accounting, "Free and pending never overlap, contiguous room within free");
+
+    check((txRingPending(&ring) == 0) && (txRingFree(&ring) == RING_SIZE - 1), "Ring empty at the end");
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Full Ring
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkFull(void)
+{
+    static uint8_t buffer[RING_SIZE], data[RING_SIZE];
+
+    txRing_t ring;
+    uint32_t n;
+
+    dmaInit(&ring, buffer);
+
+    for (n = 0; n < RING_SIZE; n++)
+        data[n] = pattern(n);
+
+    // 100 bytes go out as one transfer, then the ring is filled behind it
+
+    txRingWrite(&ring, data, 100);
+    dmaRun(50);
+
+    dma.paused = true;
+
+    txRingWrite(&ring, &data[100], RING_SIZE - 1 - 100);
+
+    check((txRingFree(&ring) == 0) && (txRingWrite(&ring, &data[RING_SIZE - 1], 1) == 0) &&
+          (ring.dropped == 1) && (ring.overflows == 1), "Full ring refuses the next byte and counts it");
+
+    check(txRingWrite(&ring, &data[RING_SIZE - 1], 1) == 0, "Half sent transfer still holds its room");
+
+    dma.paused = false;
+
+    dmaRun(50);
+
+    check((txRingFree(&ring) == 100) && (txRingWrite(&ring, &data[RING_SIZE - 1], 1) == 1),
+          "Room comes back when the transfer completes");
+
+    dmaRun(UINT32_MAX);
+
+    check((output.count == RING_SIZE) && (output.errors == 0), "What was taken all goes out intact");
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Early Wrap
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkWrap(void)
+{
+    static uint8_t buffer[RING_SIZE], data[RING_SIZE + 30];
+
+    txRing_t ring;
+    uint8_t  *room;
+    uint32_t n;
+
+    dmaInit(&ring, buffer);
+
+    for (n = 0; n < RING_SIZE + 30; n++)
+        data[n] = pattern(n);
+
+    // Empty with head and tail 10 bytes from the end
+
+    txRingWrite(&ring, data, RING_SIZE - 10);
+    dmaRun(UINT32_MAX);
+
+    memset(&buffer[RING_SIZE - 10], 0xEE, 10);
+
+    room = txRingReserve(&ring, 40);
+
+    check((room == buffer) && (txRingFreeContiguous(&ring) == RING_SIZE - 11),
+          "40 bytes with 10 left at the end start at the buffer start");
+
+    memcpy(room, &data[RING_SIZE - 10], 40);
+    txRingCommit(&ring, 40);
+
+    check(txRingPending(&ring) == 40, "The 10 bytes skipped at the end are not pending");
+
+    dmaRun(UINT32_MAX);
+
+    check((output.count == RING_SIZE + 30) && (output.errors == 0), "Sent from the start, the skipped end left out");
+
+    room = txRingReserve(&ring, RING_SIZE);
+
+    check((room == NULL) && (ring.overflows == 1), "Longer than the ring refused");
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Overload, Against the Old Ring
+///////////////////////////////////////////////////////////////////////////////
+
+// The ring drv_telemetry.c had, a byte at a time with no room check, the
+// tail moved past a block as its transfer starts
+
+typedef struct oldRing_t
+{
+    uint8_t       buffer[RING_SIZE];
+    uint16_t      head;
+    uint16_t      tail;
+    uint8_t       active;
+    const uint8_t *data;
+    uint16_t      length;
+    uint16_t      done;
+} oldRing_t;
+
+static void oldStart(oldRing_t *old)
+{
+    if (old->active || (old->head == old->tail))
+        return;
+
+    old->data = &old->buffer[old->tail];
+    old->done = 0;
+
+    if (old->head > old->tail)
+    {
+        old->length = old->head - old->tail;
+        old->tail   = old->head;
+    }
+    else
+    {
+        old->length = RING_SIZE - old->tail;
+        old->tail   = 0;
+    }
+
+    old->active = true;
+}
+
+///////////////////////////////////////
+
+static void oldWrite(oldRing_t *old, const uint8_t *data, uint16_t length)
+{
+    while (length--)
+    {
+        old->buffer[old->head] = *data++;
+        old->head = (old->head + 1) % RING_SIZE;
+    }
+
+    oldStart(old);
+}
+
+///////////////////////////////////////
+
+static void oldRun(oldRing_t *old, telemParser_t *parser, uint32_t bytes)
+{
+    while (bytes > 0)
+    {
+        if (old->active == false)
+        {
+            oldStart(old);
+
+            if (old->active == false)
+                return;
+        }
+
+        telemParserPut(parser, old->data[old->done++]);
+        while (telemParserGet(parser));
+
+        bytes--;
+
+        if (old->done == old->length)
+        {
+            old->active = false;
+            oldStart(old);
+        }
+    }
+}
+
+///////////////////////////////////////
+
+static void newRun(telemParser_t *parser, uint32_t bytes)
+{
+    while (bytes > 0)
+    {
+        if (dma.length == 0)
+        {
+            dmaStart(dma.ring);
+
+            if (dma.length == 0)
+                return;
+        }
+
+        telemParserPut(parser, dma.data[dma.done++]);
+        while (telemParserGet(parser));
+
+        bytes--;
+
+        if (dma.done == dma.length)
+        {
+            dma.length = 0;
+
+            txRingSendDone(dma.ring);
+            dmaStart(dma.ring);
+        }
+    }
+}
+
+///////////////////////////////////////
+
+static void checkOverload(void)
+{
+    static uint8_t   buffer[RING_SIZE];
+    static oldRing_t old;
+
+    txRing_t      ring;
+    telemParser_t oldParser, newParser;
+    telemAccels_t accels;
+    uint8_t       frame[TELEM_MAX_FRAME];
+    uint16_t      length = 0;
+    uint32_t      n, sent = 0, refused = 0;
+    char          what[100];
+
+    dmaInit(&ring, buffer);
+    memset(&old, 0, sizeof(old));
+
+    telemParserInit(&oldParser);
+    telemParserInit(&newParser);
+
+    memset(&accels, 0, sizeof(accels));
+
+    // 31 byte accels frames at 100 Hz, plus a 31 byte frame every tick of
+    // 1 ms, twice what 115200 baud carries, 11.52 bytes a ms
+
+    for (n = 0; n < OVERLOAD_FRAMES; n++)
+    {
+        accels.accel[0] = (float)n;
+        length = telemFrameEncode(frame, TELEM_ACCELS, (uint8_t)n, &accels, sizeof(accels));
+
+        oldWrite(&old, frame, length);
+
+        if (txRingWrite(&ring, frame, length) == length)
+            sent++;
+        else
+            refused++;
+
+        oldRun(&old, &oldParser, (n & 1) ? 12 : 11);
+        newRun(&newParser, (n & 1) ? 12 : 11);
+    }
+
+    oldRun(&old, &oldParser, UINT32_MAX);
+    newRun(&newParser, UINT32_MAX);
+
+    printf("Overload, %d frames of %d bytes offered at twice the link rate\n", OVERLOAD_FRAMES, length);
+    printf("    old ring  %6ld good  %6ld CRC errors  %8ld bytes skipped\n",
+           (long)oldParser.frames, (long)oldParser.crcErrors, (long)oldParser.skipped);
+    printf("    txRing    %6ld good  %6ld CRC errors  %8ld bytes skipped  %6ld refused, %ld bytes\n",
+           (long)newParser.frames, (long)newParser.crcErrors, (long)newParser.skipped, (long)refused, (long)ring.dropped);
+
+    snprintf(what, sizeof(what), "Old ring writes over frames not yet sent, %ld corrupt", (long)(oldParser.crcErrors + oldParser.skipped / length));
+    check((oldParser.crcErrors > 0) || (oldParser.skipped > 0), what);
+
+    check((newParser.frames == sent) && (newParser.crcErrors == 0) && (newParser.skipped == 0),
+          "txRing sends every frame it takes intact");
+
+    check((refused > 0) && (ring.overflows == refused) && (ring.dropped == refused * length),
+          "Frames that do not fit refused whole and counted");
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Throughput
+///////////////////////////////////////////////////////////////////////////////
+
+// Empties the ring as a completed transfer would, so the producer cost is
+// what is measured
+
+static void drainRing(txRing_t *ring)
+{
+    const uint8_t *data;
+
+    while (txRingSendStart(ring, &data) != 0)
+        txRingSendDone(ring);
+}
+
+///////////////////////////////////////
+
+static void speed(uint16_t size)
+{
+    static uint8_t   buffer[RING_SIZE], data[RING_SIZE];
+    static oldRing_t old;
+
+    txRing_t ring;
+    uint8_t  *room;
+    uint32_t n, writes = SPEED_BYTES / size;
+    double   begin, oldTime, writeTime, reserveTime;
+
+    for (n = 0; n < size; n++)
+        data[n] = pattern(n);
+
+    // Old ring, a byte at a time
+
+    memset(&old, 0, sizeof(old));
+
+    begin = now();
+
+    for (n = 0; n < writes; n++)
+    {
+        oldWrite(&old, data, size);
+        old.active = false;
+    }
+
+    oldTime = now() - begin;
+    sink    = old.head;
+
+    // txRingWrite
+
+    txRingInit(&ring, buffer, RING_SIZE, NULL);
+
+    begin = now();
+
+    for (n = 0; n < writes; n++)
+    {
+        txRingWrite(&ring, data, size);
+        drainRing(&ring);
+    }
+
+    writeTime = now() - begin;
+    sink      = ring.head;
+
+    // In place, the producer writes its bytes straight into the ring
+
+    txRingInit(&ring, buffer, RING_SIZE, NULL);
+
+    begin = now();
+
+    for (n = 0; n < writes; n++)
+    {
+        room = txRingReserve(&ring, size);
+        memcpy(room, data, size);
+        txRingCommit(&ring, size);
+        drainRing(&ring);
+    }
+
+    reserveTime = now() - begin;
+    sink        = ring.head;
+
+    printf("    %4d  %8.0f  %8.0f  %8.0f\n", size,
+           SPEED_BYTES / oldTime * 1e3, SPEED_BYTES / writeTime * 1e3, SPEED_BYTES / reserveTime * 1e3);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+    static const uint16_t sizes[] = { 1, 8, 31, 71, 256 };
+
+    uint8_t n;
+
+    checkRandom();
+    checkFull();
+    checkWrap();
+    checkOverload();
+
+    printf("MB/s by write size, the in place and write times include draining the ring\n");
+    printf("    size  old ring  txRingWrite  reserve\n");
+
+    for (n = 0; n < sizeof(sizes) / sizeof(sizes[0]); n++)
+        speed(sizes[n]);
+
+    printf("\n%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
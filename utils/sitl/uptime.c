@@ -0,0 +1,444 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+///////////////////////////////////////////////////////////////////////////////
+
+// src/timebase.c arithmetic against exact 64 bit integer results.  Checks:
+//
+//   convert    timebaseCyclesToMicros() against cycles / cyclesPerMicro,
+//              every count up to exactLimit, then past it, for a range of
+//              core clocks, and how many mSec past a tick stay exact
+//   uptime     micros64() and cycles64() as drv_system.c builds them, a
+//              SysTick handler that runs late by up to 50 uSec and a
+//              higher priority handler reading the time while it runs,
+//              through the DWT counter wrap and the tick count high word
+//              carry, against the true cycle count
+//   interval   timebaseSampleInterval() with the first sample, a repeated
+//              timestamp, one going backwards and a gap past 32 bits
+//
+// then nSec per conversion against a divide.  Exits non zero on any
+// failure.
+//
+// Usage: uptime
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <time.h>
+
+#include "board.h"
+
+#include "sitlCheck.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define EXHAUSTIVE_LIMIT  (1UL << 26)  // Every count checked up to here, sampled above
+#define RANDOM_SAMPLES    4000000
+#define SPEED_CONVERSIONS 100000000
+
+#define UPTIME_TICKS      40           // Simulated mSec per uptime run
+#define HANDLER_LATENCY   50           // uSec, most a SysTick handler is held off
+
+static volatile uint32_t sink;
+
+static uint64_t randomState = 88172645463325252ULL;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static double now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+///////////////////////////////////////
+
+static uint32_t random32(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+
+    return (uint32_t)(randomState >> 32);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Conversion
+///////////////////////////////////////////////////////////////////////////////
+
+static void checkConvert(uint32_t coreClock)
+{
+    timebase_t timebase;
+    uint32_t   micros, exact, end, n, firstWrong = 0;
+    uint64_t   cycles;
+    uint32_t   wrong = 0, outside = 0;
+    char       what[100];
+
+    timebaseInit(&timebase, coreClock);
+
+    // Up to the limit, every count then random ones, and both edges
+
+    end = (timebase.exactLimit < EXHAUSTIVE_LIMIT) ? timebase.exactLimit : EXHAUSTIVE_LIMIT;
+
+    for (n = 0; n <= end; n++)
+        if (timebaseCyclesToMicros(&timebase, n) != n / timebase.cyclesPerMicro)
+            wrong++;
+
+    if (timebase.exactLimit > EXHAUSTIVE_LIMIT)
+    {
+        for (n = 0; n < RANDOM_SAMPLES; n++)
+        {
+            cycles = EXHAUSTIVE_LIMIT + (uint64_t)random32() % (timebase.exactLimit - EXHAUSTIVE_LIMIT + 1);
+
+            if (timebaseCyclesToMicros(&timebase, (uint32_t)cycles) != (uint32_t)cycles / timebase.cyclesPerMicro)
+                wrong++;
+        }
+    }
+
+    if ((timebaseCyclesToMicros(&timebase, timebase.exactLimit)     != timebase.exactLimit / timebase.cyclesPerMicro) ||
+        (timebaseCyclesToMicros(&timebase, timebase.exactLimit - 1) != (timebase.exactLimit - 1) / timebase.cyclesPerMicro))
+        wrong++;
+
+    snprintf(what, sizeof(what), "%3lu MHz exact up to %lu cycles, %lu mSec past a tick", (unsigned long)(coreClock / 1000000),
+             (unsigned long)timebase.exactLimit, (unsigned long)(timebase.exactLimit / timebase.cyclesPerTick));
+    check(wrong == 0, what);
+
+    // Past the limit, the first wrong count and every result one high at most
+
+    if (timebase.exactLimit < UINT32_MAX)
+    {
+        end = (timebase.exactLimit < UINT32_MAX / 8) ? timebase.exactLimit * 8 : UINT32_MAX;
+
+        for (n = timebase.exactLimit + 1; n < end; n++)
+        {
+            if (timebaseCyclesToMicros(&timebase, n) != n / timebase.cyclesPerMicro)
+            {
+                firstWrong = n;
+                break;
+            }
+        }
+    }
+
+    for (n = 0; n < RANDOM_SAMPLES; n++)
+    {
+        cycles = random32();
+        micros = timebaseCyclesToMicros(&timebase, (uint32_t)cycles);
+        exact  = (uint32_t)cycles / timebase.cyclesPerMicro;
+
+        if ((micros < exact) || (micros > exact + 1))
+            outside++;
+    }
+
+    if (firstWrong != 0)
+        snprintf(what, sizeof(what), "    first wrong at %lu, never more than 1 high", (unsigned long)firstWrong);
+    else
+        snprintf(what, sizeof(what), "    never more than 1 high");
+
+    check((outside == 0) && ((firstWrong == 0) || (firstWrong > timebase.exactLimit)), what);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Uptime
+///////////////////////////////////////////////////////////////////////////////
+
+// The SysTick and DWT state drv_system.c keeps, and the core clock
+
+typedef struct uptime_t
+{
+    uint64_t cycles;                   // True cycles since the tick count was zero
+    uint32_t dwt;                      // DWT_CYCCNT
+
+    uint32_t sysTickUptime;
+    uint32_t sysTickUptimeHigh;
+    uint32_t sysTickCycleCounter;
+
+    uint8_t  readAtHandler;            // Snapshot read from the DWT in the handler, as before
+    uint8_t  masked;                   // Stores published with interrupts masked, as now
+
+    uint64_t previous;                 // Last micros64() reading
+    uint32_t worst;                    // uSec
+    uint32_t backwards;
+    uint32_t cyclesWrong;
+} uptime_t;
+
+///////////////////////////////////////
+
+static void advance(uptime_t *uptime, uint32_t cycles)
+{
+    uptime->cycles += cycles;
+    uptime->dwt    += cycles;
+}
+
+///////////////////////////////////////
+
+// micros64() and cycles64() against the true count
+
+static void readUptime(uptime_t *uptime, const timebase_t *timebase)
+{
+    uint64_t ticks, micros, exact;
+    uint32_t error;
+
+    ticks  = ((uint64_t)uptime->sysTickUptimeHigh << 32) | uptime->sysTickUptime;
+    micros = timebaseMicros(timebase, ticks, uptime->dwt - uptime->sysTickCycleCounter);
+    exact  = uptime->cycles / timebase->cyclesPerMicro;
+
+    if (timebaseCycles(timebase, ticks, uptime->dwt - uptime->sysTickCycleCounter) != uptime->cycles)
+        uptime->cyclesWrong++;
+
+    error = (uint32_t)((micros > exact) ? micros - exact : exact - micros);
+
+    if (error > uptime->worst)
+        uptime->worst = error;
+
+    if (micros < uptime->previous)
+        uptime->backwards++;
+
+    uptime->previous = micros;
+}
+
+///////////////////////////////////////
+
+// SysTick_Handler(), the hardware tick was cyclesPerTick after the last.
+// A data ready or DMA handler preempts it and reads the time, between the
+// two stores unless they are masked, after them if they are.
+
+static void sysTick(uptime_t *uptime, const timebase_t *timebase)
+{
+    if (uptime->readAtHandler)
+        uptime->sysTickCycleCounter = uptime->dwt;
+    else
+        uptime->sysTickCycleCounter += timebase->cyclesPerTick;
+
+    if (uptime->masked == false)
+        readUptime(uptime, timebase);
+
+    uptime->sysTickUptime++;
+
+    if (uptime->sysTickUptime == 0)
+        uptime->sysTickUptimeHigh++;
+
+    if (uptime->masked)
+        readUptime(uptime, timebase);
+}
+
+///////////////////////////////////////
+
+// Runs UPTIME_TICKS mSec from just before both wraps, reading micros64()
+// and cycles64() every 997 cycles and from a handler preempting each
+// SysTick
+
+static void runUptime(uptime_t *uptime, const timebase_t *timebase, uint8_t readAtHandler, uint8_t masked,
+                      int *wrapped, int *carried)
+{
+    uint64_t tickDue;
+    uint32_t latency, step, tick;
+
+    memset(uptime, 0, sizeof(uptime_t));
+
+    uptime->readAtHandler = readAtHandler;
+    uptime->masked        = masked;
+
+    // Tick count 5 short of its 32 bit carry, DWT 12.5 mSec short of its wrap
+
+    uptime->sysTickUptime       = UINT32_MAX - 4;
+    uptime->cycles              = (uint64_t)uptime->sysTickUptime * timebase->cyclesPerTick;
+    uptime->dwt                 = UINT32_MAX - timebase->cyclesPerTick * 25 / 2;
+    uptime->sysTickCycleCounter = uptime->dwt;
+
+    tickDue = uptime->cycles;
+
+    *wrapped = false;
+    *carried = false;
+
+    for (tick = 0; tick < UPTIME_TICKS; tick++)
+    {
+        tickDue += timebase->cyclesPerTick;  // The hardware tick does not wait for the handler
+        latency = (tick & 1) ? random32() % (HANDLER_LATENCY * timebase->cyclesPerMicro) : 0;
+
+        // Readings up to the hardware tick and on until the handler runs
+
+        while (uptime->cycles < tickDue + latency)
+        {
+            step = 997;
+
+            if (uptime->cycles + step > tickDue + latency)
+                step = (uint32_t)(tickDue + latency - uptime->cycles);
+
+            if (uptime->dwt + step < uptime->dwt)
+                *wrapped = true;
+
+            advance(uptime, step);
+
+            readUptime(uptime, timebase);
+        }
+
+        sysTick(uptime, timebase);
+
+        if (uptime->sysTickUptimeHigh != 0)
+            *carried = true;
+    }
+}
+
+///////////////////////////////////////
+
+static void checkUptime(uint32_t coreClock)
+{
+    timebase_t timebase;
+    uptime_t   uptime;
+    int        wrapped, carried;
+    char       what[100];
+
+    timebaseInit(&timebase, coreClock);
+
+    runUptime(&uptime, &timebase, false, true, &wrapped, &carried);
+
+    check(wrapped && carried, "Run crosses the DWT wrap and the tick count carry");
+
+    check((uptime.worst == 0) && (uptime.backwards == 0) && (uptime.cyclesWrong == 0),
+          "micros64() and cycles64() exact and monotonic, handler up to 50 uSec late");
+
+    runUptime(&uptime, &timebase, true, true, &wrapped, &carried);
+
+    snprintf(what, sizeof(what), "Snapshot read in the handler instead, %lu uSec off, %lu steps back",
+             (unsigned long)uptime.worst, (unsigned long)uptime.backwards);
+    check((uptime.worst > 0) && (uptime.backwards > 0), what);
+
+    runUptime(&uptime, &timebase, false, false, &wrapped, &carried);
+
+    snprintf(what, sizeof(what), "Stores unmasked instead, %lu uSec off, %lu steps back",
+             (unsigned long)uptime.worst, (unsigned long)uptime.backwards);
+    check((uptime.worst >= 999) && (uptime.backwards == UPTIME_TICKS), what);
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Sample Interval
+///////////////////////////////////////////////////////////////////////////////
+
+static int near(float value, float expected)
+{
+    return fabsf(value - expected) <= 1e-6f * expected;
+}
+
+///////////////////////////////////////
+
+static void checkInterval(void)
+{
+    uint64_t previous = 0;
+    float    dt;
+
+    dt = timebaseSampleInterval(&previous, 5000000, 0.002f);
+    check((dt == 0.002f) && (previous == 5000000), "First sample, nominal interval");
+
+    dt = timebaseSampleInterval(&previous, 5002000, 0.002f);
+    check(near(dt, 0.002f) && (previous == 5002000), "2000 uSec later, 0.002 Sec");
+
+    dt = timebaseSampleInterval(&previous, 5002000, 0.002f);
+    check((dt == 0.002f) && (previous == 5002000), "Same timestamp again, nominal, previous kept");
+
+    dt = timebaseSampleInterval(&previous, 5001000, 0.002f);
+    check((dt == 0.002f) && (previous == 5002000), "Timestamp going backwards, nominal, previous kept");
+
+    dt = timebaseSampleInterval(&previous, 5003500, 0.002f);
+    check(near(dt, 0.0015f) && (previous == 5003500), "Next one measured from the newest, 0.0015 Sec");
+
+    dt = timebaseSampleInterval(&previous, 5003500 + 0x100000000ULL + 5, 0.002f);
+    check((dt == 0.002f) && (previous == 5003500 + 0x100000000ULL + 5), "Gap past 32 bits of uSec, nominal, not 5 uSec");
+
+    previous = 0x1000000000000ULL;
+
+    dt = timebaseSampleInterval(&previous, 0x1000000000000ULL + 1000, 0.002f);
+    check(near(dt, 0.001f), "Interval 2^48 uSec after power up, 0.001 Sec");
+
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Conversion Speed
+///////////////////////////////////////////////////////////////////////////////
+
+static void speed(void)
+{
+    timebase_t timebase;
+    uint32_t   n, sum = 0;
+    double     begin, multiply, divide;
+
+    timebaseInit(&timebase, 168000000);
+
+    begin = now();
+
+    for (n = 0; n < SPEED_CONVERSIONS; n++)
+        sum += timebaseCyclesToMicros(&timebase, n * 7);
+
+    multiply = now() - begin;
+    sink     = sum;
+
+    begin = now();
+
+    for (n = 0; n < SPEED_CONVERSIONS; n++)
+        sum += (n * 7) / timebase.cyclesPerMicro;
+
+    divide = now() - begin;
+    sink   = sum;
+
+    printf("Cycles to uSec, nSec each: multiply %.2f, divide %.2f\n", multiply / SPEED_CONVERSIONS, divide / SPEED_CONVERSIONS);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+    static const uint32_t clocks[] = { 168000000, 180000000, 144000000, 120000000, 84000000, 16000000, 2000000 };
+
+    uint8_t n;
+
+    for (n = 0; n < sizeof(clocks) / sizeof(clocks[0]); n++)
+        checkConvert(clocks[n]);
+
+    printf("\n");
+
+    checkUptime(168000000);
+
+    checkInterval();
+
+    speed();
+
+    printf("\n%d failures\n", failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
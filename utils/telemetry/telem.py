@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+from __future__ import print_function
+import argparse
+import os
+import re
+import struct
+import sys
+
+# Reader for the binary high speed telemetry.  The message table is read
+# from src/telemMessages.h each run, so this never falls behind the
+# firmware.  Prints the same comma separated lines as telemcsv, or import
+# it and iterate frames() for (name, sequence, values) tuples.
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'src', 'telemMessages.h')
+
+SYNC = b'\xa5\x5a'
+HEADER_SIZE = 5
+CRC_SIZE = 2
+MAX_PAYLOAD = 64
+
+TYPES = { 'float': 'f', 'int32_t': 'i', 'uint32_t': 'I', 'int16_t': 'h',
+          'uint16_t': 'H', 'uint8_t': 'B', 'char': 's' }
+
+def load_messages(header = HEADER):
+	"""Returns {id: (name, struct, [(field, count, format)])} from the table."""
+	text = open(header).read()
+
+	fields = {}
+	for block in re.finditer(r"#define TELEM_(\w+)_FIELDS\(TELEM_FIELD\)((?:.*\\\n)*.*)", text):
+		fields[block.group(1)] = re.findall(
+			r"TELEM_FIELD\((\w+),\s*(\w+),\s*(?:\[(\d+)\])?\s*,\s*(\"[^\"]*\")\)", block.group(2))
+
+	messages = {}
+	for id, name in re.findall(r"^\s*TELEM_MESSAGE\((\w+),\s*(\w+),\s*\w+\)", text, re.M):
+		layout = '<'
+		names = []
+		for type, field, count, format in fields[name]:
+			count = int(count or 1)
+			layout += (str(count) if count > 1 else '') + TYPES[type]
+			names.append((field, 1 if type == 'char' else count, re.sub(r'(%\d*)l', r'\1', format.strip('"'))))
+		messages[int(id, 0)] = (name, struct.Struct(layout), names)
+
+	return messages
+
+def crc16(data, crc = 0xFFFF):
+	"""CRC-16/CCITT-FALSE as in telemFrame.c."""
+	for byte in bytearray(data):
+		crc ^= byte << 8
+		for bit in range(8):
+			crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+		crc &= 0xFFFF
+	return crc
+
+class Parser(object):
+	"""Byte stream to frames, dropping text and rescanning after a bad CRC."""
+
+	def __init__(self):
+		self.buffer = bytearray()
+		self.frames = self.crc_errors = self.lost = self.skipped = 0
+		self.sequence = None
+
+	def feed(self, data):
+		self.buffer += data
+		while True:
+			start = self.buffer.find(SYNC)
+			if start < 0:
+				keep = 1 if self.buffer[-1:] == SYNC[:1] else 0
+				self.skipped += len(self.buffer) - keep
+				del self.buffer[:len(self.buffer) - keep]
+				return
+			self.skipped += start
+			del self.buffer[:start]
+
+			if len(self.buffer) < 3:
+				return
+			length = self.buffer[2]
+			if length > MAX_PAYLOAD:
+				self.skipped += 1
+				del self.buffer[:1]
+				continue
+			size = HEADER_SIZE + length + CRC_SIZE
+			if len(self.buffer) < size:
+				return
+
+			frame = bytes(self.buffer[:size])
+			if crc16(frame[2:size - 2]) != struct.unpack('<H', frame[-2:])[0]:
+				self.crc_errors += 1
+				self.skipped += 1
+				del self.buffer[:1]
+				continue
+
+			del self.buffer[:size]
+			id, sequence = bytearray(frame[3:5])
+			if self.sequence is not None:
+				self.lost += (sequence - self.sequence - 1) & 0xFF
+			self.sequence = sequence
+			self.frames += 1
+			yield id, sequence, frame[HEADER_SIZE:HEADER_SIZE + length]
+
+def frames(stream, messages = None):
+	"""Yields (name, sequence, values) for every known frame in stream."""
+	messages = messages or load_messages()
+	parser = Parser()
+	while True:
+		data = stream.read(4096) if not hasattr(stream, 'in_waiting') else stream.read(max(1, stream.in_waiting))
+		if not data:
+			return
+		for id, sequence, payload in parser.feed(data):
+			if id not in messages or len(payload) != messages[id][1].size:
+				continue
+			name, layout, names = messages[id]
+			values = list(layout.unpack(payload))
+			yield name, sequence, [v.split(b'\0')[0].decode() if isinstance(v, bytes) else v for v in values]
+
+def csv_line(messages, name, values):
+	fields = next(m[2] for m in messages.values() if m[0] == name)
+	text = []
+	for field, count, format in fields:
+		text += [format % v for v in values[:count]]
+		values = values[count:]
+	return ', '.join(text)
+
+if __name__ == '__main__':
+	parser = argparse.ArgumentParser(description = "AQ32Plus binary telemetry reader")
+
+	parser.add_argument('input', nargs='?',
+		help="capture file, stdin if neither this nor --port is given")
+	parser.add_argument('--port', nargs='?',
+		help="serial port name to read live")
+	parser.add_argument('--baud', type=int, default=115200,
+		help="baud rate for serial port")
+	parser.add_argument('-m', dest='message',
+		help="only this message, e.g. ATTITUDE")
+	parser.add_argument('-n', action='store_true', dest='names',
+		help="start each line with the message name")
+	parser.add_argument('-l', action='store_true', dest='list',
+		help="list the messages and their fields")
+
+	args = parser.parse_args()
+	messages = load_messages()
+
+	if args.list:
+		for id, (name, layout, fields) in sorted(messages.items()):
+			print("0x%02X %-14s %3d bytes   %s" % (id, name, layout.size, ' '.join(f[0] for f in fields)))
+		sys.exit(0)
+
+	if args.port:
+		import serial
+		stream = serial.Serial(args.port, args.baud)
+	elif args.input:
+		stream = open(args.input, 'rb')
+	else:
+		stream = getattr(sys.stdin, 'buffer', sys.stdin)
+
+	try:
+		for name, sequence, values in frames(stream, messages):
+			if args.message and name != args.message.upper():
+				continue
+			print((name + ', ' if args.names else '') + csv_line(messages, name, values))
+	except KeyboardInterrupt:
+		pass
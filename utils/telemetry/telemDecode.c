@@ -0,0 +1,217 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Host side descriptions of the binary telemetry messages, built from the
+// table in src/telemMessages.h with the same macros the firmware uses for
+// its payload structs.  Payloads are read byte by byte as little endian,
+// so the decoder does not depend on the host's byte order or packing.
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "telemDecode.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Message Descriptions
+///////////////////////////////////////////////////////////////////////////////
+
+#define FIELD_INFO(type, name, dimension, format) { #name, format, TELEM_TYPE_##type, sizeof(type dimension) / sizeof(type), sizeof(type) },
+
+#define FIELD_TABLE(id, NAME, Name)               static const telemFieldInfo_t fields##Name[] = { TELEM_##NAME##_FIELDS(FIELD_INFO) };
+
+TELEM_MESSAGES(FIELD_TABLE)
+
+#define MESSAGE_INFO(id, NAME, Name)              { id, #NAME, sizeof(telem##Name##_t), sizeof(fields##Name) / sizeof(fields##Name[0]), fields##Name },
+
+const telemMessageInfo_t telemMessageInfo[] = { TELEM_MESSAGES(MESSAGE_INFO) };
+
+const uint8_t telemNumberOfMessages = sizeof(telemMessageInfo) / sizeof(telemMessageInfo[0]);
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Message Lookup
+///////////////////////////////////////////////////////////////////////////////
+
+const telemMessageInfo_t *telemMessageFind(uint8_t id)
+{
+    uint8_t index;
+
+    for (index = 0; index < telemNumberOfMessages; index++)
+        if (telemMessageInfo[index].id == id)
+            return &telemMessageInfo[index];
+
+    return NULL;
+}
+
+///////////////////////////////////////
+
+// Message name in any case, or its id in decimal or 0x hex
+
+const telemMessageInfo_t *telemMessageFindName(const char *name)
+{
+    uint8_t index;
+    char    *end;
+    long    id;
+
+    for (index = 0; index < telemNumberOfMessages; index++)
+        if (strcasecmp(telemMessageInfo[index].name, name) == 0)
+            return &telemMessageInfo[index];
+
+    id = strtol(name, &end, 0);
+
+    if ((*end != '\0') || (id < 1) || (id > 255))
+        return NULL;
+
+    return telemMessageFind((uint8_t)id);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Message Print
+///////////////////////////////////////////////////////////////////////////////
+
+static uint32_t readLittleEndian(const uint8_t *data, uint8_t size)
+{
+    uint32_t value = 0;
+
+    while (size--)
+        value = (value << 8) | data[size];
+
+    return value;
+}
+
+///////////////////////////////////////
+
+// One comma separated line, every field in the table's format.  Returns
+// 0, printing nothing, for a payload that is not the message's length.
+
+int telemMessagePrint(FILE *file, const telemMessageInfo_t *info, const uint8_t *payload, uint8_t length)
+{
+    const telemFieldInfo_t *field;
+    const char *separator = "";
+    uint8_t     index, value;
+    uint32_t    raw;
+    float       f;
+    char        text[TELEM_MAX_PAYLOAD + 1];
+
+    if (length != info->length)
+        return 0;
+
+    for (index = 0; index < info->fieldCount; index++)
+    {
+        field = &info->fields[index];
+
+        if (field->type == TELEM_TYPE_char)
+        {
+            memcpy(text, payload, field->count);
+            text[field->count] = '\0';
+
+            fputs(separator, file);
+            fprintf(file, field->format, text);
+
+            payload  += field->count;
+            separator = ", ";
+            continue;
+        }
+
+        for (value = 0; value < field->count; value++)
+        {
+            raw = readLittleEndian(payload, field->size);
+
+            fputs(separator, file);
+
+            switch (field->type)
+            {
+                case TELEM_TYPE_float:
+                    memcpy(&f, &raw, sizeof(f));
+                    fprintf(file, field->format, (double)f);
+                    break;
+
+                case TELEM_TYPE_int32_t:
+                    fprintf(file, field->format, (long)(int32_t)raw);
+                    break;
+
+                case TELEM_TYPE_int16_t:
+                    fprintf(file, field->format, (long)(int16_t)raw);
+                    break;
+
+                default:
+                    fprintf(file, field->format, (long)raw);
+                    break;
+            }
+
+            payload  += field->size;
+            separator = ", ";
+        }
+    }
+
+    fputc('\n', file);
+
+    return 1;
+}
+
+///////////////////////////////////////
+
+// Column names for the lines above, arrays as name[0], name[1] ...
+
+void telemMessageHeader(FILE *file, const telemMessageInfo_t *info)
+{
+    const telemFieldInfo_t *field;
+    const char *separator = "";
+    uint8_t     index, value;
+
+    for (index = 0; index < info->fieldCount; index++)
+    {
+        field = &info->fields[index];
+
+        if ((field->count == 1) || (field->type == TELEM_TYPE_char))
+        {
+            fprintf(file, "%s%s", separator, field->name);
+        }
+        else
+        {
+            for (value = 0; value < field->count; value++)
+                fprintf(file, "%s%s[%d]", separator, field->name, value);
+        }
+
+        separator = ", ";
+    }
+
+    fputc('\n', file);
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,100 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "telemFrame.h"
+#include "telemMessages.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Message Descriptions
+///////////////////////////////////////////////////////////////////////////////
+
+// TELEM_TYPE_##type for each field type telemMessages.h allows
+
+enum { TELEM_TYPE_float,
+       TELEM_TYPE_int32_t,
+       TELEM_TYPE_uint32_t,
+       TELEM_TYPE_int16_t,
+       TELEM_TYPE_uint16_t,
+       TELEM_TYPE_uint8_t,
+       TELEM_TYPE_char
+     };
+
+typedef struct telemFieldInfo_t
+{
+    const char *name;
+    const char *format;
+    uint8_t     type;
+    uint8_t     count;
+    uint8_t     size;                  // Bytes per value
+} telemFieldInfo_t;
+
+typedef struct telemMessageInfo_t
+{
+    uint8_t                 id;
+    const char             *name;
+    uint8_t                 length;    // Payload bytes
+    uint8_t                 fieldCount;
+    const telemFieldInfo_t *fields;
+} telemMessageInfo_t;
+
+extern const telemMessageInfo_t telemMessageInfo[];
+
+extern const uint8_t telemNumberOfMessages;
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Message Lookup
+///////////////////////////////////////////////////////////////////////////////
+
+const telemMessageInfo_t *telemMessageFind(uint8_t id);
+
+const telemMessageInfo_t *telemMessageFindName(const char *name);
+
+///////////////////////////////////////////////////////////////////////////////
+// Telemetry Message Print
+///////////////////////////////////////////////////////////////////////////////
+
+int telemMessagePrint(FILE *file, const telemMessageInfo_t *info, const uint8_t *payload, uint8_t length);
+
+void telemMessageHeader(FILE *file, const telemMessageInfo_t *info);
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,196 @@
+/*
+  October 2012
+
+  aq32Plus Rev -
+
+  Copyright (c) 2012 John Ihlein.  All rights reserved.
+
+  Open Source STM32 Based Multicopter Controller Software
+
+  Includes code and/or ideas from:
+
+  1)AeroQuad
+  2)BaseFlight
+  3)CH Robotics
+  4)MultiWii
+  5)S.O.H. Madgwick
+  6)UAVX
+
+  Designed to run on the AQ32 Flight Control Board
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Turns the binary high speed telemetry back into the comma separated
+// lines the text streams used to print, so existing plots and scripts
+// keep working.  Reads a capture file or stdin, anything between frames,
+// CLI replies and EVR lines, is dropped.
+//
+// Usage: telemcsv [-n] [-c] [-m message] [-s] [-l] [file]
+//
+//   -n  Start each line with the message name
+//   -c  Column names before each message's first line
+//   -m  Only this message, by name or id, e.g. -m attitude
+//   -s  Frame, CRC error, lost frame and skipped byte counts on stderr
+//   -l  List the messages and their fields
+//
+//   ../sitl/sitl -T 4 | ./telemcsv > attitude.csv
+//   stty -F /dev/ttyUSB0 115200 raw; ./telemcsv -n -s /dev/ttyUSB0
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <getopt.h>
+#include <stdlib.h>
+
+#include "telemDecode.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void listMessages(void)
+{
+    uint8_t index, field;
+
+    for (index = 0; index < telemNumberOfMessages; index++)
+    {
+        const telemMessageInfo_t *info = &telemMessageInfo[index];
+
+        printf("0x%02X %-14s %3d bytes  ", info->id, info->name, info->length);
+
+        for (field = 0; field < info->fieldCount; field++)
+        {
+            if (info->fields[field].count > 1)
+                printf(" %s[%d]", info->fields[field].name, info->fields[field].count);
+            else
+                printf(" %s", info->fields[field].name);
+        }
+
+        printf("\n");
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    const telemMessageInfo_t *info, *only = NULL;
+
+    telemParser_t parser;
+    FILE     *input = stdin;
+    uint32_t counts[256] = { 0 }, unknown = 0;
+    int      names = 0, columns = 0, stats = 0, option, ch;
+    uint16_t index;
+
+    while ((option = getopt(argc, argv, "ncm:sl")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':
+                names = 1;
+                break;
+
+            case 'c':
+                columns = 1;
+                break;
+
+            case 'm':
+                only = telemMessageFindName(optarg);
+
+                if (only == NULL)
+                {
+                    fprintf(stderr, "%s: no message %s, see -l\n", argv[0], optarg);
+                    return 1;
+                }
+                break;
+
+            case 's':
+                stats = 1;
+                break;
+
+            case 'l':
+                listMessages();
+                return 0;
+
+            default:
+                fprintf(stderr, "usage: %s [-n] [-c] [-m message] [-s] [-l] [file]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind < argc)
+    {
+        input = fopen(argv[optind], "rb");
+
+        if (input == NULL)
+        {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    telemParserInit(&parser);
+
+    while ((ch = getc(input)) != EOF)
+    {
+        telemParserPut(&parser, (uint8_t)ch);
+
+        while (telemParserGet(&parser))
+        {
+            info = telemMessageFind(parser.id);
+
+            if ((info == NULL) || (info->length != parser.length))
+            {
+                unknown++;
+                continue;
+            }
+
+            if ((only != NULL) && (info != only))
+                continue;
+
+            if (columns && (counts[info->id] == 0))
+            {
+                if (names)
+                    printf("message, ");
+
+                telemMessageHeader(stdout, info);
+            }
+
+            counts[info->id]++;
+
+            if (names)
+                printf("%s, ", info->name);
+
+            telemMessagePrint(stdout, info, parser.payload, parser.length);
+        }
+    }
+
+    if (stats)
+    {
+        fprintf(stderr, "%lu frames, %lu CRC errors, %lu lost by sequence, %lu bytes skipped, %lu unknown\n",
+                (unsigned long)parser.frames, (unsigned long)parser.crcErrors, (unsigned long)parser.sequenceGaps,
+                (unsigned long)parser.skipped, (unsigned long)unknown);
+
+        for (index = 0; index < 256; index++)
+            if (counts[index] > 0)
+                fprintf(stderr, "  %-14s %lu\n", telemMessageFind((uint8_t)index)->name, (unsigned long)counts[index]);
+    }
+
+    if (input != stdin)
+        fclose(input);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////